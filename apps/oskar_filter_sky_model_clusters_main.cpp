@@ -3,7 +3,6 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
-#include "convert/oskar_convert_healpix_ring_to_theta_phi.h"
 #include "log/oskar_log.h"
 #include "math/oskar_angular_distance.h"
 #include "math/oskar_bearing_angle.h"
@@ -16,7 +15,6 @@
 #include "utility/oskar_version_string.h"
 
 #include <algorithm>
-#include <cfloat>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -33,12 +31,6 @@ using std::string;
 using std::unique;
 using std::vector;
 
-template<typename T>
-bool contains(const std::vector<T>& v, const T& val)
-{
-    return std::find(v.begin(), v.end(), val) != v.end();
-}
-
 template<typename T>
 struct sort_indices
 {
@@ -50,9 +42,10 @@ struct sort_indices
 static void check_overlap(int start_component,
         const double* ra, const double* dec, const double* major,
         const double* minor, const double* pa_rad, const double sigma,
-        const double max_separation_rad, vector<int>& cluster_components,
-        vector<int>& components_removed, const vector<double>& bin_ra,
-        const vector<double>& bin_dec, const vector<vector<int> >& bin_indices)
+        const double max_separation_rad, int cluster,
+        vector<int>& cluster_components, vector<int>& component_cluster,
+        vector<char>& removed, int& num_removed,
+        const oskar_SkyIndex* index, oskar_Mem* query, int* status)
 {
     // Get data for the reference component.
     double ra0  = ra[start_component];
@@ -61,53 +54,43 @@ static void check_overlap(int start_component,
     double minor0 = sigma * FWHM_TO_SIGMA * minor[start_component];
     double pa0 = pa_rad[start_component];
 
-    // Find distances to the nearest bin centres.
-    const int num_bins = (int)bin_ra.size();
-    vector<double> bin_dist(num_bins);
-    vector<int> bin_index(num_bins);
-    for (int i = 0; i < num_bins; ++i)
+    // Find all components within the maximum separation.
+    // The query buffer is reused by recursive calls, so take a copy.
+    const int num_found = oskar_sky_index_query_radius(index, ra0, dec0,
+            0.0, max_separation_rad, query, status);
+    if (*status || num_found == 0) return;
+    const int* found = oskar_mem_int_const(query, status);
+    vector<int> components_to_check(found, found + num_found);
+    for (int i = 0; i < num_found; ++i)
     {
-        bin_index[i] = i;
-        bin_dist[i] = oskar_angular_distance(ra0, bin_ra[i], dec0, bin_dec[i]);
-    }
-    sort(bin_index.begin(), bin_index.end(),
-            sort_indices<double>(&bin_dist[0]));
-
-    // Loop over all unchecked sources in nearby bins (4 bins is worst case).
-    for (int b = 0; b < 4; ++b)
-    {
-        int bin = bin_index[b];
-        int num_components_to_check = (int)bin_indices[bin].size();
-        for (int i = 0; i < num_components_to_check; ++i)
+        // Get the component index.
+        int c = components_to_check[i];
+
+        // Don't check for overlap if the component to check against
+        // is already in this cluster.
+        if (component_cluster[c] == cluster) continue;
+
+        // Calculate component separation and Gaussian ellipse radii.
+        double d = oskar_angular_distance(ra0, ra[c], dec0, dec[c]);
+        double a0 = oskar_bearing_angle(ra0, ra[c], dec0, dec[c]);
+        double r0 = oskar_ellipse_radius(major0, minor0, pa0, a0);
+        double a1 = oskar_bearing_angle(ra[c], ra0, dec[c], dec0);
+        double r1 = oskar_ellipse_radius(sigma * FWHM_TO_SIGMA * major[c],
+                sigma * FWHM_TO_SIGMA * minor[c], pa_rad[c], a1);
+
+        // Mark for removal if components are overlapping.
+        if (r0 + r1 > d || c == start_component)
         {
-            // Get the component index.
-            int c = bin_indices[bin][i];
-
-            // Calculate component separation and Gaussian ellipse radii.
-            double d = oskar_angular_distance(ra0, ra[c], dec0, dec[c]);
-            if (d > max_separation_rad) continue;
-
-            // Don't check for overlap if the component to check against
-            // is already marked for removal.
-            if (contains(cluster_components, c)) continue;
-
-            double a0 = oskar_bearing_angle(ra0, ra[c], dec0, dec[c]);
-            double r0 = oskar_ellipse_radius(major0, minor0, pa0, a0);
-            double a1 = oskar_bearing_angle(ra[c], ra0, dec[c], dec0);
-            double r1 = oskar_ellipse_radius(sigma * FWHM_TO_SIGMA * major[c],
-                    sigma * FWHM_TO_SIGMA * minor[c], pa_rad[c], a1);
-
-            // Mark for removal if components are overlapping.
-            if (r0 + r1 > d || c == start_component)
-            {
-                components_removed.push_back(c);
-                cluster_components.push_back(c);
-
-                // Recursively check for overlap from component being removed.
-                check_overlap(c, ra, dec, major, minor, pa_rad, sigma,
-                        max_separation_rad, cluster_components,
-                        components_removed, bin_ra, bin_dec, bin_indices);
-            }
+            removed[c] = 1;
+            num_removed++;
+            component_cluster[c] = cluster;
+            cluster_components.push_back(c);
+
+            // Recursively check for overlap from component being removed.
+            check_overlap(c, ra, dec, major, minor, pa_rad, sigma,
+                    max_separation_rad, cluster, cluster_components,
+                    component_cluster, removed, num_removed, index, query,
+                    status);
         }
     }
 }
@@ -240,40 +223,32 @@ int main(int argc, char** argv)
             num_input, 0, &max_size_rad, 0, 0, &status);
     max_size_rad *= 1.1 * sigma;
 
-    // Create spatial bins.
-    int nside = 5;
-    int num_bins = 12 * nside * nside;
-    vector<double> bin_ra(num_bins), bin_dec(num_bins), bin_dist(num_bins);
-    vector< vector<int> > bin_indices(num_bins);
-    for (int i = 0; i < num_bins; ++i)
-    {
-        oskar_convert_healpix_ring_to_theta_phi_d(nside, i,
-                &bin_dec[i], &bin_ra[i]);
-        bin_dec[i] = 0.5 * M_PI - bin_dec[i];
-    }
-
-    // Spatially bin the input data.
-    for (int i = 0, bin = 0; i < num_input; ++i)
+    // Create a spatial index of the component positions.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_input,
+            oskar_sky_ra_rad_const(sky_to_filter),
+            oskar_sky_dec_rad_const(sky_to_filter), &status);
+    oskar_Mem* query = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    if (status)
     {
-        double min_d = DBL_MAX;
-        for (int j = 0; j < num_bins; ++j)
-        {
-            double d = oskar_angular_distance(sky_ra[i], bin_ra[j],
-                    sky_dec[i], bin_dec[j]);
-            if (d < min_d)
-            {
-                bin = j;
-                min_d = d;
-            }
-        }
-        bin_indices[bin].push_back(i);
+        oskar_log_error(log, "Cannot create spatial index: %s",
+                oskar_get_error_string(status));
+        oskar_timer_free(timer);
+        oskar_sky_free(sky_to_filter, &status);
+        oskar_sky_free(sky_as_filter, &status);
+        return EXIT_FAILURE;
     }
+    oskar_log_message(log, 'M', 0, "Created spatial index (nside %d) "
+            "in %.1f sec.", oskar_sky_index_nside(index),
+            oskar_timer_elapsed(timer));
 
     // Loop over input sources.
     vector< vector<int> > output_source_components;
-    vector<int> components_removed;
-    oskar_log_message(log, 'M', 0, "Grouping using %d bins...", num_bins);
-    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    vector<int> component_cluster(num_input, -1);
+    vector<char> removed(num_input, 0);
+    int num_removed = 0;
+    oskar_log_message(log, 'M', 0, "Grouping...");
     oskar_timer_start(timer);
     for (int i = 0, progress = -num_input; i < num_input; ++i)
     {
@@ -288,18 +263,21 @@ int main(int argc, char** argv)
 
         // Don't check for overlap if the component is already marked
         // for removal.
-        if (contains(components_removed, i)) continue;
+        if (removed[i]) continue;
 
         vector<int> components;
         check_overlap(i, sky_ra, sky_dec, filter_maj, filter_min, filter_pa,
-                sigma, max_size_rad,  components, components_removed,
-                bin_ra, bin_dec, bin_indices);
+                sigma, max_size_rad, (int)output_source_components.size(),
+                components, component_cluster, removed, num_removed,
+                index, query, &status);
         output_source_components.push_back(components);
     }
     int num_output = (int)output_source_components.size();
     oskar_log_message(log, 'M', 1, "100%% done after %6.1f sec.",
             oskar_timer_elapsed(timer));
     oskar_timer_free(timer);
+    oskar_sky_index_free(index);
+    oskar_mem_free(query, &status);
 
     // Check that all components have been grouped.
     {
@@ -314,10 +292,10 @@ int main(int argc, char** argv)
             oskar_sky_free(sky_as_filter, &status);
             return EXIT_FAILURE;
         }
-        if (num_input != (int)components_removed.size())
+        if (num_input != num_removed)
         {
             oskar_log_error(log, "Inconsistent component counts: %d input, "
-                    "%d removed.",  num_input, (int)components_removed.size());
+                    "%d removed.",  num_input, num_removed);
             oskar_sky_free(sky_to_filter, &status);
             oskar_sky_free(sky_as_filter, &status);
             return EXIT_FAILURE;
@@ -433,7 +411,7 @@ int main(int argc, char** argv)
 
     // Print output sky model stats.
     double min_flux = 0.0, max_flux = 0.0, mean_flux = 0.0, std_flux = 0.0;
-    oskar_mem_stats(oskar_sky_I_const(sky_out), num_output,
+    oskar_mem_stats(oskar_sky_I_const(sky_out), num_sources_out,
             &min_flux, &max_flux, &mean_flux, &std_flux, &status);
     oskar_log_message(log, 'M', 0, "After filtering, (min, max, mean, std.dev) "
             "component fluxes are:");
@@ -3,72 +3,79 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
-#include "oskar_rebin_sky_cuda.h"
-#include "log/oskar_log.h"
 #include "settings/oskar_option_parser.h"
 #include "sky/oskar_sky.h"
-#include "utility/oskar_device.h"
+#include "utility/oskar_device_count.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_version_string.h"
 
 #include <cstdio>
 #include <cstdlib>
 
 int main(int argc, char** argv)
 {
-    oskar_Sky *input, *output, *input_gpu, *output_gpu;
+    oskar_Sky *input, *output, *input_dev = 0, *output_dev = 0;
     int error = 0;
 
-    oskar::OptionParser opt("oskar_rebin_sky");
+    oskar::OptionParser opt("oskar_rebin_sky", oskar_version_string());
     opt.add_required("input sky file");
     opt.add_required("output sky file");
+    opt.add_flag("-d", "Use double precision (CPU only).",
+            false, "--double");
+    opt.add_flag("-c", "Use the CPU even if a GPU is available.",
+            false, "--cpu");
     if (!opt.check_options(argc, argv)) return EXIT_FAILURE;
+    const char* input_file = opt.get_arg(0);
+    const char* output_file = opt.get_arg(1);
+    const int type = opt.is_set("-d") ? OSKAR_DOUBLE : OSKAR_SINGLE;
+    int location = OSKAR_CPU;
+    if (type == OSKAR_SINGLE && !opt.is_set("-c") &&
+            oskar_device_count("CUDA", 0) > 0)
+        location = OSKAR_GPU;
 
     // Load input and output sky models.
-    printf("Loading input '%s'\n", argv[1]);
-    input = oskar_sky_load(argv[1], OSKAR_SINGLE, &error);
+    printf("Loading input '%s'\n", input_file);
+    input = oskar_sky_load(input_file, type, &error);
     if (error)
     {
         fprintf(stderr, "Error loading input sky file.\n");
         return EXIT_FAILURE;
     }
-    printf("Loading output '%s'\n", argv[2]);
-    output = oskar_sky_load(argv[2], OSKAR_SINGLE, &error);
+    printf("Loading output '%s'\n", output_file);
+    output = oskar_sky_load(output_file, type, &error);
     if (error)
     {
+        oskar_sky_free(input, &error);
         fprintf(stderr, "Error loading output sky file.\n");
         return EXIT_FAILURE;
     }
 
-    // Copy sky models to GPU.
-    input_gpu = oskar_sky_create_copy(input, OSKAR_GPU, &error);
-    output_gpu = oskar_sky_create_copy(output, OSKAR_GPU, &error);
-
-    // Free CPU sky models.
-    oskar_sky_free(input, &error);
-    oskar_sky_free(output, &error);
-
     // Rebin flux in input sky to output source positions.
-    oskar_mem_clear_contents(oskar_sky_I(output_gpu), &error);
-    oskar_rebin_sky_cuda_f(
-            oskar_sky_num_sources(input_gpu),
-            oskar_sky_num_sources(output_gpu),
-            oskar_mem_float_const(oskar_sky_ra_rad_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_dec_rad_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_I_const(input_gpu), &error),
-            oskar_mem_float_const(oskar_sky_ra_rad_const(output_gpu), &error),
-            oskar_mem_float_const(oskar_sky_dec_rad_const(output_gpu), &error),
-            oskar_mem_float(oskar_sky_I(output_gpu), &error));
-    oskar_device_check_error_cuda(&error);
-    if (error)
-        fprintf(stderr, "CUDA error (%s).\n", oskar_get_error_string(error));
+    printf("Rebinning %d sources onto %d sources using the %s\n",
+            oskar_sky_num_sources(input), oskar_sky_num_sources(output),
+            location == OSKAR_GPU ? "GPU" : "CPU");
+    if (location == OSKAR_GPU)
+    {
+        input_dev = oskar_sky_create_copy(input, location, &error);
+        output_dev = oskar_sky_create_copy(output, location, &error);
+        oskar_sky_rebin(input_dev, output_dev, &error);
+        oskar_sky_free(output, &error);
+        output = oskar_sky_create_copy(output_dev, OSKAR_CPU, &error);
+    }
+    else
+        oskar_sky_rebin(input, output, &error);
 
     // Write new sky model out.
-    output = oskar_sky_create_copy(output_gpu, OSKAR_CPU, &error);
-    oskar_sky_save(output, argv[2], &error);
+    if (!error)
+        oskar_sky_save(output, output_file, &error);
+    else
+        fprintf(stderr, "Error rebinning sky model (%s).\n",
+                oskar_get_error_string(error));
 
     // Free sky models.
-    oskar_sky_free(input_gpu, &error);
-    oskar_sky_free(output_gpu, &error);
+    oskar_sky_free(input_dev, &error);
+    oskar_sky_free(output_dev, &error);
+    oskar_sky_free(input, &error);
     oskar_sky_free(output, &error);
 
     return error ? EXIT_FAILURE : EXIT_SUCCESS;
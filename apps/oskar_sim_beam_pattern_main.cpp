@@ -11,10 +11,12 @@
 #include "log/oskar_log.h"
 #include "settings/oskar_option_parser.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_trace.h"
 #include "utility/oskar_version_string.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 
 using namespace oskar;
 
@@ -72,8 +74,17 @@ int main(int argc, char** argv)
         oskar_beam_pattern_set_telescope_model(sim, tel, &status);
     oskar_telescope_free(tel, &status);
 
+    // Record a performance trace, if required.
+    std::string trace_file = s->to_string("simulator/trace_file", &status);
+    if (!trace_file.empty()) oskar_trace_set_enabled(1);
+
     // Run simulation.
     oskar_beam_pattern_run(sim, &status);
+    if (!trace_file.empty())
+    {
+        oskar_trace_set_enabled(0);
+        oskar_trace_write(trace_file.c_str(), &status);
+    }
 
     // Free memory.
     oskar_beam_pattern_free(sim, &status);
@@ -5,6 +5,7 @@
 
 #include "apps/oskar_app_settings.h"
 #include "apps/oskar_settings_log.h"
+#include "apps/oskar_settings_to_imager.h"
 #include "apps/oskar_settings_to_interferometer.h"
 #include "apps/oskar_settings_to_sky.h"
 #include "apps/oskar_settings_to_telescope.h"
@@ -12,10 +13,15 @@
 #include "settings/oskar_option_parser.h"
 #include "interferometer/oskar_interferometer.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_mpi.h"
+#include "utility/oskar_trace.h"
 #include "utility/oskar_version_string.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 
 using namespace oskar;
 
@@ -55,25 +61,57 @@ int main(int argc, char** argv)
         return ok ? 0 : EXIT_FAILURE;
     }
 
+    // Initialise MPI, if running across multiple processes.
+    // Blocks are shared between processes, and the first one writes
+    // all the output.
+    oskar_mpi_init(&argc, &argv, &status);
+    if (status)
+    {
+        oskar_log_error(0, "Failed to initialise MPI: %s.",
+                oskar_get_error_string(status));
+        SettingsTree::free(s);
+        oskar_mpi_finalise();
+        return EXIT_FAILURE;
+    }
+    const int rank = oskar_mpi_rank();
+
     // Set up the interferometer simulator.
     oskar_Interferometer* sim =
             oskar_settings_to_interferometer(s, NULL, &status);
     oskar_Log* log = oskar_interferometer_log(sim);
     int priority = opt.is_set("-q") ? OSKAR_LOG_WARNING : OSKAR_LOG_STATUS;
+    if (rank > 0)
+    {
+        priority = OSKAR_LOG_WARNING;
+        oskar_log_set_keep_file(log, 0);
+    }
     oskar_log_set_term_priority(log, priority);
 
     // Write settings to log.
     oskar_settings_log(s, log);
 
     // Set up the sky model and telescope model.
+    // These are read only by the first process, and sent to the others.
     oskar_Telescope* tel = 0;
-    oskar_Sky* sky = oskar_settings_to_sky(s, log, &status);
+    oskar_Sky* sky = 0;
+    if (rank == 0)
+        sky = oskar_settings_to_sky(s, log, &status);
+    else
+        sky = oskar_sky_create(s->to_int("simulator/double_precision",
+                &status) ? OSKAR_DOUBLE : OSKAR_SINGLE, OSKAR_CPU, 0, &status);
+    if (oskar_mpi_size() > 1)
+    {
+        int root_status = status, mpi_status = 0;
+        oskar_mpi_bcast(&root_status, sizeof(int), 0, &mpi_status);
+        if (!status) status = root_status ? root_status : mpi_status;
+        if (sky) oskar_sky_bcast(sky, 0, &status);
+    }
     if (!sky || status)
         oskar_log_error(log, "Failed to set up sky model: %s.",
                 oskar_get_error_string(status));
     else
     {
-        tel = oskar_settings_to_telescope(s, log, &status);
+        tel = oskar_settings_to_telescope_mpi(s, log, &status);
         if (!tel || status)
             oskar_log_error(log, "Failed to set up telescope model: %s.",
                     oskar_get_error_string(status));
@@ -88,11 +126,63 @@ int main(int argc, char** argv)
     oskar_sky_free(sky, &status);
     oskar_telescope_free(tel, &status);
 
+    // Set up any imagers to image the visibilities as they are simulated.
+    int num_imager_files = 0;
+    std::vector<oskar_Imager*> imagers;
+    const char* const* imager_files = s->to_string_list(
+            "interferometer/imager_settings_files", &num_imager_files, &status);
+    for (int i = 0; i < num_imager_files && !status; ++i)
+    {
+        if (!imager_files[i] || !strlen(imager_files[i])) continue;
+        SettingsTree* t = oskar_app_settings_tree("oskar_imager",
+                imager_files[i]);
+        if (!t)
+        {
+            oskar_log_error(log, "Failed to read imager settings file '%s'",
+                    imager_files[i]);
+            status = OSKAR_ERR_SETUP_FAIL;
+            break;
+        }
+        if (!strlen(t->to_string("image/root_path", &status)))
+        {
+            oskar_log_error(log, "No output image root path set in '%s'",
+                    imager_files[i]);
+            status = OSKAR_ERR_SETUP_FAIL;
+        }
+        oskar_Imager* imager = oskar_settings_to_imager(t, NULL, &status);
+        oskar_imager_set_input_files(imager, 0, 0, &status);
+        oskar_log_set_term_priority(oskar_imager_log(imager), priority);
+        oskar_interferometer_add_imager(sim, imager);
+        imagers.push_back(imager);
+        SettingsTree::free(t);
+    }
+
+    // Record a performance trace, if required.
+    std::string trace_file = s->to_string("simulator/trace_file", &status);
+    if (!trace_file.empty() && rank > 0)
+    {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ".%d", rank);
+        trace_file += suffix;
+    }
+    if (!trace_file.empty()) oskar_trace_set_enabled(1);
+
     // Run simulation.
     oskar_interferometer_run(sim, &status);
+    if (!trace_file.empty())
+    {
+        oskar_trace_set_enabled(0);
+        oskar_trace_write(trace_file.c_str(), &status);
+    }
+
+    // Stop all processes if any one of them failed.
+    if (status) oskar_mpi_abort(status);
 
     // Free memory.
     oskar_interferometer_free(sim, &status);
+    for (size_t i = 0; i < imagers.size(); ++i)
+        oskar_imager_free(imagers[i], &status);
     SettingsTree::free(s);
+    oskar_mpi_finalise();
     return status ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -59,6 +59,27 @@ OSKAR_APPS_EXPORT
 oskar_Telescope* oskar_settings_to_telescope(oskar::SettingsTree* s,
         oskar_Log* log, int* status);
 
+/**
+ * @brief
+ * Creates a telescope model from the supplied settings, on all processes.
+ *
+ * @details
+ * This is the same as oskar_settings_to_telescope(), except that the
+ * telescope model directory is read only by the first process and sent to
+ * all the others using oskar_telescope_load_mpi().
+ *
+ * This is a collective operation, so it must be called on all processes.
+ *
+ * @param[in] s           A pointer to the settings tree.
+ * @param[in,out] log     A pointer to the log to use.
+ * @param[in,out] status  Status return code.
+ *
+ * @return A handle to the new telescope model.
+ */
+OSKAR_APPS_EXPORT
+oskar_Telescope* oskar_settings_to_telescope_mpi(oskar::SettingsTree* s,
+        oskar_Log* log, int* status);
+
 #endif
 
 #endif /* OSKAR_SETTINGS_TO_TELESCOPE_H_ */
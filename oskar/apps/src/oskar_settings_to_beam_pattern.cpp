@@ -73,6 +73,7 @@ oskar_BeamPattern* oskar_settings_to_beam_pattern(oskar::SettingsTree* s,
         oskar_beam_pattern_set_num_devices(h, -1);
     else
         oskar_beam_pattern_set_num_devices(h, s->to_int("num_devices", status));
+    oskar_mem_pool_set_enabled(s->to_int("use_memory_pool", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
@@ -99,6 +99,7 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
             s->to_string("algorithm", status), status);
     oskar_imager_set_weighting(h,
             s->to_string("weighting", status), status);
+    oskar_imager_set_robust(h, s->to_double("robust", status));
     if (s->starts_with("algorithm", "FFT", status) ||
             s->starts_with("algorithm", "fft", status))
     {
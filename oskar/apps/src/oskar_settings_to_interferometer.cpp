@@ -52,6 +52,7 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     else
         oskar_interferometer_set_num_devices(h,
                 s->to_int("num_devices", status));
+    oskar_mem_pool_set_enabled(s->to_int("use_memory_pool", status));
     oskar_log_set_keep_file(log_, s->to_int("keep_log_file", status));
     oskar_log_set_file_priority(log_,
             s->to_int("write_status_to_log_file", status) ?
@@ -67,6 +68,12 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
     oskar_interferometer_set_source_flux_range(h,
             s->to_double("common_flux_filter/flux_min", status),
             s->to_double("common_flux_filter/flux_max", status));
+    oskar_interferometer_set_model_image(h,
+            s->to_string("model_image/file", status),
+            s->to_string("model_image/algorithm", status),
+            s->to_string("model_image/default_map_units", status),
+            s->to_int("model_image/override_map_units", status),
+            s->to_double("model_image/spectral_index", status));
     s->end_group();
 
     // Set interferometer settings.
@@ -78,14 +85,50 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("max_time_samples_per_block", status));
     oskar_interferometer_set_max_channels_per_block(h,
             s->to_int("max_channels_per_block", status));
+    oskar_interferometer_set_device_partition(h,
+            s->to_string("device_partition", status), status);
+    oskar_interferometer_set_adaptive_chunks(h,
+            s->to_int("adaptive_chunks/enable", status),
+            s->to_double("adaptive_chunks/memory_budget_mb", status));
+    oskar_interferometer_set_level_of_detail(h,
+            s->to_int("level_of_detail/enable", status),
+            s->to_double("level_of_detail/tolerance_jy", status));
+    oskar_interferometer_set_facet_prediction(h,
+            s->to_int("facet_prediction/enable", status),
+            s->to_int("facet_prediction/min_sources", status),
+            s->to_double("facet_prediction/facet_size_deg", status),
+            s->to_double("facet_prediction/pixel_oversample", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
     oskar_interferometer_set_output_measurement_set(h,
             s->to_string("ms_filename", status));
+    oskar_interferometer_set_output_bda_vis_file(h,
+            s->to_string("bda/oskar_vis_filename", status));
+    oskar_interferometer_set_bda(h,
+            s->to_double("bda/max_amplitude_loss_factor", status),
+            s->to_double("bda/fov_deg", status),
+            s->to_double("bda/max_time_average_sec", status),
+            s->to_int("bda/max_channels_average", status));
+    oskar_interferometer_set_beam_table(h,
+            s->to_int("beam_table/enable", status),
+            s->to_string("beam_table/filename", status),
+            s->to_int("beam_table/grid_size", status),
+            s->to_int("beam_table/epoch_time_steps", status),
+            s->to_double("beam_table/max_error", status));
+    oskar_interferometer_set_beam_time_interp(h,
+            s->to_int("beam_time_interp/enable", status),
+            s->starts_with("beam_time_interp/time_step", "auto", status) ?
+                    0 : s->to_int("beam_time_interp/time_step", status),
+            s->to_double("beam_time_interp/max_error", status),
+            s->to_int("beam_time_interp/all_chunks", status));
     oskar_interferometer_set_force_polarised_ms(h,
             s->to_int("force_polarised_ms", status));
     oskar_interferometer_set_ignore_w_components(h,
             s->to_int("ignore_w_components", status));
+    oskar_interferometer_set_fused_jones(h,
+            s->to_int("fused_jones_chain", status));
+    oskar_interferometer_set_direct_correlation(h,
+            s->to_string("direct_correlation", status), status);
     s->end_group();
 
     // Set observation settings.
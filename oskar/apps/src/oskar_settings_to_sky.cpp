@@ -43,6 +43,8 @@ static void gen_rpl(oskar_Sky* sky, SettingsTree* s,
 static void gen_rbpl(oskar_Sky* sky, SettingsTree* s,
         double ra0, double dec0, oskar_Log* log, int* status);
 
+static oskar_Sky* read_columns(const char* filename, int type,
+        SettingsTree* s, double ra0_rad, double dec0_rad, int* status);
 static void set_up_filter(oskar_Sky* sky, SettingsTree* s,
         double ra0_rad, double dec0_rad, oskar_Log* log, int* status);
 static void set_up_extended(oskar_Sky* sky, SettingsTree* s, int* status);
@@ -125,6 +127,15 @@ oskar_Sky* oskar_settings_to_sky(SettingsTree* s, oskar_Log* log, int* status)
         oskar_sky_save(sky, filename, status);
     }
 
+    /* Write columnar file. */
+    filename = s->to_string("output_columnar_file", status);
+    if (filename && strlen(filename) > 0 && !*status)
+    {
+        oskar_log_message(log, 'M', 1,
+                "Writing sky model columnar file: %s", filename);
+        oskar_sky_write_columns(sky, filename, 0, status);
+    }
+
     /* Write binary file. */
     filename = s->to_string("output_binary_file", status);
     if (filename && strlen(filename) > 0 && !*status)
@@ -147,7 +158,7 @@ static void load_osm(oskar_Sky* sky, SettingsTree* s,
     const char* const* files = s->to_string_list("file", &num_files, status);
     for (int i = 0; i < num_files; ++i)
     {
-        int binary_file_error = 0;
+        int binary_file_error = 0, columnar_file_error = 0;
         if (*status) break;
         if (!files[i] || strlen(files[i]) == 0) continue;
 
@@ -155,11 +166,15 @@ static void load_osm(oskar_Sky* sky, SettingsTree* s,
         oskar_log_message(log, 'M', 0,
                 "Loading OSKAR sky model file '%s' ...", files[i]);
 
-        /* Try to read sky model as a binary file first. */
-        /* If this fails, read it as an ASCII file. */
-        oskar_Sky* t = oskar_sky_read(files[i],
-                OSKAR_CPU, &binary_file_error);
-        if (binary_file_error)
+        /* Try to read sky model as a columnar file first, skipping
+         * chunks that would be removed by the filters. */
+        /* If this fails, try to read it as a binary file, and then
+         * as an ASCII file. */
+        oskar_Sky* t = read_columns(files[i], oskar_sky_precision(sky),
+                s, ra0, dec0, &columnar_file_error);
+        if (columnar_file_error)
+            t = oskar_sky_read(files[i], OSKAR_CPU, &binary_file_error);
+        if (columnar_file_error && binary_file_error)
             t = oskar_sky_load(files[i],
                     oskar_sky_precision(sky), status);
 
@@ -476,6 +491,28 @@ static void gen_rbpl(oskar_Sky* sky, SettingsTree* s,
 }
 
 
+static oskar_Sky* read_columns(const char* filename, int type,
+        SettingsTree* s, double ra0_rad, double dec0_rad, int* status)
+{
+    /* The filters are applied again afterwards, so only the values
+     * are needed here. */
+    s->begin_group("filter");
+    double flux_min = s->to_double("flux_min", status);
+    double flux_max = s->to_double("flux_max", status);
+    double radius_inner_deg = s->to_double("radius_inner_deg", status);
+    double radius_outer_deg = s->to_double("radius_outer_deg", status);
+    s->end_group();
+    if (dec0_rad < -99.0)
+    {
+        radius_inner_deg = 0.0;
+        radius_outer_deg = 180.0;
+    }
+    return oskar_sky_read_columns(filename, type, flux_min, flux_max,
+            radius_inner_deg * D2R, radius_outer_deg * D2R,
+            ra0_rad, dec0_rad, status);
+}
+
+
 static void set_up_filter(oskar_Sky* sky, SettingsTree* s,
         double ra0_rad, double dec0_rad, oskar_Log* log, int* status)
 {
@@ -20,11 +20,25 @@ using oskar::SettingsTree;
 #define D2R M_PI/180.0
 
 /* Private functions. */
+static oskar_Telescope* create_telescope(SettingsTree* s, oskar_Log* log,
+        int distributed, int* status);
 static void set_station_data(oskar_Station* station, SettingsTree* s,
         int* status);
 
 oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
         oskar_Log* log, int* status)
+{
+    return create_telescope(s, log, 0, status);
+}
+
+oskar_Telescope* oskar_settings_to_telescope_mpi(SettingsTree* s,
+        oskar_Log* log, int* status)
+{
+    return create_telescope(s, log, 1, status);
+}
+
+static oskar_Telescope* create_telescope(SettingsTree* s, oskar_Log* log,
+        int distributed, int* status)
 {
     if (*status || !s) return 0;
     s->clear_group();
@@ -47,11 +61,17 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
     oskar_telescope_set_enable_numerical_patterns(t,
             s->to_int("telescope/aperture_array/element_pattern/"
                     "enable_numerical", status));
+    oskar_telescope_set_enable_snapshot(t,
+            s->to_int("telescope/use_snapshot", status));
 
     /************************************************************************/
     /* Load telescope model folders to define the stations. */
-    oskar_telescope_load(t,
-            s->to_string("telescope/input_directory", status), log, status);
+    if (distributed)
+        oskar_telescope_load_mpi(t,
+                s->to_string("telescope/input_directory", status), log, status);
+    else
+        oskar_telescope_load(t,
+                s->to_string("telescope/input_directory", status), log, status);
     if (*status) return t;
 
     /* Return if no stations were found. */
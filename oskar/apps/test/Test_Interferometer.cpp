@@ -9,6 +9,8 @@
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_version_string.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -207,3 +209,330 @@ TEST(apps, test_interferometer_modes)
     // Free settings.
     SettingsTree::free(sim_settings);
 }
+
+TEST(apps, test_interferometer_imaging)
+{
+    int status = 0;
+
+    // Create a sky model file and a telescope model directory.
+    const char* sky_model_file = "apps_test_sky.txt";
+    const char* tel_model_dir = "apps_test_telescope.tm";
+    create_sky_model(sky_model_file, &status);
+    create_telescope_model(tel_model_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Set simulator parameters.
+    string test_name = "apps_test_interferometer_imaging";
+    string vis_name = test_name + ".vis";
+    const char* sim_par[] = {
+            "sky/oskar_sky_model/file", sky_model_file,
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "-30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "2",
+            "observation/frequency_inc_hz", "20e6",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "06:00:00.0",
+            "observation/num_time_steps", "12",
+            "telescope/input_directory", tel_model_dir,
+            "interferometer/max_time_samples_per_block", "4",
+            "interferometer/oskar_vis_filename", vis_name.c_str(),
+            "simulator/use_gpus", "false",
+            NULL, NULL
+    };
+    const char* img_par[] = {
+            "image/fov_deg", "2.0",
+            "image/size", "128",
+            "image/weighting", "Uniform",
+            "image/use_gpus", "false",
+            NULL, NULL
+    };
+    SettingsTree* sim_settings = oskar_app_settings_tree(app_interferometer, 0);
+    ASSERT_TRUE(sim_settings->set_values(0, sim_par));
+
+    // Create an imager to image the visibilities as they are simulated.
+    SettingsTree* img_settings = oskar_app_settings_tree(app_imager, 0);
+    ASSERT_TRUE(img_settings->set_values(0, img_par));
+    string root_stream = test_name + "_stream";
+    ASSERT_TRUE(img_settings->set_value("image/root_path",
+            root_stream.c_str()));
+    oskar_Imager* img_stream = oskar_settings_to_imager(
+            img_settings, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Run the simulation with the imager attached.
+    oskar_Interferometer* sim = oskar_settings_to_interferometer(
+            sim_settings, 0, &status);
+    oskar_Sky* sky = oskar_settings_to_sky(sim_settings, 0, &status);
+    oskar_Telescope* tel = oskar_settings_to_telescope(
+            sim_settings, 0, &status);
+    oskar_interferometer_set_telescope_model(sim, tel, &status);
+    oskar_interferometer_set_sky_model(sim, sky, &status);
+    oskar_interferometer_add_imager(sim, img_stream);
+    oskar_interferometer_run(sim, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_interferometer_free(sim, &status);
+    oskar_imager_free(img_stream, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+
+    // Image the visibility file in the usual way.
+    string root_file = test_name + "_file";
+    ASSERT_TRUE(img_settings->set_value("image/root_path", root_file.c_str()));
+    ASSERT_TRUE(img_settings->set_value("image/input_vis_data",
+            vis_name.c_str()));
+    oskar_Imager* img_file = oskar_settings_to_imager(
+            img_settings, 0, &status);
+    oskar_imager_run(img_file, 0, 0, 0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_imager_free(img_file, &status);
+    SettingsTree::free(img_settings);
+    SettingsTree::free(sim_settings);
+
+    // Check the images are the same.
+    int size[2];
+    double crval[2], crpix[2], cellsize = 0.0, time = 0.0, freq = 0.0;
+    double beam_area = 0.0, min_rel = 0.0, max_rel = 0.0, avg = 0.0, std = 0.0;
+    oskar_Mem* image_stream = oskar_mem_read_fits_image_plane(
+            string(root_stream + "_I.fits").c_str(), 0, 0, 0, size, crval,
+            crpix, &cellsize, &time, &freq, &beam_area, 0, &status);
+    oskar_Mem* image_file = oskar_mem_read_fits_image_plane(
+            string(root_file + "_I.fits").c_str(), 0, 0, 0, size, crval,
+            crpix, &cellsize, &time, &freq, &beam_area, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_evaluate_relative_error(image_stream, image_file,
+            &min_rel, &max_rel, &avg, &std, &status);
+    EXPECT_LT(max_rel, 1e-6);
+    oskar_mem_free(image_stream, &status);
+    oskar_mem_free(image_file, &status);
+}
+
+TEST(apps, test_interferometer_device_partition)
+{
+    int status = 0;
+
+    // Create a sky model file and a telescope model directory.
+    const char* sky_model_file = "apps_test_sky.txt";
+    const char* tel_model_dir = "apps_test_telescope.tm";
+    create_sky_model(sky_model_file, &status);
+    create_telescope_model(tel_model_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Use several sky chunks, and a final block shorter than the
+    // number of devices.
+    const char* sim_par[] = {
+            "sky/oskar_sky_model/file", sky_model_file,
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "-30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "2",
+            "observation/frequency_inc_hz", "20e6",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "06:00:00.0",
+            "observation/num_time_steps", "10",
+            "telescope/input_directory", tel_model_dir,
+            "interferometer/max_time_samples_per_block", "4",
+            "interferometer/correlation_type", "Both",
+            "simulator/use_gpus", "false",
+            "simulator/double_precision", "true",
+            "simulator/max_sources_per_chunk", "1",
+            NULL, NULL
+    };
+    const char* modes[] = {"Sky chunk", "Time"};
+    const char* num_devices[] = {"1", "3"};
+    string test_name = "apps_test_interferometer_device_partition";
+    SettingsTree* sim_settings = oskar_app_settings_tree(app_interferometer, 0);
+    ASSERT_TRUE(sim_settings->set_values(0, sim_par));
+    for (int i = 0; i < 3; ++i)
+    {
+        string vis_name = test_name + "_" + string(1, (char)('0' + i)) + ".vis";
+        ASSERT_TRUE(sim_settings->set_value("simulator/num_devices",
+                num_devices[i > 0 ? 1 : 0]));
+        ASSERT_TRUE(sim_settings->set_value("interferometer/device_partition",
+                i > 0 ? modes[i - 1] : "Auto"));
+        ASSERT_TRUE(sim_settings->set_value("interferometer/oskar_vis_filename",
+                vis_name.c_str()));
+        oskar_Interferometer* sim = oskar_settings_to_interferometer(
+                sim_settings, 0, &status);
+        oskar_Sky* sky = oskar_settings_to_sky(sim_settings, 0, &status);
+        oskar_Telescope* tel = oskar_settings_to_telescope(
+                sim_settings, 0, &status);
+        oskar_interferometer_set_telescope_model(sim, tel, &status);
+        oskar_interferometer_set_sky_model(sim, sky, &status);
+        oskar_interferometer_run(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_interferometer_free(sim, &status);
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+    }
+    SettingsTree::free(sim_settings);
+
+    // Check the partitioned outputs match the single-device output.
+    oskar_Binary* file[3];
+    oskar_VisHeader* hdr[3];
+    oskar_VisBlock* block[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        string vis_name = test_name + "_" + string(1, (char)('0' + i)) + ".vis";
+        file[i] = oskar_binary_create(vis_name.c_str(), 'r', &status);
+        hdr[i] = oskar_vis_header_read(file[i], &status);
+        block[i] = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr[i], &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int num_blocks = oskar_vis_header_num_blocks(hdr[0]);
+    EXPECT_EQ(3, num_blocks);
+    for (int b = 0; b < num_blocks; ++b)
+    {
+        for (int i = 0; i < 3; ++i)
+            oskar_vis_block_read(block[i], hdr[i], file[i], b, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int i = 1; i < 3; ++i)
+        {
+            double min_rel = 0.0, max_rel = 0.0, avg = 0.0, std = 0.0;
+            oskar_mem_evaluate_relative_error(
+                    oskar_vis_block_cross_correlations(block[i]),
+                    oskar_vis_block_cross_correlations(block[0]),
+                    &min_rel, &max_rel, &avg, &std, &status);
+            EXPECT_LT(max_rel, 1e-10);
+            oskar_mem_evaluate_relative_error(
+                    oskar_vis_block_auto_correlations(block[i]),
+                    oskar_vis_block_auto_correlations(block[0]),
+                    &min_rel, &max_rel, &avg, &std, &status);
+            EXPECT_LT(max_rel, 1e-10);
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_vis_block_free(block[i], &status);
+        oskar_vis_header_free(hdr[i], &status);
+        oskar_binary_free(file[i]);
+    }
+}
+
+TEST(apps, test_interferometer_facets)
+{
+    int status = 0;
+
+    // Create a sky model of point sources close to the phase centre,
+    // which is low enough that they rise and set during the observation,
+    // and a telescope model directory.
+    const char* sky_model_file = "apps_test_facets_sky.txt";
+    const char* tel_model_dir = "apps_test_telescope.tm";
+    oskar_Sky* sky_in = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    for (int ra = 16; ra <= 24; ++ra)
+    {
+        for (int dec = 27; dec <= 33; ++dec)
+        {
+            // Use pairs of sources, so that facets hold more than one.
+            for (int j = 0; j < 2; ++j)
+            {
+                char line[128];
+                const int i = oskar_sky_num_sources(sky_in);
+                oskar_sky_resize(sky_in, i + 1, &status);
+                sprintf(line, "%.2f %d %.1f", ra + 0.02 * j, dec,
+                        1.0 + 0.1 * i);
+                oskar_sky_set_source_str(sky_in, i, line, &status);
+            }
+        }
+    }
+    oskar_sky_save(sky_in, sky_model_file, &status);
+    oskar_sky_free(sky_in, &status);
+    create_telescope_model(tel_model_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Simulate with and without facets.
+    const char* sim_par[] = {
+            "sky/oskar_sky_model/file", sky_model_file,
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "1",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "12:00:00.0",
+            "observation/num_time_steps", "12",
+            "telescope/input_directory", tel_model_dir,
+            "interferometer/correlation_type", "Both",
+            "interferometer/facet_prediction/min_sources", "1",
+            "interferometer/facet_prediction/pixel_oversample", "16",
+            "interferometer/facet_prediction/facet_size_deg", "0.1",
+            "simulator/use_gpus", "false",
+            "simulator/double_precision", "true",
+            NULL, NULL
+    };
+    string test_name = "apps_test_interferometer_facets";
+    SettingsTree* sim_settings = oskar_app_settings_tree(app_interferometer, 0);
+    ASSERT_TRUE(sim_settings->set_values(0, sim_par));
+    for (int i = 0; i < 2; ++i)
+    {
+        string vis_name = test_name + "_" + string(1, (char)('0' + i)) + ".vis";
+        ASSERT_TRUE(sim_settings->set_value(
+                "interferometer/facet_prediction/enable",
+                i > 0 ? "true" : "false"));
+        ASSERT_TRUE(sim_settings->set_value("interferometer/oskar_vis_filename",
+                vis_name.c_str()));
+        oskar_Interferometer* sim = oskar_settings_to_interferometer(
+                sim_settings, 0, &status);
+        oskar_Sky* sky = oskar_settings_to_sky(sim_settings, 0, &status);
+        oskar_Telescope* tel = oskar_settings_to_telescope(
+                sim_settings, 0, &status);
+        oskar_interferometer_set_telescope_model(sim, tel, &status);
+        oskar_interferometer_set_sky_model(sim, sky, &status);
+        oskar_interferometer_run(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_interferometer_free(sim, &status);
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+    }
+    SettingsTree::free(sim_settings);
+
+    // The auto-correlations are evaluated for each source, so they must
+    // match exactly. The cross-correlations must agree to within the
+    // accuracy of the facet prediction, so sources below the horizon
+    // must not be included.
+    oskar_Binary* file[2];
+    oskar_VisHeader* hdr[2];
+    oskar_VisBlock* block[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        string vis_name = test_name + "_" + string(1, (char)('0' + i)) + ".vis";
+        file[i] = oskar_binary_create(vis_name.c_str(), 'r', &status);
+        hdr[i] = oskar_vis_header_read(file[i], &status);
+        block[i] = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr[i], &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int num_blocks = oskar_vis_header_num_blocks(hdr[0]);
+    for (int b = 0; b < num_blocks; ++b)
+    {
+        double min_rel = 0.0, max_rel = 0.0, avg = 0.0, std = 0.0;
+        for (int i = 0; i < 2; ++i)
+            oskar_vis_block_read(block[i], hdr[i], file[i], b, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_mem_evaluate_relative_error(
+                oskar_vis_block_auto_correlations(block[1]),
+                oskar_vis_block_auto_correlations(block[0]),
+                &min_rel, &max_rel, &avg, &std, &status);
+        EXPECT_LT(max_rel, 1e-10);
+        const oskar_Mem* xc[] = {
+                oskar_vis_block_cross_correlations(block[0]),
+                oskar_vis_block_cross_correlations(block[1])
+        };
+        const double* v0 = oskar_mem_double_const(xc[0], &status);
+        const double* v1 = oskar_mem_double_const(xc[1], &status);
+        const size_t n = 8 * oskar_mem_length(xc[0]);
+        double max_diff = 0.0, peak = 0.0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            max_diff = std::max(max_diff, fabs(v1[j] - v0[j]));
+            peak = std::max(peak, fabs(v0[j]));
+        }
+        EXPECT_LT(max_diff, 1e-2 * peak);
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_vis_block_free(block[i], &status);
+        oskar_vis_header_free(hdr[i], &status);
+        oskar_binary_free(file[i]);
+    }
+}
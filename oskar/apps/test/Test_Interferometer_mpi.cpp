@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "apps/oskar_apps.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_mpi.h"
+
+#include <cstdio>
+#include <string>
+
+using oskar::SettingsTree;
+using std::string;
+
+void create_sky_model(const char* filename, int* status);
+void create_telescope_model(const char* filename, int* status);
+
+static void compare_vis(const char* file1, const char* file2)
+{
+    int status = 0;
+    oskar_Binary* f[2];
+    oskar_VisHeader* hdr[2];
+    oskar_VisBlock* block[2];
+    const char* names[] = {file1, file2};
+    for (int i = 0; i < 2; ++i)
+    {
+        f[i] = oskar_binary_create(names[i], 'r', &status);
+        hdr[i] = oskar_vis_header_read(f[i], &status);
+        block[i] = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr[i], &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const int num_blocks = oskar_vis_header_num_blocks(hdr[0]);
+    ASSERT_EQ(num_blocks, oskar_vis_header_num_blocks(hdr[1]));
+    for (int b = 0; b < num_blocks; ++b)
+    {
+        double min_rel = 0.0, max_rel = 0.0, avg = 0.0, std = 0.0;
+        for (int i = 0; i < 2; ++i)
+            oskar_vis_block_read(block[i], hdr[i], f[i], b, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(oskar_vis_block_start_time_index(block[0]),
+                oskar_vis_block_start_time_index(block[1]));
+        oskar_mem_evaluate_relative_error(
+                oskar_vis_block_cross_correlations(block[1]),
+                oskar_vis_block_cross_correlations(block[0]),
+                &min_rel, &max_rel, &avg, &std, &status);
+        EXPECT_LT(max_rel, 1e-10);
+        oskar_mem_evaluate_relative_error(
+                oskar_vis_block_auto_correlations(block[1]),
+                oskar_vis_block_auto_correlations(block[0]),
+                &min_rel, &max_rel, &avg, &std, &status);
+        EXPECT_LT(max_rel, 1e-10);
+        for (int j = 0; j < 3; ++j)
+        {
+            oskar_mem_evaluate_relative_error(
+                    oskar_vis_block_baseline_uvw_metres(block[1], j),
+                    oskar_vis_block_baseline_uvw_metres(block[0], j),
+                    &min_rel, &max_rel, &avg, &std, &status);
+            EXPECT_LT(max_rel, 1e-10);
+        }
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_vis_block_free(block[i], &status);
+        oskar_vis_header_free(hdr[i], &status);
+        oskar_binary_free(f[i]);
+    }
+}
+
+TEST(apps_mpi, test_interferometer_distributed)
+{
+    int status = 0;
+    const int rank = oskar_mpi_rank();
+    printf("Process %d of %d\n", rank, oskar_mpi_size());
+
+    // Only the first process needs the input files.
+    const char* sky_model_file = "apps_test_mpi_sky.txt";
+    const char* tel_model_dir = "apps_test_mpi_telescope.tm";
+    if (rank == 0)
+    {
+        create_sky_model(sky_model_file, &status);
+        create_telescope_model(tel_model_dir, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Use a number of blocks that is not a multiple of the process count.
+    const char* sim_par[] = {
+            "sky/oskar_sky_model/file", sky_model_file,
+            "observation/phase_centre_ra_deg", "20.0",
+            "observation/phase_centre_dec_deg", "-30.0",
+            "observation/start_frequency_hz", "100e6",
+            "observation/num_channels", "2",
+            "observation/frequency_inc_hz", "20e6",
+            "observation/start_time_utc", "2000-01-01 12:00:00.0",
+            "observation/length", "06:00:00.0",
+            "observation/num_time_steps", "9",
+            "telescope/input_directory", tel_model_dir,
+            "interferometer/max_time_samples_per_block", "2",
+            "interferometer/correlation_type", "Both",
+            "interferometer/oskar_vis_filename", "apps_test_mpi.vis",
+            "simulator/use_gpus", "false",
+            "simulator/double_precision", "true",
+            NULL, NULL
+    };
+    SettingsTree* s = oskar_app_settings_tree("oskar_sim_interferometer", 0);
+    ASSERT_TRUE(s->set_values(0, sim_par));
+
+    // Read the models on the first process only, and share them.
+    oskar_Sky* sky = (rank == 0) ? oskar_settings_to_sky(s, 0, &status) :
+            oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_sky_bcast(sky, 0, &status);
+    oskar_Telescope* tel = oskar_settings_to_telescope_mpi(s, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(3, oskar_sky_num_sources(sky));
+
+    // Run the simulation across all processes.
+    oskar_Interferometer* sim = oskar_settings_to_interferometer(s, 0, &status);
+    oskar_interferometer_set_telescope_model(sim, tel, &status);
+    oskar_interferometer_set_sky_model(sim, sky, &status);
+    oskar_interferometer_run(sim, &status);
+    oskar_interferometer_free(sim, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the output against a run using only the first process.
+    if (rank == 0)
+    {
+        ASSERT_TRUE(s->set_value("interferometer/oskar_vis_filename",
+                "apps_test_mpi_ref.vis"));
+        sim = oskar_settings_to_interferometer(s, 0, &status);
+        oskar_interferometer_set_use_mpi(sim, 0);
+        oskar_interferometer_set_telescope_model(sim, tel, &status);
+        oskar_interferometer_set_sky_model(sim, sky, &status);
+        oskar_interferometer_run(sim, &status);
+        oskar_interferometer_free(sim, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        compare_vis("apps_test_mpi_ref.vis", "apps_test_mpi.vis");
+    }
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    SettingsTree::free(s);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_mpi.h"
+
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    int status = 0;
+    oskar_mpi_init(&argc, &argv, &status);
+    if (status)
+    {
+        fprintf(stderr, "%s\n", oskar_get_error_string(status));
+        oskar_mpi_finalise();
+        return status;
+    }
+    ::testing::InitGoogleTest(&argc, argv);
+
+    // Report results only from the first process.
+    if (oskar_mpi_rank() > 0)
+    {
+        ::testing::TestEventListeners& listeners =
+                ::testing::UnitTest::GetInstance()->listeners();
+        delete listeners.Release(listeners.default_result_printer());
+    }
+    int val = RUN_ALL_TESTS();
+    oskar_device_reset_all();
+    if (val) oskar_mpi_abort(val);
+    oskar_mpi_finalise();
+    return val;
+}
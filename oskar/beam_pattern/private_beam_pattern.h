@@ -65,6 +65,7 @@ struct oskar_BeamPattern
 {
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
+    int num_cpu_threads; /* OpenMP threads used by each CPU device. */
     int max_chunk_size;
     int num_time_steps, num_channels, num_chunks;
     int pol_mode, width, height, nside;
@@ -11,6 +11,7 @@
 #include "math/private_cond2_2x2.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_file_exists.h"
+#include "utility/oskar_get_num_procs.h"
 #include "oskar_version.h"
 
 #include <stdlib.h>
@@ -580,6 +581,16 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_beam_pattern_set_num_devices(h, h->num_gpus);
 
+    /* Share the available cores between the CPU devices, so that kernels
+     * using multiple threads do not oversubscribe the host. */
+    h->num_cpu_threads = 1;
+    if (h->num_devices > h->num_gpus)
+    {
+        h->num_cpu_threads = (oskar_get_num_procs() - h->num_gpus) /
+                (h->num_devices - h->num_gpus);
+        if (h->num_cpu_threads < 1) h->num_cpu_threads = 1;
+    }
+
     for (i = 0; i < h->num_devices; ++i)
     {
         int dev_loc, i_stokes_type;
@@ -694,7 +705,10 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
 
         /* Timers. */
         if (!d->tmr_compute)
+        {
             d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
+            oskar_timer_set_name(d->tmr_compute, "Compute");
+        }
     }
 }
 
@@ -14,6 +14,7 @@
 #include "utility/oskar_file_exists.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_trace.h"
 #include "oskar_version.h"
 
 #include <stdlib.h>
@@ -175,9 +176,10 @@ static void* run_blocks(void* arg)
     const int device_id = thread_id - 1;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism, but allow kernels on CPU devices
+     * to use their share of the available cores. */
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    omp_set_num_threads(device_id >= h->num_gpus ? h->num_cpu_threads : 1);
 #endif
 
     if (device_id >= 0 && device_id < h->num_gpus)
@@ -264,6 +266,10 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
     if (i_chunk >= h->num_chunks) return;
 
     /* Get time and frequency values. */
+    oskar_trace_set_context(OSKAR_TRACE_DEVICE, device_id);
+    oskar_trace_set_context(OSKAR_TRACE_TIME, i_time);
+    oskar_trace_set_context(OSKAR_TRACE_CHUNK, i_chunk);
+    oskar_trace_set_context(OSKAR_TRACE_CHANNEL, i_channel);
     oskar_timer_resume(d->tmr_compute);
     const double dt_dump = h->time_inc_sec / 86400.0;
     const double mjd = h->time_start_mjd_utc + dt_dump * (i_time + 0.5);
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "correlate/oskar_auto_correlate.h"
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_lod.h"
+#include "interferometer/oskar_jones.h"
+#include "telescope/oskar_telescope.h"
+
+#include <cmath>
+#include <cstring>
+
+static void correlate(oskar::BenchmarkState& state, int cross, int matrix)
+{
+    const int num_stations = state.arg(0);
+    const int num_sources = state.arg(1);
+    const int use_extended = state.arg(2) & 1;
+    const int smearing = state.arg(3);
+    const int type = state.precision(), location = state.location();
+    int* status = state.status();
+    const int jones_type = type | OSKAR_COMPLEX | (matrix ? OSKAR_MATRIX : 0);
+
+    // Create arrays and fill inputs with random data in sensible ranges.
+    oskar_Mem *src_dir[3], *src_ext[3], *src_flux[4], *uvw[3];
+    oskar_Telescope* tel = oskar_telescope_create(
+            type, location, num_stations, status);
+    oskar_Jones* J = oskar_jones_create(
+            jones_type, location, num_stations, num_sources, status);
+    oskar_Mem* vis = oskar_mem_create(jones_type, location,
+            cross ? oskar_telescope_num_baselines(tel) : num_stations, status);
+    for (int i = 0; i < 4; ++i)
+        src_flux[i] = oskar_mem_create(type, location, num_sources, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        src_dir[i] = oskar_mem_create(type, location, num_sources, status);
+        src_ext[i] = oskar_mem_create(type, location, num_sources, status);
+        uvw[i] = oskar_mem_create(type, location, num_stations, status);
+        oskar_mem_random_range(uvw[i], 1.0, 5.0, status);
+        oskar_mem_random_range(src_dir[i], 0.1, 0.9, status);
+        oskar_mem_random_range(src_ext[i], 0.1e-6, 0.2e-6, status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, i),
+                0.1, 1000.0, status);
+    }
+    oskar_mem_random_range(oskar_jones_mem(J), 1.0, 5.0, status);
+    oskar_mem_random_range(src_flux[0], 1.0, 2.0, status);
+    oskar_mem_random_range(src_flux[1], 0.1, 1.0, status);
+    oskar_mem_random_range(src_flux[2], 0.1, 0.5, status);
+    oskar_mem_random_range(src_flux[3], 0.1, 0.2, status);
+
+    // Bit 0 enables bandwidth smearing; bit 1 enables time smearing.
+    oskar_telescope_set_channel_bandwidth(tel, (smearing & 1) ? 10e6 : 0.0);
+    oskar_telescope_set_time_average(tel, (smearing & 2) ? 10.0 : 0.0);
+
+    // Run the benchmark.
+    while (state.running())
+    {
+        if (cross)
+            oskar_cross_correlate(use_extended, num_sources, J,
+                    src_flux, src_dir, src_ext, tel, uvw, 0.0, 100e6,
+                    0, vis, status);
+        else
+            oskar_auto_correlate(num_sources, J, src_flux, 0, vis, status);
+    }
+    state.set_items_processed((double) num_sources *
+            (cross ? oskar_telescope_num_baselines(tel) : num_stations));
+
+    // Free memory.
+    oskar_mem_free(vis, status);
+    oskar_jones_free(J, status);
+    oskar_telescope_free(tel, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(src_dir[i], status);
+        oskar_mem_free(src_ext[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    for (int i = 0; i < 4; ++i)
+        oskar_mem_free(src_flux[i], status);
+}
+
+static void bench_cross_correlate(oskar::BenchmarkState& state)
+{
+    correlate(state, 1, 1);
+}
+
+static void bench_cross_correlate_scalar(oskar::BenchmarkState& state)
+{
+    correlate(state, 1, 0);
+}
+
+static void bench_auto_correlate(oskar::BenchmarkState& state)
+{
+    correlate(state, 0, 1);
+}
+
+static void bench_cross_correlate_lod(oskar::BenchmarkState& state)
+{
+    const int num_stations = state.arg(0);
+    const int num_sources = state.arg(1);
+    const double tolerance = 1e-3 * state.arg(2);
+    const int type = state.precision();
+    int* status = state.status();
+    const int jones_type = type | OSKAR_COMPLEX | OSKAR_MATRIX;
+    double num_terms = 0.0, num_terms_exact = 0.0, max_error = 0.0;
+
+    // A compact array, and a field of mostly faint, weakly polarised
+    // point sources.
+    oskar_Mem *src_dir[3], *src_flux[4], *uvw[3];
+    oskar_Telescope* tel = oskar_telescope_create(
+            type, OSKAR_CPU, num_stations, status);
+    oskar_Jones* J = oskar_jones_create(
+            jones_type, OSKAR_CPU, num_stations, num_sources, status);
+    oskar_Mem* vis = oskar_mem_create(jones_type, OSKAR_CPU,
+            oskar_telescope_num_baselines(tel), status);
+    for (int i = 0; i < 4; ++i)
+    {
+        src_flux[i] = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+        oskar_mem_random_range(src_flux[i], 0.0, i == 0 ? 1.0 : 0.01, status);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        src_dir[i] = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+        uvw[i] = oskar_mem_create(type, OSKAR_CPU, num_stations, status);
+        oskar_mem_random_range(uvw[i], -50.0, 50.0, status);
+        oskar_mem_random_range(src_dir[i], -0.1, 0.1, status);
+    }
+    oskar_mem_random_range(oskar_jones_mem(J), 0.9, 1.0, status);
+    if (type == OSKAR_DOUBLE)
+    {
+        double* I = oskar_mem_double(src_flux[0], status);
+        double* n = oskar_mem_double(src_dir[2], status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            I[i] = 0.1 * pow(I[i], 8.0);
+            n[i] = 1.0;
+        }
+    }
+    else
+    {
+        float* I = oskar_mem_float(src_flux[0], status);
+        float* n = oskar_mem_float(src_dir[2], status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            I[i] = (float) (0.1 * pow(I[i], 8.0));
+            n[i] = 1.0f;
+        }
+    }
+    for (int i = 1; i < 4; ++i)
+        oskar_mem_multiply(src_flux[i], src_flux[i], src_flux[0],
+                0, 0, 0, num_sources, status);
+
+    // Put the sources into tree order, as the simulator does.
+    oskar_SourceTree* tree = oskar_source_tree_create();
+    oskar_source_tree_build(tree, num_sources, src_dir, status);
+    const int* order = oskar_source_tree_order(tree);
+    for (int i = 0; i < 7 && !*status; ++i)
+    {
+        oskar_Mem* src = i < 3 ? src_dir[i] : src_flux[i - 3];
+        oskar_Mem* t = oskar_mem_create_copy(src, OSKAR_CPU, status);
+        const size_t size = oskar_mem_element_size(type);
+        const char* from = (const char*) oskar_mem_void_const(t);
+        char* to = (char*) oskar_mem_void(src);
+        for (int j = 0; j < num_sources; ++j)
+            memcpy(to + j * size, from + order[j] * size, size);
+        oskar_mem_free(t, status);
+    }
+    oskar_source_tree_build(tree, num_sources, src_dir, status);
+
+    // Run the benchmark.
+    while (state.running())
+    {
+        oskar_cross_correlate_lod(tree, tolerance, num_sources, J,
+                src_flux, src_dir, tel, uvw, 0.0, 100e6, 0, vis,
+                &num_terms, &num_terms_exact, &max_error, status);
+    }
+    state.set_items_processed((double) num_sources *
+            oskar_telescope_num_baselines(tel));
+
+    // Free memory.
+    oskar_source_tree_free(tree);
+    oskar_mem_free(vis, status);
+    oskar_jones_free(J, status);
+    oskar_telescope_free(tel, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(src_dir[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    for (int i = 0; i < 4; ++i)
+        oskar_mem_free(src_flux[i], status);
+}
+
+// Cover point and Gaussian sources with each combination of
+// bandwidth (1) and time (2) smearing.
+OSKAR_BENCHMARK("cross_correlate", bench_cross_correlate,
+        "stations,sources,gaussian,smearing")
+        ->args(32, 256, 0, 0)->args(32, 256, 0, 1)
+        ->args(32, 256, 0, 2)->args(32, 256, 0, 3)
+        ->args(32, 256, 1, 0)->args(32, 256, 1, 3)
+        ->args(128, 1024, 0, 0)->args(128, 1024, 0, 3)
+        ->args(128, 1024, 1, 0)->args(128, 1024, 1, 3)
+        ->args(512, 1024, 0, 0)->args(512, 1024, 0, 3);
+
+OSKAR_BENCHMARK("cross_correlate_scalar", bench_cross_correlate_scalar,
+        "stations,sources,gaussian,smearing")
+        ->args(32, 256, 0, 0)->args(32, 256, 1, 3)
+        ->args(128, 1024, 0, 0)->args(128, 1024, 0, 3)
+        ->args(128, 1024, 1, 3)->args(512, 1024, 0, 0);
+
+OSKAR_BENCHMARK("auto_correlate", bench_auto_correlate,
+        "stations,sources")
+        ->args(32, 256)->args(128, 1024)->args(512, 16384);
+
+// Items processed are the source terms of the exact correlator, so rates
+// can be compared with those of cross_correlate for point sources.
+OSKAR_BENCHMARK("cross_correlate_lod", bench_cross_correlate_lod,
+        "stations,sources,tolerance_mjy")
+        ->args(128, 16384, 0)->args(128, 16384, 10)->args(128, 16384, 100)->args(128, 16384, 1000)
+        ->cpu_only();
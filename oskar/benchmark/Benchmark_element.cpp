@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "math/oskar_cmath.h"
+#include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
+
+static void element_evaluate(oskar::BenchmarkState& state, const char* type,
+        const char* taper)
+{
+    const int num_points = state.arg(0);
+    const int prec = state.precision(), location = state.location();
+    int* status = state.status();
+
+    // Create the element model and random directions above the horizon.
+    oskar_Element* element = oskar_element_create(prec, location, status);
+    oskar_element_set_element_type(element, type, status);
+    oskar_element_set_taper_type(element, taper, status);
+    oskar_element_set_gaussian_fwhm_rad(element, 45.0 * M_PI / 180.0);
+    oskar_Mem *dir[3], *theta, *phi_x, *phi_y, *output;
+    for (int i = 0; i < 3; ++i)
+        dir[i] = oskar_mem_create(prec, location, num_points, status);
+    oskar_mem_random_range(dir[0], -0.7, 0.7, status);
+    oskar_mem_random_range(dir[1], -0.7, 0.7, status);
+    oskar_mem_random_range(dir[2], 0.1, 1.0, status);
+    theta = oskar_mem_create(prec, location, 0, status);
+    phi_x = oskar_mem_create(prec, location, 0, status);
+    phi_y = oskar_mem_create(prec, location, 0, status);
+    output = oskar_mem_create(prec | OSKAR_COMPLEX | OSKAR_MATRIX, location,
+            num_points, status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_element_evaluate(element, 0, 0, M_PI / 2.0, 0.0, 0,
+                num_points, dir[0], dir[1], dir[2], 100e6,
+                theta, phi_x, phi_y, 0, output, status);
+    state.set_items_processed((double) num_points);
+
+    // Free memory.
+    for (int i = 0; i < 3; ++i)
+        oskar_mem_free(dir[i], status);
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi_x, status);
+    oskar_mem_free(phi_y, status);
+    oskar_mem_free(output, status);
+    oskar_element_free(element, status);
+}
+
+static void bench_element_evaluate_dipole(oskar::BenchmarkState& state)
+{
+    element_evaluate(state, "Dipole", "None");
+}
+
+static void bench_element_evaluate_isotropic(oskar::BenchmarkState& state)
+{
+    element_evaluate(state, "Isotropic", "Gaussian");
+}
+
+OSKAR_BENCHMARK("element_evaluate_dipole", bench_element_evaluate_dipole,
+        "points")->args(4096)->args(65536)->args(1048576);
+
+OSKAR_BENCHMARK("element_evaluate_isotropic",
+        bench_element_evaluate_isotropic,
+        "points")->args(4096)->args(65536)->args(1048576);
+
+static void bench_spherical_wave_sum(oskar::BenchmarkState& state)
+{
+    const int num_points = state.arg(0), l_max = state.arg(1);
+    const int prec = state.precision(), location = state.location();
+    const int type = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    int* status = state.status();
+
+    // Create random coefficients and directions above the horizon.
+    oskar_Mem *theta, *phi_x, *phi_y, *alpha, *output;
+    theta = oskar_mem_create(prec, location, num_points, status);
+    phi_x = oskar_mem_create(prec, location, num_points, status);
+    phi_y = oskar_mem_create(prec, location, num_points, status);
+    alpha = oskar_mem_create(type, location,
+            (l_max + 1) * (l_max + 1) - 1, status);
+    output = oskar_mem_create(type, location, num_points, status);
+    oskar_mem_random_range(theta, 0.0, M_PI / 2.0, status);
+    oskar_mem_random_range(phi_x, -M_PI, M_PI, status);
+    oskar_mem_random_range(phi_y, -M_PI, M_PI, status);
+    oskar_mem_random_range(alpha, -1.0, 1.0, status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_evaluate_spherical_wave_sum(num_points, theta, phi_x, phi_y,
+                l_max, alpha, 0, output, status);
+    state.set_items_processed((double) num_points);
+
+    // Free memory.
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi_x, status);
+    oskar_mem_free(phi_y, status);
+    oskar_mem_free(alpha, status);
+    oskar_mem_free(output, status);
+}
+
+OSKAR_BENCHMARK("spherical_wave_sum", bench_spherical_wave_sum,
+        "points,l_max")->args(4096, 5)->args(4096, 10)->args(4096, 20)
+        ->args(4096, 30)->args(65536, 30);
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj2.h"
+#include "math/oskar_cmath.h"
+#include "mem/oskar_mem.h"
+
+#include <vector>
+
+struct GridData
+{
+    oskar_Mem *uu, *vv, *ww, *vis, *weight, *grid;
+    double cell_size_rad;
+};
+
+static void create_grid_data(GridData& d, int type, int num_points,
+        int grid_size, int* status)
+{
+    // Scale the baseline coordinates so they almost fill the grid.
+    const double fov_rad = 2.0 * M_PI / 180.0;
+    const double max_uv = 0.45 * grid_size / fov_rad;
+    d.cell_size_rad = fov_rad / grid_size;
+    d.uu = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    d.vv = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    d.ww = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    d.vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_points, status);
+    d.weight = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    d.grid = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            (size_t) grid_size * grid_size, status);
+    oskar_mem_random_range(d.uu, -max_uv, max_uv, status);
+    oskar_mem_random_range(d.vv, -max_uv, max_uv, status);
+    oskar_mem_random_range(d.ww, -max_uv, max_uv, status);
+    oskar_mem_random_range(d.vis, -1.0, 1.0, status);
+    oskar_mem_set_value_real(d.weight, 1.0, 0, num_points, status);
+}
+
+static void free_grid_data(GridData& d, int* status)
+{
+    oskar_mem_free(d.uu, status);
+    oskar_mem_free(d.vv, status);
+    oskar_mem_free(d.ww, status);
+    oskar_mem_free(d.vis, status);
+    oskar_mem_free(d.weight, status);
+    oskar_mem_free(d.grid, status);
+}
+
+static void bench_grid_simple(oskar::BenchmarkState& state)
+{
+    const int num_points = state.arg(0);
+    const int grid_size = state.arg(1);
+    const int type = state.precision();
+    const int support = 3, oversample = 100;
+    size_t num_skipped = 0;
+    double norm = 0.0;
+    int* status = state.status();
+
+    // Create a separable kernel in the same format as the imager.
+    GridData d;
+    create_grid_data(d, type, num_points, grid_size, status);
+    const int conv_size = (support + 2) * oversample;
+    oskar_Mem* conv_func = oskar_mem_create(type, OSKAR_CPU, conv_size, status);
+    oskar_mem_random_range(conv_func, 0.0, 1.0, status);
+
+    // Run the benchmark.
+    while (state.running())
+    {
+        if (type == OSKAR_DOUBLE)
+            oskar_grid_simple_d(support, oversample,
+                    oskar_mem_double_const(conv_func, status),
+                    (size_t) num_points,
+                    oskar_mem_double_const(d.uu, status),
+                    oskar_mem_double_const(d.vv, status),
+                    oskar_mem_double_const(d.vis, status),
+                    oskar_mem_double_const(d.weight, status),
+                    d.cell_size_rad, grid_size, &num_skipped, &norm,
+                    oskar_mem_double(d.grid, status));
+        else
+            oskar_grid_simple_f(support, oversample,
+                    oskar_mem_float_const(conv_func, status),
+                    (size_t) num_points,
+                    oskar_mem_float_const(d.uu, status),
+                    oskar_mem_float_const(d.vv, status),
+                    oskar_mem_float_const(d.vis, status),
+                    oskar_mem_float_const(d.weight, status),
+                    (float) d.cell_size_rad, grid_size, &num_skipped, &norm,
+                    oskar_mem_float(d.grid, status));
+    }
+    state.set_items_processed((double) num_points);
+
+    // Free memory.
+    oskar_mem_free(conv_func, status);
+    free_grid_data(d, status);
+}
+
+static void bench_grid_wproj2(oskar::BenchmarkState& state)
+{
+    const int num_points = state.arg(0);
+    const int grid_size = state.arg(1);
+    const int num_w_planes = state.arg(2);
+    const int type = state.precision();
+    const int oversample = 4;
+    size_t num_skipped = 0;
+    double norm = 0.0;
+    int* status = state.status();
+
+    // Create compacted kernels with support growing from 4 to 16 with w,
+    // in the same format as the imager.
+    GridData d;
+    create_grid_data(d, type, num_points, grid_size, status);
+    std::vector<int> support(num_w_planes), kernel_start(num_w_planes);
+    size_t kernel_len = 0;
+    for (int i = 0; i < num_w_planes; ++i)
+    {
+        support[i] = 4 + (12 * i) / (num_w_planes > 1 ? num_w_planes - 1 : 1);
+        const int conv_len = 2 * support[i] + 1;
+        const int width = (oversample / 2 * conv_len + 1) * conv_len;
+        kernel_start[i] = (int) kernel_len;
+        kernel_len += (size_t) (oversample / 2 + 1) * width;
+    }
+    oskar_Mem* conv_func = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            kernel_len, status);
+    oskar_mem_random_range(conv_func, -1.0, 1.0, status);
+    const double max_w = 0.45 * grid_size / (2.0 * M_PI / 180.0);
+    const double w_scale = pow(num_w_planes - 1, 2) / max_w;
+
+    // Run the benchmark.
+    while (state.running())
+    {
+        if (type == OSKAR_DOUBLE)
+            oskar_grid_wproj2_d((size_t) num_w_planes, &support[0],
+                    oversample, &kernel_start[0],
+                    oskar_mem_double_const(conv_func, status),
+                    (size_t) num_points,
+                    oskar_mem_double_const(d.uu, status),
+                    oskar_mem_double_const(d.vv, status),
+                    oskar_mem_double_const(d.ww, status),
+                    oskar_mem_double_const(d.vis, status),
+                    oskar_mem_double_const(d.weight, status),
+                    d.cell_size_rad, w_scale, grid_size, &num_skipped, &norm,
+                    oskar_mem_double(d.grid, status));
+        else
+            oskar_grid_wproj2_f((size_t) num_w_planes, &support[0],
+                    oversample, &kernel_start[0],
+                    oskar_mem_float_const(conv_func, status),
+                    (size_t) num_points,
+                    oskar_mem_float_const(d.uu, status),
+                    oskar_mem_float_const(d.vv, status),
+                    oskar_mem_float_const(d.ww, status),
+                    oskar_mem_float_const(d.vis, status),
+                    oskar_mem_float_const(d.weight, status),
+                    (float) d.cell_size_rad, (float) w_scale, grid_size,
+                    &num_skipped, &norm, oskar_mem_float(d.grid, status));
+    }
+    state.set_items_processed((double) num_points);
+
+    // Free memory.
+    oskar_mem_free(conv_func, status);
+    free_grid_data(d, status);
+}
+
+OSKAR_BENCHMARK("grid_simple", bench_grid_simple, "points,grid")
+        ->args(65536, 1024)->args(1048576, 1024)->args(1048576, 4096)
+        ->cpu_only();
+
+OSKAR_BENCHMARK("grid_wproj2", bench_grid_wproj2, "points,grid,w_planes")
+        ->args(65536, 1024, 16)->args(1048576, 1024, 16)
+        ->args(1048576, 4096, 64)->cpu_only();
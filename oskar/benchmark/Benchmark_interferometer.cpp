@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
+
+static void bench_evaluate_jones_K(oskar::BenchmarkState& state)
+{
+    const int num_stations = state.arg(0);
+    const int num_sources = state.arg(1);
+    const int type = state.precision(), location = state.location();
+    int* status = state.status();
+
+    // Create source directions, fluxes and station coordinates.
+    // No sources are removed by the flux filter.
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, location,
+            num_stations, num_sources, status);
+    oskar_Mem *lmn[3], *uvw[3];
+    oskar_Mem* flux = oskar_mem_create(type, location, num_sources, status);
+    oskar_mem_random_range(flux, 0.0, 1.0, status);
+    for (int i = 0; i < 3; ++i)
+    {
+        lmn[i] = oskar_mem_create(type, location, num_sources, status);
+        uvw[i] = oskar_mem_create(type, location, num_stations, status);
+        oskar_mem_random_range(lmn[i], -1.0, 1.0, status);
+        oskar_mem_random_range(uvw[i], -1000.0, 1000.0, status);
+    }
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_evaluate_jones_K(K, num_sources, lmn[0], lmn[1], lmn[2],
+                uvw[0], uvw[1], uvw[2], 100e6, flux, -1.0, 2.0, 0, status);
+    state.set_items_processed((double) num_stations * num_sources);
+
+    // Free memory.
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(lmn[i], status);
+        oskar_mem_free(uvw[i], status);
+    }
+    oskar_mem_free(flux, status);
+    oskar_jones_free(K, status);
+}
+
+OSKAR_BENCHMARK("evaluate_jones_K", bench_evaluate_jones_K,
+        "stations,sources")
+        ->args(32, 1024)->args(128, 16384)->args(512, 65536);
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_fft.h"
+
+static void bench_dftw(oskar::BenchmarkState& state)
+{
+    const int num_elements = state.arg(0);
+    const int num_directions = state.arg(1);
+    const int matrix = state.arg(2);
+    const int type = state.precision(), location = state.location();
+    const int cplx = type | OSKAR_COMPLEX | (matrix ? OSKAR_MATRIX : 0);
+    int* status = state.status();
+
+    // Create element positions, directions and weights.
+    // All elements share one (element pattern) data set.
+    oskar_Mem *x_in[3], *x_out[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        x_in[i] = oskar_mem_create(type, location, num_elements, status);
+        x_out[i] = oskar_mem_create(type, location, num_directions, status);
+        oskar_mem_random_range(x_in[i], -20.0, 20.0, status);
+        oskar_mem_random_range(x_out[i], -0.5, 0.5, status);
+    }
+    oskar_Mem* weights = oskar_mem_create(type | OSKAR_COMPLEX, location,
+            num_elements, status);
+    oskar_Mem* data_idx = oskar_mem_create(OSKAR_INT, location,
+            num_elements, status);
+    oskar_Mem* data = oskar_mem_create(cplx, location, num_directions, status);
+    oskar_Mem* output = oskar_mem_create(cplx, location,
+            num_directions, status);
+    oskar_mem_random_range(weights, -1.0, 1.0, status);
+    oskar_mem_random_range(data, -1.0, 1.0, status);
+    oskar_mem_clear_contents(data_idx, status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_dftw(0, num_elements, 2.0 * M_PI, weights,
+                x_in[0], x_in[1], x_in[2], 0, num_directions,
+                x_out[0], x_out[1], x_out[2], data_idx, data, 1, 1,
+                0, output, status);
+    state.set_items_processed((double) num_elements * num_directions);
+
+    // Free memory.
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(x_in[i], status);
+        oskar_mem_free(x_out[i], status);
+    }
+    oskar_mem_free(weights, status);
+    oskar_mem_free(data_idx, status);
+    oskar_mem_free(data, status);
+    oskar_mem_free(output, status);
+}
+
+static void bench_fft_exec(oskar::BenchmarkState& state)
+{
+    const int grid_size = state.arg(0);
+    const int type = state.precision(), location = state.location();
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    int* status = state.status();
+
+    // Transform a random 2D grid in place.
+    oskar_FFT* fft = oskar_fft_create(type, location, 2, grid_size, 0, status);
+    oskar_Mem* grid = oskar_mem_create(type | OSKAR_COMPLEX, location,
+            num_cells, status);
+    oskar_mem_random_range(grid, -1.0, 1.0, status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_fft_exec(fft, grid, status);
+    state.set_items_processed((double) num_cells);
+
+    // Free memory.
+    oskar_mem_free(grid, status);
+    oskar_fft_free(fft);
+}
+
+OSKAR_BENCHMARK("dftw", bench_dftw, "elements,directions,matrix")
+        ->args(256, 4096, 0)->args(256, 4096, 1)
+        ->args(1024, 16384, 0)->args(1024, 16384, 1);
+
+OSKAR_BENCHMARK("fft_exec", bench_fft_exec, "grid")
+        ->args(256)->args(1024)->args(2048)->args(4096);
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/station/oskar_station_work.h"
+
+static void bench_sky_horizon_clip(oskar::BenchmarkState& state)
+{
+    const int num_sources = state.arg(0);
+    const int num_stations = state.arg(1);
+    const int type = state.precision(), location = state.location();
+    const double deg2rad = M_PI / 180.0;
+    int* status = state.status();
+
+    // Create a sky model with sources over the whole sphere.
+    oskar_Sky* sky_cpu = oskar_sky_create(type, OSKAR_CPU, num_sources, status);
+    oskar_mem_random_range(oskar_sky_ra_rad(sky_cpu), 0.0, 2.0 * M_PI, status);
+    oskar_mem_random_range(oskar_sky_dec_rad(sky_cpu),
+            -M_PI / 2.0, M_PI / 2.0, status);
+    oskar_mem_random_range(oskar_sky_I(sky_cpu), 1.0, 10.0, status);
+    oskar_sky_evaluate_relative_directions(sky_cpu, 0.0, -M_PI / 4.0, status);
+    oskar_Sky* sky_in = oskar_sky_create_copy(sky_cpu, location, status);
+    oskar_Sky* sky_out = oskar_sky_create(type, location, 0, status);
+
+    // Create a telescope model with stations spread over a few degrees.
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU, 0, status);
+    oskar_telescope_resize(tel, num_stations, status);
+    for (int i = 0; i < num_stations && !*status; ++i)
+        oskar_station_set_position(oskar_telescope_station(tel, i),
+                (116.0 + 0.01 * i) * deg2rad, (-27.0 - 0.01 * i) * deg2rad,
+                0.0, 0.0, 0.0, 0.0);
+    oskar_StationWork* work = oskar_station_work_create(type, location,
+            status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_sky_horizon_clip(sky_out, sky_in, tel, 0.0, work, status);
+    state.set_items_processed((double) num_sources);
+
+    // Free memory.
+    oskar_station_work_free(work, status);
+    oskar_telescope_free(tel, status);
+    oskar_sky_free(sky_out, status);
+    oskar_sky_free(sky_in, status);
+    oskar_sky_free(sky_cpu, status);
+}
+
+OSKAR_BENCHMARK("sky_horizon_clip", bench_sky_horizon_clip,
+        "sources,stations")
+        ->args(16384, 1)->args(262144, 1)->args(262144, 512)
+        ->args(1048576, 512);
+
+static oskar_Sky* random_sky(int type, int num_sources, int* status)
+{
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, status);
+    oskar_mem_random_range(oskar_sky_ra_rad(sky), 0.0, 2.0 * M_PI, status);
+    oskar_mem_random_range(oskar_sky_dec_rad(sky),
+            -M_PI / 2.0, M_PI / 2.0, status);
+    oskar_mem_random_range(oskar_sky_I(sky), 1.0, 10.0, status);
+    return sky;
+}
+
+static void bench_sky_index_create(oskar::BenchmarkState& state)
+{
+    const int num_sources = state.arg(0);
+    int* status = state.status();
+    oskar_Sky* sky = random_sky(state.precision(), num_sources, status);
+    while (state.running())
+        oskar_sky_index_free(oskar_sky_index_create(num_sources,
+                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+                status));
+    state.set_items_processed((double) num_sources);
+    oskar_sky_free(sky, status);
+}
+
+OSKAR_BENCHMARK("sky_index_create", bench_sky_index_create, "sources")
+        ->args(65536)->args(1048576)->args(10000000)->cpu_only();
+
+static void bench_sky_index_query_radius(oskar::BenchmarkState& state)
+{
+    const int num_sources = state.arg(0);
+    const double radius_rad = state.arg(1) * M_PI / (180.0 * 60.0);
+    int* status = state.status();
+    oskar_Sky* sky = random_sky(state.precision(), num_sources, status);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+            status);
+    oskar_Mem* found = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+
+    // Query at a sequence of points spread over the sky.
+    const int num_queries = 100;
+    while (state.running())
+        for (int i = 0; i < num_queries; ++i)
+            oskar_sky_index_query_radius(index, 0.37 * i,
+                    asin(2.0 * (i + 0.5) / num_queries - 1.0),
+                    0.0, radius_rad, found, status);
+    state.set_items_processed((double) num_queries);
+    oskar_mem_free(found, status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, status);
+}
+
+OSKAR_BENCHMARK("sky_index_query_radius", bench_sky_index_query_radius,
+        "sources,radius_arcmin")
+        ->args(65536, 60)->args(1048576, 10)->args(1048576, 60)
+        ->args(10000000, 10)->cpu_only();
+
+static void bench_sky_index_query_nearest(oskar::BenchmarkState& state)
+{
+    const int num_sources = state.arg(0), k = state.arg(1);
+    int* status = state.status();
+    oskar_Sky* sky = random_sky(state.precision(), num_sources, status);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+            status);
+    oskar_Mem* found = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    const int num_queries = 1000;
+    while (state.running())
+        for (int i = 0; i < num_queries; ++i)
+            oskar_sky_index_query_nearest(index, 0.37 * i,
+                    asin(2.0 * (i + 0.5) / num_queries - 1.0),
+                    k, found, 0, status);
+    state.set_items_processed((double) num_queries);
+    oskar_mem_free(found, status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, status);
+}
+
+OSKAR_BENCHMARK("sky_index_query_nearest", bench_sky_index_query_nearest,
+        "sources,k")
+        ->args(65536, 1)->args(1048576, 1)->args(1048576, 16)
+        ->args(10000000, 1)->cpu_only();
+
+static void bench_sky_horizon_clip_indexed(oskar::BenchmarkState& state)
+{
+    const int num_sources = state.arg(0);
+    const int num_stations = state.arg(1);
+    const int type = state.precision();
+    const double deg2rad = M_PI / 180.0;
+    int* status = state.status();
+    oskar_Sky* sky_in = random_sky(type, num_sources, status);
+    oskar_sky_evaluate_relative_directions(sky_in, 0.0, -M_PI / 4.0, status);
+    oskar_Sky* sky_out = oskar_sky_create(type, OSKAR_CPU, 0, status);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky_in), oskar_sky_dec_rad_const(sky_in),
+            status);
+
+    // Create a telescope model with stations spread over a few degrees.
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU, 0, status);
+    oskar_telescope_resize(tel, num_stations, status);
+    for (int i = 0; i < num_stations && !*status; ++i)
+        oskar_station_set_position(oskar_telescope_station(tel, i),
+                (116.0 + 0.01 * i) * deg2rad, (-27.0 - 0.01 * i) * deg2rad,
+                0.0, 0.0, 0.0, 0.0);
+    oskar_StationWork* work = oskar_station_work_create(type, OSKAR_CPU,
+            status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_sky_horizon_clip_indexed(sky_out, sky_in, index, tel, 0.0,
+                work, status);
+    state.set_items_processed((double) num_sources);
+
+    // Free memory.
+    oskar_station_work_free(work, status);
+    oskar_telescope_free(tel, status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky_out, status);
+    oskar_sky_free(sky_in, status);
+}
+
+OSKAR_BENCHMARK("sky_horizon_clip_indexed", bench_sky_horizon_clip_indexed,
+        "sources,stations")
+        ->args(16384, 1)->args(262144, 1)->args(262144, 512)
+        ->args(1048576, 512)->args(10000000, 512)->cpu_only();
+
+static void bench_sky_rebin(oskar::BenchmarkState& state)
+{
+    const int num_in = state.arg(0), num_out = state.arg(1);
+    int* status = state.status();
+    oskar_Sky* sky_in = random_sky(state.precision(), num_in, status);
+    oskar_Sky* sky_out = random_sky(state.precision(), num_out, status);
+    while (state.running())
+        oskar_sky_rebin(sky_in, sky_out, status);
+    state.set_items_processed((double) num_in);
+    oskar_sky_free(sky_out, status);
+    oskar_sky_free(sky_in, status);
+}
+
+OSKAR_BENCHMARK("sky_rebin", bench_sky_rebin, "sources_in,sources_out")
+        ->args(65536, 1024)->args(1048576, 16384)
+        ->args(4194304, 65536)->cpu_only();
+
+static void bench_sky_from_healpix_ring(oskar::BenchmarkState& state)
+{
+    const int nside = state.arg(0), num_pixels = 12 * nside * nside;
+    int* status = state.status();
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_pixels, status);
+    oskar_mem_random_range(data, 1.0, 10.0, status);
+    while (state.running())
+    {
+        oskar_Sky* sky = oskar_sky_from_healpix_ring(state.precision(), data,
+                100e6, -0.7, nside, 1, status);
+        oskar_sky_free(sky, status);
+    }
+    state.set_items_processed((double) num_pixels);
+    oskar_mem_free(data, status);
+}
+
+OSKAR_BENCHMARK("sky_from_healpix_ring", bench_sky_from_healpix_ring, "nside")
+        ->args(64)->args(256)->args(1024)->cpu_only();
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "math/oskar_cmath.h"
+#include "splines/oskar_splines.h"
+#include "splines/private_splines.h"
+
+// Copies fitted double-precision splines to the required precision,
+// as is done when element data are loaded.
+static void copy_splines(oskar_Splines* dst, const oskar_Splines* src,
+        int* status)
+{
+    const oskar_Mem* src_mem[] = {src->knots_x_theta, src->knots_y_phi,
+            src->coeff};
+    oskar_Mem* dst_mem[] = {dst->knots_x_theta, dst->knots_y_phi, dst->coeff};
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_Mem* t = oskar_mem_convert_precision(src_mem[i],
+                dst->precision, status);
+        oskar_mem_copy(dst_mem[i], t, status);
+        oskar_mem_free(t, status);
+    }
+    dst->num_knots_x_theta = src->num_knots_x_theta;
+    dst->num_knots_y_phi = src->num_knots_y_phi;
+    dst->smoothing_factor = src->smoothing_factor;
+}
+
+static void bench_splines_evaluate(oskar::BenchmarkState& state)
+{
+    const int num_points = state.arg(0);
+    const int sample_deg = state.arg(1);
+    const int prec = state.precision(), location = state.location();
+    int* status = state.status();
+
+    // Fit a smooth pattern sampled over the upper hemisphere, in the same
+    // way as element pattern data. Fitting is done only in double precision.
+    const int num_theta = 90 / sample_deg + 1;
+    const int num_phi = 360 / sample_deg + 1;
+    const int num_samples = num_theta * num_phi;
+    oskar_Mem* theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_samples, status);
+    oskar_Mem* phi = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_samples, status);
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_samples, status);
+    oskar_Mem* weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_samples, status);
+    double* t = oskar_mem_double(theta, status);
+    double* p = oskar_mem_double(phi, status);
+    double* d = oskar_mem_double(data, status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_samples, status);
+    for (int i = 0, k = 0; i < num_theta; ++i)
+    {
+        for (int j = 0; j < num_phi; ++j, ++k)
+        {
+            t[k] = i * sample_deg * M_PI / 180.0;
+            p[k] = j * sample_deg * M_PI / 180.0;
+            d[k] = cos(t[k]) * (1.0 + 0.2 * cos(2.0 * p[k])) + 0.1;
+        }
+    }
+    double avg_frac_error = 0.02;
+    oskar_Splines* fitted = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU,
+            status);
+    oskar_splines_fit(fitted, num_samples, t, p, d,
+            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL,
+            1, &avg_frac_error, 1.5, 1.0, 1e-14, status);
+    oskar_Splines* spline = oskar_splines_create(prec, location, status);
+    copy_splines(spline, fitted, status);
+
+    // Create random points at which to evaluate the splines.
+    oskar_Mem* x = oskar_mem_create(prec, location, num_points, status);
+    oskar_Mem* y = oskar_mem_create(prec, location, num_points, status);
+    oskar_Mem* output = oskar_mem_create(prec, location, num_points, status);
+    oskar_mem_random_range(x, 0.0, M_PI / 2.0, status);
+    oskar_mem_random_range(y, 0.0, 2.0 * M_PI, status);
+
+    // Run the benchmark.
+    while (state.running())
+        oskar_splines_evaluate(spline, num_points, x, y, 1, 0, output, status);
+    state.set_items_processed((double) num_points);
+
+    // Free memory.
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi, status);
+    oskar_mem_free(data, status);
+    oskar_mem_free(weight, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(output, status);
+    oskar_splines_free(fitted, status);
+    oskar_splines_free(spline, status);
+}
+
+OSKAR_BENCHMARK("splines_evaluate", bench_splines_evaluate,
+        "points,sample_deg")
+        ->args(4096, 5)->args(65536, 5)->args(65536, 2)->args(1048576, 2);
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "settings/oskar_option_parser.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_get_num_procs.h"
+#include "oskar_version.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using oskar::Benchmark;
+using oskar::BenchmarkState;
+using std::string;
+using std::vector;
+
+struct Run
+{
+    string name;
+    int repetitions, repetition_index;
+    long long iterations;
+    double real_time, cpu_time, items_per_second;
+    const char* aggregate;
+};
+
+struct Todo
+{
+    Todo(Benchmark* b, int set, int precision) :
+        benchmark(b), set(set), precision(precision) {}
+    Benchmark* benchmark;
+    int set, precision;
+};
+
+static bool matches_filter(const string& name, const string& filter)
+{
+    // The filter is a comma-separated list of substrings.
+    if (filter.empty()) return true;
+    for (size_t start = 0; start < filter.size();)
+    {
+        size_t end = filter.find(',', start);
+        if (end == string::npos) end = filter.size();
+        const string s = filter.substr(start, end - start);
+        if (!s.empty() && name.find(s) != string::npos) return true;
+        start = end + 1;
+    }
+    return false;
+}
+
+static string format_time(double sec)
+{
+    char buffer[32];
+    if (sec < 1e-6)
+        (void) snprintf(buffer, sizeof(buffer), "%8.1f ns", sec * 1e9);
+    else if (sec < 1e-3)
+        (void) snprintf(buffer, sizeof(buffer), "%8.2f us", sec * 1e6);
+    else if (sec < 1.0)
+        (void) snprintf(buffer, sizeof(buffer), "%8.3f ms", sec * 1e3);
+    else
+        (void) snprintf(buffer, sizeof(buffer), "%8.3f s ", sec);
+    return string(buffer);
+}
+
+static void print_run(const Run& r, size_t name_width)
+{
+    string name = r.name;
+    if (r.aggregate) name = name + "_" + r.aggregate;
+    printf("%-*s %s %s %12lld", (int) name_width, name.c_str(),
+            format_time(r.real_time).c_str(),
+            format_time(r.cpu_time).c_str(), r.iterations);
+    if (r.items_per_second > 0.0)
+        printf(" %10.4g items/s", r.items_per_second);
+    printf("\n");
+}
+
+static void add_aggregates(const vector<Run>& reps, vector<Run>& runs)
+{
+    const int n = (int) reps.size();
+    if (n < 2) return;
+    vector<double> t(n), c(n), items(n);
+    for (int i = 0; i < n; ++i)
+    {
+        t[i] = reps[i].real_time;
+        c[i] = reps[i].cpu_time;
+        items[i] = reps[i].items_per_second;
+    }
+    Run mean = reps[0], median = reps[0], stddev = reps[0], min = reps[0];
+    mean.aggregate = "mean";
+    median.aggregate = "median";
+    stddev.aggregate = "stddev";
+    min.aggregate = "min";
+    mean.real_time = mean.cpu_time = mean.items_per_second = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        mean.real_time += t[i] / n;
+        mean.cpu_time += c[i] / n;
+        mean.items_per_second += items[i] / n;
+    }
+    stddev.real_time = stddev.cpu_time = stddev.items_per_second = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        stddev.real_time += pow(t[i] - mean.real_time, 2.0) / (n - 1);
+        stddev.cpu_time += pow(c[i] - mean.cpu_time, 2.0) / (n - 1);
+        stddev.items_per_second +=
+                pow(items[i] - mean.items_per_second, 2.0) / (n - 1);
+    }
+    stddev.real_time = sqrt(stddev.real_time);
+    stddev.cpu_time = sqrt(stddev.cpu_time);
+    stddev.items_per_second = sqrt(stddev.items_per_second);
+    std::sort(t.begin(), t.end());
+    std::sort(c.begin(), c.end());
+    std::sort(items.begin(), items.end());
+    median.real_time = (t[(n - 1) / 2] + t[n / 2]) / 2.0;
+    median.cpu_time = (c[(n - 1) / 2] + c[n / 2]) / 2.0;
+    median.items_per_second = (items[(n - 1) / 2] + items[n / 2]) / 2.0;
+    min.real_time = t[0];
+    min.cpu_time = c[0];
+    min.items_per_second = items[n - 1];
+    runs.push_back(mean);
+    runs.push_back(median);
+    runs.push_back(stddev);
+    runs.push_back(min);
+}
+
+static void write_json(const char* filename, const vector<Run>& runs,
+        const char* device_name, int num_threads)
+{
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Unable to open '%s'\n", filename);
+        return;
+    }
+
+    // Write results in the same schema as Google Benchmark, so that
+    // existing tools can be used to compare runs.
+    char date[64];
+    time_t now = time(0);
+    (void) strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(file, "{\n  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"executable\": \"oskar_benchmark\",\n");
+    fprintf(file, "    \"oskar_version\": \"%s\",\n", OSKAR_VERSION_STR);
+    fprintf(file, "    \"device\": \"%s\",\n", device_name);
+    fprintf(file, "    \"num_cpus\": %d,\n", oskar_get_num_procs());
+    fprintf(file, "    \"num_threads\": %d,\n", num_threads);
+#ifdef NDEBUG
+    fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(file, "  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const Run& r = runs[i];
+        const string name = r.aggregate ? r.name + "_" + r.aggregate : r.name;
+        fprintf(file, "%s\n    {\n", i > 0 ? "," : "");
+        fprintf(file, "      \"name\": \"%s\",\n", name.c_str());
+        fprintf(file, "      \"run_name\": \"%s\",\n", r.name.c_str());
+        if (r.aggregate)
+        {
+            fprintf(file, "      \"run_type\": \"aggregate\",\n");
+            fprintf(file, "      \"aggregate_name\": \"%s\",\n", r.aggregate);
+        }
+        else
+            fprintf(file, "      \"run_type\": \"iteration\",\n");
+        fprintf(file, "      \"repetitions\": %d,\n", r.repetitions);
+        fprintf(file, "      \"repetition_index\": %d,\n", r.repetition_index);
+        fprintf(file, "      \"threads\": %d,\n", num_threads);
+        fprintf(file, "      \"iterations\": %lld,\n", r.iterations);
+        fprintf(file, "      \"real_time\": %.6e,\n", r.real_time * 1e9);
+        fprintf(file, "      \"cpu_time\": %.6e,\n", r.cpu_time * 1e9);
+        fprintf(file, "      \"time_unit\": \"ns\"");
+        if (r.items_per_second > 0.0)
+            fprintf(file, ",\n      \"items_per_second\": %.6e",
+                    r.items_per_second);
+        fprintf(file, "\n    }");
+    }
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_benchmark", OSKAR_VERSION_STR);
+    opt.set_description("Times the main simulation and imaging kernels.");
+    opt.add_flag("--filter", "Run only benchmarks with names containing one "
+            "of these comma-separated strings.", 1, "", false);
+    opt.add_flag("--json", "Write results to this JSON file.", 1, "", false);
+    opt.add_flag("--min-time", "Minimum time to run each benchmark, "
+            "in seconds.", 1, "0.5", false);
+    opt.add_flag("--repetitions", "Number of times to repeat each "
+            "benchmark.", 1, "1", false);
+    opt.add_flag("--precision", "Precision to use: single, double or both.",
+            1, "both", false);
+    opt.add_flag("-g", "Run on the GPU (default: CPU).");
+    opt.add_flag("-cl", "Run using OpenCL (default: CPU).");
+    opt.add_flag("--quick", "Run the smallest case of each benchmark once, "
+            "to check they all work.");
+    opt.add_flag("--list", "List the benchmarks and exit.");
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    // Get options.
+    const string filter = opt.get_string("--filter");
+    const string json_file = opt.get_string("--json");
+    const string precision = opt.get_string("--precision");
+    const bool quick = opt.is_set("--quick") ? true : false;
+    double min_time = opt.get_double("--min-time");
+    int repetitions = opt.get_int("--repetitions");
+    if (repetitions < 1) repetitions = 1;
+    if (quick)
+    {
+        min_time = 0.0;
+        repetitions = 1;
+    }
+    int location = OSKAR_CPU;
+    if (opt.is_set("-g")) location = OSKAR_GPU;
+    if (opt.is_set("-cl")) location = OSKAR_CL;
+    vector<int> precisions;
+    if (precision != "double") precisions.push_back(OSKAR_SINGLE);
+    if (precision != "single") precisions.push_back(OSKAR_DOUBLE);
+    int num_threads = 1;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    // Collect the runs to do.
+    vector<Benchmark*>& benchmarks = Benchmark::all();
+    vector<Todo> todo;
+    size_t name_width = 10;
+    for (size_t i = 0; i < benchmarks.size(); ++i)
+    {
+        Benchmark* b = benchmarks[i];
+        if (b->is_cpu_only() && location != OSKAR_CPU) continue;
+        const int num_sets = (int) b->arg_sets().size();
+        for (int j = 0; j < num_sets && (!quick || j == 0); ++j)
+        {
+            for (size_t p = 0; p < precisions.size(); ++p)
+            {
+                const string name = b->run_name(j, precisions[p]);
+                if (!matches_filter(name, filter)) continue;
+                todo.push_back(Todo(b, j, precisions[p]));
+                name_width = std::max(name_width, name.size() + 7);
+            }
+        }
+    }
+    if (opt.is_set("--list"))
+    {
+        for (size_t i = 0; i < todo.size(); ++i)
+            printf("%s\n", todo[i].benchmark->run_name(
+                    todo[i].set, todo[i].precision).c_str());
+        return EXIT_SUCCESS;
+    }
+
+    // Print the header.
+    char* device_name = oskar_device_name(location, 0);
+    const char* device = device_name ? device_name : "CPU";
+    printf("Running on '%s' with %d thread(s)\n", device, num_threads);
+    printf("%-*s %11s %11s %12s\n", (int) name_width, "Benchmark",
+            "Time", "CPU", "Iterations");
+    printf("%s\n", string(name_width + 37, '-').c_str());
+
+    // Run the benchmarks.
+    int num_failed = 0;
+    vector<Run> runs;
+    for (size_t i = 0; i < todo.size(); ++i)
+    {
+        Benchmark* b = todo[i].benchmark;
+        const int set = todo[i].set, prec = todo[i].precision;
+        const string name = b->run_name(set, prec);
+        vector<Run> reps;
+        if (location != OSKAR_CPU && prec == OSKAR_DOUBLE &&
+                !oskar_device_supports_double(location))
+        {
+            printf("%-*s SKIPPED: No double precision support\n",
+                    (int) name_width, name.c_str());
+            continue;
+        }
+        for (int r = 0; r < repetitions; ++r)
+        {
+            // Use the same random inputs every time.
+            srand(1);
+            BenchmarkState state(b->arg_sets()[set], prec, location, min_time);
+            b->function()(state);
+            if (!state.skip_reason().empty())
+            {
+                printf("%-*s SKIPPED: %s\n", (int) name_width,
+                        name.c_str(), state.skip_reason().c_str());
+                break;
+            }
+            if (state.error())
+            {
+                printf("%-*s ERROR: %s\n", (int) name_width, name.c_str(),
+                        oskar_get_error_string(state.error()));
+                num_failed++;
+                break;
+            }
+            Run run;
+            run.name = name;
+            run.repetitions = repetitions;
+            run.repetition_index = r;
+            run.iterations = state.iterations();
+            run.real_time = state.real_time() / state.iterations();
+            run.cpu_time = state.cpu_time() / state.iterations();
+            run.items_per_second = state.items_per_iteration() / run.real_time;
+            run.aggregate = 0;
+            print_run(run, name_width);
+            reps.push_back(run);
+        }
+        runs.insert(runs.end(), reps.begin(), reps.end());
+        const size_t num_runs = runs.size();
+        add_aggregates(reps, runs);
+        for (size_t k = num_runs; k < runs.size(); ++k)
+            print_run(runs[k], name_width);
+    }
+
+    // Write the JSON file if required.
+    if (!json_file.empty())
+        write_json(json_file.c_str(), runs, device, num_threads);
+    free(device_name);
+    return num_failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "benchmark/oskar_benchmark.h"
+#include "mem/oskar_mem.h"
+
+#include <cstdio>
+#include <ctime>
+
+namespace oskar {
+
+BenchmarkState::BenchmarkState(const std::vector<int>& args, int precision,
+        int location, double min_time) : args_(args), precision_(precision),
+        location_(location), status_(0), min_time_(min_time),
+        items_per_iteration_(0.0), real_time_(0.0), cpu_time_(0.0),
+        cpu_start_(0.0), iterations_(0), started_(false)
+{
+    timer_ = oskar_timer_create(location);
+}
+
+BenchmarkState::~BenchmarkState()
+{
+    oskar_timer_free(timer_);
+}
+
+int BenchmarkState::arg(int i) const
+{
+    return (i >= 0 && i < (int) args_.size()) ? args_[i] : 0;
+}
+
+bool BenchmarkState::running()
+{
+    if (!started_)
+    {
+        // Run once without timing, to warm up caches and allocate buffers.
+        started_ = true;
+        return !status_ && skip_reason_.empty();
+    }
+    if (status_ || !skip_reason_.empty()) return false;
+    if (iterations_ == 0)
+    {
+        cpu_start_ = (double) clock() / CLOCKS_PER_SEC;
+        oskar_timer_start(timer_);
+        iterations_ = 1;
+        return true;
+    }
+    real_time_ = oskar_timer_elapsed(timer_);
+    if (real_time_ < min_time_)
+    {
+        iterations_++;
+        return true;
+    }
+    oskar_timer_pause(timer_);
+    cpu_time_ = (double) clock() / CLOCKS_PER_SEC - cpu_start_;
+    return false;
+}
+
+void BenchmarkState::set_items_processed(double items_per_iteration)
+{
+    items_per_iteration_ = items_per_iteration;
+}
+
+void BenchmarkState::skip(const char* reason)
+{
+    skip_reason_ = reason;
+}
+
+Benchmark* Benchmark::add(const char* name, BenchmarkFunction func,
+        const char* arg_names)
+{
+    Benchmark* b = new Benchmark;
+    b->name_ = name;
+    b->func_ = func;
+    b->cpu_only_ = false;
+    std::string names(arg_names ? arg_names : "");
+    for (size_t start = 0; start < names.size();)
+    {
+        size_t end = names.find(',', start);
+        if (end == std::string::npos) end = names.size();
+        b->arg_names_.push_back(names.substr(start, end - start));
+        start = end + 1;
+    }
+    all().push_back(b);
+    return b;
+}
+
+std::vector<Benchmark*>& Benchmark::all()
+{
+    // Constructed on first use, as benchmarks register during static
+    // initialisation.
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+Benchmark* Benchmark::args(int a0, int a1, int a2, int a3)
+{
+    std::vector<int> a;
+    const int values[] = {a0, a1, a2, a3};
+    for (int i = 0; i < 4 && values[i] != NONE; ++i)
+        a.push_back(values[i]);
+    args_.push_back(a);
+    return this;
+}
+
+Benchmark* Benchmark::cpu_only()
+{
+    cpu_only_ = true;
+    return this;
+}
+
+std::string Benchmark::run_name(int i, int precision) const
+{
+    char buffer[64];
+    std::string s = name_;
+    s += (precision == OSKAR_SINGLE) ? "/single" : "/double";
+    const std::vector<int>& a = args_[i];
+    for (size_t j = 0; j < a.size(); ++j)
+    {
+        if (j < arg_names_.size())
+            (void) snprintf(buffer, sizeof(buffer), "/%s:%d",
+                    arg_names_[j].c_str(), a[j]);
+        else
+            (void) snprintf(buffer, sizeof(buffer), "/%d", a[j]);
+        s += buffer;
+    }
+    return s;
+}
+
+} // namespace oskar
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_BENCHMARK_H_
+#define OSKAR_BENCHMARK_H_
+
+/**
+ * @file oskar_benchmark.h
+ *
+ * @brief
+ * Minimal harness for timing the processing kernels.
+ *
+ * @details
+ * Benchmarks are registered in the style of Google Benchmark:
+ *
+ * @code
+ * static void bench_example(oskar::BenchmarkState& state)
+ * {
+ *     // Set up inputs using state.arg(i), state.precision(), etc.
+ *     while (state.running())
+ *     {
+ *         // Call the kernel, passing state.status().
+ *     }
+ *     state.set_items_processed(num_items_per_call);
+ *     // Free inputs.
+ * }
+ * OSKAR_BENCHMARK("example", bench_example, "stations,sources")
+ *         ->args(64, 1000)->args(256, 1000);
+ * @endcode
+ *
+ * Each registered benchmark is run once for each argument set and each
+ * requested precision. Only the loop body is timed. Inputs are filled
+ * from a fixed random seed, so runs are reproducible.
+ */
+
+#include "utility/oskar_timer.h"
+
+#include <string>
+#include <vector>
+
+namespace oskar {
+
+class BenchmarkState
+{
+public:
+    BenchmarkState(const std::vector<int>& args, int precision,
+            int location, double min_time);
+    ~BenchmarkState();
+
+    /** Returns the value of argument i. */
+    int arg(int i) const;
+
+    /** Returns the precision enumerator (OSKAR_SINGLE or OSKAR_DOUBLE). */
+    int precision() const { return precision_; }
+
+    /** Returns the location enumerator (OSKAR_CPU, OSKAR_GPU, etc.) */
+    int location() const { return location_; }
+
+    /** Returns a pointer to the status code to pass to the kernel. */
+    int* status() { return &status_; }
+
+    /**
+     * @brief
+     * Controls the timed loop.
+     *
+     * @details
+     * Returns true until the loop has run for at least the minimum time,
+     * or until an error has been returned in the status code.
+     */
+    bool running();
+
+    /** Sets the number of items processed by one call of the kernel. */
+    void set_items_processed(double items_per_iteration);
+
+    /** Marks the benchmark as skipped, with the given reason. */
+    void skip(const char* reason);
+
+    /* Results. */
+    int error() const { return status_; }
+    long long iterations() const { return iterations_; }
+    double items_per_iteration() const { return items_per_iteration_; }
+    double real_time() const { return real_time_; }
+    double cpu_time() const { return cpu_time_; }
+    const std::string& skip_reason() const { return skip_reason_; }
+
+private:
+    BenchmarkState(const BenchmarkState&);
+    BenchmarkState& operator=(const BenchmarkState&);
+
+    std::vector<int> args_;
+    int precision_, location_, status_;
+    double min_time_, items_per_iteration_;
+    double real_time_, cpu_time_, cpu_start_;
+    long long iterations_;
+    bool started_;
+    std::string skip_reason_;
+    oskar_Timer* timer_;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState& state);
+
+class Benchmark
+{
+public:
+    /**
+     * @brief
+     * Registers a benchmark.
+     *
+     * @param[in] name       Name of the benchmark.
+     * @param[in] func       Function to run.
+     * @param[in] arg_names  Comma-separated list of argument names.
+     */
+    static Benchmark* add(const char* name, BenchmarkFunction func,
+            const char* arg_names);
+
+    /** Returns all registered benchmarks. */
+    static std::vector<Benchmark*>& all();
+
+    /** Adds a set of arguments. Unused trailing arguments are omitted. */
+    Benchmark* args(int a0, int a1 = NONE, int a2 = NONE, int a3 = NONE);
+
+    /** Marks the benchmark as able to run only on the CPU. */
+    Benchmark* cpu_only();
+
+    /** Returns the full name of the run with argument set i. */
+    std::string run_name(int i, int precision) const;
+
+    const std::string& name() const { return name_; }
+    BenchmarkFunction function() const { return func_; }
+    const std::vector<std::vector<int> >& arg_sets() const { return args_; }
+    bool is_cpu_only() const { return cpu_only_; }
+
+private:
+    enum { NONE = -0x7FFFFFFF };
+    std::string name_;
+    BenchmarkFunction func_;
+    std::vector<std::string> arg_names_;
+    std::vector<std::vector<int> > args_;
+    bool cpu_only_;
+};
+
+} // namespace oskar
+
+#define OSKAR_BENCHMARK_CONCAT2(A, B) A ## B
+#define OSKAR_BENCHMARK_CONCAT(A, B) OSKAR_BENCHMARK_CONCAT2(A, B)
+
+/**
+ * @brief Registers a benchmark function. Argument sets can be chained on.
+ */
+#define OSKAR_BENCHMARK(NAME, FUNC, ARG_NAMES) \
+    static oskar::Benchmark* OSKAR_BENCHMARK_CONCAT(benchmark_, __LINE__) = \
+            oskar::Benchmark::add(NAME, FUNC, ARG_NAMES)
+
+#endif /* OSKAR_BENCHMARK_H_ */
@@ -67,7 +67,9 @@ enum OSKAR_TAG_GROUPS
     OSKAR_TAG_GROUP_SPLINE_DATA      = 9,
     OSKAR_TAG_GROUP_ELEMENT_DATA     = 10,
     OSKAR_TAG_GROUP_VIS_HEADER       = 11,
-    OSKAR_TAG_GROUP_VIS_BLOCK        = 12
+    OSKAR_TAG_GROUP_VIS_BLOCK        = 12,
+    OSKAR_TAG_GROUP_TELESCOPE        = 13,
+    OSKAR_TAG_GROUP_VIS_BDA          = 14
 };
 
 /* Standard metadata tags. */
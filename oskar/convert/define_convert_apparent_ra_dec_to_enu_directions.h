@@ -12,7 +12,7 @@
         GLOBAL_OUT(FP, y),\
         GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP sin_ha, cos_ha, sin_dec, cos_dec;\
     const FP ha_rad = lst_rad - ra_rad[i];\
     SINCOS(ha_rad, sin_ha, cos_ha);\
@@ -5,7 +5,7 @@
         const FP lst_rad, const FP cos_lat, const FP sin_lat,\
         GLOBAL_OUT(FP, ra_rad), GLOBAL_OUT(FP, dec_rad))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP sin_az, cos_az, sin_el, cos_el;\
     SINCOS(az_rad[i], sin_az, cos_az);\
     SINCOS(el_rad[i], sin_el, cos_el);\
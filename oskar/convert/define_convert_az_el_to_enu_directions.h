@@ -4,7 +4,7 @@
         const int num, GLOBAL_IN(FP, az_rad), GLOBAL_IN(FP, el_rad),\
         GLOBAL_OUT(FP, x), GLOBAL_OUT(FP, y), GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP sin_az, cos_az, sin_el, cos_el;\
     SINCOS(az_rad[i], sin_az, cos_az);\
     SINCOS(el_rad[i], sin_el, cos_el);\
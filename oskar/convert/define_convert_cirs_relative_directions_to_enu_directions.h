@@ -9,7 +9,7 @@
         const int offset_out, GLOBAL_OUT(FP, x), GLOBAL_OUT(FP, y),\
         GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const int i_in = i + offset_in, i_out = i + offset_out;\
     FP l_, m_, n_, x2, y2, z2;\
     if (at_origin) {\
@@ -17,7 +17,7 @@
 {\
     FP zero;\
     MAKE_ZERO(FP, zero);\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const FP x_ = x[i], y_ = y[i], z_ = z[i];\
     const FP t = x_ * cos_ha0 - y_ * sin_ha0;\
     const int j = i + offset_out;\
@@ -4,7 +4,7 @@
         const int num, GLOBAL_IN(FP, x), GLOBAL_IN(FP, y), GLOBAL_IN(FP, z),\
         GLOBAL_OUT(FP, az_rad), GLOBAL_OUT(FP, el_rad))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const FP x_ = x[i], y_ = y[i], z_ = z[i];\
     const FP r = sqrt(x_*x_ + y_*y_);\
     az_rad[i] = atan2(x_, y_);\
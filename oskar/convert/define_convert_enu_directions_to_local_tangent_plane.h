@@ -5,7 +5,7 @@
         const FP cos_phi, const FP sin_phi, const FP cos_theta,\
         const FP sin_theta, GLOBAL_OUT(FP, l), GLOBAL_OUT(FP, m))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const FP x_ = x[i], y_ = y[i], z_ = z[i];\
     l[i] = x_ * cos_phi - y_ * sin_phi;\
     m[i] = x_ * cos_theta * sin_phi + y_ * cos_theta * cos_phi - z_ * sin_theta;\
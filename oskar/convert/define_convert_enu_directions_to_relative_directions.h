@@ -8,7 +8,7 @@
         const int offset_out, GLOBAL_OUT(FP, l), GLOBAL_OUT(FP, m),\
         GLOBAL_OUT(FP, n))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const int i_in = i + offset_in, i_out = i + offset_out;\
     FP x_ = x[i_in], y_ = y[i_in], z_ = z[i_in], t;\
     l[i_out] = x_ * cos_ha0 -\
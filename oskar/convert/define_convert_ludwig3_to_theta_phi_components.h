@@ -4,7 +4,7 @@
         const int num, GLOBAL_IN(FP, phi), const int stride, const int off_h,\
         const int off_v, GLOBAL FP2* h_theta, GLOBAL FP2* v_phi)\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP sin_p, cos_p;\
     const FP p = phi[i];\
     SINCOS(p, sin_p, cos_p);\
@@ -11,7 +11,7 @@
         GLOBAL FP* lon_rad,\
         GLOBAL FP* lat_rad)\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     const FP l_ = l[i], m_ = m[i];\
     const FP n_ = (IS_3D) ? n[i] : sqrt((FP)1 - l_*l_ - m_*m_);\
     lat_rad[i] = asin(n_ * sin_lat0 + m_ * cos_lat0);\
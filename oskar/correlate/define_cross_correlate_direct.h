@@ -0,0 +1,71 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+#define OSKAR_XCORR_DIRECT_ARGS(FP, FP2)\
+        const int num_src, const int num_stations, const int offset_out,\
+        GLOBAL_IN(FP, src_I),\
+        GLOBAL_IN(FP, src_l), GLOBAL_IN(FP, src_m), GLOBAL_IN(FP, src_n),\
+        GLOBAL_IN(FP, src_a), GLOBAL_IN(FP, src_b), GLOBAL_IN(FP, src_c),\
+        GLOBAL_IN(FP, st_u), GLOBAL_IN(FP, st_v), GLOBAL_IN(FP, st_w),\
+        GLOBAL_IN(FP, st_x), GLOBAL_IN(FP, st_y),\
+        const FP uv_min_lambda,  const FP uv_max_lambda,\
+        const FP inv_wavelength, const FP frac_bandwidth,\
+        const FP time_int_sec,   const FP gha0_rad, const FP dec0_rad,\
+        const FP src_min_jy,     const FP src_max_jy,\
+        const int use_beam,  GLOBAL_IN(FP2, beam),\
+        const int use_gains, GLOBAL_IN(FP2, gains),\
+        GLOBAL_OUT(FP2, vis)
+
+/* Scalar correlator which evaluates the interferometer phase of each
+ * source directly on each baseline, instead of reading it from K-Jones. */
+#define OSKAR_XCORR_SCALAR_DIRECT(NAME, BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN, FP, FP2)\
+KERNEL(NAME) (OSKAR_XCORR_DIRECT_ARGS(FP, FP2))\
+{\
+    KERNEL_LOOP_Y(int, SP, 1, num_stations)\
+    KERNEL_LOOP_PAR_X(int, SQ, 0, SP)\
+    FP uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;\
+    OSKAR_BASELINE_TERMS(FP, st_u[SP], st_u[SQ], st_v[SP], st_v[SQ],\
+            st_w[SP], st_w[SQ], uu, vv, ww, uu2, vv2, uuvv, uv_len)\
+    if (TIME_SMEARING)\
+        OSKAR_BASELINE_DELTAS(FP, st_x[SP], st_x[SQ],\
+                st_y[SP], st_y[SQ], du, dv, dw)\
+    if (uv_len >= uv_min_lambda && uv_len <= uv_max_lambda) {\
+        const FP k = ((FP) (2.0 * M_PI)) * inv_wavelength;\
+        const FP pu = (st_u[SP] - st_u[SQ]) * k;\
+        const FP pv = (st_v[SP] - st_v[SQ]) * k;\
+        const FP pw = (st_w[SP] - st_w[SQ]) * k;\
+        FP2 sum;\
+        MAKE_ZERO2(FP, sum);\
+        for (int i = 0; i < num_src; ++i) {\
+            FP re, im;\
+            if (!(src_I[i] > src_min_jy && src_I[i] <= src_max_jy)) continue;\
+            OSKAR_XCORR_SMEARING(BANDWIDTH_SMEARING, TIME_SMEARING, GAUSSIAN, FP)\
+            smearing *= src_I[i];\
+            const FP phase = pu * src_l[i] + pv * src_m[i] +\
+                    pw * (src_n[i] - (FP) 1);\
+            SINCOS(phase, im, re);\
+            if (use_beam) {\
+                FP2 t;\
+                const FP2 e_p = beam[num_src * SP + i];\
+                const FP2 e_q = beam[num_src * SQ + i];\
+                OSKAR_MUL_COMPLEX_CONJUGATE(t, e_p, e_q)\
+                sum.x += (re * t.x - im * t.y) * smearing;\
+                sum.y += (re * t.y + im * t.x) * smearing;\
+            }\
+            else {\
+                sum.x += re * smearing;\
+                sum.y += im * smearing;\
+            }\
+        }\
+        if (use_gains) {\
+            FP2 g;\
+            const FP2 g_p = gains[SP], g_q = gains[SQ];\
+            OSKAR_MUL_COMPLEX_CONJUGATE(g, g_p, g_q)\
+            OSKAR_MUL_COMPLEX_IN_PLACE(FP2, sum, g)\
+        }\
+        const int j = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;\
+        vis[j].x += sum.x; vis[j].y += sum.y;\
+    }\
+    KERNEL_LOOP_END\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
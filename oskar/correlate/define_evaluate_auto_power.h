@@ -5,7 +5,7 @@
         const FP src_I, const FP src_Q, const FP src_U, const FP src_V,\
         const int offset_out, GLOBAL_OUT(FP4c, out))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     FP4c val1, val2, b;\
     OSKAR_LOAD_MATRIX(val1, jones[i + offset_in])\
     val2 = val1;\
@@ -26,7 +26,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     (void) src_Q;\
     (void) src_U;\
     (void) src_V;\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     FP2 val = jones[i + offset_in];\
     val.x = val.x * val.x + val.y * val.y;\
     val.y = 0;\
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_DIRECT_H_
+#define OSKAR_CROSS_CORRELATE_DIRECT_H_
+
+/**
+ * @file oskar_cross_correlate_direct.h
+ */
+
+#include <oskar_global.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Forms scalar visibilities, evaluating the interferometer phase directly.
+ *
+ * @details
+ * This is a version of oskar_cross_correlate() for scalar (Stokes I)
+ * visibilities which does not need K-Jones. The interferometer phase
+ * of each source is evaluated on each baseline inside the correlator,
+ * from the baseline (u, v, w) coordinates and the source direction cosines,
+ * as exp(2 pi i (u l + v m + w (n - 1))). This avoids writing and reading
+ * back an array of Jones scalars of size (stations x sources).
+ *
+ * The source terms are optionally multiplied by a station beam,
+ * given per station and source (E-Jones), and the visibilities are
+ * optionally multiplied by a complex factor per station (such as a gain).
+ * Either of these can be NULL, for isotropic stations or unit gains.
+ *
+ * Sources with Stokes I outside the range (source_min_jy, source_max_jy]
+ * are excluded, as done by oskar_evaluate_jones_K().
+ *
+ * @param[in]  source_type    Source type (0 = point, 1 = Gaussian).
+ * @param[in]  num_sources    Number of sources to use.
+ * @param[in]  beam           Optional scalar station beams (may be NULL).
+ * @param[in]  station_factor Optional complex factor per station
+ *                            (may be NULL).
+ * @param[in]  src_flux       Vector of source Stokes I values.
+ * @param[in]  src_dir[3]     Vectors of source direction cosines.
+ * @param[in]  src_ext[3]     Vectors of extended source parameters.
+ * @param[in]  source_min_jy  Minimum allowed Stokes I value (exclusive).
+ * @param[in]  source_max_jy  Maximum allowed Stokes I value (inclusive).
+ * @param[in]  tel            Telescope model.
+ * @param[in]  station_uvw[3] Station (u, v, w) coordinates, in metres.
+ * @param[in]  gast           Greenwich apparent sidereal time, in radians.
+ * @param[in]  frequency_hz   Current observation frequency, in Hz.
+ * @param[in]  offset_out     Output visibility start offset.
+ * @param[out] vis            Output visibility amplitudes.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_direct(
+        int source_type,
+        int num_sources,
+        const oskar_Jones* beam,
+        const oskar_Mem* station_factor,
+        const oskar_Mem* src_flux,
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        double source_min_jy,
+        double source_max_jy,
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* vis,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
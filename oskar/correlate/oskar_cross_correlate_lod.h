@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_CROSS_CORRELATE_LOD_H_
+#define OSKAR_CROSS_CORRELATE_LOD_H_
+
+/**
+ * @file oskar_cross_correlate_lod.h
+ */
+
+#include <oskar_global.h>
+#include <correlate/oskar_source_tree.h>
+#include <telescope/oskar_telescope.h>
+#include <interferometer/oskar_jones.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Forms visibilities of point sources using a level-of-detail source tree.
+ *
+ * @details
+ * This is an approximate version of oskar_cross_correlate() for point
+ * sources, which merges groups of sources that a baseline does not resolve.
+ *
+ * For each baseline, the source tree (built from the same source
+ * directions using oskar_source_tree_build()) is descended from the root.
+ * A node is replaced by its representative source, with the summed
+ * Stokes parameters of all sources in the node, if the bound on the error
+ * this causes is no larger than \p tolerance. Groups of faint sources,
+ * and groups that the baseline does not resolve, are therefore merged
+ * first. Leaf nodes which cannot be merged are summed exactly.
+ *
+ * The error bound for a node of radius r (in direction cosines) on a
+ * baseline of length |uvw| wavelengths is
+ * |J_p| |J_q| S (min(2, 2 pi |uvw| r) + 0.44 |d| r),
+ * where J_p and J_q are the Jones matrices of the representative source,
+ * S is the sum of the norms of the brightness matrices in the node,
+ * and |d| is the rate of change of the bandwidth- and time-smearing
+ * arguments with source position. This accounts for the interferometer
+ * phase and the smearing terms; the station beam is assumed to be
+ * constant across each node.
+ *
+ * The bound on the error of each visibility is the sum of the bounds
+ * for the nodes merged on its baseline. The number of source terms
+ * evaluated, the number that oskar_cross_correlate() would have evaluated,
+ * and the largest error bound for any visibility are accumulated into the
+ * last three arguments.
+ *
+ * All data must be in CPU memory.
+ *
+ * @param[in,out] tree        Source tree built from \p src_dir.
+ * @param[in]  tolerance      Largest error allowed from merging one node, in Jy.
+ * @param[in]  num_sources    Number of sources to use.
+ * @param[in]  jones          Set of Jones matrices.
+ * @param[in]  src_flux[4]    Vectors of source Stokes (I, Q, U, V) values.
+ * @param[in]  src_dir[3]     Vectors of source direction cosines.
+ * @param[in]  tel            Telescope model.
+ * @param[in]  station_uvw[3] Station (u, v, w) coordinates, in metres.
+ * @param[in]  gast           Greenwich apparent sidereal time, in radians.
+ * @param[in]  frequency_hz   Current observation frequency, in Hz.
+ * @param[in]  offset_out     Output visibility start offset.
+ * @param[out] vis            Output visibility amplitudes.
+ * @param[in,out] num_terms        Running total of source terms evaluated.
+ * @param[in,out] num_terms_exact  Running total of source terms needed
+ *                                 without the tree.
+ * @param[in,out] max_error_bound  Largest error bound of any visibility.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_cross_correlate_lod(
+        oskar_SourceTree* tree,
+        double tolerance,
+        int num_sources,
+        const oskar_Jones* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* vis,
+        double* num_terms,
+        double* num_terms_exact,
+        double* max_error_bound,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
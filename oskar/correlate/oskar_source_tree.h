@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SOURCE_TREE_H_
+#define OSKAR_SOURCE_TREE_H_
+
+/**
+ * @file oskar_source_tree.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_SourceTree;
+#ifndef OSKAR_SOURCE_TREE_TYPEDEF_
+#define OSKAR_SOURCE_TREE_TYPEDEF_
+typedef struct oskar_SourceTree oskar_SourceTree;
+#endif /* OSKAR_SOURCE_TREE_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates an empty hierarchical source tree.
+ *
+ * @details
+ * The tree is used by oskar_cross_correlate_lod() to merge groups of
+ * sources that are not resolved by a baseline.
+ * Call oskar_source_tree_build() to fill it.
+ *
+ * @return A handle to the tree.
+ */
+OSKAR_EXPORT
+oskar_SourceTree* oskar_source_tree_create(void);
+
+/**
+ * @brief
+ * Builds the tree from source direction cosines.
+ *
+ * @details
+ * Sources are split recursively in half along the longest axis of the
+ * bounding box of their direction cosines, until each leaf node holds
+ * only a few sources.
+ *
+ * Each node of the tree has a representative source, which is the source
+ * closest to the centre of its bounding box, and a radius, which is the
+ * largest distance in (l, m, n) from the representative to any other
+ * source in the node.
+ *
+ * The tree depends only on the source positions, so it can be built
+ * once per sky chunk and reused for all channels. Any previous contents
+ * are replaced. Each node is split so that the order of the sources
+ * on each side is kept: if the sources are put into the order given by
+ * oskar_source_tree_order() (or a subset of them is taken in that order),
+ * building the tree again gives an order in which nearby sources are
+ * close together in memory. The arrays must be in CPU memory, and may be of
+ * either precision.
+ *
+ * @param[in,out] tree     Handle to the tree.
+ * @param[in] num_sources  Number of sources.
+ * @param[in] src_dir      Source direction cosines (l, m, n).
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_source_tree_build(oskar_SourceTree* tree, int num_sources,
+        const oskar_Mem* const src_dir[3], int* status);
+
+/**
+ * @brief
+ * Returns the number of sources in the tree.
+ */
+OSKAR_EXPORT
+int oskar_source_tree_num_sources(const oskar_SourceTree* tree);
+
+/**
+ * @brief
+ * Returns the number of nodes in the tree.
+ */
+OSKAR_EXPORT
+int oskar_source_tree_num_nodes(const oskar_SourceTree* tree);
+
+/**
+ * @brief
+ * Returns the order of the sources in the tree.
+ *
+ * @details
+ * Element i of the returned array is the original index of the
+ * i-th source held in the tree. The sources in each node are contiguous
+ * in this order.
+ */
+OSKAR_EXPORT
+const int* oskar_source_tree_order(const oskar_SourceTree* tree);
+
+/**
+ * @brief
+ * Frees memory held by the tree.
+ */
+OSKAR_EXPORT
+void oskar_source_tree_free(oskar_SourceTree* tree);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_SOURCE_TREE_H_
+#define OSKAR_PRIVATE_SOURCE_TREE_H_
+
+#include <stddef.h>
+
+/* Number of values held for each node in the flux array. */
+#define OSKAR_SOURCE_TREE_FLUX_VALUES 5
+
+struct oskar_SourceTreeNode
+{
+    int start, end;  /* Range of sources, in tree order. */
+    int first_child; /* Children are first_child and first_child + 1. */
+    int rep;         /* Original index of the representative source. */
+    double radius;   /* Largest distance in (l, m, n) from representative. */
+};
+typedef struct oskar_SourceTreeNode oskar_SourceTreeNode;
+
+struct oskar_SourceTree
+{
+    int num_sources, capacity_sources, num_nodes, capacity_nodes;
+    int* order;   /* Original index of each source, in tree order. */
+    double* lmn;  /* Direction cosines, in tree order. */
+    oskar_SourceTreeNode* nodes; /* Children always follow their parent. */
+
+    /* Sums of Stokes I, Q, U, V and of the norm of the brightness matrix
+     * for each node, set by the correlator for the current channel. */
+    double* flux;
+
+    /* Norm of the Jones matrix of the representative source of each node,
+     * for each station, set by the correlator. */
+    double* jones_norm;
+    size_t capacity_jones_norm;
+};
+
+#ifndef OSKAR_SOURCE_TREE_TYPEDEF_
+#define OSKAR_SOURCE_TREE_TYPEDEF_
+typedef struct oskar_SourceTree oskar_SourceTree;
+#endif /* OSKAR_SOURCE_TREE_TYPEDEF_ */
+
+#endif /* include guard */
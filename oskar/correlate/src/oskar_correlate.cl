@@ -1,6 +1,14 @@
-/* Copyright (c) 2018-2020, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2021, The University of Oxford. See LICENSE file. */
 
 OSKAR_AUTO_POWER_MATRIX(  M_CAT(evaluate_auto_power_, Real), Real, Real2, Real4c)
 OSKAR_AUTO_POWER_SCALAR(  M_CAT(evaluate_auto_power_scalar_, Real), Real, Real2)
 OSKAR_CROSS_POWER_MATRIX( M_CAT(evaluate_cross_power_, Real), Real, Real2, Real4c)
 OSKAR_CROSS_POWER_SCALAR( M_CAT(evaluate_cross_power_scalar_, Real), Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_point_, Real), false, false, false, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_point_bs_, Real), true, false, false, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_point_ts_, Real), false, true, false, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_point_bs_ts_, Real), true, true, false, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_gaussian_, Real), false, false, true, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_gaussian_bs_, Real), true, false, true, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_gaussian_ts_, Real), false, true, true, Real, Real2)
+OSKAR_XCORR_SCALAR_DIRECT( M_CAT(xcorr_direct_gaussian_bs_ts_, Real), true, true, true, Real, Real2)
@@ -1,7 +1,9 @@
-/* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
+/* Copyright (c) 2018-2021, The University of Oxford. See LICENSE file. */
 
 #include "correlate/define_auto_correlate.h"
 #include "correlate/define_correlate_utils.h"
+#include "correlate/define_cross_correlate.h"
+#include "correlate/define_cross_correlate_direct.h"
 #include "correlate/define_evaluate_auto_power.h"
 #include "correlate/define_evaluate_cross_power.h"
 #include "math/define_multiply.h"
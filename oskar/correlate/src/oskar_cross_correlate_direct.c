@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/define_cross_correlate.h"
+#include "correlate/define_cross_correlate_direct.h"
+#include "correlate/oskar_cross_correlate_direct.h"
+#include "math/define_multiply.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <float.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XCORR_DIRECT_CPU(FP, FP2, T)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_point_##T, 0, 0, 0, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_point_bs_##T, 1, 0, 0, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_point_ts_##T, 0, 1, 0, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_point_bs_ts_##T, 1, 1, 0, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_gaussian_##T, 0, 0, 1, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_gaussian_bs_##T, 1, 0, 1, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_gaussian_ts_##T, 0, 1, 1, FP, FP2)\
+    OSKAR_XCORR_SCALAR_DIRECT(xcorr_direct_gaussian_bs_ts_##T, 1, 1, 1, FP, FP2)\
+    typedef void (*xcorr_direct_##T)(OSKAR_XCORR_DIRECT_ARGS(FP, FP2));\
+    static const xcorr_direct_##T xcorr_direct_cpu_##T[] = {\
+            xcorr_direct_point_##T, xcorr_direct_point_bs_##T,\
+            xcorr_direct_point_ts_##T, xcorr_direct_point_bs_ts_##T,\
+            xcorr_direct_gaussian_##T, xcorr_direct_gaussian_bs_##T,\
+            xcorr_direct_gaussian_ts_##T, xcorr_direct_gaussian_bs_ts_##T};
+
+XCORR_DIRECT_CPU(float, float2, float)
+XCORR_DIRECT_CPU(double, double2, double)
+
+/* Kernel names, indexed as for the CPU functions. */
+static const char* xcorr_direct_names[] = {
+        "xcorr_direct_point_float", "xcorr_direct_point_bs_float",
+        "xcorr_direct_point_ts_float", "xcorr_direct_point_bs_ts_float",
+        "xcorr_direct_gaussian_float", "xcorr_direct_gaussian_bs_float",
+        "xcorr_direct_gaussian_ts_float", "xcorr_direct_gaussian_bs_ts_float",
+        "xcorr_direct_point_double", "xcorr_direct_point_bs_double",
+        "xcorr_direct_point_ts_double", "xcorr_direct_point_bs_ts_double",
+        "xcorr_direct_gaussian_double", "xcorr_direct_gaussian_bs_double",
+        "xcorr_direct_gaussian_ts_double", "xcorr_direct_gaussian_bs_ts_double"
+};
+
+void oskar_cross_correlate_direct(
+        int source_type,
+        int num_sources,
+        const oskar_Jones* beam,
+        const oskar_Mem* station_factor,
+        const oskar_Mem* src_flux,
+        const oskar_Mem* const src_dir[3],
+        const oskar_Mem* const src_ext[3],
+        double source_min_jy,
+        double source_max_jy,
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* vis,
+        int* status)
+{
+    double uv_filter_min, uv_filter_max;
+    double time_avg = 0.0, gha0 = 0.0, dec0 = 0.0;
+    if (*status) return;
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const int use_extended = (source_type == 1);
+    const int use_beam = beam ? 1 : 0;
+    const int use_gains = station_factor ? 1 : 0;
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / frequency_hz;
+
+    /* Get time-average smearing terms.
+     * Ignore if drift scanning - this will need to be done differently. */
+    if (oskar_telescope_phase_centre_coord_type(tel) != OSKAR_COORDS_AZEL)
+    {
+        time_avg = oskar_telescope_time_average_sec(tel);
+        gha0 = gast - oskar_telescope_phase_centre_longitude_rad(tel);
+        dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    }
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Use placeholders for unused arrays. */
+    const oskar_Mem* b = beam ? oskar_jones_mem_const(beam) : vis;
+    const oskar_Mem* g = station_factor ? station_factor : vis;
+    const oskar_Mem* const* ext = use_extended ? src_ext : src_dir;
+
+    /* Check data locations. */
+    const int location = oskar_mem_location(vis);
+    if (oskar_telescope_mem_location(tel) != location ||
+            oskar_mem_location(b) != location ||
+            oskar_mem_location(g) != location ||
+            oskar_mem_location(src_flux) != location ||
+            oskar_mem_location(src_dir[0]) != location ||
+            oskar_mem_location(ext[0]) != location ||
+            oskar_mem_location(station_uvw[0]) != location ||
+            oskar_mem_location(station_uvw[1]) != location ||
+            oskar_mem_location(station_uvw[2]) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Check for consistent data types. */
+    const int type = oskar_mem_type(vis);
+    const int base_type = oskar_type_precision(type);
+    if (oskar_mem_type(b) != type || oskar_mem_type(g) != type ||
+            oskar_mem_type(src_flux) != base_type ||
+            oskar_mem_type(src_dir[0]) != base_type ||
+            oskar_mem_type(station_uvw[0]) != base_type ||
+            oskar_mem_type(station_uvw[1]) != base_type ||
+            oskar_mem_type(station_uvw[2]) != base_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (type != OSKAR_SINGLE_COMPLEX && type != OSKAR_DOUBLE_COMPLEX)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Check the input dimensions. */
+    if ((beam && (oskar_jones_num_sources(beam) != num_sources ||
+            oskar_jones_num_stations(beam) != num_stations)) ||
+            (station_factor &&
+                    (int)oskar_mem_length(station_factor) < num_stations) ||
+            (int)oskar_mem_length(station_uvw[0]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[1]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[2]) != num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Get handles to arrays. */
+    const oskar_Mem* x =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    const oskar_Mem* y =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+
+    /* Select kernel. */
+    const int is_dbl = (type == OSKAR_DOUBLE_COMPLEX);
+    const int k = (frac_bandwidth != 0.0 ? 1 : 0) +
+            (time_avg != 0.0 ? 2 : 0) + (use_extended ? 4 : 0);
+    if (location == OSKAR_CPU)
+    {
+        if (is_dbl)
+            xcorr_direct_cpu_double[k](num_sources, num_stations, offset_out,
+                    oskar_mem_double_const(src_flux, status),
+                    oskar_mem_double_const(src_dir[0], status),
+                    oskar_mem_double_const(src_dir[1], status),
+                    oskar_mem_double_const(src_dir[2], status),
+                    oskar_mem_double_const(ext[0], status),
+                    oskar_mem_double_const(ext[1], status),
+                    oskar_mem_double_const(ext[2], status),
+                    oskar_mem_double_const(station_uvw[0], status),
+                    oskar_mem_double_const(station_uvw[1], status),
+                    oskar_mem_double_const(station_uvw[2], status),
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    uv_filter_min, uv_filter_max, inv_wavelength,
+                    frac_bandwidth, time_avg, gha0, dec0,
+                    source_min_jy, source_max_jy,
+                    use_beam, oskar_mem_double2_const(b, status),
+                    use_gains, oskar_mem_double2_const(g, status),
+                    oskar_mem_double2(vis, status));
+        else
+            xcorr_direct_cpu_float[k](num_sources, num_stations, offset_out,
+                    oskar_mem_float_const(src_flux, status),
+                    oskar_mem_float_const(src_dir[0], status),
+                    oskar_mem_float_const(src_dir[1], status),
+                    oskar_mem_float_const(src_dir[2], status),
+                    oskar_mem_float_const(ext[0], status),
+                    oskar_mem_float_const(ext[1], status),
+                    oskar_mem_float_const(ext[2], status),
+                    oskar_mem_float_const(station_uvw[0], status),
+                    oskar_mem_float_const(station_uvw[1], status),
+                    oskar_mem_float_const(station_uvw[2], status),
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    (float) uv_filter_min, (float) uv_filter_max,
+                    (float) inv_wavelength, (float) frac_bandwidth,
+                    (float) time_avg, (float) gha0, (float) dec0,
+                    (float) source_min_jy, (float) source_max_jy,
+                    use_beam, oskar_mem_float2_const(b, status),
+                    use_gains, oskar_mem_float2_const(g, status),
+                    oskar_mem_float2(vis, status));
+    }
+    else
+    {
+        size_t local_size[] = {64, 1, 1}, global_size[] = {1, 1, 1};
+        const float uv_filter_min_f = (float) uv_filter_min;
+        const float uv_filter_max_f = (float) uv_filter_max;
+        const float inv_wavelength_f = (float) inv_wavelength;
+        const float frac_bandwidth_f = (float) frac_bandwidth;
+        const float time_avg_f = (float) time_avg;
+        const float gha0_f = (float) gha0;
+        const float dec0_f = (float) dec0;
+        const float source_min_jy_f = (float) source_min_jy;
+        const float source_max_jy_f = (float) source_max_jy;
+        const size_t fp_sz = is_dbl ? DBL_SZ : FLT_SZ;
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_sources},
+                {INT_SZ, &num_stations},
+                {INT_SZ, &offset_out},
+                {PTR_SZ, oskar_mem_buffer_const(src_flux)},
+                {PTR_SZ, oskar_mem_buffer_const(src_dir[0])},
+                {PTR_SZ, oskar_mem_buffer_const(src_dir[1])},
+                {PTR_SZ, oskar_mem_buffer_const(src_dir[2])},
+                {PTR_SZ, oskar_mem_buffer_const(ext[0])},
+                {PTR_SZ, oskar_mem_buffer_const(ext[1])},
+                {PTR_SZ, oskar_mem_buffer_const(ext[2])},
+                {PTR_SZ, oskar_mem_buffer_const(station_uvw[0])},
+                {PTR_SZ, oskar_mem_buffer_const(station_uvw[1])},
+                {PTR_SZ, oskar_mem_buffer_const(station_uvw[2])},
+                {PTR_SZ, oskar_mem_buffer_const(x)},
+                {PTR_SZ, oskar_mem_buffer_const(y)},
+                {fp_sz, is_dbl ? (const void*)&uv_filter_min :
+                        (const void*)&uv_filter_min_f},
+                {fp_sz, is_dbl ? (const void*)&uv_filter_max :
+                        (const void*)&uv_filter_max_f},
+                {fp_sz, is_dbl ? (const void*)&inv_wavelength :
+                        (const void*)&inv_wavelength_f},
+                {fp_sz, is_dbl ? (const void*)&frac_bandwidth :
+                        (const void*)&frac_bandwidth_f},
+                {fp_sz, is_dbl ? (const void*)&time_avg :
+                        (const void*)&time_avg_f},
+                {fp_sz, is_dbl ? (const void*)&gha0 : (const void*)&gha0_f},
+                {fp_sz, is_dbl ? (const void*)&dec0 : (const void*)&dec0_f},
+                {fp_sz, is_dbl ? (const void*)&source_min_jy :
+                        (const void*)&source_min_jy_f},
+                {fp_sz, is_dbl ? (const void*)&source_max_jy :
+                        (const void*)&source_max_jy_f},
+                {INT_SZ, &use_beam},
+                {PTR_SZ, oskar_mem_buffer_const(b)},
+                {INT_SZ, &use_gains},
+                {PTR_SZ, oskar_mem_buffer_const(g)},
+                {PTR_SZ, oskar_mem_buffer(vis)}
+        };
+        if (oskar_device_is_cpu(location))
+            local_size[0] = 8;
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_stations, local_size[0]);
+        global_size[1] = (size_t) num_stations;
+        oskar_device_launch_kernel(xcorr_direct_names[k + (is_dbl ? 8 : 0)],
+                location, 2, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_cross_correlate_lod.h"
+#include "correlate/private_source_tree.h"
+#include "math/define_multiply.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+// Largest magnitude of the derivative of sin(x) / x.
+#define SINC_MAX_SLOPE 0.4362
+
+// Maximum depth of the source tree, which halves at each level.
+#define MAX_DEPTH 64
+
+static void update_flux(oskar_SourceTree* tree, int matrix,
+        const oskar_Mem* const src_flux[4], int* status);
+
+template<typename REAL>
+static void smearing_terms(REAL& smearing, const REAL* source_l,
+        const REAL* source_m, const REAL* source_n, const int i,
+        const bool bandwidth_smearing, const bool time_smearing,
+        const REAL uu, const REAL vv, const REAL ww,
+        const REAL du, const REAL dv, const REAL dw)
+{
+    smearing = (REAL) 1;
+    if (bandwidth_smearing || time_smearing)
+    {
+        const REAL l = source_l[i];
+        const REAL m = source_m[i];
+        const REAL n = source_n[i] - (REAL) 1;
+        if (bandwidth_smearing)
+        {
+            const REAL t = uu * l + vv * m + ww * n;
+            smearing *= OSKAR_SINC(REAL, t);
+        }
+        if (time_smearing)
+        {
+            const REAL t = du * l + dv * m + dw * n;
+            smearing *= OSKAR_SINC(REAL, t);
+        }
+    }
+}
+
+template
+<
+bool MATRIX, typename REAL, typename REAL2, typename REAL4c
+>
+static void oskar_xcorr_lod_omp(
+        const oskar_SourceTree* tree,
+        const double                 tolerance,
+        const int                    num_sources,
+        const int                    num_stations,
+        const int                    offset_out,
+        const void*         const    jones,
+        const REAL*   const RESTRICT source_I,
+        const REAL*   const RESTRICT source_Q,
+        const REAL*   const RESTRICT source_U,
+        const REAL*   const RESTRICT source_V,
+        const REAL*   const RESTRICT source_l,
+        const REAL*   const RESTRICT source_m,
+        const REAL*   const RESTRICT source_n,
+        const REAL*   const RESTRICT station_u,
+        const REAL*   const RESTRICT station_v,
+        const REAL*   const RESTRICT station_w,
+        const REAL*   const RESTRICT station_x,
+        const REAL*   const RESTRICT station_y,
+        const REAL                   uv_min_lambda,
+        const REAL                   uv_max_lambda,
+        const REAL                   inv_wavelength,
+        const REAL                   frac_bandwidth,
+        const REAL                   time_int_sec,
+        const REAL                   gha0_rad,
+        const REAL                   dec0_rad,
+        void*                        vis,
+        double*                      num_terms,
+        double*                      num_terms_exact,
+        double*                      max_error_bound)
+{
+    const bool bandwidth_smearing = (frac_bandwidth != (REAL) 0);
+    const bool time_smearing = (time_int_sec != (REAL) 0);
+    const oskar_SourceTreeNode* const nodes = tree->nodes;
+    const double* const flux = tree->flux;
+    const int* const order = tree->order;
+    const int num_nodes = tree->num_nodes;
+    double* const jones_norm = tree->jones_norm;
+    double terms = 0.0, terms_exact = 0.0, error_max = 0.0;
+
+    // Get the norm of the Jones matrix of each node's representative
+    // source, for each station.
+#pragma omp parallel for
+    for (int s = 0; s < num_stations; ++s)
+    {
+        for (int inode = 0; inode < num_nodes; ++inode)
+        {
+            const int i = s * num_sources + nodes[inode].rep;
+            double t;
+            if (MATRIX)
+            {
+                const REAL4c j = ((const REAL4c*) jones)[i];
+                t = (double) j.a.x * j.a.x + (double) j.a.y * j.a.y +
+                        (double) j.b.x * j.b.x + (double) j.b.y * j.b.y +
+                        (double) j.c.x * j.c.x + (double) j.c.y * j.c.y +
+                        (double) j.d.x * j.d.x + (double) j.d.y * j.d.y;
+            }
+            else
+            {
+                const REAL2 j = ((const REAL2*) jones)[i];
+                t = (double) j.x * j.x + (double) j.y * j.y;
+            }
+            jones_norm[s * num_nodes + inode] = sqrt(t);
+        }
+    }
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1) \
+        reduction(+:terms, terms_exact) reduction(max:error_max)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        int stack[MAX_DEPTH];
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv;
+            REAL du = (REAL) 0, dv = (REAL) 0, dw = (REAL) 0;
+            double4c sum_m;
+            double2 sum_s;
+            OSKAR_CLEAR_COMPLEX_MATRIX(double, sum_m)
+            MAKE_ZERO2(double, sum_s);
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+            (void) uuvv;
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Compute the deltas for time-average smearing.
+            if (time_smearing)
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+
+            // Get the rates of change of the phase and smearing arguments
+            // with source position.
+            const double ww_lambda = ((double) station_w[SP] -
+                    (double) station_w[SQ]) * inv_wavelength;
+            const double phase_slope = 2.0 * M_PI * sqrt((double) uu2 +
+                    (double) vv2 + ww_lambda * ww_lambda);
+            double smear_slope = 0.0;
+            if (bandwidth_smearing)
+                smear_slope += sqrt((double) uu * uu +
+                        (double) vv * vv + (double) ww * ww);
+            if (time_smearing)
+                smear_slope += sqrt((double) du * du +
+                        (double) dv * dv + (double) dw * dw);
+            smear_slope *= SINC_MAX_SLOPE;
+
+            // Descend the tree.
+            double error = 0.0;
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const int inode = stack[--top];
+                const oskar_SourceTreeNode* node = &nodes[inode];
+                const double* node_flux =
+                        &flux[OSKAR_SOURCE_TREE_FLUX_VALUES * inode];
+                if (node_flux[4] == 0.0) continue;
+                const int rep = node->rep;
+
+                // Find the bound on the error from merging this node.
+                const double gain = jones_norm[SP * num_nodes + inode] *
+                        jones_norm[SQ * num_nodes + inode];
+                double phase_error = phase_slope * node->radius;
+                if (phase_error > 2.0) phase_error = 2.0;
+                const double bound = gain * node_flux[4] *
+                        (phase_error + smear_slope * node->radius);
+                if (bound <= tolerance)
+                {
+                    // Use the representative source for the whole node.
+                    REAL smearing;
+                    smearing_terms(smearing, source_l, source_m, source_n,
+                            rep, bandwidth_smearing, time_smearing,
+                            uu, vv, ww, du, dv, dw);
+                    if (MATRIX)
+                    {
+                        REAL4c m1, m2;
+                        OSKAR_CONSTRUCT_B(REAL, m2, (REAL) node_flux[0],
+                                (REAL) node_flux[1], (REAL) node_flux[2],
+                                (REAL) node_flux[3])
+                        m1 = ((const REAL4c*) jones)[SP * num_sources + rep];
+                        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(
+                                REAL2, m1, m2)
+                        m2 = ((const REAL4c*) jones)[SQ * num_sources + rep];
+                        OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(
+                                REAL2, m1, m2)
+                        OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum_m, m1,
+                                (double) smearing)
+                    }
+                    else
+                    {
+                        REAL2 t1 = ((const REAL2*) jones)[
+                                SP * num_sources + rep];
+                        const REAL2 t2 = ((const REAL2*) jones)[
+                                SQ * num_sources + rep];
+                        OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+                        const double f = smearing * node_flux[0];
+                        sum_s.x += t1.x * f; sum_s.y += t1.y * f;
+                    }
+                    error += bound;
+                    terms += 1.0;
+                }
+                else if (node->first_child < 0)
+                {
+                    // Sum all sources in the leaf node exactly.
+                    for (int k = node->start; k < node->end; ++k)
+                    {
+                        const int i = order[k];
+                        REAL smearing;
+                        smearing_terms(smearing, source_l, source_m,
+                                source_n, i, bandwidth_smearing,
+                                time_smearing, uu, vv, ww, du, dv, dw);
+                        if (MATRIX)
+                        {
+                            REAL4c m1, m2;
+                            OSKAR_CONSTRUCT_B(REAL, m2, source_I[i],
+                                    source_Q[i], source_U[i], source_V[i])
+                            m1 = ((const REAL4c*) jones)[
+                                    SP * num_sources + i];
+                            OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(
+                                    REAL2, m1, m2)
+                            m2 = ((const REAL4c*) jones)[
+                                    SQ * num_sources + i];
+                            OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(
+                                    REAL2, m1, m2)
+                            OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum_m, m1,
+                                    (double) smearing)
+                        }
+                        else
+                        {
+                            REAL2 t1 = ((const REAL2*) jones)[
+                                    SP * num_sources + i];
+                            const REAL2 t2 = ((const REAL2*) jones)[
+                                    SQ * num_sources + i];
+                            OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+                            const double f = (double) smearing * source_I[i];
+                            sum_s.x += t1.x * f; sum_s.y += t1.y * f;
+                        }
+                    }
+                    terms += node->end - node->start;
+                }
+                else
+                {
+                    // Descend to the children.
+                    stack[top++] = node->first_child + 1;
+                    stack[top++] = node->first_child;
+                }
+            }
+            terms_exact += num_sources;
+            if (error > error_max) error_max = error;
+
+            // Add result to the baseline visibility.
+            const int j = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) +
+                    offset_out;
+            if (MATRIX)
+            {
+                REAL4c* v = &((REAL4c*) vis)[j];
+                v->a.x += (REAL) sum_m.a.x; v->a.y += (REAL) sum_m.a.y;
+                v->b.x += (REAL) sum_m.b.x; v->b.y += (REAL) sum_m.b.y;
+                v->c.x += (REAL) sum_m.c.x; v->c.y += (REAL) sum_m.c.y;
+                v->d.x += (REAL) sum_m.d.x; v->d.y += (REAL) sum_m.d.y;
+            }
+            else
+            {
+                REAL2* v = &((REAL2*) vis)[j];
+                v->x += (REAL) sum_s.x; v->y += (REAL) sum_s.y;
+            }
+        }
+    }
+    *num_terms += terms;
+    *num_terms_exact += terms_exact;
+    if (error_max > *max_error_bound) *max_error_bound = error_max;
+}
+
+#define XCORR_LOD(MATRIX, REAL, REAL2, REAL4c, CONST_PTR)                   \
+        oskar_xcorr_lod_omp<MATRIX, REAL, REAL2, REAL4c>(                   \
+                tree, tolerance, num_sources, num_stations, offset_out,     \
+                oskar_mem_void_const(oskar_jones_mem_const(jones)),         \
+                CONST_PTR(src_flux[0], status),                             \
+                CONST_PTR(src_flux[1], status),                             \
+                CONST_PTR(src_flux[2], status),                             \
+                CONST_PTR(src_flux[3], status),                             \
+                CONST_PTR(src_dir[0], status),                              \
+                CONST_PTR(src_dir[1], status),                              \
+                CONST_PTR(src_dir[2], status),                              \
+                CONST_PTR(station_uvw[0], status),                          \
+                CONST_PTR(station_uvw[1], status),                          \
+                CONST_PTR(station_uvw[2], status),                          \
+                CONST_PTR(x, status), CONST_PTR(y, status),                 \
+                (REAL) uv_filter_min, (REAL) uv_filter_max,                 \
+                (REAL) inv_wavelength, (REAL) frac_bandwidth,               \
+                (REAL) time_avg, (REAL) gha0, (REAL) dec0,                  \
+                oskar_mem_void(vis), num_terms, num_terms_exact,            \
+                max_error_bound);
+
+extern "C"
+void oskar_cross_correlate_lod(
+        oskar_SourceTree* tree,
+        double tolerance,
+        int num_sources,
+        const oskar_Jones* jones,
+        const oskar_Mem* const src_flux[4],
+        const oskar_Mem* const src_dir[3],
+        const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3],
+        double gast,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* vis,
+        double* num_terms,
+        double* num_terms_exact,
+        double* max_error_bound,
+        int* status)
+{
+    double uv_filter_min, uv_filter_max;
+    double time_avg = 0.0, gha0 = 0.0, dec0 = 0.0;
+    if (*status) return;
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / frequency_hz;
+
+    /* Get time-average smearing terms.
+     * Ignore if drift scanning - this will need to be done differently. */
+    if (oskar_telescope_phase_centre_coord_type(tel) != OSKAR_COORDS_AZEL)
+    {
+        time_avg = oskar_telescope_time_average_sec(tel);
+        gha0 = gast - oskar_telescope_phase_centre_longitude_rad(tel);
+        dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    }
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Check data locations. */
+    if (oskar_jones_mem_location(jones) != OSKAR_CPU ||
+            oskar_telescope_mem_location(tel) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[0]) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[1]) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[2]) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check for consistent data types. */
+    const int jones_type = oskar_jones_type(jones);
+    const int base_type = oskar_type_precision(jones_type);
+    if (oskar_mem_type(vis) != jones_type ||
+            oskar_mem_type(station_uvw[0]) != base_type ||
+            oskar_mem_type(station_uvw[1]) != base_type ||
+            oskar_mem_type(station_uvw[2]) != base_type ||
+            oskar_mem_type(src_flux[0]) != base_type ||
+            oskar_mem_type(src_dir[0]) != base_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Check the input dimensions. */
+    if (oskar_jones_num_sources(jones) < num_sources ||
+            oskar_source_tree_num_sources(tree) != num_sources ||
+            (int)oskar_mem_length(station_uvw[0]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[1]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[2]) != num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (num_sources == 0) return;
+
+    /* Sum the source fluxes in each node of the tree. */
+    update_flux(tree, oskar_type_is_matrix(jones_type), src_flux, status);
+    if (*status) return;
+
+    /* Make space for the norms of the Jones matrices. */
+    const size_t num_norms = (size_t) num_stations * tree->num_nodes;
+    if (num_norms > tree->capacity_jones_norm)
+    {
+        double* t = (double*) realloc(tree->jones_norm,
+                num_norms * sizeof(double));
+        if (!t)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        tree->jones_norm = t;
+        tree->capacity_jones_norm = num_norms;
+    }
+
+    /* Select kernel. */
+    const oskar_Mem* x =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    const oskar_Mem* y =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+    switch (jones_type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        XCORR_LOD(true, float, float2, float4c, oskar_mem_float_const)
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        XCORR_LOD(true, double, double2, double4c, oskar_mem_double_const)
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        XCORR_LOD(false, float, float2, float4c, oskar_mem_float_const)
+        break;
+    case OSKAR_DOUBLE_COMPLEX:
+        XCORR_LOD(false, double, double2, double4c, oskar_mem_double_const)
+        break;
+    default:
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+}
+
+
+static void update_flux(oskar_SourceTree* tree, int matrix,
+        const oskar_Mem* const src_flux[4], int* status)
+{
+    int i, j, k;
+    const int num_stokes = matrix ? 4 : 1;
+    const int type = oskar_mem_type(src_flux[0]);
+    const int* order = tree->order;
+    const void* stokes[4];
+    for (j = 0; j < num_stokes; ++j)
+    {
+        if (oskar_mem_type(src_flux[j]) != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        stokes[j] = oskar_mem_void_const(src_flux[j]);
+    }
+    for (i = tree->num_nodes - 1; i >= 0; --i)
+    {
+        const oskar_SourceTreeNode* node = &tree->nodes[i];
+        double* node_flux = &tree->flux[OSKAR_SOURCE_TREE_FLUX_VALUES * i];
+        for (j = 0; j < OSKAR_SOURCE_TREE_FLUX_VALUES; ++j)
+            node_flux[j] = 0.0;
+        if (node->first_child >= 0)
+        {
+            // Children follow their parent, so they have been done already.
+            const double* c1 = &tree->flux[
+                    OSKAR_SOURCE_TREE_FLUX_VALUES * node->first_child];
+            const double* c2 = c1 + OSKAR_SOURCE_TREE_FLUX_VALUES;
+            for (j = 0; j < OSKAR_SOURCE_TREE_FLUX_VALUES; ++j)
+                node_flux[j] = c1[j] + c2[j];
+            continue;
+        }
+        for (k = node->start; k < node->end; ++k)
+        {
+            double s[4] = {0.0, 0.0, 0.0, 0.0};
+            const int src = order[k];
+            for (j = 0; j < num_stokes; ++j)
+            {
+                s[j] = (type == OSKAR_DOUBLE) ?
+                        ((const double*) stokes[j])[src] :
+                        ((const float*) stokes[j])[src];
+                node_flux[j] += s[j];
+            }
+
+            // The eigenvalues of the brightness matrix are
+            // I +/- sqrt(Q^2 + U^2 + V^2).
+            node_flux[4] += fabs(s[0]) +
+                    sqrt(s[1] * s[1] + s[2] * s[2] + s[3] * s[3]);
+        }
+    }
+}
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/oskar_source_tree.h"
+#include "correlate/private_source_tree.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of sources in a leaf node. */
+#define LEAF_SIZE 8
+
+typedef struct Build
+{
+    oskar_SourceTree* tree;
+    double* coord; /* Scratch space for finding the median. */
+    double* lmn;   /* Scratch space for partitioning. */
+    int* order;    /* Scratch space for partitioning. */
+    int* status;
+} Build;
+
+static void build_node(Build* b, int node);
+static double select_nth(double* values, int num, int nth);
+static void partition(Build* b, int start, int end, int mid, int axis);
+static int new_nodes(oskar_SourceTree* tree, int num, int* status);
+
+
+oskar_SourceTree* oskar_source_tree_create(void)
+{
+    return (oskar_SourceTree*) calloc(1, sizeof(oskar_SourceTree));
+}
+
+
+void oskar_source_tree_build(oskar_SourceTree* tree, int num_sources,
+        const oskar_Mem* const src_dir[3], int* status)
+{
+    int i, j;
+    if (*status) return;
+    tree->num_sources = 0;
+    tree->num_nodes = 0;
+    const int type = oskar_mem_type(src_dir[0]);
+    for (j = 0; j < 3; ++j)
+    {
+        if (oskar_mem_location(src_dir[j]) != OSKAR_CPU)
+        {
+            *status = OSKAR_ERR_BAD_LOCATION;
+            return;
+        }
+        if (oskar_mem_type(src_dir[j]) != type ||
+                (type != OSKAR_SINGLE && type != OSKAR_DOUBLE))
+        {
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        if (num_sources < 0 ||
+                (size_t) num_sources > oskar_mem_length(src_dir[j]))
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            return;
+        }
+    }
+    if (num_sources == 0) return;
+
+    /* Resize the source arrays if needed. */
+    if (num_sources > tree->capacity_sources)
+    {
+        int* t_order = (int*) realloc(tree->order, num_sources * sizeof(int));
+        if (t_order) tree->order = t_order;
+        double* t_lmn = (double*) realloc(tree->lmn,
+                3 * (size_t) num_sources * sizeof(double));
+        if (t_lmn) tree->lmn = t_lmn;
+        if (!t_order || !t_lmn)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        tree->capacity_sources = num_sources;
+    }
+
+    /* Copy the direction cosines. */
+    for (j = 0; j < 3; ++j)
+    {
+        if (type == OSKAR_DOUBLE)
+        {
+            const double* p = oskar_mem_double_const(src_dir[j], status);
+            for (i = 0; i < num_sources; ++i) tree->lmn[3 * i + j] = p[i];
+        }
+        else
+        {
+            const float* p = oskar_mem_float_const(src_dir[j], status);
+            for (i = 0; i < num_sources; ++i) tree->lmn[3 * i + j] = p[i];
+        }
+    }
+    for (i = 0; i < num_sources; ++i) tree->order[i] = i;
+    tree->num_sources = num_sources;
+
+    /* Build the tree from the root node. */
+    Build b;
+    b.tree = tree;
+    b.status = status;
+    b.coord = (double*) malloc(num_sources * sizeof(double));
+    b.lmn = (double*) malloc(3 * (size_t) num_sources * sizeof(double));
+    b.order = (int*) malloc(num_sources * sizeof(int));
+    const int root = new_nodes(tree, 1, status);
+    if (!b.coord || !b.lmn || !b.order)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (!*status)
+    {
+        tree->nodes[root].end = num_sources;
+        build_node(&b, root);
+    }
+    free(b.coord);
+    free(b.lmn);
+    free(b.order);
+    if (*status) return;
+
+    /* Make space for the sums of flux in each node. */
+    double* t = (double*) realloc(tree->flux, (size_t) tree->capacity_nodes *
+            OSKAR_SOURCE_TREE_FLUX_VALUES * sizeof(double));
+    if (!t)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    tree->flux = t;
+}
+
+
+int oskar_source_tree_num_sources(const oskar_SourceTree* tree)
+{
+    return tree->num_sources;
+}
+
+
+int oskar_source_tree_num_nodes(const oskar_SourceTree* tree)
+{
+    return tree->num_nodes;
+}
+
+
+const int* oskar_source_tree_order(const oskar_SourceTree* tree)
+{
+    return tree->order;
+}
+
+
+void oskar_source_tree_free(oskar_SourceTree* tree)
+{
+    if (!tree) return;
+    free(tree->order);
+    free(tree->lmn);
+    free(tree->nodes);
+    free(tree->flux);
+    free(tree->jones_norm);
+    free(tree);
+}
+
+
+static void build_node(Build* b, int node)
+{
+    oskar_SourceTree* tree = b->tree;
+    int i, j, axis = 0, rep = 0;
+    double min[3], max[3], centre[3], extent = -1.0, d2_min = DBL_MAX;
+    double d2_max = 0.0;
+    const int start = tree->nodes[node].start, end = tree->nodes[node].end;
+    const double* lmn = tree->lmn;
+
+    /* Find the bounding box, and the source closest to its centre. */
+    for (j = 0; j < 3; ++j)
+    {
+        min[j] = DBL_MAX;
+        max[j] = -DBL_MAX;
+    }
+    for (i = start; i < end; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+        {
+            if (lmn[3 * i + j] < min[j]) min[j] = lmn[3 * i + j];
+            if (lmn[3 * i + j] > max[j]) max[j] = lmn[3 * i + j];
+        }
+    }
+    for (j = 0; j < 3; ++j)
+    {
+        centre[j] = 0.5 * (min[j] + max[j]);
+        if (max[j] - min[j] > extent)
+        {
+            extent = max[j] - min[j];
+            axis = j;
+        }
+    }
+    for (i = start; i < end; ++i)
+    {
+        double d2 = 0.0;
+        for (j = 0; j < 3; ++j)
+            d2 += (lmn[3 * i + j] - centre[j]) * (lmn[3 * i + j] - centre[j]);
+        if (d2 < d2_min)
+        {
+            d2_min = d2;
+            rep = i;
+        }
+    }
+    for (i = start; i < end; ++i)
+    {
+        double d2 = 0.0;
+        for (j = 0; j < 3; ++j)
+            d2 += (lmn[3 * i + j] - lmn[3 * rep + j]) *
+                    (lmn[3 * i + j] - lmn[3 * rep + j]);
+        if (d2 > d2_max) d2_max = d2;
+    }
+    tree->nodes[node].rep = tree->order[rep];
+    tree->nodes[node].radius = sqrt(d2_max);
+    tree->nodes[node].first_child = -1;
+
+    /* Split the node in half along its longest axis, unless it is small
+     * enough or its sources are coincident. */
+    if (end - start <= LEAF_SIZE || extent <= 0.0) return;
+    const int mid = (start + end) / 2;
+    partition(b, start, end, mid, axis);
+    const int first = new_nodes(tree, 2, b->status);
+    if (*b->status) return;
+    tree->nodes[node].first_child = first;
+    tree->nodes[first].start = start;
+    tree->nodes[first].end = mid;
+    tree->nodes[first + 1].start = mid;
+    tree->nodes[first + 1].end = end;
+    build_node(b, first);
+    build_node(b, first + 1);
+}
+
+
+static void partition(Build* b, int start, int end, int mid, int axis)
+{
+    /* Move the (mid - start) sources with the smallest coordinates
+     * to the start of the range, keeping the order of the sources on
+     * each side, so that sources which are already in tree order
+     * stay in the same order if the tree is built again. */
+    int i, j, num_left = 0, num_right = 0, num_equal;
+    oskar_SourceTree* tree = b->tree;
+    const int num = end - start;
+    for (i = 0; i < num; ++i)
+        b->coord[i] = tree->lmn[3 * (start + i) + axis];
+    const double median = select_nth(b->coord, num, mid - start);
+    for (i = start, num_equal = 0; i < end; ++i)
+        if (tree->lmn[3 * i + axis] < median) num_equal++;
+    num_equal = (mid - start) - num_equal;
+    for (i = start; i < end; ++i)
+    {
+        const double v = tree->lmn[3 * i + axis];
+        int k;
+        if (v < median || (v == median && num_equal-- > 0))
+            k = num_left++;
+        else
+            k = (mid - start) + num_right++;
+        b->order[k] = tree->order[i];
+        for (j = 0; j < 3; ++j) b->lmn[3 * k + j] = tree->lmn[3 * i + j];
+    }
+    memcpy(&tree->order[start], b->order, num * sizeof(int));
+    memcpy(&tree->lmn[3 * start], b->lmn, 3 * (size_t) num * sizeof(double));
+}
+
+
+static double select_nth(double* values, int num, int nth)
+{
+    /* Quickselect, to find the value that would be at nth if sorted. */
+    int lo = 0, hi = num - 1;
+    while (hi > lo)
+    {
+        int i = lo, j = hi;
+        const double pivot = values[(lo + hi) / 2];
+        while (i <= j)
+        {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j)
+            {
+                const double t = values[i];
+                values[i++] = values[j];
+                values[j--] = t;
+            }
+        }
+        if (nth <= j) hi = j;
+        else if (nth >= i) lo = i;
+        else break;
+    }
+    return values[nth];
+}
+
+
+static int new_nodes(oskar_SourceTree* tree, int num, int* status)
+{
+    const int first = tree->num_nodes;
+    if (first + num > tree->capacity_nodes)
+    {
+        int capacity = 2 * tree->capacity_nodes;
+        if (capacity < first + num)
+            capacity = first + num + 4 * (tree->num_sources / LEAF_SIZE);
+        oskar_SourceTreeNode* t = (oskar_SourceTreeNode*) realloc(
+                tree->nodes, capacity * sizeof(oskar_SourceTreeNode));
+        if (!t)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return -1;
+        }
+        tree->nodes = t;
+        tree->capacity_nodes = capacity;
+    }
+    memset(&tree->nodes[first], 0, num * sizeof(oskar_SourceTreeNode));
+    tree->num_nodes += num;
+    return first;
+}
+
+#ifdef __cplusplus
+}
+#endif
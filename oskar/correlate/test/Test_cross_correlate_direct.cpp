@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_direct.h"
+#include "interferometer/oskar_evaluate_jones_chain.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+#include <cstdlib>
+
+static void run_test(int precision, int use_beam, int use_gains,
+        int extended, double bandwidth_hz, double time_average_sec,
+        double tol)
+{
+    const int num_sources = 400, num_stations = 30;
+    const int type = precision | OSKAR_COMPLEX;
+    const double frequency_hz = 100e6, I_min = 0.1, I_max = 1.0;
+    int status = 0;
+
+    // Create random sources, station coordinates, beams and gains.
+    oskar_Mem *src_dir[3], *src_ext[3], *src_flux[4], *uvw[3];
+    oskar_Telescope* tel = oskar_telescope_create(precision, OSKAR_CPU,
+            num_stations, &status);
+    oskar_telescope_set_channel_bandwidth(tel, bandwidth_hz);
+    oskar_telescope_set_time_average(tel, time_average_sec);
+    for (int i = 0; i < 3; ++i)
+    {
+        src_dir[i] = oskar_mem_create(precision, OSKAR_CPU, num_sources,
+                &status);
+        src_ext[i] = oskar_mem_create(precision, OSKAR_CPU, num_sources,
+                &status);
+        uvw[i] = oskar_mem_create(precision, OSKAR_CPU, num_stations,
+                &status);
+    }
+    for (int i = 0; i < 4; ++i)
+        src_flux[i] = oskar_mem_create(precision, OSKAR_CPU, num_sources,
+                &status);
+    oskar_Jones* E = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* J = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* gains = oskar_mem_create(type, OSKAR_CPU, num_stations,
+            &status);
+    srand(5);
+    oskar_mem_random_range(uvw[0], -1000.0, 1000.0, &status);
+    oskar_mem_random_range(uvw[1], -1000.0, 1000.0, &status);
+    oskar_mem_random_range(uvw[2], -50.0, 50.0, &status);
+    oskar_mem_random_range(src_dir[0], -0.3, 0.3, &status);
+    oskar_mem_random_range(src_dir[1], -0.3, 0.3, &status);
+    oskar_mem_random_range(src_dir[2], 0.9, 1.0, &status);
+    oskar_mem_random_range(src_flux[0], 0.0, 1.0, &status);
+    oskar_mem_random_range(src_ext[0], 0.0, 1e-6, &status);
+    oskar_mem_random_range(src_ext[1], 0.0, 1e-6, &status);
+    oskar_mem_random_range(src_ext[2], 0.0, 1e-6, &status);
+    oskar_mem_random_range(
+            oskar_telescope_station_true_offset_ecef_metres(tel, 0),
+            -1000.0, 1000.0, &status);
+    oskar_mem_random_range(
+            oskar_telescope_station_true_offset_ecef_metres(tel, 1),
+            -1000.0, 1000.0, &status);
+    oskar_mem_random_range(gains, 0.5, 1.0, &status);
+    if (use_beam)
+        oskar_mem_random_range(oskar_jones_mem(E), -1.0, 1.0, &status);
+    else
+        oskar_mem_set_value_real(oskar_jones_mem(E), 1.0, 0,
+                num_stations * num_sources, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Correlate the full Jones chain, and directly.
+    const int num_baselines = oskar_telescope_num_baselines(tel);
+    oskar_Mem* vis = oskar_mem_create(type, OSKAR_CPU, num_baselines,
+            &status);
+    oskar_Mem* vis_direct = oskar_mem_create(type, OSKAR_CPU, num_baselines,
+            &status);
+    oskar_mem_clear_contents(vis, &status);
+    oskar_mem_clear_contents(vis_direct, &status);
+    oskar_evaluate_jones_chain(J, num_sources,
+            src_dir[0], src_dir[1], src_dir[2], uvw[0], uvw[1], uvw[2],
+            frequency_hz, src_flux[0], I_min, I_max, 0, E, 0,
+            use_gains ? gains : 0, &status);
+    oskar_cross_correlate(extended, num_sources, J, src_flux, src_dir,
+            src_ext, tel, uvw, 1.0, frequency_hz, 0, vis, &status);
+    oskar_cross_correlate_direct(extended, num_sources, use_beam ? E : 0,
+            use_gains ? gains : 0, src_flux[0], src_dir, src_ext,
+            I_min, I_max, tel, uvw, 1.0, frequency_hz, 0, vis_direct,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are consistent.
+    double max_err = 0.0, avg_err = 0.0;
+    oskar_mem_evaluate_relative_error(vis_direct, vis, 0,
+            &max_err, &avg_err, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(avg_err, tol);
+
+    // Clean up.
+    for (int i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(src_dir[i], &status);
+        oskar_mem_free(src_ext[i], &status);
+        oskar_mem_free(uvw[i], &status);
+    }
+    for (int i = 0; i < 4; ++i)
+        oskar_mem_free(src_flux[i], &status);
+    oskar_mem_free(gains, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(vis_direct, &status);
+    oskar_jones_free(E, &status);
+    oskar_jones_free(J, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(cross_correlate_direct, isotropic)
+{
+    run_test(OSKAR_DOUBLE, 0, 0, 0, 0.0, 0.0, 1e-10);
+    run_test(OSKAR_SINGLE, 0, 0, 0, 0.0, 0.0, 1e-3);
+}
+
+TEST(cross_correlate_direct, beam_and_gains)
+{
+    for (int i = 1; i < 4; ++i)
+    {
+        run_test(OSKAR_DOUBLE, i & 1, i & 2, 0, 0.0, 0.0, 1e-10);
+        run_test(OSKAR_SINGLE, i & 1, i & 2, 0, 0.0, 0.0, 1e-3);
+    }
+}
+
+TEST(cross_correlate_direct, smearing_and_extended)
+{
+    run_test(OSKAR_DOUBLE, 1, 1, 0, 1e6, 0.0, 1e-10);
+    run_test(OSKAR_DOUBLE, 1, 1, 0, 0.0, 10.0, 1e-10);
+    run_test(OSKAR_DOUBLE, 1, 1, 1, 1e6, 10.0, 1e-10);
+    run_test(OSKAR_SINGLE, 1, 1, 1, 1e6, 10.0, 1e-3);
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_lod.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+#include <cstdlib>
+
+static void convert(oskar_Mem** mem, int precision, int* status)
+{
+    oskar_Mem* t = oskar_mem_convert_precision(*mem, precision, status);
+    oskar_mem_free(*mem, status);
+    *mem = t;
+}
+
+class cross_correlate_lod : public ::testing::Test
+{
+protected:
+    static const int num_sources = 3000;
+    static const int num_stations = 24;
+    oskar_Mem *src_dir[3], *src_ext[3], *src_flux[4], *uvw[3];
+    oskar_Telescope* tel;
+    oskar_Jones* jones;
+    double frequency_hz;
+
+    void create_test_data(int precision, int matrix)
+    {
+        int status = 0, type = precision | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        frequency_hz = 100e6;
+        const double inv_wavelength = frequency_hz / 299792458.0;
+        jones = oskar_jones_create(type, OSKAR_CPU, num_stations, num_sources,
+                &status);
+        tel = oskar_telescope_create(precision, OSKAR_CPU,
+                num_stations, &status);
+        for (int i = 0; i < 3; ++i)
+        {
+            src_dir[i] = oskar_mem_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+            src_ext[i] = oskar_mem_create(
+                    precision, OSKAR_CPU, num_sources, &status);
+            uvw[i] = oskar_mem_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+        }
+        for (int i = 0; i < 4; ++i)
+            src_flux[i] = oskar_mem_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, num_sources, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // A compact array, and a small field containing many faint sources
+        // and a few bright ones.
+        srand(3);
+        oskar_mem_random_range(uvw[0], -300.0, 300.0, &status);
+        oskar_mem_random_range(uvw[1], -300.0, 300.0, &status);
+        oskar_mem_random_range(uvw[2], -20.0, 20.0, &status);
+        oskar_mem_random_range(src_dir[0], -0.05, 0.05, &status);
+        oskar_mem_random_range(src_dir[1], -0.05, 0.05, &status);
+        oskar_mem_random_range(src_flux[0], 0.0, 1.0, &status);
+        oskar_mem_random_range(src_flux[1], -0.1, 0.1, &status);
+        oskar_mem_random_range(src_flux[2], -0.1, 0.1, &status);
+        oskar_mem_random_range(src_flux[3], -0.01, 0.01, &status);
+        oskar_mem_random_range(src_ext[0], 0.0, 0.0, &status);
+        oskar_mem_random_range(src_ext[1], 0.0, 0.0, &status);
+        oskar_mem_random_range(src_ext[2], 0.0, 0.0, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, 0),
+                -300.0, 300.0, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, 1),
+                -300.0, 300.0, &status);
+        double* l = oskar_mem_double(src_dir[0], &status);
+        double* m = oskar_mem_double(src_dir[1], &status);
+        double* n = oskar_mem_double(src_dir[2], &status);
+        double* I = oskar_mem_double(src_flux[0], &status);
+        double* Q = oskar_mem_double(src_flux[1], &status);
+        double* U = oskar_mem_double(src_flux[2], &status);
+        double* V = oskar_mem_double(src_flux[3], &status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            n[i] = sqrt(1.0 - l[i] * l[i] - m[i] * m[i]);
+            I[i] = (i % 100 == 0) ? 10.0 : 0.01 * pow(I[i], 4.0);
+            Q[i] *= I[i];
+            U[i] *= I[i];
+            V[i] *= I[i];
+        }
+
+        // Jones matrices are a constant, nearly diagonal gain for each station,
+        // multiplied by the interferometer phase.
+        const double* u = oskar_mem_double_const(uvw[0], &status);
+        const double* v = oskar_mem_double_const(uvw[1], &status);
+        const double* w = oskar_mem_double_const(uvw[2], &status);
+        oskar_Mem* J = oskar_mem_create(
+                (type & ~OSKAR_SINGLE) | OSKAR_DOUBLE, OSKAR_CPU,
+                num_stations * num_sources, &status);
+        double* j = oskar_mem_double(J, &status);
+        const int num_values = matrix ? 8 : 2;
+        for (int s = 0; s < num_stations; ++s)
+        {
+            double g[8];
+            for (int k = 0; k < num_values; ++k)
+            {
+                const bool diagonal_real = (k == 0 || k == 6);
+                const double r = (double) rand() / RAND_MAX;
+                g[k] = diagonal_real ? 0.8 + 0.4 * r : 0.1 * r;
+            }
+            for (int i = 0; i < num_sources; ++i)
+            {
+                const double phase = 2.0 * M_PI * inv_wavelength * (
+                        u[s] * l[i] + v[s] * m[i] + w[s] * (n[i] - 1.0));
+                const double re = cos(phase), im = sin(phase);
+                double* t = &j[num_values * (s * num_sources + i)];
+                for (int k = 0; k < num_values; k += 2)
+                {
+                    t[k] = g[k] * re - g[k + 1] * im;
+                    t[k + 1] = g[k] * im + g[k + 1] * re;
+                }
+            }
+        }
+        convert(&J, precision, &status);
+        oskar_mem_copy(oskar_jones_mem(jones), J, &status);
+        oskar_mem_free(J, &status);
+        for (int i = 0; i < 3; ++i)
+        {
+            convert(&src_dir[i], precision, &status);
+            convert(&uvw[i], precision, &status);
+        }
+        for (int i = 0; i < 4; ++i)
+            convert(&src_flux[i], precision, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void destroy_test_data()
+    {
+        int status = 0;
+        oskar_jones_free(jones, &status);
+        for (int i = 0; i < 3; ++i)
+        {
+            oskar_mem_free(src_dir[i], &status);
+            oskar_mem_free(src_ext[i], &status);
+            oskar_mem_free(uvw[i], &status);
+        }
+        for (int i = 0; i < 4; ++i)
+            oskar_mem_free(src_flux[i], &status);
+        oskar_telescope_free(tel, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+
+    void run_test(int precision, int matrix, double tolerance,
+            double bandwidth_hz, double time_average_sec)
+    {
+        int status = 0, type = precision | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        double num_terms = 0.0, num_terms_exact = 0.0, max_error = 0.0;
+        create_test_data(precision, matrix);
+        oskar_telescope_set_channel_bandwidth(tel, bandwidth_hz);
+        oskar_telescope_set_time_average(tel, time_average_sec);
+        const int num_baselines = oskar_telescope_num_baselines(tel);
+        oskar_Mem* vis_exact = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_Mem* vis_lod = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_mem_clear_contents(vis_exact, &status);
+        oskar_mem_clear_contents(vis_lod, &status);
+
+        // Evaluate visibilities exactly, and using the source tree.
+        oskar_SourceTree* tree = oskar_source_tree_create();
+        oskar_source_tree_build(tree, num_sources, src_dir, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(num_sources + 0, oskar_source_tree_num_sources(tree));
+        EXPECT_GT(oskar_source_tree_num_nodes(tree), num_sources / 8);
+        oskar_cross_correlate(0, num_sources, jones, src_flux, src_dir,
+                src_ext, tel, uvw, 1.0, frequency_hz, 0, vis_exact, &status);
+        oskar_cross_correlate_lod(tree, tolerance, num_sources, jones,
+                src_flux, src_dir, tel, uvw, 1.0, frequency_hz, 0, vis_lod,
+                &num_terms, &num_terms_exact, &max_error, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_DOUBLE_EQ((double) num_sources * num_baselines,
+                num_terms_exact);
+
+        // Check the differences are within the error bound.
+        convert(&vis_exact, OSKAR_DOUBLE, &status);
+        convert(&vis_lod, OSKAR_DOUBLE, &status);
+        const double* v1 = oskar_mem_double_const(vis_exact, &status);
+        const double* v2 = oskar_mem_double_const(vis_lod, &status);
+        const int num_values = 2 * num_baselines * (matrix ? 4 : 1);
+        double max_diff = 0.0, max_abs = 0.0;
+        for (int i = 0; i < num_values; ++i)
+        {
+            const double diff = fabs(v1[i] - v2[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (fabs(v1[i]) > max_abs) max_abs = fabs(v1[i]);
+        }
+        const double rounding = max_abs *
+                (precision == OSKAR_DOUBLE ? 1e-12 : 1e-5);
+        EXPECT_LE(max_diff, max_error + rounding);
+        if (tolerance == 0.0)
+        {
+            EXPECT_EQ(0.0, max_error);
+            EXPECT_DOUBLE_EQ(num_terms_exact, num_terms);
+        }
+        else
+        {
+            EXPECT_GT(max_error, 0.0);
+            EXPECT_LT(num_terms, 0.5 * num_terms_exact);
+        }
+        RecordProperty("SpeedUp", int(num_terms_exact / num_terms));
+
+        oskar_source_tree_free(tree);
+        oskar_mem_free(vis_exact, &status);
+        oskar_mem_free(vis_lod, &status);
+        destroy_test_data();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+};
+
+TEST_F(cross_correlate_lod, exact_with_zero_tolerance)
+{
+    run_test(OSKAR_DOUBLE, 1, 0.0, 0.0, 0.0);
+    run_test(OSKAR_DOUBLE, 0, 0.0, 0.0, 0.0);
+}
+
+TEST_F(cross_correlate_lod, matrix_double)
+{
+    run_test(OSKAR_DOUBLE, 1, 0.05, 0.0, 0.0);
+}
+
+TEST_F(cross_correlate_lod, matrix_double_smearing)
+{
+    run_test(OSKAR_DOUBLE, 1, 0.05, 1e6, 10.0);
+}
+
+TEST_F(cross_correlate_lod, scalar_double)
+{
+    run_test(OSKAR_DOUBLE, 0, 0.05, 0.0, 0.0);
+}
+
+TEST_F(cross_correlate_lod, matrix_single)
+{
+    run_test(OSKAR_SINGLE, 1, 0.05, 1e6, 10.0);
+}
+
+TEST_F(cross_correlate_lod, scalar_single)
+{
+    run_test(OSKAR_SINGLE, 0, 0.05, 0.0, 0.0);
+}
+
+TEST_F(cross_correlate_lod, tree_matches_source_count)
+{
+    int status = 0;
+    create_test_data(OSKAR_DOUBLE, 0);
+    oskar_SourceTree* tree = oskar_source_tree_create();
+    oskar_source_tree_build(tree, num_sources / 2, src_dir, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double num_terms = 0.0, num_terms_exact = 0.0, max_error = 0.0;
+    oskar_Mem* vis = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            oskar_telescope_num_baselines(tel), &status);
+    oskar_cross_correlate_lod(tree, 0.0, num_sources, jones,
+            src_flux, src_dir, tel, uvw, 1.0, frequency_hz, 0, vis,
+            &num_terms, &num_terms_exact, &max_error, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+    oskar_mem_free(vis, &status);
+    oskar_source_tree_free(tree);
+    destroy_test_data();
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_DEGRID_SIMPLE_H_
+#define OSKAR_DEGRID_SIMPLE_H_
+
+/**
+ * @file oskar_degrid_simple.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Simple degridding function for 1D real convolution kernel (double precision).
+ *
+ * @details
+ * This is the adjoint of oskar_grid_simple_d(): the visibility at each
+ * (u,v) point is interpolated from the grid using the same convolution
+ * function and coordinate convention, and normalised by the sum of the
+ * convolution function values used.
+ *
+ * Points that would need grid cells outside the grid are set to zero.
+ * Points are processed in parallel.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[in] grid          Complex visibility grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[out] vis          Complex visibilities for each point.
+ */
+OSKAR_EXPORT
+void oskar_degrid_simple_d(
+        const int support,
+        const int oversample,
+        const double* RESTRICT conv_func,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const double cell_size_rad,
+        const int grid_size,
+        const double* RESTRICT grid,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT vis);
+
+/**
+ * @brief
+ * Simple degridding function for 1D real convolution kernel (single precision).
+ *
+ * @details
+ * This is the adjoint of oskar_grid_simple_f(): the visibility at each
+ * (u,v) point is interpolated from the grid using the same convolution
+ * function and coordinate convention, and normalised by the sum of the
+ * convolution function values used.
+ *
+ * Points that would need grid cells outside the grid are set to zero.
+ * Points are processed in parallel.
+ *
+ * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
+ * @param[in] oversample    GCF oversample factor, or values per grid cell.
+ * @param[in] conv_func     GCF array, length oversample * (support + 1).
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] grid_size     Side length of image and grid.
+ * @param[in] grid          Complex visibility grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[out] vis          Complex visibilities for each point.
+ */
+OSKAR_EXPORT
+void oskar_degrid_simple_f(
+        const int support,
+        const int oversample,
+        const float* RESTRICT conv_func,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const float cell_size_rad,
+        const int grid_size,
+        const float* RESTRICT grid,
+        size_t* RESTRICT num_skipped,
+        float* RESTRICT vis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_DEGRID_WPROJ_H_
+#define OSKAR_DEGRID_WPROJ_H_
+
+/**
+ * @file oskar_degrid_wproj.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Degridding function for W-projection (double precision).
+ *
+ * @details
+ * This is the adjoint of oskar_grid_wproj2_d(): the visibility at each
+ * (u,v,w) point is interpolated from the grid using the conjugate of the
+ * W-kernel that would be used to grid it, and normalised by the sum of the
+ * real parts of the kernel values used.
+ *
+ * Points that would need grid cells outside the grid are set to zero.
+ * Points are processed in parallel.
+ *
+ * @param[in] num_w_planes  Number of W-projection planes.
+ * @param[in] support       GCF support size per W-plane.
+ * @param[in] oversample    GCF oversample factor.
+ * @param[in] wkernel_start Start index of each convolution kernel.
+ * @param[in] wkernel       The rearranged convolution kernels.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww            Visibility baseline ww coordinates, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] w_scale       Scaling factor used to find W-plane index.
+ * @param[in] grid_size     Side length of grid.
+ * @param[in] grid          Complex visibility grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[out] vis          Complex visibilities for each point.
+ */
+OSKAR_EXPORT
+void oskar_degrid_wproj_d(
+        const size_t num_w_planes,
+        const int* RESTRICT support,
+        const int oversample,
+        const int* wkernel_start,
+        const double* RESTRICT wkernel,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const double* RESTRICT ww,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        const double* RESTRICT grid,
+        size_t* RESTRICT num_skipped,
+        double* RESTRICT vis);
+
+/**
+ * @brief
+ * Degridding function for W-projection (float precision).
+ *
+ * @details
+ * This is the adjoint of oskar_grid_wproj2_f(): the visibility at each
+ * (u,v,w) point is interpolated from the grid using the conjugate of the
+ * W-kernel that would be used to grid it, and normalised by the sum of the
+ * real parts of the kernel values used.
+ *
+ * Points that would need grid cells outside the grid are set to zero.
+ * Points are processed in parallel.
+ *
+ * @param[in] num_w_planes  Number of W-projection planes.
+ * @param[in] support       GCF support size per W-plane.
+ * @param[in] oversample    GCF oversample factor.
+ * @param[in] wkernel_start Start index of each convolution kernel.
+ * @param[in] wkernel       The rearranged convolution kernels.
+ * @param[in] num_points    Number of visibility points.
+ * @param[in] uu            Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv            Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww            Visibility baseline ww coordinates, in wavelengths.
+ * @param[in] cell_size_rad Cell size, in radians.
+ * @param[in] w_scale       Scaling factor used to find W-plane index.
+ * @param[in] grid_size     Side length of grid.
+ * @param[in] grid          Complex visibility grid.
+ * @param[out] num_skipped  Number of visibilities that fell outside the grid.
+ * @param[out] vis          Complex visibilities for each point.
+ */
+OSKAR_EXPORT
+void oskar_degrid_wproj_f(
+        const size_t num_w_planes,
+        const int* RESTRICT support,
+        const int oversample,
+        const int* wkernel_start,
+        const float* RESTRICT wkernel,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const float* RESTRICT ww,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        const float* RESTRICT grid,
+        size_t* RESTRICT num_skipped,
+        float* RESTRICT vis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
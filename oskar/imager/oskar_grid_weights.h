@@ -12,11 +12,43 @@
 
 #include <oskar_global.h>
 #include <stddef.h>
+#include <stdint.h>
+
+/* Cell index of points which are outside the grid. */
+#define OSKAR_GRID_WEIGHTS_NO_CELL SIZE_MAX
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief
+ * Sorts grid points by the band of rows that contains them.
+ *
+ * @details
+ * Returns the indices of the points in band 0, followed by those in
+ * band 1, and so on, where band b contains rows from b * rows_per_band.
+ * The indices of the points in band b are at positions band_start[b] to
+ * band_start[b + 1] - 1, in their input order, so that weights in each cell
+ * are summed in the same order as in serial. Points with the cell index
+ * OSKAR_GRID_WEIGHTS_NO_CELL are left out.
+ *
+ * The returned array must be freed by the caller. A null pointer is
+ * returned if memory could not be allocated.
+ *
+ * @param[in] num_points        Number of data points.
+ * @param[in] cell              Grid cell index of each point.
+ * @param[in] grid_size         Side length of grid.
+ * @param[in] rows_per_band     Number of grid rows in each band.
+ * @param[in] num_bands         Number of bands.
+ * @param[out] band_start       Start of each band (num_bands + 1 values).
+ */
+OSKAR_EXPORT
+size_t* oskar_grid_weights_sort_by_band(const size_t num_points,
+        const size_t* RESTRICT cell, const int grid_size,
+        const int rows_per_band, const int num_bands,
+        size_t* RESTRICT band_start);
+
 /**
  * @brief
  * Updates gridded weights (double precision).
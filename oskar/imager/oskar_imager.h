@@ -74,7 +74,8 @@ enum OSKAR_IMAGE_WEIGHTING
     OSKAR_WEIGHTING_NATURAL,
     OSKAR_WEIGHTING_RADIAL,
     OSKAR_WEIGHTING_UNIFORM,
-    OSKAR_WEIGHTING_GRIDLESS_UNIFORM
+    OSKAR_WEIGHTING_GRIDLESS_UNIFORM,
+    OSKAR_WEIGHTING_BRIGGS
 };
 
 #ifdef __cplusplus
@@ -87,6 +88,7 @@ enum OSKAR_IMAGE_WEIGHTING
 #include <imager/oskar_imager_finalise.h>
 #include <imager/oskar_imager_free.h>
 #include <imager/oskar_imager_linear_to_stokes.h>
+#include <imager/oskar_imager_predict.h>
 #include <imager/oskar_imager_reset_cache.h>
 #include <imager/oskar_imager_rotate_coords.h>
 #include <imager/oskar_imager_rotate_vis.h>
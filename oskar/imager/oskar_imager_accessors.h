@@ -299,6 +299,16 @@ int oskar_imager_plane_type(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_precision(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the robustness parameter used for Briggs weighting.
+ *
+ * @details
+ * Returns the robustness parameter used for Briggs weighting.
+ */
+OSKAR_EXPORT
+double oskar_imager_robust(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the option to scale image normalisation by the number of input files.
@@ -650,6 +660,21 @@ void oskar_imager_set_output_root(oskar_Imager* h, const char* filename);
 OSKAR_EXPORT
 void oskar_imager_set_oversample(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the robustness parameter used for Briggs weighting.
+ *
+ * @details
+ * Sets the robustness parameter used for Briggs weighting.
+ * Values typically range from -2 (close to uniform weighting)
+ * to +2 (close to natural weighting).
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Briggs robustness parameter.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_robust(oskar_Imager* h, double value);
+
 /**
  * @brief
  * Sets the option to scale image normalisation with number of input files.
@@ -790,13 +815,33 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the range of baseline W coordinates used for W-projection.
+ *
+ * @details
+ * Sets the statistics of the magnitudes of the baseline W coordinates,
+ * in wavelengths, used to choose the W-projection kernels.
+ * These are normally found from the visibility data in a first pass
+ * over the coordinates, but must be set explicitly when the imager is used
+ * only to predict visibilities.
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] ww_min           Minimum of |W|, in wavelengths.
+ * @param[in] ww_max           Maximum of |W|, in wavelengths.
+ * @param[in] ww_rms           RMS of |W|, in wavelengths.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_range(oskar_Imager* h,
+        double ww_min, double ww_max, double ww_rms);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
  *
  * @details
  * Sets the visibility weighting scheme to use,
- * either "Natural", "Radial" or "Uniform".
+ * either "Natural", "Radial", "Uniform" or "Briggs".
  *
  * @param[in,out] h            Handle to imager.
  * @param[in] type             Visibility weighting type string, as above.
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_PREDICT_H_
+#define OSKAR_IMAGER_PREDICT_H_
+
+/**
+ * @file oskar_imager_predict.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Sets the model image used to predict visibilities.
+ *
+ * @details
+ * Sets the model image from which visibilities are predicted by
+ * oskar_imager_predict(), using the current imaging algorithm.
+ *
+ * The image must be real-valued, in host memory, and contain at least
+ * image_size * image_size pixels, in Jy/pixel, laid out in the same way
+ * as the images made by the imager.
+ * The image size, cell size and image centre must be set first.
+ *
+ * For the FFT-based algorithms, the image is transformed here to a grid
+ * using the adjoint of the transform used for imaging, so the same
+ * convolution kernels and FFT plan are reused for prediction.
+ * For the DFT algorithms, only the non-zero pixels are stored.
+ *
+ * The model is cleared if the imager is reset or finalised.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] image          Model image, in Jy/pixel.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_model_image(oskar_Imager* h, const oskar_Mem* image,
+        int* status);
+
+/**
+ * @brief
+ * Reads the model image used to predict visibilities from a FITS file.
+ *
+ * @details
+ * Reads the first plane of a FITS image, converts its pixels to Jy/pixel,
+ * and sets the image size, cell size and image centre of the imager to
+ * match it before calling oskar_imager_set_model_image().
+ *
+ * The image is embedded in the smallest even-sized square image centred
+ * on the reference pixel. As for oskar_sky_from_image(), the image is
+ * assumed to use the orthographic (SIN) projection, with right ascension
+ * increasing to the left.
+ *
+ * If the visibilities are not phased to the image centre, the visibility
+ * phase centre must be set afterwards using
+ * oskar_imager_set_vis_phase_centre().
+ *
+ * @param[in,out] h              Handle to imager.
+ * @param[in] filename           Path to FITS image file.
+ * @param[in] default_map_units  Units to use if none are given in the file.
+ * @param[in] override_units     If set, use the default units regardless.
+ * @param[out] freq_hz           Frequency of the image plane, in Hz.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_read_model_image(oskar_Imager* h, const char* filename,
+        const char* default_map_units, int override_units, double* freq_hz,
+        int* status);
+
+/**
+ * @brief
+ * Predicts visibilities from the model image.
+ *
+ * @details
+ * Predicts visibilities at the given baseline coordinates from the model
+ * image set using oskar_imager_set_model_image(), using the current
+ * imaging algorithm. This is the adjoint of imaging:
+ * the FFT algorithm degrids using the same convolution function,
+ * W-projection degrids using the same W-kernels, and the DFT algorithms
+ * evaluate the direct Fourier sum over the non-zero pixels.
+ *
+ * If the imager is set to a different direction to the visibility phase
+ * centre, the coordinates are rotated and the visibilities phase-shifted
+ * back to the visibility phase centre.
+ *
+ * Visibilities are computed in parallel on the CPU.
+ * The imager is not modified, so this function may be called concurrently
+ * from multiple threads once the model has been set.
+ *
+ * Points outside the grid are set to zero.
+ *
+ * @param[in] h             Handle to imager.
+ * @param[in] num_vis       Number of visibilities.
+ * @param[in] uu            Baseline UU coordinates, in wavelengths.
+ * @param[in] vv            Baseline VV coordinates, in wavelengths.
+ * @param[in] ww            Baseline WW coordinates, in wavelengths.
+ * @param[out] vis          Predicted complex visibilities, in Jy.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_imager_predict(const oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        oskar_Mem* vis, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
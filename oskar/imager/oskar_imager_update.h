@@ -111,6 +111,8 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
  * @param[in,out] plane         Updated image or visibility plane.
  * @param[in,out] plane_norm    Updated required normalisation of plane.
  * @param[in,out] weights_grid  Grid of weights, updated if required.
+ *                              If NULL, the internal grid for \p i_plane
+ *                              is used.
  * @param[in,out] status        Status return code.
  */
 OSKAR_EXPORT
@@ -4,6 +4,7 @@
  */
 
 #include <fitsio.h>
+#include <imager/private_imager_weight_grid.h>
 #include <log/oskar_log.h>
 #include <math/oskar_fft.h>
 #include <mem/oskar_mem.h>
@@ -52,7 +53,7 @@ struct oskar_Imager
     char direction_type, kernel_type;
     char **input_files, *input_root, *output_root, *ms_column;
     double cellsize_rad, fov_deg, image_padding, im_centre_deg[2];
-    double uv_filter_min, uv_filter_max;
+    double uv_filter_min, uv_filter_max, robust;
     double time_min_utc, time_max_utc, freq_min_hz, freq_max_hz;
 
     /* Visibility meta-data. */
@@ -72,7 +73,8 @@ struct oskar_Imager
     oskar_Mem *uu_tmp, *vv_tmp, *ww_tmp, *stokes, *weight_tmp;
     int num_planes; /* For each output channel and polarisation. */
     double *plane_norm, delta_l, delta_m, delta_n, M[9];
-    oskar_Mem **planes, **weights_grids, **weights_guard;
+    oskar_Mem **planes, **weights_guard;
+    oskar_WeightGrid **weights_grids;
 
     /* DFT imager data. */
     oskar_Mem *l, *m, *n;
@@ -88,6 +90,9 @@ struct oskar_Imager
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
 
+    /* Model data for prediction. */
+    oskar_Mem *model_grid, *model_pixels, *model_lmn[3];
+
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
 };
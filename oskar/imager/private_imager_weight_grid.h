@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_IMAGER_WEIGHT_GRID_H_
+#define OSKAR_PRIVATE_IMAGER_WEIGHT_GRID_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Open-addressed hash table of weights for one band of grid rows. */
+struct oskar_WeightGridBand
+{
+    size_t capacity, count;
+    size_t* keys; /* Cell index + 1, or 0 if empty. */
+    double* vals;
+};
+typedef struct oskar_WeightGridBand oskar_WeightGridBand;
+
+/*
+ * Grid of summed visibility weights, used for uniform and Briggs weighting.
+ *
+ * The grid starts in sparse form, with one hash table per band of rows so
+ * that bands can be updated by different threads, and is converted to a
+ * dense array once enough cells are filled that the tables would use
+ * more memory.
+ */
+struct oskar_WeightGrid
+{
+    int grid_size, num_bands, rows_per_band, sums_valid;
+    size_t num_filled;
+    double *dense, sum_w, sum_w2;
+    oskar_WeightGridBand* bands;
+};
+typedef struct oskar_WeightGrid oskar_WeightGrid;
+
+oskar_WeightGrid* oskar_weight_grid_create(void);
+
+void oskar_weight_grid_free(oskar_WeightGrid* g);
+
+void oskar_weight_grid_write(oskar_WeightGrid* g, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* weight,
+        double cell_size_rad, int grid_size, size_t* num_skipped,
+        int* status);
+
+void oskar_weight_grid_read(oskar_WeightGrid* g, int weighting,
+        double robust, size_t num_points, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* weight_in, oskar_Mem* weight_out,
+        double cell_size_rad, size_t* num_skipped, int* status);
+
+size_t oskar_weight_grid_memory(const oskar_WeightGrid* g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
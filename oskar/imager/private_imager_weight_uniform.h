@@ -41,6 +41,11 @@ void oskar_imager_weight_uniform(size_t num_points, const oskar_Mem* uu,
         double cell_size_rad, int grid_size, const oskar_Mem* weight_grid,
         size_t* num_skipped, int* status);
 
+void oskar_imager_weight_briggs(size_t num_points, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* weight_in, oskar_Mem* weight_out,
+        double cell_size_rad, int grid_size, double robust,
+        const oskar_Mem* weight_grid, size_t* num_skipped, int* status);
+
 #ifdef __cplusplus
 }
 #endif
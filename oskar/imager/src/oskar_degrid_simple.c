@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/oskar_degrid_simple.h"
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OSKAR_DEGRID_SIMPLE(NAME, FP, ROUND) void NAME(\
+        const int support, const int oversample,\
+        const FP* RESTRICT conv_func, const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv,\
+        const FP cell_size_rad, const int grid_size,\
+        const FP* RESTRICT grid, size_t* RESTRICT num_skipped,\
+        FP* RESTRICT vis)\
+{\
+    long int i, skipped = 0;\
+    const long int num = (long int) num_points;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    _Pragma("omp parallel for reduction(+:skipped)")\
+    for (i = 0; i < num; ++i) {\
+        double sum = 0.0, sum_re = 0.0, sum_im = 0.0;\
+        int j, k;\
+        /* Convert UV coordinates to grid coordinates. */\
+        const FP pos_u = -uu[i] * grid_scale;\
+        const FP pos_v = vv[i] * grid_scale;\
+        const int grid_u = (int)ROUND(pos_u) + grid_centre;\
+        const int grid_v = (int)ROUND(pos_v) + grid_centre;\
+        /* Scaled distance from nearest grid point. */\
+        const int off_u = (int)ROUND((ROUND(pos_u) - pos_u) * oversample);\
+        const int off_v = (int)ROUND((ROUND(pos_v) - pos_v) * oversample);\
+        vis[2 * i] = vis[2 * i + 1] = (FP) 0;\
+        /* Catch points that would lie outside the grid. */\
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||\
+                grid_v + support >= grid_size || grid_v - support < 0) {\
+            skipped++;\
+            continue;\
+        }\
+        /* Convolve the grid around this point. */\
+        for (j = -support; j <= support; ++j) {\
+            size_t p1;\
+            const FP c1 = conv_func[abs(off_v + j * oversample)];\
+            p1 = grid_v + j;\
+            p1 *= grid_size; /* Tested to avoid int overflow. */\
+            p1 += grid_u;\
+            for (k = -support; k <= support; ++k) {\
+                const size_t p = (p1 + k) << 1;\
+                const FP c = conv_func[abs(off_u + k * oversample)] * c1;\
+                sum_re += grid[p] * c;\
+                sum_im += grid[p + 1] * c;\
+                sum += c;\
+            }\
+        }\
+        if (sum != 0.0) {\
+            vis[2 * i]     = (FP) (sum_re / sum);\
+            vis[2 * i + 1] = (FP) (sum_im / sum);\
+        }\
+    }\
+    *num_skipped = (size_t) skipped;\
+}
+
+OSKAR_DEGRID_SIMPLE(oskar_degrid_simple_d, double, round)
+OSKAR_DEGRID_SIMPLE(oskar_degrid_simple_f, float, roundf)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/oskar_degrid_wproj.h"
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OSKAR_DEGRID_WPROJ(NAME, FP, ROUND, SQRT, FABS) void NAME(\
+        const size_t num_w_planes, const int* RESTRICT support,\
+        const int oversample, const int* wkernel_start,\
+        const FP* RESTRICT wkernel, const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv,\
+        const FP* RESTRICT ww, const FP cell_size_rad, const FP w_scale,\
+        const int grid_size, const FP* RESTRICT grid,\
+        size_t* RESTRICT num_skipped, FP* RESTRICT vis)\
+{\
+    long int i, skipped = 0;\
+    const long int num = (long int) num_points;\
+    const int grid_centre = grid_size / 2;\
+    const int oversample_h = oversample / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    _Pragma("omp parallel for reduction(+:skipped)")\
+    for (i = 0; i < num; ++i) {\
+        double sum = 0.0, sum_re = 0.0, sum_im = 0.0;\
+        int j, k;\
+        /* Convert UV coordinates to grid coordinates. */\
+        const FP pos_u = -uu[i] * grid_scale;\
+        const FP pos_v = vv[i] * grid_scale;\
+        const FP ww_i = ww[i];\
+        const FP conv_conj = (ww_i > (FP) 0) ? (FP) -1 : (FP) 1;\
+        const size_t grid_w = (size_t)ROUND(SQRT(FABS(ww_i * w_scale)));\
+        const int grid_u = (int)ROUND(pos_u) + grid_centre;\
+        const int grid_v = (int)ROUND(pos_v) + grid_centre;\
+        /* Scaled distance from nearest grid point. */\
+        const int off_u = (int)ROUND((ROUND(pos_u) - pos_u) * oversample);\
+        const int off_v = (int)ROUND((ROUND(pos_v) - pos_v) * oversample);\
+        /* Get kernel support size and start offset. */\
+        const int w_support = grid_w < num_w_planes ?\
+                support[grid_w] : support[num_w_planes - 1];\
+        const int kernel_start = grid_w < num_w_planes ?\
+                wkernel_start[grid_w] : wkernel_start[num_w_planes - 1];\
+        vis[2 * i] = vis[2 * i + 1] = (FP) 0;\
+        /* Catch points that would lie outside the grid. */\
+        if (grid_u + w_support >= grid_size || grid_u - w_support < 0 ||\
+                grid_v + w_support >= grid_size || grid_v - w_support < 0) {\
+            skipped++;\
+            continue;\
+        }\
+        /* Convolve the grid around this point with the conjugate kernel. */\
+        const int conv_len = 2 * w_support + 1;\
+        const int width = (oversample_h * conv_len + 1) * conv_len;\
+        const int mid = kernel_start + (abs(off_u) + 1) * width - 1 - w_support;\
+        const int stride = (off_u >= 0) ? 1 : -1;\
+        for (j = -w_support; j <= w_support; ++j) {\
+            const int t = mid - abs(off_v + j * oversample) * conv_len;\
+            size_t p1 = grid_v + j;\
+            p1 *= grid_size; /* Tested to avoid int overflow. */\
+            p1 += grid_u;\
+            for (k = -w_support; k <= w_support; ++k) {\
+                const int p = (t + stride * k) << 1;\
+                const FP c_re = wkernel[p];\
+                const FP c_im = -wkernel[p + 1] * conv_conj;\
+                const size_t p2 = (p1 + k) << 1;\
+                sum_re += (grid[p2] * c_re - grid[p2 + 1] * c_im);\
+                sum_im += (grid[p2 + 1] * c_re + grid[p2] * c_im);\
+                sum += c_re; /* Real part only. */\
+            }\
+        }\
+        if (sum != 0.0) {\
+            vis[2 * i]     = (FP) (sum_re / sum);\
+            vis[2 * i + 1] = (FP) (sum_im / sum);\
+        }\
+    }\
+    *num_skipped = (size_t) skipped;\
+}
+
+OSKAR_DEGRID_WPROJ(oskar_degrid_wproj_d, double, round, sqrt, fabs)
+OSKAR_DEGRID_WPROJ(oskar_degrid_wproj_f, float, roundf, sqrtf, fabsf)
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,26 +6,136 @@
 #include "imager/oskar_grid_weights.h"
 #include "math/oskar_kahan_sum.h"
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Bands of rows used by each thread, to balance the load. */
+#define BANDS_PER_THREAD 4
+
+static int max_threads(void)
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+size_t* oskar_grid_weights_sort_by_band(const size_t num_points,
+        const size_t* RESTRICT cell, const int grid_size,
+        const int rows_per_band, const int num_bands,
+        size_t* RESTRICT band_start)
+{
+    const int num_threads_max = max_threads();
+    size_t* order = (size_t*) malloc(
+            (num_points > 0 ? num_points : 1) * sizeof(size_t));
+    size_t* offsets = (size_t*) calloc(
+            (size_t) num_threads_max * num_bands, sizeof(size_t));
+    if (!order || !offsets)
+    {
+        free(order);
+        free(offsets);
+        return 0;
+    }
+
+    /* Each thread counts the points in each band for a contiguous range
+     * of the input, and after a prefix sum over bands and then threads,
+     * copies their indices to the output, so the input order is kept. */
+#pragma omp parallel num_threads(num_threads_max)
+    {
+        size_t i, *offset;
+        int thread_id = 0, num_threads = 1;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+        num_threads = omp_get_num_threads();
+#endif
+        const size_t i_start = num_points / num_threads * thread_id +
+                (num_points % num_threads) * thread_id / num_threads;
+        const size_t i_end = num_points / num_threads * (thread_id + 1) +
+                (num_points % num_threads) * (thread_id + 1) / num_threads;
+        offset = &offsets[(size_t) thread_id * num_bands];
+        for (i = i_start; i < i_end; ++i)
+        {
+            if (cell[i] == OSKAR_GRID_WEIGHTS_NO_CELL) continue;
+            offset[(cell[i] / (size_t) grid_size) / rows_per_band]++;
+        }
+#pragma omp barrier
+#pragma omp single
+        {
+            int b, t;
+            size_t total = 0;
+            for (b = 0; b < num_bands; ++b)
+            {
+                band_start[b] = total;
+                for (t = 0; t < num_threads; ++t)
+                {
+                    const size_t count = offsets[(size_t) t * num_bands + b];
+                    offsets[(size_t) t * num_bands + b] = total;
+                    total += count;
+                }
+            }
+            band_start[num_bands] = total;
+        }
+        for (i = i_start; i < i_end; ++i)
+        {
+            if (cell[i] == OSKAR_GRID_WEIGHTS_NO_CELL) continue;
+            order[offset[(cell[i] / (size_t) grid_size) / rows_per_band]++] =
+                    i;
+        }
+    }
+    free(offsets);
+    return order;
+}
+
+/* Returns the cells of the points in each band of rows, sorted by band,
+ * or a null pointer to use a single thread. */
+static size_t* sort_cells(const size_t num_points, size_t* cell,
+        const int grid_size, int* rows_per_band, int* num_bands,
+        size_t** band_start)
+{
+    size_t* order = 0;
+    *num_bands = BANDS_PER_THREAD * max_threads();
+    if (*num_bands > grid_size) *num_bands = grid_size;
+    *rows_per_band = (grid_size + *num_bands - 1) / *num_bands;
+    *band_start = (size_t*) malloc((*num_bands + 1) * sizeof(size_t));
+    if (*band_start)
+        order = oskar_grid_weights_sort_by_band(num_points, cell,
+                grid_size, *rows_per_band, *num_bands, *band_start);
+    if (!order)
+    {
+        free(*band_start);
+        *band_start = 0;
+    }
+    return order;
+}
+
 void oskar_grid_weights_write_d(const size_t num_points,
         const double* RESTRICT uu, const double* RESTRICT vv,
         const double* RESTRICT weight, const double cell_size_rad,
         const int grid_size, size_t* RESTRICT num_skipped,
         double* RESTRICT grid)
 {
-    size_t i;
+    long int i;
+    int b, num_bands = 0, rows_per_band = 0;
+    size_t skipped = 0, *cell = 0, *order = 0, *band_start = 0;
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
-    /* Grid the existing weights. */
-    *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+    /* Find the grid cell for each point. */
+    if (max_threads() > 1)
+        cell = (size_t*) malloc(
+                (num_points > 0 ? num_points : 1) * sizeof(size_t));
+#pragma omp parallel for private(i) reduction(+:skipped) if(cell)
+    for (i = 0; i < (long int) num_points; ++i)
     {
         /* Convert UV coordinates to grid coordinates. */
         const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
@@ -38,13 +148,43 @@ void oskar_grid_weights_write_d(const size_t num_points,
         if (grid_u >= grid_size || grid_u < 0 ||
                 grid_v >= grid_size || grid_v < 0)
         {
-            *num_skipped += 1;
-            continue;
+            t = OSKAR_GRID_WEIGHTS_NO_CELL;
+            skipped++;
         }
 
-        /* Add weight to the grid. */
-        grid[t] += weight[i];
+        /* Add weight to the grid here if using a single thread. */
+        if (cell)
+            cell[i] = t;
+        else if (t != OSKAR_GRID_WEIGHTS_NO_CELL)
+            grid[t] += weight[i];
+    }
+    *num_skipped = skipped;
+
+    /* Otherwise each thread adds the points in whole bands of rows,
+     * so no locking is needed, and each cell is summed in the same order
+     * as in serial. */
+    if (cell)
+        order = sort_cells(num_points, cell, grid_size,
+                &rows_per_band, &num_bands, &band_start);
+    if (order)
+    {
+#pragma omp parallel for private(b) schedule(dynamic)
+        for (b = 0; b < num_bands; ++b)
+        {
+            size_t j;
+            for (j = band_start[b]; j < band_start[b + 1]; ++j)
+                grid[cell[order[j]]] += weight[order[j]];
+        }
+    }
+    else if (cell)
+    {
+        for (i = 0; i < (long int) num_points; ++i)
+            if (cell[i] != OSKAR_GRID_WEIGHTS_NO_CELL)
+                grid[cell[i]] += weight[i];
     }
+    free(order);
+    free(band_start);
+    free(cell);
 }
 
 void oskar_grid_weights_read_d(const size_t num_points,
@@ -53,13 +193,14 @@ void oskar_grid_weights_read_d(const size_t num_points,
         const double cell_size_rad, const int grid_size,
         size_t* RESTRICT num_skipped, const double* RESTRICT grid)
 {
-    size_t i;
+    long int i;
+    size_t skipped = 0;
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
     /* Look up gridded weight density at each point location. */
-    *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < (long int) num_points; ++i)
     {
         /* Convert UV coordinates to grid coordinates. */
         const int grid_u = (int)round(-uu[i] * grid_scale) + grid_centre;
@@ -72,13 +213,14 @@ void oskar_grid_weights_read_d(const size_t num_points,
         if (grid_u >= grid_size || grid_u < 0 ||
                 grid_v >= grid_size || grid_v < 0)
         {
-            *num_skipped += 1;
+            skipped++;
             continue;
         }
 
         /* Calculate new weight based on gridded point density. */
         weight_out[i] = (grid[t] != 0.0) ? weight_in[i] / grid[t] : 0.0;
     }
+    *num_skipped = skipped;
 }
 
 void oskar_grid_weights_write_f(const size_t num_points,
@@ -87,13 +229,18 @@ void oskar_grid_weights_write_f(const size_t num_points,
         const int grid_size, size_t* RESTRICT num_skipped,
         float* RESTRICT grid, float* RESTRICT grid_guard)
 {
-    size_t i;
+    long int i;
+    int b, num_bands = 0, rows_per_band = 0;
+    size_t skipped = 0, *cell = 0, *order = 0, *band_start = 0;
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
-    /* Grid the existing weights. */
-    *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+    /* Find the grid cell for each point. */
+    if (max_threads() > 1)
+        cell = (size_t*) malloc(
+                (num_points > 0 ? num_points : 1) * sizeof(size_t));
+#pragma omp parallel for private(i) reduction(+:skipped) if(cell)
+    for (i = 0; i < (long int) num_points; ++i)
     {
         /* Convert UV coordinates to grid coordinates. */
         const int grid_u = (int)roundf(-uu[i] * grid_scale) + grid_centre;
@@ -106,13 +253,51 @@ void oskar_grid_weights_write_f(const size_t num_points,
         if (grid_u >= grid_size || grid_u < 0 ||
                 grid_v >= grid_size || grid_v < 0)
         {
-            *num_skipped += 1;
-            continue;
+            t = OSKAR_GRID_WEIGHTS_NO_CELL;
+            skipped++;
         }
 
-        /* Add weight to the grid using Kahan summation. */
-        OSKAR_KAHAN_SUM(float, grid[t], weight[i], grid_guard[t]);
+        /* Add weight to the grid here if using a single thread,
+         * using Kahan summation. */
+        if (cell)
+            cell[i] = t;
+        else if (t != OSKAR_GRID_WEIGHTS_NO_CELL)
+            OSKAR_KAHAN_SUM(float, grid[t], weight[i], grid_guard[t]);
+    }
+    *num_skipped = skipped;
+
+    /* Otherwise each thread adds the points in whole bands of rows,
+     * so no locking is needed, and each cell is summed in the same order
+     * as in serial. */
+    if (cell)
+        order = sort_cells(num_points, cell, grid_size,
+                &rows_per_band, &num_bands, &band_start);
+    if (order)
+    {
+#pragma omp parallel for private(b) schedule(dynamic)
+        for (b = 0; b < num_bands; ++b)
+        {
+            size_t j;
+            for (j = band_start[b]; j < band_start[b + 1]; ++j)
+            {
+                const size_t t = cell[order[j]];
+                OSKAR_KAHAN_SUM(float, grid[t], weight[order[j]],
+                        grid_guard[t]);
+            }
+        }
+    }
+    else if (cell)
+    {
+        for (i = 0; i < (long int) num_points; ++i)
+        {
+            const size_t t = cell[i];
+            if (t == OSKAR_GRID_WEIGHTS_NO_CELL) continue;
+            OSKAR_KAHAN_SUM(float, grid[t], weight[i], grid_guard[t]);
+        }
     }
+    free(order);
+    free(band_start);
+    free(cell);
 }
 
 void oskar_grid_weights_read_f(const size_t num_points,
@@ -121,13 +306,14 @@ void oskar_grid_weights_read_f(const size_t num_points,
         const float cell_size_rad, const int grid_size,
         size_t* RESTRICT num_skipped, const float* RESTRICT grid)
 {
-    size_t i;
+    long int i;
+    size_t skipped = 0;
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
     /* Look up gridded weight density at each point location. */
-    *num_skipped = 0;
-    for (i = 0; i < num_points; ++i)
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < (long int) num_points; ++i)
     {
         /* Convert UV coordinates to grid coordinates. */
         const int grid_u = (int)roundf(-uu[i] * grid_scale) + grid_centre;
@@ -140,13 +326,14 @@ void oskar_grid_weights_read_f(const size_t num_points,
         if (grid_u >= grid_size || grid_u < 0 ||
                 grid_v >= grid_size || grid_v < 0)
         {
-            *num_skipped += 1;
+            skipped++;
             continue;
         }
 
         /* Calculate new weight based on gridded point density. */
         weight_out[i] = (grid[t] != 0.0) ? weight_in[i] / grid[t] : 0.0;
     }
+    *num_skipped = skipped;
 }
 
 #ifdef __cplusplus
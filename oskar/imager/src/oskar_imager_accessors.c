@@ -198,6 +198,12 @@ int oskar_imager_precision(const oskar_Imager* h)
 }
 
 
+double oskar_imager_robust(const oskar_Imager* h)
+{
+    return h->robust;
+}
+
+
 int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h)
 {
     return h->scale_norm_with_num_input_files;
@@ -528,6 +534,12 @@ void oskar_imager_set_oversample(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_robust(oskar_Imager* h, double value)
+{
+    h->robust = value;
+}
+
+
 void oskar_imager_set_scale_norm_with_num_input_files(oskar_Imager* h,
         int value)
 {
@@ -691,6 +703,16 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_range(oskar_Imager* h,
+        double ww_min, double ww_max, double ww_rms)
+{
+    h->ww_min = ww_min;
+    h->ww_max = ww_max;
+    h->ww_rms = ww_rms;
+    h->ww_points = 0;
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (*status || !type) return;
@@ -700,6 +722,8 @@ void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
         h->weighting = OSKAR_WEIGHTING_RADIAL;
     else if (!strncmp(type, "U", 1) || !strncmp(type, "u", 1))
         h->weighting = OSKAR_WEIGHTING_UNIFORM;
+    else if (!strncmp(type, "B", 1) || !strncmp(type, "b", 1))
+        h->weighting = OSKAR_WEIGHTING_BRIGGS;
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 }
 
@@ -743,6 +767,7 @@ const char* oskar_imager_weighting(const oskar_Imager* h)
     case OSKAR_WEIGHTING_NATURAL: return "Natural";
     case OSKAR_WEIGHTING_RADIAL:  return "Radial";
     case OSKAR_WEIGHTING_UNIFORM: return "Uniform";
+    case OSKAR_WEIGHTING_BRIGGS:  return "Briggs";
     default:                      return "";
     }
 }
@@ -25,15 +25,16 @@ void oskar_imager_check_init(oskar_Imager* h, int* status)
     if (!h->weights_grids && h->num_planes > 0)
     {
         int i;
-        h->weights_grids = (oskar_Mem**)
-                calloc(h->num_planes, sizeof(oskar_Mem*));
+        h->weights_grids = (oskar_WeightGrid**)
+                calloc(h->num_planes, sizeof(oskar_WeightGrid*));
         h->weights_guard = (oskar_Mem**)
                 calloc(h->num_planes, sizeof(oskar_Mem*));
         for (i = 0; i < h->num_planes; ++i)
         {
-            h->weights_grids[i] = oskar_mem_create(h->imager_prec,
-                    OSKAR_CPU, 0, status);
-            h->weights_guard[i] = oskar_mem_create(h->imager_prec,
+            h->weights_grids[i] = oskar_weight_grid_create();
+            if (!h->weights_grids[i])
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            h->weights_guard[i] = oskar_mem_create(OSKAR_SINGLE,
                     OSKAR_CPU, 0, status);
         }
     }
@@ -59,6 +59,18 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->tmr_coord_scan = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_weights_grid = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_weights_lookup = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_name(h->tmr_grid_finalise, "Grid finalise");
+    oskar_timer_set_name(h->tmr_grid_update, "Grid update");
+    oskar_timer_set_name(h->tmr_init, "Imager init");
+    oskar_timer_set_name(h->tmr_select_scale, "Select and scale");
+    oskar_timer_set_name(h->tmr_rotate, "Phase rotate");
+    oskar_timer_set_name(h->tmr_filter, "Filter");
+    oskar_timer_set_name(h->tmr_read, "Read");
+    oskar_timer_set_name(h->tmr_write, "Image write");
+    oskar_timer_set_name(h->tmr_copy_convert, "Copy and convert");
+    oskar_timer_set_name(h->tmr_coord_scan, "Coordinate scan");
+    oskar_timer_set_name(h->tmr_weights_grid, "Weights grid");
+    oskar_timer_set_name(h->tmr_weights_lookup, "Weights lookup");
     h->mutex = oskar_mutex_create();
     h->log = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_WARNING);
 
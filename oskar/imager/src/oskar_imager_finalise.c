@@ -30,9 +30,8 @@
 #include "imager/oskar_imager.h"
 
 #include "imager/oskar_grid_correction.h"
-#include "imager/oskar_grid_functions_pillbox.h"
-#include "imager/oskar_grid_functions_spheroidal.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_init_corr_func.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
@@ -246,6 +245,15 @@ void oskar_imager_finalise(oskar_Imager* h,
                     "Field of view [arcmin]", "%.1f", h->fov_deg * 60.0);
         oskar_log_value(h->log, 'M', 0,
                 "Image dimension [pixels]", "%d", h->image_size);
+        if (h->weights_grids)
+        {
+            size_t weights_bytes = 0;
+            for (i = 0; i < h->num_planes; ++i)
+                weights_bytes += oskar_weight_grid_memory(h->weights_grids[i]);
+            if (weights_bytes > 0)
+                oskar_log_value(h->log, 'M', 0,
+                        "Weights grid memory", "%.1f MB", weights_bytes / 1e6);
+        }
         if (h->num_files > 0)
         {
             oskar_log_message(h->log, 'M', 0, "Input(s):");
@@ -351,25 +359,7 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     oskar_fft_exec(h->fft, plane, status);
 
     /* Generate grid correction function if required. */
-    if (!h->corr_func)
-    {
-        oskar_Mem* corr_func = 0;
-        corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
-            oskar_grid_correction_function_spheroidal(size, h->oversample,
-                    oskar_mem_double(corr_func, status));
-        else
-        {
-            if (h->kernel_type == 'S')
-                oskar_grid_correction_function_spheroidal(size, 0,
-                        oskar_mem_double(corr_func, status));
-            else if (h->kernel_type == 'P')
-                oskar_grid_correction_function_pillbox(size,
-                        oskar_mem_double(corr_func, status));
-        }
-        h->corr_func = oskar_mem_convert_precision(corr_func,
-                h->imager_prec, status);
-    }
+    oskar_imager_init_corr_func(h, status);
 
     /* FFT shift again, and apply grid correction. */
     oskar_fftphase(size, size, plane, status);
@@ -0,0 +1,528 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "convert/oskar_convert_brightness_to_jy.h"
+#include "imager/oskar_degrid_simple.h"
+#include "imager/oskar_degrid_wproj.h"
+#include "imager/oskar_grid_correction.h"
+#include "imager/private_imager_init_corr_func.h"
+#include "log/oskar_log.h"
+#include "math/oskar_cmath.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftphase.h"
+#include "utility/oskar_device.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OSKAR_PREDICT_DFT(NAME, FP, SINCOS) static void NAME(\
+        const int is_3d, const size_t num_pixels,\
+        const FP* RESTRICT pix, const FP* RESTRICT l, const FP* RESTRICT m,\
+        const FP* RESTRICT n, const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv, const FP* RESTRICT ww,\
+        FP* RESTRICT vis)\
+{\
+    long int i;\
+    const long int num = (long int) num_points;\
+    _Pragma("omp parallel for")\
+    for (i = 0; i < num; ++i) {\
+        size_t j;\
+        double sum_re = 0.0, sum_im = 0.0;\
+        const FP u = (FP) (2.0 * M_PI) * uu[i];\
+        const FP v = (FP) (2.0 * M_PI) * vv[i];\
+        const FP w = (FP) (2.0 * M_PI) * ww[i];\
+        for (j = 0; j < num_pixels; ++j) {\
+            FP re, im, t = u * l[j] + v * m[j];\
+            if (is_3d) t += w * n[j];\
+            SINCOS(t, im, re);\
+            sum_re += pix[j] * re;\
+            sum_im += pix[j] * im;\
+        }\
+        vis[2 * i]     = (FP) sum_re;\
+        vis[2 * i + 1] = (FP) sum_im;\
+    }\
+}
+
+#define OSKAR_PREDICT_ROTATE(NAME, FP, SINCOS) static void NAME(\
+        const double M[9], const double delta[3], const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv, const FP* RESTRICT ww,\
+        FP* RESTRICT uu_rot, FP* RESTRICT vv_rot, FP* RESTRICT ww_rot,\
+        FP* RESTRICT phase)\
+{\
+    long int i;\
+    const long int num = (long int) num_points;\
+    _Pragma("omp parallel for")\
+    for (i = 0; i < num; ++i) {\
+        FP re, im;\
+        const double s0 = uu[i], s1 = vv[i], s2 = ww[i];\
+        const FP t = (FP) (-2.0 * M_PI *\
+                (s0 * delta[0] + s1 * delta[1] + s2 * delta[2]));\
+        uu_rot[i] = (FP) (M[0] * s0 + M[1] * s1 + M[2] * s2);\
+        vv_rot[i] = (FP) (M[3] * s0 + M[4] * s1 + M[5] * s2);\
+        ww_rot[i] = (FP) (M[6] * s0 + M[7] * s1 + M[8] * s2);\
+        SINCOS(t, im, re);\
+        phase[2 * i]     = re;\
+        phase[2 * i + 1] = im;\
+    }\
+}
+
+#define SINCOS_D(X, S, C) S = sin(X); C = cos(X)
+#define SINCOS_F(X, S, C) S = sinf(X); C = cosf(X)
+OSKAR_PREDICT_DFT(predict_dft_d, double, SINCOS_D)
+OSKAR_PREDICT_DFT(predict_dft_f, float, SINCOS_F)
+OSKAR_PREDICT_ROTATE(predict_rotate_d, double, SINCOS_D)
+OSKAR_PREDICT_ROTATE(predict_rotate_f, float, SINCOS_F)
+
+static void set_model_pixels(oskar_Imager* h, const oskar_Mem* image,
+        int* status);
+static void set_model_grid(oskar_Imager* h, const oskar_Mem* image,
+        int* status);
+
+
+void oskar_imager_set_model_image(oskar_Imager* h, const oskar_Mem* image,
+        int* status)
+{
+    oskar_Mem* tmp = 0;
+    int i;
+    if (*status) return;
+
+    /* Check the image. */
+    if (oskar_mem_type(image) != OSKAR_SINGLE &&
+            oskar_mem_type(image) != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(image) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_length(image) <
+            (size_t) h->image_size * (size_t) h->image_size)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Initialise the algorithm, and clear any previous model. */
+    oskar_imager_check_init(h, status);
+    oskar_mem_free(h->model_grid, status);
+    oskar_mem_free(h->model_pixels, status);
+    h->model_grid = h->model_pixels = 0;
+    for (i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(h->model_lmn[i], status);
+        h->model_lmn[i] = 0;
+    }
+    if (*status) return;
+
+    /* Store the model for the current algorithm. */
+    tmp = oskar_mem_convert_precision(image, h->imager_prec, status);
+    switch (h->algorithm)
+    {
+    case OSKAR_ALGORITHM_DFT_2D:
+    case OSKAR_ALGORITHM_DFT_3D:
+        set_model_pixels(h, tmp, status);
+        break;
+    case OSKAR_ALGORITHM_FFT:
+    case OSKAR_ALGORITHM_WPROJ:
+        set_model_grid(h, tmp, status);
+        break;
+    default:
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+    }
+    oskar_mem_free(tmp, status);
+}
+
+
+void oskar_imager_read_model_image(oskar_Imager* h, const char* filename,
+        const char* default_map_units, int override_units, double* freq_hz,
+        int* status)
+{
+    double crval_deg[2], crpix[2], cellsize_deg = 0.0, image_freq_hz = 0.0;
+    double beam_area_pixels = 0.0;
+    char* reported_map_units = 0;
+    int image_size[2], ref[2], size = 0, i;
+    oskar_Mem *data = 0, *image = 0;
+    if (*status) return;
+
+    /* Read the image pixels and make sure they are in Jy. */
+    data = oskar_mem_read_fits_image_plane(filename, 0, 0, 0,
+            image_size, crval_deg, crpix, &cellsize_deg, 0, &image_freq_hz,
+            &beam_area_pixels, &reported_map_units, status);
+    if (!*status && cellsize_deg == 0.0)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        oskar_log_error(h->log, "Unknown image pixel size. "
+                "(Ensure all WCS headers are present.)");
+    }
+    oskar_convert_brightness_to_jy(data, beam_area_pixels,
+            pow(cellsize_deg * M_PI / 180.0, 2.0), image_freq_hz, 0.0, 0.0,
+            reported_map_units, default_map_units, override_units, status);
+    free(reported_map_units);
+    if (freq_hz) *freq_hz = image_freq_hz;
+
+    /* Find the smallest even image size centred on the reference pixel. */
+    for (i = 0; i < 2; ++i)
+    {
+        ref[i] = (int) round(crpix[i] - 1.0);
+        if (2 * ref[i] > size) size = 2 * ref[i];
+        if (2 * (image_size[i] - ref[i]) > size)
+            size = 2 * (image_size[i] - ref[i]);
+    }
+    if (!*status && size > 0)
+    {
+        /* Copy the pixels into the centred image. */
+        const int off_x = size / 2 - ref[0], off_y = size / 2 - ref[1];
+        image = oskar_mem_create(oskar_mem_type(data), OSKAR_CPU,
+                (size_t) size * (size_t) size, status);
+        oskar_mem_clear_contents(image, status);
+        for (i = 0; i < image_size[1]; ++i)
+            oskar_mem_copy_contents(image, data,
+                    (size_t) (i + off_y) * size + off_x,
+                    (size_t) i * image_size[0], image_size[0], status);
+
+        /* Set the imager parameters to match, and set the model. */
+        oskar_imager_set_size(h, size, status);
+        oskar_imager_set_cellsize(h, cellsize_deg * 3600.0);
+        oskar_imager_set_direction(h, crval_deg[0], crval_deg[1]);
+        oskar_imager_set_model_image(h, image, status);
+    }
+    oskar_mem_free(image, status);
+    oskar_mem_free(data, status);
+}
+
+
+void oskar_imager_predict(const oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        oskar_Mem* vis, int* status)
+{
+    oskar_Mem *uu_rot = 0, *vv_rot = 0, *ww_rot = 0, *phase = 0;
+    const oskar_Mem *u = uu, *v = vv, *w = ww;
+    const int prec = h->imager_prec;
+    size_t num_skipped = 0;
+    if (*status) return;
+
+    /* Check the inputs. */
+    if (oskar_mem_type(uu) != prec || oskar_mem_type(vv) != prec ||
+            oskar_mem_type(ww) != prec ||
+            oskar_mem_type(vis) != (prec | OSKAR_COMPLEX))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mem_location(uu) != OSKAR_CPU ||
+            oskar_mem_location(vv) != OSKAR_CPU ||
+            oskar_mem_location(ww) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (!h->model_grid && !h->model_pixels)
+    {
+        *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+    oskar_mem_ensure(vis, num_vis, status);
+    if (*status) return;
+
+    /* Rotate the coordinates to the image centre, if required. */
+    if (h->direction_type == 'R')
+    {
+        const double delta[] = {h->delta_l, h->delta_m, h->delta_n};
+        uu_rot = oskar_mem_create(prec, OSKAR_CPU, num_vis, status);
+        vv_rot = oskar_mem_create(prec, OSKAR_CPU, num_vis, status);
+        ww_rot = oskar_mem_create(prec, OSKAR_CPU, num_vis, status);
+        phase = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                num_vis, status);
+        if (!*status)
+        {
+            if (prec == OSKAR_DOUBLE)
+                predict_rotate_d(h->M, delta, num_vis,
+                        oskar_mem_double_const(uu, status),
+                        oskar_mem_double_const(vv, status),
+                        oskar_mem_double_const(ww, status),
+                        oskar_mem_double(uu_rot, status),
+                        oskar_mem_double(vv_rot, status),
+                        oskar_mem_double(ww_rot, status),
+                        oskar_mem_double(phase, status));
+            else
+                predict_rotate_f(h->M, delta, num_vis,
+                        oskar_mem_float_const(uu, status),
+                        oskar_mem_float_const(vv, status),
+                        oskar_mem_float_const(ww, status),
+                        oskar_mem_float(uu_rot, status),
+                        oskar_mem_float(vv_rot, status),
+                        oskar_mem_float(ww_rot, status),
+                        oskar_mem_float(phase, status));
+        }
+        u = uu_rot; v = vv_rot; w = ww_rot;
+    }
+
+    /* Predict the visibilities using the current algorithm. */
+    if (!*status)
+    {
+        switch (h->algorithm)
+        {
+        case OSKAR_ALGORITHM_DFT_2D:
+        case OSKAR_ALGORITHM_DFT_3D:
+        {
+            const int is_3d = (h->algorithm == OSKAR_ALGORITHM_DFT_3D);
+            const size_t num_pixels = oskar_mem_length(h->model_pixels);
+            if (prec == OSKAR_DOUBLE)
+                predict_dft_d(is_3d, num_pixels,
+                        oskar_mem_double_const(h->model_pixels, status),
+                        oskar_mem_double_const(h->model_lmn[0], status),
+                        oskar_mem_double_const(h->model_lmn[1], status),
+                        oskar_mem_double_const(h->model_lmn[2], status),
+                        num_vis,
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        oskar_mem_double_const(w, status),
+                        oskar_mem_double(vis, status));
+            else
+                predict_dft_f(is_3d, num_pixels,
+                        oskar_mem_float_const(h->model_pixels, status),
+                        oskar_mem_float_const(h->model_lmn[0], status),
+                        oskar_mem_float_const(h->model_lmn[1], status),
+                        oskar_mem_float_const(h->model_lmn[2], status),
+                        num_vis,
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        oskar_mem_float_const(w, status),
+                        oskar_mem_float(vis, status));
+            break;
+        }
+        case OSKAR_ALGORITHM_FFT:
+            if (!h->conv_func ||
+                    oskar_mem_location(h->conv_func) != OSKAR_CPU)
+            {
+                *status = OSKAR_ERR_BAD_LOCATION;
+                break;
+            }
+            if (prec == OSKAR_DOUBLE)
+                oskar_degrid_simple_d(h->support, h->oversample,
+                        oskar_mem_double_const(h->conv_func, status), num_vis,
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        h->cellsize_rad, h->grid_size,
+                        oskar_mem_double_const(h->model_grid, status),
+                        &num_skipped, oskar_mem_double(vis, status));
+            else
+                oskar_degrid_simple_f(h->support, h->oversample,
+                        oskar_mem_float_const(h->conv_func, status), num_vis,
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        (float) (h->cellsize_rad), h->grid_size,
+                        oskar_mem_float_const(h->model_grid, status),
+                        &num_skipped, oskar_mem_float(vis, status));
+            break;
+        case OSKAR_ALGORITHM_WPROJ:
+            /* Kernels are not kept in host memory if gridding on the GPU. */
+            if (!h->w_kernels_compact)
+            {
+                *status = OSKAR_ERR_BAD_LOCATION;
+                break;
+            }
+            if (prec == OSKAR_DOUBLE)
+                oskar_degrid_wproj_d(h->num_w_planes,
+                        oskar_mem_int_const(h->w_support, status),
+                        h->oversample,
+                        oskar_mem_int_const(h->w_kernel_start, status),
+                        oskar_mem_double_const(h->w_kernels_compact, status),
+                        num_vis,
+                        oskar_mem_double_const(u, status),
+                        oskar_mem_double_const(v, status),
+                        oskar_mem_double_const(w, status),
+                        h->cellsize_rad, h->w_scale, h->grid_size,
+                        oskar_mem_double_const(h->model_grid, status),
+                        &num_skipped, oskar_mem_double(vis, status));
+            else
+                oskar_degrid_wproj_f(h->num_w_planes,
+                        oskar_mem_int_const(h->w_support, status),
+                        h->oversample,
+                        oskar_mem_int_const(h->w_kernel_start, status),
+                        oskar_mem_float_const(h->w_kernels_compact, status),
+                        num_vis,
+                        oskar_mem_float_const(u, status),
+                        oskar_mem_float_const(v, status),
+                        oskar_mem_float_const(w, status),
+                        (float) (h->cellsize_rad), (float) (h->w_scale),
+                        h->grid_size,
+                        oskar_mem_float_const(h->model_grid, status),
+                        &num_skipped, oskar_mem_float(vis, status));
+            break;
+        default:
+            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        }
+    }
+
+    /* Phase-shift back to the visibility phase centre, if required. */
+    if (phase)
+        oskar_mem_multiply(vis, vis, phase, 0, 0, 0, num_vis, status);
+    oskar_mem_free(uu_rot, status);
+    oskar_mem_free(vv_rot, status);
+    oskar_mem_free(ww_rot, status);
+    oskar_mem_free(phase, status);
+}
+
+
+#define OSKAR_SET_MODEL_PIXELS(NAME, FP) static size_t NAME(\
+        const size_t num_pixels, const FP* RESTRICT image,\
+        const FP* RESTRICT l, const FP* RESTRICT m, const FP* RESTRICT n,\
+        FP* RESTRICT pix, FP* RESTRICT pix_l, FP* RESTRICT pix_m,\
+        FP* RESTRICT pix_n)\
+{\
+    size_t i, j = 0;\
+    for (i = 0; i < num_pixels; ++i) {\
+        if (image[i] == (FP) 0) continue;\
+        if (pix) {\
+            pix[j] = image[i];\
+            pix_l[j] = l[i]; pix_m[j] = m[i]; pix_n[j] = n[i];\
+        }\
+        j++;\
+    }\
+    return j;\
+}
+
+OSKAR_SET_MODEL_PIXELS(set_model_pixels_d, double)
+OSKAR_SET_MODEL_PIXELS(set_model_pixels_f, float)
+
+static void set_model_pixels(oskar_Imager* h, const oskar_Mem* image,
+        int* status)
+{
+    int i, pass;
+    size_t num_nonzero = 0;
+    const size_t num_pixels = (size_t) h->image_size * (size_t) h->image_size;
+    const int prec = h->imager_prec;
+
+    /* Keep only the non-zero pixels, and their coordinates.
+     * The first pass counts them, and the second pass stores them. */
+    for (pass = 0; pass < 2; ++pass)
+    {
+        if (pass == 1)
+        {
+            h->model_pixels = oskar_mem_create(prec, OSKAR_CPU,
+                    num_nonzero, status);
+            for (i = 0; i < 3; ++i)
+                h->model_lmn[i] = oskar_mem_create(prec, OSKAR_CPU,
+                        num_nonzero, status);
+        }
+        if (*status) return;
+        if (prec == OSKAR_DOUBLE)
+            num_nonzero = set_model_pixels_d(num_pixels,
+                    oskar_mem_double_const(image, status),
+                    oskar_mem_double_const(h->l, status),
+                    oskar_mem_double_const(h->m, status),
+                    oskar_mem_double_const(h->n, status),
+                    pass ? oskar_mem_double(h->model_pixels, status) : 0,
+                    pass ? oskar_mem_double(h->model_lmn[0], status) : 0,
+                    pass ? oskar_mem_double(h->model_lmn[1], status) : 0,
+                    pass ? oskar_mem_double(h->model_lmn[2], status) : 0);
+        else
+            num_nonzero = set_model_pixels_f(num_pixels,
+                    oskar_mem_float_const(image, status),
+                    oskar_mem_float_const(h->l, status),
+                    oskar_mem_float_const(h->m, status),
+                    oskar_mem_float_const(h->n, status),
+                    pass ? oskar_mem_float(h->model_pixels, status) : 0,
+                    pass ? oskar_mem_float(h->model_lmn[0], status) : 0,
+                    pass ? oskar_mem_float(h->model_lmn[1], status) : 0,
+                    pass ? oskar_mem_float(h->model_lmn[2], status) : 0);
+    }
+}
+
+
+static void set_model_grid(oskar_Imager* h, const oskar_Mem* image,
+        int* status)
+{
+    oskar_Mem* plane = 0;
+    size_t i;
+    int row;
+    const int size = oskar_imager_plane_size(h);
+    const int image_size = h->image_size;
+    const size_t num_cells = (size_t) size * (size_t) size;
+    const int offset = (size - image_size) / 2;
+    const int fft_loc = (h->fft_on_gpu && h->num_gpus > 0) ?
+            h->dev_loc : OSKAR_CPU;
+
+    /* Place the image in the centre of the padded plane. */
+    h->model_grid = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX,
+            OSKAR_CPU, num_cells, status);
+    oskar_mem_clear_contents(h->model_grid, status);
+    if (*status) return;
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        double* t = oskar_mem_double(h->model_grid, status);
+        const double* img = oskar_mem_double_const(image, status);
+        for (row = 0; row < image_size; ++row)
+        {
+            const size_t in = (size_t) row * image_size;
+            const size_t out = (size_t) (row + offset) * size + offset;
+            for (i = 0; i < (size_t) image_size; ++i)
+                t[2 * (out + i)] = img[in + i];
+        }
+    }
+    else
+    {
+        float* t = oskar_mem_float(h->model_grid, status);
+        const float* img = oskar_mem_float_const(image, status);
+        for (row = 0; row < image_size; ++row)
+        {
+            const size_t in = (size_t) row * image_size;
+            const size_t out = (size_t) (row + offset) * size + offset;
+            for (i = 0; i < (size_t) image_size; ++i)
+                t[2 * (out + i)] = img[in + i];
+        }
+    }
+
+    /* Apply the grid correction, so the model is tapered in the same way
+     * as a gridded image, then transform to the grid. This is the adjoint
+     * of the transform done by oskar_imager_finalise_plane(). */
+    oskar_imager_init_corr_func(h, status);
+    oskar_grid_correction(size, h->corr_func, h->model_grid, status);
+    if (fft_loc != OSKAR_CPU)
+    {
+        oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
+        plane = oskar_mem_create_copy(h->model_grid, fft_loc, status);
+    }
+    else
+        plane = h->model_grid;
+    oskar_fftphase(size, size, plane, status);
+    if (!h->fft)
+        h->fft = oskar_fft_create(h->imager_prec, fft_loc, 2, size, 0, status);
+    oskar_fft_exec(h->fft, plane, status);
+    oskar_fftphase(size, size, plane, status);
+    if (plane != h->model_grid)
+    {
+        oskar_mem_copy(h->model_grid, plane, status);
+        oskar_mem_free(plane, status);
+    }
+    if (*status) return;
+
+    /* Conjugate to get the adjoint transform of the real image. */
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        double* t = oskar_mem_double(h->model_grid, status);
+        for (i = 0; i < num_cells; ++i) t[2 * i + 1] *= -1.0;
+    }
+    else
+    {
+        float* t = oskar_mem_float(h->model_grid, status);
+        for (i = 0; i < num_cells; ++i) t[2 * i + 1] *= -1.0f;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -42,6 +42,14 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
 
+    /* Clear model data. */
+    oskar_mem_free(h->model_grid, status); h->model_grid = 0;
+    oskar_mem_free(h->model_pixels, status); h->model_pixels = 0;
+    for (i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(h->model_lmn[i], status); h->model_lmn[i] = 0;
+    }
+
     /* Free the image planes. */
     if (h->planes)
         for (i = 0; i < h->num_planes; ++i)
@@ -53,7 +61,7 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     if (h->weights_grids)
         for (i = 0; i < h->num_planes; ++i)
         {
-            oskar_mem_free(h->weights_grids[i], status);
+            oskar_weight_grid_free(h->weights_grids[i]);
             oskar_mem_free(h->weights_guard[i], status);
         }
     free(h->weights_grids); h->weights_grids = 0;
@@ -93,6 +93,7 @@ void oskar_imager_run(oskar_Imager* h,
 
     /* Read baseline coordinates and weights if required. */
     if (h->weighting == OSKAR_WEIGHTING_UNIFORM ||
+            h->weighting == OSKAR_WEIGHTING_BRIGGS ||
             h->algorithm == OSKAR_ALGORITHM_WPROJ)
     {
         oskar_imager_set_coords_only(h, 1);
@@ -16,6 +16,7 @@
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
 #include "imager/private_imager_weight_radial.h"
+#include "imager/private_imager_weight_grid.h"
 #include "imager/private_imager_weight_uniform.h"
 #include "log/oskar_log.h"
 #include "utility/oskar_device.h"
@@ -32,7 +33,7 @@ static void oskar_imager_allocate_planes(oskar_Imager* h, int *status);
 static void oskar_imager_update_weights_grid(oskar_Imager* h,
         size_t num_points, const oskar_Mem* uu, const oskar_Mem* vv,
         const oskar_Mem* ww, const oskar_Mem* weight, oskar_Mem* weights_grid,
-        oskar_Mem* weights_guard, int* status);
+        int i_plane, int* status);
 
 void oskar_imager_update_from_block(oskar_Imager* h,
         const oskar_VisHeader* hdr, oskar_VisBlock* block,
@@ -423,7 +424,7 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
             i_plane = h->num_im_pols * c + p;
             oskar_imager_update_plane(h, num_vis, h->uu_im, h->vv_im,
                     h->ww_im, (h->coords_only ? 0 : h->vis_im), h->weight_im,
-                    i_plane, 0, 0, h->weights_grids[i_plane], status);
+                    i_plane, 0, 0, 0, status);
         }
     }
 
@@ -480,7 +481,7 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
     if (h->coords_only)
     {
         oskar_imager_update_weights_grid(h, num_vis, pu, pv, pw, ph,
-                weights_grid, h->weights_guard[i_plane], status);
+                weights_grid, i_plane, status);
     }
     else
     {
@@ -514,10 +515,26 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             ph = h->weight_tmp;
             break;
         case OSKAR_WEIGHTING_UNIFORM:
+        case OSKAR_WEIGHTING_BRIGGS:
             oskar_timer_resume(h->tmr_weights_lookup);
-            oskar_imager_weight_uniform(num_vis, pu, pv, ph, h->weight_tmp,
-                    h->cellsize_rad, oskar_imager_plane_size(h), weights_grid,
-                    &num_skipped, status);
+            if (!weights_grid)
+            {
+                if (h->weights_grids && i_plane < h->num_planes)
+                    oskar_weight_grid_read(h->weights_grids[i_plane],
+                            h->weighting, h->robust, num_vis, pu, pv, ph,
+                            h->weight_tmp, h->cellsize_rad, &num_skipped,
+                            status);
+                else
+                    *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+            }
+            else if (h->weighting == OSKAR_WEIGHTING_BRIGGS)
+                oskar_imager_weight_briggs(num_vis, pu, pv, ph, h->weight_tmp,
+                        h->cellsize_rad, oskar_imager_plane_size(h),
+                        h->robust, weights_grid, &num_skipped, status);
+            else
+                oskar_imager_weight_uniform(num_vis, pu, pv, ph, h->weight_tmp,
+                        h->cellsize_rad, oskar_imager_plane_size(h),
+                        weights_grid, &num_skipped, status);
             oskar_timer_pause(h->tmr_weights_lookup);
             ph = h->weight_tmp;
             break;
@@ -571,43 +588,63 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
 
 void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
         const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
-        const oskar_Mem* weight, oskar_Mem* weights_grid,
-        oskar_Mem* weights_guard, int* status)
+        const oskar_Mem* weight, oskar_Mem* weights_grid, int i_plane,
+        int* status)
 {
     if (*status) return;
 
     /* Update the weights grid. */
-    if (h->weighting == OSKAR_WEIGHTING_UNIFORM)
+    if (h->weighting == OSKAR_WEIGHTING_UNIFORM ||
+            h->weighting == OSKAR_WEIGHTING_BRIGGS)
     {
         size_t num_cells, num_skipped = 0;
-
-        /* Resize the grid of weights if needed. */
         const int grid_size = oskar_imager_plane_size(h);
         num_cells = (size_t) grid_size * (size_t) grid_size;
-        oskar_mem_ensure(weights_grid, num_cells, status);
-        if (*status) return;
 
+        /* Use the internal (sparse) grid if one was not supplied. */
         oskar_timer_resume(h->tmr_weights_grid);
-        if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
+        if (!weights_grid)
         {
-            oskar_grid_weights_write_d(num_points,
-                    oskar_mem_double_const(uu, status),
-                    oskar_mem_double_const(vv, status),
-                    oskar_mem_double_const(weight, status),
-                    h->cellsize_rad, grid_size, &num_skipped,
-                    oskar_mem_double(weights_grid, status));
+            oskar_imager_check_init(h, status);
+            if (!*status && i_plane >= h->num_planes)
+                *status = OSKAR_ERR_OUT_OF_RANGE;
+            if (!*status)
+                oskar_weight_grid_write(h->weights_grids[i_plane],
+                        num_points, uu, vv, weight, h->cellsize_rad,
+                        grid_size, &num_skipped, status);
+        }
+        else if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
+        {
+            oskar_mem_ensure(weights_grid, num_cells, status);
+            if (!*status)
+                oskar_grid_weights_write_d(num_points,
+                        oskar_mem_double_const(uu, status),
+                        oskar_mem_double_const(vv, status),
+                        oskar_mem_double_const(weight, status),
+                        h->cellsize_rad, grid_size, &num_skipped,
+                        oskar_mem_double(weights_grid, status));
         }
         else
         {
-            oskar_mem_ensure(weights_guard, num_cells, status);
-            if (*status) return;
-            oskar_grid_weights_write_f(num_points,
-                    oskar_mem_float_const(uu, status),
-                    oskar_mem_float_const(vv, status),
-                    oskar_mem_float_const(weight, status),
-                    (float) (h->cellsize_rad), grid_size, &num_skipped,
-                    oskar_mem_float(weights_grid, status),
-                    oskar_mem_float(weights_guard, status));
+            /* Keep the compensation for each plane between calls. */
+            oskar_imager_check_init(h, status);
+            if (!*status && i_plane >= h->num_planes)
+                *status = OSKAR_ERR_OUT_OF_RANGE;
+            if (!*status)
+            {
+                oskar_Mem* weights_guard = h->weights_guard[i_plane];
+                oskar_mem_ensure(weights_guard, num_cells, status);
+                oskar_mem_ensure(weights_grid, num_cells, status);
+                if (!*status)
+                    oskar_grid_weights_write_f(num_points,
+                            oskar_mem_float_const(uu, status),
+                            oskar_mem_float_const(vv, status),
+                            oskar_mem_float_const(weight, status),
+                            (float) (h->cellsize_rad), grid_size,
+                            &num_skipped,
+                            oskar_mem_float(weights_grid, status),
+                            oskar_mem_float(weights_guard, status));
+            }
         }
         if (num_skipped > 0)
             oskar_log_warning(h->log, "Skipped %lu visibility weights.",
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/oskar_grid_weights.h"
+#include "imager/oskar_imager.h"
+#include "imager/private_imager_weight_grid.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of row bands, and so the useful number of threads. */
+#define MAX_BANDS 64
+
+/* The grid is made dense once more than 1/DENSE_FRACTION cells are filled. */
+#define DENSE_FRACTION 16
+
+#define NO_CELL OSKAR_GRID_WEIGHTS_NO_CELL
+
+static size_t band_hash(size_t key, size_t capacity)
+{
+    return (size_t)(((unsigned long long) key *
+            0x9E3779B97F4A7C15ULL) >> 17) & (capacity - 1);
+}
+
+static double band_lookup(const oskar_WeightGridBand* b, size_t cell)
+{
+    size_t i;
+    const size_t key = cell + 1;
+    if (b->capacity == 0) return 0.0;
+    for (i = band_hash(key, b->capacity);; i = (i + 1) & (b->capacity - 1))
+    {
+        if (b->keys[i] == key) return b->vals[i];
+        if (b->keys[i] == 0) return 0.0;
+    }
+}
+
+static int band_resize(oskar_WeightGridBand* b, size_t capacity)
+{
+    size_t i, j;
+    size_t* keys = (size_t*) calloc(capacity, sizeof(size_t));
+    double* vals = (double*) calloc(capacity, sizeof(double));
+    if (!keys || !vals)
+    {
+        free(keys);
+        free(vals);
+        return 1;
+    }
+    for (i = 0; i < b->capacity; ++i)
+    {
+        if (b->keys[i] == 0) continue;
+        for (j = band_hash(b->keys[i], capacity); keys[j] != 0;
+                j = (j + 1) & (capacity - 1));
+        keys[j] = b->keys[i];
+        vals[j] = b->vals[i];
+    }
+    free(b->keys);
+    free(b->vals);
+    b->keys = keys;
+    b->vals = vals;
+    b->capacity = capacity;
+    return 0;
+}
+
+static int band_add(oskar_WeightGridBand* b, size_t cell, double weight)
+{
+    size_t i;
+    const size_t key = cell + 1;
+
+    /* Keep the load factor below one half. */
+    if (2 * (b->count + 1) > b->capacity)
+    {
+        if (band_resize(b, b->capacity ? 2 * b->capacity : 256)) return 1;
+    }
+    for (i = band_hash(key, b->capacity);; i = (i + 1) & (b->capacity - 1))
+    {
+        if (b->keys[i] == key)
+        {
+            b->vals[i] += weight;
+            return 0;
+        }
+        if (b->keys[i] == 0)
+        {
+            b->keys[i] = key;
+            b->vals[i] = weight;
+            b->count++;
+            return 0;
+        }
+    }
+}
+
+static void make_dense(oskar_WeightGrid* g, int* status)
+{
+    int b;
+    size_t i;
+    const size_t num_cells = (size_t) g->grid_size * (size_t) g->grid_size;
+    g->dense = (double*) calloc(num_cells, sizeof(double));
+    if (!g->dense)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (b = 0; b < g->num_bands; ++b)
+    {
+        oskar_WeightGridBand* band = &g->bands[b];
+        for (i = 0; i < band->capacity; ++i)
+            if (band->keys[i] != 0)
+                g->dense[band->keys[i] - 1] = band->vals[i];
+        free(band->keys);
+        free(band->vals);
+    }
+    free(g->bands);
+    g->bands = 0;
+}
+
+/* Returns the grid cell index for each point, or NO_CELL if outside. */
+static size_t* cell_indices(size_t num_points, const oskar_Mem* uu,
+        const oskar_Mem* vv, double cell_size_rad, int grid_size,
+        size_t* num_skipped, int* status)
+{
+    size_t skipped = 0;
+    long int i;
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * cell_size_rad;
+    const double *u_d = 0, *v_d = 0;
+    const float *u_f = 0, *v_f = 0;
+    size_t* cell = (size_t*) malloc(num_points * sizeof(size_t));
+    if (!cell)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (oskar_mem_precision(uu) == OSKAR_DOUBLE)
+    {
+        u_d = oskar_mem_double_const(uu, status);
+        v_d = oskar_mem_double_const(vv, status);
+    }
+    else
+    {
+        u_f = oskar_mem_float_const(uu, status);
+        v_f = oskar_mem_float_const(vv, status);
+    }
+#pragma omp parallel for private(i) reduction(+:skipped)
+    for (i = 0; i < (long int) num_points; ++i)
+    {
+        int grid_u, grid_v;
+        if (u_d)
+        {
+            grid_u = (int)round(-u_d[i] * grid_scale) + grid_centre;
+            grid_v = (int)round(v_d[i] * grid_scale) + grid_centre;
+        }
+        else
+        {
+            const float scale = grid_size * (float) cell_size_rad;
+            grid_u = (int)roundf(-u_f[i] * scale) + grid_centre;
+            grid_v = (int)roundf(v_f[i] * scale) + grid_centre;
+        }
+        if (grid_u >= grid_size || grid_u < 0 ||
+                grid_v >= grid_size || grid_v < 0)
+        {
+            cell[i] = NO_CELL;
+            skipped++;
+            continue;
+        }
+        cell[i] = (size_t) grid_v * (size_t) grid_size + (size_t) grid_u;
+    }
+    *num_skipped = skipped;
+    return cell;
+}
+
+
+oskar_WeightGrid* oskar_weight_grid_create(void)
+{
+    return (oskar_WeightGrid*) calloc(1, sizeof(oskar_WeightGrid));
+}
+
+
+void oskar_weight_grid_free(oskar_WeightGrid* g)
+{
+    int b;
+    if (!g) return;
+    if (g->bands)
+    {
+        for (b = 0; b < g->num_bands; ++b)
+        {
+            free(g->bands[b].keys);
+            free(g->bands[b].vals);
+        }
+    }
+    free(g->bands);
+    free(g->dense);
+    free(g);
+}
+
+
+void oskar_weight_grid_write(oskar_WeightGrid* g, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* weight,
+        double cell_size_rad, int grid_size, size_t* num_skipped,
+        int* status)
+{
+    int b, error = 0;
+    size_t *cell = 0, *order = 0, *band_start = 0;
+    const double* w_d = 0;
+    const float* w_f = 0;
+    *num_skipped = 0;
+    if (*status || num_points == 0) return;
+
+    /* Set the grid dimensions on first use. */
+    if (g->grid_size == 0)
+    {
+        g->grid_size = grid_size;
+        g->num_bands = grid_size < MAX_BANDS ? grid_size : MAX_BANDS;
+        g->rows_per_band = (grid_size + g->num_bands - 1) / g->num_bands;
+        g->bands = (oskar_WeightGridBand*)
+                calloc(g->num_bands, sizeof(oskar_WeightGridBand));
+        if (!g->bands)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+    }
+    else if (g->grid_size != grid_size)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Find the cell for each point. */
+    cell = cell_indices(num_points, uu, vv, cell_size_rad, grid_size,
+            num_skipped, status);
+    if (*status) return;
+    if (oskar_mem_precision(weight) == OSKAR_DOUBLE)
+        w_d = oskar_mem_double_const(weight, status);
+    else
+        w_f = oskar_mem_float_const(weight, status);
+
+    /* With more than one thread, sort the points by band, so that each
+     * thread adds the points in whole bands of rows. No locking is then
+     * needed, and weights in each cell are summed in the same order as in
+     * serial. */
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1)
+    {
+        band_start = (size_t*) malloc((g->num_bands + 1) * sizeof(size_t));
+        if (band_start)
+            order = oskar_grid_weights_sort_by_band(num_points, cell,
+                    grid_size, g->rows_per_band, g->num_bands, band_start);
+        if (!order)
+        {
+            free(band_start);
+            free(cell);
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+    }
+#endif
+    if (order)
+    {
+#pragma omp parallel for private(b) schedule(dynamic)
+        for (b = 0; b < g->num_bands; ++b)
+        {
+            size_t j;
+            for (j = band_start[b]; j < band_start[b + 1]; ++j)
+            {
+                const size_t i = order[j], c = cell[i];
+                const double w = w_d ? w_d[i] : (double) w_f[i];
+                if (g->dense)
+                    g->dense[c] += w;
+                else if (band_add(&g->bands[b], c, w))
+                    error = 1;
+            }
+        }
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < num_points; ++i)
+        {
+            const size_t c = cell[i];
+            if (c == NO_CELL) continue;
+            const int band = (int) (c / (size_t) grid_size) / g->rows_per_band;
+            const double w = w_d ? w_d[i] : (double) w_f[i];
+            if (g->dense)
+                g->dense[c] += w;
+            else if (band_add(&g->bands[band], c, w))
+                error = 1;
+        }
+    }
+    free(order);
+    free(band_start);
+    free(cell);
+    g->sums_valid = 0;
+    if (error)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+    /* Switch to a dense grid if it would use less memory. */
+    if (!g->dense)
+    {
+        const size_t num_cells = (size_t) grid_size * (size_t) grid_size;
+        g->num_filled = 0;
+        for (b = 0; b < g->num_bands; ++b)
+            g->num_filled += g->bands[b].count;
+        if (g->num_filled > num_cells / DENSE_FRACTION)
+            make_dense(g, status);
+    }
+}
+
+
+void oskar_weight_grid_read(oskar_WeightGrid* g, int weighting,
+        double robust, size_t num_points, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* weight_in, oskar_Mem* weight_out,
+        double cell_size_rad, size_t* num_skipped, int* status)
+{
+    long int i;
+    size_t* cell = 0;
+    double f2 = 0.0;
+    *num_skipped = 0;
+    if (*status || num_points == 0) return;
+
+    /* Check the grid has been filled. */
+    if (g->grid_size == 0)
+    {
+        *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Sum the gridded weights and their squares for Briggs weighting. */
+    if (weighting == OSKAR_WEIGHTING_BRIGGS)
+    {
+        if (!g->sums_valid)
+        {
+            int b;
+            size_t j;
+            double sum_w = 0.0, sum_w2 = 0.0;
+            if (g->dense)
+            {
+                const size_t num_cells =
+                        (size_t) g->grid_size * (size_t) g->grid_size;
+                for (j = 0; j < num_cells; ++j)
+                {
+                    sum_w += g->dense[j];
+                    sum_w2 += g->dense[j] * g->dense[j];
+                }
+            }
+            else
+            {
+                for (b = 0; b < g->num_bands; ++b)
+                {
+                    const oskar_WeightGridBand* band = &g->bands[b];
+                    for (j = 0; j < band->capacity; ++j)
+                    {
+                        if (band->keys[j] == 0) continue;
+                        sum_w += band->vals[j];
+                        sum_w2 += band->vals[j] * band->vals[j];
+                    }
+                }
+            }
+            g->sum_w = sum_w;
+            g->sum_w2 = sum_w2;
+            g->sums_valid = 1;
+        }
+        if (g->sum_w2 > 0.0)
+            f2 = pow(5.0 * pow(10.0, -robust), 2.0) /
+                    (g->sum_w2 / g->sum_w);
+    }
+
+    /* Size the output array. */
+    oskar_mem_realloc(weight_out, num_points, status);
+    cell = cell_indices(num_points, uu, vv, cell_size_rad, g->grid_size,
+            num_skipped, status);
+    if (*status) return;
+
+    /* Calculate new weights from the grid. */
+    if (oskar_mem_precision(weight_out) == OSKAR_DOUBLE)
+    {
+        const double* in = oskar_mem_double_const(weight_in, status);
+        double* out = oskar_mem_double(weight_out, status);
+#pragma omp parallel for private(i)
+        for (i = 0; i < (long int) num_points; ++i)
+        {
+            const size_t c = cell[i];
+            if (c == NO_CELL) continue;
+            const double w = g->dense ? g->dense[c] : band_lookup(
+                    &g->bands[(c / g->grid_size) / g->rows_per_band], c);
+            if (weighting == OSKAR_WEIGHTING_BRIGGS)
+                out[i] = in[i] / (1.0 + w * f2);
+            else
+                out[i] = (w != 0.0) ? in[i] / w : 0.0;
+        }
+    }
+    else
+    {
+        const float* in = oskar_mem_float_const(weight_in, status);
+        float* out = oskar_mem_float(weight_out, status);
+#pragma omp parallel for private(i)
+        for (i = 0; i < (long int) num_points; ++i)
+        {
+            const size_t c = cell[i];
+            if (c == NO_CELL) continue;
+            const double w = g->dense ? g->dense[c] : band_lookup(
+                    &g->bands[(c / g->grid_size) / g->rows_per_band], c);
+            if (weighting == OSKAR_WEIGHTING_BRIGGS)
+                out[i] = (float) (in[i] / (1.0 + w * f2));
+            else
+                out[i] = (w != 0.0) ? (float) (in[i] / w) : 0.0f;
+        }
+    }
+    free(cell);
+}
+
+
+size_t oskar_weight_grid_memory(const oskar_WeightGrid* g)
+{
+    int b;
+    size_t bytes = 0;
+    if (!g) return 0;
+    if (g->dense)
+        return (size_t) g->grid_size * (size_t) g->grid_size * sizeof(double);
+    if (g->bands)
+        for (b = 0; b < g->num_bands; ++b)
+            bytes += g->bands[b].capacity * (sizeof(size_t) + sizeof(double));
+    return bytes;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -70,6 +70,65 @@ void oskar_imager_weight_uniform(size_t num_points, const oskar_Mem* uu,
                 oskar_mem_float_const(weight_grid, status));
 }
 
+void oskar_imager_weight_briggs(size_t num_points, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* weight_in, oskar_Mem* weight_out,
+        double cell_size_rad, int grid_size, double robust,
+        const oskar_Mem* weight_grid, size_t* num_skipped, int* status)
+{
+    size_t i, num_cells;
+    double sum_w = 0.0, sum_w2 = 0.0, f2 = 0.0;
+
+    /* Convert the grid to uniform weights first. */
+    oskar_imager_weight_uniform(num_points, uu, vv, weight_in, weight_out,
+            cell_size_rad, grid_size, weight_grid, num_skipped, status);
+    if (*status) return;
+
+    /* Get the Briggs scale factor from the gridded weights. */
+    num_cells = (size_t) grid_size * (size_t) grid_size;
+    if (oskar_mem_precision(weight_grid) == OSKAR_DOUBLE)
+    {
+        const double* g = oskar_mem_double_const(weight_grid, status);
+        for (i = 0; i < num_cells; ++i)
+        {
+            sum_w += g[i];
+            sum_w2 += g[i] * g[i];
+        }
+    }
+    else
+    {
+        const float* g = oskar_mem_float_const(weight_grid, status);
+        for (i = 0; i < num_cells; ++i)
+        {
+            sum_w += g[i];
+            sum_w2 += (double)g[i] * g[i];
+        }
+    }
+    if (sum_w2 > 0.0)
+        f2 = pow(5.0 * pow(10.0, -robust), 2.0) / (sum_w2 / sum_w);
+
+    /* Recover the gridded weight W from the uniform weight w / W,
+     * and use it to form the Briggs weight w / (1 + W f^2). */
+    if (oskar_mem_precision(weight_out) == OSKAR_DOUBLE)
+    {
+        const double* in = oskar_mem_double_const(weight_in, status);
+        double* out = oskar_mem_double(weight_out, status);
+        for (i = 0; i < num_points; ++i)
+            if (out[i] != 0.0)
+                out[i] = in[i] / (1.0 + (in[i] / out[i]) * f2);
+    }
+    else
+    {
+        const float* in = oskar_mem_float_const(weight_in, status);
+        float* out = oskar_mem_float(weight_out, status);
+        for (i = 0; i < num_points; ++i)
+            if (out[i] != 0.0f)
+            {
+                const double w = (double)in[i] / out[i];
+                out[i] = (float) (in[i] / (1.0 + w * f2));
+            }
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
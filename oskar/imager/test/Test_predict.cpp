@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+
+static const int size = 256;
+static const double cellsize_arcsec = 30.0;
+static const int num_sources = 3;
+static const int src_x[] = {size / 2, size / 2 + 10, size / 2 - 60};
+static const int src_y[] = {size / 2, size / 2 - 20, size / 2 + 5};
+static const double src_flux[] = {0.5, 1.0, 2.0};
+
+static double predict_error(const char* algorithm, double w_max, int type)
+{
+    int status = 0;
+    const int num_vis = 2000;
+
+    // Create and set up the imager.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_cellsize(im, cellsize_arcsec);
+    if (w_max > 0.0)
+        oskar_imager_set_w_range(im, 0.0, w_max, w_max / sqrt(3.0));
+
+    // Create a model image containing point sources.
+    oskar_Mem* image = oskar_mem_create(type, OSKAR_CPU,
+            size * size, &status);
+    oskar_mem_clear_contents(image, &status);
+    for (int i = 0; i < num_sources; ++i)
+        oskar_mem_set_element_real(image, src_y[i] * size + src_x[i],
+                src_flux[i], &status);
+    oskar_imager_set_model_image(im, image, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate baseline coordinates inside the grid.
+    const double max_uv = 0.4 / (cellsize_arcsec * M_PI / (180.0 * 3600.0));
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_uniform(uu, 1, 2, 3, 4, &status);
+    oskar_mem_random_uniform(vv, 5, 6, 7, 8, &status);
+    oskar_mem_random_uniform(ww, 9, 10, 11, 12, &status);
+    double* u = oskar_mem_double(uu, &status);
+    double* v = oskar_mem_double(vv, &status);
+    double* w = oskar_mem_double(ww, &status);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        u[i] = max_uv * (2.0 * u[i] - 1.0);
+        v[i] = max_uv * (2.0 * v[i] - 1.0);
+        w[i] = w_max * (2.0 * w[i] - 1.0);
+    }
+
+    // Predict the visibilities.
+    oskar_Mem* uu_t = oskar_mem_convert_precision(uu, type, &status);
+    oskar_Mem* vv_t = oskar_mem_convert_precision(vv, type, &status);
+    oskar_Mem* ww_t = oskar_mem_convert_precision(ww, type, &status);
+    oskar_Mem* vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            0, &status);
+    oskar_imager_predict(im, num_vis, uu_t, vv_t, ww_t, vis, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Mem* vis_d = oskar_mem_convert_precision(vis, OSKAR_DOUBLE, &status);
+    const double* v_pred = oskar_mem_double_const(vis_d, &status);
+
+    // Compare with the direct sum over the sources.
+    double max_err = 0.0;
+    const double sin_cell = sin(cellsize_arcsec * M_PI / (180.0 * 3600.0));
+    for (int i = 0; i < num_vis; ++i)
+    {
+        double re = 0.0, im_ = 0.0;
+        for (int s = 0; s < num_sources; ++s)
+        {
+            const double l = -(src_x[s] - size / 2) * sin_cell;
+            const double m = (src_y[s] - size / 2) * sin_cell;
+            const double n = sqrt(1.0 - l * l - m * m);
+            const double arg = 2.0 * M_PI * (u[i] * l + v[i] * m +
+                    w[i] * (n - 1.0));
+            re += src_flux[s] * cos(arg);
+            im_ += src_flux[s] * sin(arg);
+        }
+        const double err = sqrt(pow(v_pred[2 * i] - re, 2.0) +
+                pow(v_pred[2 * i + 1] - im_, 2.0));
+        if (err > max_err || err != err) max_err = err;
+    }
+
+    // Clean up.
+    oskar_mem_free(image, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(uu_t, &status);
+    oskar_mem_free(vv_t, &status);
+    oskar_mem_free(ww_t, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(vis_d, &status);
+    oskar_imager_free(im, &status);
+    EXPECT_EQ(0, status);
+    return max_err;
+}
+
+// The errors are compared with the total flux of 3.5 Jy.
+// Errors from the FFT algorithm are limited by the aliasing of the
+// spheroidal kernel; errors from W-projection are limited by the
+// oversampling of the W-kernels, as for imaging.
+
+TEST(imager, predict_fft)
+{
+    EXPECT_LT(predict_error("FFT", 0.0, OSKAR_DOUBLE), 0.02);
+    EXPECT_LT(predict_error("FFT", 0.0, OSKAR_SINGLE), 0.02);
+}
+
+TEST(imager, predict_wproj)
+{
+    // Ignoring the w-term here would give errors of order 1 Jy.
+    EXPECT_LT(predict_error("W-projection", 3000.0, OSKAR_DOUBLE), 0.5);
+}
+
+TEST(imager, predict_dft)
+{
+    EXPECT_LT(predict_error("DFT 3D", 3000.0, OSKAR_DOUBLE), 1e-9);
+    EXPECT_LT(predict_error("DFT 2D", 0.0, OSKAR_DOUBLE), 1e-9);
+}
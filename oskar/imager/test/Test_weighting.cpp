@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_weights.h"
+#include "imager/oskar_imager.h"
+#include "vis/oskar_vis_header.h"
+#include "vis/oskar_vis_block.h"
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static oskar_Mem* make_image(int type, int size, const char* weighting,
+        double robust, int* status)
+{
+    // Create and set up an imager.
+    oskar_Imager* im = oskar_imager_create(type, status);
+    oskar_imager_set_fov(im, 5.0);
+    oskar_imager_set_size(im, size, status);
+    oskar_imager_set_weighting(im, weighting, status);
+    oskar_imager_set_robust(im, robust);
+
+    // Create visibility data.
+    const int num_times = 8, num_channels = 1, num_stations = 64;
+    oskar_VisHeader* hdr = oskar_vis_header_create(type | OSKAR_COMPLEX, type,
+            num_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, status);
+    oskar_Mem* vis = oskar_vis_block_cross_correlations(block);
+    oskar_Mem* u = oskar_vis_block_station_uvw_metres(block, 0);
+    oskar_Mem* v = oskar_vis_block_station_uvw_metres(block, 1);
+    oskar_Mem* w = oskar_vis_block_station_uvw_metres(block, 2);
+    oskar_mem_random_gaussian(u, 0, 1, 2, 3, 500.0, status);
+    oskar_mem_random_gaussian(v, 4, 5, 6, 7, 500.0, status);
+    oskar_mem_set_value_real(w, 0.0, 0, oskar_mem_length(w), status);
+    oskar_mem_random_gaussian(vis, 8, 9, 10, 11, 1.0, status);
+
+    // Make the image.
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update_from_block(im, hdr, block, status);
+    oskar_imager_set_coords_only(im, 0);
+    oskar_imager_update_from_block(im, hdr, block, status);
+    oskar_Mem* image = oskar_mem_create(type, OSKAR_CPU, size * size, status);
+    oskar_imager_finalise(im, 1, &image, 0, 0, status);
+
+    // Clean up.
+    oskar_imager_free(im, status);
+    oskar_vis_block_free(block, status);
+    oskar_vis_header_free(hdr, status);
+    return image;
+}
+
+TEST(imager, briggs_weighting_limits)
+{
+    // Use a large grid (sparse weights) and a small grid (dense weights).
+    const int sizes[] = {1024, 64};
+    const int types[] = {OSKAR_DOUBLE, OSKAR_SINGLE};
+    for (int t = 0; t < 2; ++t)
+    {
+        for (int s = 0; s < 2; ++s)
+        {
+            int status = 0;
+            double max_err = 0.0, avg_err = 0.0;
+            oskar_Mem* natural = make_image(types[t], sizes[s],
+                    "Natural", 0.0, &status);
+            oskar_Mem* uniform = make_image(types[t], sizes[s],
+                    "Uniform", 0.0, &status);
+            oskar_Mem* robust_hi = make_image(types[t], sizes[s],
+                    "Briggs", 5.0, &status);
+            oskar_Mem* robust_lo = make_image(types[t], sizes[s],
+                    "Briggs", -5.0, &status);
+            oskar_Mem* robust_0 = make_image(types[t], sizes[s],
+                    "Briggs", 0.0, &status);
+            ASSERT_EQ(0, status);
+
+            // Large robustness should give natural weighting.
+            oskar_mem_evaluate_relative_error(robust_hi, natural,
+                    0, &max_err, &avg_err, 0, &status);
+            EXPECT_LT(avg_err, 1e-4);
+
+            // Small robustness should give uniform weighting.
+            oskar_mem_evaluate_relative_error(robust_lo, uniform,
+                    0, &max_err, &avg_err, 0, &status);
+            EXPECT_LT(avg_err, 1e-4);
+
+            // Intermediate robustness should be neither.
+            oskar_mem_evaluate_relative_error(robust_0, natural,
+                    0, &max_err, &avg_err, 0, &status);
+            EXPECT_GT(avg_err, 1e-3);
+            oskar_mem_evaluate_relative_error(robust_0, uniform,
+                    0, &max_err, &avg_err, 0, &status);
+            EXPECT_GT(avg_err, 1e-3);
+            oskar_mem_free(natural, &status);
+            oskar_mem_free(uniform, &status);
+            oskar_mem_free(robust_hi, &status);
+            oskar_mem_free(robust_lo, &status);
+            oskar_mem_free(robust_0, &status);
+        }
+    }
+}
+
+TEST(imager, grid_weights_write)
+{
+    int status = 0, type = OSKAR_DOUBLE;
+    const int grid_size = 256;
+    const size_t num_points = 100000, num_cells = grid_size * grid_size;
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* wt = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* grid = oskar_mem_create(type, OSKAR_CPU, num_cells, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 100.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 100.0, &status);
+    oskar_mem_set_value_real(wt, 1.0, 0, num_points, &status);
+    oskar_mem_clear_contents(grid, &status);
+    ASSERT_EQ(0, status);
+
+    // Check every point is either on the grid or counted as skipped.
+    size_t num_skipped = 0;
+    oskar_grid_weights_write_d(num_points, oskar_mem_double(uu, &status),
+            oskar_mem_double(vv, &status), oskar_mem_double(wt, &status),
+            0.004, grid_size, &num_skipped, oskar_mem_double(grid, &status));
+    const double* g = oskar_mem_double(grid, &status);
+    double sum = 0.0;
+    for (size_t i = 0; i < num_cells; ++i) sum += g[i];
+    EXPECT_GT(num_skipped, 0u);
+    EXPECT_DOUBLE_EQ((double) (num_points - num_skipped), sum);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(wt, &status);
+    oskar_mem_free(grid, &status);
+}
+
+TEST(imager, grid_weights_sort_by_band)
+{
+    // Cells on a 10 x 10 grid, in bands of 3 rows, with some outside.
+    const int grid_size = 10, rows_per_band = 3, num_bands = 4;
+    const size_t num_points = 1000;
+    std::vector<size_t> cell(num_points), band_start(num_bands + 1);
+    for (size_t i = 0; i < num_points; ++i)
+        cell[i] = (i % 7 == 0) ? OSKAR_GRID_WEIGHTS_NO_CELL :
+                (i * 37) % (grid_size * grid_size);
+    size_t* order = oskar_grid_weights_sort_by_band(num_points, &cell[0],
+            grid_size, rows_per_band, num_bands, &band_start[0]);
+    ASSERT_TRUE(order != 0);
+
+    // Check each point is in its band, in the input order.
+    size_t num_inside = 0;
+    for (size_t i = 0; i < num_points; ++i)
+        if (cell[i] != OSKAR_GRID_WEIGHTS_NO_CELL) num_inside++;
+    EXPECT_EQ(0u, band_start[0]);
+    EXPECT_EQ(num_inside, band_start[num_bands]);
+    for (int b = 0; b < num_bands; ++b)
+    {
+        for (size_t j = band_start[b]; j < band_start[b + 1]; ++j)
+        {
+            EXPECT_EQ(b, (int) (cell[order[j]] / grid_size) / rows_per_band);
+            if (j > band_start[b])
+            {
+                EXPECT_LT(order[j - 1], order[j]);
+            }
+        }
+    }
+    free(order);
+}
+
+TEST(imager, grid_weights_threads)
+{
+    // Grids made with several threads must match those from one thread.
+    int status = 0;
+    const int grid_size = 256;
+    const size_t num_points = 100000, num_cells = grid_size * grid_size;
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points,
+            &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points,
+            &status);
+    oskar_Mem* wt = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points,
+            &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 100.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 100.0, &status);
+    oskar_mem_random_gaussian(wt, 8, 9, 10, 11, 1.0, &status);
+    oskar_Mem* uu_f = oskar_mem_convert_precision(uu, OSKAR_SINGLE, &status);
+    oskar_Mem* vv_f = oskar_mem_convert_precision(vv, OSKAR_SINGLE, &status);
+    oskar_Mem* wt_f = oskar_mem_convert_precision(wt, OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status);
+    std::vector<double> grid_d[2];
+    std::vector<float> grid_f[2], guard_f[2];
+    size_t num_skipped[2][2];
+#ifdef _OPENMP
+    const int num_threads_orig = omp_get_max_threads();
+#endif
+    for (int k = 0; k < 2; ++k)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(k == 0 ? 1 : 4);
+#endif
+        grid_d[k].assign(num_cells, 0.0);
+        grid_f[k].assign(num_cells, 0.0f);
+        guard_f[k].assign(num_cells, 0.0f);
+        oskar_grid_weights_write_d(num_points,
+                oskar_mem_double(uu, &status), oskar_mem_double(vv, &status),
+                oskar_mem_double(wt, &status), 0.004, grid_size,
+                &num_skipped[k][0], &grid_d[k][0]);
+        oskar_grid_weights_write_f(num_points,
+                oskar_mem_float(uu_f, &status),
+                oskar_mem_float(vv_f, &status),
+                oskar_mem_float(wt_f, &status), 0.004f, grid_size,
+                &num_skipped[k][1], &grid_f[k][0], &guard_f[k][0]);
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads_orig);
+#endif
+    EXPECT_GT(num_skipped[0][0], 0u);
+    EXPECT_EQ(num_skipped[0][0], num_skipped[1][0]);
+    EXPECT_EQ(num_skipped[0][1], num_skipped[1][1]);
+    EXPECT_TRUE(grid_d[0] == grid_d[1]);
+    EXPECT_TRUE(grid_f[0] == grid_f[1]);
+    EXPECT_TRUE(guard_f[0] == guard_f[1]);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(wt, &status);
+    oskar_mem_free(uu_f, &status);
+    oskar_mem_free(vv_f, &status);
+    oskar_mem_free(wt_f, &status);
+}
+
+TEST(imager, weights_grid_compensation)
+{
+    int status = 0, type = OSKAR_SINGLE;
+    const int grid_size = 64, num_updates = 100;
+    const size_t num_cells = grid_size * grid_size;
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_fov(im, 1.0);
+    oskar_imager_set_size(im, grid_size, &status);
+    oskar_imager_set_weighting(im, "Uniform", &status);
+    oskar_imager_set_vis_frequency(im, 100e6, 1e6, 1);
+    oskar_imager_set_coords_only(im, 1);
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, 1, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, 1, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, 1, &status);
+    oskar_Mem* wt = oskar_mem_create(type, OSKAR_CPU, 1, &status);
+    oskar_Mem* grid = oskar_mem_create(type, OSKAR_CPU, num_cells, &status);
+    oskar_mem_clear_contents(uu, &status);
+    oskar_mem_clear_contents(vv, &status);
+    oskar_mem_clear_contents(ww, &status);
+    oskar_mem_clear_contents(grid, &status);
+    oskar_mem_set_value_real(wt, 1.0, 0, 1, &status);
+
+    // Set up the planes.
+    oskar_imager_update(im, 1, 0, 0, 1, uu, vv, ww, 0, wt, 0, &status);
+    ASSERT_EQ(0, status);
+
+    // Add small weights one at a time to a large one in a supplied grid.
+    // The compensation must be kept between calls to avoid losing them.
+    oskar_mem_set_value_real(wt, 16777216.0, 0, 1, &status);
+    oskar_imager_update_plane(im, 1, uu, vv, ww, 0, wt, 0, 0, 0,
+            grid, &status);
+    oskar_mem_set_value_real(wt, 1.0, 0, 1, &status);
+    for (int i = 0; i < num_updates; ++i)
+        oskar_imager_update_plane(im, 1, uu, vv, ww, 0, wt, 0, 0, 0,
+                grid, &status);
+    ASSERT_EQ(0, status);
+    const float* g = oskar_mem_float_const(grid, &status);
+    double sum = 0.0;
+    for (size_t i = 0; i < num_cells; ++i) sum += g[i];
+    EXPECT_NEAR(16777216.0 + num_updates, sum, 1.0);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(wt, &status);
+    oskar_mem_free(grid, &status);
+    oskar_imager_free(im, &status);
+}
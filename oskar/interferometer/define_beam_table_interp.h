@@ -0,0 +1,54 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+/* Catmull-Rom cubic convolution weights for fractional position T. */
+#define OSKAR_BEAM_TABLE_WEIGHTS(FP, T, W) {\
+    const FP t2 = T * T, t3 = t2 * T;\
+    W[0] = (FP)0.5 * (-t3 + (FP)2 * t2 - T);\
+    W[1] = (FP)0.5 * ((FP)3 * t3 - (FP)5 * t2 + (FP)2);\
+    W[2] = (FP)0.5 * ((FP)-3 * t3 + (FP)4 * t2 + T);\
+    W[3] = (FP)0.5 * (t3 - t2);}\
+
+/* The table holds num_comp real values at each grid point, on a
+ * stereographic projection of the sky about the zenith. Grid points
+ * 1 to (grid_size - 2) span projected coordinates -1 to 1 along each axis
+ * (the horizon is the unit circle), so the 4x4 stencil always lies within
+ * the grid. */
+#define OSKAR_BEAM_TABLE_INTERP(NAME, FP) KERNEL(NAME) (\
+        const int num_points,\
+        GLOBAL_IN(FP, x), GLOBAL_IN(FP, y), GLOBAL_IN(FP, z),\
+        const int grid_size, const int num_comp, GLOBAL_IN(FP, table),\
+        const int offset_out, GLOBAL_OUT(FP, beam))\
+{\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num_points)\
+    const int i_out = (offset_out + i) * num_comp;\
+    if (z[i] < (FP)0) {\
+        for (int c = 0; c < num_comp; ++c) beam[i_out + c] = (FP)0;\
+    }\
+    else {\
+        FP wx[4], wy[4];\
+        const FP scale = (FP)0.5 * (FP)(grid_size - 3);\
+        const FP f = (FP)1 / ((FP)1 + z[i]);\
+        const FP px = (x[i] * f + (FP)1) * scale + (FP)1;\
+        const FP py = (y[i] * f + (FP)1) * scale + (FP)1;\
+        int ix = (int) floor(px), iy = (int) floor(py);\
+        ix = ix < 1 ? 1 : (ix > grid_size - 3 ? grid_size - 3 : ix);\
+        iy = iy < 1 ? 1 : (iy > grid_size - 3 ? grid_size - 3 : iy);\
+        const FP tx = px - (FP)ix, ty = py - (FP)iy;\
+        OSKAR_BEAM_TABLE_WEIGHTS(FP, tx, wx)\
+        OSKAR_BEAM_TABLE_WEIGHTS(FP, ty, wy)\
+        for (int c = 0; c < num_comp; ++c) {\
+            FP sum = (FP)0;\
+            for (int j = 0; j < 4; ++j) {\
+                const int k = ((iy - 1 + j) * grid_size + ix - 1) *\
+                        num_comp + c;\
+                sum += wy[j] * (wx[0] * table[k] +\
+                        wx[1] * table[k + num_comp] +\
+                        wx[2] * table[k + 2 * num_comp] +\
+                        wx[3] * table[k + 3 * num_comp]);\
+            }\
+            beam[i_out + c] = sum;\
+        }\
+    }\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
@@ -57,7 +57,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         OSKAR_JONES_K_ARGS(FP, FP2))\
 {\
     KERNEL_LOOP_Y(int, a, 0, num_stations)\
-    KERNEL_LOOP_X(int, s, 0, num_sources)\
+    KERNEL_LOOP_PAR_SIMD_X(int, s, 0, num_sources)\
     FP2 weight; weight.x = weight.y = (FP) 0;\
     if (source_filter[s] > source_filter_min &&\
                 source_filter[s] <= source_filter_max) {\
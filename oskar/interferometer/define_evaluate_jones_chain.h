@@ -0,0 +1,83 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+#define OSKAR_JONES_CHAIN_ARGS(FP, FP_J)\
+        const int       num_sources,\
+        GLOBAL_IN(FP,   l),\
+        GLOBAL_IN(FP,   m),\
+        GLOBAL_IN(FP,   n),\
+        const int       num_stations,\
+        GLOBAL_IN(FP,   u),\
+        GLOBAL_IN(FP,   v),\
+        GLOBAL_IN(FP,   w),\
+        const FP        wavenumber,\
+        GLOBAL_IN(FP,   source_filter),\
+        const FP        source_filter_min,\
+        const FP        source_filter_max,\
+        const int       ignore_w_components,\
+        GLOBAL_IN(FP_J, E),\
+        const int       use_R,\
+        GLOBAL_IN(FP_J, R),\
+        const int       use_gains,\
+        GLOBAL_IN(FP_J, gains),\
+        GLOBAL_OUT(FP_J, J)\
+
+/* Evaluates the interferometer phase for one station and source. */
+#define OSKAR_JONES_CHAIN_K(FP, K) {\
+        K.x = K.y = (FP) 0;\
+        if (source_filter[s] > source_filter_min &&\
+                source_filter[s] <= source_filter_max) {\
+            FP phase = u[a] * l[s] + v[a] * m[s];\
+            if (!ignore_w_components) phase += w[a] * (n[s] - (FP)1);\
+            phase *= wavenumber;\
+            SINCOS(phase, K.y, K.x);\
+        }\
+    }\
+
+/* J = G * K * E * R, for matrix Jones terms. */
+#define OSKAR_JONES_CHAIN_M(NAME, FP, FP2, FP4c) KERNEL(NAME) (\
+        OSKAR_JONES_CHAIN_ARGS(FP, FP4c))\
+{\
+    KERNEL_LOOP_Y(int, a, 0, num_stations)\
+    KERNEL_LOOP_PAR_SIMD_X(int, s, 0, num_sources)\
+    const int i = s + num_sources * a;\
+    FP2 k;\
+    FP4c t, out;\
+    OSKAR_JONES_CHAIN_K(FP, k)\
+    if (use_R) {\
+        const FP4c e = E[i], r = R[i];\
+        OSKAR_MUL_COMPLEX_MATRIX(t, e, r)\
+    }\
+    else t = E[i];\
+    OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, t, k)\
+    if (use_gains) {\
+        const FP4c g = gains[a];\
+        OSKAR_MUL_COMPLEX_MATRIX(out, g, t)\
+    }\
+    else out = t;\
+    J[i] = out;\
+    KERNEL_LOOP_END\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
+
+/* J = G * K * E, for scalar Jones terms. */
+#define OSKAR_JONES_CHAIN_C(NAME, FP, FP2) KERNEL(NAME) (\
+        OSKAR_JONES_CHAIN_ARGS(FP, FP2))\
+{\
+    (void) use_R; (void) R;\
+    KERNEL_LOOP_Y(int, a, 0, num_stations)\
+    KERNEL_LOOP_PAR_SIMD_X(int, s, 0, num_sources)\
+    const int i = s + num_sources * a;\
+    const FP2 e = E[i];\
+    FP2 k, t;\
+    OSKAR_JONES_CHAIN_K(FP, k)\
+    OSKAR_MUL_COMPLEX(t, k, e)\
+    if (use_gains) {\
+        const FP2 g = gains[a];\
+        OSKAR_MUL_COMPLEX_IN_PLACE(FP2, t, g)\
+    }\
+    J[i] = t;\
+    KERNEL_LOOP_END\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
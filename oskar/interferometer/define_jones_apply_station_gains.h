@@ -8,7 +8,7 @@
 {\
     KERNEL_LOOP_Y(int, i_station, 0, num_stations)\
     const FP4c g = gains[i_station];\
-    KERNEL_LOOP_X(int, i_source, 0, num_sources)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i_source, 0, num_sources)\
     const int i_jones = num_sources * i_station + i_source;\
     const FP4c in = jones[i_jones];\
     FP4c out;\
@@ -27,7 +27,7 @@ OSKAR_REGISTER_KERNEL(NAME)
 {\
     KERNEL_LOOP_Y(int, i_station, 0, num_stations)\
     const FP2 g = gains[i_station];\
-    KERNEL_LOOP_X(int, i_source, 0, num_sources)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i_source, 0, num_sources)\
     const int i_jones = num_sources * i_station + i_source;\
     const FP2 in = jones[i_jones];\
     FP2 out;\
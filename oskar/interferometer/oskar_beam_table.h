@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_BEAM_TABLE_H_
+#define OSKAR_BEAM_TABLE_H_
+
+/**
+ * @file oskar_beam_table.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_BeamTable;
+#ifndef OSKAR_BEAM_TABLE_TYPEDEF_
+#define OSKAR_BEAM_TABLE_TYPEDEF_
+typedef struct oskar_BeamTable oskar_BeamTable;
+#endif /* OSKAR_BEAM_TABLE_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates tabulated station beams for an observation.
+ *
+ * @details
+ * Evaluates the beam of each distinct station on a regular grid in a
+ * stereographic projection of the sky about the zenith, once per channel
+ * and pointing epoch, so that E-Jones can later be interpolated from the
+ * tables using oskar_beam_table_evaluate(). The projection is used because
+ * beams remain smooth functions of the grid coordinates all the way down
+ * to the horizon.
+ *
+ * Stations share a table if they are identical and have the same position,
+ * or if the telescope model allows duplication of identical station beams.
+ * Each epoch covers \p epoch_time_steps consecutive time steps,
+ * and the beams are evaluated at the middle time step of the epoch.
+ * The tables are evaluated in parallel, using one thread per processor.
+ *
+ * Each table is checked by comparing interpolated values against a direct
+ * evaluation of the beam at a fixed set of directions above the horizon,
+ * at the first, middle and last time steps of its epoch.
+ * Tables for which the largest difference, relative to the peak of the
+ * beam, exceeds \p max_error are not used, and the beam for that station,
+ * channel and epoch will be evaluated directly instead.
+ *
+ * If \p filename is set, the tables are held in a memory-mapped file.
+ * An existing file is reused if it was made for the same observation
+ * and station models (see oskar_station_checksum()), and if its tables
+ * still pass the check against direct evaluation; otherwise,
+ * it is overwritten.
+ *
+ * The telescope model must be in CPU memory and must not use an
+ * ionospheric screen.
+ *
+ * @param[in] tel                Telescope model, in CPU memory.
+ * @param[in] grid_size          Number of grid points along each axis.
+ * @param[in] epoch_time_steps   Number of time steps per pointing epoch.
+ * @param[in] max_error          Maximum allowed interpolation error.
+ * @param[in] time_start_mjd_utc Observation start time, as MJD(UTC).
+ * @param[in] time_inc_sec       Observation time increment, in seconds.
+ * @param[in] num_time_steps     Number of time steps in the observation.
+ * @param[in] freq_start_hz      Frequency of the first channel, in Hz.
+ * @param[in] freq_inc_hz        Frequency increment, in Hz.
+ * @param[in] num_channels       Number of frequency channels.
+ * @param[in] filename           Path of the table file. May be NULL.
+ * @param[in,out] log            Pointer to log structure to use.
+ * @param[in,out] status         Status return code.
+ *
+ * @return A handle to the tables.
+ */
+OSKAR_EXPORT
+oskar_BeamTable* oskar_beam_table_create(const oskar_Telescope* tel,
+        int grid_size, int epoch_time_steps, double max_error,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        double freq_start_hz, double freq_inc_hz, int num_channels,
+        const char* filename, oskar_Log* log, int* status);
+
+/**
+ * @brief
+ * Evaluates station beams (Jones E) by interpolation from the tables.
+ *
+ * @details
+ * This is a replacement for oskar_evaluate_jones_E() for sources given
+ * as direction cosines relative to a reference point.
+ *
+ * If the tables are used on a GPU, each table needed is copied into
+ * \p table_buffer, which must be in the same memory as the Jones matrices.
+ * The index of the table it holds is kept in \p table_buffer_index,
+ * which should be initialised to -1.
+ *
+ * @param[in] table              Handle to the tables.
+ * @param[out] E                 Jones matrices for all stations.
+ * @param[in] num_points         Number of sources.
+ * @param[in] source_coords      Source direction cosines (l, m, n).
+ * @param[in] ref_lon_rad        Reference longitude, in radians.
+ * @param[in] ref_lat_rad        Reference latitude, in radians.
+ * @param[in] tel                Telescope model, in the same memory as E.
+ * @param[in] time_index         Simulation time index.
+ * @param[in] gast_rad           Greenwich Apparent Sidereal Time, in radians.
+ * @param[in] channel_index      Simulation channel index.
+ * @param[in] frequency_hz       The observing frequency, in Hz.
+ * @param[in] work               Station beam workspace.
+ * @param[in,out] table_buffer   Device copy of a table, if needed.
+ * @param[in,out] table_buffer_index Index of the table in the buffer.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_beam_table_evaluate(const oskar_BeamTable* table, oskar_Jones* E,
+        int num_points, const oskar_Mem* const source_coords[3],
+        double ref_lon_rad, double ref_lat_rad, const oskar_Telescope* tel,
+        int time_index, double gast_rad, int channel_index,
+        double frequency_hz, oskar_StationWork* work,
+        oskar_Mem* table_buffer, int* table_buffer_index, int* status);
+
+/**
+ * @brief
+ * Returns the largest measured error of the tables that are used.
+ *
+ * @details
+ * Returns the largest difference, relative to the beam peak,
+ * between interpolated and directly-evaluated beams, for all tables that
+ * passed the accuracy check.
+ */
+OSKAR_EXPORT
+double oskar_beam_table_measured_error(const oskar_BeamTable* table);
+
+/**
+ * @brief
+ * Returns the number of tables that failed the accuracy check.
+ */
+OSKAR_EXPORT
+int oskar_beam_table_num_rejected(const oskar_BeamTable* table);
+
+/**
+ * @brief
+ * Frees memory held by the tables, and closes any file.
+ */
+OSKAR_EXPORT
+void oskar_beam_table_free(oskar_BeamTable* table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -30,6 +30,10 @@ extern "C" {
  * If all stations are marked as identical, the results for the first station
  * are copied into the results for the others.
  *
+ * If interpolation in time has been enabled in the workspace using
+ * oskar_station_work_set_beam_time_interp(), the station beams are
+ * interpolated between exact beams on a coarser grid of time indices.
+ *
  * @param[out] E             Output set of Jones matrices.
  * @param[in]  coord_type    Type of coordinates.
  * @param[in]  num_points    Number of coordinates given.
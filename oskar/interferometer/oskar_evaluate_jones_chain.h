@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_EVALUATE_JONES_CHAIN_H_
+#define OSKAR_EVALUATE_JONES_CHAIN_H_
+
+/**
+ * @file oskar_evaluate_jones_chain.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates the interferometer phase and joins the Jones chain in one pass.
+ *
+ * @details
+ * This function evaluates the interferometer phase (K) for each source
+ * and station, and multiplies it by the station beam (E), the parallactic
+ * angle rotation (R) and the station gains (G), to give
+ *
+ * J = G * K * E * R
+ *
+ * for each source and station.
+ *
+ * The result is the same as using oskar_evaluate_jones_K(),
+ * oskar_jones_join() and oskar_jones_apply_station_gains() in turn, but
+ * the K-Jones array and the intermediate products are never stored,
+ * so the Jones arrays are read and written only once.
+ *
+ * The R-Jones and the gains are optional, and should be NULL if not used.
+ * R-Jones can be used only with matrix types.
+ *
+ * @param[out] J                 Output set of Jones matrices.
+ * @param[in]  num_sources       The number of sources in the input arrays.
+ * @param[in]  l                 Source l-direction cosines.
+ * @param[in]  m                 Source m-direction cosines.
+ * @param[in]  n                 Source n-direction cosines.
+ * @param[in]  u                 Station u coordinates, in metres.
+ * @param[in]  v                 Station v coordinates, in metres.
+ * @param[in]  w                 Station w coordinates, in metres.
+ * @param[in]  frequency_hz      The current observing frequency, in Hz.
+ * @param[in]  source_filter     Per-source values used for filtering.
+ * @param[in]  source_filter_min Minimum allowed filter value (exclusive).
+ * @param[in]  source_filter_max Maximum allowed filter value (inclusive).
+ * @param[in]  ignore_w_components If set, ignore station w coordinate values.
+ * @param[in]  E                 Station beam Jones matrices.
+ * @param[in]  R                 Optional parallactic angle Jones matrices.
+ * @param[in]  gains             Optional vector of station gains.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_chain(oskar_Jones* J, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double frequency_hz, const oskar_Mem* source_filter,
+        double source_filter_min, double source_filter_max,
+        int ignore_w_components, const oskar_Jones* E, const oskar_Jones* R,
+        const oskar_Mem* gains, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -73,6 +73,26 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status);
 OSKAR_EXPORT
 void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status);
 
+/**
+ * @brief Returns true if devices should own disjoint time ranges.
+ *
+ * @details
+ * Decides how work in each block is shared between compute devices.
+ * With \p device_partition 'T' or 'S', work is partitioned by time or
+ * by sky chunk respectively. With 'A', work is partitioned by time only
+ * if there are at least as many time samples per block as devices, and
+ * the devices are either all GPUs or all CPUs, as each device gets an
+ * equal share of the times.
+ *
+ * @param[in] device_partition     'A' (auto), 'T' (time) or 'S' (sky chunk).
+ * @param[in] num_devices          Number of compute devices.
+ * @param[in] num_gpus             Number of devices which are GPUs.
+ * @param[in] max_times_per_block  Maximum number of times in each block.
+ */
+OSKAR_EXPORT
+int oskar_interferometer_partition_by_time(char device_partition,
+        int num_devices, int num_gpus, int max_times_per_block);
+
 OSKAR_EXPORT
 void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status);
 
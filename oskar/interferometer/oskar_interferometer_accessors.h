@@ -11,6 +11,7 @@
  */
 
 #include <oskar_global.h>
+#include <imager/oskar_imager.h>
 #include <log/oskar_log.h>
 #include <sky/oskar_sky.h>
 #include <telescope/oskar_telescope.h>
@@ -21,6 +22,14 @@
 extern "C" {
 #endif
 
+OSKAR_EXPORT
+void oskar_interferometer_add_imager(oskar_Interferometer* h,
+        oskar_Imager* imager);
+
+OSKAR_EXPORT
+void oskar_interferometer_append_sky_model(oskar_Interferometer* h,
+        const oskar_Sky* sky, int* status);
+
 OSKAR_EXPORT
 int oskar_interferometer_coords_only(const oskar_Interferometer* h);
 
@@ -42,6 +51,49 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status);
 OSKAR_EXPORT
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_adaptive_chunks(oskar_Interferometer* h,
+        int enable, double memory_budget_mb);
+
+OSKAR_EXPORT
+void oskar_interferometer_set_bda(oskar_Interferometer* h, double max_fact,
+        double fov_deg, double max_time_avg_sec, int max_chans_avg);
+
+/**
+ * @brief
+ * Sets whether station beams are interpolated in time.
+ *
+ * @details
+ * If enabled, station beams (E-Jones) of aperture arrays are evaluated
+ * exactly only at every \p time_step time steps, and interpolated
+ * linearly between them, which can be much faster if the beam changes
+ * slowly compared to the time sampling.
+ *
+ * If \p time_step is 0, it is chosen automatically, so that errors
+ * measured at the middle of each interval do not exceed \p max_error,
+ * relative to the peak of the beam.
+ *
+ * Work units are simulated chunk by chunk, so if there is more than one
+ * sky chunk, the cached beams are evaluated again after each change of
+ * chunk, unless \p all_chunks is set. This keeps the beams of every chunk,
+ * which needs memory for two beams per station, channel and source in the
+ * whole sky model on each device.
+ *
+ * @param[in] h          Handle to simulator.
+ * @param[in] enable     If set, interpolate station beams in time.
+ * @param[in] time_step  Time steps between exact beams, or 0 for auto.
+ * @param[in] max_error  Maximum error allowed if the step is automatic.
+ * @param[in] all_chunks If set, keep cached beams for all sky chunks.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_beam_time_interp(oskar_Interferometer* h,
+        int enable, int time_step, double max_error, int all_chunks);
+
+OSKAR_EXPORT
+void oskar_interferometer_set_beam_table(oskar_Interferometer* h,
+        int enable, const char* filename, int grid_size,
+        int epoch_time_steps, double max_error);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -50,10 +102,63 @@ OSKAR_EXPORT
 void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
         const char* type, int* status);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_device_partition(oskar_Interferometer* h,
+        const char* type, int* status);
+
+/**
+ * @brief
+ * Sets when scalar visibilities are correlated without forming the Jones chain.
+ *
+ * @details
+ * For scalar visibilities, the interferometer phase can be evaluated on
+ * each baseline inside the correlator instead of being stored in the
+ * Jones chain, which can be faster for large numbers of stations or for
+ * isotropic stations, where the station beam need not be evaluated
+ * per source.
+ *
+ * The type string is one of:
+ * - "Auto": Time both methods on the first chunks, and use the faster.
+ * - "Direct": Always use direct correlation, where possible.
+ * - "Jones chain": Always form the Jones chain before correlating.
+ *
+ * Direct correlation is not used for polarised visibilities, if
+ * auto-correlations are required, or with level-of-detail correlation.
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] type   Type string, as above.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_direct_correlation(oskar_Interferometer* h,
+        const char* type, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Sets whether the Jones chain is evaluated in a single fused pass.
+ *
+ * @details
+ * If set (the default), the interferometer phase (K) is computed and
+ * combined with the station beam, parallactic angle and station gains
+ * in one pass over each station and source, so K-Jones and the
+ * intermediate products are never stored.
+ *
+ * If clear, each stage of the chain is evaluated and stored separately,
+ * which can be useful for debugging.
+ *
+ * This must be set before device memory is allocated by
+ * oskar_interferometer_check_init().
+ *
+ * @param[in] h      Handle to simulator.
+ * @param[in] value  If set, use the fused Jones chain.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_fused_jones(oskar_Interferometer* h, int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num_gpus,
         const int* cuda_device_ids, int* status);
@@ -65,6 +170,15 @@ OSKAR_EXPORT
 void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_facet_prediction(oskar_Interferometer* h,
+        int enable, int min_sources, double facet_size_deg,
+        double pixel_oversample);
+
+OSKAR_EXPORT
+void oskar_interferometer_set_level_of_detail(oskar_Interferometer* h,
+        int enable, double tolerance_jy);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value);
@@ -77,6 +191,34 @@ OSKAR_EXPORT
 void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
         int value);
 
+/**
+ * @brief
+ * Sets a model image of extended emission to add to the sky model.
+ *
+ * @details
+ * Visibilities of the model image are predicted using the imager
+ * (see oskar_imager_predict()) and added to the cross-correlations of the
+ * sky model, without converting the image to point sources.
+ *
+ * The image gives the apparent brightness: station beams, gains and
+ * other direction-dependent effects are not applied to it.
+ * Only Stokes I is used, and visibilities are not smeared.
+ *
+ * Pass NULL or an empty string as the filename to disable the model image.
+ *
+ * @param[in] h                 Handle to simulator.
+ * @param[in] filename          Path to FITS image file.
+ * @param[in] algorithm         Prediction algorithm, as for the imager.
+ * @param[in] default_map_units Units to use if none are given in the file.
+ * @param[in] override_units    If set, use the default units regardless.
+ * @param[in] spectral_index    Spectral index of the image.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_model_image(oskar_Interferometer* h,
+        const char* filename, const char* algorithm,
+        const char* default_map_units, int override_units,
+        double spectral_index);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
@@ -88,6 +230,10 @@ OSKAR_EXPORT
 void oskar_interferometer_set_observation_time(oskar_Interferometer* h,
         double time_start_mjd_utc, double inc_sec, int num_time_steps);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_output_bda_vis_file(oskar_Interferometer* h,
+        const char* filename);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_output_measurement_set(oskar_Interferometer* h,
         const char* filename);
@@ -112,6 +258,9 @@ OSKAR_EXPORT
 void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
         double min_jy, double max_jy);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_use_mpi(oskar_Interferometer* h, int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value);
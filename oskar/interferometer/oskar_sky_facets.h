@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_FACETS_H_
+#define OSKAR_SKY_FACETS_H_
+
+/**
+ * @file oskar_sky_facets.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <mem/oskar_mem.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_SkyFacets;
+#ifndef OSKAR_SKY_FACETS_TYPEDEF_
+#define OSKAR_SKY_FACETS_TYPEDEF_
+typedef struct oskar_SkyFacets oskar_SkyFacets;
+#endif /* OSKAR_SKY_FACETS_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates an empty set of sky facets.
+ *
+ * @details
+ * Sky facets are used to predict visibilities of a large sky model
+ * by FFT and degridding, as an alternative to the direct sum over
+ * sources done by oskar_cross_correlate().
+ *
+ * @param[in] precision    Enumerated precision (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in,out] status   Status return code.
+ *
+ * @return A handle to the facets.
+ */
+OSKAR_EXPORT
+oskar_SkyFacets* oskar_sky_facets_create(int precision, int* status);
+
+/**
+ * @brief
+ * Divides a sky model into facets.
+ *
+ * @details
+ * The sources are divided into square facets of side \p facet_size_rad
+ * in the direction cosines (l, m) relative to the phase centre, which
+ * must already have been evaluated in the sky model. Empty facets are
+ * discarded. The centre of each facet is the centre of the bounding box
+ * of its sources.
+ *
+ * Each facet has a model image with pixels of size \p cell_size_rad,
+ * which is padded by a factor of two and transformed to give a grid
+ * from which visibilities are degridded. Space is made for
+ * \p num_slots sets of grids, so that the grids for several frequencies
+ * can be kept: call oskar_sky_facets_update() to fill each one.
+ *
+ * Any previous contents are replaced. The sky model must be in CPU memory.
+ *
+ * @param[in,out] facets       Handle to the facets.
+ * @param[in] sky              Sky model, with relative directions evaluated.
+ * @param[in] facet_size_rad   Side length of each facet, in radians.
+ * @param[in] cell_size_rad    Model image pixel size, in radians.
+ * @param[in] polarised        If set, grid all four Stokes parameters;
+ *                             otherwise, grid Stokes I only.
+ * @param[in] num_slots        Number of sets of grids to hold.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_facets_set_up(oskar_SkyFacets* facets, const oskar_Sky* sky,
+        double facet_size_rad, double cell_size_rad, int polarised,
+        int num_slots, int* status);
+
+/**
+ * @brief
+ * Makes the facet grids from the current source fluxes.
+ *
+ * @details
+ * The fluxes of each source are spread onto the model image of its facet
+ * using cubic interpolation weights, then each model image is corrected
+ * for the degridding kernel and transformed using an FFT.
+ *
+ * The sky model must contain the same sources, in the same order,
+ * as that used for oskar_sky_facets_set_up(), although the fluxes may
+ * have been scaled to a different frequency. As in oskar_evaluate_jones_K(),
+ * only sources with Stokes I greater than \p source_min_jy and not greater
+ * than \p source_max_jy are included.
+ *
+ * @param[in,out] facets      Handle to the facets.
+ * @param[in] sky             Sky model.
+ * @param[in] slot            Index of the set of grids to fill.
+ * @param[in] source_min_jy   Minimum source flux density, in Jy.
+ * @param[in] source_max_jy   Maximum source flux density, in Jy.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_facets_update(oskar_SkyFacets* facets, const oskar_Sky* sky,
+        int slot, double source_min_jy, double source_max_jy, int* status);
+
+/**
+ * @brief
+ * Returns the number of facets.
+ */
+OSKAR_EXPORT
+int oskar_sky_facets_num_facets(const oskar_SkyFacets* facets);
+
+/**
+ * @brief
+ * Returns the size of each facet grid.
+ */
+OSKAR_EXPORT
+int oskar_sky_facets_grid_size(const oskar_SkyFacets* facets);
+
+/**
+ * @brief
+ * Returns the direction cosines of the facet centres.
+ *
+ * @param[in] facets  Handle to the facets.
+ * @param[in] dim     Dimension index (0, 1 or 2 for l, m or n).
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_facets_lmn_const(const oskar_SkyFacets* facets,
+        int dim);
+
+/**
+ * @brief
+ * Returns the Right Ascension of the facet centres, in radians.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_facets_ra_rad_const(const oskar_SkyFacets* facets);
+
+/**
+ * @brief
+ * Returns the Declination of the facet centres, in radians.
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_facets_dec_rad_const(const oskar_SkyFacets* facets);
+
+/**
+ * @brief
+ * Returns the summed Stokes parameters of each facet.
+ *
+ * @details
+ * The values are those used for the last call to oskar_sky_facets_update()
+ * for the given slot.
+ *
+ * @param[in] facets  Handle to the facets.
+ * @param[in] slot    Index of the set of grids.
+ * @param[in] stokes  Stokes parameter index (0 to 3 for I, Q, U, V).
+ */
+OSKAR_EXPORT
+const oskar_Mem* oskar_sky_facets_stokes_const(const oskar_SkyFacets* facets,
+        int slot, int stokes);
+
+/**
+ * @brief
+ * Predicts cross-correlations by degridding the facet grids.
+ *
+ * @details
+ * The visibility on each baseline is the sum over facets of
+ * J_p S J_q^H, where J_p and J_q are the Jones matrices at the
+ * facet centre (which must include the interferometer phase of the
+ * centre), and S is the brightness matrix of the facet degridded
+ * at the baseline (u, v) coordinates, corrected to first order
+ * for the w-term across the facet. Bandwidth and time-average smearing
+ * are evaluated at the facet centre.
+ *
+ * A bound on the error of each visibility is the sum over facets of
+ * |J_p| |J_q| S_f (e_pix + min(2, 2 pi |w| r_w) + e_kernel), where
+ * S_f is the sum of the norms of the brightness matrices in the facet,
+ * e_pix = e_u + e_v + e_u e_v with e_u = 0.0234 (2 pi |u| dl)^4
+ * is the bound on the error of cubic interpolation onto pixels of size dl,
+ * r_w is the largest second-order w-term residual of any source in
+ * the facet, and e_kernel = 0.003 is the measured error of the spheroidal
+ * degridding kernel with two-fold padding. The station beam is assumed
+ * to be constant across each facet. The largest bound for any visibility
+ * is written to \p max_error_bound, if it is larger.
+ *
+ * All data must be in CPU memory.
+ *
+ * @param[in,out] facets        Handle to the facets.
+ * @param[in] slot              Index of the set of grids to use.
+ * @param[in] jones             Jones matrices at the facet centres.
+ * @param[in] tel               Telescope model.
+ * @param[in] station_uvw[3]    Station (u, v, w) coordinates, in metres.
+ * @param[in] gast              Greenwich apparent sidereal time, in radians.
+ * @param[in] frequency_hz      Current observation frequency, in Hz.
+ * @param[in] ignore_w_components If set, ignore the w-term.
+ * @param[in] offset_out        Output visibility start offset.
+ * @param[in,out] vis           Output visibility amplitudes.
+ * @param[in,out] max_error_bound Largest error bound of any visibility.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_facets_predict(oskar_SkyFacets* facets, int slot,
+        const oskar_Jones* jones, const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3], double gast,
+        double frequency_hz, int ignore_w_components, int offset_out,
+        oskar_Mem* vis, double* max_error_bound, int* status);
+
+/**
+ * @brief
+ * Frees memory held by the facets.
+ */
+OSKAR_EXPORT
+void oskar_sky_facets_free(oskar_SkyFacets* facets, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_BEAM_TABLE_H_
+#define OSKAR_PRIVATE_BEAM_TABLE_H_
+
+#include <mem/oskar_mem.h>
+#include <utility/oskar_file_map.h>
+#include <stddef.h>
+
+/* Values of the per-table flags. */
+enum OSKAR_BEAM_TABLE_FLAG
+{
+    OSKAR_BEAM_TABLE_EMPTY = 0,
+    OSKAR_BEAM_TABLE_INTERPOLATE = 1,
+    OSKAR_BEAM_TABLE_DIRECT = 2
+};
+
+/* Header at the start of the table storage (padded to 64 bytes). */
+struct oskar_BeamTableHeader
+{
+    char magic[8];
+    int version, type, grid_size, num_tables, num_channels, num_epochs;
+    unsigned int key;          /* Checksum of the inputs to the tables. */
+    int complete;              /* Set when all tables have been checked. */
+};
+typedef struct oskar_BeamTableHeader oskar_BeamTableHeader;
+
+struct oskar_BeamTable
+{
+    int type;                  /* Complex (matrix) type of the beam. */
+    int grid_size;             /* Grid points along each axis. */
+    int num_comp;              /* Real values per grid point. */
+    int num_tables;            /* Number of stations with distinct beams. */
+    int num_stations;
+    int num_channels, num_epochs, epoch_time_steps;
+    int duplicate_first;       /* If set, station 0 is used for all. */
+    int* station_table;        /* Table index of each station. */
+    int* table_station;        /* First station using each table. */
+    int num_rejected;          /* Tables failing the accuracy check. */
+    double measured_error;     /* Largest error of tables in use. */
+    size_t table_bytes;        /* Size of each table. */
+    oskar_BeamTableHeader* header; /* Start of table storage. */
+    unsigned char* flags;      /* Flag for each table. */
+    char* data;                /* Start of table data. */
+    char* buffer;              /* Owned memory, if not using a file. */
+    oskar_FileMap* map;        /* Mapped file, if used. */
+};
+
+#ifndef OSKAR_BEAM_TABLE_TYPEDEF_
+#define OSKAR_BEAM_TABLE_TYPEDEF_
+typedef struct oskar_BeamTable oskar_BeamTable;
+#endif /* OSKAR_BEAM_TABLE_TYPEDEF_ */
+
+/* Returns the index of the table for the given epoch, channel and table. */
+#define OSKAR_BEAM_TABLE_INDEX(T, EPOCH, CHANNEL, TABLE) \
+    (((size_t)(EPOCH) * (T)->num_channels + (CHANNEL)) * (T)->num_tables + \
+            (TABLE))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Interpolates beam values from one table, held in a real-valued array. */
+void oskar_beam_table_interp(int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, int grid_size, int num_comp,
+        const oskar_Mem* table, int offset_out, oskar_Mem* beam, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -7,7 +7,11 @@
 #define OSKAR_PRIVATE_INTERFEROMETER_H_
 
 #include <binary/oskar_binary.h>
+#include <correlate/oskar_source_tree.h>
+#include <imager/oskar_imager.h>
+#include <interferometer/oskar_beam_table.h>
 #include <interferometer/oskar_jones.h>
+#include <interferometer/oskar_sky_facets.h>
 #include <log/oskar_log.h>
 #include <mem/oskar_mem.h>
 #include <ms/oskar_measurement_set.h>
@@ -15,6 +19,7 @@
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_thread.h>
 #include <utility/oskar_timer.h>
+#include <vis/oskar_vis_bda.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 
@@ -22,7 +27,10 @@
 struct DeviceData
 {
     /* Host memory. */
-    oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
+    /* On host, for copy back & write.
+     * When partitioning work by time, only device 0 has these, and all
+     * devices copy their time samples into them. */
+    oskar_VisBlock* vis_block_cpu[2];
 
     /* Device memory. */
     int previous_chunk_index;
@@ -34,6 +42,46 @@ struct DeviceData
     oskar_Jones *J, *R, *E, *K;
     oskar_Mem *gains;
     oskar_StationWork* station_work;
+    oskar_Mem* beam_table_buffer; /* Device copy of a beam table. */
+    int beam_table_buffer_index;
+
+    /* Buffers in which small chunks are merged, one per time in the block,
+     * if using adaptive chunks. */
+    oskar_Sky** merge;
+    int num_merge;
+    int merge_min_sources;      /* Chunks smaller than this are merged. */
+    int fit_count;              /* Samples of kernel time against size. */
+    double fit_n, fit_t, fit_nn, fit_nt;
+
+    /* Source tree for level-of-detail correlation, if used. */
+    oskar_SourceTree* source_tree;
+    int use_source_tree;        /* Set if the tree matches the current sky. */
+    double lod_terms, lod_terms_exact, lod_error_max;
+
+    /* Facets for predicting large chunks, if used. */
+    oskar_SkyFacets* facets;
+    int facet_chunk_index;      /* Sky chunk from which facets were made. */
+    int* facet_channel;         /* Channel of the grids in each slot. */
+    oskar_Mem* facet_mask;      /* Horizon mask used to make the facets. */
+    int facet_beam_key;         /* Key of station beams for the facets. */
+    double facet_work_units, facet_error_max;
+
+    /* Sources for which station beams are cached for interpolation,
+     * in a slot for each sky chunk, or in one slot shared by all chunks. */
+    int beam_interp_num_slots, beam_interp_next_key;
+    int* beam_interp_chunk;     /* Sky chunk in each slot, or -1 if none. */
+    int* beam_interp_key;       /* Key of cached beams in each slot. */
+    int* beam_interp_num_clip;  /* Sources above horizon in each slot. */
+    oskar_Mem** beam_interp_mask; /* Horizon mask in each slot, on host. */
+    oskar_Mem* beam_interp_mask_host; /* Current horizon mask, if on GPU. */
+
+    /* Choice of direct scalar correlation, made by timing both methods. */
+    int direct_xcorr;           /* 1 direct, 0 Jones chain, -1 undecided. */
+    int direct_samples[2];      /* Timing samples for each method. */
+    double direct_time[2];      /* Kernel time per source for each method. */
+
+    /* Buffers for visibilities predicted from a model image, if used. */
+    oskar_Mem *model_station_uvw[3], *model_uvw[3], *model_vis, *model_block;
 
     /* Timers. */
     oskar_Timer* tmr_compute;   /* Total time spent filling vis blocks. */
@@ -51,16 +99,36 @@ struct oskar_Interferometer
 {
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
+    int num_cpu_threads; /* OpenMP threads used by each CPU device. */
     int num_channels, num_time_steps;
     int max_sources_per_chunk, max_times_per_block, max_channels_per_block;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
-    int coords_only, ignore_w_components;
+    int coords_only, ignore_w_components, use_mpi, fuse_jones;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
-    char correlation_type, *vis_name, *ms_name, *settings_path;
+    double bda_max_fact, bda_fov_deg, bda_max_time_avg_sec;
+    int bda_max_chans_avg;
+    int beam_table_enabled, beam_table_grid_size, beam_table_epoch_time_steps;
+    double beam_table_max_error;
+    int beam_interp_enabled, beam_interp_time_step, beam_interp_all_chunks;
+    double beam_interp_max_error;
+    int adaptive_chunks;
+    double adaptive_chunks_memory_mb;
+    int lod_enabled;
+    double lod_tolerance_jy;
+    int facet_enabled, facet_min_sources;
+    double facet_size_rad, facet_pixel_oversample, facet_cell_size_rad;
+    int model_image_override_units;
+    double model_image_spectral_index;
+    char *model_image_file, *model_image_algorithm, *model_image_units;
+    char correlation_type, device_partition, direct_correlation;
+    char *vis_name, *ms_name, *bda_name, *beam_table_name, *settings_path;
 
     /* State. */
     int init_sky, work_unit_index;
+    int partition_by_time; /* Set if devices own disjoint time ranges. */
+    int isotropic_stations; /* Set if all stations are isotropic. */
+    int num_procs, proc_id; /* Processes sharing blocks, and index of this. */
     oskar_Mutex* mutex;
     oskar_Barrier* barrier;
     oskar_Log* log;
@@ -68,12 +136,21 @@ struct oskar_Interferometer
     /* Sky model and telescope model. */
     int num_sources_total, num_sky_chunks;
     oskar_Sky** sky_chunks;
+    oskar_SkyIndex** sky_chunk_index; /* For horizon clip on CPU devices. */
     oskar_Telescope* tel;
+    oskar_BeamTable* beam_table; /* Tabulated station beams, if used. */
+    oskar_Imager* model_imager; /* Predicts visibilities from model image. */
+    double model_image_freq_hz; /* Frequency of the model image. */
 
     /* Output data and file handles. */
     oskar_VisHeader* header;
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
+    oskar_Binary* bda_file;
+    oskar_VisBDA* bda;
+    oskar_VisBlock* vis_block_recv; /* Block from another process. */
+    oskar_Imager** imagers; /* Not owned: images blocks as they finish. */
+    int num_imagers;
     oskar_Mem *temp;
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
     oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_SKY_FACETS_H_
+#define OSKAR_PRIVATE_SKY_FACETS_H_
+
+#include <math/oskar_fft.h>
+#include <mem/oskar_mem.h>
+
+/* Degridding kernel parameters. */
+#define OSKAR_SKY_FACETS_SUPPORT 3
+#define OSKAR_SKY_FACETS_OVERSAMPLE 1000
+
+struct oskar_SkyFacets
+{
+    int precision, polarised, num_sources, num_facets, num_slots, num_grids;
+    int grid_size;        /* Side length of each (padded) facet grid. */
+    double cell_size_rad; /* Model image pixel size. */
+
+    /* Division of sources into facets. */
+    int* facet_start;     /* Facet f has sources facet_start[f] to [f + 1]. */
+    int* order;           /* Original index of each source, in facet order. */
+    double* pixel;        /* Model image (x, y) pixel of each source. */
+    double* w_residual;   /* Largest second-order w-term of each facet. */
+
+    /* Facet centres. */
+    oskar_Mem *lmn[3], *ra_rad, *dec_rad;
+
+    /* For each slot: summed Stokes parameters, brightness norms and grids. */
+    oskar_Mem** stokes;   /* Indexed as [slot * 4 + stokes]. */
+    double* flux_norm;    /* Indexed as [slot * num_facets + facet]. */
+    oskar_Mem* grids;     /* Indexed as [slot][facet][grid][v][u]. */
+
+    /* Gridding functions, FFT plan and work arrays. */
+    oskar_Mem *conv_func, *corr_func, *plane;
+    oskar_FFT* fft;
+    oskar_Mem *uu, *vv, *degridded[4], *sum;
+    double* bound;
+    size_t capacity_bound;
+};
+
+#ifndef OSKAR_SKY_FACETS_TYPEDEF_
+#define OSKAR_SKY_FACETS_TYPEDEF_
+typedef struct oskar_SkyFacets oskar_SkyFacets;
+#endif /* OSKAR_SKY_FACETS_TYPEDEF_ */
+
+#endif /* include guard */
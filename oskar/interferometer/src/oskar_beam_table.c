@@ -0,0 +1,597 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/oskar_beam_table.h"
+#include "interferometer/private_beam_table.h"
+#include "binary/oskar_crc.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_file_exists.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEADER_BYTES 64
+#define NUM_PROBES 256
+
+static const char table_magic[8] = {'O', 'S', 'K', 'A', 'R', 'B', 'T', 0};
+static const int table_version = 2;
+
+/* Inputs and results for one thread evaluating and checking tables. */
+struct BuildArgs
+{
+    oskar_BeamTable* t;
+    const oskar_Telescope* tel;
+    const oskar_Mem* grid[3];
+    const oskar_Mem* probe[3];
+    double max_error, time_start_mjd_utc, time_inc_sec;
+    double freq_start_hz, freq_inc_hz;
+    int num_time_steps, reused, thread_id, num_threads;
+    int stale, num_rejected, status;
+    double measured_error;
+};
+typedef struct BuildArgs BuildArgs;
+
+static void* build_tables(void* arg);
+static void set_station_tables(oskar_BeamTable* t, const oskar_Telescope* tel,
+        int* status);
+static unsigned int table_key(const oskar_BeamTable* t,
+        const oskar_Telescope* tel, const double obs[5], double max_error,
+        int* status);
+static int open_file(oskar_BeamTable* t, const char* filename,
+        size_t num_bytes, unsigned int key, int* status);
+static void create_storage(oskar_BeamTable* t, const char* filename,
+        size_t num_bytes, unsigned int key, oskar_Log* log, int* status);
+static void set_grid_directions(oskar_Mem* const dir[3], int grid_size,
+        int* status);
+static void set_probe_directions(oskar_Mem* const dir[3], int* status);
+static double max_abs(const oskar_Mem* data, const oskar_Mem* z,
+        int num_comp, int* status);
+static double max_diff(const oskar_Mem* a, const oskar_Mem* b,
+        size_t num_values, int* status);
+
+
+oskar_BeamTable* oskar_beam_table_create(const oskar_Telescope* tel,
+        int grid_size, int epoch_time_steps, double max_error,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps,
+        double freq_start_hz, double freq_inc_hz, int num_channels,
+        const char* filename, oskar_Log* log, int* status)
+{
+    int i, pass, num_threads, reused = 0;
+    oskar_BeamTable* t = 0;
+    oskar_Mem *grid[3], *probe[3];
+    BuildArgs* args = 0;
+    oskar_Thread** threads = 0;
+    if (*status) return 0;
+    if (!tel || grid_size < 8 || epoch_time_steps < 1 ||
+            num_time_steps < 1 || num_channels < 1 ||
+            oskar_telescope_num_stations(tel) < 1)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    if (oskar_telescope_ionosphere_screen_type(tel) == 'E')
+    {
+        oskar_log_error(log, "Tabulated station beams cannot be used "
+                "with an ionospheric screen.");
+        *status = OSKAR_ERR_SETTINGS_TELESCOPE;
+        return 0;
+    }
+
+    /* Set table dimensions. */
+    const int prec = oskar_telescope_precision(tel);
+    t = (oskar_BeamTable*) calloc(1, sizeof(oskar_BeamTable));
+    t->type = prec | OSKAR_COMPLEX;
+    if (oskar_telescope_pol_mode(tel) == OSKAR_POL_MODE_FULL)
+        t->type |= OSKAR_MATRIX;
+    t->num_comp = oskar_type_is_matrix(t->type) ? 8 : 2;
+    t->grid_size = grid_size;
+    t->num_channels = num_channels;
+    t->epoch_time_steps = epoch_time_steps;
+    t->num_epochs = (num_time_steps + epoch_time_steps - 1) / epoch_time_steps;
+    set_station_tables(t, tel, status);
+    const size_t num_points = (size_t)grid_size * grid_size;
+    const size_t num_tables_total = OSKAR_BEAM_TABLE_INDEX(t,
+            t->num_epochs, 0, 0);
+    const size_t flag_bytes = ((num_tables_total + 63) / 64) * 64;
+    t->table_bytes = num_points * t->num_comp * oskar_mem_element_size(prec);
+    const size_t num_bytes = HEADER_BYTES + flag_bytes +
+            num_tables_total * t->table_bytes;
+
+    /* Reuse an existing file if it matches, otherwise create storage. */
+    const double obs[] = {time_start_mjd_utc, time_inc_sec,
+            (double) num_time_steps, freq_start_hz, freq_inc_hz};
+    const unsigned int key = table_key(t, tel, obs, max_error, status);
+    if (filename && strlen(filename) > 0)
+        reused = open_file(t, filename, num_bytes, key, status);
+    if (!reused)
+        create_storage(t, filename, num_bytes, key, log, status);
+    if (*status)
+    {
+        oskar_beam_table_free(t);
+        return 0;
+    }
+
+    /* The tables are independent, so share them out between threads. */
+    num_threads = oskar_get_num_procs();
+    if (num_threads > (int) num_tables_total)
+        num_threads = (int) num_tables_total;
+    if (num_threads < 1) num_threads = 1;
+    oskar_log_message(log, 'M', 0, "%s %d station beam table(s) of %d x %d "
+            "points (%.1f MB) using %d thread(s).",
+            reused ? "Checking" : "Evaluating",
+            (int) num_tables_total, grid_size, grid_size,
+            num_bytes / (1024.0 * 1024.0), num_threads);
+
+    /* Create grid and probe directions. */
+    for (i = 0; i < 3; ++i)
+    {
+        grid[i] = oskar_mem_create(prec, OSKAR_CPU, num_points, status);
+        probe[i] = oskar_mem_create(prec, OSKAR_CPU, NUM_PROBES, status);
+    }
+    set_grid_directions(grid, grid_size, status);
+    set_probe_directions(probe, status);
+    args = (BuildArgs*) calloc(num_threads, sizeof(BuildArgs));
+    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+    for (i = 0; i < num_threads; ++i)
+    {
+        int j;
+        for (j = 0; j < 3; ++j)
+        {
+            args[i].grid[j] = grid[j];
+            args[i].probe[j] = probe[j];
+        }
+        args[i].t = t;
+        args[i].tel = tel;
+        args[i].max_error = max_error;
+        args[i].time_start_mjd_utc = time_start_mjd_utc;
+        args[i].time_inc_sec = time_inc_sec;
+        args[i].freq_start_hz = freq_start_hz;
+        args[i].freq_inc_hz = freq_inc_hz;
+        args[i].num_time_steps = num_time_steps;
+        args[i].thread_id = i;
+        args[i].num_threads = num_threads;
+    }
+
+    /* Evaluate each table (unless reused), and check it against direct
+     * evaluation of the beam. If a reused file fails the check,
+     * it is out of date, so evaluate all the tables again. */
+    for (pass = 0; pass < 2 && !*status; ++pass)
+    {
+        int stale = 0;
+        for (i = 0; i < num_threads; ++i)
+        {
+            args[i].reused = reused;
+            threads[i] = oskar_thread_create(build_tables, &args[i], 0);
+        }
+        t->num_rejected = 0;
+        t->measured_error = 0.0;
+        for (i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+            if (args[i].status && !*status) *status = args[i].status;
+            if (args[i].stale) stale = 1;
+            t->num_rejected += args[i].num_rejected;
+            if (args[i].measured_error > t->measured_error)
+                t->measured_error = args[i].measured_error;
+        }
+        if (!stale) break;
+        oskar_log_message(log, 'M', 0, "Station beam table file is out of "
+                "date. Evaluating tables again.");
+        t->header->complete = 0;
+        reused = 0;
+    }
+
+    /* Mark the file as complete. */
+    if (!*status)
+    {
+        t->header->complete = 1;
+        if (t->map) oskar_file_map_sync(t->map, status);
+        oskar_log_message(log, 'M', 1, "Largest interpolation error "
+                "relative to beam peak: %.3e", t->measured_error);
+        if (t->num_rejected > 0)
+            oskar_log_warning(log, "%d table(s) exceed the error tolerance "
+                    "of %.3e: these beams will be evaluated directly.",
+                    t->num_rejected, max_error);
+    }
+
+    /* Clean up. */
+    for (i = 0; i < 3; ++i)
+    {
+        oskar_mem_free(grid[i], status);
+        oskar_mem_free(probe[i], status);
+    }
+    free(args);
+    free(threads);
+    if (*status)
+    {
+        oskar_beam_table_free(t);
+        t = 0;
+    }
+    return t;
+}
+
+
+/* Evaluates (unless reused) and checks every table assigned to a thread. */
+static void* build_tables(void* arg)
+{
+    size_t k;
+    int i;
+    BuildArgs* a = (BuildArgs*) arg;
+    oskar_BeamTable* t = a->t;
+    int* status = &a->status;
+    const int prec = oskar_type_precision(t->type);
+    const size_t num_points = (size_t)t->grid_size * t->grid_size;
+    const size_t num_tables_total = OSKAR_BEAM_TABLE_INDEX(t,
+            t->num_epochs, 0, 0);
+    const int norm_coord_type =
+            oskar_telescope_phase_centre_coord_type(a->tel);
+    const double norm_lon_rad =
+            oskar_telescope_phase_centre_longitude_rad(a->tel);
+    const double norm_lat_rad =
+            oskar_telescope_phase_centre_latitude_rad(a->tel);
+    const double dt_dump_days = a->time_inc_sec / 86400.0;
+    a->stale = a->num_rejected = 0;
+    a->measured_error = 0.0;
+    oskar_StationWork* work = oskar_station_work_create(prec,
+            OSKAR_CPU, status);
+    oskar_Mem* direct = oskar_mem_create(t->type, OSKAR_CPU,
+            NUM_PROBES, status);
+    oskar_Mem* interp = oskar_mem_create(t->type, OSKAR_CPU,
+            NUM_PROBES, status);
+    for (k = a->thread_id; k < num_tables_total && !a->stale && !*status;
+            k += a->num_threads)
+    {
+        int time_index[3];
+        double error = 0.0;
+        const int u = (int) (k % t->num_tables);
+        const int c = (int) ((k / t->num_tables) % t->num_channels);
+        const int e = (int) (k / ((size_t)t->num_tables * t->num_channels));
+        const double freq_hz = a->freq_start_hz + c * a->freq_inc_hz;
+        const oskar_Station* station = oskar_telescope_station_const(a->tel,
+                t->table_station[u]);
+        char* ptr = t->data + k * t->table_bytes;
+
+        /* The table is made at the middle of the epoch, and it is
+         * checked at the middle, and at the first and last time steps. */
+        time_index[0] = e * t->epoch_time_steps + t->epoch_time_steps / 2;
+        time_index[1] = e * t->epoch_time_steps;
+        time_index[2] = (e + 1) * t->epoch_time_steps - 1;
+        for (i = 0; i < 3; ++i)
+        {
+            if (time_index[i] >= a->num_time_steps)
+                time_index[i] = a->num_time_steps - 1;
+        }
+        oskar_Mem* table = oskar_mem_create_alias_from_raw(ptr,
+                prec, OSKAR_CPU, num_points * t->num_comp, status);
+        if (!a->reused)
+        {
+            const double gast_rad = oskar_convert_mjd_to_gast_fast(
+                    a->time_start_mjd_utc +
+                    dt_dump_days * (time_index[0] + 0.5));
+            oskar_Mem* beam = oskar_mem_create_alias_from_raw(
+                    ptr, t->type, OSKAR_CPU, num_points, status);
+            oskar_station_beam(station, work, OSKAR_COORDS_ENU_DIR,
+                    (int) num_points, a->grid, 0.0, 0.0, norm_coord_type,
+                    norm_lon_rad, norm_lat_rad, time_index[0],
+                    gast_rad, freq_hz, 0, beam, status);
+            oskar_mem_free(beam, status);
+        }
+
+        /* Compare against direct evaluation. */
+        oskar_beam_table_interp(NUM_PROBES, a->probe[0], a->probe[1],
+                a->probe[2], t->grid_size, t->num_comp, table, 0,
+                interp, status);
+        for (i = 0; i < 3; ++i)
+        {
+            if (i > 0 && time_index[i] == time_index[0]) continue;
+            if (i > 1 && time_index[i] == time_index[1]) continue;
+            const double gast_rad = oskar_convert_mjd_to_gast_fast(
+                    a->time_start_mjd_utc +
+                    dt_dump_days * (time_index[i] + 0.5));
+            oskar_station_beam(station, work, OSKAR_COORDS_ENU_DIR,
+                    NUM_PROBES, a->probe, 0.0, 0.0, norm_coord_type,
+                    norm_lon_rad, norm_lat_rad, time_index[i],
+                    gast_rad, freq_hz, 0, direct, status);
+            const double diff = max_diff(interp, direct,
+                    NUM_PROBES * (size_t)t->num_comp, status);
+            if (diff > error) error = diff;
+        }
+        const double peak = max_abs(table, a->grid[2], t->num_comp, status);
+        if (peak > 0.0) error /= peak;
+        oskar_mem_free(table, status);
+        if (*status) break;
+        if (error <= a->max_error)
+        {
+            if (a->reused && t->flags[k] != OSKAR_BEAM_TABLE_INTERPOLATE)
+                a->stale = 1;
+            t->flags[k] = OSKAR_BEAM_TABLE_INTERPOLATE;
+            if (error > a->measured_error) a->measured_error = error;
+        }
+        else
+        {
+            if (a->reused && t->flags[k] != OSKAR_BEAM_TABLE_DIRECT)
+                a->stale = 1;
+            t->flags[k] = OSKAR_BEAM_TABLE_DIRECT;
+            a->num_rejected++;
+        }
+    }
+    oskar_mem_free(direct, status);
+    oskar_mem_free(interp, status);
+    oskar_station_work_free(work, status);
+    return 0;
+}
+
+
+double oskar_beam_table_measured_error(const oskar_BeamTable* table)
+{
+    return table ? table->measured_error : 0.0;
+}
+
+
+int oskar_beam_table_num_rejected(const oskar_BeamTable* table)
+{
+    return table ? table->num_rejected : 0;
+}
+
+
+void oskar_beam_table_free(oskar_BeamTable* table)
+{
+    if (!table) return;
+    oskar_file_map_free(table->map);
+    free(table->buffer);
+    free(table->station_table);
+    free(table->table_station);
+    free(table);
+}
+
+
+static void set_station_tables(oskar_BeamTable* t, const oskar_Telescope* tel,
+        int* status)
+{
+    int s, u;
+    t->num_stations = oskar_telescope_num_stations(tel);
+    t->station_table = (int*) calloc(t->num_stations, sizeof(int));
+    t->table_station = (int*) calloc(t->num_stations, sizeof(int));
+    t->duplicate_first = oskar_telescope_allow_station_beam_duplication(tel) &&
+            oskar_telescope_identical_stations(tel);
+    t->num_tables = 1;
+    if (t->duplicate_first) return;
+    for (s = 1; s < t->num_stations; ++s)
+    {
+        const oskar_Station* st = oskar_telescope_station_const(tel, s);
+        for (u = 0; u < t->num_tables; ++u)
+        {
+            const oskar_Station* first = oskar_telescope_station_const(tel,
+                    t->table_station[u]);
+            if (oskar_station_lon_rad(st) == oskar_station_lon_rad(first) &&
+                    oskar_station_lat_rad(st) == oskar_station_lat_rad(first) &&
+                    !oskar_station_different(first, st, status))
+                break;
+        }
+        if (u == t->num_tables)
+            t->table_station[t->num_tables++] = s;
+        t->station_table[s] = u;
+    }
+}
+
+
+static unsigned int table_key(const oskar_BeamTable* t,
+        const oskar_Telescope* tel, const double obs[5], double max_error,
+        int* status)
+{
+    int u;
+    unsigned long crc = 0;
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    const int ints[] = {table_version, t->type, t->grid_size,
+            t->num_tables, t->num_stations, t->num_channels,
+            t->num_epochs, t->epoch_time_steps, t->duplicate_first,
+            oskar_telescope_phase_centre_coord_type(tel)};
+    const double doubles[] = {obs[0], obs[1], obs[2], obs[3], obs[4],
+            max_error, oskar_telescope_phase_centre_longitude_rad(tel),
+            oskar_telescope_phase_centre_latitude_rad(tel)};
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = oskar_crc_update(crc_data, crc, doubles, sizeof(doubles));
+    crc = oskar_crc_update(crc_data, crc, t->station_table,
+            t->num_stations * sizeof(int));
+    oskar_crc_free(crc_data);
+
+    /* Include the complete model of each station with a table, so that
+     * any change to its layout, weights or element data is detected. */
+    for (u = 0; u < t->num_tables; ++u)
+    {
+        crc = oskar_station_checksum(oskar_telescope_station_const(tel,
+                t->table_station[u]), crc, status);
+    }
+    return (unsigned int) crc;
+}
+
+
+static void set_pointers(oskar_BeamTable* t, char* base, size_t flag_bytes)
+{
+    t->header = (oskar_BeamTableHeader*) base;
+    t->flags = (unsigned char*) (base + HEADER_BYTES);
+    t->data = base + HEADER_BYTES + flag_bytes;
+}
+
+
+static int open_file(oskar_BeamTable* t, const char* filename,
+        size_t num_bytes, unsigned int key, int* status)
+{
+    int tmp_status = 0;
+    oskar_BeamTableHeader header;
+    if (*status || !oskar_file_exists(filename)) return 0;
+    oskar_FileMap* map = oskar_file_map_open(filename, 1, &tmp_status);
+    if (tmp_status || oskar_file_map_size(map) != num_bytes)
+    {
+        oskar_file_map_free(map);
+        return 0;
+    }
+    char* base = (char*) oskar_file_map_data(map);
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, table_magic, sizeof(table_magic)) != 0 ||
+            header.version != table_version || header.type != t->type ||
+            header.grid_size != t->grid_size ||
+            header.num_tables != t->num_tables ||
+            header.num_channels != t->num_channels ||
+            header.num_epochs != t->num_epochs ||
+            header.key != key || header.complete != 1)
+    {
+        oskar_file_map_free(map);
+        return 0;
+    }
+    t->map = map;
+    set_pointers(t, base, num_bytes - HEADER_BYTES -
+            OSKAR_BEAM_TABLE_INDEX(t, t->num_epochs, 0, 0) * t->table_bytes);
+    return 1;
+}
+
+
+static void create_storage(oskar_BeamTable* t, const char* filename,
+        size_t num_bytes, unsigned int key, oskar_Log* log, int* status)
+{
+    char* base = 0;
+    oskar_BeamTableHeader header;
+    if (*status) return;
+    oskar_file_map_free(t->map);
+    t->map = 0;
+    if (filename && strlen(filename) > 0)
+    {
+        int tmp_status = 0;
+        t->map = oskar_file_map_create(filename, num_bytes, &tmp_status);
+        if (tmp_status)
+            oskar_log_warning(log, "Unable to create station beam table "
+                    "file '%s': tables will be held in memory.", filename);
+        else
+            base = (char*) oskar_file_map_data(t->map);
+    }
+    if (!base)
+    {
+        t->buffer = (char*) calloc(1, num_bytes);
+        if (!t->buffer)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        base = t->buffer;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, table_magic, sizeof(table_magic));
+    header.version = table_version;
+    header.type = t->type;
+    header.grid_size = t->grid_size;
+    header.num_tables = t->num_tables;
+    header.num_channels = t->num_channels;
+    header.num_epochs = t->num_epochs;
+    header.key = key;
+    header.complete = 0; /* Set when all tables are complete. */
+    memset(base, 0, HEADER_BYTES);
+    memcpy(base, &header, sizeof(header));
+    set_pointers(t, base, num_bytes - HEADER_BYTES -
+            OSKAR_BEAM_TABLE_INDEX(t, t->num_epochs, 0, 0) * t->table_bytes);
+}
+
+
+static void set_grid_directions(oskar_Mem* const dir[3], int grid_size,
+        int* status)
+{
+    int ix, iy;
+    const double inc = 2.0 / (grid_size - 3);
+    for (iy = 0; iy < grid_size; ++iy)
+    {
+        const double v = -1.0 + (iy - 1) * inc;
+        for (ix = 0; ix < grid_size; ++ix)
+        {
+            const double u = -1.0 + (ix - 1) * inc;
+            const double r2 = u * u + v * v, f = 1.0 / (1.0 + r2);
+            const size_t i = (size_t)iy * grid_size + ix;
+
+            /* Points outside the unit circle lie below the horizon, where
+             * the beam is blanked, so use the mirror image above it. */
+            oskar_mem_set_element_real(dir[0], i, 2.0 * u * f, status);
+            oskar_mem_set_element_real(dir[1], i, 2.0 * v * f, status);
+            oskar_mem_set_element_real(dir[2], i, fabs(1.0 - r2) * f, status);
+        }
+    }
+}
+
+
+static void set_probe_directions(oskar_Mem* const dir[3], int* status)
+{
+    int i;
+    const double golden_angle = M_PI * (3.0 - sqrt(5.0));
+
+    /* Points spread evenly over the hemisphere above the horizon. */
+    for (i = 0; i < NUM_PROBES; ++i)
+    {
+        const double z = 1.0 - (i + 0.5) / NUM_PROBES;
+        const double r = sqrt(1.0 - z * z), phi = i * golden_angle;
+        oskar_mem_set_element_real(dir[0], i, r * sin(phi), status);
+        oskar_mem_set_element_real(dir[1], i, r * cos(phi), status);
+        oskar_mem_set_element_real(dir[2], i, z, status);
+    }
+}
+
+
+/* Returns the largest complex magnitude at grid points above the horizon. */
+static double max_abs(const oskar_Mem* data, const oskar_Mem* z,
+        int num_comp, int* status)
+{
+    size_t i;
+    int c;
+    double val = 0.0;
+    const size_t num_points = oskar_mem_length(z);
+    for (i = 0; i < num_points; ++i)
+    {
+        if (oskar_mem_get_element(z, i, status) <= 0.0) continue;
+        for (c = 0; c < num_comp; c += 2)
+        {
+            const size_t k = i * num_comp + c;
+            const double re = oskar_mem_get_element(data, k, status);
+            const double im = oskar_mem_get_element(data, k + 1, status);
+            if (re * re + im * im > val) val = re * re + im * im;
+        }
+    }
+    return sqrt(val);
+}
+
+
+/* Returns the largest complex magnitude of the difference between arrays. */
+static double max_diff(const oskar_Mem* a, const oskar_Mem* b,
+        size_t num_values, int* status)
+{
+    size_t i;
+    double val = 0.0;
+    const void* pa = oskar_mem_void_const(a);
+    const void* pb = oskar_mem_void_const(b);
+    if (*status) return 0.0;
+    for (i = 0; i < num_values; i += 2)
+    {
+        double re, im;
+        if (oskar_mem_is_double(a))
+        {
+            re = ((const double*)pa)[i] - ((const double*)pb)[i];
+            im = ((const double*)pa)[i + 1] - ((const double*)pb)[i + 1];
+        }
+        else
+        {
+            re = ((const float*)pa)[i] - ((const float*)pb)[i];
+            im = ((const float*)pa)[i + 1] - ((const float*)pb)[i + 1];
+        }
+        if (re * re + im * im > val) val = re * re + im * im;
+    }
+    return sqrt(val);
+}
+
+#ifdef __cplusplus
+}
+#endif
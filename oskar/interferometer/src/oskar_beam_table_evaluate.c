@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/define_beam_table_interp.h"
+#include "interferometer/oskar_beam_table.h"
+#include "interferometer/private_beam_table.h"
+#include "interferometer/oskar_jones_accessors.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_BEAM_TABLE_INTERP(beam_table_interp_float, float)
+OSKAR_BEAM_TABLE_INTERP(beam_table_interp_double, double)
+
+void oskar_beam_table_interp(int num_points, const oskar_Mem* x,
+        const oskar_Mem* y, const oskar_Mem* z, int grid_size, int num_comp,
+        const oskar_Mem* table, int offset_out, oskar_Mem* beam, int* status)
+{
+    if (*status) return;
+    const int precision = oskar_mem_precision(beam);
+    const int location = oskar_mem_location(beam);
+    if (precision != oskar_mem_type(x) || precision != oskar_mem_type(y) ||
+            precision != oskar_mem_type(z) ||
+            precision != oskar_mem_type(table))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (location != oskar_mem_location(x) ||
+            location != oskar_mem_location(y) ||
+            location != oskar_mem_location(z) ||
+            location != oskar_mem_location(table))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (!oskar_mem_is_complex(beam) ||
+            num_comp != (oskar_mem_is_matrix(beam) ? 8 : 2))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (location == OSKAR_CPU)
+    {
+        if (precision == OSKAR_SINGLE)
+            beam_table_interp_float(num_points,
+                    oskar_mem_float_const(x, status),
+                    oskar_mem_float_const(y, status),
+                    oskar_mem_float_const(z, status),
+                    grid_size, num_comp,
+                    oskar_mem_float_const(table, status),
+                    offset_out, (float*) oskar_mem_void(beam));
+        else if (precision == OSKAR_DOUBLE)
+            beam_table_interp_double(num_points,
+                    oskar_mem_double_const(x, status),
+                    oskar_mem_double_const(y, status),
+                    oskar_mem_double_const(z, status),
+                    grid_size, num_comp,
+                    oskar_mem_double_const(table, status),
+                    offset_out, (double*) oskar_mem_void(beam));
+        else
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+    }
+    else
+    {
+        size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        const char* k = 0;
+        if (precision == OSKAR_SINGLE)
+            k = "beam_table_interp_float";
+        else if (precision == OSKAR_DOUBLE)
+            k = "beam_table_interp_double";
+        else
+        {
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_points, local_size[0]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_points},
+                {PTR_SZ, oskar_mem_buffer_const(x)},
+                {PTR_SZ, oskar_mem_buffer_const(y)},
+                {PTR_SZ, oskar_mem_buffer_const(z)},
+                {INT_SZ, &grid_size},
+                {INT_SZ, &num_comp},
+                {PTR_SZ, oskar_mem_buffer_const(table)},
+                {INT_SZ, &offset_out},
+                {PTR_SZ, oskar_mem_buffer(beam)}
+        };
+        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+
+void oskar_beam_table_evaluate(const oskar_BeamTable* table, oskar_Jones* E,
+        int num_points, const oskar_Mem* const source_coords[3],
+        double ref_lon_rad, double ref_lat_rad, const oskar_Telescope* tel,
+        int time_index, double gast_rad, int channel_index,
+        double frequency_hz, oskar_StationWork* work,
+        oskar_Mem* table_buffer, int* table_buffer_index, int* status)
+{
+    int i, have_enu = 0;
+    double enu_lon_rad = 0.0, enu_lat_rad = 0.0;
+    oskar_Mem *enu[3], *beam, *data = 0;
+    if (*status) return;
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const int num_sources = oskar_jones_num_sources(E);
+    const int n = table->duplicate_first ? 1 : num_stations;
+    const int location = oskar_jones_mem_location(E);
+    const int precision = oskar_type_precision(table->type);
+    const int epoch = time_index / table->epoch_time_steps;
+    const size_t num_values = (size_t)table->grid_size * table->grid_size *
+            table->num_comp;
+    if (num_stations != table->num_stations ||
+            num_stations != oskar_jones_num_stations(E))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (epoch < 0 || epoch >= table->num_epochs ||
+            channel_index < 0 || channel_index >= table->num_channels)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    beam = oskar_jones_mem(E);
+    if (oskar_mem_type(beam) != table->type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Evaluate the station beam(s). */
+    for (i = 0; i < n && !*status; ++i)
+    {
+        const oskar_Station* station = oskar_telescope_station_const(tel, i);
+        const int k = (int) OSKAR_BEAM_TABLE_INDEX(table, epoch,
+                channel_index, table->station_table[i]);
+        if (table->flags[k] != OSKAR_BEAM_TABLE_INTERPOLATE)
+        {
+            /* Table failed the accuracy check, so evaluate directly.
+             * This overwrites the direction arrays in the workspace. */
+            oskar_station_beam(station, work, OSKAR_COORDS_REL_DIR,
+                    num_points, source_coords, ref_lon_rad, ref_lat_rad,
+                    oskar_telescope_phase_centre_coord_type(tel),
+                    oskar_telescope_phase_centre_longitude_rad(tel),
+                    oskar_telescope_phase_centre_latitude_rad(tel),
+                    time_index, gast_rad, frequency_hz,
+                    i * num_sources, beam, status);
+            have_enu = 0;
+            continue;
+        }
+
+        /* Get source ENU directions, if not already known here. */
+        const double lon_rad = oskar_station_lon_rad(station);
+        const double lat_rad = oskar_station_lat_rad(station);
+        if (!have_enu || lon_rad != enu_lon_rad || lat_rad != enu_lat_rad)
+        {
+            int dim;
+            for (dim = 0; dim < 3; ++dim)
+                enu[dim] = oskar_station_work_lmn_direction(
+                        work, dim, num_points, status);
+            oskar_convert_relative_directions_to_enu_directions(0, 0, 0,
+                    num_points, source_coords[0], source_coords[1],
+                    source_coords[2], gast_rad + lon_rad - ref_lon_rad,
+                    ref_lat_rad, lat_rad, 0, enu[0], enu[1], enu[2], status);
+            enu_lon_rad = lon_rad;
+            enu_lat_rad = lat_rad;
+            have_enu = 1;
+        }
+
+        /* Get the table, copying it to device memory if required. */
+        oskar_Mem* table_cpu = oskar_mem_create_alias_from_raw(
+                table->data + k * table->table_bytes, precision, OSKAR_CPU,
+                num_values, status);
+        if (location == OSKAR_CPU)
+            data = table_cpu;
+        else
+        {
+            if (*table_buffer_index != k)
+            {
+                oskar_mem_copy(table_buffer, table_cpu, status);
+                *table_buffer_index = k;
+            }
+            data = table_buffer;
+        }
+        oskar_beam_table_interp(num_points, enu[0], enu[1], enu[2],
+                table->grid_size, table->num_comp, data,
+                i * num_sources, beam, status);
+        oskar_mem_free(table_cpu, status);
+    }
+
+    /* Copy station beam only if required. */
+    for (i = n; i < num_stations; ++i)
+        oskar_mem_copy_contents(beam, beam, (size_t)(i * num_sources), 0,
+                (size_t)num_sources, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -41,10 +41,10 @@ void oskar_evaluate_jones_E(
         return;
     }
 
-    /* Evaluate the station beam(s). */
+    /* Evaluate the station beam(s), interpolating in time if enabled. */
     for (i = 0; i < n; ++i)
-        oskar_station_beam(
-                oskar_telescope_station_const(tel, i), work,
+        oskar_station_beam_time_interp(
+                oskar_telescope_station_const(tel, i), i, work,
                 coord_type, num_points, source_coords,
                 ref_lon_rad, ref_lat_rad,
                 oskar_telescope_phase_centre_coord_type(tel),
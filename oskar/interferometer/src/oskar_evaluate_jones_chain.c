@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/define_multiply.h"
+#include "interferometer/define_evaluate_jones_chain.h"
+#include "interferometer/oskar_evaluate_jones_chain.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_JONES_CHAIN_C(evaluate_jones_chain_complex_float, float, float2)
+OSKAR_JONES_CHAIN_C(evaluate_jones_chain_complex_double, double, double2)
+OSKAR_JONES_CHAIN_M(evaluate_jones_chain_matrix_float, float, float2, float4c)
+OSKAR_JONES_CHAIN_M(evaluate_jones_chain_matrix_double, double, double2, double4c)
+
+void oskar_evaluate_jones_chain(oskar_Jones* J, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double frequency_hz, const oskar_Mem* source_filter,
+        double source_filter_min, double source_filter_max,
+        int ignore_w_components, const oskar_Jones* E, const oskar_Jones* R,
+        const oskar_Mem* gains, int* status)
+{
+    if (*status) return;
+    const int type = oskar_jones_type(J);
+    const int precision = oskar_type_precision(type);
+    const int location = oskar_jones_mem_location(J);
+    const int num_stations = oskar_jones_num_stations(J);
+    const int use_R = R ? 1 : 0, use_gains = gains ? 1 : 0;
+    const double wavenumber = 2.0 * M_PI * frequency_hz / 299792458.0;
+    const float wavenumber_f = (float) wavenumber;
+    const float source_filter_min_f = (float) source_filter_min;
+    const float source_filter_max_f = (float) source_filter_max;
+    const oskar_Mem* e = oskar_jones_mem_const(E);
+    const oskar_Mem* r = R ? oskar_jones_mem_const(R) : e;
+    const oskar_Mem* g = gains ? gains : e;
+    if (oskar_mem_location(l) != location ||
+            oskar_mem_location(m) != location ||
+            oskar_mem_location(n) != location ||
+            oskar_mem_location(source_filter) != location ||
+            oskar_mem_location(u) != location ||
+            oskar_mem_location(v) != location ||
+            oskar_mem_location(w) != location ||
+            oskar_mem_location(e) != location ||
+            oskar_mem_location(r) != location ||
+            oskar_mem_location(g) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (precision != oskar_mem_type(l) || precision != oskar_mem_type(m) ||
+            precision != oskar_mem_type(n) || precision != oskar_mem_type(u) ||
+            precision != oskar_mem_type(v) || precision != oskar_mem_type(w) ||
+            precision != oskar_mem_type(source_filter) ||
+            type != oskar_mem_type(e) || type != oskar_mem_type(r) ||
+            type != oskar_mem_type(g))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_jones_num_sources(E) < num_sources ||
+            oskar_jones_num_stations(E) != num_stations ||
+            (R && (oskar_jones_num_sources(R) < num_sources ||
+                    oskar_jones_num_stations(R) != num_stations)) ||
+            (gains && (int)oskar_mem_length(gains) < num_stations) ||
+            oskar_jones_num_sources(J) < num_sources)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (R && !oskar_type_is_matrix(type))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (location == OSKAR_CPU)
+    {
+        switch (type)
+        {
+        case OSKAR_SINGLE_COMPLEX:
+            evaluate_jones_chain_complex_float(
+                    num_sources,
+                    oskar_mem_float_const(l, status),
+                    oskar_mem_float_const(m, status),
+                    oskar_mem_float_const(n, status),
+                    num_stations,
+                    oskar_mem_float_const(u, status),
+                    oskar_mem_float_const(v, status),
+                    oskar_mem_float_const(w, status), wavenumber_f,
+                    oskar_mem_float_const(source_filter, status),
+                    source_filter_min_f, source_filter_max_f,
+                    ignore_w_components,
+                    oskar_mem_float2_const(e, status),
+                    use_R, oskar_mem_float2_const(r, status),
+                    use_gains, oskar_mem_float2_const(g, status),
+                    oskar_mem_float2(oskar_jones_mem(J), status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            evaluate_jones_chain_complex_double(
+                    num_sources,
+                    oskar_mem_double_const(l, status),
+                    oskar_mem_double_const(m, status),
+                    oskar_mem_double_const(n, status),
+                    num_stations,
+                    oskar_mem_double_const(u, status),
+                    oskar_mem_double_const(v, status),
+                    oskar_mem_double_const(w, status), wavenumber,
+                    oskar_mem_double_const(source_filter, status),
+                    source_filter_min, source_filter_max,
+                    ignore_w_components,
+                    oskar_mem_double2_const(e, status),
+                    use_R, oskar_mem_double2_const(r, status),
+                    use_gains, oskar_mem_double2_const(g, status),
+                    oskar_mem_double2(oskar_jones_mem(J), status));
+            break;
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            evaluate_jones_chain_matrix_float(
+                    num_sources,
+                    oskar_mem_float_const(l, status),
+                    oskar_mem_float_const(m, status),
+                    oskar_mem_float_const(n, status),
+                    num_stations,
+                    oskar_mem_float_const(u, status),
+                    oskar_mem_float_const(v, status),
+                    oskar_mem_float_const(w, status), wavenumber_f,
+                    oskar_mem_float_const(source_filter, status),
+                    source_filter_min_f, source_filter_max_f,
+                    ignore_w_components,
+                    oskar_mem_float4c_const(e, status),
+                    use_R, oskar_mem_float4c_const(r, status),
+                    use_gains, oskar_mem_float4c_const(g, status),
+                    oskar_mem_float4c(oskar_jones_mem(J), status));
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            evaluate_jones_chain_matrix_double(
+                    num_sources,
+                    oskar_mem_double_const(l, status),
+                    oskar_mem_double_const(m, status),
+                    oskar_mem_double_const(n, status),
+                    num_stations,
+                    oskar_mem_double_const(u, status),
+                    oskar_mem_double_const(v, status),
+                    oskar_mem_double_const(w, status), wavenumber,
+                    oskar_mem_double_const(source_filter, status),
+                    source_filter_min, source_filter_max,
+                    ignore_w_components,
+                    oskar_mem_double4c_const(e, status),
+                    use_R, oskar_mem_double4c_const(r, status),
+                    use_gains, oskar_mem_double4c_const(g, status),
+                    oskar_mem_double4c(oskar_jones_mem(J), status));
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+    }
+    else
+    {
+        size_t local_size[] = {64, 4, 1}, global_size[] = {1, 1, 1};
+        const int is_dbl = oskar_type_is_double(type);
+        const char* k = 0;
+        switch (type)
+        {
+        case OSKAR_SINGLE_COMPLEX:
+            k = "evaluate_jones_chain_complex_float";
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            k = "evaluate_jones_chain_complex_double";
+            break;
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            k = "evaluate_jones_chain_matrix_float";
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            k = "evaluate_jones_chain_matrix_double";
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        if (oskar_device_is_cpu(location))
+            local_size[1] = 1;
+        oskar_device_check_local_size(location, 0, local_size);
+        oskar_device_check_local_size(location, 1, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_sources, local_size[0]);
+        global_size[1] = oskar_device_global_size(
+                (size_t) num_stations, local_size[1]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_sources},
+                {PTR_SZ, oskar_mem_buffer_const(l)},
+                {PTR_SZ, oskar_mem_buffer_const(m)},
+                {PTR_SZ, oskar_mem_buffer_const(n)},
+                {INT_SZ, &num_stations},
+                {PTR_SZ, oskar_mem_buffer_const(u)},
+                {PTR_SZ, oskar_mem_buffer_const(v)},
+                {PTR_SZ, oskar_mem_buffer_const(w)},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&wavenumber :
+                        (const void*)&wavenumber_f},
+                {PTR_SZ, oskar_mem_buffer_const(source_filter)},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&source_filter_min :
+                        (const void*)&source_filter_min_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&source_filter_max :
+                        (const void*)&source_filter_max_f},
+                {INT_SZ, &ignore_w_components},
+                {PTR_SZ, oskar_mem_buffer_const(e)},
+                {INT_SZ, &use_R},
+                {PTR_SZ, oskar_mem_buffer_const(r)},
+                {INT_SZ, &use_gains},
+                {PTR_SZ, oskar_mem_buffer_const(g)},
+                {PTR_SZ, oskar_mem_buffer(oskar_jones_mem(J))}
+        };
+        oskar_device_launch_kernel(k, location, 2, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,7 +1,9 @@
 /* Copyright (c) 2018-2020, The OSKAR Developers. See LICENSE file. */
 
 #include "math/define_multiply.h"
+#include "interferometer/define_beam_table_interp.h"
 #include "interferometer/define_jones_apply_station_gains.h"
+#include "interferometer/define_evaluate_jones_chain.h"
 #include "interferometer/define_evaluate_jones_K.h"
 #include "interferometer/define_evaluate_jones_R.h"
 #include "utility/oskar_cuda_registrar.h"
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -9,6 +9,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_device.h"
 
@@ -16,6 +17,48 @@
 extern "C" {
 #endif
 
+static char* copy_string(const char* str)
+{
+    char* copy = 0;
+    if (!str || strlen(str) == 0) return 0;
+    copy = (char*) calloc(1 + strlen(str), 1);
+    strcpy(copy, str);
+    return copy;
+}
+
+void oskar_interferometer_add_imager(oskar_Interferometer* h,
+        oskar_Imager* imager)
+{
+    if (!imager) return;
+    h->imagers = (oskar_Imager**) realloc(h->imagers,
+            (h->num_imagers + 1) * sizeof(oskar_Imager*));
+    h->imagers[h->num_imagers++] = imager;
+}
+
+void oskar_interferometer_append_sky_model(oskar_Interferometer* h,
+        const oskar_Sky* sky, int* status)
+{
+    int i;
+    if (*status || !h || !sky) return;
+
+    /* The chunks will change, so their indices must be rebuilt. */
+    if (h->sky_chunk_index)
+    {
+        for (i = 0; i < h->num_sky_chunks; ++i)
+            oskar_sky_index_free(h->sky_chunk_index[i]);
+        free(h->sky_chunk_index);
+        h->sky_chunk_index = 0;
+    }
+
+    /* Add the sources to the last chunk, and to new chunks as needed. */
+    if (oskar_sky_num_sources(sky) > 0)
+        oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
+                h->max_sources_per_chunk, sky, status);
+    if (!*status)
+        h->num_sources_total += oskar_sky_num_sources(sky);
+    h->init_sky = 0;
+}
+
 int oskar_interferometer_coords_only(const oskar_Interferometer* h)
 {
     return h->coords_only;
@@ -52,6 +95,48 @@ void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h)
     h->work_unit_index = 0;
 }
 
+void oskar_interferometer_set_adaptive_chunks(oskar_Interferometer* h,
+        int enable, double memory_budget_mb)
+{
+    h->adaptive_chunks = enable;
+    h->adaptive_chunks_memory_mb = memory_budget_mb;
+}
+
+void oskar_interferometer_set_bda(oskar_Interferometer* h, double max_fact,
+        double fov_deg, double max_time_avg_sec, int max_chans_avg)
+{
+    h->bda_max_fact = max_fact;
+    h->bda_fov_deg = fov_deg;
+    h->bda_max_time_avg_sec = max_time_avg_sec;
+    h->bda_max_chans_avg = max_chans_avg;
+}
+
+void oskar_interferometer_set_beam_time_interp(oskar_Interferometer* h,
+        int enable, int time_step, double max_error, int all_chunks)
+{
+    h->beam_interp_enabled = enable;
+    h->beam_interp_time_step = time_step;
+    h->beam_interp_max_error = max_error;
+    h->beam_interp_all_chunks = all_chunks;
+}
+
+void oskar_interferometer_set_beam_table(oskar_Interferometer* h,
+        int enable, const char* filename, int grid_size,
+        int epoch_time_steps, double max_error)
+{
+    h->beam_table_enabled = enable;
+    h->beam_table_grid_size = grid_size;
+    h->beam_table_epoch_time_steps = epoch_time_steps;
+    h->beam_table_max_error = max_error;
+    free(h->beam_table_name);
+    h->beam_table_name = 0;
+    if (!filename) return;
+    const int len = (int) strlen(filename);
+    if (len == 0) return;
+    h->beam_table_name = (char*) calloc(1 + len, 1);
+    strcpy(h->beam_table_name, filename);
+}
+
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status)
 {
@@ -72,6 +157,32 @@ void oskar_interferometer_set_correlation_type(oskar_Interferometer* h,
     else *status = OSKAR_ERR_INVALID_ARGUMENT;
 }
 
+void oskar_interferometer_set_device_partition(oskar_Interferometer* h,
+        const char* type, int* status)
+{
+    if (*status) return;
+    if (!strncmp(type, "A", 1) || !strncmp(type, "a", 1))
+        h->device_partition = 'A';
+    else if (!strncmp(type, "T",  1) || !strncmp(type, "t",  1))
+        h->device_partition = 'T';
+    else if (!strncmp(type, "S",  1) || !strncmp(type, "s",  1))
+        h->device_partition = 'S';
+    else *status = OSKAR_ERR_INVALID_ARGUMENT;
+}
+
+void oskar_interferometer_set_direct_correlation(oskar_Interferometer* h,
+        const char* type, int* status)
+{
+    if (*status) return;
+    if (!strncmp(type, "A", 1) || !strncmp(type, "a", 1))
+        h->direct_correlation = 'A';
+    else if (!strncmp(type, "D",  1) || !strncmp(type, "d",  1))
+        h->direct_correlation = 'D';
+    else if (!strncmp(type, "J",  1) || !strncmp(type, "j",  1))
+        h->direct_correlation = 'J';
+    else *status = OSKAR_ERR_INVALID_ARGUMENT;
+}
+
 void oskar_interferometer_set_force_polarised_ms(oskar_Interferometer* h,
         int value)
 {
@@ -118,6 +229,21 @@ void oskar_interferometer_set_gpus(oskar_Interferometer* h, int num,
     }
 }
 
+void oskar_interferometer_set_facet_prediction(oskar_Interferometer* h,
+        int enable, int min_sources, double facet_size_deg,
+        double pixel_oversample)
+{
+    h->facet_enabled = enable;
+    h->facet_min_sources = min_sources;
+    h->facet_size_rad = facet_size_deg * M_PI / 180.0;
+    h->facet_pixel_oversample = pixel_oversample;
+}
+
+void oskar_interferometer_set_fused_jones(oskar_Interferometer* h, int value)
+{
+    h->fuse_jones = value;
+}
+
 void oskar_interferometer_set_horizon_clip(oskar_Interferometer* h, int value)
 {
     h->apply_horizon_clip = value;
@@ -129,6 +255,13 @@ void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
     h->ignore_w_components = value;
 }
 
+void oskar_interferometer_set_level_of_detail(oskar_Interferometer* h,
+        int enable, double tolerance_jy)
+{
+    h->lod_enabled = enable;
+    h->lod_tolerance_jy = tolerance_jy;
+}
+
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
@@ -147,6 +280,24 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
     h->max_times_per_block = value;
 }
 
+void oskar_interferometer_set_model_image(oskar_Interferometer* h,
+        const char* filename, const char* algorithm,
+        const char* default_map_units, int override_units,
+        double spectral_index)
+{
+    int status = 0;
+    oskar_imager_free(h->model_imager, &status);
+    h->model_imager = 0;
+    free(h->model_image_file);
+    free(h->model_image_algorithm);
+    free(h->model_image_units);
+    h->model_image_file = copy_string(filename);
+    h->model_image_algorithm = copy_string(algorithm);
+    h->model_image_units = copy_string(default_map_units);
+    h->model_image_override_units = override_units;
+    h->model_image_spectral_index = spectral_index;
+}
+
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 {
     int status = 0;
@@ -198,17 +349,20 @@ void oskar_interferometer_set_sky_model(oskar_Interferometer* h,
 
     /* Clear the old chunk set. */
     for (i = 0; i < h->num_sky_chunks; ++i)
+    {
         oskar_sky_free(h->sky_chunks[i], status);
+        if (h->sky_chunk_index)
+            oskar_sky_index_free(h->sky_chunk_index[i]);
+    }
     free(h->sky_chunks);
+    free(h->sky_chunk_index);
     h->sky_chunks = 0;
+    h->sky_chunk_index = 0;
     h->num_sky_chunks = 0;
+    h->num_sources_total = 0;
 
     /* Split up the sky model into chunks and store them. */
-    h->num_sources_total = oskar_sky_num_sources(sky);
-    if (h->num_sources_total > 0)
-        oskar_sky_append_to_set(&h->num_sky_chunks, &h->sky_chunks,
-                h->max_sources_per_chunk, sky, status);
-    h->init_sky = 0;
+    oskar_interferometer_append_sky_model(h, sky, status);
 
     /* Print summary data. */
     oskar_log_section(h->log, 'M', "Sky model summary");
@@ -233,6 +387,8 @@ void oskar_interferometer_set_telescope_model(oskar_Interferometer* h,
     }
 
     /* Remove any existing telescope model, and copy the new one. */
+    oskar_beam_table_free(h->beam_table);
+    h->beam_table = 0;
     oskar_telescope_free(h->tel, status);
     h->tel = oskar_telescope_create_copy(model, OSKAR_CPU, status);
 
@@ -253,6 +409,18 @@ void oskar_interferometer_set_output_vis_file(oskar_Interferometer* h,
     strcpy(h->vis_name, filename);
 }
 
+void oskar_interferometer_set_output_bda_vis_file(oskar_Interferometer* h,
+        const char* filename)
+{
+    if (!filename) return;
+    const int len = (int) strlen(filename);
+    free(h->bda_name);
+    h->bda_name = 0;
+    if (len == 0) return;
+    h->bda_name = (char*) calloc(1 + len, 1);
+    strcpy(h->bda_name, filename);
+}
+
 void oskar_interferometer_set_output_measurement_set(oskar_Interferometer* h,
         const char* filename)
 {
@@ -277,6 +445,11 @@ void oskar_interferometer_set_source_flux_range(oskar_Interferometer* h,
     h->source_max_jy = max_jy;
 }
 
+void oskar_interferometer_set_use_mpi(oskar_Interferometer* h, int value)
+{
+    h->use_mpi = value;
+}
+
 void oskar_interferometer_set_zero_failed_gaussians(oskar_Interferometer* h,
         int value)
 {
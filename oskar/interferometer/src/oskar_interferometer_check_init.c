@@ -3,21 +3,56 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "correlate/oskar_source_tree.h"
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
 #include "math/oskar_cmath.h"
+#include "sky/oskar_sky_append_to_set.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_mpi.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Smallest chunk size chosen from the memory budget. */
+#define MIN_ADAPTIVE_CHUNK_SIZE 256
+
+/* Number of source arrays held in a sky model. */
+#define NUM_SKY_ARRAYS 18
+
+static void set_up_adaptive_chunks(oskar_Interferometer* h, int* status);
+static void set_up_beam_table(oskar_Interferometer* h, int* status);
 static void set_up_device_data(oskar_Interferometer* h, int* status);
+static void set_up_facet_cell_size(oskar_Interferometer* h, int* status);
+static void set_up_model_image(oskar_Interferometer* h, int* status);
+static void set_up_sky_index(oskar_Interferometer* h, int* status);
+static void sort_sky_chunks(oskar_Interferometer* h, int* status);
+static double max_uv_wavelengths(const oskar_Interferometer* h,
+        int* status);
+static oskar_Mem* sky_column(oskar_Sky* sky, int i);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 
+int oskar_interferometer_partition_by_time(char device_partition,
+        int num_devices, int num_gpus, int max_times_per_block)
+{
+    if (device_partition == 'T') return 1;
+    if (device_partition == 'S') return 0;
+
+    /* Time ranges are shared equally, so only use them if every device
+     * is of the same kind. Otherwise the faster devices would wait for
+     * the slower ones, which the queue of work units avoids. */
+    return (num_devices > 1 && max_times_per_block >= num_devices &&
+            (num_gpus == 0 || num_gpus >= num_devices));
+}
+
 void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
 {
     if (*status) return;
@@ -34,12 +69,20 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
     if (!h->header)
         set_up_vis_header(h, status);
 
+    /* Share blocks between processes, if running under MPI. */
+    h->num_procs = h->use_mpi ? oskar_mpi_size() : 1;
+    h->proc_id = h->use_mpi ? oskar_mpi_rank() : 0;
+
     /* Calculate source parameters if required. */
     if (!h->init_sky)
     {
         int i, num_failed = 0;
         double ra0 = 0.0, dec0 = 0.0;
 
+        /* Choose the chunk size and re-pack the chunks if required. */
+        if (h->adaptive_chunks)
+            set_up_adaptive_chunks(h, status);
+
         /* Compute source direction cosines. */
         if (oskar_telescope_phase_centre_coord_type(h->tel) !=
                 OSKAR_COORDS_AZEL)
@@ -67,11 +110,25 @@ void oskar_interferometer_check_init(oskar_Interferometer* h, int* status)
                         "for %i sources. These will be simulated "
                         "as point sources.", num_failed);
         }
+
+        /* Put sources into tree order if using level-of-detail
+         * correlation, so nearby sources are close together in memory. */
+        sort_sky_chunks(h, status);
+
+        /* Index the source positions for horizon clipping on the CPU. */
+        set_up_sky_index(h, status);
         h->init_sky = 1;
     }
 
     /* Check that each compute device has been set up. */
+    set_up_facet_cell_size(h, status);
+    if (h->model_image_file && !h->model_imager && !h->coords_only)
+        set_up_model_image(h, status);
     set_up_device_data(h, status);
+
+    /* Tabulate station beams if required. */
+    if (h->beam_table_enabled && !h->beam_table && !h->coords_only)
+        set_up_beam_table(h, status);
     if (!*status && !h->coords_only)
         oskar_log_section(h->log, 'M', "Starting simulation...");
 
@@ -159,6 +216,262 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
 }
 
 
+static void set_up_adaptive_chunks(oskar_Interferometer* h, int* status)
+{
+    int i, num_chunks = 0;
+    oskar_Sky** chunks = 0;
+    if (*status || h->num_sources_total == 0) return;
+
+    /* Size chunks so that the source-dependent arrays on each device fit in
+     * the memory budget. This can't change once device memory exists. */
+    if (!h->d[0].tel)
+    {
+        const size_t num_stations = oskar_telescope_num_stations(h->tel);
+        const int matrix =
+                oskar_telescope_pol_mode(h->tel) == OSKAR_POL_MODE_FULL;
+        const size_t prec = oskar_mem_element_size(h->prec);
+        const size_t jones = 2 * prec * (matrix ? 4 : 1);
+
+        /* Jones J, E and R, complex scalar K (unless the Jones chain is
+         * fused), cached ENU directions and beams for interpolation in
+         * time per station, plus direction cosines and the device sky
+         * models. */
+        const size_t bytes_per_source = num_stations *
+                (jones * (matrix ? 3 : 2) + (h->fuse_jones ? 0 : 2 * prec) +
+                3 * prec + (h->beam_interp_enabled ?
+                        2 * jones * h->max_channels_per_block : 0)) +
+                prec * (3 + NUM_SKY_ARRAYS * (2 + h->max_times_per_block));
+        double cap = h->adaptive_chunks_memory_mb * 1024.0 * 1024.0 /
+                bytes_per_source;
+        if (cap > h->num_sources_total) cap = h->num_sources_total;
+        if (cap > INT_MAX / 2) cap = INT_MAX / 2;
+        if (cap < MIN_ADAPTIVE_CHUNK_SIZE) cap = MIN_ADAPTIVE_CHUNK_SIZE;
+        h->max_sources_per_chunk = (int) cap;
+    }
+
+    /* Re-pack the sky model into chunks of equal size. */
+    const int max_chunk = h->max_sources_per_chunk;
+    const int num = (h->num_sources_total + max_chunk - 1) / max_chunk;
+    const int chunk_size = (h->num_sources_total + num - 1) / num;
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        oskar_sky_append_to_set(&num_chunks, &chunks, chunk_size,
+                h->sky_chunks[i], status);
+        oskar_sky_free(h->sky_chunks[i], status);
+    }
+    free(h->sky_chunks);
+    h->sky_chunks = chunks;
+    h->num_sky_chunks = num_chunks;
+    oskar_log_message(h->log, 'M', 0, "Using %d sky chunks of up to "
+            "%d sources (memory budget %.0f MB per device).",
+            num_chunks, chunk_size, h->adaptive_chunks_memory_mb);
+}
+
+
+static void set_up_sky_index(oskar_Interferometer* h, int* status)
+{
+    int i;
+    if (*status || h->sky_chunk_index || !h->apply_horizon_clip ||
+            h->num_devices <= h->num_gpus || h->num_sky_chunks == 0)
+        return;
+    h->sky_chunk_index = (oskar_SkyIndex**) calloc(h->num_sky_chunks,
+            sizeof(oskar_SkyIndex*));
+    for (i = 0; i < h->num_sky_chunks; ++i)
+    {
+        const oskar_Sky* chunk = h->sky_chunks[i];
+        h->sky_chunk_index[i] = oskar_sky_index_create(
+                oskar_sky_num_sources(chunk), oskar_sky_ra_rad_const(chunk),
+                oskar_sky_dec_rad_const(chunk), status);
+    }
+}
+
+
+static void sort_sky_chunks(oskar_Interferometer* h, int* status)
+{
+    int i, j, k;
+    if (*status || !h->lod_enabled || h->num_devices <= h->num_gpus ||
+            h->correlation_type == 'A')
+        return;
+    oskar_SourceTree* tree = oskar_source_tree_create();
+    const size_t size = oskar_mem_element_size(h->prec);
+    for (i = 0; i < h->num_sky_chunks && !*status; ++i)
+    {
+        oskar_Sky* chunk = h->sky_chunks[i];
+        const int num_sources = oskar_sky_num_sources(chunk);
+        const oskar_Mem* dir[3];
+        dir[0] = oskar_sky_l_const(chunk);
+        dir[1] = oskar_sky_m_const(chunk);
+        dir[2] = oskar_sky_n_const(chunk);
+        oskar_source_tree_build(tree, num_sources, dir, status);
+        if (*status || num_sources == 0) continue;
+        const int* order = oskar_source_tree_order(tree);
+        char* temp = (char*) malloc(num_sources * size);
+        if (!temp)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            break;
+        }
+        for (j = 0; j < NUM_SKY_ARRAYS; ++j)
+        {
+            char* data = (char*) oskar_mem_void(sky_column(chunk, j));
+            for (k = 0; k < num_sources; ++k)
+                memcpy(temp + k * size, data + order[k] * size, size);
+            memcpy(data, temp, num_sources * size);
+        }
+        free(temp);
+    }
+    oskar_source_tree_free(tree);
+}
+
+
+static oskar_Mem* sky_column(oskar_Sky* sky, int i)
+{
+    switch (i)
+    {
+    case 0:  return oskar_sky_ra_rad(sky);
+    case 1:  return oskar_sky_dec_rad(sky);
+    case 2:  return oskar_sky_I(sky);
+    case 3:  return oskar_sky_Q(sky);
+    case 4:  return oskar_sky_U(sky);
+    case 5:  return oskar_sky_V(sky);
+    case 6:  return oskar_sky_reference_freq_hz(sky);
+    case 7:  return oskar_sky_spectral_index(sky);
+    case 8:  return oskar_sky_rotation_measure_rad(sky);
+    case 9:  return oskar_sky_l(sky);
+    case 10: return oskar_sky_m(sky);
+    case 11: return oskar_sky_n(sky);
+    case 12: return oskar_sky_gaussian_a(sky);
+    case 13: return oskar_sky_gaussian_b(sky);
+    case 14: return oskar_sky_gaussian_c(sky);
+    case 15: return oskar_sky_fwhm_major_rad(sky);
+    case 16: return oskar_sky_fwhm_minor_rad(sky);
+    default: return oskar_sky_position_angle_rad(sky);
+    }
+}
+
+
+static double max_uv_wavelengths(const oskar_Interferometer* h,
+        int* status)
+{
+    int i, j;
+    double range[3], max_freq_hz;
+
+    /* Find the longest possible baseline, in wavelengths, from the
+     * diagonal of the box around the stations and the highest frequency. */
+    const int num_stations = oskar_telescope_num_stations(h->tel);
+    for (j = 0; j < 3; ++j)
+    {
+        double min_val = 0.0, max_val = 0.0;
+        const oskar_Mem* pos =
+                oskar_telescope_station_true_offset_ecef_metres_const(
+                        h->tel, j);
+        for (i = 0; i < num_stations; ++i)
+        {
+            const double val = oskar_mem_get_element(pos, i, status);
+            if (i == 0 || val < min_val) min_val = val;
+            if (i == 0 || val > max_val) max_val = val;
+        }
+        range[j] = max_val - min_val;
+    }
+    max_freq_hz = fabs(h->freq_start_hz);
+    if (h->num_channels > 1)
+    {
+        const double f = h->freq_start_hz +
+                (h->num_channels - 1) * h->freq_inc_hz;
+        if (fabs(f) > max_freq_hz) max_freq_hz = fabs(f);
+    }
+    return sqrt(range[0] * range[0] + range[1] * range[1] +
+            range[2] * range[2]) * max_freq_hz / 299792458.0;
+}
+
+
+static void set_up_facet_cell_size(oskar_Interferometer* h, int* status)
+{
+    if (*status || !h->facet_enabled) return;
+
+    /* The longest baseline must be sampled with the required factor. */
+    const double max_uv = max_uv_wavelengths(h, status);
+    h->facet_cell_size_rad = (max_uv > 0.0) ?
+            1.0 / (2.0 * h->facet_pixel_oversample * max_uv) : 1.0;
+}
+
+
+static void set_up_model_image(oskar_Interferometer* h, int* status)
+{
+    int size = 0;
+    double cellsize_rad = 0.0;
+    if (*status) return;
+    if (oskar_telescope_phase_centre_coord_type(h->tel) != OSKAR_COORDS_RADEC)
+    {
+        oskar_log_error(h->log, "A model image can only be used with "
+                "a phase centre in equatorial coordinates.");
+        *status = OSKAR_ERR_SETUP_FAIL_SKY;
+        return;
+    }
+    oskar_log_section(h->log, 'M', "Model image");
+    oskar_log_value(h->log, 'M', 0, "File", "%s", h->model_image_file);
+
+    /* Read the image into an imager, which predicts its visibilities
+     * using the same kernels as for imaging. The W-kernels must cover
+     * the longest possible baseline. */
+    const double max_uv = max_uv_wavelengths(h, status);
+    h->model_imager = oskar_imager_create(h->prec, status);
+    oskar_log_set_file_priority(oskar_imager_log(h->model_imager),
+            OSKAR_LOG_NONE);
+    oskar_imager_set_gpus(h->model_imager, 0, 0, status);
+    oskar_imager_set_algorithm(h->model_imager,
+            h->model_image_algorithm, status);
+    oskar_imager_set_w_range(h->model_imager, 0.0, max_uv,
+            max_uv / sqrt(3.0));
+    oskar_imager_read_model_image(h->model_imager, h->model_image_file,
+            h->model_image_units, h->model_image_override_units,
+            &h->model_image_freq_hz, status);
+    if (*status)
+    {
+        oskar_log_error(h->log, "Unable to read model image '%s' (%s).",
+                h->model_image_file, oskar_get_error_string(*status));
+        return;
+    }
+    if (h->model_image_freq_hz == 0.0)
+        h->model_image_freq_hz = h->freq_start_hz;
+    oskar_imager_set_vis_phase_centre(h->model_imager,
+            oskar_telescope_phase_centre_longitude_rad(h->tel) * 180.0 / M_PI,
+            oskar_telescope_phase_centre_latitude_rad(h->tel) * 180.0 / M_PI);
+    size = oskar_imager_image_size(h->model_imager);
+    cellsize_rad = oskar_imager_cellsize(h->model_imager) * M_PI / 648000.0;
+    oskar_log_value(h->log, 'M', 0, "Image size", "%d", size);
+    oskar_log_value(h->log, 'M', 0, "Cell size [arcsec]", "%.3f",
+            oskar_imager_cellsize(h->model_imager));
+    oskar_log_value(h->log, 'M', 0, "Algorithm", "%s",
+            h->model_image_algorithm);
+    oskar_log_value(h->log, 'M', 0, "Reference frequency [Hz]", "%.6e",
+            h->model_image_freq_hz);
+
+    /* Baselines beyond the edge of the grid see nothing of the image. */
+    if (max_uv * 2.0 * cellsize_rad > 1.0)
+        oskar_log_warning(h->log, "The model image cell size is too large "
+                "for the longest baselines, which will not see the image.");
+}
+
+
+static void set_up_beam_table(oskar_Interferometer* h, int* status)
+{
+    if (*status) return;
+    if (oskar_telescope_ionosphere_screen_type(h->tel) == 'E')
+    {
+        oskar_log_warning(h->log, "Station beams will not be tabulated, "
+                "as an ionospheric screen is in use.");
+        return;
+    }
+    oskar_log_section(h->log, 'M', "Tabulating station beams");
+    h->beam_table = oskar_beam_table_create(h->tel, h->beam_table_grid_size,
+            h->beam_table_epoch_time_steps, h->beam_table_max_error,
+            h->time_start_mjd_utc, h->time_inc_sec, h->num_time_steps,
+            h->freq_start_hz, h->freq_inc_hz, h->num_channels,
+            h->beam_table_name, h->log, status);
+}
+
+
 struct ThreadArgs
 {
     oskar_Interferometer* h;
@@ -205,21 +518,41 @@ static void* init_device(void* arg)
         d->tmr_K         = oskar_timer_create(dev_loc);
         d->tmr_join      = oskar_timer_create(dev_loc);
         d->tmr_correlate = oskar_timer_create(dev_loc);
+        oskar_timer_set_name(d->tmr_compute, "Compute");
+        oskar_timer_set_name(d->tmr_copy, "Copy");
+        oskar_timer_set_name(d->tmr_clip, "Horizon clip");
+        oskar_timer_set_name(d->tmr_E, "Jones E");
+        oskar_timer_set_name(d->tmr_K, "Jones K");
+        oskar_timer_set_name(d->tmr_join, "Jones join");
+        oskar_timer_set_name(d->tmr_correlate, "Correlate");
     }
 
-    /* Visibility blocks. */
+    /* Visibility blocks.
+     * If partitioning by time, each device block only needs to hold
+     * its share of the time samples, and only device 0 needs host blocks. */
     if (!d->vis_block)
     {
         d->vis_block = oskar_vis_block_create_from_header(dev_loc,
                 h->header, status);
+        if (h->partition_by_time)
+            oskar_vis_block_resize(d->vis_block,
+                    (h->max_times_per_block + h->num_devices - 1) /
+                    h->num_devices, oskar_vis_block_num_channels(d->vis_block),
+                    num_stations, status);
+    }
+    if (!d->vis_block_cpu[0] && (i == 0 || !h->partition_by_time))
+    {
         d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
                 h->header, status);
         d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
                 h->header, status);
     }
     oskar_vis_block_clear(d->vis_block, status);
-    oskar_vis_block_clear(d->vis_block_cpu[0], status);
-    oskar_vis_block_clear(d->vis_block_cpu[1], status);
+    if (d->vis_block_cpu[0])
+    {
+        oskar_vis_block_clear(d->vis_block_cpu[0], status);
+        oskar_vis_block_clear(d->vis_block_cpu[1], status);
+    }
 
     /* Device scratch memory. */
     if (!d->tel)
@@ -239,10 +572,12 @@ static void* init_device(void* arg)
                 dev_loc, num_stations, num_src, status) : 0;
         d->E = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                 status);
-        d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
-                status);
+        d->K = oskar_jones_create(complx, dev_loc, num_stations,
+                h->fuse_jones ? 0 : num_src, status);
         d->gains = oskar_mem_create(vistype, dev_loc, num_stations, status);
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
+        d->beam_table_buffer = oskar_mem_create(h->prec, dev_loc, 0, status);
+        d->beam_table_buffer_index = -1;
         oskar_station_work_set_tec_screen_common_params(d->station_work,
                 oskar_telescope_ionosphere_screen_type(d->tel),
                 oskar_telescope_tec_screen_height_km(d->tel),
@@ -251,6 +586,103 @@ static void* init_device(void* arg)
         if (oskar_telescope_ionosphere_screen_type(d->tel) == 'E')
             oskar_station_work_set_tec_screen_path(d->station_work,
                     oskar_telescope_tec_screen_path(d->tel));
+        if (h->lod_enabled && dev_loc == OSKAR_CPU)
+            d->source_tree = oskar_source_tree_create();
+        if (h->facet_enabled && dev_loc == OSKAR_CPU &&
+                oskar_telescope_phase_centre_coord_type(d->tel) ==
+                        OSKAR_COORDS_RADEC)
+        {
+            d->facets = oskar_sky_facets_create(h->prec, status);
+            d->facet_channel = (int*) calloc(h->max_channels_per_block,
+                    sizeof(int));
+            d->facet_mask = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+        }
+        if (h->adaptive_chunks)
+        {
+            int j;
+            d->num_merge = h->max_times_per_block;
+            d->merge = (oskar_Sky**) calloc(d->num_merge, sizeof(oskar_Sky*));
+            for (j = 0; j < d->num_merge; ++j)
+                d->merge[j] = oskar_sky_create(h->prec, dev_loc, num_src,
+                        status);
+        }
+    }
+    if (h->model_imager && !d->model_vis)
+    {
+        int j;
+        const int num_baselines = oskar_telescope_num_baselines(d->tel);
+        for (j = 0; j < 3; ++j)
+        {
+            d->model_station_uvw[j] = oskar_mem_create(h->prec,
+                    OSKAR_CPU, num_stations, status);
+            d->model_uvw[j] = oskar_mem_create(h->prec,
+                    OSKAR_CPU, num_baselines, status);
+        }
+        d->model_vis = oskar_mem_create(h->prec | OSKAR_COMPLEX,
+                OSKAR_CPU, num_baselines, status);
+        d->model_block = oskar_mem_create(oskar_mem_type(
+                oskar_vis_block_cross_correlations(d->vis_block)),
+                OSKAR_CPU, num_baselines, status);
+        oskar_mem_clear_contents(d->model_block, status);
+    }
+    d->use_source_tree = 0;
+    d->lod_terms = d->lod_terms_exact = d->lod_error_max = 0.0;
+    d->facet_chunk_index = -1;
+    d->facet_work_units = d->facet_error_max = 0.0;
+    {
+        /* Beams cached for interpolation are kept in a slot for each
+         * sky chunk if required, as chunks are simulated in turn. */
+        int j;
+        const int num_slots = (h->beam_interp_enabled &&
+                h->beam_interp_all_chunks && h->num_sky_chunks > 1) ?
+                        h->num_sky_chunks : 1;
+        for (j = 0; j < d->beam_interp_num_slots; ++j)
+            oskar_mem_free(d->beam_interp_mask[j], status);
+        d->beam_interp_num_slots = num_slots;
+        d->beam_interp_chunk = (int*) realloc(d->beam_interp_chunk,
+                num_slots * sizeof(int));
+        d->beam_interp_key = (int*) realloc(d->beam_interp_key,
+                num_slots * sizeof(int));
+        d->beam_interp_num_clip = (int*) realloc(d->beam_interp_num_clip,
+                num_slots * sizeof(int));
+        d->beam_interp_mask = (oskar_Mem**) realloc(d->beam_interp_mask,
+                num_slots * sizeof(oskar_Mem*));
+        for (j = 0; j < num_slots; ++j)
+        {
+            d->beam_interp_chunk[j] = -1;
+            d->beam_interp_key[j] = 0;
+            d->beam_interp_num_clip[j] = 0;
+            d->beam_interp_mask[j] = oskar_mem_create(OSKAR_INT,
+                    OSKAR_CPU, 0, status);
+        }
+        if (!d->beam_interp_mask_host)
+            d->beam_interp_mask_host = oskar_mem_create(OSKAR_INT,
+                    OSKAR_CPU, 0, status);
+
+        /* With facets, auto-correlations need beams for the sources as
+         * well as the facet centres, so keep twice as many channels. */
+        oskar_station_work_set_beam_time_interp(d->station_work,
+                h->beam_interp_enabled ? h->beam_interp_time_step : 1,
+                h->beam_interp_max_error,
+                h->beam_interp_enabled ? num_stations : 0,
+                num_slots * h->max_channels_per_block * (d->facets &&
+                        h->correlation_type != 'C' ? 2 : 1),
+                h->time_start_mjd_utc, h->time_inc_sec, h->num_time_steps);
+    }
+    d->direct_xcorr = 0;
+    if (!oskar_type_is_matrix(vistype) && h->correlation_type == 'C' &&
+            !d->source_tree && h->direct_correlation != 'J')
+        d->direct_xcorr = (h->direct_correlation == 'D') ? 1 : -1;
+    d->direct_samples[0] = d->direct_samples[1] = 0;
+    d->direct_time[0] = d->direct_time[1] = 0.0;
+    if (d->merge)
+    {
+        int j;
+        for (j = 0; j < d->num_merge; ++j)
+            oskar_sky_set_num_sources(d->merge[j], 0, status);
+        d->merge_min_sources = num_src / 2;
+        d->fit_count = 0;
+        d->fit_n = d->fit_t = d->fit_nn = d->fit_nt = 0.0;
     }
     return 0;
 }
@@ -268,6 +700,39 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_interferometer_set_num_devices(h, h->num_gpus);
 
+    /* Share the available cores between the CPU devices, so that kernels
+     * using multiple threads do not oversubscribe the host. */
+    h->num_cpu_threads = 1;
+    if (h->num_devices > h->num_gpus)
+    {
+        h->num_cpu_threads = (oskar_get_num_procs() - h->num_gpus) /
+                (h->num_devices - h->num_gpus);
+        if (h->num_cpu_threads < 1) h->num_cpu_threads = 1;
+    }
+
+    /* Decide how to partition work between devices.
+     * Host blocks are allocated according to this, so it must not
+     * change while device data exist. */
+    if (!h->d[0].vis_block)
+    {
+        h->partition_by_time = oskar_interferometer_partition_by_time(
+                h->device_partition, h->num_devices, h->num_gpus,
+                h->max_times_per_block);
+    }
+
+    /* Check whether all stations are isotropic, so that station beams
+     * need not be evaluated per source for direct correlation. */
+    h->isotropic_stations =
+            oskar_telescope_ionosphere_screen_type(h->tel) == 'N';
+    for (i = 0; i < oskar_telescope_num_stations(h->tel); ++i)
+    {
+        const oskar_Station* station =
+                oskar_telescope_station_const(h->tel, i);
+        if (!station ||
+                oskar_station_type(station) != OSKAR_STATION_TYPE_ISOTROPIC)
+            h->isotropic_stations = 0;
+    }
+
     /* Set up devices in parallel. */
     const int num_devices = h->num_devices;
     threads = (oskar_Thread**) calloc(num_devices, sizeof(oskar_Thread*));
@@ -293,6 +758,17 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     /* Record memory usage. */
     if (!*status && init)
     {
+        if (h->num_devices > 1)
+            oskar_log_message(h->log, 'M', 0, "Partitioning work between "
+                    "devices by %s.", h->partition_by_time ?
+                            "time" : "sky chunk");
+        if (h->num_cpu_threads > 1)
+            oskar_log_message(h->log, 'M', 0, "Using %d threads for each "
+                    "CPU device.", h->num_cpu_threads);
+        if (h->num_procs > 1)
+            oskar_log_message(h->log, 'M', 0, "Sharing blocks between "
+                    "%d processes (this is process %d).",
+                    h->num_procs, h->proc_id);
         oskar_log_section(h->log, 'M', "Initial memory usage");
         for (i = 0; i < h->num_gpus; ++i)
             oskar_device_log_mem(h->dev_loc, 0, h->gpu_ids[i], h->log);
@@ -21,6 +21,7 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->prec      = precision;
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_name(h->tmr_write, "Write");
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
     h->barrier   = oskar_barrier_create(0);
@@ -35,9 +36,21 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     oskar_interferometer_set_gpus(h, -1, 0, status);
     oskar_interferometer_set_num_devices(h, -1);
     oskar_interferometer_set_correlation_type(h, "Cross-correlations", status);
+    oskar_interferometer_set_device_partition(h, "Auto", status);
     oskar_interferometer_set_horizon_clip(h, 1);
+    oskar_interferometer_set_fused_jones(h, 1);
+    oskar_interferometer_set_beam_time_interp(h, 0, 0, 1e-3, 0);
+    oskar_interferometer_set_direct_correlation(h, "Auto", status);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
     oskar_interferometer_set_max_times_per_block(h, 8);
+    oskar_interferometer_set_bda(h, 1.01, 1.0, 0.0, 0);
+    oskar_interferometer_set_beam_table(h, 0, 0, 256, 10, 1e-3);
+    oskar_interferometer_set_adaptive_chunks(h, 0, 256.0);
+    oskar_interferometer_set_level_of_detail(h, 0, 1e-3);
+    oskar_interferometer_set_facet_prediction(h, 0, 100000, 1.0, 4.0);
+    oskar_interferometer_set_model_image(h, 0, "W-projection", "Jy/beam",
+            0, 0.0);
+    oskar_interferometer_set_use_mpi(h, 1);
     return h;
 }
 
@@ -76,9 +76,21 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
         }
     }
 
+    /* Write out any remaining baseline-dependent averages. */
+    if (h->bda) oskar_vis_bda_finalise(h->bda, h->bda_file, status);
+
+    /* Write images from any attached imagers. */
+    if (!h->coords_only && h->proc_id == 0)
+    {
+        int i;
+        for (i = 0; i < h->num_imagers; ++i)
+            oskar_imager_finalise(h->imagers[i], 0, 0, 0, 0, status);
+    }
+
     /* Record times and summarise output files. */
     if (!*status)
     {
+        int i;
         size_t log_size = 0;
         char* log_data;
         if (h->num_sources_total < 32 && h->num_gpus > 0)
@@ -94,6 +106,104 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
         if (h->ms_name)
             oskar_log_value(h->log, 'M', 1,
                     "Measurement Set", "%s", h->ms_name);
+        if (h->bda_name)
+            oskar_log_value(h->log, 'M', 1,
+                    "BDA binary file", "%s", h->bda_name);
+        for (i = 0; i < h->num_imagers; ++i)
+            oskar_log_value(h->log, 'M', 1, "Image root path", "%s",
+                    oskar_imager_output_root(h->imagers[i]));
+        if (h->bda)
+        {
+            oskar_log_message(h->log, 'M', 0, "Baseline-dependent averaging:");
+            oskar_log_value(h->log, 'M', 1, "Max. (u,v,w) change",
+                    "%.3f wavelengths",
+                    oskar_vis_bda_max_duvw_wavelengths(h->bda));
+            oskar_log_value(h->log, 'M', 1, "Visibilities in", "%.0f",
+                    oskar_vis_bda_num_vis_in(h->bda));
+            oskar_log_value(h->log, 'M', 1, "Visibilities out", "%.0f",
+                    oskar_vis_bda_num_vis_out(h->bda));
+            oskar_log_value(h->log, 'M', 1, "Compression ratio", "%.2f",
+                    oskar_vis_bda_compression_ratio(h->bda));
+        }
+        if (h->lod_enabled)
+        {
+            double terms = 0.0, terms_exact = 0.0, error_max = 0.0;
+            for (i = 0; i < h->num_devices; ++i)
+            {
+                terms += h->d[i].lod_terms;
+                terms_exact += h->d[i].lod_terms_exact;
+                if (h->d[i].lod_error_max > error_max)
+                    error_max = h->d[i].lod_error_max;
+            }
+            oskar_log_message(h->log, 'M', 0, "Level-of-detail correlation:");
+            oskar_log_value(h->log, 'M', 1, "Terms evaluated", "%.0f", terms);
+            oskar_log_value(h->log, 'M', 1, "Terms if exact", "%.0f",
+                    terms_exact);
+            oskar_log_value(h->log, 'M', 1, "Speed-up", "%.2f",
+                    terms > 0.0 ? terms_exact / terms : 1.0);
+            oskar_log_value(h->log, 'M', 1, "Max. error bound", "%.3g Jy",
+                    error_max);
+        }
+        if (h->facet_enabled)
+        {
+            double work_units = 0.0, error_max = 0.0;
+            for (i = 0; i < h->num_devices; ++i)
+            {
+                work_units += h->d[i].facet_work_units;
+                if (h->d[i].facet_error_max > error_max)
+                    error_max = h->d[i].facet_error_max;
+            }
+            oskar_log_message(h->log, 'M', 0, "Facet prediction:");
+            oskar_log_value(h->log, 'M', 1, "Work units predicted", "%.0f",
+                    work_units);
+            oskar_log_value(h->log, 'M', 1, "Max. error bound", "%.3g Jy",
+                    error_max);
+        }
+        if (h->beam_interp_enabled)
+        {
+            int time_step = 0;
+            double num_exact = 0.0, num_interp = 0.0, num_checks = 0.0;
+            double error_max = 0.0;
+            for (i = 0; i < h->num_devices; ++i)
+            {
+                int step;
+                double exact, interp, checks, error;
+                oskar_station_work_beam_time_interp_stats(
+                        h->d[i].station_work, &step, &exact, &interp,
+                        &checks, &error);
+                num_exact += exact;
+                num_interp += interp;
+                num_checks += checks;
+                if (error > error_max) error_max = error;
+                if (step > time_step) time_step = step;
+            }
+            oskar_log_message(h->log, 'M', 0,
+                    "Station beam interpolation in time:");
+            oskar_log_value(h->log, 'M', 1, "Time step", "%d%s", time_step,
+                    h->beam_interp_time_step == 0 ? " (auto)" : "");
+            oskar_log_value(h->log, 'M', 1, "Beams evaluated", "%.0f",
+                    num_exact);
+            oskar_log_value(h->log, 'M', 1, "Beams interpolated", "%.0f",
+                    num_interp);
+            oskar_log_value(h->log, 'M', 1, "Beams checked", "%.0f",
+                    num_checks);
+            oskar_log_value(h->log, 'M', 1, "Max. relative error", "%.3g",
+                    error_max);
+        }
+        if (h->direct_correlation != 'J')
+        {
+            int num_direct = 0, num_eligible = 0;
+            for (i = 0; i < h->num_devices; ++i)
+            {
+                if (h->d[i].direct_xcorr != 0 || h->d[i].direct_samples[1])
+                    num_eligible++;
+                if (h->d[i].direct_xcorr > 0) num_direct++;
+            }
+            if (num_eligible > 0)
+                oskar_log_message(h->log, 'M', 0, "Direct scalar correlation "
+                        "used on %d of %d devices.", num_direct,
+                        h->num_devices);
+        }
         oskar_log_message(h->log, 'M', 0, "Run completed in %.3f sec.",
                 oskar_timer_elapsed(h->tmr_sim));
 
@@ -106,6 +216,9 @@ void oskar_interferometer_finalise(oskar_Interferometer* h, int* status)
         if (h->vis)
             oskar_binary_write(h->vis, OSKAR_CHAR, OSKAR_TAG_GROUP_RUN,
                     OSKAR_TAG_RUN_LOG, 0, log_size, log_data, status);
+        if (h->bda_file)
+            oskar_binary_write(h->bda_file, OSKAR_CHAR, OSKAR_TAG_GROUP_RUN,
+                    OSKAR_TAG_RUN_LOG, 0, log_size, log_data, status);
         free(log_data);
     }
     else
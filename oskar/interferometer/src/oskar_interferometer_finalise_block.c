@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2020, The OSKAR Developers.
+ * Copyright (c) 2011-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -10,43 +10,77 @@
 
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_mpi.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static oskar_VisBlock* finalise_local_block(oskar_Interferometer* h,
+        int block_index, int* status);
+static void reduce_blocks(oskar_Interferometer* h, int i_buffer, int* status);
+static void send_block(const oskar_Interferometer* h, oskar_VisBlock* block,
+        int* status);
+static oskar_VisBlock* receive_block(oskar_Interferometer* h, int source,
+        int* status);
 static unsigned int disp_width(unsigned int v);
 
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status)
 {
-    int i, i_active;
-    oskar_VisBlock *b0 = 0, *b = 0;
-    if (*status) return 0;
+    int i;
+    oskar_VisBlock *b0 = 0;
 
-    /* The visibilities must be copied back
-     * at the end of the block simulation. */
+    /* Blocks are shared between processes in turn.
+     * Receive the block if it was simulated by another process. */
+    const int source = block_index % h->num_procs;
+    if (*status)
+    {
+        /* Tell the first process this block failed,
+         * so that it does not wait for it forever. */
+        if (source == h->proc_id && h->proc_id > 0)
+            send_block(h, 0, status);
+        return 0;
+    }
+    if (source == h->proc_id)
+        b0 = finalise_local_block(h, block_index, status);
+    else
+        b0 = receive_block(h, source, status);
 
-    /* Combine all vis blocks into the first one. */
-    i_active = (block_index + 1) % 2;
-    b0 = h->d[0].vis_block_cpu[!i_active];
-    if (!h->coords_only)
+    /* Image the block with any attached imagers. */
+    for (i = 0; i < h->num_imagers && h->proc_id == 0; ++i)
+        oskar_imager_update_from_block(h->imagers[i], h->header, b0, status);
+
+    /* Print status message. */
+    if (!*status)
     {
-        oskar_Mem *xc0 = 0, *ac0 = 0;
-        xc0 = oskar_vis_block_cross_correlations(b0);
-        ac0 = oskar_vis_block_auto_correlations(b0);
-        for (i = 1; i < h->num_devices; ++i)
-        {
-            b = h->d[i].vis_block_cpu[!i_active];
-            if (oskar_vis_block_has_cross_correlations(b))
-                oskar_mem_add(xc0, xc0, oskar_vis_block_cross_correlations(b),
-                        0, 0, 0, oskar_mem_length(xc0), status);
-            if (oskar_vis_block_has_auto_correlations(b))
-                oskar_mem_add(ac0, ac0, oskar_vis_block_auto_correlations(b),
-                        0, 0, 0, oskar_mem_length(ac0), status);
-        }
+        const int num_blocks = oskar_interferometer_num_vis_blocks(h);
+        oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
+                "complete. Simulation time elapsed: %.3f s",
+                disp_width(num_blocks), block_index + 1, num_blocks,
+                100.0 * (block_index + 1) / (double)num_blocks,
+                oskar_timer_elapsed(h->tmr_sim));
     }
 
+    /* Return a pointer to the block. */
+    return b0;
+}
+
+static oskar_VisBlock* finalise_local_block(oskar_Interferometer* h,
+        int block_index, int* status)
+{
+    oskar_VisBlock *b0 = 0;
+
+    /* The visibilities must be copied back
+     * at the end of the block simulation. */
+
+    /* Combine all vis blocks into the first one, unless devices own
+     * disjoint time ranges of a single shared block. */
+    const int i_buffer = (block_index / h->num_procs) % 2;
+    b0 = h->d[0].vis_block_cpu[i_buffer];
+    if (!h->coords_only && !h->partition_by_time)
+        reduce_blocks(h, i_buffer, status);
+
     /* Calculate (u,v,w) coordinates for the block. */
     if (oskar_vis_block_has_cross_correlations(b0))
         oskar_telescope_uvw(h->tel, 0, h->ignore_w_components,
@@ -66,19 +100,124 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         oskar_vis_block_add_system_noise(b0, h->header, h->tel,
                 block_index, h->temp, status);
 
-    /* Print status message. */
+    /* Send the block to the first process, which writes all output. */
+    if (h->proc_id > 0)
+        send_block(h, b0, status);
+    return b0;
+}
+
+static void add_block(oskar_VisBlock* dst, const oskar_VisBlock* src,
+        int* status)
+{
+    if (oskar_vis_block_has_cross_correlations(src))
+    {
+        oskar_Mem* xc = oskar_vis_block_cross_correlations(dst);
+        oskar_mem_add(xc, xc, oskar_vis_block_cross_correlations_const(src),
+                0, 0, 0, oskar_mem_length(xc), status);
+    }
+    if (oskar_vis_block_has_auto_correlations(src))
+    {
+        oskar_Mem* ac = oskar_vis_block_auto_correlations(dst);
+        oskar_mem_add(ac, ac, oskar_vis_block_auto_correlations_const(src),
+                0, 0, 0, oskar_mem_length(ac), status);
+    }
+}
+
+/* Sums the host blocks from all devices into the one from device 0,
+ * using a pairwise tree so that the additions at each level can run
+ * in parallel. */
+static void reduce_blocks(oskar_Interferometer* h, int i_buffer, int* status)
+{
+    int stride;
+    const int num_devices = h->num_devices;
+    for (stride = 1; stride < num_devices && !*status; stride *= 2)
+    {
+        int i, error = 0;
+        const int num_pairs = (num_devices - stride + 2 * stride - 1) /
+                (2 * stride);
+#pragma omp parallel for num_threads(num_pairs) private(i)
+        for (i = 0; i < num_devices - stride; i += 2 * stride)
+        {
+            int local_status = 0;
+            add_block(h->d[i].vis_block_cpu[i_buffer],
+                    h->d[i + stride].vis_block_cpu[i_buffer], &local_status);
+            if (local_status) error = local_status;
+        }
+        if (error) *status = error;
+    }
+}
+
+/* Returns the arrays in a block that are sent between processes. */
+static int block_arrays(const oskar_Interferometer* h, oskar_VisBlock* block,
+        oskar_Mem* arrays[8])
+{
+    int i, num_arrays = 0;
+    if (!h->coords_only)
+    {
+        if (oskar_vis_block_has_cross_correlations(block))
+            arrays[num_arrays++] = oskar_vis_block_cross_correlations(block);
+        if (oskar_vis_block_has_auto_correlations(block))
+            arrays[num_arrays++] = oskar_vis_block_auto_correlations(block);
+    }
+    for (i = 0; i < 3; ++i)
+    {
+        arrays[num_arrays++] = oskar_vis_block_station_uvw_metres(block, i);
+        arrays[num_arrays++] = oskar_vis_block_baseline_uvw_metres(block, i);
+    }
+    return num_arrays;
+}
+
+static void send_block(const oskar_Interferometer* h, oskar_VisBlock* block,
+        int* status)
+{
+    int i, dims[5] = {0, 0, 0, 0, 0}, send_status = 0;
+    oskar_Mem* arrays[8];
+
+    /* The header is sent even if this process has failed,
+     * with the error code in place of the block contents. */
+    dims[0] = *status;
     if (!*status)
     {
-        const int num_blocks = oskar_interferometer_num_vis_blocks(h);
-        oskar_log_message(h->log, 'S', 0, "Block %*i/%i (%3.0f%%) "
-                "complete. Simulation time elapsed: %.3f s",
-                disp_width(num_blocks), block_index + 1, num_blocks,
-                100.0 * (block_index + 1) / (double)num_blocks,
-                oskar_timer_elapsed(h->tmr_sim));
+        dims[1] = oskar_vis_block_start_time_index(block);
+        dims[2] = oskar_vis_block_start_channel_index(block);
+        dims[3] = oskar_vis_block_num_times(block);
+        dims[4] = oskar_vis_block_num_channels(block);
     }
+    oskar_mpi_send_int(dims, 5, 0, 0, &send_status);
+    if (*status) return;
+    *status = send_status;
+    const int num_arrays = block_arrays(h, block, arrays);
+    for (i = 0; i < num_arrays; ++i)
+        oskar_mpi_send_mem(arrays[i], oskar_mem_length(arrays[i]),
+                0, 0, status);
+}
 
-    /* Return a pointer to the block. */
-    return b0;
+static oskar_VisBlock* receive_block(oskar_Interferometer* h, int source,
+        int* status)
+{
+    int i, dims[5];
+    oskar_Mem* arrays[8];
+    if (!h->vis_block_recv)
+        h->vis_block_recv = oskar_vis_block_create_from_header(OSKAR_CPU,
+                h->header, status);
+    oskar_VisBlock* block = h->vis_block_recv;
+    oskar_mpi_recv_int(dims, 5, source, 0, status);
+    if (!*status && dims[0])
+    {
+        oskar_log_error(h->log, "Process %d failed with code %d.",
+                source, dims[0]);
+        *status = dims[0];
+    }
+    if (*status) return block;
+    oskar_vis_block_set_start_time_index(block, dims[1]);
+    oskar_vis_block_set_start_channel_index(block, dims[2]);
+    oskar_vis_block_resize(block, dims[3], dims[4],
+            oskar_vis_block_num_stations(block), status);
+    const int num_arrays = block_arrays(h, block, arrays);
+    for (i = 0; i < num_arrays; ++i)
+        oskar_mpi_recv_mem(arrays[i], oskar_mem_length(arrays[i]),
+                source, 0, status);
+    return block;
 }
 
 static unsigned int disp_width(unsigned int v)
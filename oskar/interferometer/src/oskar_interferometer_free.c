@@ -20,7 +20,11 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     if (!h) return;
     oskar_interferometer_reset_cache(h, status);
     for (i = 0; i < h->num_sky_chunks; ++i)
+    {
         oskar_sky_free(h->sky_chunks[i], status);
+        if (h->sky_chunk_index)
+            oskar_sky_index_free(h->sky_chunk_index[i]);
+    }
     oskar_telescope_free(h->tel, status);
     oskar_mem_free(h->temp, status);
     oskar_timer_free(h->tmr_sim);
@@ -29,17 +33,24 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_barrier_free(h->barrier);
     oskar_log_free(h->log);
     free(h->sky_chunks);
+    free(h->sky_chunk_index);
     free(h->gpu_ids);
+    free(h->imagers);
     free(h->vis_name);
     free(h->ms_name);
+    free(h->bda_name);
+    free(h->beam_table_name);
     free(h->settings_path);
+    free(h->model_image_file);
+    free(h->model_image_algorithm);
+    free(h->model_image_units);
     free(h->d);
     free(h);
 }
 
 void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
 {
-    int i;
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -65,8 +76,30 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_mem_free(d->uvw[2], status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
+        for (j = 0; j < d->num_merge; ++j)
+            oskar_sky_free(d->merge[j], status);
+        free(d->merge);
+        oskar_source_tree_free(d->source_tree);
+        oskar_sky_facets_free(d->facets, status);
+        free(d->facet_channel);
+        oskar_mem_free(d->facet_mask, status);
+        for (j = 0; j < 3; ++j)
+        {
+            oskar_mem_free(d->model_station_uvw[j], status);
+            oskar_mem_free(d->model_uvw[j], status);
+        }
+        oskar_mem_free(d->model_vis, status);
+        oskar_mem_free(d->model_block, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
+        oskar_mem_free(d->beam_table_buffer, status);
+        for (j = 0; j < d->beam_interp_num_slots; ++j)
+            oskar_mem_free(d->beam_interp_mask[j], status);
+        oskar_mem_free(d->beam_interp_mask_host, status);
+        free(d->beam_interp_chunk);
+        free(d->beam_interp_key);
+        free(d->beam_interp_num_clip);
+        free(d->beam_interp_mask);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
@@ -80,12 +113,22 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 {
     oskar_interferometer_free_device_data(h, status);
     oskar_binary_free(h->vis);
+    oskar_binary_free(h->bda_file);
+    oskar_vis_bda_free(h->bda, status);
+    oskar_vis_block_free(h->vis_block_recv, status);
     oskar_vis_header_free(h->header, status);
+    oskar_beam_table_free(h->beam_table);
+    oskar_imager_free(h->model_imager, status);
 #ifndef OSKAR_NO_MS
     oskar_ms_close(h->ms);
 #endif
     h->vis = 0;
+    h->bda_file = 0;
+    h->bda = 0;
+    h->vis_block_recv = 0;
     h->header = 0;
+    h->beam_table = 0;
+    h->model_imager = 0;
     h->ms = 0;
 }
 
@@ -4,9 +4,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "utility/oskar_trace.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -37,10 +39,12 @@ static void* run_blocks(void* arg)
     status = ((ThreadArgs*)arg)->status;
 
 #ifdef _OPENMP
-    /* Disable any nested parallelism. */
+    /* Disable any nested parallelism, but allow kernels on CPU devices
+     * to use their share of the available cores. */
     omp_set_nested(0);
-    omp_set_num_threads(1);
+    omp_set_num_threads(device_id >= h->num_gpus ? h->num_cpu_threads : 1);
 #endif
+    oskar_trace_set_context(OSKAR_TRACE_DEVICE, device_id);
 
     /* Loop over visibility blocks, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
@@ -54,17 +58,32 @@ static void* run_blocks(void* arg)
      * data are ready yet) and no simulation is performed for the last loop
      * counter (which corresponds to the last block + 1) as this iteration
      * simply writes the last block.
+     *
+     * If there are multiple processes, they take turns to simulate blocks,
+     * so each loop counter covers one block from each process.
+     * The first process collects and writes all of them, in order.
      */
     const int num_blocks = oskar_interferometer_num_vis_blocks(h);
-    for (b = 0; b < num_blocks + 1; ++b)
+    const int num_procs = h->num_procs, proc_id = h->proc_id;
+    const int num_rounds = (num_blocks + num_procs - 1) / num_procs;
+    for (b = 0; b < num_rounds + 1; ++b)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
-            oskar_interferometer_run_block(h, b, device_id, status);
+        const int i_block = b * num_procs + proc_id;
+        if ((thread_id > 0 || num_threads == 1) && i_block < num_blocks)
+            oskar_interferometer_run_block(h, i_block, device_id, status);
         if (thread_id == 0 && b > 0)
         {
-            oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            int p;
+            for (p = 0; p < num_procs; ++p)
+            {
+                oskar_VisBlock* block;
+                const int i_write = (b - 1) * num_procs + p;
+                if (i_write >= num_blocks) break;
+                if (proc_id > 0 && p != proc_id) continue;
+                oskar_trace_set_context(OSKAR_TRACE_BLOCK, i_write);
+                block = oskar_interferometer_finalise_block(h, i_write, status);
+                oskar_interferometer_write_block(h, block, i_write, status);
+            }
         }
 
         /* Barrier 1: Reset work unit index and print status. */
@@ -79,33 +98,21 @@ static void* run_blocks(void* arg)
 }
 
 
-void oskar_interferometer_run(oskar_Interferometer* h, int* status)
+static void run_threads(oskar_Interferometer* h, int* status)
 {
     int i;
     oskar_Thread** threads = 0;
     ThreadArgs* args = 0;
-    if (*status || !h) return;
-
-    /* Check the visibilities are going somewhere. */
-    if (!h->vis_name
-#ifndef OSKAR_NO_MS
-            && !h->ms_name
-#endif
-    )
+    if (*status)
     {
-        oskar_log_error(h->log, "No output file specified.");
-#ifdef OSKAR_NO_MS
-        if (h->ms_name)
-            oskar_log_error(h->log,
-                    "OSKAR was compiled without Measurement Set support.");
-#endif
-        *status = OSKAR_ERR_FILE_IO;
+        /* Let the first process know this one failed during set-up,
+         * so that it does not wait for blocks from it. */
+        if (h->proc_id > 0 &&
+                h->proc_id < oskar_interferometer_num_vis_blocks(h))
+            oskar_interferometer_finalise_block(h, h->proc_id, status);
         return;
     }
 
-    /* Initialise if required. */
-    oskar_interferometer_check_init(h, status);
-
     /* Set up worker threads. */
     const int num_threads = h->num_devices + 1;
     oskar_barrier_set_num_threads(h->barrier, num_threads);
@@ -132,6 +139,65 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     }
     free(threads);
     free(args);
+}
+
+static int imagers_need_coords_first(const oskar_Interferometer* h)
+{
+    int i;
+    for (i = 0; i < h->num_imagers; ++i)
+    {
+        if (!strcmp(oskar_imager_weighting(h->imagers[i]), "Uniform") ||
+                !strcmp(oskar_imager_weighting(h->imagers[i]), "Briggs") ||
+                !strcmp(oskar_imager_algorithm(h->imagers[i]), "W-projection"))
+            return 1;
+    }
+    return 0;
+}
+
+static void set_coords_only(oskar_Interferometer* h, int value, int* status)
+{
+    int i;
+    oskar_interferometer_set_coords_only(h, value, status);
+    for (i = 0; i < h->num_imagers; ++i)
+        oskar_imager_set_coords_only(h->imagers[i], value);
+}
+
+void oskar_interferometer_run(oskar_Interferometer* h, int* status)
+{
+    if (*status || !h) return;
+
+    /* Check the visibilities are going somewhere. */
+    if (!h->vis_name && !h->bda_name && h->num_imagers == 0
+#ifndef OSKAR_NO_MS
+            && !h->ms_name
+#endif
+    )
+    {
+        oskar_log_error(h->log, "No output file specified.");
+#ifdef OSKAR_NO_MS
+        if (h->ms_name)
+            oskar_log_error(h->log,
+                    "OSKAR was compiled without Measurement Set support.");
+#endif
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+
+    /* Simulate coordinates first, if any imager needs them. */
+    if (!h->coords_only && imagers_need_coords_first(h))
+    {
+        set_coords_only(h, 1, status);
+        oskar_interferometer_check_init(h, status);
+        run_threads(h, status);
+        oskar_interferometer_reset_cache(h, status);
+        set_coords_only(h, 0, status);
+    }
+
+    /* Initialise if required. */
+    oskar_interferometer_check_init(h, status);
+
+    /* Run the simulation. */
+    run_threads(h, status);
 
     /* Finalise. */
     oskar_interferometer_finalise(h, status);
@@ -3,6 +3,8 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include <float.h>
+
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
 
@@ -11,25 +13,91 @@
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_auto_correlate.h"
 #include "correlate/oskar_cross_correlate.h"
+#include "correlate/oskar_cross_correlate_direct.h"
+#include "correlate/oskar_cross_correlate_lod.h"
 #include "interferometer/oskar_evaluate_jones_R.h"
 #include "interferometer/oskar_evaluate_jones_Z.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
+#include "interferometer/oskar_evaluate_jones_chain.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Stations with local sidereal times and latitudes closer than this
+ * share the same source ENU directions. */
+#define STATION_DIRECTION_TOLERANCE_RAD 1e-9
+
+/* Adaptive chunks are merged up to the size at which kernels reach this
+ * fraction of their peak throughput (sources per second). */
+#define ADAPTIVE_CHUNK_EFFICIENCY 0.9
+
+/* Number of measurements needed before the merge threshold is updated. */
+#define ADAPTIVE_CHUNK_MIN_SAMPLES 8
+
+/* Number of timings of each correlation method before choosing one. */
+#define DIRECT_XCORR_MIN_SAMPLES 3
+
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int channel_index_sim, int time_index_sim, int* status);
+static void join_jones_chain(oskar_Interferometer* h, DeviceData* d,
+        int num_sources, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], int time_index_sim, double freq,
+        const oskar_Mem* source_filter, double source_filter_min,
+        double source_filter_max, int* status);
+static void run_time_range(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int block_index, int* status);
+static void run_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status);
+static void simulate_sky(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int device_id, int i_chunk, int i_time,
+        int sim_time_idx, int chan_index_start, int num_chans_block,
+        int* status);
+static void simulate_facets(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status);
+static void simulate_model_image(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status);
+static void flush_merged(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status);
+static void check_beam_cache(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, int i_chunk, int* status);
+static int choose_direct_xcorr(const DeviceData* d);
+static void correlate_direct(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], int time_index_sim,
+        int channel_index_sim, double gast_rad, double freq,
+        int offset_out, int* status);
+static void correlate_jones_chain(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], const oskar_Mem* const src_flux[4],
+        int time_index_sim, int channel_index_sim, double gast_rad,
+        double freq, int offset, int* status);
+static void evaluate_jones_sources(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], const oskar_Mem* const src_flux[4],
+        int time_index_sim, int channel_index_sim, double gast_rad,
+        double freq, int* status);
+static double kernel_time(DeviceData* d);
+static void update_direct_xcorr(DeviceData* d, int direct, int num_sources,
+        double time);
+static void update_merge_threshold(oskar_Interferometer* h, DeviceData* d,
+        int num_sources, double time_per_channel);
 static unsigned int disp_width(unsigned int v);
 
 void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         int device_id, int* status)
 {
     int chan_index_start, chan_index_end, time_index_start, time_index_end;
+    int i_time;
     DeviceData* d;
     if (*status) return;
 
@@ -47,21 +115,29 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->dev_loc, h->gpu_ids[device_id], status);
 
-    /* Clear the visibility block. */
+    /* Devices own disjoint time ranges if partitioning by time. */
     d = &(h->d[device_id]);
+    oskar_trace_set_context(OSKAR_TRACE_BLOCK, block_index);
+    if (h->partition_by_time)
+    {
+        oskar_timer_resume(d->tmr_compute);
+        run_time_range(h, d, device_id, block_index, status);
+        oskar_timer_pause(d->tmr_compute);
+        return;
+    }
+
+    /* Clear the visibility block. */
     oskar_timer_resume(d->tmr_compute);
     oskar_vis_block_clear(d->vis_block, status);
 
     /* Set the visibility block meta-data. */
-    const int total_chunks = h->num_sky_chunks;
+    const int total_chunks = h->num_sky_chunks + (h->model_imager ? 1 : 0);
     const int total_chans = h->num_channels;
     const int total_times = h->num_time_steps;
     const int num_blocks_chan = (total_chans + h->max_channels_per_block - 1) /
             h->max_channels_per_block;
     const int i_block_chan = block_index % num_blocks_chan;
     const int i_block_time = block_index / num_blocks_chan;
-    const double obs_start_mjd = h->time_start_mjd_utc;
-    const double dt_dump_days = h->time_inc_sec / 86400.0;
     chan_index_start = i_block_chan * h->max_channels_per_block;
     chan_index_end = chan_index_start + h->max_channels_per_block - 1;
     time_index_start = i_block_time * h->max_times_per_block;
@@ -83,9 +159,6 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
      * as the simulation for one time and one sky chunk. */
     while (!h->coords_only)
     {
-        oskar_Sky* sky;
-        int i_channel;
-
         oskar_mutex_lock(h->mutex);
         const int i_work_unit = (h->work_unit_index)++;
         oskar_mutex_unlock(h->mutex);
@@ -96,52 +169,805 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         const int i_time       = i_work_unit - i_chunk * num_times_block;
         const int sim_time_idx = time_index_start + i_time;
 
-        /* Copy sky chunk to device only if different from the previous one. */
-        if (i_chunk != d->previous_chunk_index)
+        run_work_unit(h, d, device_id, i_chunk, i_time, sim_time_idx,
+                chan_index_start, num_chans_block, status);
+    }
+
+    /* Simulate any chunks still waiting to be merged. */
+    for (i_time = 0; i_time < num_times_block && d->merge; ++i_time)
+        flush_merged(h, d, device_id, total_chunks - 1, i_time,
+                time_index_start + i_time, chan_index_start, num_chans_block,
+                status);
+
+    /* Copy the visibility block to host memory. */
+    const int i_active = (block_index / h->num_procs) % 2; /* Active buffer. */
+    oskar_timer_resume(d->tmr_copy);
+    oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
+    oskar_timer_pause(d->tmr_copy);
+    oskar_timer_pause(d->tmr_compute);
+}
+
+
+static void run_time_range(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int block_index, int* status)
+{
+    int i_work_unit;
+    oskar_VisBlock* b0;
+
+    /* Get the dimensions of the whole block. */
+    const int total_chunks = h->num_sky_chunks + (h->model_imager ? 1 : 0);
+    const int total_chans = h->num_channels;
+    const int total_times = h->num_time_steps;
+    const int num_blocks_chan = (total_chans + h->max_channels_per_block - 1) /
+            h->max_channels_per_block;
+    const int i_block_chan = block_index % num_blocks_chan;
+    const int i_block_time = block_index / num_blocks_chan;
+    const int chan_index_start = i_block_chan * h->max_channels_per_block;
+    const int time_index_start = i_block_time * h->max_times_per_block;
+    int chan_index_end = chan_index_start + h->max_channels_per_block - 1;
+    int time_index_end = time_index_start + h->max_times_per_block - 1;
+    if (time_index_end >= total_times)
+        time_index_end = total_times - 1;
+    if (chan_index_end >= total_chans)
+        chan_index_end = total_chans - 1;
+    const int num_times_block = 1 + time_index_end - time_index_start;
+    const int num_chans_block = 1 + chan_index_end - chan_index_start;
+    const int num_stations = oskar_vis_block_num_stations(d->vis_block);
+    const int num_baselines = oskar_vis_block_num_baselines(d->vis_block);
+
+    /* Get the range of times owned by this device. */
+    const int t0 = device_id * num_times_block / h->num_devices;
+    const int t1 = (device_id + 1) * num_times_block / h->num_devices;
+    const int num_times_local = t1 - t0;
+
+    /* Size the shared host block, if not already done by another device.
+     * Every time sample is overwritten by its owner, so it is not cleared. */
+    b0 = h->d[0].vis_block_cpu[(block_index / h->num_procs) % 2];
+    oskar_mutex_lock(h->mutex);
+    if (oskar_vis_block_num_times(b0) != num_times_block ||
+            oskar_vis_block_num_channels(b0) != num_chans_block ||
+            oskar_vis_block_start_time_index(b0) != time_index_start ||
+            oskar_vis_block_start_channel_index(b0) != chan_index_start)
+    {
+        oskar_vis_block_resize(b0, num_times_block, num_chans_block,
+                num_stations, status);
+        oskar_vis_block_set_start_time_index(b0, time_index_start);
+        oskar_vis_block_set_start_channel_index(b0, chan_index_start);
+    }
+    oskar_mutex_unlock(h->mutex);
+    if (num_times_local <= 0 || h->coords_only) return;
+
+    /* Set up the device block for the local time range. */
+    oskar_vis_block_resize(d->vis_block, num_times_local, num_chans_block,
+            num_stations, status);
+    oskar_vis_block_clear(d->vis_block, status);
+    oskar_vis_block_set_start_time_index(d->vis_block, time_index_start + t0);
+    oskar_vis_block_set_start_channel_index(d->vis_block, chan_index_start);
+
+    /* Go though all work units in the local time range, chunk by chunk,
+     * so each chunk is copied to the device only once. */
+    for (i_work_unit = 0; i_work_unit < num_times_local * total_chunks;
+            ++i_work_unit)
+    {
+        if (*status) break;
+        const int i_chunk      = i_work_unit / num_times_local;
+        const int i_time       = i_work_unit - i_chunk * num_times_local;
+        const int sim_time_idx = time_index_start + t0 + i_time;
+
+        run_work_unit(h, d, device_id, i_chunk, i_time, sim_time_idx,
+                chan_index_start, num_chans_block, status);
+    }
+
+    /* Simulate any chunks still waiting to be merged. */
+    for (i_work_unit = 0; i_work_unit < num_times_local && d->merge;
+            ++i_work_unit)
+        flush_merged(h, d, device_id, total_chunks - 1, i_work_unit,
+                time_index_start + t0 + i_work_unit, chan_index_start,
+                num_chans_block, status);
+
+    /* Copy the local time range into its place in the shared host block. */
+    oskar_timer_resume(d->tmr_copy);
+    if (oskar_vis_block_has_cross_correlations(b0))
+    {
+        const size_t n = (size_t) num_chans_block * num_baselines;
+        oskar_mem_copy_contents(oskar_vis_block_cross_correlations(b0),
+                oskar_vis_block_cross_correlations(d->vis_block),
+                n * t0, 0, n * num_times_local, status);
+    }
+    if (oskar_vis_block_has_auto_correlations(b0))
+    {
+        const size_t n = (size_t) num_chans_block * num_stations;
+        oskar_mem_copy_contents(oskar_vis_block_auto_correlations(b0),
+                oskar_vis_block_auto_correlations(d->vis_block),
+                n * t0, 0, n * num_times_local, status);
+    }
+    oskar_timer_pause(d->tmr_copy);
+}
+
+
+static void run_work_unit(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status)
+{
+    oskar_Sky* sky;
+
+    /* Copy sky chunk to device only if different from the previous one.
+     * The last work unit for each time predicts the model image. */
+    oskar_trace_set_context(OSKAR_TRACE_TIME, sim_time_idx);
+    oskar_trace_set_context(OSKAR_TRACE_CHUNK, i_chunk);
+    oskar_trace_set_context(OSKAR_TRACE_CHANNEL, -1);
+    if (i_chunk >= h->num_sky_chunks)
+    {
+        if (oskar_vis_block_has_cross_correlations(d->vis_block))
+            simulate_model_image(h, d, device_id, i_chunk, i_time,
+                    sim_time_idx, chan_index_start, num_chans_block, status);
+        oskar_trace_set_context(OSKAR_TRACE_TIME, -1);
+        oskar_trace_set_context(OSKAR_TRACE_CHUNK, -1);
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, -1);
+        return;
+    }
+    if (i_chunk != d->previous_chunk_index)
+    {
+        oskar_timer_resume(d->tmr_copy);
+        oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
+        oskar_timer_pause(d->tmr_copy);
+    }
+    d->previous_chunk_index = i_chunk;
+    sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
+
+    /* Predict the cross-correlations of large chunks from facet grids. */
+    if (d->facets && !oskar_sky_use_extended(d->chunk) &&
+            oskar_sky_num_sources(d->chunk) >= h->facet_min_sources &&
+            oskar_vis_block_has_cross_correlations(d->vis_block))
+    {
+        simulate_facets(h, d, device_id, i_chunk, i_time, sim_time_idx,
+                chan_index_start, num_chans_block, status);
+        oskar_trace_set_context(OSKAR_TRACE_TIME, -1);
+        oskar_trace_set_context(OSKAR_TRACE_CHUNK, -1);
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, -1);
+        return;
+    }
+
+    /* Apply horizon clip if required. */
+    if (h->apply_horizon_clip)
+    {
+        double gast, mjd;
+        mjd = h->time_start_mjd_utc +
+                (h->time_inc_sec / 86400.0) * (sim_time_idx + 0.5);
+        gast = oskar_convert_mjd_to_gast_fast(mjd);
+        oskar_timer_resume(d->tmr_clip);
+        oskar_sky_horizon_clip_indexed(d->chunk_clip, d->chunk,
+                h->sky_chunk_index ? h->sky_chunk_index[i_chunk] : 0,
+                d->tel, gast, d->station_work, status);
+        oskar_timer_pause(d->tmr_clip);
+    }
+
+    /* If using adaptive chunks, collect small chunks for this time
+     * in the merge buffer, and simulate them together once it is full.
+     * Each work unit is claimed by only one device, so the buffer
+     * can be local to the device. */
+    const int num_sources = oskar_sky_num_sources(sky);
+    if (d->merge && num_sources < d->merge_min_sources)
+    {
+        oskar_Sky* merged = d->merge[i_time];
+        if (oskar_sky_num_sources(merged) + num_sources >
+                h->max_sources_per_chunk)
+            flush_merged(h, d, device_id, i_chunk, i_time, sim_time_idx,
+                    chan_index_start, num_chans_block, status);
+        oskar_timer_resume(d->tmr_copy);
+        oskar_sky_append(merged, sky, status);
+        oskar_timer_pause(d->tmr_copy);
+        if (oskar_sky_num_sources(merged) >= d->merge_min_sources)
+            flush_merged(h, d, device_id, i_chunk, i_time, sim_time_idx,
+                    chan_index_start, num_chans_block, status);
+    }
+    else
+    {
+        simulate_sky(h, d, sky, device_id, i_chunk, i_time, sim_time_idx,
+                chan_index_start, num_chans_block, status);
+    }
+    oskar_trace_set_context(OSKAR_TRACE_TIME, -1);
+    oskar_trace_set_context(OSKAR_TRACE_CHUNK, -1);
+    oskar_trace_set_context(OSKAR_TRACE_CHANNEL, -1);
+}
+
+
+static void simulate_facets(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status)
+{
+    int i_channel;
+    const int total_chunks = h->num_sky_chunks + (h->model_imager ? 1 : 0);
+    const int total_chans = h->num_channels;
+    const int total_times = h->num_time_steps;
+    const int num_baselines = oskar_telescope_num_baselines(d->tel);
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const double dt_dump_days = h->time_inc_sec / 86400.0;
+    const double t_start = h->time_start_mjd_utc;
+    const double t_dump = t_start + dt_dump_days * (sim_time_idx + 0.5);
+    const double gast_rad = oskar_convert_mjd_to_gast_fast(t_dump);
+    const int has_auto = oskar_vis_block_has_auto_correlations(d->vis_block);
+    int remake = (i_chunk != d->facet_chunk_index);
+    oskar_Sky* sky = d->chunk;
+    oskar_station_work_set_direction_cache(d->station_work, num_stations,
+            STATION_DIRECTION_TOLERANCE_RAD);
+
+    /* Apply horizon clip if required. The facets must be made again
+     * if the sources above the horizon have changed. */
+    if (h->apply_horizon_clip)
+    {
+        oskar_timer_resume(d->tmr_clip);
+        oskar_sky_horizon_clip_indexed(d->chunk_clip, d->chunk,
+                h->sky_chunk_index ? h->sky_chunk_index[i_chunk] : 0,
+                d->tel, gast_rad, d->station_work, status);
+        oskar_timer_pause(d->tmr_clip);
+        const oskar_Mem* mask =
+                oskar_station_work_horizon_mask(d->station_work);
+        if (remake || oskar_mem_different(mask, d->facet_mask,
+                oskar_sky_num_sources(d->chunk), status))
         {
-            oskar_timer_resume(d->tmr_copy);
-            oskar_sky_copy(d->chunk, h->sky_chunks[i_chunk], status);
-            oskar_timer_pause(d->tmr_copy);
+            oskar_mem_copy(d->facet_mask, mask, status);
+            remake = 1;
         }
-        sky = h->apply_horizon_clip ? d->chunk_clip : d->chunk;
+        sky = d->chunk_clip;
+    }
+
+    /* Divide the chunk into facets, if not already done.
+     * The grids for each channel in the block are kept for later times. */
+    if (remake)
+    {
+        oskar_timer_resume(d->tmr_correlate);
+        oskar_sky_facets_set_up(d->facets, sky, h->facet_size_rad,
+                h->facet_cell_size_rad,
+                oskar_type_is_matrix(oskar_jones_type(d->J)),
+                h->max_channels_per_block, status);
+        oskar_timer_pause(d->tmr_correlate);
+        for (i_channel = 0; i_channel < h->max_channels_per_block;
+                ++i_channel)
+            d->facet_channel[i_channel] = -1;
+        d->facet_chunk_index = *status ? -1 : i_chunk;
+
+        /* Station beams at the facet centres are cached for
+         * interpolation in time, so do not use any from other facets. */
+        d->facet_beam_key = ++d->beam_interp_next_key;
+    }
+    oskar_station_work_set_beam_time_interp_key(d->station_work,
+            d->facet_beam_key);
+    const int num_facets = oskar_sky_facets_num_facets(d->facets);
+    const oskar_Mem* const facet_lmn[] = {
+            oskar_sky_facets_lmn_const(d->facets, 0),
+            oskar_sky_facets_lmn_const(d->facets, 1),
+            oskar_sky_facets_lmn_const(d->facets, 2)
+    };
 
-        /* Apply horizon clip if required. */
-        if (h->apply_horizon_clip)
+    /* Get true station (u,v,w) coordinates. */
+    oskar_telescope_uvw(d->tel, 1, 0, 1, t_start, dt_dump_days,
+            sim_time_idx, d->uvw[0], d->uvw[1], d->uvw[2],
+            0, 0, 0, status);
+    const oskar_Mem* const uvw[] = { d->uvw[0], d->uvw[1], d->uvw[2] };
+
+    /* The auto-correlations are not predicted from the facets, as they
+     * need the station beam in the direction of each source. */
+    for (i_channel = 0; i_channel < num_chans_block && has_auto; ++i_channel)
+    {
+        const int num_src = oskar_sky_num_sources(sky);
+        if (*status || num_src == 0) break;
+        const int sim_chan_idx = chan_index_start + i_channel;
+        const double freq = h->freq_start_hz + sim_chan_idx * h->freq_inc_hz;
+        const int offset = num_chans_block * i_time + i_channel;
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, sim_chan_idx);
+        oskar_sky_scale_flux_with_frequency(sky, freq, status);
+        const oskar_Mem* const src_flux[] = {
+                oskar_sky_I_const(sky),
+                oskar_sky_Q_const(sky),
+                oskar_sky_U_const(sky),
+                oskar_sky_V_const(sky)
+        };
+        const oskar_Mem* const src_lmn[] = {
+                oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky),
+                oskar_sky_n_const(sky)
+        };
+        evaluate_jones_sources(h, d, sky, src_lmn, uvw, src_flux,
+                sim_time_idx, sim_chan_idx, gast_rad, freq, status);
+        oskar_timer_resume(d->tmr_correlate);
+        oskar_auto_correlate(num_src, d->J, src_flux, num_stations * offset,
+                oskar_vis_block_auto_correlations(d->vis_block), status);
+        oskar_timer_pause(d->tmr_correlate);
+    }
+
+    /* Simulate all baselines for all channels for this time. */
+    for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    {
+        if (*status || num_facets == 0) break;
+        const int sim_chan_idx = chan_index_start + i_channel;
+        const double freq = h->freq_start_hz + sim_chan_idx * h->freq_inc_hz;
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, sim_chan_idx);
+        oskar_mutex_lock(h->mutex);
+        oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                "Chunk %*i/%i, Channel %*i/%i [Device %i, %i facets]",
+                disp_width(total_times), sim_time_idx + 1, total_times,
+                disp_width(total_chunks), i_chunk + 1, total_chunks,
+                disp_width(total_chans), sim_chan_idx + 1, total_chans,
+                device_id, num_facets);
+        oskar_mutex_unlock(h->mutex);
+
+        /* Make the grids for this channel, if not already done. */
+        if (d->facet_channel[i_channel] != sim_chan_idx)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
-            oskar_timer_resume(d->tmr_clip);
-            oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
-                    d->station_work, status);
-            oskar_timer_pause(d->tmr_clip);
+            oskar_timer_resume(d->tmr_correlate);
+            oskar_sky_scale_flux_with_frequency(sky, freq, status);
+            oskar_sky_facets_update(d->facets, sky, i_channel,
+                    h->source_min_jy, h->source_max_jy, status);
+            oskar_timer_pause(d->tmr_correlate);
+            d->facet_channel[i_channel] = *status ? -1 : sim_chan_idx;
         }
+        const oskar_Mem* const facet_flux[] = {
+                oskar_sky_facets_stokes_const(d->facets, i_channel, 0),
+                oskar_sky_facets_stokes_const(d->facets, i_channel, 1),
+                oskar_sky_facets_stokes_const(d->facets, i_channel, 2),
+                oskar_sky_facets_stokes_const(d->facets, i_channel, 3)
+        };
+
+        /* Evaluate the Jones matrices at the facet centres. */
+        if (d->R)
+            oskar_jones_set_size(d->R, num_stations, num_facets, status);
+        oskar_jones_set_size(d->J, num_stations, num_facets, status);
+        oskar_jones_set_size(d->E, num_stations, num_facets, status);
+        oskar_timer_resume(d->tmr_E);
+        if (h->beam_table)
+            oskar_beam_table_evaluate(h->beam_table, d->E, num_facets,
+                    facet_lmn, oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), d->tel, sim_time_idx,
+                    gast_rad, sim_chan_idx, freq, d->station_work,
+                    d->beam_table_buffer, &d->beam_table_buffer_index,
+                    status);
+        else
+            oskar_evaluate_jones_E(d->E, OSKAR_COORDS_REL_DIR, num_facets,
+                    facet_lmn, oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), d->tel, sim_time_idx,
+                    gast_rad, freq, d->station_work, status);
+        if (d->R)
+            oskar_evaluate_jones_R(d->R, num_facets,
+                    oskar_sky_facets_ra_rad_const(d->facets),
+                    oskar_sky_facets_dec_rad_const(d->facets),
+                    d->tel, gast_rad, status);
+        oskar_timer_pause(d->tmr_E);
+        join_jones_chain(h, d, num_facets, facet_lmn, uvw, sim_time_idx,
+                freq, facet_flux[0], -DBL_MAX, DBL_MAX, status);
+
+        /* Predict the cross-correlations from the facet grids. */
+        const int offset = num_chans_block * i_time + i_channel;
+        oskar_timer_resume(d->tmr_correlate);
+        oskar_sky_facets_predict(d->facets, i_channel, d->J, d->tel, uvw,
+                gast_rad, freq, h->ignore_w_components,
+                num_baselines * offset,
+                oskar_vis_block_cross_correlations(d->vis_block),
+                &d->facet_error_max, status);
+        oskar_timer_pause(d->tmr_correlate);
+    }
+    d->facet_work_units += 1.0;
+}
+
+
+#define OSKAR_ADD_MODEL_VIS(FP, IS_MATRIX, IN, OUT, NUM) {\
+        int b;\
+        const FP* in_ = (const FP*) (IN);\
+        FP* out_ = (FP*) (OUT);\
+        for (b = 0; b < (NUM); ++b)\
+        {\
+            if (IS_MATRIX)\
+            {\
+                out_[8 * b + 0] = out_[8 * b + 6] = in_[2 * b];\
+                out_[8 * b + 1] = out_[8 * b + 7] = in_[2 * b + 1];\
+            }\
+            else\
+            {\
+                out_[2 * b + 0] = in_[2 * b];\
+                out_[2 * b + 1] = in_[2 * b + 1];\
+            }\
+        }\
+    }
+
+
+static void simulate_model_image(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status)
+{
+    int i, i_channel;
+    double uvw_scale = 1.0;
+    const int total_chunks = h->num_sky_chunks + 1;
+    const int total_chans = h->num_channels;
+    const int total_times = h->num_time_steps;
+    const int num_baselines = oskar_telescope_num_baselines(d->tel);
+    const int is_matrix = oskar_mem_is_matrix(d->model_block);
+    const double dt_dump_days = h->time_inc_sec / 86400.0;
+    oskar_Mem* xc = oskar_vis_block_cross_correlations(d->vis_block);
+
+    /* Model image visibilities are predicted on the host from the true
+     * baseline (u,v,w) coordinates, in metres, for this time. */
+    oskar_timer_resume(d->tmr_correlate);
+    oskar_telescope_uvw(h->tel, 1, 0, 1, h->time_start_mjd_utc,
+            dt_dump_days, sim_time_idx, d->model_station_uvw[0],
+            d->model_station_uvw[1], d->model_station_uvw[2],
+            d->model_uvw[0], d->model_uvw[1], d->model_uvw[2], status);
+    oskar_timer_pause(d->tmr_correlate);
+    for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    {
+        if (*status) break;
+        const int sim_chan_idx = chan_index_start + i_channel;
+        const double freq = h->freq_start_hz + sim_chan_idx * h->freq_inc_hz;
+        const double scale = pow(freq / h->model_image_freq_hz,
+                h->model_image_spectral_index);
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, sim_chan_idx);
+        oskar_mutex_lock(h->mutex);
+        oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                "Chunk %*i/%i, Channel %*i/%i [Device %i, model image]",
+                disp_width(total_times), sim_time_idx + 1, total_times,
+                disp_width(total_chunks), i_chunk + 1, total_chunks,
+                disp_width(total_chans), sim_chan_idx + 1, total_chans,
+                device_id);
+        oskar_mutex_unlock(h->mutex);
+
+        /* Convert to wavelengths, predict, and scale to this frequency. */
+        oskar_timer_resume(d->tmr_correlate);
+        for (i = 0; i < 3; ++i)
+            oskar_mem_scale_real(d->model_uvw[i],
+                    (freq / 299792458.0) / uvw_scale, 0, num_baselines, status);
+        uvw_scale = freq / 299792458.0;
+        oskar_imager_predict(h->model_imager, num_baselines,
+                d->model_uvw[0], d->model_uvw[1], d->model_uvw[2],
+                d->model_vis, status);
+        oskar_mem_scale_real(d->model_vis, scale, 0, num_baselines, status);
+
+        /* Add the Stokes I visibilities to the XX and YY correlations. */
+        if (oskar_mem_precision(d->model_vis) == OSKAR_DOUBLE)
+            OSKAR_ADD_MODEL_VIS(double, is_matrix,
+                    oskar_mem_void_const(d->model_vis),
+                    oskar_mem_void(d->model_block), num_baselines)
+        else
+            OSKAR_ADD_MODEL_VIS(float, is_matrix,
+                    oskar_mem_void_const(d->model_vis),
+                    oskar_mem_void(d->model_block), num_baselines)
+        const int offset = num_chans_block * i_time + i_channel;
+        oskar_mem_add(xc, xc, d->model_block, num_baselines * offset,
+                num_baselines * offset, 0, num_baselines, status);
+        oskar_timer_pause(d->tmr_correlate);
+    }
+}
+
+
+static void flush_merged(oskar_Interferometer* h, DeviceData* d,
+        int device_id, int i_chunk, int i_time, int sim_time_idx,
+        int chan_index_start, int num_chans_block, int* status)
+{
+    oskar_Sky* merged = d->merge[i_time];
+    if (oskar_sky_num_sources(merged) == 0) return;
+    simulate_sky(h, d, merged, device_id, i_chunk, i_time, sim_time_idx,
+            chan_index_start, num_chans_block, status);
+    oskar_sky_set_num_sources(merged, 0, status);
+    oskar_sky_set_use_extended(merged, 0);
+}
+
+
+static void simulate_sky(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int device_id, int i_chunk, int i_time,
+        int sim_time_idx, int chan_index_start, int num_chans_block,
+        int* status)
+{
+    int i_channel;
+    const int total_chunks = h->num_sky_chunks + (h->model_imager ? 1 : 0);
+    const int total_chans = h->num_channels;
+    const int total_times = h->num_time_steps;
+    const double start_time = d->merge ? kernel_time(d) : 0.0;
+
+    /* Source directions depend only on the time and the sky model, so
+     * compute them once here for all channels. The station beam keeps the
+     * ENU directions for each station position until the next call. */
+    oskar_station_work_set_direction_cache(d->station_work,
+            oskar_telescope_num_stations(d->tel),
+            STATION_DIRECTION_TOLERANCE_RAD);
+    if (oskar_telescope_phase_centre_coord_type(d->tel) == OSKAR_COORDS_AZEL)
+    {
+        /* Calculate ENU source direction cosines for array centre. */
+        const double gast_rad = oskar_convert_mjd_to_gast_fast(
+                h->time_start_mjd_utc +
+                (h->time_inc_sec / 86400.0) * (sim_time_idx + 0.5));
+        const double lst_rad = gast_rad + oskar_telescope_lon_rad(d->tel);
+        oskar_convert_apparent_ra_dec_to_enu_directions(
+                oskar_sky_num_sources(sky),
+                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+                lst_rad, oskar_telescope_lat_rad(d->tel),
+                0, d->lmn[0], d->lmn[1], d->lmn[2], status);
+    }
 
-        /* Simulate all baselines for all channels for this time and chunk. */
-        for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    /* Discard station beams cached for other sources. */
+    check_beam_cache(h, d, sky, i_chunk, status);
+
+    /* Build the source tree for level-of-detail correlation, which also
+     * depends only on the source directions. Extended sources are
+     * correlated exactly. */
+    d->use_source_tree = 0;
+    if (d->source_tree && !oskar_sky_use_extended(sky) &&
+            oskar_vis_block_has_cross_correlations(d->vis_block))
+    {
+        const oskar_Mem* dir[3];
+        const int azel = oskar_telescope_phase_centre_coord_type(d->tel) ==
+                OSKAR_COORDS_AZEL;
+        dir[0] = azel ? d->lmn[0] : oskar_sky_l_const(sky);
+        dir[1] = azel ? d->lmn[1] : oskar_sky_m_const(sky);
+        dir[2] = azel ? d->lmn[2] : oskar_sky_n_const(sky);
+        oskar_timer_resume(d->tmr_correlate);
+        oskar_source_tree_build(d->source_tree,
+                oskar_sky_num_sources(sky), dir, status);
+        oskar_timer_pause(d->tmr_correlate);
+        d->use_source_tree = 1;
+    }
+
+    /* Simulate all baselines for all channels for this time and sky. */
+    for (i_channel = 0; i_channel < num_chans_block; ++i_channel)
+    {
+        if (*status) break;
+        const int sim_chan_idx = chan_index_start + i_channel;
+        oskar_trace_set_context(OSKAR_TRACE_CHANNEL, sim_chan_idx);
+        oskar_mutex_lock(h->mutex);
+        oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
+                "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
+                disp_width(total_times), sim_time_idx + 1, total_times,
+                disp_width(total_chunks), i_chunk + 1, total_chunks,
+                disp_width(total_chans), sim_chan_idx + 1, total_chans,
+                device_id, oskar_sky_num_sources(sky));
+        oskar_mutex_unlock(h->mutex);
+        sim_baselines(h, d, sky, i_channel, i_time,
+                sim_chan_idx, sim_time_idx, status);
+    }
+
+    /* Record the kernel time, to find the best size for merged chunks. */
+    if (d->merge && num_chans_block > 0 && !*status)
+        update_merge_threshold(h, d, oskar_sky_num_sources(sky),
+                (kernel_time(d) - start_time) / num_chans_block);
+}
+
+
+static double kernel_time(DeviceData* d)
+{
+    return oskar_timer_elapsed(d->tmr_E) + oskar_timer_elapsed(d->tmr_K) +
+            oskar_timer_elapsed(d->tmr_join) +
+            oskar_timer_elapsed(d->tmr_correlate);
+}
+
+
+static void check_beam_cache(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, int i_chunk, int* status)
+{
+    /* Station beams are cached for interpolation in time against the
+     * address of the source coordinates and a key, which must change if
+     * different sources are stored there. The clipped chunk holds the
+     * same sources only if the horizon mask has not changed. Each slot
+     * keeps the key of the beams for one chunk. */
+    if (!h->beam_interp_enabled || *status) return;
+    if (sky != d->chunk && sky != d->chunk_clip)
+    {
+        /* Merged chunks are not kept. */
+        oskar_station_work_set_beam_time_interp_key(d->station_work,
+                ++d->beam_interp_next_key);
+        return;
+    }
+    const int slot = (d->beam_interp_num_slots > 1) ? i_chunk : 0;
+    int changed = (d->beam_interp_chunk[slot] != i_chunk);
+    if (sky == d->chunk_clip)
+    {
+        const int num_sources = oskar_sky_num_sources(d->chunk);
+        const int num_clip = oskar_sky_num_sources(d->chunk_clip);
+        const oskar_Mem* mask =
+                oskar_station_work_horizon_mask(d->station_work);
+        oskar_Mem* stored = d->beam_interp_mask[slot];
+        if (num_clip != d->beam_interp_num_clip[slot])
+            changed = 1;
+        else if (!changed && num_clip < num_sources)
         {
-            if (*status) break;
-            const int sim_chan_idx = chan_index_start + i_channel;
-            oskar_mutex_lock(h->mutex);
-            oskar_log_message(h->log, 'S', 1, "Time %*i/%i, "
-                    "Chunk %*i/%i, Channel %*i/%i [Device %i, %i sources]",
-                    disp_width(total_times), sim_time_idx + 1, total_times,
-                    disp_width(total_chunks), i_chunk + 1, total_chunks,
-                    disp_width(total_chans), sim_chan_idx + 1, total_chans,
-                    device_id, oskar_sky_num_sources(sky));
-            oskar_mutex_unlock(h->mutex);
-            sim_baselines(h, d, sky, i_channel, i_time,
-                    sim_chan_idx, sim_time_idx, status);
+            /* Compare masks only if they can differ, and on the host. */
+            if (oskar_mem_location(mask) != OSKAR_CPU)
+            {
+                oskar_mem_copy(d->beam_interp_mask_host, mask, status);
+                mask = d->beam_interp_mask_host;
+            }
+            changed = oskar_mem_different(mask, stored, num_sources, status);
+        }
+        if (changed)
+        {
+            oskar_mem_copy(stored, mask, status);
+            d->beam_interp_num_clip[slot] = num_clip;
         }
-        d->previous_chunk_index = i_chunk;
     }
+    else if (changed)
+        d->beam_interp_num_clip[slot] = -1;
+    if (changed)
+    {
+        d->beam_interp_key[slot] = ++d->beam_interp_next_key;
+        d->beam_interp_chunk[slot] = *status ? -1 : i_chunk;
+    }
+    oskar_station_work_set_beam_time_interp_key(d->station_work,
+            d->beam_interp_key[slot]);
+}
 
-    /* Copy the visibility block to host memory. */
-    const int i_active = block_index % 2; /* Index of the active buffer. */
-    oskar_timer_resume(d->tmr_copy);
-    oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
-    oskar_timer_pause(d->tmr_copy);
-    oskar_timer_pause(d->tmr_compute);
+
+static int choose_direct_xcorr(const DeviceData* d)
+{
+    /* Direct correlation is not compatible with the source tree. */
+    if (d->direct_xcorr == 0 || d->use_source_tree) return 0;
+    if (d->direct_xcorr > 0) return 1;
+
+    /* Still undecided, so alternate between the two methods. */
+    return d->direct_samples[1] < d->direct_samples[0];
+}
+
+
+static void update_direct_xcorr(DeviceData* d, int direct, int num_sources,
+        double time)
+{
+    /* Keep the fastest time per source seen for each method, which
+     * excludes the cost of warming up caches or compiling kernels. */
+    const double time_per_source = time / num_sources;
+    if (d->direct_samples[direct] == 0 ||
+            time_per_source < d->direct_time[direct])
+        d->direct_time[direct] = time_per_source;
+    d->direct_samples[direct]++;
+    if (d->direct_samples[0] < DIRECT_XCORR_MIN_SAMPLES ||
+            d->direct_samples[1] < DIRECT_XCORR_MIN_SAMPLES)
+        return;
+    d->direct_xcorr = (d->direct_time[1] < d->direct_time[0]) ? 1 : 0;
+}
+
+
+static void update_merge_threshold(oskar_Interferometer* h, DeviceData* d,
+        int num_sources, double time_per_channel)
+{
+    /* Fit time = a + b * num_sources, by least squares. The throughput
+     * reaches the target fraction E of its peak (1 / b) at the size
+     * a / b * E / (1 - E), which is used as the merge threshold. */
+    d->fit_count++;
+    d->fit_n += num_sources;
+    d->fit_t += time_per_channel;
+    d->fit_nn += (double)num_sources * num_sources;
+    d->fit_nt += num_sources * time_per_channel;
+    if (d->fit_count < ADAPTIVE_CHUNK_MIN_SAMPLES) return;
+    const double det = d->fit_count * d->fit_nn - d->fit_n * d->fit_n;
+    if (det <= 0.0) return;
+    const double b = (d->fit_count * d->fit_nt - d->fit_n * d->fit_t) / det;
+    const double a = (d->fit_t - b * d->fit_n) / d->fit_count;
+    if (b <= 0.0 || a < 0.0) return;
+    double n = (a / b) * ADAPTIVE_CHUNK_EFFICIENCY /
+            (1.0 - ADAPTIVE_CHUNK_EFFICIENCY);
+    if (n > h->max_sources_per_chunk) n = h->max_sources_per_chunk;
+    if (n < 1.0) n = 1.0;
+    d->merge_min_sources = (int) n;
+}
+
+
+static void join_jones_chain(oskar_Interferometer* h, DeviceData* d,
+        int num_sources, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], int time_index_sim, double freq,
+        const oskar_Mem* source_filter, double source_filter_min,
+        double source_filter_max, int* status)
+{
+    /* Evaluate station gains, if a gain model exists. */
+    const oskar_Gains* gains = oskar_telescope_gains_const(d->tel);
+    const int use_gains = oskar_gains_defined(gains);
+    if (use_gains)
+        oskar_gains_evaluate(gains, time_index_sim, freq, d->gains, status);
+
+    /* Form J = G * K * E * R, from Jones E and R already evaluated. */
+    if (h->fuse_jones)
+    {
+        /* Compute Jones K on the fly, without storing it. */
+        oskar_timer_resume(d->tmr_K);
+        oskar_evaluate_jones_chain(d->J, num_sources,
+                lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2], freq,
+                source_filter, source_filter_min, source_filter_max,
+                h->ignore_w_components, d->E, d->R,
+                use_gains ? d->gains : 0, status);
+        oskar_timer_pause(d->tmr_K);
+        return;
+    }
+
+    /* Staged evaluation: store each Jones term, then join them. */
+    oskar_jones_set_size(d->K, oskar_jones_num_stations(d->J), num_sources,
+            status);
+    if (d->R)
+    {
+        oskar_timer_resume(d->tmr_join);
+        oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_timer_pause(d->tmr_join);
+    }
+    oskar_timer_resume(d->tmr_K);
+    oskar_evaluate_jones_K(d->K, num_sources,
+            lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2], freq,
+            source_filter, source_filter_min, source_filter_max,
+            h->ignore_w_components, status);
+    oskar_timer_pause(d->tmr_K);
+    oskar_timer_resume(d->tmr_join);
+    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
+    if (use_gains)
+        oskar_jones_apply_station_gains(d->J, d->gains, status);
+    oskar_timer_pause(d->tmr_join);
+}
+
+
+static void correlate_direct(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], int time_index_sim,
+        int channel_index_sim, double gast_rad, double freq,
+        int offset_out, int* status)
+{
+    const oskar_Jones* beam = d->E;
+    const oskar_Mem* factor = 0;
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const int num_src = oskar_sky_num_sources(sky);
+    const oskar_Mem* const source_coords[] = {
+            oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky),
+            oskar_sky_n_const(sky)
+    };
+    const oskar_Mem* const src_extended[] = {
+            oskar_sky_gaussian_a_const(sky),
+            oskar_sky_gaussian_b_const(sky),
+            oskar_sky_gaussian_c_const(sky)
+    };
+
+    /* Evaluate station gains, if a gain model exists. */
+    const oskar_Gains* gains = oskar_telescope_gains_const(d->tel);
+    const int use_gains = oskar_gains_defined(gains);
+    if (use_gains)
+    {
+        oskar_gains_evaluate(gains, time_index_sim, freq, d->gains, status);
+        factor = d->gains;
+    }
+
+    /* Evaluate station beams. Isotropic stations have the same beam
+     * (1, or 0 if below the horizon) for every source, so this is
+     * evaluated for one source only and applied as a station factor. */
+    oskar_timer_resume(d->tmr_E);
+    if (h->isotropic_stations && !h->beam_table)
+    {
+        oskar_jones_set_size(d->E, num_stations, 1, status);
+        oskar_evaluate_jones_E(d->E, OSKAR_COORDS_REL_DIR, 1,
+                source_coords, oskar_sky_reference_ra_rad(sky),
+                oskar_sky_reference_dec_rad(sky), d->tel, time_index_sim,
+                gast_rad, freq, d->station_work, status);
+        if (use_gains)
+            oskar_mem_multiply(d->gains, d->gains, oskar_jones_mem(d->E),
+                    0, 0, 0, num_stations, status);
+        else
+            factor = oskar_jones_mem_const(d->E);
+        beam = 0;
+    }
+    else
+    {
+        oskar_jones_set_size(d->E, num_stations, num_src, status);
+        if (h->beam_table)
+            oskar_beam_table_evaluate(h->beam_table, d->E, num_src,
+                    source_coords, oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), d->tel,
+                    time_index_sim, gast_rad, channel_index_sim, freq,
+                    d->station_work, d->beam_table_buffer,
+                    &d->beam_table_buffer_index, status);
+        else
+            oskar_evaluate_jones_E(d->E, OSKAR_COORDS_REL_DIR, num_src,
+                    source_coords, oskar_sky_reference_ra_rad(sky),
+                    oskar_sky_reference_dec_rad(sky), d->tel,
+                    time_index_sim, gast_rad, freq, d->station_work, status);
+    }
+    oskar_timer_pause(d->tmr_E);
+
+    /* Correlate, evaluating the interferometer phase on each baseline. */
+    oskar_timer_resume(d->tmr_correlate);
+    oskar_cross_correlate_direct(oskar_sky_use_extended(sky), num_src,
+            beam, factor, oskar_sky_I_const(sky), lmn, src_extended,
+            h->source_min_jy, h->source_max_jy, d->tel, uvw, gast_rad, freq,
+            offset_out, oskar_vis_block_cross_correlations(d->vis_block),
+            status);
+    oskar_timer_pause(d->tmr_correlate);
 }
 
 
@@ -151,7 +977,6 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 {
     /* Get dimensions. */
     const int num_baselines   = oskar_telescope_num_baselines(d->tel);
-    const int num_stations    = oskar_telescope_num_stations(d->tel);
     const int num_src         = oskar_sky_num_sources(sky);
     const int num_times_block = oskar_vis_block_num_times(d->vis_block);
     const int num_chans_block = oskar_vis_block_num_channels(d->vis_block);
@@ -192,14 +1017,7 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     const oskar_Mem* lmn[3];
     if (oskar_telescope_phase_centre_coord_type(d->tel) == OSKAR_COORDS_AZEL)
     {
-        /* Calculate ENU source direction cosines for array centre. */
-        const double lst_rad = gast_rad + oskar_telescope_lon_rad(d->tel);
-        oskar_convert_apparent_ra_dec_to_enu_directions(num_src,
-                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
-                lst_rad, oskar_telescope_lat_rad(d->tel),
-                0, d->lmn[0], d->lmn[1], d->lmn[2], status);
-
-        /* Reference direction cosine scratch arrays. */
+        /* Reference ENU direction cosines computed for this work unit. */
         lmn[0] = d->lmn[0];
         lmn[1] = d->lmn[1];
         lmn[2] = d->lmn[2];
@@ -212,12 +1030,38 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         lmn[2] = oskar_sky_n_const(sky);
     }
 
+    /* Correlate scalar visibilities directly if chosen, or form the
+     * Jones chain. Both methods are timed until the faster is known. */
+    const int offset = num_chans_block * time_index_block + channel_index_block;
+    const int direct = choose_direct_xcorr(d);
+    const int timing = d->direct_xcorr < 0 && !d->use_source_tree;
+    const double start_time = timing ? kernel_time(d) : 0.0;
+    if (direct)
+        correlate_direct(h, d, sky, lmn, uvw, time_index_sim,
+                channel_index_sim, gast_rad, freq, num_baselines * offset,
+                status);
+    else
+        correlate_jones_chain(h, d, sky, lmn, uvw, src_flux, time_index_sim,
+                channel_index_sim, gast_rad, freq, offset, status);
+    if (timing && !*status)
+        update_direct_xcorr(d, direct, num_src, kernel_time(d) - start_time);
+}
+
+
+static void evaluate_jones_sources(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], const oskar_Mem* const src_flux[4],
+        int time_index_sim, int channel_index_sim, double gast_rad,
+        double freq, int* status)
+{
+    const int num_stations  = oskar_telescope_num_stations(d->tel);
+    const int num_src       = oskar_sky_num_sources(sky);
+
     /* Set dimensions of Jones matrices. */
     if (d->R)
         oskar_jones_set_size(d->R, num_stations, num_src, status);
     oskar_jones_set_size(d->J, num_stations, num_src, status);
     oskar_jones_set_size(d->E, num_stations, num_src, status);
-    oskar_jones_set_size(d->K, num_stations, num_src, status);
 
     /* Evaluate station beam (Jones E: may be matrix). */
     const oskar_Mem* const source_coords[] = {
@@ -226,13 +1070,20 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             oskar_sky_n_const(sky)
     };
     oskar_timer_resume(d->tmr_E);
-    oskar_evaluate_jones_E(d->E, OSKAR_COORDS_REL_DIR, num_src, source_coords,
-            oskar_sky_reference_ra_rad(sky), oskar_sky_reference_dec_rad(sky),
-            d->tel, time_index_sim, gast_rad, freq, d->station_work, status);
+    if (h->beam_table)
+        oskar_beam_table_evaluate(h->beam_table, d->E, num_src,
+                source_coords, oskar_sky_reference_ra_rad(sky),
+                oskar_sky_reference_dec_rad(sky), d->tel, time_index_sim,
+                gast_rad, channel_index_sim, freq, d->station_work,
+                d->beam_table_buffer, &d->beam_table_buffer_index, status);
+    else
+        oskar_evaluate_jones_E(d->E, OSKAR_COORDS_REL_DIR, num_src,
+                source_coords, oskar_sky_reference_ra_rad(sky),
+                oskar_sky_reference_dec_rad(sky), d->tel, time_index_sim,
+                gast_rad, freq, d->station_work, status);
     oskar_timer_pause(d->tmr_E);
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones E.
-     * TODO Move this into station beam evaluation instead. */
+    /* Evaluate parallactic angle (Jones R: matrix). */
     if (d->R)
     {
         oskar_timer_resume(d->tmr_E);
@@ -241,35 +1092,27 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
                 oskar_sky_dec_rad_const(sky),
                 d->tel, gast_rad, status);
         oskar_timer_pause(d->tmr_E);
-        oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
-        oskar_timer_pause(d->tmr_join);
     }
 
-    /* Evaluate interferometer phase (Jones K: scalar). */
-    oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src,
-            lmn[0], lmn[1], lmn[2], uvw[0], uvw[1], uvw[2],
-            freq, src_flux[0], h->source_min_jy, h->source_max_jy,
-            h->ignore_w_components, status);
-    oskar_timer_pause(d->tmr_K);
+    /* Evaluate interferometer phase (Jones K) and join the chain. */
+    join_jones_chain(h, d, num_src, lmn, uvw, time_index_sim, freq,
+            src_flux[0], h->source_min_jy, h->source_max_jy, status);
+}
 
-    /* Multiply Jones matrix chain to get a single block. */
-    oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
-    oskar_timer_pause(d->tmr_join);
 
-    /* Check whether gain model exists.
-     * If so, evaluate gains and apply them. */
-    if (oskar_gains_defined(oskar_telescope_gains(d->tel)))
-    {
-        oskar_gains_evaluate(oskar_telescope_gains(d->tel),
-                time_index_sim, freq, d->gains, status);
-        oskar_jones_apply_station_gains(d->J, d->gains, status);
-    }
+static void correlate_jones_chain(oskar_Interferometer* h, DeviceData* d,
+        const oskar_Sky* sky, const oskar_Mem* const lmn[3],
+        const oskar_Mem* const uvw[3], const oskar_Mem* const src_flux[4],
+        int time_index_sim, int channel_index_sim, double gast_rad,
+        double freq, int offset, int* status)
+{
+    const int num_baselines = oskar_telescope_num_baselines(d->tel);
+    const int num_stations  = oskar_telescope_num_stations(d->tel);
+    const int num_src       = oskar_sky_num_sources(sky);
 
-    /* Calculate output offset. */
-    const int offset = num_chans_block * time_index_block + channel_index_block;
+    /* Evaluate the Jones matrices for every source. */
+    evaluate_jones_sources(h, d, sky, lmn, uvw, src_flux, time_index_sim,
+            channel_index_sim, gast_rad, freq, status);
     oskar_timer_resume(d->tmr_correlate);
 
     /* Auto-correlate for this time and channel. */
@@ -278,7 +1121,17 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
                 oskar_vis_block_auto_correlations(d->vis_block), status);
 
     /* Cross-correlate for this time and channel. */
-    if (oskar_vis_block_has_cross_correlations(d->vis_block))
+    if (oskar_vis_block_has_cross_correlations(d->vis_block) &&
+            d->use_source_tree)
+    {
+        oskar_cross_correlate_lod(d->source_tree, h->lod_tolerance_jy,
+                num_src, d->J, src_flux, lmn, d->tel, uvw, gast_rad, freq,
+                num_baselines * offset,
+                oskar_vis_block_cross_correlations(d->vis_block),
+                &d->lod_terms, &d->lod_terms_exact, &d->lod_error_max,
+                status);
+    }
+    else if (oskar_vis_block_has_cross_correlations(d->vis_block))
     {
         const int source_type = oskar_sky_use_extended(sky);
         const oskar_Mem* const src_extended[] = {
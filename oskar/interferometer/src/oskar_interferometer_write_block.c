@@ -8,6 +8,8 @@
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header_write_ms.h"
 
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,7 +17,7 @@ extern "C" {
 void oskar_interferometer_write_block(oskar_Interferometer* h,
         const oskar_VisBlock* block, int block_index, int* status)
 {
-    if (*status) return;
+    if (*status || h->coords_only || h->proc_id > 0) return;
     oskar_timer_resume(h->tmr_write);
 #ifndef OSKAR_NO_MS
     if (h->ms_name && !h->ms)
@@ -24,8 +26,29 @@ void oskar_interferometer_write_block(oskar_Interferometer* h,
     if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
 #endif
     if (h->vis_name && !h->vis)
+    {
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
+
+        /* Record the name of the averaged data file, if there is one. */
+        if (h->vis && h->bda_name)
+            oskar_binary_write(h->vis, OSKAR_CHAR, OSKAR_TAG_GROUP_VIS_BDA,
+                    OSKAR_VIS_BDA_TAG_FILE_NAME, 0, 1 + strlen(h->bda_name),
+                    h->bda_name, status);
+    }
     if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+    if (h->bda_name && !h->bda_file)
+    {
+        oskar_log_message(h->log, 'M', 0, "Writing baseline-dependent "
+                "averages to '%s'.", h->bda_name);
+        oskar_log_message(h->log, 'M', 1, "This file has a visibility "
+                "header, but no visibility blocks: averaged rows are in "
+                "tag group %d.", OSKAR_TAG_GROUP_VIS_BDA);
+        h->bda_file = oskar_vis_header_write(h->header, h->bda_name, status);
+        h->bda = oskar_vis_bda_create(h->header, h->bda_max_fact,
+                h->bda_fov_deg, h->bda_max_time_avg_sec,
+                h->bda_max_chans_avg, status);
+    }
+    if (h->bda) oskar_vis_bda_add_block(h->bda, block, h->bda_file, status);
     oskar_timer_pause(h->tmr_write);
 }
 
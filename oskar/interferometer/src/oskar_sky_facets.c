@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "convert/oskar_convert_relative_directions_to_lon_lat.h"
+#include "imager/oskar_grid_correction.h"
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/private_imager_composite_nearest_even.h"
+#include "interferometer/oskar_sky_facets.h"
+#include "interferometer/private_sky_facets.h"
+#include "math/oskar_fftphase.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest squared distance of a facet centre from the phase centre,
+ * to keep the w-term correction finite. */
+#define MAX_CENTRE_R2 0.999999
+
+struct FacetKey
+{
+    long long int key;
+    int index;
+};
+typedef struct FacetKey FacetKey;
+
+static int compare_keys(const void* a, const void* b)
+{
+    const FacetKey* x = (const FacetKey*) a;
+    const FacetKey* y = (const FacetKey*) b;
+    if (x->key != y->key) return (x->key < y->key) ? -1 : 1;
+    return x->index - y->index;
+}
+
+static double get_value(const oskar_Mem* mem, int i)
+{
+    return (oskar_mem_precision(mem) == OSKAR_DOUBLE) ?
+            ((const double*) oskar_mem_void_const(mem))[i] :
+            ((const float*) oskar_mem_void_const(mem))[i];
+}
+
+static void set_value(oskar_Mem* mem, int i, double value)
+{
+    if (oskar_mem_precision(mem) == OSKAR_DOUBLE)
+        ((double*) oskar_mem_void(mem))[i] = value;
+    else
+        ((float*) oskar_mem_void(mem))[i] = (float) value;
+}
+
+static int include(const oskar_Mem* stokes_I, int i, double min_jy,
+        double max_jy)
+{
+    const double value = get_value(stokes_I, i);
+    return (value > min_jy && value <= max_jy);
+}
+
+static void clear_facets(oskar_SkyFacets* f, int* status)
+{
+    int i;
+    if (f->stokes)
+    {
+        for (i = 0; i < 4 * f->num_slots; ++i)
+            oskar_mem_free(f->stokes[i], status);
+    }
+    free(f->stokes);
+    free(f->facet_start);
+    free(f->order);
+    free(f->pixel);
+    free(f->w_residual);
+    free(f->flux_norm);
+    oskar_mem_free(f->grids, status);
+    oskar_mem_free(f->corr_func, status);
+    oskar_mem_free(f->plane, status);
+    oskar_fft_free(f->fft);
+    f->stokes = 0;
+    f->facet_start = 0;
+    f->order = 0;
+    f->pixel = 0;
+    f->w_residual = 0;
+    f->flux_norm = 0;
+    f->grids = 0;
+    f->corr_func = 0;
+    f->plane = 0;
+    f->fft = 0;
+    f->num_sources = f->num_facets = f->num_slots = f->grid_size = 0;
+}
+
+
+oskar_SkyFacets* oskar_sky_facets_create(int precision, int* status)
+{
+    int i;
+    oskar_Mem* tmp = 0;
+    oskar_SkyFacets* f = (oskar_SkyFacets*) calloc(1, sizeof(oskar_SkyFacets));
+    if (!f)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    if (precision != OSKAR_SINGLE && precision != OSKAR_DOUBLE)
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+    f->precision = precision;
+    const int complex_type = precision | OSKAR_COMPLEX;
+    for (i = 0; i < 3; ++i)
+        f->lmn[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    f->ra_rad = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    f->dec_rad = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    f->uu = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    f->vv = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+    for (i = 0; i < 4; ++i)
+        f->degridded[i] = oskar_mem_create(complex_type, OSKAR_CPU, 0, status);
+    f->sum = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU, 0,
+            status);
+
+    /* Generate the convolution function used for degridding. */
+    tmp = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            OSKAR_SKY_FACETS_OVERSAMPLE * (OSKAR_SKY_FACETS_SUPPORT + 1),
+            status);
+    if (!*status)
+        oskar_grid_convolution_function_spheroidal(OSKAR_SKY_FACETS_SUPPORT,
+                OSKAR_SKY_FACETS_OVERSAMPLE, oskar_mem_double(tmp, status));
+    f->conv_func = oskar_mem_convert_precision(tmp, precision, status);
+    oskar_mem_free(tmp, status);
+    return f;
+}
+
+
+void oskar_sky_facets_set_up(oskar_SkyFacets* f, const oskar_Sky* sky,
+        double facet_size_rad, double cell_size_rad, int polarised,
+        int num_slots, int* status)
+{
+    int i, j, k, num_facets = 0, nx, ny, grid_size = 0;
+    double l_min = 0.0, l_max = 0.0, m_min = 0.0, m_max = 0.0, half = 0.0;
+    FacetKey* keys = 0;
+    if (*status) return;
+
+    /* Check inputs. */
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_sky_precision(sky) != f->precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (facet_size_rad <= 0.0 || cell_size_rad <= 0.0 || num_slots < 1)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Discard any previous facets. */
+    clear_facets(f, status);
+    const int num_sources = oskar_sky_num_sources(sky);
+    const oskar_Mem* l = oskar_sky_l_const(sky);
+    const oskar_Mem* m = oskar_sky_m_const(sky);
+    const oskar_Mem* n = oskar_sky_n_const(sky);
+    f->polarised = polarised;
+    f->num_grids = polarised ? 4 : 1;
+    f->num_sources = num_sources;
+    f->num_slots = num_slots;
+    f->cell_size_rad = cell_size_rad;
+
+    /* Find the bounding box of the sources. */
+    for (i = 0; i < num_sources; ++i)
+    {
+        const double l_ = get_value(l, i), m_ = get_value(m, i);
+        if (i == 0 || l_ < l_min) l_min = l_;
+        if (i == 0 || l_ > l_max) l_max = l_;
+        if (i == 0 || m_ < m_min) m_min = m_;
+        if (i == 0 || m_ > m_max) m_max = m_;
+    }
+    nx = 1 + (int) floor((l_max - l_min) / facet_size_rad);
+    ny = 1 + (int) floor((m_max - m_min) / facet_size_rad);
+
+    /* Sort the sources by facet. Sources in the hemisphere behind the
+     * phase centre go into separate facets. */
+    keys = (FacetKey*) calloc(num_sources > 0 ? num_sources : 1,
+            sizeof(FacetKey));
+    f->order = (int*) calloc(num_sources > 0 ? num_sources : 1, sizeof(int));
+    f->pixel = (double*) calloc(2 * (num_sources > 0 ? num_sources : 1),
+            sizeof(double));
+    f->facet_start = (int*) calloc(num_sources + 1, sizeof(int));
+    if (!keys || !f->order || !f->pixel || !f->facet_start)
+    {
+        free(keys);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < num_sources; ++i)
+    {
+        int ix = (int) floor((get_value(l, i) - l_min) / facet_size_rad);
+        int iy = (int) floor((get_value(m, i) - m_min) / facet_size_rad);
+        if (ix >= nx) ix = nx - 1;
+        if (iy >= ny) iy = ny - 1;
+        keys[i].key = ((long long int) iy * nx + ix) * 2 +
+                (get_value(n, i) < 0.0 ? 1 : 0);
+        keys[i].index = i;
+    }
+    qsort(keys, (size_t) num_sources, sizeof(FacetKey), compare_keys);
+    for (i = 0; i < num_sources; ++i)
+    {
+        f->order[i] = keys[i].index;
+        if (i == 0 || keys[i].key != keys[i - 1].key)
+            f->facet_start[num_facets++] = i;
+    }
+    f->facet_start[num_facets] = num_sources;
+    f->num_facets = num_facets;
+    free(keys);
+
+    /* Find the centre of each facet, and the largest offset from it. */
+    f->w_residual = (double*) calloc(num_facets > 0 ? num_facets : 1,
+            sizeof(double));
+    f->flux_norm = (double*) calloc(
+            (size_t) num_slots * (num_facets > 0 ? num_facets : 1),
+            sizeof(double));
+    if (!f->w_residual || !f->flux_norm)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < 3; ++i)
+        oskar_mem_realloc(f->lmn[i], num_facets, status);
+    oskar_mem_realloc(f->ra_rad, num_facets, status);
+    oskar_mem_realloc(f->dec_rad, num_facets, status);
+    if (*status) return;
+    for (k = 0; k < num_facets; ++k)
+    {
+        double l0, m0, n0, r2, b_l[2] = {0.0, 0.0}, b_m[2] = {0.0, 0.0};
+        const int start = f->facet_start[k], end = f->facet_start[k + 1];
+        for (j = start; j < end; ++j)
+        {
+            const int s = f->order[j];
+            const double l_ = get_value(l, s), m_ = get_value(m, s);
+            if (j == start || l_ < b_l[0]) b_l[0] = l_;
+            if (j == start || l_ > b_l[1]) b_l[1] = l_;
+            if (j == start || m_ < b_m[0]) b_m[0] = m_;
+            if (j == start || m_ > b_m[1]) b_m[1] = m_;
+        }
+        l0 = 0.5 * (b_l[0] + b_l[1]);
+        m0 = 0.5 * (b_m[0] + b_m[1]);
+        r2 = l0 * l0 + m0 * m0;
+        if (r2 > MAX_CENTRE_R2)
+        {
+            const double scale = sqrt(MAX_CENTRE_R2 / r2);
+            l0 *= scale;
+            m0 *= scale;
+            r2 = MAX_CENTRE_R2;
+        }
+        n0 = sqrt(1.0 - r2);
+        if (get_value(n, f->order[start]) < 0.0) n0 = -n0;
+        set_value(f->lmn[0], k, l0);
+        set_value(f->lmn[1], k, m0);
+        set_value(f->lmn[2], k, n0);
+
+        /* Get the pixel offsets and the residual w-term of each source. */
+        for (j = start; j < end; ++j)
+        {
+            const int s = f->order[j];
+            const double dl = get_value(l, s) - l0;
+            const double dm = get_value(m, s) - m0;
+            const double w_res = fabs(get_value(n, s) - n0 +
+                    (l0 * dl + m0 * dm) / n0);
+            if (fabs(dl) > half) half = fabs(dl);
+            if (fabs(dm) > half) half = fabs(dm);
+            if (w_res > f->w_residual[k]) f->w_residual[k] = w_res;
+            f->pixel[2 * j] = -dl / cell_size_rad;
+            f->pixel[2 * j + 1] = dm / cell_size_rad;
+        }
+    }
+    oskar_convert_relative_directions_to_lon_lat(num_facets,
+            f->lmn[0], f->lmn[1], f->lmn[2],
+            oskar_sky_reference_ra_rad(sky), oskar_sky_reference_dec_rad(sky),
+            f->ra_rad, f->dec_rad, status);
+
+    /* Choose a grid size that is twice the model image size, allowing
+     * room for the interpolation weights. */
+    const int image_size = 2 * (int) ceil(half / cell_size_rad) + 6;
+    (void) oskar_imager_composite_nearest_even(2 * image_size - 1,
+            0, &grid_size);
+    f->grid_size = grid_size;
+    for (j = 0; j < 2 * num_sources; ++j)
+        f->pixel[j] += grid_size / 2;
+
+    /* Generate the grid correction function. */
+    oskar_Mem* tmp = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, grid_size,
+            status);
+    if (!*status)
+        oskar_grid_correction_function_spheroidal(grid_size, 0,
+                oskar_mem_double(tmp, status));
+    f->corr_func = oskar_mem_convert_precision(tmp, f->precision, status);
+    oskar_mem_free(tmp, status);
+
+    /* Allocate the Stokes sums, the grids and the FFT plan. */
+    const int complex_type = f->precision | OSKAR_COMPLEX;
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    f->stokes = (oskar_Mem**) calloc(4 * num_slots, sizeof(oskar_Mem*));
+    if (!f->stokes)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < 4 * num_slots; ++i)
+        f->stokes[i] = oskar_mem_create(f->precision, OSKAR_CPU,
+                num_facets, status);
+    f->grids = oskar_mem_create(complex_type, OSKAR_CPU,
+            num_slots * num_facets * f->num_grids * num_cells, status);
+    f->plane = oskar_mem_create(complex_type, OSKAR_CPU, num_cells, status);
+    f->fft = oskar_fft_create(f->precision, OSKAR_CPU, 2, grid_size, 0,
+            status);
+}
+
+
+void oskar_sky_facets_update(oskar_SkyFacets* f, const oskar_Sky* sky,
+        int slot, double source_min_jy, double source_max_jy, int* status)
+{
+    int i, j, k;
+    const oskar_Mem* src_stokes[4];
+    if (*status) return;
+    if (oskar_sky_num_sources(sky) != f->num_sources ||
+            slot < 0 || slot >= f->num_slots)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_sky_precision(sky) != f->precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    src_stokes[0] = oskar_sky_I_const(sky);
+    src_stokes[1] = oskar_sky_Q_const(sky);
+    src_stokes[2] = oskar_sky_U_const(sky);
+    src_stokes[3] = oskar_sky_V_const(sky);
+    const int grid_size = f->grid_size;
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    for (k = 0; k < f->num_facets; ++k)
+    {
+        double sum[4] = {0.0, 0.0, 0.0, 0.0}, norm = 0.0;
+        const int start = f->facet_start[k], end = f->facet_start[k + 1];
+
+        /* Sum the fluxes in the facet. */
+        for (j = start; j < end; ++j)
+        {
+            double s[4];
+            const int src = f->order[j];
+            if (!include(src_stokes[0], src, source_min_jy, source_max_jy))
+                continue;
+            for (i = 0; i < 4; ++i)
+            {
+                s[i] = get_value(src_stokes[i], src);
+                sum[i] += s[i];
+            }
+
+            /* The eigenvalues of the brightness matrix are
+             * I +/- sqrt(Q^2 + U^2 + V^2). */
+            norm += fabs(s[0]);
+            if (f->polarised)
+                norm += sqrt(s[1] * s[1] + s[2] * s[2] + s[3] * s[3]);
+        }
+        for (i = 0; i < 4; ++i)
+            set_value(f->stokes[4 * slot + i], k, sum[i]);
+        f->flux_norm[slot * f->num_facets + k] = norm;
+
+        /* Make the grid for each Stokes parameter. */
+        for (i = 0; i < f->num_grids; ++i)
+        {
+            const size_t offset = num_cells * (i + (size_t) f->num_grids *
+                    (k + (size_t) f->num_facets * slot));
+            double* plane_d = 0;
+            float* plane_f = 0;
+            oskar_mem_clear_contents(f->plane, status);
+            if (*status) return;
+            if (f->precision == OSKAR_DOUBLE)
+                plane_d = oskar_mem_double(f->plane, status);
+            else
+                plane_f = oskar_mem_float(f->plane, status);
+
+            /* Spread each source over the nearest 4 x 4 pixels using
+             * cubic interpolation weights. */
+            for (j = start; j < end; ++j)
+            {
+                int a, b;
+                double wx[4], wy[4];
+                const int src = f->order[j];
+                const double value = get_value(src_stokes[i], src);
+                const double x = f->pixel[2 * j], y = f->pixel[2 * j + 1];
+                const int x0 = (int) floor(x), y0 = (int) floor(y);
+                const double tx = x - x0, ty = y - y0;
+                if (value == 0.0 || !include(src_stokes[0], src,
+                        source_min_jy, source_max_jy))
+                    continue;
+                wx[0] = -tx * (tx - 1.0) * (tx - 2.0) / 6.0;
+                wx[1] = (tx + 1.0) * (tx - 1.0) * (tx - 2.0) / 2.0;
+                wx[2] = -(tx + 1.0) * tx * (tx - 2.0) / 2.0;
+                wx[3] = (tx + 1.0) * tx * (tx - 1.0) / 6.0;
+                wy[0] = -ty * (ty - 1.0) * (ty - 2.0) / 6.0;
+                wy[1] = (ty + 1.0) * (ty - 1.0) * (ty - 2.0) / 2.0;
+                wy[2] = -(ty + 1.0) * ty * (ty - 2.0) / 2.0;
+                wy[3] = (ty + 1.0) * ty * (ty - 1.0) / 6.0;
+                for (b = 0; b < 4; ++b)
+                {
+                    const size_t row = (size_t) (y0 - 1 + b) * grid_size;
+                    for (a = 0; a < 4; ++a)
+                    {
+                        const size_t p = (row + (x0 - 1 + a)) << 1;
+                        const double t = value * wx[a] * wy[b];
+                        if (plane_d)
+                            plane_d[p] += t;
+                        else
+                            plane_f[p] += (float) t;
+                    }
+                }
+            }
+
+            /* Transform the model image to the grid. This is the adjoint
+             * of the transform done by the imager, so the same
+             * degridding kernel can be used. */
+            oskar_grid_correction(grid_size, f->corr_func, f->plane, status);
+            oskar_fftphase(grid_size, grid_size, f->plane, status);
+            oskar_fft_exec(f->fft, f->plane, status);
+            oskar_fftphase(grid_size, grid_size, f->plane, status);
+            if (*status) return;
+            if (f->precision == OSKAR_DOUBLE)
+            {
+                double* t = oskar_mem_double(f->plane, status);
+                for (j = 0; j < (int) num_cells; ++j) t[2 * j + 1] *= -1.0;
+            }
+            else
+            {
+                float* t = oskar_mem_float(f->plane, status);
+                for (j = 0; j < (int) num_cells; ++j) t[2 * j + 1] *= -1.0f;
+            }
+            oskar_mem_copy_contents(f->grids, f->plane, offset, 0,
+                    num_cells, status);
+        }
+    }
+}
+
+
+int oskar_sky_facets_num_facets(const oskar_SkyFacets* f)
+{
+    return f->num_facets;
+}
+
+int oskar_sky_facets_grid_size(const oskar_SkyFacets* f)
+{
+    return f->grid_size;
+}
+
+const oskar_Mem* oskar_sky_facets_lmn_const(const oskar_SkyFacets* f,
+        int dim)
+{
+    return (dim >= 0 && dim < 3) ? f->lmn[dim] : 0;
+}
+
+const oskar_Mem* oskar_sky_facets_ra_rad_const(const oskar_SkyFacets* f)
+{
+    return f->ra_rad;
+}
+
+const oskar_Mem* oskar_sky_facets_dec_rad_const(const oskar_SkyFacets* f)
+{
+    return f->dec_rad;
+}
+
+const oskar_Mem* oskar_sky_facets_stokes_const(const oskar_SkyFacets* f,
+        int slot, int stokes)
+{
+    if (slot < 0 || slot >= f->num_slots || stokes < 0 || stokes > 3)
+        return 0;
+    return f->stokes[4 * slot + stokes];
+}
+
+
+void oskar_sky_facets_free(oskar_SkyFacets* f, int* status)
+{
+    int i;
+    if (!f) return;
+    clear_facets(f, status);
+    for (i = 0; i < 3; ++i) oskar_mem_free(f->lmn[i], status);
+    for (i = 0; i < 4; ++i) oskar_mem_free(f->degridded[i], status);
+    oskar_mem_free(f->ra_rad, status);
+    oskar_mem_free(f->dec_rad, status);
+    oskar_mem_free(f->uu, status);
+    oskar_mem_free(f->vv, status);
+    oskar_mem_free(f->sum, status);
+    oskar_mem_free(f->conv_func, status);
+    free(f->bound);
+    free(f);
+}
+
+#ifdef __cplusplus
+}
+#endif
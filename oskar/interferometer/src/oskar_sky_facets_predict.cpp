@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "imager/oskar_degrid_simple.h"
+#include "interferometer/oskar_sky_facets.h"
+#include "interferometer/private_sky_facets.h"
+#include "math/define_multiply.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+
+// Bound on the error of cubic interpolation of exp(i x) at unit spacing,
+// as a multiple of x^4: max |(t + 1) t (t - 1) (t - 2)| / 4! = 9 / 384.
+#define CUBIC_ERROR 0.0234375
+
+// Measured relative error of the degridding kernel with two-fold padding,
+// for a source in the corner of the model image.
+#define KERNEL_ERROR 0.003
+
+template<typename REAL>
+static void facet_uv(const int num_stations,
+        const REAL* const RESTRICT station_u,
+        const REAL* const RESTRICT station_v,
+        const REAL* const RESTRICT station_w,
+        const double inv_wavelength, const double dl_dw, const double dm_dw,
+        REAL* RESTRICT uu, REAL* RESTRICT vv)
+{
+#pragma omp parallel for
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            const int b = OSKAR_BASELINE_INDEX(num_stations, SP, SQ);
+            const double u = ((double) station_u[SP] - station_u[SQ]);
+            const double v = ((double) station_v[SP] - station_v[SQ]);
+            const double w = ((double) station_w[SP] - station_w[SQ]);
+            uu[b] = (REAL) ((u - w * dl_dw) * inv_wavelength);
+            vv[b] = (REAL) ((v - w * dm_dw) * inv_wavelength);
+        }
+    }
+}
+
+template<bool MATRIX, typename REAL2, typename REAL4c>
+static double jones_norm(const void* jones, const int i)
+{
+    double t;
+    if (MATRIX)
+    {
+        const REAL4c j = ((const REAL4c*) jones)[i];
+        t = (double) j.a.x * j.a.x + (double) j.a.y * j.a.y +
+                (double) j.b.x * j.b.x + (double) j.b.y * j.b.y +
+                (double) j.c.x * j.c.x + (double) j.c.y * j.c.y +
+                (double) j.d.x * j.d.x + (double) j.d.y * j.d.y;
+    }
+    else
+    {
+        const REAL2 j = ((const REAL2*) jones)[i];
+        t = (double) j.x * j.x + (double) j.y * j.y;
+    }
+    return sqrt(t);
+}
+
+template
+<
+bool MATRIX, typename REAL, typename REAL2, typename REAL4c
+>
+static void facet_add(
+        const int                    facet,
+        const int                    jones_stride,
+        const int                    num_stations,
+        const bool                   polarised,
+        const void*         const    jones,
+        const REAL2*  const RESTRICT deg_I,
+        const REAL2*  const RESTRICT deg_Q,
+        const REAL2*  const RESTRICT deg_U,
+        const REAL2*  const RESTRICT deg_V,
+        const REAL*   const RESTRICT uu_facet,
+        const REAL*   const RESTRICT vv_facet,
+        const double                 l0,
+        const double                 m0,
+        const double                 n0,
+        const double                 flux_norm,
+        const double                 w_residual,
+        const double                 cell_size_rad,
+        const double                 uv_limit,
+        const bool                   ignore_w,
+        const REAL*   const RESTRICT station_u,
+        const REAL*   const RESTRICT station_v,
+        const REAL*   const RESTRICT station_w,
+        const REAL*   const RESTRICT station_x,
+        const REAL*   const RESTRICT station_y,
+        const REAL                   uv_min_lambda,
+        const REAL                   uv_max_lambda,
+        const REAL                   inv_wavelength,
+        const REAL                   frac_bandwidth,
+        const REAL                   time_int_sec,
+        const REAL                   gha0_rad,
+        const REAL                   dec0_rad,
+        double4c*           RESTRICT sum,
+        double*             RESTRICT bound)
+{
+    const bool bandwidth_smearing = (frac_bandwidth != (REAL) 0);
+    const bool time_smearing = (time_int_sec != (REAL) 0);
+
+    // Loop over stations.
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int SQ = 0; SQ < num_stations; ++SQ)
+    {
+        // Get the norm of the Jones matrix for this station.
+        const double norm_q = jones_norm<MATRIX, REAL2, REAL4c>(
+                jones, SQ * jones_stride + facet);
+
+        // Loop over baselines for this station.
+        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        {
+            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv;
+            REAL du = (REAL) 0, dv = (REAL) 0, dw = (REAL) 0;
+            const int b = OSKAR_BASELINE_INDEX(num_stations, SP, SQ);
+
+            // Get common baseline values.
+            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
+                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
+                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
+            (void) uuvv;
+
+            // Apply the baseline length filter.
+            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+            // Find the bound on the error of this facet.
+            const double gain = norm_q * jones_norm<MATRIX, REAL2, REAL4c>(
+                    jones, SP * jones_stride + facet);
+            const double u_f = fabs((double) uu_facet[b]);
+            const double v_f = fabs((double) vv_facet[b]);
+            if (u_f > uv_limit || v_f > uv_limit)
+            {
+                // The grid does not reach this baseline.
+                bound[b] += gain * flux_norm;
+                continue;
+            }
+            const double t_u = 2.0 * M_PI * u_f * cell_size_rad;
+            const double t_v = 2.0 * M_PI * v_f * cell_size_rad;
+            const double e_u = CUBIC_ERROR * t_u * t_u * t_u * t_u;
+            const double e_v = CUBIC_ERROR * t_v * t_v * t_v * t_v;
+            double e_w = 0.0;
+            if (!ignore_w)
+            {
+                const double ww_lambda = ((double) station_w[SP] -
+                        (double) station_w[SQ]) * inv_wavelength;
+                e_w = 2.0 * M_PI * fabs(ww_lambda) * w_residual;
+                if (e_w > 2.0) e_w = 2.0;
+            }
+            bound[b] += gain * flux_norm *
+                    (e_u + e_v + e_u * e_v + e_w + KERNEL_ERROR);
+
+            // Get the smearing at the facet centre.
+            double smearing = 1.0;
+            if (bandwidth_smearing)
+            {
+                const double t = uu * l0 + vv * m0 + ww * (n0 - 1.0);
+                smearing *= OSKAR_SINC(double, t);
+            }
+            if (time_smearing)
+            {
+                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
+                        station_y[SP], station_y[SQ], du, dv, dw);
+                const double t = du * l0 + dv * m0 + dw * (n0 - 1.0);
+                smearing *= OSKAR_SINC(double, t);
+            }
+
+            // Add J_p S J_q^H, where S is the degridded brightness matrix.
+            if (MATRIX)
+            {
+                REAL4c m1, m2;
+                const REAL2 s_I = deg_I[b];
+                if (polarised)
+                {
+                    const REAL2 s_Q = deg_Q[b];
+                    const REAL2 s_U = deg_U[b];
+                    const REAL2 s_V = deg_V[b];
+                    m2.a.x = s_I.x + s_Q.x; m2.a.y = s_I.y + s_Q.y;
+                    m2.b.x = s_U.x - s_V.y; m2.b.y = s_U.y + s_V.x;
+                    m2.c.x = s_U.x + s_V.y; m2.c.y = s_U.y - s_V.x;
+                    m2.d.x = s_I.x - s_Q.x; m2.d.y = s_I.y - s_Q.y;
+                }
+                else
+                {
+                    m2.a = s_I; m2.d = s_I;
+                    m2.b.x = m2.b.y = m2.c.x = m2.c.y = (REAL) 0;
+                }
+                m1 = ((const REAL4c*) jones)[SP * jones_stride + facet];
+                OSKAR_MUL_COMPLEX_MATRIX_IN_PLACE(REAL2, m1, m2)
+                m2 = ((const REAL4c*) jones)[SQ * jones_stride + facet];
+                OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(
+                        REAL2, m1, m2)
+                OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum[b], m1, smearing)
+            }
+            else
+            {
+                REAL2 t1 = ((const REAL2*) jones)[SP * jones_stride + facet];
+                const REAL2 t2 = ((const REAL2*) jones)[
+                        SQ * jones_stride + facet];
+                OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+                OSKAR_MUL_COMPLEX_IN_PLACE(REAL2, t1, deg_I[b])
+                sum[b].a.x += t1.x * smearing;
+                sum[b].a.y += t1.y * smearing;
+            }
+        }
+    }
+}
+
+template<bool MATRIX, typename REAL, typename REAL2, typename REAL4c>
+static void add_to_vis(const int num_baselines, const int offset_out,
+        const double4c* RESTRICT sum, void* vis)
+{
+    for (int b = 0; b < num_baselines; ++b)
+    {
+        const int j = b + offset_out;
+        if (MATRIX)
+        {
+            REAL4c* v = &((REAL4c*) vis)[j];
+            v->a.x += (REAL) sum[b].a.x; v->a.y += (REAL) sum[b].a.y;
+            v->b.x += (REAL) sum[b].b.x; v->b.y += (REAL) sum[b].b.y;
+            v->c.x += (REAL) sum[b].c.x; v->c.y += (REAL) sum[b].c.y;
+            v->d.x += (REAL) sum[b].d.x; v->d.y += (REAL) sum[b].d.y;
+        }
+        else
+        {
+            REAL2* v = &((REAL2*) vis)[j];
+            v->x += (REAL) sum[b].a.x; v->y += (REAL) sum[b].a.y;
+        }
+    }
+}
+
+#define FACET_ADD(MATRIX, REAL, REAL2, REAL4c, CONST_PTR)                   \
+        facet_add<MATRIX, REAL, REAL2, REAL4c>(k,                           \
+                oskar_jones_num_sources(jones), num_stations,               \
+                (f->num_grids == 4), oskar_mem_void_const(J),               \
+                (const REAL2*) oskar_mem_void_const(deg[0]),                \
+                (const REAL2*) oskar_mem_void_const(deg[1]),                \
+                (const REAL2*) oskar_mem_void_const(deg[2]),                \
+                (const REAL2*) oskar_mem_void_const(deg[3]),                \
+                CONST_PTR(f->uu, status), CONST_PTR(f->vv, status),         \
+                l0, m0, n0, f->flux_norm[slot * f->num_facets + k],         \
+                f->w_residual[k], f->cell_size_rad, uv_limit,               \
+                (ignore_w_components != 0),                                 \
+                CONST_PTR(station_uvw[0], status),                          \
+                CONST_PTR(station_uvw[1], status),                          \
+                CONST_PTR(station_uvw[2], status),                          \
+                CONST_PTR(x, status), CONST_PTR(y, status),                 \
+                (REAL) uv_filter_min, (REAL) uv_filter_max,                 \
+                (REAL) inv_wavelength, (REAL) frac_bandwidth,               \
+                (REAL) time_avg, (REAL) gha0, (REAL) dec0,                  \
+                sum, f->bound);
+
+extern "C"
+void oskar_sky_facets_predict(oskar_SkyFacets* f, int slot,
+        const oskar_Jones* jones, const oskar_Telescope* tel,
+        const oskar_Mem* const station_uvw[3], double gast,
+        double frequency_hz, int ignore_w_components, int offset_out,
+        oskar_Mem* vis, double* max_error_bound, int* status)
+{
+    double uv_filter_min, uv_filter_max;
+    double time_avg = 0.0, gha0 = 0.0, dec0 = 0.0;
+    const oskar_Mem* deg[4];
+    if (*status) return;
+
+    /* Get the data dimensions. */
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const int num_facets = f->num_facets;
+
+    /* Get bandwidth-smearing terms. */
+    frequency_hz = fabs(frequency_hz);
+    const double inv_wavelength = frequency_hz / 299792458.0;
+    const double channel_bandwidth = oskar_telescope_channel_bandwidth_hz(tel);
+    const double frac_bandwidth = channel_bandwidth / frequency_hz;
+
+    /* Get time-average smearing terms.
+     * Ignore if drift scanning - this will need to be done differently. */
+    if (oskar_telescope_phase_centre_coord_type(tel) != OSKAR_COORDS_AZEL)
+    {
+        time_avg = oskar_telescope_time_average_sec(tel);
+        gha0 = gast - oskar_telescope_phase_centre_longitude_rad(tel);
+        dec0 = oskar_telescope_phase_centre_latitude_rad(tel);
+    }
+
+    /* Get UV filter parameters in wavelengths. */
+    uv_filter_min = oskar_telescope_uv_filter_min(tel);
+    uv_filter_max = oskar_telescope_uv_filter_max(tel);
+    if (oskar_telescope_uv_filter_units(tel) == OSKAR_METRES)
+    {
+        uv_filter_min *= inv_wavelength;
+        uv_filter_max *= inv_wavelength;
+    }
+    if (uv_filter_max < 0.0 || uv_filter_max > FLT_MAX)
+        uv_filter_max = FLT_MAX;
+
+    /* Check data locations. */
+    if (oskar_jones_mem_location(jones) != OSKAR_CPU ||
+            oskar_telescope_mem_location(tel) != OSKAR_CPU ||
+            oskar_mem_location(vis) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[0]) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[1]) != OSKAR_CPU ||
+            oskar_mem_location(station_uvw[2]) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Check for consistent data types. */
+    const int jones_type = oskar_jones_type(jones);
+    if (oskar_mem_type(vis) != jones_type ||
+            oskar_type_precision(jones_type) != f->precision ||
+            oskar_mem_type(station_uvw[0]) != f->precision ||
+            oskar_mem_type(station_uvw[1]) != f->precision ||
+            oskar_mem_type(station_uvw[2]) != f->precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Check the input dimensions. */
+    if (slot < 0 || slot >= f->num_slots ||
+            oskar_jones_num_sources(jones) < num_facets ||
+            oskar_jones_num_stations(jones) != num_stations ||
+            (int)oskar_mem_length(station_uvw[0]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[1]) != num_stations ||
+            (int)oskar_mem_length(station_uvw[2]) != num_stations ||
+            (int)oskar_mem_length(vis) < offset_out + num_baselines)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (num_facets == 0 || num_baselines == 0) return;
+
+    /* Resize work arrays. */
+    const int num_grids = f->num_grids;
+    oskar_mem_ensure(f->uu, num_baselines, status);
+    oskar_mem_ensure(f->vv, num_baselines, status);
+    for (int i = 0; i < 4; ++i)
+    {
+        oskar_mem_ensure(f->degridded[i], num_baselines, status);
+        deg[i] = f->degridded[i < num_grids ? i : 0];
+    }
+    oskar_mem_ensure(f->sum, num_baselines, status);
+    oskar_mem_clear_contents(f->sum, status);
+    if ((size_t) num_baselines > f->capacity_bound)
+    {
+        double* t = (double*) realloc(f->bound,
+                num_baselines * sizeof(double));
+        if (!t) *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
+        {
+            f->bound = t;
+            f->capacity_bound = num_baselines;
+        }
+    }
+    if (*status) return;
+    for (int b = 0; b < num_baselines; ++b) f->bound[b] = 0.0;
+
+    /* The degridding kernel must fit inside the grid. */
+    const int grid_size = f->grid_size;
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    const double uv_limit = (grid_size / 2 - OSKAR_SKY_FACETS_SUPPORT - 1) /
+            (grid_size * f->cell_size_rad);
+
+    /* Loop over facets. */
+    const oskar_Mem* J = oskar_jones_mem_const(jones);
+    const oskar_Mem* x =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 0);
+    const oskar_Mem* y =
+            oskar_telescope_station_true_offset_ecef_metres_const(tel, 1);
+    double4c* sum = (double4c*) oskar_mem_void(f->sum);
+    for (int k = 0; k < num_facets; ++k)
+    {
+        size_t num_skipped = 0;
+        const double l0 = (f->precision == OSKAR_DOUBLE) ?
+                oskar_mem_double_const(f->lmn[0], status)[k] :
+                oskar_mem_float_const(f->lmn[0], status)[k];
+        const double m0 = (f->precision == OSKAR_DOUBLE) ?
+                oskar_mem_double_const(f->lmn[1], status)[k] :
+                oskar_mem_float_const(f->lmn[1], status)[k];
+        const double n0 = (f->precision == OSKAR_DOUBLE) ?
+                oskar_mem_double_const(f->lmn[2], status)[k] :
+                oskar_mem_float_const(f->lmn[2], status)[k];
+        if (f->flux_norm[slot * num_facets + k] == 0.0) continue;
+
+        /* Get the baseline coordinates, shifted to correct the w-term
+         * to first order across the facet. */
+        const double dl_dw = ignore_w_components ? 0.0 : l0 / n0;
+        const double dm_dw = ignore_w_components ? 0.0 : m0 / n0;
+        if (f->precision == OSKAR_DOUBLE)
+            facet_uv<double>(num_stations,
+                    oskar_mem_double_const(station_uvw[0], status),
+                    oskar_mem_double_const(station_uvw[1], status),
+                    oskar_mem_double_const(station_uvw[2], status),
+                    inv_wavelength, dl_dw, dm_dw,
+                    oskar_mem_double(f->uu, status),
+                    oskar_mem_double(f->vv, status));
+        else
+            facet_uv<float>(num_stations,
+                    oskar_mem_float_const(station_uvw[0], status),
+                    oskar_mem_float_const(station_uvw[1], status),
+                    oskar_mem_float_const(station_uvw[2], status),
+                    inv_wavelength, dl_dw, dm_dw,
+                    oskar_mem_float(f->uu, status),
+                    oskar_mem_float(f->vv, status));
+
+        /* Degrid each Stokes parameter. */
+        for (int i = 0; i < num_grids; ++i)
+        {
+            const size_t offset = num_cells * (i + (size_t) num_grids *
+                    (k + (size_t) num_facets * slot));
+            if (f->precision == OSKAR_DOUBLE)
+                oskar_degrid_simple_d(OSKAR_SKY_FACETS_SUPPORT,
+                        OSKAR_SKY_FACETS_OVERSAMPLE,
+                        oskar_mem_double_const(f->conv_func, status),
+                        (size_t) num_baselines,
+                        oskar_mem_double_const(f->uu, status),
+                        oskar_mem_double_const(f->vv, status),
+                        f->cell_size_rad, grid_size,
+                        oskar_mem_double_const(f->grids, status) + 2 * offset,
+                        &num_skipped,
+                        oskar_mem_double(f->degridded[i], status));
+            else
+                oskar_degrid_simple_f(OSKAR_SKY_FACETS_SUPPORT,
+                        OSKAR_SKY_FACETS_OVERSAMPLE,
+                        oskar_mem_float_const(f->conv_func, status),
+                        (size_t) num_baselines,
+                        oskar_mem_float_const(f->uu, status),
+                        oskar_mem_float_const(f->vv, status),
+                        (float) f->cell_size_rad, grid_size,
+                        oskar_mem_float_const(f->grids, status) + 2 * offset,
+                        &num_skipped,
+                        oskar_mem_float(f->degridded[i], status));
+        }
+        if (*status) return;
+
+        /* Add the facet to the visibilities. */
+        switch (jones_type)
+        {
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            FACET_ADD(true, float, float2, float4c, oskar_mem_float_const)
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            FACET_ADD(true, double, double2, double4c, oskar_mem_double_const)
+            break;
+        case OSKAR_SINGLE_COMPLEX:
+            FACET_ADD(false, float, float2, float4c, oskar_mem_float_const)
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            FACET_ADD(false, double, double2, double4c, oskar_mem_double_const)
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+    }
+
+    /* Add the sum to the output visibilities. */
+    switch (jones_type)
+    {
+    case OSKAR_SINGLE_COMPLEX_MATRIX:
+        add_to_vis<true, float, float2, float4c>(num_baselines, offset_out,
+                sum, oskar_mem_void(vis));
+        break;
+    case OSKAR_DOUBLE_COMPLEX_MATRIX:
+        add_to_vis<true, double, double2, double4c>(num_baselines, offset_out,
+                sum, oskar_mem_void(vis));
+        break;
+    case OSKAR_SINGLE_COMPLEX:
+        add_to_vis<false, float, float2, float4c>(num_baselines, offset_out,
+                sum, oskar_mem_void(vis));
+        break;
+    default:
+        add_to_vis<false, double, double2, double4c>(num_baselines,
+                offset_out, sum, oskar_mem_void(vis));
+        break;
+    }
+    double error_max = 0.0;
+    for (int b = 0; b < num_baselines; ++b)
+        if (f->bound[b] > error_max) error_max = f->bound[b];
+    if (error_max > *max_error_bound) *max_error_bound = error_max;
+}
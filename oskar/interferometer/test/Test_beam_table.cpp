@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "interferometer/oskar_beam_table.h"
+#include "interferometer/oskar_evaluate_jones_E.h"
+#include "interferometer/oskar_jones.h"
+#include "math/oskar_evaluate_image_lmn_grid.h"
+#include "math/oskar_linspace.h"
+#include "math/oskar_meshgrid.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+static oskar_Telescope* create_telescope(int num_stations, int* status)
+{
+    const int station_dim = 4;
+    const double station_size_m = 12.0;
+    const int num_antennas = station_dim * station_dim;
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, status);
+    std::vector<double> x_pos(station_dim);
+    oskar_linspace_d(&x_pos[0], -station_size_m / 2.0, station_size_m / 2.0,
+            station_dim);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        oskar_station_resize(s, num_antennas, status);
+        oskar_station_resize_element_types(s, 1, status);
+        oskar_station_set_position(s, 0.0, 50.0 * D2R, 0.0, 0.0, 0.0, 0.0);
+        oskar_element_set_element_type(oskar_station_element(s, 0),
+                "Isotropic", status);
+        oskar_meshgrid_d(
+                oskar_mem_double(
+                        oskar_station_element_measured_enu_metres(s, 0, 0),
+                        status),
+                oskar_mem_double(
+                        oskar_station_element_measured_enu_metres(s, 0, 1),
+                        status),
+                &x_pos[0], station_dim, &x_pos[0], station_dim);
+        for (int dim = 0; dim < 2; ++dim)
+            oskar_mem_copy(oskar_station_element_true_enu_metres(s, 0, dim),
+                    oskar_station_element_measured_enu_metres(s, 0, dim),
+                    status);
+    }
+    oskar_telescope_set_station_ids(tel);
+    oskar_telescope_set_phase_centre(tel,
+            OSKAR_COORDS_RADEC, 0.0, 60.0 * D2R);
+    oskar_telescope_set_allow_station_beam_duplication(tel, OSKAR_FALSE);
+    oskar_telescope_analyse(tel, status);
+    return tel;
+}
+
+// Returns the largest difference between interpolated and direct beams.
+static double compare_with_direct(const oskar_BeamTable* table,
+        const oskar_Telescope* tel, int time_index, double mjd_start,
+        double time_inc_sec, double freq_hz, int* status)
+{
+    const int num_l = 32, num_m = 32, num_pts = num_l * num_m;
+    const int num_stations = oskar_telescope_num_stations(tel);
+    oskar_Mem* lmn[3];
+    for (int i = 0; i < 3; ++i)
+        lmn[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_pts, status);
+    oskar_evaluate_image_lmn_grid(num_l, num_m, 60.0 * D2R, 60.0 * D2R,
+            0, lmn[0], lmn[1], lmn[2], status);
+    const oskar_Mem* const source_coords[] = {lmn[0], lmn[1], lmn[2]};
+    const int type = oskar_telescope_pol_mode(tel) == OSKAR_POL_MODE_FULL ?
+            OSKAR_DOUBLE_COMPLEX_MATRIX : OSKAR_DOUBLE_COMPLEX;
+    oskar_Jones* E_direct = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_pts, status);
+    oskar_Jones* E_table = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_pts, status);
+    oskar_StationWork* work = oskar_station_work_create(OSKAR_DOUBLE,
+            OSKAR_CPU, status);
+    int buffer_index = -1;
+    const double gast_rad = oskar_convert_mjd_to_gast_fast(
+            mjd_start + (time_index + 0.5) * time_inc_sec / 86400.0);
+    oskar_evaluate_jones_E(E_direct, OSKAR_COORDS_REL_DIR, num_pts,
+            source_coords, 0.0, 60.0 * D2R, tel, time_index, gast_rad,
+            freq_hz, work, status);
+    oskar_beam_table_evaluate(table, E_table, num_pts, source_coords,
+            0.0, 60.0 * D2R, tel, time_index, gast_rad, 0, freq_hz, work,
+            0, &buffer_index, status);
+    double max_diff = 0.0;
+    if (!*status)
+    {
+        const double* a = oskar_mem_double_const(
+                oskar_jones_mem_const(E_direct), status);
+        const double* b = oskar_mem_double_const(
+                oskar_jones_mem_const(E_table), status);
+        const size_t n = 2 * oskar_mem_length(oskar_jones_mem_const(E_table))
+                * (oskar_type_is_matrix(type) ? 4 : 1);
+        for (size_t i = 0; i < n; ++i)
+            max_diff = std::max(max_diff, fabs(a[i] - b[i]));
+    }
+    for (int i = 0; i < 3; ++i)
+        oskar_mem_free(lmn[i], status);
+    oskar_jones_free(E_direct, status);
+    oskar_jones_free(E_table, status);
+    oskar_station_work_free(work, status);
+    return max_diff;
+}
+
+TEST(beam_table, compare_with_direct)
+{
+    int status = 0;
+    const int num_stations = 3;
+    const double mjd_start = 51544.5, time_inc_sec = 60.0;
+    const double freq_hz = 50e6;
+    const char* filename = "temp_test_beam_table.bin";
+    oskar_Telescope* tel = create_telescope(num_stations, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create the tables, held in a file.
+    remove(filename);
+    oskar_BeamTable* table = oskar_beam_table_create(tel, 128, 1, 1e-3,
+            mjd_start, time_inc_sec, 2, freq_hz, 1e6, 1, filename, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_beam_table_num_rejected(table));
+    EXPECT_LT(oskar_beam_table_measured_error(table), 1e-3);
+
+    // Compare interpolated and directly-evaluated beams.
+    for (int t = 0; t < 2; ++t)
+    {
+        const double diff = compare_with_direct(table, tel, t,
+                mjd_start, time_inc_sec, freq_hz, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_LT(diff, 2e-3);
+    }
+
+    // Check the file is reused.
+    const double error = oskar_beam_table_measured_error(table);
+    oskar_beam_table_free(table);
+    table = oskar_beam_table_create(tel, 128, 1, 1e-3,
+            mjd_start, time_inc_sec, 2, freq_hz, 1e6, 1, filename, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_DOUBLE_EQ(error, oskar_beam_table_measured_error(table));
+
+    // Check tables are rejected if the tolerance cannot be met.
+    oskar_beam_table_free(table);
+    table = oskar_beam_table_create(tel, 8, 1, 1e-9,
+            mjd_start, time_inc_sec, 2, freq_hz, 1e6, 1, 0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(2, oskar_beam_table_num_rejected(table));
+
+    // Check the file is not reused if the station layout changes.
+    oskar_beam_table_free(table);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* s = oskar_telescope_station(tel, i);
+        for (int dim = 0; dim < 2; ++dim)
+        {
+            oskar_mem_scale_real(
+                    oskar_station_element_measured_enu_metres(s, 0, dim),
+                    2.0, 0, oskar_station_num_elements(s), &status);
+            oskar_mem_copy(oskar_station_element_true_enu_metres(s, 0, dim),
+                    oskar_station_element_measured_enu_metres(s, 0, dim),
+                    &status);
+        }
+    }
+    table = oskar_beam_table_create(tel, 128, 1, 1e-3,
+            mjd_start, time_inc_sec, 2, freq_hz, 1e6, 1, filename, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(compare_with_direct(table, tel, 0, mjd_start, time_inc_sec,
+            freq_hz, &status), 2e-3);
+
+    // Clean up.
+    remove(filename);
+    oskar_beam_table_free(table);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(beam_table, epoch_edges)
+{
+    int status = 0;
+    const int num_times = 8;
+    const double mjd_start = 51544.5, time_inc_sec = 300.0;
+    const double freq_hz = 50e6, max_error = 1e-3;
+    oskar_Telescope* tel = create_telescope(1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Use one epoch for all time steps. The beam moves across the sky
+    // during the epoch, so the table must be checked at the edges,
+    // not just at the middle where it was made.
+    oskar_BeamTable* table = oskar_beam_table_create(tel, 128, num_times,
+            max_error, mjd_start, time_inc_sec, num_times, freq_hz, 1e6, 1,
+            0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(1, oskar_beam_table_num_rejected(table));
+    for (int t = 0; t < num_times; t += num_times - 1)
+    {
+        const double diff = compare_with_direct(table, tel, t,
+                mjd_start, time_inc_sec, freq_hz, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_LT(diff, 2.0 * max_error) << "Time index " << t;
+    }
+
+    // A short epoch should be accepted.
+    oskar_beam_table_free(table);
+    table = oskar_beam_table_create(tel, 128, 1, max_error,
+            mjd_start, time_inc_sec, num_times, freq_hz, 1e6, 1,
+            0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_beam_table_num_rejected(table));
+    oskar_beam_table_free(table);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_interferometer.h"
+
+TEST(device_partition, auto_mode)
+{
+    // Devices of one kind share time ranges, if there are enough times.
+    EXPECT_EQ(1, oskar_interferometer_partition_by_time('A', 4, 0, 8));
+    EXPECT_EQ(1, oskar_interferometer_partition_by_time('A', 2, 2, 8));
+    EXPECT_EQ(0, oskar_interferometer_partition_by_time('A', 4, 0, 3));
+    EXPECT_EQ(0, oskar_interferometer_partition_by_time('A', 1, 0, 8));
+
+    // Mixed GPU and CPU devices use the queue of work units.
+    EXPECT_EQ(0, oskar_interferometer_partition_by_time('A', 3, 1, 8));
+    EXPECT_EQ(0, oskar_interferometer_partition_by_time('A', 8, 2, 8));
+}
+
+TEST(device_partition, explicit_mode)
+{
+    // An explicit choice is used even for mixed devices.
+    EXPECT_EQ(1, oskar_interferometer_partition_by_time('T', 3, 1, 8));
+    EXPECT_EQ(0, oskar_interferometer_partition_by_time('S', 4, 0, 8));
+}
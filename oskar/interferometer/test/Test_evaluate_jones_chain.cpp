@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_evaluate_jones_chain.h"
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+
+static void run_test(int type, int use_R, int use_gains, double tol)
+{
+#ifdef OSKAR_HAVE_CUDA
+    int location = OSKAR_GPU;
+#else
+    int location = OSKAR_CPU;
+#endif
+    const int num_sources = 500, num_stations = 40;
+    const int prec = oskar_type_precision(type);
+    const double I_min = 0.2, I_max = 1.0, freq_hz = 100e6;
+    int status = 0;
+
+    // Create the inputs.
+    oskar_Mem* l = oskar_mem_create(prec, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(prec, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(prec, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(prec, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(prec, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* gains = oskar_mem_create(type, OSKAR_CPU, num_stations,
+            &status);
+    oskar_Jones* E = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* R = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    srand(3);
+    oskar_mem_random_range(l, -1.0, 1.0, &status);
+    oskar_mem_random_range(m, -1.0, 1.0, &status);
+    oskar_mem_random_range(n, -1.0, 1.0, &status);
+    oskar_mem_random_range(I, 0.0, 1.0, &status);
+    oskar_mem_random_range(u, -100.0, 100.0, &status);
+    oskar_mem_random_range(v, -100.0, 100.0, &status);
+    oskar_mem_random_range(w, -100.0, 100.0, &status);
+    oskar_mem_random_range(gains, -1.0, 1.0, &status);
+    oskar_mem_random_range(oskar_jones_mem(E), -1.0, 1.0, &status);
+    oskar_mem_random_range(oskar_jones_mem(R), -1.0, 1.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate and join each term in turn, on the CPU.
+    oskar_Jones* K = oskar_jones_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* ER = oskar_jones_create_copy(R, OSKAR_CPU, &status);
+    oskar_Jones* J_staged = oskar_jones_create(type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+            freq_hz, I, I_min, I_max, 0, &status);
+    if (use_R) oskar_jones_join(ER, E, ER, &status);
+    oskar_jones_join(J_staged, K, use_R ? ER : E, &status);
+    if (use_gains) oskar_jones_apply_station_gains(J_staged, gains, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate the fused chain.
+    oskar_Mem* l_g = oskar_mem_create_copy(l, location, &status);
+    oskar_Mem* m_g = oskar_mem_create_copy(m, location, &status);
+    oskar_Mem* n_g = oskar_mem_create_copy(n, location, &status);
+    oskar_Mem* I_g = oskar_mem_create_copy(I, location, &status);
+    oskar_Mem* u_g = oskar_mem_create_copy(u, location, &status);
+    oskar_Mem* v_g = oskar_mem_create_copy(v, location, &status);
+    oskar_Mem* w_g = oskar_mem_create_copy(w, location, &status);
+    oskar_Mem* gains_g = oskar_mem_create_copy(gains, location, &status);
+    oskar_Jones* E_g = oskar_jones_create_copy(E, location, &status);
+    oskar_Jones* R_g = oskar_jones_create_copy(R, location, &status);
+    oskar_Jones* J_g = oskar_jones_create(type, location,
+            num_stations, num_sources, &status);
+    oskar_evaluate_jones_chain(J_g, num_sources, l_g, m_g, n_g,
+            u_g, v_g, w_g, freq_hz, I_g, I_min, I_max, 0, E_g,
+            use_R ? R_g : 0, use_gains ? gains_g : 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are consistent.
+    double max_err = 0.0, avg_err = 0.0;
+    oskar_mem_evaluate_relative_error(oskar_jones_mem_const(J_g),
+            oskar_jones_mem_const(J_staged), 0, &max_err, &avg_err, 0,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_err, tol);
+    EXPECT_LT(avg_err, tol);
+
+    // Clean up.
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_mem_free(gains, &status);
+    oskar_mem_free(l_g, &status);
+    oskar_mem_free(m_g, &status);
+    oskar_mem_free(n_g, &status);
+    oskar_mem_free(I_g, &status);
+    oskar_mem_free(u_g, &status);
+    oskar_mem_free(v_g, &status);
+    oskar_mem_free(w_g, &status);
+    oskar_mem_free(gains_g, &status);
+    oskar_jones_free(E, &status);
+    oskar_jones_free(R, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(ER, &status);
+    oskar_jones_free(J_staged, &status);
+    oskar_jones_free(E_g, &status);
+    oskar_jones_free(R_g, &status);
+    oskar_jones_free(J_g, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Jones_chain, scalar)
+{
+    run_test(OSKAR_SINGLE_COMPLEX, 0, 0, 1e-5);
+    run_test(OSKAR_SINGLE_COMPLEX, 0, 1, 1e-5);
+    run_test(OSKAR_DOUBLE_COMPLEX, 0, 0, 1e-10);
+    run_test(OSKAR_DOUBLE_COMPLEX, 0, 1, 1e-10);
+}
+
+TEST(Jones_chain, matrix)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        run_test(OSKAR_SINGLE_COMPLEX_MATRIX, i & 1, i & 2, 1e-5);
+        run_test(OSKAR_DOUBLE_COMPLEX_MATRIX, i & 1, i & 2, 1e-10);
+    }
+}
+
+TEST(Jones_chain, scalar_with_R)
+{
+    int status = 0;
+    oskar_Jones* J = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            1, 1, &status);
+    oskar_Mem* c = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1, &status);
+    oskar_evaluate_jones_chain(J, 1, c, c, c, c, c, c, 1e8, c, 0.0, 1.0, 0,
+            J, J, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_BAD_DATA_TYPE, status);
+    status = 0;
+    oskar_mem_free(c, &status);
+    oskar_jones_free(J, &status);
+}
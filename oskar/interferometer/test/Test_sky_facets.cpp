@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "correlate/oskar_cross_correlate.h"
+#include "interferometer/oskar_sky_facets.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_sky.h"
+#include "utility/oskar_get_error_string.h"
+#include <cfloat>
+#include <cstdlib>
+
+static void convert(oskar_Mem** mem, int precision, int* status)
+{
+    oskar_Mem* t = oskar_mem_convert_precision(*mem, precision, status);
+    oskar_mem_free(*mem, status);
+    *mem = t;
+}
+
+// Sets Jones matrices to a constant, nearly diagonal gain for each station,
+// multiplied by the interferometer phase of each direction.
+static void set_jones(oskar_Jones* jones, int matrix, const double* gains,
+        const oskar_Mem* const uvw[3], const oskar_Mem* const dir[3],
+        double inv_wavelength, int* status)
+{
+    oskar_Mem *u, *v, *w, *l, *m, *n;
+    u = oskar_mem_convert_precision(uvw[0], OSKAR_DOUBLE, status);
+    v = oskar_mem_convert_precision(uvw[1], OSKAR_DOUBLE, status);
+    w = oskar_mem_convert_precision(uvw[2], OSKAR_DOUBLE, status);
+    l = oskar_mem_convert_precision(dir[0], OSKAR_DOUBLE, status);
+    m = oskar_mem_convert_precision(dir[1], OSKAR_DOUBLE, status);
+    n = oskar_mem_convert_precision(dir[2], OSKAR_DOUBLE, status);
+    const int num_stations = oskar_jones_num_stations(jones);
+    const int num_sources = oskar_jones_num_sources(jones);
+    const int num_values = matrix ? 8 : 2;
+    const int type = oskar_jones_type(jones);
+    oskar_Mem* J = oskar_mem_create((type & ~OSKAR_SINGLE) | OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations * num_sources, status);
+    double* j = oskar_mem_double(J, status);
+    for (int s = 0; s < num_stations; ++s)
+    {
+        const double* g = &gains[8 * s];
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const double phase = 2.0 * M_PI * inv_wavelength * (
+                    oskar_mem_double(u, status)[s] *
+                    oskar_mem_double(l, status)[i] +
+                    oskar_mem_double(v, status)[s] *
+                    oskar_mem_double(m, status)[i] +
+                    oskar_mem_double(w, status)[s] *
+                    (oskar_mem_double(n, status)[i] - 1.0));
+            const double re = cos(phase), im = sin(phase);
+            double* t = &j[num_values * (s * num_sources + i)];
+            for (int k = 0; k < num_values; k += 2)
+            {
+                t[k] = g[k] * re - g[k + 1] * im;
+                t[k + 1] = g[k] * im + g[k + 1] * re;
+            }
+        }
+    }
+    convert(&J, oskar_type_precision(type), status);
+    oskar_mem_copy(oskar_jones_mem(jones), J, status);
+    oskar_mem_free(J, status);
+    oskar_mem_free(u, status);
+    oskar_mem_free(v, status);
+    oskar_mem_free(w, status);
+    oskar_mem_free(l, status);
+    oskar_mem_free(m, status);
+    oskar_mem_free(n, status);
+}
+
+class sky_facets : public ::testing::Test
+{
+protected:
+    static const int num_sources = 3000;
+    static const int num_stations = 24;
+
+    void run_test(int precision, int matrix, double pixel_oversample,
+            double w_range, double bandwidth_hz, double time_average_sec)
+    {
+        int status = 0, type = precision | OSKAR_COMPLEX;
+        if (matrix) type |= OSKAR_MATRIX;
+        const double frequency_hz = 100e6;
+        const double inv_wavelength = frequency_hz / 299792458.0;
+        const double ra0 = 0.1, dec0 = 0.8;
+        oskar_Mem *uvw[3], *src_ext[3];
+        oskar_Telescope* tel = oskar_telescope_create(precision, OSKAR_CPU,
+                num_stations, &status);
+        oskar_telescope_set_channel_bandwidth(tel, bandwidth_hz);
+        oskar_telescope_set_time_average(tel, time_average_sec);
+        oskar_telescope_set_phase_centre(tel,
+                OSKAR_COORDS_RADEC, ra0, dec0);
+        for (int i = 0; i < 3; ++i)
+        {
+            uvw[i] = oskar_mem_create(precision, OSKAR_CPU, num_stations,
+                    &status);
+            src_ext[i] = oskar_mem_create(precision, OSKAR_CPU, num_sources,
+                    &status);
+            oskar_mem_clear_contents(src_ext[i], &status);
+        }
+
+        // A compact array, and a field containing many faint sources
+        // and a few bright ones.
+        srand(5);
+        oskar_mem_random_range(uvw[0], -300.0, 300.0, &status);
+        oskar_mem_random_range(uvw[1], -300.0, 300.0, &status);
+        oskar_mem_random_range(uvw[2], -w_range, w_range, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, 0),
+                -300.0, 300.0, &status);
+        oskar_mem_random_range(
+                oskar_telescope_station_true_offset_ecef_metres(tel, 1),
+                -300.0, 300.0, &status);
+        oskar_Sky* sky = oskar_sky_create(precision, OSKAR_CPU, num_sources,
+                &status);
+        oskar_mem_random_range(oskar_sky_ra_rad(sky), ra0 - 0.1, ra0 + 0.1,
+                &status);
+        oskar_mem_random_range(oskar_sky_dec_rad(sky), dec0 - 0.06,
+                dec0 + 0.06, &status);
+        oskar_mem_random_range(oskar_sky_I(sky), 0.0, 1.0, &status);
+        oskar_mem_random_range(oskar_sky_Q(sky), -0.1, 0.1, &status);
+        oskar_mem_random_range(oskar_sky_U(sky), -0.1, 0.1, &status);
+        oskar_mem_random_range(oskar_sky_V(sky), -0.01, 0.01, &status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            double I = oskar_mem_get_element(oskar_sky_I(sky), i, &status);
+            I = (i % 100 == 0) ? 10.0 : 0.01 * pow(I, 4.0);
+            oskar_mem_set_element_real(oskar_sky_I(sky), i, I, &status);
+        }
+        oskar_sky_evaluate_relative_directions(sky, ra0, dec0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        double gains[8 * num_stations];
+        for (int s = 0; s < num_stations; ++s)
+        {
+            for (int k = 0; k < 8; ++k)
+            {
+                const bool diagonal_real = (k == 0 || k == 6);
+                const double r = (double) rand() / RAND_MAX;
+                gains[8 * s + k] = diagonal_real ? 0.8 + 0.4 * r : 0.1 * r;
+            }
+        }
+
+        // Choose the pixel size from the longest baseline.
+        double uv_max = 0.0;
+        oskar_Mem* u = oskar_mem_convert_precision(uvw[0], OSKAR_DOUBLE,
+                &status);
+        oskar_Mem* v = oskar_mem_convert_precision(uvw[1], OSKAR_DOUBLE,
+                &status);
+        for (int p = 0; p < num_stations; ++p)
+        {
+            for (int q = p + 1; q < num_stations; ++q)
+            {
+                const double du = oskar_mem_double(u, &status)[p] -
+                        oskar_mem_double(u, &status)[q];
+                const double dv = oskar_mem_double(v, &status)[p] -
+                        oskar_mem_double(v, &status)[q];
+                const double r = sqrt(du * du + dv * dv) * inv_wavelength;
+                if (r > uv_max) uv_max = r;
+            }
+        }
+        oskar_mem_free(u, &status);
+        oskar_mem_free(v, &status);
+        const double cell_size_rad = 1.0 / (2.0 * pixel_oversample * uv_max);
+
+        // Make the facets.
+        oskar_SkyFacets* facets = oskar_sky_facets_create(precision, &status);
+        oskar_sky_facets_set_up(facets, sky, 0.03, cell_size_rad, matrix, 1,
+                &status);
+        oskar_sky_facets_update(facets, sky, 0, -DBL_MAX, DBL_MAX, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int num_facets = oskar_sky_facets_num_facets(facets);
+        EXPECT_GT(num_facets, 10);
+        EXPECT_LT(num_facets, 100);
+
+        // Evaluate visibilities exactly, and using the facets.
+        const oskar_Mem* src_dir[3] = {oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky)};
+        const oskar_Mem* src_flux[4] = {oskar_sky_I_const(sky),
+                oskar_sky_Q_const(sky), oskar_sky_U_const(sky),
+                oskar_sky_V_const(sky)};
+        const oskar_Mem* facet_dir[3];
+        for (int i = 0; i < 3; ++i)
+            facet_dir[i] = oskar_sky_facets_lmn_const(facets, i);
+        oskar_Jones* jones = oskar_jones_create(type, OSKAR_CPU, num_stations,
+                num_sources, &status);
+        oskar_Jones* jones_facets = oskar_jones_create(type, OSKAR_CPU,
+                num_stations, num_facets, &status);
+        set_jones(jones, matrix, gains, uvw, src_dir, inv_wavelength,
+                &status);
+        set_jones(jones_facets, matrix, gains, uvw, facet_dir,
+                inv_wavelength, &status);
+        const int num_baselines = oskar_telescope_num_baselines(tel);
+        oskar_Mem* vis_exact = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_Mem* vis_facets = oskar_mem_create(type, OSKAR_CPU,
+                num_baselines, &status);
+        oskar_mem_clear_contents(vis_exact, &status);
+        oskar_mem_clear_contents(vis_facets, &status);
+        double max_error = 0.0;
+        oskar_cross_correlate(0, num_sources, jones, src_flux, src_dir,
+                src_ext, tel, uvw, 1.0, frequency_hz, 0, vis_exact, &status);
+        oskar_sky_facets_predict(facets, 0, jones_facets, tel, uvw, 1.0,
+                frequency_hz, 0, 0, vis_facets, &max_error, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Check the differences are within the error bound,
+        // and that the bound is useful.
+        convert(&vis_exact, OSKAR_DOUBLE, &status);
+        convert(&vis_facets, OSKAR_DOUBLE, &status);
+        const double* v1 = oskar_mem_double_const(vis_exact, &status);
+        const double* v2 = oskar_mem_double_const(vis_facets, &status);
+        const int num_values = 2 * num_baselines * (matrix ? 4 : 1);
+        double max_diff = 0.0, max_abs = 0.0;
+        for (int i = 0; i < num_values; ++i)
+        {
+            const double diff = fabs(v1[i] - v2[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (fabs(v1[i]) > max_abs) max_abs = fabs(v1[i]);
+        }
+        const double rounding = max_abs *
+                (precision == OSKAR_DOUBLE ? 1e-12 : 1e-5);
+        EXPECT_LE(max_diff, max_error + rounding);
+        EXPECT_GT(max_error, 0.0);
+        EXPECT_LT(max_error, 0.2 * max_abs);
+        RecordProperty("MaxDiff", int(1e6 * max_diff / max_abs));
+        RecordProperty("MaxBound", int(1e6 * max_error / max_abs));
+
+        oskar_sky_facets_free(facets, &status);
+        oskar_jones_free(jones, &status);
+        oskar_jones_free(jones_facets, &status);
+        oskar_mem_free(vis_exact, &status);
+        oskar_mem_free(vis_facets, &status);
+        for (int i = 0; i < 3; ++i)
+        {
+            oskar_mem_free(uvw[i], &status);
+            oskar_mem_free(src_ext[i], &status);
+        }
+        oskar_sky_free(sky, &status);
+        oskar_telescope_free(tel, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+};
+
+TEST_F(sky_facets, matrix_double)
+{
+    run_test(OSKAR_DOUBLE, 1, 4.0, 20.0, 0.0, 0.0);
+}
+
+TEST_F(sky_facets, matrix_double_no_w)
+{
+    run_test(OSKAR_DOUBLE, 1, 8.0, 0.0, 0.0, 0.0);
+}
+
+TEST_F(sky_facets, matrix_double_smearing)
+{
+    run_test(OSKAR_DOUBLE, 1, 4.0, 20.0, 100e3, 10.0);
+}
+
+TEST_F(sky_facets, scalar_double)
+{
+    run_test(OSKAR_DOUBLE, 0, 4.0, 20.0, 0.0, 0.0);
+}
+
+TEST_F(sky_facets, matrix_single)
+{
+    run_test(OSKAR_SINGLE, 1, 4.0, 20.0, 0.0, 0.0);
+}
+
+TEST_F(sky_facets, scalar_single)
+{
+    run_test(OSKAR_SINGLE, 0, 4.0, 20.0, 0.0, 0.0);
+}
+
+TEST_F(sky_facets, facet_fluxes_sum_to_total)
+{
+    int status = 0;
+    const int n = 500;
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    srand(1);
+    oskar_mem_random_range(oskar_sky_ra_rad(sky), -0.2, 0.2, &status);
+    oskar_mem_random_range(oskar_sky_dec_rad(sky), -0.2, 0.2, &status);
+    oskar_mem_random_range(oskar_sky_I(sky), 0.0, 1.0, &status);
+    oskar_mem_random_range(oskar_sky_Q(sky), -0.1, 0.1, &status);
+    oskar_sky_evaluate_relative_directions(sky, 0.0, 0.0, &status);
+    oskar_SkyFacets* facets = oskar_sky_facets_create(OSKAR_DOUBLE, &status);
+    oskar_sky_facets_set_up(facets, sky, 0.1, 0.01, 1, 2, &status);
+    oskar_sky_facets_update(facets, sky, 1, -DBL_MAX, DBL_MAX, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(16, oskar_sky_facets_num_facets(facets));
+    for (int s = 0; s < 2; ++s)
+    {
+        double sum_src = 0.0, sum_facets = 0.0;
+        const oskar_Mem* src = s == 0 ?
+                oskar_sky_I_const(sky) : oskar_sky_Q_const(sky);
+        const oskar_Mem* f = oskar_sky_facets_stokes_const(facets, 1, s);
+        for (int i = 0; i < n; ++i)
+            sum_src += oskar_mem_double_const(src, &status)[i];
+        for (int i = 0; i < oskar_sky_facets_num_facets(facets); ++i)
+            sum_facets += oskar_mem_double_const(f, &status)[i];
+        EXPECT_NEAR(sum_src, sum_facets, 1e-10);
+    }
+
+    // A sky model with a different number of sources is rejected.
+    oskar_sky_resize(sky, n - 1, &status);
+    oskar_sky_facets_update(facets, sky, 0, -DBL_MAX, DBL_MAX, &status);
+    EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+    status = 0;
+    oskar_sky_facets_free(facets, &status);
+    oskar_sky_free(sky, &status);
+}
@@ -4,7 +4,7 @@
         const int n, GLOBAL_IN(FP, x), GLOBAL_IN(FP, y),\
         const FP inv_2_var, GLOBAL_OUT(FP2, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const FP x_ = x[i]; const FP y_ = y[i];\
     const FP arg = -(x_ * x_ + y_ * y_) * inv_2_var;\
     z[i].x = exp(arg); z[i].y = (FP) 0;\
@@ -16,7 +16,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const int n, GLOBAL_IN(FP, x), GLOBAL_IN(FP, y),\
         const FP inv_2_var, GLOBAL_OUT(FP4c, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const FP x_ = x[i]; const FP y_ = y[i];\
     const FP arg = -(x_ * x_ + y_ * y_) * inv_2_var;\
     const FP value = exp(arg);\
@@ -5,7 +5,7 @@
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP* a, GLOBAL const FP* b, GLOBAL FP* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     c[i + off_c] = a[i + off_a] + b[i + off_b];\
     KERNEL_LOOP_END\
 }\
@@ -5,7 +5,7 @@
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP* a, GLOBAL const FP* b, GLOBAL FP* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     c[i + off_c] = a[i + off_a] * b[i + off_b];\
     KERNEL_LOOP_END\
 }\
@@ -16,7 +16,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP2* a, GLOBAL const FP2* b, GLOBAL FP2* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP2 cc;\
     const FP2 ac = a[i + off_a];\
     const FP2 bc = b[i + off_b];\
@@ -31,7 +31,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP2* a, GLOBAL const FP2* b, GLOBAL FP4c* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP2 cc;\
     const FP2 ac = a[i + off_a];\
     const FP2 bc = b[i + off_b];\
@@ -51,7 +51,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP2* a, GLOBAL const FP4c* b, GLOBAL FP4c* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     const FP2 ac = a[i + off_a];\
     FP4c bc = b[i + off_b];\
     OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, bc, ac)\
@@ -65,7 +65,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP4c* a, GLOBAL const FP2* b, GLOBAL FP4c* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP4c ac = a[i + off_a];\
     const FP2 bc = b[i + off_b];\
     OSKAR_MUL_COMPLEX_MATRIX_COMPLEX_SCALAR_IN_PLACE(FP2, ac, bc)\
@@ -79,7 +79,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int off_c, const unsigned int n,\
         GLOBAL const FP4c* a, GLOBAL const FP4c* b, GLOBAL FP4c* c)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP4c ac = a[i + off_a];\
     const FP4c bc = b[i + off_b];\
     OSKAR_MUL_COMPLEX_MATRIX_IN_PLACE(FP2, ac, bc)\
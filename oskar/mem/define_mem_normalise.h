@@ -5,7 +5,7 @@
         GLOBAL_OUT(FP, a), const unsigned int idx)\
 {\
     const FP scal = ((FP)1) / a[idx];\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     const unsigned int j = offset + i;\
     if (j != idx) a[j] *= scal;\
     KERNEL_LOOP_END\
@@ -19,7 +19,7 @@ OSKAR_REGISTER_KERNEL(NAME)
     const FP2 val = a[idx];\
     const FP amp = val.x * val.x + val.y * val.y;\
     const FP scal = RSQRT(amp);\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     const unsigned int j = offset + i;\
     if (j != idx) {\
         a[j].x *= scal; a[j].y *= scal;\
@@ -38,7 +38,7 @@ OSKAR_REGISTER_KERNEL(NAME)
             val.c.x * val.c.x + val.c.y * val.c.y +\
             val.d.x * val.d.x + val.d.y * val.d.y) / (FP)2;\
     const FP scal = RSQRT(amp);\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     const unsigned int j = offset + i;\
     if (j != idx) {\
         a[j].a.x *= scal; a[j].a.y *= scal;\
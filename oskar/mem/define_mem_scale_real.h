@@ -3,7 +3,7 @@
 #define OSKAR_MEM_SCALE_REAL(NAME, FP) KERNEL(NAME) (const unsigned int offset,\
         const unsigned int n, const FP val, GLOBAL FP* a)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     a[i + offset] *= val;\
     KERNEL_LOOP_END\
 }\
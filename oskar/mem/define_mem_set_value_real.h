@@ -4,7 +4,7 @@
         const unsigned int offset, const unsigned int n, const FP val,\
         GLOBAL FP* a)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     a[i + offset] = val;\
     KERNEL_LOOP_END\
 }\
@@ -14,7 +14,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int offset, const unsigned int n, const FP val,\
         GLOBAL FP2* a)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP2 v; v.x = val; v.y = (FP) 0;\
     a[i + offset] = v;\
     KERNEL_LOOP_END\
@@ -25,7 +25,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const unsigned int offset, const unsigned int n, const FP val,\
         GLOBAL FP4c* a)\
 {\
-    KERNEL_LOOP_X(unsigned int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(unsigned int, i, 0, n)\
     FP4c v;\
     v.a.x = val; v.a.y = (FP) 0;\
     MAKE_ZERO2(FP, v.b);\
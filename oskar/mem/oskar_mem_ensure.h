@@ -50,6 +50,10 @@ extern "C" {
  * If the block is already large enough, no reallocation is performed.
  * Existing data in the memory block is preserved.
  *
+ * If the array is managed by the memory pool (see oskar_mem_pool.h),
+ * its allocation grows geometrically, so that repeated calls with
+ * slowly increasing sizes only reallocate occasionally.
+ *
  * An error is returned if the data type of the memory block is unsupported.
  *
  * @param[in] mem Pointer to memory block to resize.
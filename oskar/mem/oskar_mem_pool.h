@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_MEM_POOL_H_
+#define OSKAR_MEM_POOL_H_
+
+/**
+ * @file oskar_mem_pool.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Enables or disables pooled allocation of array memory.
+ *
+ * @details
+ * When enabled, arrays created afterwards that own their memory are given
+ * blocks rounded up to a size class, and keep them when they shrink.
+ * Arrays enlarged by oskar_mem_ensure() grow geometrically, so that
+ * work buffers sized per chunk or per station are only reallocated
+ * a few times. Host memory released by an array is kept in a free list
+ * for its size class, to be reused by the next allocation of that size.
+ * Each thread keeps its own free lists (up to 64 MB), and passes
+ * any further blocks to free lists shared by all threads (up to 1 GB).
+ *
+ * When disabled (the default), every resize is passed directly to the
+ * system allocator.
+ *
+ * The pool is shared by everything in the process, so this should
+ * normally be set only by applications.
+ *
+ * @param[in] value If true, enable the pool; if false, disable it.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_set_enabled(int value);
+
+/**
+ * @brief
+ * Returns true if pooled allocation of array memory is enabled.
+ */
+OSKAR_EXPORT
+int oskar_mem_pool_enabled(void);
+
+/**
+ * @brief
+ * Returns cached host memory in the pool to the system.
+ *
+ * @details
+ * This frees the blocks in the shared free lists and those held by
+ * the calling thread. Blocks held by other threads are moved to the
+ * shared free lists when those threads exit.
+ *
+ * Arrays that are still allocated are not affected.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_release(void);
+
+/**
+ * @brief
+ * Returns the allocation counters of the pool.
+ *
+ * @details
+ * Any of the pointers may be NULL, if the value is not required.
+ *
+ * Counts from other threads are included once they have exited,
+ * or have needed to use the shared free lists.
+ *
+ * @param[out] num_allocs    Number of blocks obtained from the system.
+ * @param[out] num_reused    Number of blocks reused from the free lists.
+ * @param[out] num_in_place  Number of resizes done without reallocation.
+ * @param[out] bytes_cached  Bytes held in the shared free lists and those
+ *                           of the calling thread.
+ * @param[out] bytes_peak    Peak number of bytes obtained from the system.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_counters(size_t* num_allocs, size_t* num_reused,
+        size_t* num_in_place, size_t* bytes_cached, size_t* bytes_peak);
+
+/**
+ * @brief
+ * Resets the allocation counters of the pool.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_reset_counters(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_POOL_H_ */
@@ -49,6 +49,8 @@ struct oskar_Mem
     int location;        /* Enumerated address space of data pointer. */
     size_t num_elements; /* Number of elements in memory block. */
     int owner;           /* Flag set if the structure owns the memory. */
+    int pooled;          /* Flag set if the memory is managed by the pool. */
+    size_t capacity;     /* Number of bytes allocated, if pooled. */
     void* data;          /* Data pointer. */
 
 #ifdef OSKAR_HAVE_OPENCL
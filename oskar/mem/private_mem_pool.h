@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_MEM_POOL_H_
+#define OSKAR_PRIVATE_MEM_POOL_H_
+
+#include <stddef.h>
+
+#include "mem/private_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns the size class used for a block of the given number of bytes. */
+size_t oskar_mem_pool_block_size(size_t bytes);
+
+/* Returns an uninitialised host block of oskar_mem_pool_block_size(bytes),
+ * or NULL if the allocation failed. */
+void* oskar_mem_pool_alloc(size_t bytes);
+
+/* Returns a host block of the given size class to the pool. */
+void oskar_mem_pool_free(void* ptr, size_t block_size);
+
+/* Resizes a pooled array, allocating at least min_bytes if it must grow. */
+void oskar_mem_realloc_pooled(oskar_Mem* mem, size_t num_elements,
+        size_t min_bytes, int* status);
+
+/* Records a resize that was done without reallocation. */
+void oskar_mem_pool_count_in_place(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
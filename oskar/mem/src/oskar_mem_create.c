@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <stdlib.h>
@@ -57,6 +58,8 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->location = location;
     mem->num_elements = 0;
     mem->owner = 1;
+    mem->pooled = oskar_mem_pool_enabled();
+    mem->capacity = 0;
     mem->data = NULL;
 
     /* Check if allocation should happen or not. */
@@ -72,6 +75,13 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     }
     const size_t bytes = num_elements * element_size;
 
+    /* Pooled arrays are given a whole size class. */
+    if (mem->pooled)
+    {
+        oskar_mem_realloc_pooled(mem, num_elements, 0, status);
+        return mem;
+    }
+
     /* Check whether the memory should be on the host or the device. */
     mem->num_elements = num_elements;
     if (location == OSKAR_CPU)
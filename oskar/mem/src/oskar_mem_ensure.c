@@ -28,6 +28,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,7 +36,15 @@ extern "C" {
 
 void oskar_mem_ensure(oskar_Mem* mem, size_t num_elements, int* status)
 {
-    if (oskar_mem_length(mem) < num_elements)
+    if (oskar_mem_length(mem) >= num_elements) return;
+
+    /* Pooled arrays grow by at least half their capacity each time,
+     * so that a buffer sized for each chunk is only reallocated
+     * a few times over a run. */
+    if (mem->owner && mem->pooled)
+        oskar_mem_realloc_pooled(mem, num_elements,
+                mem->capacity + mem->capacity / 2, status);
+    else
         oskar_mem_realloc(mem, num_elements, status);
 }
 
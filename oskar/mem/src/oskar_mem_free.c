@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 
 #include <stdlib.h>
 
@@ -65,8 +66,11 @@ void oskar_mem_free(oskar_Mem* mem, int* status)
         /* Check whether the memory is on the host or the device. */
         if (mem->location == OSKAR_CPU)
         {
-            /* Free host memory. */
-            free(mem->data);
+            /* Free host memory, or return it to the pool. */
+            if (mem->pooled)
+                oskar_mem_pool_free(mem->data, mem->capacity);
+            else
+                free(mem->data);
         }
         else if (mem->location == OSKAR_GPU)
         {
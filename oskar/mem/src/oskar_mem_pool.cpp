@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <cstdlib>
+
+#include "mem/oskar_mem_pool.h"
+#include "mem/private_mem_pool.h"
+#include "utility/oskar_thread.h"
+
+/* Blocks smaller than this are rounded up to it. */
+#define MIN_BLOCK_BYTES ((size_t) 256)
+
+/* Limit on the total size of blocks held in the shared free lists. */
+#define MAX_CACHED_BYTES ((size_t) 1 << 30)
+
+/* Blocks larger than this are returned to the system when released. */
+#define MAX_CACHED_BLOCK_BYTES (MAX_CACHED_BYTES / 4)
+
+/* Limit on the total size of blocks held by each thread. */
+#define MAX_THREAD_CACHED_BYTES ((size_t) 1 << 26)
+
+/* Four size classes per power of two, so at most 25% of a block is unused. */
+#define CLASSES_PER_OCTAVE 4
+#define NUM_CLASSES (CLASSES_PER_OCTAVE * 8 * sizeof(size_t))
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct LocalMutex
+{
+    oskar_Mutex* m;
+    LocalMutex()  { this->m = oskar_mutex_create(); }
+    ~LocalMutex() { oskar_mutex_free(this->m); }
+    void lock()   { oskar_mutex_lock(this->m); }
+    void unlock() { oskar_mutex_unlock(this->m); }
+};
+static LocalMutex mutex_;
+
+/* Shared free lists and counters, protected by the mutex. */
+static int enabled_ = 0;
+static FreeBlock* free_lists_[NUM_CLASSES];
+static size_t num_allocs_ = 0, num_reused_ = 0, num_in_place_ = 0;
+static size_t bytes_cached_ = 0, bytes_in_use_ = 0, bytes_peak_ = 0;
+
+/* Free lists kept by each thread, so that a block released and requested
+ * again by the same thread does not need the mutex. Counters are kept
+ * locally, and added to the shared ones whenever the mutex is taken.
+ * The blocks must be handed back when the thread exits, which needs a
+ * destructor, so this uses thread_local rather than THREAD_LOCAL. */
+struct ThreadCache
+{
+    FreeBlock* lists[NUM_CLASSES];
+    size_t bytes, num_reused, num_in_place;
+    ThreadCache();
+    ~ThreadCache();
+};
+static thread_local ThreadCache cache_;
+
+static unsigned int log2_floor(size_t v)
+{
+    unsigned int r = 0;
+    while (v >>= 1) r++;
+    return r;
+}
+
+/* Returns the index of the size class for a block of exactly this size. */
+static size_t class_index(size_t block_size)
+{
+    if (block_size <= MIN_BLOCK_BYTES) return 0;
+    const unsigned int k = log2_floor(block_size - 1);
+    const size_t step = (size_t)1 << (k - 2);
+    return 1 + CLASSES_PER_OCTAVE * (k - log2_floor(MIN_BLOCK_BYTES)) +
+            (block_size / step - CLASSES_PER_OCTAVE - 1);
+}
+
+/* Returns the size of blocks in a size class (the inverse of the above). */
+static size_t class_block_size(size_t i)
+{
+    if (i == 0) return MIN_BLOCK_BYTES;
+    const size_t octave = (i - 1) / CLASSES_PER_OCTAVE;
+    const size_t m = CLASSES_PER_OCTAVE + 1 + (i - 1) % CLASSES_PER_OCTAVE;
+    return m << (octave + log2_floor(MIN_BLOCK_BYTES) - 2);
+}
+
+/* Adds the counters of a thread to the shared ones.
+ * The mutex must be locked. */
+static void flush_counters(ThreadCache* c)
+{
+    num_reused_ += c->num_reused;
+    num_in_place_ += c->num_in_place;
+    c->num_reused = c->num_in_place = 0;
+}
+
+/* Moves the blocks of a thread to the shared free lists, and returns any
+ * that do not fit to the system. The mutex must be locked. */
+static void flush_blocks(ThreadCache* c)
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        if (!c->lists[i]) continue;
+        const size_t block_size = class_block_size(i);
+        while (c->lists[i])
+        {
+            FreeBlock* node = c->lists[i];
+            c->lists[i] = node->next;
+            if (bytes_cached_ + block_size <= MAX_CACHED_BYTES)
+            {
+                node->next = free_lists_[i];
+                free_lists_[i] = node;
+                bytes_cached_ += block_size;
+            }
+            else
+            {
+                free(node);
+                bytes_in_use_ -= block_size;
+            }
+        }
+    }
+    c->bytes = 0;
+}
+
+ThreadCache::ThreadCache() : bytes(0), num_reused(0), num_in_place(0)
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i) this->lists[i] = 0;
+}
+
+ThreadCache::~ThreadCache()
+{
+    mutex_.lock();
+    flush_counters(this);
+    flush_blocks(this);
+    mutex_.unlock();
+}
+
+extern "C" {
+
+size_t oskar_mem_pool_block_size(size_t bytes)
+{
+    if (bytes <= MIN_BLOCK_BYTES) return MIN_BLOCK_BYTES;
+    const size_t step = (size_t)1 << (log2_floor(bytes - 1) - 2);
+    return ((bytes + step - 1) / step) * step;
+}
+
+void* oskar_mem_pool_alloc(size_t bytes)
+{
+    void* ptr = 0;
+    const size_t block_size = oskar_mem_pool_block_size(bytes);
+    const size_t i = class_index(block_size);
+
+    /* Reuse a block released by this thread, if there is one. */
+    ThreadCache* c = &cache_;
+    if (c->lists[i])
+    {
+        ptr = (void*) c->lists[i];
+        c->lists[i] = c->lists[i]->next;
+        c->bytes -= block_size;
+        c->num_reused++;
+        return ptr;
+    }
+
+    /* Otherwise try the shared free list. */
+    mutex_.lock();
+    flush_counters(c);
+    if (free_lists_[i])
+    {
+        ptr = (void*) free_lists_[i];
+        free_lists_[i] = free_lists_[i]->next;
+        bytes_cached_ -= block_size;
+        num_reused_++;
+    }
+    mutex_.unlock();
+    if (ptr) return ptr;
+
+    /* Nothing to reuse, so get a new block. The caller initialises it,
+     * which places its pages on the memory node of the calling thread. */
+    ptr = malloc(block_size);
+    if (!ptr) return 0;
+    mutex_.lock();
+    num_allocs_++;
+    bytes_in_use_ += block_size;
+    if (bytes_in_use_ > bytes_peak_) bytes_peak_ = bytes_in_use_;
+    mutex_.unlock();
+    return ptr;
+}
+
+void oskar_mem_pool_free(void* ptr, size_t block_size)
+{
+    if (!ptr) return;
+    const size_t i = class_index(block_size);
+    const int cache = enabled_ && block_size <= MAX_CACHED_BLOCK_BYTES;
+
+    /* Keep the block in this thread's free list, if there is room. */
+    ThreadCache* c = &cache_;
+    FreeBlock* node = (FreeBlock*) ptr;
+    if (cache && c->bytes + block_size <= MAX_THREAD_CACHED_BYTES)
+    {
+        node->next = c->lists[i];
+        c->lists[i] = node;
+        c->bytes += block_size;
+        return;
+    }
+
+    /* Otherwise put it in the shared free list, or free it. */
+    mutex_.lock();
+    flush_counters(c);
+    if (cache && bytes_cached_ + block_size <= MAX_CACHED_BYTES)
+    {
+        node->next = free_lists_[i];
+        free_lists_[i] = node;
+        bytes_cached_ += block_size;
+        ptr = 0;
+    }
+    else
+        bytes_in_use_ -= block_size;
+    mutex_.unlock();
+    free(ptr);
+}
+
+void oskar_mem_pool_count_in_place(void)
+{
+    cache_.num_in_place++;
+}
+
+void oskar_mem_pool_set_enabled(int value)
+{
+    enabled_ = value;
+    if (!value) oskar_mem_pool_release();
+}
+
+int oskar_mem_pool_enabled(void)
+{
+    return enabled_;
+}
+
+void oskar_mem_pool_release(void)
+{
+    ThreadCache* c = &cache_;
+    mutex_.lock();
+    flush_counters(c);
+    flush_blocks(c);
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        while (free_lists_[i])
+        {
+            FreeBlock* node = free_lists_[i];
+            free_lists_[i] = node->next;
+            free(node);
+        }
+    }
+    bytes_in_use_ -= bytes_cached_;
+    bytes_cached_ = 0;
+    mutex_.unlock();
+}
+
+void oskar_mem_pool_counters(size_t* num_allocs, size_t* num_reused,
+        size_t* num_in_place, size_t* bytes_cached, size_t* bytes_peak)
+{
+    ThreadCache* c = &cache_;
+    mutex_.lock();
+    flush_counters(c);
+    if (num_allocs) *num_allocs = num_allocs_;
+    if (num_reused) *num_reused = num_reused_;
+    if (num_in_place) *num_in_place = num_in_place_;
+    if (bytes_cached) *bytes_cached = bytes_cached_ + c->bytes;
+    if (bytes_peak) *bytes_peak = bytes_peak_;
+    mutex_.unlock();
+}
+
+void oskar_mem_pool_reset_counters(void)
+{
+    ThreadCache* c = &cache_;
+    mutex_.lock();
+    c->num_reused = c->num_in_place = 0;
+    num_allocs_ = num_reused_ = num_in_place_ = 0;
+    bytes_peak_ = bytes_in_use_;
+    mutex_.unlock();
+}
+
+} /* extern "C" */
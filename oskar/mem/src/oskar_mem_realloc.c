@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <string.h>
@@ -67,6 +68,13 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     if (new_size == old_size)
         return;
 
+    /* Use the pool, if the array is managed by it. */
+    if (mem->pooled)
+    {
+        oskar_mem_realloc_pooled(mem, num_elements, 0, status);
+        return;
+    }
+
     /* Check memory location. */
     if (mem->location == OSKAR_CPU)
     {
@@ -170,6 +178,120 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     }
 }
 
+void oskar_mem_realloc_pooled(oskar_Mem* mem, size_t num_elements,
+        size_t min_bytes, int* status)
+{
+    void* mem_new = 0;
+    if (*status) return;
+    const size_t element_size = oskar_mem_element_size(mem->type);
+    const size_t new_size = num_elements * element_size;
+    const size_t old_size = mem->num_elements * element_size;
+    const size_t copy_size = (old_size > new_size) ? new_size : old_size;
+
+    /* Resize in place if the existing block is large enough.
+     * Only an empty array gives up its block. */
+    if (new_size > 0 && new_size <= mem->capacity)
+    {
+        if (mem->location == OSKAR_CPU && new_size > old_size)
+            memset((char*)(mem->data) + old_size, 0, new_size - old_size);
+        mem->num_elements = num_elements;
+        oskar_mem_pool_count_in_place();
+        return;
+    }
+
+    /* Get a new block of the required size class. */
+    const size_t block_size = (new_size == 0) ? 0 :
+            oskar_mem_pool_block_size(new_size > min_bytes ?
+                    new_size : min_bytes);
+    if (mem->location == OSKAR_CPU)
+    {
+        if (block_size > 0)
+        {
+            mem_new = oskar_mem_pool_alloc(block_size);
+            if (!mem_new)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
+            if (copy_size > 0) memcpy(mem_new, mem->data, copy_size);
+            memset((char*)mem_new + copy_size, 0, new_size - copy_size);
+        }
+        oskar_mem_pool_free(mem->data, mem->capacity);
+        mem->data = mem_new;
+    }
+    else if (mem->location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        int cuda_error = 0;
+        if (block_size > 0)
+        {
+            cuda_error = (int)cudaMalloc(&mem_new, block_size);
+            if (cuda_error || !mem_new)
+            {
+                *status = cuda_error ? cuda_error :
+                        OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
+            if (copy_size > 0)
+                cuda_error = (int)cudaMemcpy(mem_new, mem->data, copy_size,
+                        cudaMemcpyDeviceToDevice);
+            if (cuda_error) *status = cuda_error;
+        }
+        if (mem->data)
+        {
+            cuda_error = (int)cudaFree(mem->data);
+            if (cuda_error && !*status) *status = cuda_error;
+        }
+        mem->data = mem_new;
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+        return;
+#endif
+    }
+    else if (mem->location & OSKAR_CL)
+    {
+#ifdef OSKAR_HAVE_OPENCL
+        cl_mem buffer_new = 0;
+        if (block_size > 0)
+        {
+            cl_event event;
+            cl_int error = 0;
+            buffer_new = clCreateBuffer(oskar_device_context_cl(),
+                    CL_MEM_READ_WRITE, block_size, NULL, &error);
+            if (error != CL_SUCCESS)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
+            if (copy_size > 0)
+            {
+                error = clEnqueueCopyBuffer(oskar_device_queue_cl(),
+                        mem->buffer, buffer_new, 0, 0, copy_size,
+                        0, NULL, &event);
+                if (error != CL_SUCCESS)
+                    *status = OSKAR_ERR_MEMORY_COPY_FAILURE;
+            }
+        }
+        if (mem->buffer)
+            clReleaseMemObject(mem->buffer);
+        mem->buffer = buffer_new;
+        mem->data = (void*) (mem->buffer);
+#else
+        *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
+        return;
+#endif
+    }
+    else
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Set the new meta-data. */
+    mem->capacity = block_size;
+    mem->num_elements = num_elements;
+}
+
 #ifdef __cplusplus
 }
 #endif
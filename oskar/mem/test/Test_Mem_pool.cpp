@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_thread.h"
+#include "mem/oskar_mem.h"
+
+static void* create_and_free(void* arg)
+{
+    int status = 0;
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            *((int*) arg), &status);
+    oskar_mem_free(mem, &status);
+    return 0;
+}
+
+TEST(Mem, pool_ensure_preserves_and_clears)
+{
+    int status = 0;
+    oskar_mem_pool_set_enabled(1);
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 10, &status);
+    double* p = oskar_mem_double(mem, &status);
+    for (int i = 0; i < 10; ++i) p[i] = (double) i;
+
+    // Grow a little at a time, as a per-chunk work buffer would.
+    for (int n = 20; n <= 1000; n += 10)
+    {
+        oskar_mem_ensure(mem, n, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ((size_t) n, oskar_mem_length(mem));
+        p = oskar_mem_double(mem, &status);
+        ASSERT_EQ(0.0, p[n - 1]);
+    }
+    for (int i = 0; i < 10; ++i) EXPECT_EQ((double) i, p[i]);
+
+    // Shrink, then grow again within the same block.
+    p[500] = 1.0;
+    oskar_mem_realloc(mem, 100, &status);
+    oskar_mem_realloc(mem, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    p = oskar_mem_double(mem, &status);
+    EXPECT_EQ(0.0, p[500]);
+    EXPECT_EQ(9.0, p[9]);
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_set_enabled(0);
+}
+
+TEST(Mem, pool_counters)
+{
+    int status = 0;
+    size_t num_allocs = 0, num_reused = 0, num_in_place = 0;
+    oskar_mem_pool_set_enabled(1);
+    oskar_mem_pool_reset_counters();
+
+    // Geometric growth should need far fewer allocations than resizes.
+    oskar_Mem* mem = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, 0, &status);
+    for (int n = 1; n <= 100000; n += 100)
+        oskar_mem_ensure(mem, n, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_pool_counters(&num_allocs, &num_reused, &num_in_place, 0, 0);
+    EXPECT_LT(num_allocs + num_reused, (size_t) 40);
+    EXPECT_GT(num_in_place, (size_t) 900);
+    oskar_mem_free(mem, &status);
+
+    // A block released to the pool should be reused by the next array.
+    oskar_mem_pool_reset_counters();
+    mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 5000, &status);
+    oskar_mem_free(mem, &status);
+    mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 5000, &status);
+    oskar_mem_pool_counters(&num_allocs, &num_reused, 0, 0, 0);
+    EXPECT_EQ((size_t) 2, num_allocs + num_reused);
+    EXPECT_GE(num_reused, (size_t) 1);
+    EXPECT_EQ(0.0, oskar_mem_double(mem, &status)[4999]);
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_set_enabled(0);
+}
+
+TEST(Mem, pool_threads)
+{
+    int status = 0, num_elements = 7000;
+    size_t num_allocs = 0, num_reused = 0, bytes_cached = 0;
+    oskar_mem_pool_set_enabled(1);
+    oskar_mem_pool_reset_counters();
+
+    // A block kept by a thread should be handed back when it exits.
+    oskar_Thread* thread = oskar_thread_create(create_and_free,
+            (void*) &num_elements, 0);
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    oskar_mem_pool_counters(&num_allocs, &num_reused, 0, &bytes_cached, 0);
+    EXPECT_EQ((size_t) 1, num_allocs);
+    EXPECT_GE(bytes_cached, num_elements * sizeof(double));
+
+    // The block should then be reused by this thread.
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_elements, &status);
+    oskar_mem_pool_counters(&num_allocs, &num_reused, 0, 0, 0);
+    EXPECT_EQ((size_t) 1, num_allocs);
+    EXPECT_EQ((size_t) 1, num_reused);
+    oskar_mem_free(mem, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_pool_set_enabled(0);
+}
+
+TEST(Mem, pool_disabled)
+{
+    int status = 0;
+    size_t num_allocs = 1, num_reused = 1, num_in_place = 1;
+    oskar_mem_pool_set_enabled(0);
+    oskar_mem_pool_reset_counters();
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 10, &status);
+    oskar_mem_ensure(mem, 20, &status);
+    oskar_mem_realloc(mem, 15, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ((size_t) 15, oskar_mem_length(mem));
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_counters(&num_allocs, &num_reused, &num_in_place, 0, 0);
+    EXPECT_EQ((size_t) 0, num_allocs);
+    EXPECT_EQ((size_t) 0, num_reused);
+    EXPECT_EQ((size_t) 0, num_in_place);
+}
@@ -42,6 +42,7 @@
 #include <sky/oskar_sky.h>
 #include <utility/oskar_get_error_string.h>
 #include <utility/oskar_timer.h>
+#include <utility/oskar_trace.h>
 #include <utility/oskar_version_string.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
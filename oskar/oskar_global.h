@@ -54,7 +54,9 @@ enum OSKAR_ERROR_CODES
     OSKAR_ERR_BAD_POINTING_FILE                        = -30,
     OSKAR_ERR_BAD_COORD_FILE                           = -31,
     OSKAR_ERR_BAD_GSM_FILE                             = -32,
-    OSKAR_ERR_FFT_FAILED                               = -33
+    OSKAR_ERR_FFT_FAILED                               = -33,
+    OSKAR_ERR_MPI_FAILED                               = -34,
+    OSKAR_ERR_MPI_THREAD_SUPPORT                       = -35
 
     /*
      * Codes -75 to -99 are reserved for settings errors.
@@ -112,6 +114,7 @@ enum OSKAR_COORD_TYPE
     #define OSKAR_HAVE_CUDA
     #define OSKAR_HAVE_OPENCL
     #define OSKAR_HAVE_HDF5
+    #define OSKAR_HAVE_MPI
     #define __CUDACC__
     #define __CUDA_ARCH__ 300
     #define _OPENMP
@@ -22,7 +22,7 @@
         GLOBAL const FP* pa_in,   GLOBAL FP* pa_out\
 )\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     if (mask[i]) {\
         const int i_out = indices[i];\
         ra_out[i_out]  = ra_in[i];\
@@ -72,6 +72,8 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_accessors.h>
 #include <sky/oskar_sky_append_to_set.h>
 #include <sky/oskar_sky_append.h>
+#include <sky/oskar_sky_bcast.h>
+#include <sky/oskar_sky_columns.h>
 #include <sky/oskar_sky_copy.h>
 #include <sky/oskar_sky_copy_contents.h>
 #include <sky/oskar_sky_create.h>
@@ -87,9 +89,11 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_generate_grid.h>
 #include <sky/oskar_sky_generate_random_power_law.h>
 #include <sky/oskar_sky_horizon_clip.h>
+#include <sky/oskar_sky_index.h>
 #include <sky/oskar_sky_load.h>
 #include <sky/oskar_sky_override_polarisation.h>
 #include <sky/oskar_sky_read.h>
+#include <sky/oskar_sky_rebin.h>
 #include <sky/oskar_sky_resize.h>
 #include <sky/oskar_sky_rotate_to_position.h>
 #include <sky/oskar_sky_save.h>
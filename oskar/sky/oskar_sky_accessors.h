@@ -85,6 +85,23 @@ int oskar_sky_capacity(const oskar_Sky* sky);
 OSKAR_EXPORT
 int oskar_sky_num_sources(const oskar_Sky* sky);
 
+/**
+ * @brief Sets the number of sources in the sky model.
+ *
+ * @details
+ * Sets the number of sources in the sky model, without reallocating
+ * any memory. The value must not exceed the capacity of the sky model.
+ *
+ * This can be used to empty a sky model used as a buffer, so that it
+ * can be refilled using oskar_sky_append().
+ *
+ * @param[in] sky        Pointer to sky model.
+ * @param[in] value      Number of sources.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_set_num_sources(oskar_Sky* sky, int value, int* status);
+
 /**
  * @brief Returns the flag to specify whether the sky model contains
  * extended sources.
@@ -46,6 +46,11 @@ extern "C" {
  * @details
  * This function appends source data in one sky model to those in another
  * by resizing the existing arrays and copying the data across.
+ * The arrays are only reallocated if the destination does not already
+ * have enough capacity to hold all the sources.
+ *
+ * If the destination is empty, it also takes the reference direction
+ * of the source sky model.
  *
  * @param[out] dst Pointer to destination sky model.
  * @param[in]  src Pointer to source sky model.
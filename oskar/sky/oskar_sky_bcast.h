@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_BCAST_H_
+#define OSKAR_SKY_BCAST_H_
+
+/**
+ * @file oskar_sky_bcast.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Broadcasts a sky model from one process to all others.
+ *
+ * @details
+ * Copies the contents of the sky model on the root process into the
+ * sky models on all other processes, which are resized as required.
+ * The sky models must be in CPU memory, and have the same precision
+ * on all processes.
+ *
+ * This is a collective operation, so it must be called by all processes.
+ * It does nothing if there is only one process.
+ *
+ * @param[in,out] sky     Sky model to send (on root) or fill (on all others).
+ * @param[in] root        Rank of the sending process.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_bcast(oskar_Sky* sky, int root, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
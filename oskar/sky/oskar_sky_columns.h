@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_COLUMNS_H_
+#define OSKAR_SKY_COLUMNS_H_
+
+/**
+ * @file oskar_sky_columns.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Writes a sky model to a columnar binary file.
+ *
+ * @details
+ * Writes the sky model to a file holding one aligned array for each
+ * source parameter (RA, Dec, Stokes I, Q, U, V, reference frequency,
+ * spectral index, rotation measure, FWHM major and minor axes, and
+ * position angle), so that it can be loaded quickly using
+ * oskar_sky_read_columns().
+ *
+ * Sources are sorted into bands of declination, and by right ascension
+ * within each band, and are then divided into chunks of \p chunk_size
+ * sources. The range of Stokes I values and the bounding circle of the
+ * positions are stored for each chunk, so that chunks can be skipped
+ * when the sky model is filtered on loading.
+ *
+ * The sky model must be in CPU memory.
+ *
+ * @param[in] sky         Pointer to sky model.
+ * @param[in] filename    Output filename.
+ * @param[in] chunk_size  Number of sources per chunk. If zero or less,
+ *                        a default value is used.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_write_columns(const oskar_Sky* sky, const char* filename,
+        int chunk_size, int* status);
+
+/**
+ * @brief Reads a sky model from a columnar binary file, with filtering.
+ *
+ * @details
+ * Memory-maps a file written by oskar_sky_write_columns(), and copies
+ * the columns directly into the arrays of a new sky model in CPU memory,
+ * which are allocated only once.
+ *
+ * Sources are filtered on loading using the same criteria as
+ * oskar_sky_filter_by_flux() and oskar_sky_filter_by_radius().
+ * Chunks which cannot contain any selected sources are not read,
+ * and chunks containing only selected sources are copied in bulk.
+ *
+ * If the file is not a columnar sky model file, the status code is set to
+ * OSKAR_ERR_BAD_SKY_FILE.
+ *
+ * @param[in] filename          Input filename.
+ * @param[in] type              Required precision of the sky model.
+ * @param[in] flux_min_jy       Minimum Stokes I flux (exclusive).
+ * @param[in] flux_max_jy       Maximum Stokes I flux (inclusive).
+ * @param[in] radius_inner_rad  Inner radius from (ra0, dec0) (inclusive).
+ * @param[in] radius_outer_rad  Outer radius from (ra0, dec0) (exclusive).
+ * @param[in] ra0_rad           Right Ascension of filter centre, in radians.
+ * @param[in] dec0_rad          Declination of filter centre, in radians.
+ * @param[in,out] status        Status return code.
+ *
+ * @return A handle to the sky model structure, or NULL if an error occurred.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_read_columns(const char* filename, int type,
+        double flux_min_jy, double flux_max_jy, double radius_inner_rad,
+        double radius_outer_rad, double ra0_rad, double dec0_rad,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
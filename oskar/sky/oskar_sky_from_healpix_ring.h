@@ -47,6 +47,10 @@ extern "C" {
  * Creates a sky model from an array of HEALPix pixels.
  * The pixellisation must be in RING format.
  *
+ * Pixels with a value of zero are skipped. The non-zero pixels are first
+ * counted so that the sky model can be allocated at its final size,
+ * and blocks of pixels are then converted in parallel.
+ *
  * @param[in] precision           Enumerated precision of the output sky model.
  * @param[in] data                HEALPix data array (values in Jy).
  * @param[in] frequency_hz        Reference frequency, in Hz.
@@ -61,6 +65,38 @@ oskar_Sky* oskar_sky_from_healpix_ring(int precision, const oskar_Mem* data,
         double frequency_hz, double spectral_index, int nside,
         int galactic_coords, int* status);
 
+/**
+ * @brief
+ * Creates a sky model from a range of HEALPix pixels.
+ *
+ * @details
+ * This is the same as oskar_sky_from_healpix_ring(), but only converts
+ * pixels with indices from \p first_pixel to
+ * (\p first_pixel + \p num_pixels - 1).
+ *
+ * It can be used to stream a large map into a set of sky model chunks
+ * (see oskar_sky_append_to_set()) without making a sky model of the whole
+ * map: since the output contains at most \p num_pixels sources, using a
+ * range no larger than the chunk size limits the memory needed to one
+ * extra chunk.
+ *
+ * @param[in] precision           Enumerated precision of the output sky model.
+ * @param[in] data                HEALPix data array (values in Jy).
+ * @param[in] frequency_hz        Reference frequency, in Hz.
+ * @param[in] spectral_index      Spectral index to give to each pixel.
+ * @param[in] nside               HEALPix resolution parameter.
+ * @param[in] galactic_coords     If true, map is in Galactic coordinates;
+ *                                otherwise, equatorial coordinates.
+ * @param[in] first_pixel         Index of the first pixel to convert.
+ * @param[in] num_pixels          Number of pixels to convert.
+ * @param[in,out] status          Status return code.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_from_healpix_ring_range(int precision,
+        const oskar_Mem* data, double frequency_hz, double spectral_index,
+        int nside, int galactic_coords, int first_pixel, int num_pixels,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,10 @@ extern "C" {
  * @details
  * Creates a sky model from an array of image pixels.
  *
+ * Pixels with a value of zero are skipped. The non-zero pixels are first
+ * counted so that the sky model can be allocated at its final size,
+ * and blocks of pixels are then converted in parallel.
+ *
  * @param[in] precision           Enumerated precision of the output sky model.
  * @param[in] image               2D image data (ordered as in FITS image).
  * @param[in] image_size          Image size[2] (width and height).
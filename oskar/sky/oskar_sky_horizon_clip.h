@@ -34,6 +34,7 @@
  */
 
 #include <oskar_global.h>
+#include <sky/oskar_sky_index.h>
 #include <telescope/oskar_telescope.h>
 
 #ifdef __cplusplus
@@ -60,6 +61,33 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
         const oskar_Telescope* telescope, double gast,
         oskar_StationWork* work, int* status);
 
+/**
+ * @brief
+ * Compacts a sky model into another one by removing sources below the
+ * horizon of all stations, using a spatial index.
+ *
+ * @details
+ * This is the same as oskar_sky_horizon_clip(), but if the sky model is
+ * in CPU memory, the given index of the source positions is used so that
+ * only sources close to the horizon of each station need to be checked.
+ *
+ * The index must have been created from the positions of the sources in
+ * the input sky model, using oskar_sky_index_create().
+ * If \p index is NULL, or the sky model is not in CPU memory,
+ * this function behaves like oskar_sky_horizon_clip().
+ *
+ * @param[out] out          The output sky model.
+ * @param[in]  in           The input sky model.
+ * @param[in]  index        Index of source positions in the input sky model.
+ * @param[in]  telescope    The telescope model.
+ * @param[in]  work         Work arrays.
+ * @param[in,out]  status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_horizon_clip_indexed(oskar_Sky* out, const oskar_Sky* in,
+        const oskar_SkyIndex* index, const oskar_Telescope* telescope,
+        double gast, oskar_StationWork* work, int* status);
+
 #ifdef __cplusplus
 }
 #endif
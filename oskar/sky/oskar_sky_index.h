@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_INDEX_H_
+#define OSKAR_SKY_INDEX_H_
+
+/**
+ * @file oskar_sky_index.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_SkyIndex;
+#ifndef OSKAR_SKY_INDEX_TYPEDEF_
+#define OSKAR_SKY_INDEX_TYPEDEF_
+typedef struct oskar_SkyIndex oskar_SkyIndex;
+#endif /* OSKAR_SKY_INDEX_TYPEDEF_ */
+
+/**
+ * @brief
+ * Creates a spatial index of positions on the sphere.
+ *
+ * @details
+ * Builds a tree that can be used to find positions within a radius or
+ * a box, or the nearest positions to a point, without having to check
+ * every position.
+ *
+ * The positions are converted to unit vectors and sorted by their pixel
+ * index in the HEALPix nested scheme, at a resolution chosen from the
+ * number of positions. Cells containing more than a few positions are
+ * divided into their four child cells, down to the chosen resolution,
+ * and any cells that are still too full (because positions are clustered)
+ * are split further as a k-d tree on the unit vectors. The bounding box of
+ * the unit vectors in each node of the tree is used to prune queries.
+ *
+ * The input arrays must be in CPU memory, and may be of either precision.
+ * The index holds a copy of the positions, so the arrays may be modified
+ * or freed after this call.
+ *
+ * @param[in] num_points   Number of positions.
+ * @param[in] ra_rad       Right Ascension values, in radians.
+ * @param[in] dec_rad      Declination values, in radians.
+ * @param[in,out] status   Status return code.
+ *
+ * @return A handle to the index.
+ */
+OSKAR_EXPORT
+oskar_SkyIndex* oskar_sky_index_create(int num_points,
+        const oskar_Mem* ra_rad, const oskar_Mem* dec_rad, int* status);
+
+/**
+ * @brief
+ * Returns the number of positions in the index.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_num_points(const oskar_SkyIndex* index);
+
+/**
+ * @brief
+ * Returns the HEALPix nside parameter used to sort the positions.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_nside(const oskar_SkyIndex* index);
+
+/**
+ * @brief
+ * Returns the order of the positions in the index.
+ *
+ * @details
+ * Element i of the returned array is the original index of the
+ * i-th position held in the tree. The ranges returned by
+ * oskar_sky_index_query_ranges() refer to this array.
+ */
+OSKAR_EXPORT
+const int* oskar_sky_index_order(const oskar_SkyIndex* index);
+
+/**
+ * @brief
+ * Finds all positions within an annulus about a point.
+ *
+ * @details
+ * Finds the positions at an angular distance d from the point for which
+ * inner_radius_rad <= d < outer_radius_rad, which is the same criterion
+ * used by oskar_sky_filter_by_radius(). The indices of the positions are
+ * returned in \p indices (which is resized if necessary) in
+ * ascending order.
+ *
+ * @param[in] index             Handle to the index.
+ * @param[in] ra_rad            Right Ascension of the point, in radians.
+ * @param[in] dec_rad           Declination of the point, in radians.
+ * @param[in] inner_radius_rad  Inner radius, in radians.
+ * @param[in] outer_radius_rad  Outer radius, in radians.
+ * @param[out] indices          Integer array of indices, in CPU memory.
+ * @param[in,out] status        Status return code.
+ *
+ * @return The number of positions found.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_radius(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double inner_radius_rad,
+        double outer_radius_rad, oskar_Mem* indices, int* status);
+
+/**
+ * @brief
+ * Finds all positions within a box of Right Ascension and Declination.
+ *
+ * @details
+ * Finds the positions with dec_min_rad <= Dec <= dec_max_rad and
+ * Right Ascension in the range from ra_min_rad to ra_max_rad, inclusive.
+ * If \p ra_min_rad is greater than \p ra_max_rad (after both are wrapped
+ * into the range 0 to 2 pi), the box wraps through zero.
+ * The indices of the positions are returned in \p indices
+ * (which is resized if necessary) in ascending order.
+ *
+ * @param[in] index        Handle to the index.
+ * @param[in] ra_min_rad   Start of the Right Ascension range, in radians.
+ * @param[in] ra_max_rad   End of the Right Ascension range, in radians.
+ * @param[in] dec_min_rad  Minimum Declination, in radians.
+ * @param[in] dec_max_rad  Maximum Declination, in radians.
+ * @param[out] indices     Integer array of indices, in CPU memory.
+ * @param[in,out] status   Status return code.
+ *
+ * @return The number of positions found.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_box(const oskar_SkyIndex* index,
+        double ra_min_rad, double ra_max_rad,
+        double dec_min_rad, double dec_max_rad,
+        oskar_Mem* indices, int* status);
+
+/**
+ * @brief
+ * Finds the nearest positions to a point.
+ *
+ * @details
+ * Finds the \p k positions nearest to the given point (or all of them,
+ * if there are fewer than \p k). The indices of the positions are
+ * returned in \p indices in order of increasing distance, and the
+ * angular distances, in radians, are returned in \p distances_rad
+ * if it is not NULL. Both arrays are resized if necessary.
+ *
+ * @param[in] index          Handle to the index.
+ * @param[in] ra_rad         Right Ascension of the point, in radians.
+ * @param[in] dec_rad        Declination of the point, in radians.
+ * @param[in] k              Number of positions to find.
+ * @param[out] indices       Integer array of indices, in CPU memory.
+ * @param[out] distances_rad Double-precision array of distances, or NULL.
+ * @param[in,out] status     Status return code.
+ *
+ * @return The number of positions found.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, int k, oskar_Mem* indices,
+        oskar_Mem* distances_rad, int* status);
+
+/**
+ * @brief
+ * Finds the nearest position to a point.
+ *
+ * @details
+ * This is a version of oskar_sky_index_query_nearest() for a single
+ * position, which does not allocate memory, so that it can be called
+ * from many threads at once.
+ *
+ * @param[in] index           Handle to the index.
+ * @param[in] ra_rad          Right Ascension of the point, in radians.
+ * @param[in] dec_rad         Declination of the point, in radians.
+ * @param[out] distance_rad   If not NULL, the angular distance, in radians.
+ *
+ * @return The index of the nearest position, or -1 if the index is empty.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double* distance_rad);
+
+/**
+ * @brief
+ * Finds the ranges of the tree that lie within a radius of any of a set
+ * of points.
+ *
+ * @details
+ * This is a lower-level version of oskar_sky_index_query_radius(),
+ * for callers that need to apply their own test to each position.
+ *
+ * Returns ranges of positions, in the order given by
+ * oskar_sky_index_order(), which may lie within \p radius_rad of at least
+ * one of the given points. Each range is returned as three integers in
+ * \p ranges: the start of the range, the end of the range (exclusive),
+ * and a flag which is set if every position in the range is closer than
+ * (radius_rad - tolerance_rad) to at least one of the points.
+ * Positions in ranges without the flag set must be checked individually.
+ * Positions further than (radius_rad + tolerance_rad) from all the points
+ * are not contained in any range.
+ *
+ * @param[in] index          Handle to the index.
+ * @param[in] num_centres    Number of points.
+ * @param[in] ra_rad         Right Ascension of each point, in radians.
+ * @param[in] dec_rad        Declination of each point, in radians.
+ * @param[in] radius_rad     Radius, in radians.
+ * @param[in] tolerance_rad  Tolerance on the radius, in radians.
+ * @param[out] ranges        Integer array of ranges, in CPU memory.
+ * @param[in,out] status     Status return code.
+ *
+ * @return The number of ranges found.
+ */
+OSKAR_EXPORT
+int oskar_sky_index_query_ranges(const oskar_SkyIndex* index,
+        int num_centres, const double* ra_rad, const double* dec_rad,
+        double radius_rad, double tolerance_rad, oskar_Mem* ranges,
+        int* status);
+
+/**
+ * @brief
+ * Frees memory held by the index.
+ */
+OSKAR_EXPORT
+void oskar_sky_index_free(oskar_SkyIndex* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
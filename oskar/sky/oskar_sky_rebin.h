@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SKY_REBIN_H_
+#define OSKAR_SKY_REBIN_H_
+
+/**
+ * @file oskar_sky_rebin.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Rebins the flux of one sky model onto the source positions of another.
+ *
+ * @details
+ * Sets the Stokes I value of each source in the output sky model to the
+ * sum of the Stokes I values of all input sources that are closer to it
+ * than to any other output source. Other parameters of the output sky
+ * model are not changed.
+ *
+ * In CPU memory, the nearest output source to each input source is found
+ * using a spatial index (see oskar_sky_index_create()), and input sources
+ * are shared between threads, which each accumulate flux into their own
+ * copy of the output array. The copies are summed in thread order,
+ * so the result does not depend on thread scheduling. Both precisions
+ * are supported.
+ *
+ * In GPU memory, all output sources are checked for each input source.
+ * This requires CUDA, and the sky models must be single precision.
+ *
+ * Both sky models must be of the same precision and in the same location.
+ *
+ * @param[in] input       The input sky model.
+ * @param[in,out] output  The output sky model.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_sky_rebin(const oskar_Sky* input, oskar_Sky* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
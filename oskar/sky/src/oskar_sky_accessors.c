@@ -53,6 +53,17 @@ int oskar_sky_num_sources(const oskar_Sky* sky)
     return sky->num_sources;
 }
 
+void oskar_sky_set_num_sources(oskar_Sky* sky, int value, int* status)
+{
+    if (*status) return;
+    if (value < 0 || value > sky->capacity)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    sky->num_sources = value;
+}
+
 int oskar_sky_use_extended(const oskar_Sky* sky)
 {
     return sky->use_extended;
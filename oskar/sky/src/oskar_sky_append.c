@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
 
 #ifdef __cplusplus
@@ -39,10 +40,20 @@ void oskar_sky_append(oskar_Sky* dst, const oskar_Sky* src, int* status)
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Resize the sky model. */
+    /* Resize the sky model only if it is not large enough already. */
     num_dst = oskar_sky_num_sources(dst);
     num_src = oskar_sky_num_sources(src);
-    oskar_sky_resize(dst, num_dst + num_src, status);
+    if (oskar_sky_capacity(dst) < num_dst + num_src)
+        oskar_sky_resize(dst, num_dst + num_src, status);
+    else
+        dst->num_sources = num_dst + num_src;
+
+    /* An empty sky model takes the reference direction of the source. */
+    if (num_dst == 0)
+    {
+        dst->reference_ra_rad = src->reference_ra_rad;
+        dst->reference_dec_rad = src->reference_dec_rad;
+    }
 
     /* Copy memory contents at the appropriate offset. */
     oskar_sky_copy_contents(dst, src, num_dst, 0, num_src, status);
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/private_sky.h"
+#include "sky/oskar_sky.h"
+#include "utility/oskar_mpi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_sky_bcast(oskar_Sky* sky, int root, int* status)
+{
+    int i, ints[3];
+    double doubles[2];
+    if (*status || oskar_mpi_size() == 1) return;
+    if (sky->mem_location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+
+    /* Broadcast the dimensions and scalar parameters. */
+    ints[0] = sky->num_sources;
+    ints[1] = sky->precision;
+    ints[2] = sky->use_extended;
+    doubles[0] = sky->reference_ra_rad;
+    doubles[1] = sky->reference_dec_rad;
+    oskar_mpi_bcast(ints, sizeof(ints), root, status);
+    oskar_mpi_bcast(doubles, sizeof(doubles), root, status);
+    if (*status) return;
+    if (ints[1] != sky->precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_mpi_rank() != root)
+    {
+        oskar_sky_resize(sky, ints[0], status);
+        sky->use_extended = ints[2];
+        sky->reference_ra_rad = doubles[0];
+        sky->reference_dec_rad = doubles[1];
+    }
+
+    /* Broadcast the source data. */
+    {
+        oskar_Mem* arrays[] = {
+                sky->ra_rad, sky->dec_rad, sky->I, sky->Q, sky->U, sky->V,
+                sky->reference_freq_hz, sky->spectral_index, sky->rm_rad,
+                sky->l, sky->m, sky->n,
+                sky->fwhm_major_rad, sky->fwhm_minor_rad, sky->pa_rad,
+                sky->gaussian_a, sky->gaussian_b, sky->gaussian_c
+        };
+        const size_t bytes = (size_t) ints[0] *
+                oskar_mem_element_size(sky->precision);
+        const int num_arrays = (int) (sizeof(arrays) / sizeof(oskar_Mem*));
+        for (i = 0; i < num_arrays; ++i)
+            oskar_mpi_bcast(oskar_mem_void(arrays[i]), bytes, root, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
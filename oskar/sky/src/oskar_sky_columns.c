@@ -0,0 +1,476 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/oskar_sky.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_file_map.h"
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* File layout: a header, an information block for each chunk,
+ * then one array for each column. Arrays are aligned to ALIGN_BYTES. */
+#define HEADER_BYTES 64
+#define ALIGN_BYTES 64
+#define NUM_COLUMNS 12
+#define DEFAULT_CHUNK_SIZE 65536
+#define ALIGN(X) ((((X) + ALIGN_BYTES - 1) / ALIGN_BYTES) * ALIGN_BYTES)
+
+/* Allowance for rounding errors when comparing distances with chunk bounds. */
+#define RADIUS_MARGIN_RAD 1e-9
+
+static const char columns_magic[8] = {'O', 'S', 'K', 'A', 'R', 'S', 'C', 0};
+static const int columns_version = 1;
+
+struct Header
+{
+    char magic[8];
+    int version, type, num_sources, chunk_size, num_chunks, num_columns;
+    char reserved[28];
+};
+typedef struct Header Header;
+
+struct ChunkInfo
+{
+    double flux_min, flux_max;  /* Range of Stokes I values. */
+    double centre[3];           /* Unit vector to centre of bounding circle. */
+    double radius_rad;          /* Radius of bounding circle. */
+    double reserved[2];
+};
+typedef struct ChunkInfo ChunkInfo;
+
+struct SortKey
+{
+    double key;
+    int index;
+};
+typedef struct SortKey SortKey;
+
+enum { SKIP_CHUNK, READ_ALL, READ_SELECTED };
+
+static oskar_Mem* column(oskar_Sky* sky, int i);
+static const oskar_Mem* column_const(const oskar_Sky* sky, int i);
+static int* sort_sources(const oskar_Sky* sky, int num_chunks, int* status);
+static int compare_keys(const void* a, const void* b);
+static double value(const char* column, int type, size_t i);
+static void unit_vector(double ra_rad, double dec_rad, double v[3]);
+static double distance(const double a[3], const double b[3]);
+static void copy_values(oskar_Mem* dst, size_t offset_dst, const char* src,
+        int src_type, size_t offset_src, size_t num, int* status);
+
+void oskar_sky_write_columns(const oskar_Sky* sky, const char* filename,
+        int chunk_size, int* status)
+{
+    int c, k;
+    Header hdr;
+    if (*status) return;
+    if (oskar_sky_mem_location(sky) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (chunk_size <= 0) chunk_size = DEFAULT_CHUNK_SIZE;
+    const int type = oskar_sky_precision(sky);
+    const int num_sources = oskar_sky_num_sources(sky);
+    const int num_chunks = (num_sources + chunk_size - 1) / chunk_size;
+    const size_t element_size = oskar_mem_element_size(type);
+    const size_t column_start =
+            ALIGN(HEADER_BYTES + num_chunks * sizeof(ChunkInfo));
+    const size_t column_bytes = ALIGN(num_sources * element_size);
+
+    /* Order sources so that each chunk covers a compact region. */
+    int* order = sort_sources(sky, num_chunks, status);
+    oskar_FileMap* map = oskar_file_map_create(filename,
+            column_start + NUM_COLUMNS * column_bytes, status);
+    if (*status)
+    {
+        free(order);
+        oskar_file_map_free(map);
+        return;
+    }
+    char* data = (char*) oskar_file_map_data(map);
+
+    /* Write the columns in sorted order. */
+    for (c = 0; c < NUM_COLUMNS; ++c)
+    {
+        int i;
+        const char* src = (const char*) oskar_mem_void_const(
+                column_const(sky, c));
+        char* dst = data + column_start + c * column_bytes;
+        for (i = 0; i < num_sources; ++i)
+            memcpy(dst + i * element_size,
+                    src + order[i] * element_size, element_size);
+    }
+    free(order);
+
+    /* Write the information for each chunk. */
+    const char* ra = data + column_start;
+    const char* dec = data + column_start + column_bytes;
+    const char* flux = data + column_start + 2 * column_bytes;
+    for (k = 0; k < num_chunks; ++k)
+    {
+        int i;
+        ChunkInfo info;
+        double v[3], norm;
+        const int start = k * chunk_size;
+        const int end = (start + chunk_size > num_sources) ?
+                num_sources : start + chunk_size;
+        memset(&info, 0, sizeof(ChunkInfo));
+        info.flux_min = DBL_MAX;
+        info.flux_max = -DBL_MAX;
+        for (i = start; i < end; ++i)
+        {
+            const double I = value(flux, type, i);
+            if (I < info.flux_min) info.flux_min = I;
+            if (I > info.flux_max) info.flux_max = I;
+            unit_vector(value(ra, type, i), value(dec, type, i), v);
+            info.centre[0] += v[0];
+            info.centre[1] += v[1];
+            info.centre[2] += v[2];
+        }
+        norm = sqrt(info.centre[0] * info.centre[0] +
+                info.centre[1] * info.centre[1] +
+                info.centre[2] * info.centre[2]);
+        if (norm > 1e-6)
+        {
+            info.centre[0] /= norm;
+            info.centre[1] /= norm;
+            info.centre[2] /= norm;
+        }
+        else
+        {
+            unit_vector(value(ra, type, start), value(dec, type, start),
+                    info.centre);
+        }
+        for (i = start; i < end; ++i)
+        {
+            unit_vector(value(ra, type, i), value(dec, type, i), v);
+            const double d = distance(info.centre, v);
+            if (d > info.radius_rad) info.radius_rad = d;
+        }
+        memcpy(data + HEADER_BYTES + k * sizeof(ChunkInfo), &info,
+                sizeof(ChunkInfo));
+    }
+
+    /* Write the header last, so an incomplete file is never valid. */
+    memset(&hdr, 0, sizeof(Header));
+    memcpy(hdr.magic, columns_magic, sizeof(columns_magic));
+    hdr.version = columns_version;
+    hdr.type = type;
+    hdr.num_sources = num_sources;
+    hdr.chunk_size = chunk_size;
+    hdr.num_chunks = num_chunks;
+    hdr.num_columns = NUM_COLUMNS;
+    memcpy(data, &hdr, sizeof(Header));
+    oskar_file_map_sync(map, status);
+    oskar_file_map_free(map);
+}
+
+
+oskar_Sky* oskar_sky_read_columns(const char* filename, int type,
+        double flux_min_jy, double flux_max_jy, double radius_inner_rad,
+        double radius_outer_rad, double ra0_rad, double dec0_rad,
+        int* status)
+{
+    int c, k, num_out = 0, max_out = 0;
+    double centre[3];
+    Header hdr;
+    oskar_Sky* sky = 0;
+    unsigned char* action = 0;
+    if (*status) return 0;
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    if (flux_max_jy < flux_min_jy || radius_outer_rad < radius_inner_rad)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    const int use_flux = !(flux_min_jy <= -DBL_MAX && flux_max_jy >= DBL_MAX);
+    const int use_radius = !(radius_inner_rad == 0.0 &&
+            radius_outer_rad >= M_PI);
+    unit_vector(ra0_rad, dec0_rad, centre);
+
+    /* Map the file, and check the header. */
+    oskar_FileMap* map = oskar_file_map_open(filename, 0, status);
+    if (*status) return 0;
+    const char* data = (const char*) oskar_file_map_data(map);
+    const size_t file_size = oskar_file_map_size(map);
+    if (file_size >= HEADER_BYTES)
+        memcpy(&hdr, data, sizeof(Header));
+    if (file_size < HEADER_BYTES ||
+            memcmp(hdr.magic, columns_magic, sizeof(columns_magic)) ||
+            hdr.version != columns_version || hdr.num_sources < 0 ||
+            hdr.num_chunks < 0 || hdr.chunk_size <= 0 ||
+            hdr.num_columns != NUM_COLUMNS ||
+            (hdr.type != OSKAR_SINGLE && hdr.type != OSKAR_DOUBLE))
+    {
+        *status = OSKAR_ERR_BAD_SKY_FILE;
+        oskar_file_map_free(map);
+        return 0;
+    }
+    const size_t element_size = oskar_mem_element_size(hdr.type);
+    const size_t column_start =
+            ALIGN(HEADER_BYTES + hdr.num_chunks * sizeof(ChunkInfo));
+    const size_t column_bytes = ALIGN(hdr.num_sources * element_size);
+    if (file_size < column_start + NUM_COLUMNS * column_bytes)
+    {
+        *status = OSKAR_ERR_BAD_SKY_FILE;
+        oskar_file_map_free(map);
+        return 0;
+    }
+    const char* ra = data + column_start;
+    const char* dec = data + column_start + column_bytes;
+    const char* flux = data + column_start + 2 * column_bytes;
+
+    /* Decide which chunks need to be read, using the chunk information. */
+    action = (unsigned char*) calloc(hdr.num_chunks + 1, 1);
+    for (k = 0; k < hdr.num_chunks; ++k)
+    {
+        ChunkInfo info;
+        int all = 1, none = 0;
+        const int start = k * hdr.chunk_size;
+        const int end = (start + hdr.chunk_size > hdr.num_sources) ?
+                hdr.num_sources : start + hdr.chunk_size;
+        memcpy(&info, data + HEADER_BYTES + k * sizeof(ChunkInfo),
+                sizeof(ChunkInfo));
+        if (use_flux)
+        {
+            if (info.flux_max <= flux_min_jy || info.flux_min > flux_max_jy)
+                none = 1;
+            if (!(info.flux_min > flux_min_jy && info.flux_max <= flux_max_jy))
+                all = 0;
+        }
+        if (use_radius)
+        {
+            const double d = distance(centre, info.centre);
+            const double r = info.radius_rad + RADIUS_MARGIN_RAD;
+            if (d + r < radius_inner_rad || d - r >= radius_outer_rad)
+                none = 1;
+            if (!(d - r >= radius_inner_rad && d + r < radius_outer_rad))
+                all = 0;
+        }
+        action[k] = none ? SKIP_CHUNK : (all ? READ_ALL : READ_SELECTED);
+        if (action[k] != SKIP_CHUNK) max_out += (end - start);
+    }
+
+    /* Copy the columns from the selected chunks. */
+    sky = oskar_sky_create(type, OSKAR_CPU, max_out, status);
+    for (k = 0; k < hdr.num_chunks && !*status; ++k)
+    {
+        int i;
+        const int start = k * hdr.chunk_size;
+        const int end = (start + hdr.chunk_size > hdr.num_sources) ?
+                hdr.num_sources : start + hdr.chunk_size;
+        if (action[k] == READ_ALL)
+        {
+            for (c = 0; c < NUM_COLUMNS; ++c)
+                copy_values(column(sky, c), num_out,
+                        data + column_start + c * column_bytes, hdr.type,
+                        start, end - start, status);
+            num_out += (end - start);
+        }
+        else if (action[k] == READ_SELECTED)
+        {
+            for (i = start; i < end; ++i)
+            {
+                const double I = value(flux, hdr.type, i);
+                if (use_flux && !(I > flux_min_jy && I <= flux_max_jy))
+                    continue;
+                if (use_radius)
+                {
+                    double v[3];
+                    unit_vector(value(ra, hdr.type, i),
+                            value(dec, hdr.type, i), v);
+                    const double d = distance(centre, v);
+                    if (!(d >= radius_inner_rad && d < radius_outer_rad))
+                        continue;
+                }
+                for (c = 0; c < NUM_COLUMNS; ++c)
+                    copy_values(column(sky, c), num_out,
+                            data + column_start + c * column_bytes,
+                            hdr.type, i, 1, status);
+                num_out++;
+            }
+        }
+    }
+    free(action);
+    oskar_file_map_free(map);
+    if (num_out != max_out)
+        oskar_sky_resize(sky, num_out, status);
+    if (*status)
+    {
+        oskar_sky_free(sky, status);
+        sky = 0;
+    }
+    return sky;
+}
+
+
+static oskar_Mem* column(oskar_Sky* sky, int i)
+{
+    switch (i)
+    {
+    case 0:  return oskar_sky_ra_rad(sky);
+    case 1:  return oskar_sky_dec_rad(sky);
+    case 2:  return oskar_sky_I(sky);
+    case 3:  return oskar_sky_Q(sky);
+    case 4:  return oskar_sky_U(sky);
+    case 5:  return oskar_sky_V(sky);
+    case 6:  return oskar_sky_reference_freq_hz(sky);
+    case 7:  return oskar_sky_spectral_index(sky);
+    case 8:  return oskar_sky_rotation_measure_rad(sky);
+    case 9:  return oskar_sky_fwhm_major_rad(sky);
+    case 10: return oskar_sky_fwhm_minor_rad(sky);
+    default: return oskar_sky_position_angle_rad(sky);
+    }
+}
+
+
+static const oskar_Mem* column_const(const oskar_Sky* sky, int i)
+{
+    switch (i)
+    {
+    case 0:  return oskar_sky_ra_rad_const(sky);
+    case 1:  return oskar_sky_dec_rad_const(sky);
+    case 2:  return oskar_sky_I_const(sky);
+    case 3:  return oskar_sky_Q_const(sky);
+    case 4:  return oskar_sky_U_const(sky);
+    case 5:  return oskar_sky_V_const(sky);
+    case 6:  return oskar_sky_reference_freq_hz_const(sky);
+    case 7:  return oskar_sky_spectral_index_const(sky);
+    case 8:  return oskar_sky_rotation_measure_rad_const(sky);
+    case 9:  return oskar_sky_fwhm_major_rad_const(sky);
+    case 10: return oskar_sky_fwhm_minor_rad_const(sky);
+    default: return oskar_sky_position_angle_rad_const(sky);
+    }
+}
+
+
+static int* sort_sources(const oskar_Sky* sky, int num_chunks, int* status)
+{
+    int i;
+    const int type = oskar_sky_precision(sky);
+    const int num_sources = oskar_sky_num_sources(sky);
+    const char* ra = (const char*) oskar_mem_void_const(
+            oskar_sky_ra_rad_const(sky));
+    const char* dec = (const char*) oskar_mem_void_const(
+            oskar_sky_dec_rad_const(sky));
+
+    /* Use bands of declination about twice as wide in right ascension
+     * as they are high, on average. */
+    int num_bands = (int) sqrt(num_chunks / 2.0);
+    if (num_bands < 1) num_bands = 1;
+    int* order = (int*) calloc(num_sources + 1, sizeof(int));
+    SortKey* keys = (SortKey*) calloc(num_sources + 1, sizeof(SortKey));
+    if (!order || !keys)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(keys);
+        return order;
+    }
+    for (i = 0; i < num_sources; ++i)
+    {
+        double ra_rad = fmod(value(ra, type, i), 2.0 * M_PI);
+        if (ra_rad < 0.0) ra_rad += 2.0 * M_PI;
+        int band = (int) floor(
+                (value(dec, type, i) + M_PI / 2.0) / M_PI * num_bands);
+        if (band < 0) band = 0;
+        if (band >= num_bands) band = num_bands - 1;
+        keys[i].key = 8.0 * band + ra_rad;
+        keys[i].index = i;
+    }
+    qsort(keys, num_sources, sizeof(SortKey), compare_keys);
+    for (i = 0; i < num_sources; ++i)
+        order[i] = keys[i].index;
+    free(keys);
+    return order;
+}
+
+
+static int compare_keys(const void* a, const void* b)
+{
+    const SortKey* x = (const SortKey*) a;
+    const SortKey* y = (const SortKey*) b;
+    if (x->key < y->key) return -1;
+    if (x->key > y->key) return 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+
+static double value(const char* column, int type, size_t i)
+{
+    if (type == OSKAR_DOUBLE)
+    {
+        double v;
+        memcpy(&v, column + i * sizeof(double), sizeof(double));
+        return v;
+    }
+    else
+    {
+        float v;
+        memcpy(&v, column + i * sizeof(float), sizeof(float));
+        return (double) v;
+    }
+}
+
+
+static void unit_vector(double ra_rad, double dec_rad, double v[3])
+{
+    const double cos_dec = cos(dec_rad);
+    v[0] = cos_dec * cos(ra_rad);
+    v[1] = cos_dec * sin(ra_rad);
+    v[2] = sin(dec_rad);
+}
+
+
+static double distance(const double a[3], const double b[3])
+{
+    /* Use atan2 of cross and dot products, which is accurate at all
+     * separations. */
+    const double x = a[1] * b[2] - a[2] * b[1];
+    const double y = a[2] * b[0] - a[0] * b[2];
+    const double z = a[0] * b[1] - a[1] * b[0];
+    const double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    return atan2(sqrt(x * x + y * y + z * z), dot);
+}
+
+
+static void copy_values(oskar_Mem* dst, size_t offset_dst, const char* src,
+        int src_type, size_t offset_src, size_t num, int* status)
+{
+    size_t i;
+    const int dst_type = oskar_mem_type(dst);
+    if (*status) return;
+    if (dst_type == src_type)
+    {
+        const size_t element_size = oskar_mem_element_size(src_type);
+        memcpy((char*) oskar_mem_void(dst) + offset_dst * element_size,
+                src + offset_src * element_size, num * element_size);
+    }
+    else if (dst_type == OSKAR_DOUBLE)
+    {
+        double* out = oskar_mem_double(dst, status) + offset_dst;
+        for (i = 0; i < num; ++i)
+            out[i] = value(src, src_type, offset_src + i);
+    }
+    else
+    {
+        float* out = oskar_mem_float(dst, status) + offset_dst;
+        for (i = 0; i < num; ++i)
+            out[i] = (float) value(src, src_type, offset_src + i);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,29 +1,6 @@
 /*
- * Copyright (c) 2016, The University of Oxford
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- * 1. Redistributions of source code must retain the above copyright notice,
- *    this list of conditions and the following disclaimer.
- * 2. Redistributions in binary form must reproduce the above copyright notice,
- *    this list of conditions and the following disclaimer in the documentation
- *    and/or other materials provided with the distribution.
- * 3. Neither the name of the University of Oxford nor the names of its
- *    contributors may be used to endorse or promote products derived from this
- *    software without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
- * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
- * POSSIBILITY OF SUCH DAMAGE.
+ * Copyright (c) 2016-2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
  */
 
 #include "convert/oskar_convert_galactic_to_fk5.h"
@@ -31,53 +8,160 @@
 #include "sky/oskar_sky.h"
 #include "math/oskar_cmath.h"
 
-#include <string.h>
+#include <stdlib.h>
+
+/* Number of pixels converted together. */
+#define BLOCK_SIZE 1024
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static int count_block(const oskar_Mem* data, int start, int end);
+static void fill_block(const oskar_Mem* data, int start, int end,
+        int nside, int galactic_coords, double frequency_hz,
+        double spectral_index, int offset, oskar_Sky* sky);
+
 oskar_Sky* oskar_sky_from_healpix_ring(int precision, const oskar_Mem* data,
         double frequency_hz, double spectral_index, int nside,
         int galactic_coords, int* status)
 {
-    int i = 0, s = 0, num_pixels, type;
-    const void* ptr;
-    oskar_Sky* sky;
+    return oskar_sky_from_healpix_ring_range(precision, data, frequency_hz,
+            spectral_index, nside, galactic_coords, 0, 12 * nside * nside,
+            status);
+}
+
+oskar_Sky* oskar_sky_from_healpix_ring_range(int precision,
+        const oskar_Mem* data, double frequency_hz, double spectral_index,
+        int nside, int galactic_coords, int first_pixel, int num_pixels,
+        int* status)
+{
+    int b, num_sources = 0;
+    oskar_Sky* sky = 0;
     if (*status) return 0;
 
-    /* Create a sky model. */
-    sky = oskar_sky_create(precision, OSKAR_CPU, 0, status);
+    /* Check the data. */
+    if (oskar_mem_location(data) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    if (oskar_mem_precision(data) != OSKAR_SINGLE &&
+            oskar_mem_precision(data) != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    if (first_pixel < 0 || num_pixels < 0 ||
+            first_pixel + num_pixels > 12 * nside * nside ||
+            first_pixel + num_pixels > (int) oskar_mem_length(data))
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return 0;
+    }
 
-    /* Save contents of memory to sky model. */
-    ptr = oskar_mem_void_const(data);
-    type = oskar_mem_precision(data);
-    num_pixels = 12 * nside * nside;
-    for (; i < num_pixels; ++i)
+    /* Count the non-zero pixels in each block. */
+    const int num_blocks = (num_pixels + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    int* offset = (int*) calloc(num_blocks + 1, sizeof(int));
+    if (!offset)
     {
-        double lat = 0.0, lon = 0.0, val = 0.0;
-        if (*status) break;
-        val = (type == OSKAR_SINGLE) ?
-                ((const float*)ptr)[i] : ((const double*)ptr)[i];
-        if (val == 0.0) continue;
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+#pragma omp parallel for private(b)
+    for (b = 0; b < num_blocks; ++b)
+    {
+        const int start = first_pixel + b * BLOCK_SIZE;
+        const int end = (b == num_blocks - 1) ?
+                first_pixel + num_pixels : start + BLOCK_SIZE;
+        offset[b + 1] = count_block(data, start, end);
+    }
+    for (b = 0; b < num_blocks; ++b)
+        offset[b + 1] += offset[b];
+    num_sources = offset[num_blocks];
 
-        /* Convert HEALPix index into spherical coordinates. */
-        oskar_convert_healpix_ring_to_theta_phi_d(nside, i, &lat, &lon);
-        lat = M_PI / 2.0 - lat; /* Colatitude to latitude. */
+    /* Create a sky model of the final size, and fill it. */
+    sky = oskar_sky_create(precision, OSKAR_CPU, num_sources, status);
+    if (!*status)
+    {
+#pragma omp parallel for private(b)
+        for (b = 0; b < num_blocks; ++b)
+        {
+            const int start = first_pixel + b * BLOCK_SIZE;
+            const int end = (b == num_blocks - 1) ?
+                    first_pixel + num_pixels : start + BLOCK_SIZE;
+            fill_block(data, start, end, nside, galactic_coords,
+                    frequency_hz, spectral_index, offset[b], sky);
+        }
+    }
+    free(offset);
+    return sky;
+}
+
+static int count_block(const oskar_Mem* data, int start, int end)
+{
+    int i, n = 0;
+    if (oskar_mem_precision(data) == OSKAR_SINGLE)
+    {
+        const float* ptr = (const float*) oskar_mem_void_const(data);
+        for (i = start; i < end; ++i) if (ptr[i] != 0.0f) ++n;
+    }
+    else
+    {
+        const double* ptr = (const double*) oskar_mem_void_const(data);
+        for (i = start; i < end; ++i) if (ptr[i] != 0.0) ++n;
+    }
+    return n;
+}
+
+#define STORE_BLOCK(FP) {\
+        FP* ra_ = (FP*) oskar_mem_void(oskar_sky_ra_rad(sky)) + offset;\
+        FP* dec_ = (FP*) oskar_mem_void(oskar_sky_dec_rad(sky)) + offset;\
+        FP* I_ = (FP*) oskar_mem_void(oskar_sky_I(sky)) + offset;\
+        FP* ref_ = (FP*) oskar_mem_void(\
+                oskar_sky_reference_freq_hz(sky)) + offset;\
+        FP* spix_ = (FP*) oskar_mem_void(\
+                oskar_sky_spectral_index(sky)) + offset;\
+        for (i = 0; i < n; ++i)\
+        {\
+            ra_[i] = (FP) lon[i];\
+            dec_[i] = (FP) lat[i];\
+            I_[i] = (FP) val[i];\
+            ref_[i] = (FP) frequency_hz;\
+            spix_[i] = (FP) spectral_index;\
+        }\
+    }
 
-        /* Convert Galactic coordinates to RA, Dec values if required. */
-        if (galactic_coords)
-            oskar_convert_galactic_to_fk5_d(1, &lon, &lat, &lon, &lat);
+static void fill_block(const oskar_Mem* data, int start, int end,
+        int nside, int galactic_coords, double frequency_hz,
+        double spectral_index, int offset, oskar_Sky* sky)
+{
+    int i, n = 0;
+    double lon[BLOCK_SIZE], lat[BLOCK_SIZE], val[BLOCK_SIZE];
+    const int type = oskar_mem_precision(data);
+    const void* ptr = oskar_mem_void_const(data);
 
-        /* Set source data into sky model. */
-        if (oskar_sky_num_sources(sky) <= s)
-            oskar_sky_resize(sky, s + 1000000, status);
-        oskar_sky_set_source(sky, s++, lon, lat, val, 0.0, 0.0, 0.0,
-                frequency_hz, spectral_index, 0.0, 0.0, 0.0, 0.0, status);
+    /* Convert HEALPix indices of non-zero pixels into spherical
+     * coordinates. */
+    for (i = start; i < end; ++i)
+    {
+        const double v = (type == OSKAR_SINGLE) ?
+                ((const float*)ptr)[i] : ((const double*)ptr)[i];
+        if (v == 0.0) continue;
+        oskar_convert_healpix_ring_to_theta_phi_d(nside, i, &lat[n], &lon[n]);
+        lat[n] = M_PI / 2.0 - lat[n]; /* Colatitude to latitude. */
+        val[n++] = v;
     }
-    oskar_sky_resize(sky, s, status);
 
-    return sky;
+    /* Convert Galactic coordinates to RA, Dec values if required. */
+    if (galactic_coords)
+        oskar_convert_galactic_to_fk5_d(n, lon, lat, lon, lat);
+
+    /* Store source data in sky model. */
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+        STORE_BLOCK(double)
+    else
+        STORE_BLOCK(float)
 }
 
 #ifdef __cplusplus
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2020, The OSKAR Developers.
+ * Copyright (c) 2016-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
@@ -8,13 +8,20 @@
 #include "math/oskar_cmath.h"
 #include "sky/oskar_sky.h"
 
+#include <stdlib.h>
+
+/* Number of pixels converted together. */
+#define BLOCK_SIZE 1024
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static void set_pixel(oskar_Sky* sky, int i, int x, int y, double val,
-        const double crval[2], const double crpix[2], const double cdelt[2],
-        double image_freq_hz, double spectral_index, int* status);
+static int count_block(const oskar_Mem* image, int start, int end);
+static void fill_block(const oskar_Mem* image, int start, int end,
+        int width, const double crval[2], const double crpix[2],
+        const double cdelt[2], double image_freq_hz, double spectral_index,
+        int offset, oskar_Sky* sky);
 
 
 oskar_Sky* oskar_sky_from_image(int precision, const oskar_Mem* image,
@@ -22,8 +29,8 @@ oskar_Sky* oskar_sky_from_image(int precision, const oskar_Mem* image,
         const double image_crpix[2], double image_cellsize_deg,
         double image_freq_hz, double spectral_index, int* status)
 {
-    int i, type, x, y;
-    double crval[2], cdelt[2], val;
+    int b, num_blocks, num_pixels, num_sources, *offset;
+    double crval[2], cdelt[2];
     oskar_Sky* sky = 0;
 
     /* Check if safe to proceed. */
@@ -38,6 +45,20 @@ oskar_Sky* oskar_sky_from_image(int precision, const oskar_Mem* image,
         return 0;
     }
 
+    /* Check the image. */
+    num_pixels = image_size[0] * image_size[1];
+    if ((int) oskar_mem_length(image) < num_pixels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return 0;
+    }
+    if (oskar_mem_precision(image) != OSKAR_SINGLE &&
+            oskar_mem_precision(image) != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
     /* Get reference pixels and reference values in radians. */
     crval[0] = image_crval_deg[0] * M_PI / 180.0;
     crval[1] = image_crval_deg[1] * M_PI / 180.0;
@@ -46,71 +67,111 @@ oskar_Sky* oskar_sky_from_image(int precision, const oskar_Mem* image,
     cdelt[0] = -sin(image_cellsize_deg * M_PI / 180.0);
     cdelt[1] = -cdelt[0];
 
-    /* Create a sky model. */
-    sky = oskar_sky_create(precision, OSKAR_CPU, 0, status);
-
-    /* Store the image pixels. */
-    type = oskar_mem_precision(image);
-    if (type == OSKAR_SINGLE)
+    /* Count the non-zero pixels in each block. */
+    num_blocks = (num_pixels + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    offset = (int*) calloc(num_blocks + 1, sizeof(int));
+    if (!offset)
     {
-        const float *img = oskar_mem_float_const(image, status);
-        for (y = 0, i = 0; y < image_size[1]; ++y)
-        {
-            for (x = 0; x < image_size[0]; ++x)
-            {
-                /* Check pixel value. */
-                val = (double) (img[image_size[0] * y + x]);
-                if (val == 0.0)
-                    continue;
-
-                set_pixel(sky, i++, x, y, val, crval, image_crpix, cdelt,
-                        image_freq_hz, spectral_index, status);
-            }
-        }
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
     }
-    else
+#pragma omp parallel for private(b)
+    for (b = 0; b < num_blocks; ++b)
     {
-        const double *img = oskar_mem_double_const(image, status);
-        for (y = 0, i = 0; y < image_size[1]; ++y)
+        const int start = b * BLOCK_SIZE;
+        const int end = (b == num_blocks - 1) ? num_pixels : start + BLOCK_SIZE;
+        offset[b + 1] = count_block(image, start, end);
+    }
+    for (b = 0; b < num_blocks; ++b)
+        offset[b + 1] += offset[b];
+    num_sources = offset[num_blocks];
+
+    /* Create a sky model of the final size, and store the image pixels. */
+    sky = oskar_sky_create(precision, OSKAR_CPU, num_sources, status);
+    if (!*status)
+    {
+#pragma omp parallel for private(b)
+        for (b = 0; b < num_blocks; ++b)
         {
-            for (x = 0; x < image_size[0]; ++x)
-            {
-                /* Check pixel value. */
-                val = img[image_size[0] * y + x];
-                if (val == 0.0)
-                    continue;
-
-                set_pixel(sky, i++, x, y, val, crval, image_crpix, cdelt,
-                        image_freq_hz, spectral_index, status);
-            }
+            const int start = b * BLOCK_SIZE;
+            const int end = (b == num_blocks - 1) ?
+                    num_pixels : start + BLOCK_SIZE;
+            fill_block(image, start, end, image_size[0], crval, image_crpix,
+                    cdelt, image_freq_hz, spectral_index, offset[b], sky);
         }
     }
 
     /* Return the sky model. */
-    oskar_sky_resize(sky, i, status);
+    free(offset);
     return sky;
 }
 
 
-static void set_pixel(oskar_Sky* sky, int i, int x, int y, double val,
-        const double crval[2], const double crpix[2], const double cdelt[2],
-        double image_freq_hz, double spectral_index, int* status)
+static int count_block(const oskar_Mem* image, int start, int end)
 {
-    double ra, dec;
+    int i, n = 0;
+    if (oskar_mem_precision(image) == OSKAR_SINGLE)
+    {
+        const float* img = (const float*) oskar_mem_void_const(image);
+        for (i = start; i < end; ++i) if (img[i] != 0.0f) ++n;
+    }
+    else
+    {
+        const double* img = (const double*) oskar_mem_void_const(image);
+        for (i = start; i < end; ++i) if (img[i] != 0.0) ++n;
+    }
+    return n;
+}
+
+#define STORE_BLOCK(FP) {\
+        FP* ra_ = (FP*) oskar_mem_void(oskar_sky_ra_rad(sky)) + offset;\
+        FP* dec_ = (FP*) oskar_mem_void(oskar_sky_dec_rad(sky)) + offset;\
+        FP* I_ = (FP*) oskar_mem_void(oskar_sky_I(sky)) + offset;\
+        FP* ref_ = (FP*) oskar_mem_void(\
+                oskar_sky_reference_freq_hz(sky)) + offset;\
+        FP* spix_ = (FP*) oskar_mem_void(\
+                oskar_sky_spectral_index(sky)) + offset;\
+        for (i = 0; i < n; ++i)\
+        {\
+            ra_[i] = (FP) ra[i];\
+            dec_[i] = (FP) dec[i];\
+            I_[i] = (FP) val[i];\
+            ref_[i] = (FP) image_freq_hz;\
+            spix_[i] = (FP) spectral_index;\
+        }\
+    }
+
+static void fill_block(const oskar_Mem* image, int start, int end,
+        int width, const double crval[2], const double crpix[2],
+        const double cdelt[2], double image_freq_hz, double spectral_index,
+        int offset, oskar_Sky* sky)
+{
+    int i, n = 0;
+    double l[BLOCK_SIZE], m[BLOCK_SIZE], val[BLOCK_SIZE];
+    double ra[BLOCK_SIZE], dec[BLOCK_SIZE];
+    const int type = oskar_mem_precision(image);
+    const void* img = oskar_mem_void_const(image);
+
+    /* Get direction cosines of non-zero pixels. */
+    for (i = start; i < end; ++i)
+    {
+        const double v = (type == OSKAR_SINGLE) ?
+                ((const float*)img)[i] : ((const double*)img)[i];
+        if (v == 0.0) continue;
+        l[n] = cdelt[0] * (i % width + 1 - crpix[0]);
+        m[n] = cdelt[1] * (i / width + 1 - crpix[1]);
+        val[n++] = v;
+    }
 
     /* Convert pixel positions to RA and Dec values. */
-    const double l = cdelt[0] * (x + 1 - crpix[0]);
-    const double m = cdelt[1] * (y + 1 - crpix[1]);
-    const double cos_dec0 = cos(crval[1]);
-    const double sin_dec0 = sin(crval[1]);
-    oskar_convert_relative_directions_to_lon_lat_2d_d(1,
-            &l, &m, 0, crval[0], cos_dec0, sin_dec0, &ra, &dec);
+    oskar_convert_relative_directions_to_lon_lat_2d_d(n, l, m, 0,
+            crval[0], cos(crval[1]), sin(crval[1]), ra, dec);
 
     /* Store pixel data in sky model. */
-    if (oskar_sky_num_sources(sky) <= i)
-        oskar_sky_resize(sky, i + 1000, status);
-    oskar_sky_set_source(sky, i, ra, dec, val, 0.0, 0.0, 0.0,
-            image_freq_hz, spectral_index, 0.0, 0.0, 0.0, 0.0, status);
+    if (oskar_sky_precision(sky) == OSKAR_DOUBLE)
+        STORE_BLOCK(double)
+    else
+        STORE_BLOCK(float)
 }
 
 #ifdef __cplusplus
@@ -26,20 +26,36 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "math/oskar_cmath.h"
 #include "math/oskar_prefix_sum.h"
 #include "sky/oskar_sky.h"
 #include "sky/oskar_sky_copy_source_data.h"
 #include "sky/oskar_update_horizon_mask.h"
 
+#include <stdlib.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Sources closer than this to the horizon are always checked directly. */
+#define HORIZON_TOLERANCE_RAD 1e-4
+
 static double ha0(double longitude, double ra0, double gast);
+static void update_horizon_mask_indexed(const oskar_SkyIndex* index,
+        const oskar_Sky* sky, const oskar_Telescope* telescope, double gast,
+        oskar_Mem* horizon_mask, int* status);
 
 void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
         const oskar_Telescope* telescope, double gast,
         oskar_StationWork* work, int* status)
+{
+    oskar_sky_horizon_clip_indexed(out, in, 0, telescope, gast, work, status);
+}
+
+void oskar_sky_horizon_clip_indexed(oskar_Sky* out, const oskar_Sky* in,
+        const oskar_SkyIndex* index, const oskar_Telescope* telescope,
+        double gast, oskar_StationWork* work, int* status)
 {
     int i;
     oskar_Mem *horizon_mask, *source_indices;
@@ -70,6 +86,12 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
     const int num_in = oskar_sky_num_sources(in);
     const double ra0 = oskar_sky_reference_ra_rad(in);
     const double dec0 = oskar_sky_reference_dec_rad(in);
+    if (location != OSKAR_CPU) index = 0;
+    if (index && oskar_sky_index_num_points(index) != num_in)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
 
     /* Resize the output sky model if necessary. */
     if (oskar_sky_capacity(out) < num_in)
@@ -82,14 +104,21 @@ void oskar_sky_horizon_clip(oskar_Sky* out, const oskar_Sky* in,
     /* Create the horizon mask. */
     oskar_mem_clear_contents(horizon_mask, status);
     const int num_stations = oskar_telescope_num_stations(telescope);
-    for (i = 0; i < num_stations; ++i)
+    if (index)
+        update_horizon_mask_indexed(index, in, telescope, gast,
+                horizon_mask, status);
+    else
     {
-        const oskar_Station* s = oskar_telescope_station_const(telescope, i);
-        if (!s) continue;
-        oskar_update_horizon_mask(num_in, oskar_sky_l_const(in),
-                oskar_sky_m_const(in), oskar_sky_n_const(in),
-                ha0(oskar_station_lon_rad(s), ra0, gast), dec0,
-                oskar_station_lat_rad(s), horizon_mask, status);
+        for (i = 0; i < num_stations; ++i)
+        {
+            const oskar_Station* s =
+                    oskar_telescope_station_const(telescope, i);
+            if (!s) continue;
+            oskar_update_horizon_mask(num_in, oskar_sky_l_const(in),
+                    oskar_sky_m_const(in), oskar_sky_n_const(in),
+                    ha0(oskar_station_lon_rad(s), ra0, gast), dec0,
+                    oskar_station_lat_rad(s), horizon_mask, status);
+        }
     }
 
     /* Apply exclusive prefix sum to mask to get source output indices.
@@ -106,6 +135,94 @@ static double ha0(double longitude, double ra0, double gast)
     return (gast + longitude) - ra0;
 }
 
+#define CHECK_RANGE(FP, L, M, N, LL, MM, NN) \
+        for (j = start; j < end; ++j) \
+        { \
+            const int k = order[j]; \
+            for (c = 0; c < num_centres && !mask[k]; ++c) \
+                mask[k] = ((L[k] * LL[c] + M[k] * MM[c] + N[k] * NN[c]) > \
+                        (FP) 0); \
+        }
+
+static void update_horizon_mask_indexed(const oskar_SkyIndex* index,
+        const oskar_Sky* sky, const oskar_Telescope* telescope, double gast,
+        oskar_Mem* horizon_mask, int* status)
+{
+    int c, i, j, num_centres = 0;
+    const int type = oskar_sky_precision(sky);
+    const int num_stations = oskar_telescope_num_stations(telescope);
+    const double ra0_rad = oskar_sky_reference_ra_rad(sky);
+    const double dec0_rad = oskar_sky_reference_dec_rad(sky);
+    const double sin_dec0 = sin(dec0_rad), cos_dec0 = cos(dec0_rad);
+
+    /* Get the zenith of each station, and its direction cosines relative
+     * to the reference point of the sky model. */
+    double* lst = (double*) calloc(num_stations + 1, 6 * sizeof(double));
+    float* lmn_f = (float*) calloc(num_stations + 1, 3 * sizeof(float));
+    double *lat = lst + num_stations, *ll = lat + num_stations;
+    double *mm = ll + num_stations, *nn = mm + num_stations;
+    float *ll_f = lmn_f, *mm_f = ll_f + num_stations;
+    float *nn_f = mm_f + num_stations;
+    for (i = 0; i < num_stations; ++i)
+    {
+        const oskar_Station* s = oskar_telescope_station_const(telescope, i);
+        if (!s) continue;
+        const double ha0_rad = ha0(oskar_station_lon_rad(s), ra0_rad, gast);
+        const double lat_rad = oskar_station_lat_rad(s);
+        const double cos_ha0 = cos(ha0_rad);
+        const double sin_lat = sin(lat_rad), cos_lat = cos(lat_rad);
+        lst[num_centres] = gast + oskar_station_lon_rad(s);
+        lat[num_centres] = lat_rad;
+        ll[num_centres] = cos_lat * sin(ha0_rad);
+        mm[num_centres] = sin_lat * cos_dec0 - cos_lat * cos_ha0 * sin_dec0;
+        nn[num_centres] = sin_lat * sin_dec0 + cos_lat * cos_ha0 * cos_dec0;
+        ll_f[num_centres] = (float) ll[num_centres];
+        mm_f[num_centres] = (float) mm[num_centres];
+        nn_f[num_centres] = (float) nn[num_centres];
+        num_centres++;
+    }
+
+    /* The horizon of each station is a circle of radius 90 degrees about
+     * its zenith. Sources in ranges which are not entirely above the
+     * horizon of a station are checked in the same way as in
+     * oskar_update_horizon_mask(). */
+    oskar_Mem* ranges = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    const int num_ranges = oskar_sky_index_query_ranges(index,
+            num_centres, lst, lat, M_PI / 2.0, HORIZON_TOLERANCE_RAD,
+            ranges, status);
+    const int* r = oskar_mem_int_const(ranges, status);
+    const int* order = oskar_sky_index_order(index);
+    int* mask = oskar_mem_int(horizon_mask, status);
+    for (i = 0; i < num_ranges && !*status; ++i)
+    {
+        const int start = r[3 * i], end = r[3 * i + 1];
+        if (r[3 * i + 2])
+        {
+            for (j = start; j < end; ++j)
+                mask[order[j]] = 1;
+        }
+        else if (type == OSKAR_DOUBLE)
+        {
+            const double *l, *m, *n;
+            l = oskar_mem_double_const(oskar_sky_l_const(sky), status);
+            m = oskar_mem_double_const(oskar_sky_m_const(sky), status);
+            n = oskar_mem_double_const(oskar_sky_n_const(sky), status);
+            CHECK_RANGE(double, l, m, n, ll, mm, nn)
+        }
+        else
+        {
+            const float *l, *m, *n;
+            l = oskar_mem_float_const(oskar_sky_l_const(sky), status);
+            m = oskar_mem_float_const(oskar_sky_m_const(sky), status);
+            n = oskar_mem_float_const(oskar_sky_n_const(sky), status);
+            CHECK_RANGE(float, l, m, n, ll_f, mm_f, nn_f)
+        }
+    }
+    oskar_mem_free(ranges, status);
+    free(lmn_f);
+    free(lst);
+}
+
 #ifdef __cplusplus
 }
 #endif
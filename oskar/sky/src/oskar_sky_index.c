@@ -0,0 +1,848 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/oskar_sky_index.h"
+#include "math/oskar_cmath.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of positions in a leaf node. */
+#define LEAF_SIZE 16
+
+/* Maximum HEALPix order (nside 8192), so pixel indices fit in 30 bits. */
+#define MAX_ORDER 13
+
+typedef struct Node
+{
+    double min[3], max[3]; /* Bounding box of unit vectors. */
+    int start, end;        /* Range of positions, in tree order. */
+    int first_child, num_children;
+} Node;
+
+struct oskar_SkyIndex
+{
+    int num_points, order, num_nodes, capacity_nodes;
+    int* index;  /* Original index of each position, in tree order. */
+    double* xyz; /* Unit vectors, in tree order. */
+    Node* nodes;
+};
+
+typedef struct Build
+{
+    oskar_SkyIndex* idx;
+    unsigned int* keys; /* Sorted HEALPix nested pixel indices. */
+    int* status;
+} Build;
+
+typedef struct Heap
+{
+    int size, capacity;
+    double* dist2;
+    int* index;
+} Heap;
+
+static unsigned int nested_pixel(int order, const double v[3]);
+static unsigned int spread_bits(unsigned int v);
+static void sort_by_key(int num, unsigned int* keys, int* index, int* status);
+static int new_nodes(oskar_SkyIndex* idx, int num, int* status);
+static void build_node(Build* b, int node, int level);
+static void split_kd(Build* b, int node);
+static void select_nth(oskar_SkyIndex* idx, unsigned int* keys,
+        int start, int end, int nth, int axis);
+static void swap_points(oskar_SkyIndex* idx, unsigned int* keys,
+        int i, int j);
+static double min_dist2(const Node* n, const double q[3]);
+static double max_dist2(const Node* n, const double q[3]);
+static double dist2(const double* p, const double q[3]);
+static double chord2(double angle_rad);
+static void unit_vector(double ra_rad, double dec_rad, double v[3]);
+static int append(oskar_Mem* mem, int num, int value, int* status);
+static int compare_int(const void* a, const void* b);
+static void heap_push(Heap* h, double d2, int index);
+static void heap_sift_down(Heap* h, double d2, int index);
+static void search_nearest(const oskar_SkyIndex* idx, int node,
+        const double q[3], Heap* h);
+
+
+oskar_SkyIndex* oskar_sky_index_create(int num_points,
+        const oskar_Mem* ra_rad, const oskar_Mem* dec_rad, int* status)
+{
+    int i;
+    oskar_SkyIndex* idx = 0;
+    if (*status) return 0;
+    const int type = oskar_mem_type(ra_rad);
+    if (oskar_mem_location(ra_rad) != OSKAR_CPU ||
+            oskar_mem_location(dec_rad) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return 0;
+    }
+    if (oskar_mem_type(dec_rad) != type ||
+            (type != OSKAR_SINGLE && type != OSKAR_DOUBLE))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+    if (num_points < 0 || (size_t) num_points > oskar_mem_length(ra_rad) ||
+            (size_t) num_points > oskar_mem_length(dec_rad))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return 0;
+    }
+
+    /* Choose the HEALPix resolution from the number of positions,
+     * so that there is about one position per pixel. */
+    idx = (oskar_SkyIndex*) calloc(1, sizeof(oskar_SkyIndex));
+    idx->num_points = num_points;
+    while (idx->order < MAX_ORDER &&
+            12.0 * pow(4.0, idx->order) < (double) num_points)
+        idx->order++;
+
+    /* Convert positions to unit vectors and get their pixel indices. */
+    unsigned int* keys = (unsigned int*) malloc(
+            (num_points + 1) * sizeof(unsigned int));
+    double* xyz = (double*) malloc((3 * num_points + 1) * sizeof(double));
+    idx->index = (int*) malloc((num_points + 1) * sizeof(int));
+    idx->xyz = (double*) malloc((3 * num_points + 1) * sizeof(double));
+    if (!keys || !xyz || !idx->index || !idx->xyz)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(keys);
+        free(xyz);
+        oskar_sky_index_free(idx);
+        return 0;
+    }
+    if (type == OSKAR_DOUBLE)
+    {
+        const double* ra = oskar_mem_double_const(ra_rad, status);
+        const double* dec = oskar_mem_double_const(dec_rad, status);
+        for (i = 0; i < num_points; ++i)
+            unit_vector(ra[i], dec[i], &xyz[3 * i]);
+    }
+    else
+    {
+        const float* ra = oskar_mem_float_const(ra_rad, status);
+        const float* dec = oskar_mem_float_const(dec_rad, status);
+        for (i = 0; i < num_points; ++i)
+            unit_vector(ra[i], dec[i], &xyz[3 * i]);
+    }
+    for (i = 0; i < num_points; ++i)
+    {
+        keys[i] = nested_pixel(idx->order, &xyz[3 * i]);
+        idx->index[i] = i;
+    }
+
+    /* Sort the positions by pixel index. */
+    sort_by_key(num_points, keys, idx->index, status);
+    for (i = 0; i < num_points; ++i)
+        memcpy(&idx->xyz[3 * i], &xyz[3 * idx->index[i]],
+                3 * sizeof(double));
+    free(xyz);
+
+    /* Build the tree. */
+    if (!*status && new_nodes(idx, 1, status) == 0)
+    {
+        Build b;
+        b.idx = idx;
+        b.keys = keys;
+        b.status = status;
+        idx->nodes[0].start = 0;
+        idx->nodes[0].end = num_points;
+        build_node(&b, 0, -1);
+    }
+    free(keys);
+    if (*status)
+    {
+        oskar_sky_index_free(idx);
+        idx = 0;
+    }
+    return idx;
+}
+
+
+int oskar_sky_index_num_points(const oskar_SkyIndex* index)
+{
+    return index->num_points;
+}
+
+
+int oskar_sky_index_nside(const oskar_SkyIndex* index)
+{
+    return 1 << index->order;
+}
+
+
+const int* oskar_sky_index_order(const oskar_SkyIndex* index)
+{
+    return index->index;
+}
+
+
+int oskar_sky_index_query_radius(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double inner_radius_rad,
+        double outer_radius_rad, oskar_Mem* indices, int* status)
+{
+    int i, num_found = 0, top = 0, *stack = 0;
+    double q[3];
+    if (*status || index->num_points == 0) return 0;
+
+    /* Use squared chord lengths, which are accurate at small distances. */
+    const double inner2 = inner_radius_rad > 0.0 ?
+            chord2(inner_radius_rad) : -1.0;
+    const double outer2 = outer_radius_rad > M_PI ?
+            5.0 : chord2(outer_radius_rad);
+    if (outer_radius_rad <= inner_radius_rad) return 0;
+    unit_vector(ra_rad, dec_rad, q);
+    stack = (int*) malloc(index->num_nodes * sizeof(int));
+    stack[top++] = 0;
+    while (top > 0 && !*status)
+    {
+        const Node* n = &index->nodes[stack[--top]];
+        const double d_min = min_dist2(n, q), d_max = max_dist2(n, q);
+        if (d_min >= outer2 || d_max < inner2) continue;
+        if (d_max < outer2 && d_min >= inner2)
+        {
+            /* All positions in the node are within the annulus. */
+            for (i = n->start; i < n->end; ++i)
+                num_found = append(indices, num_found, index->index[i],
+                        status);
+        }
+        else if (n->num_children == 0)
+        {
+            for (i = n->start; i < n->end; ++i)
+            {
+                const double d = dist2(&index->xyz[3 * i], q);
+                if (d >= inner2 && d < outer2)
+                    num_found = append(indices, num_found, index->index[i],
+                            status);
+            }
+        }
+        else
+        {
+            for (i = 0; i < n->num_children; ++i)
+                stack[top++] = n->first_child + i;
+        }
+    }
+    free(stack);
+    if (num_found > 1 && !*status)
+        qsort(oskar_mem_int(indices, status), num_found, sizeof(int),
+                compare_int);
+    return num_found;
+}
+
+
+int oskar_sky_index_query_box(const oskar_SkyIndex* index,
+        double ra_min_rad, double ra_max_rad,
+        double dec_min_rad, double dec_max_rad,
+        oskar_Mem* indices, int* status)
+{
+    int i, num_found = 0, top = 0, *stack = 0;
+    double centre[3], cap2 = 5.0;
+    if (*status || index->num_points == 0) return 0;
+    if (dec_max_rad < dec_min_rad) return 0;
+
+    /* Wrap the Right Ascension range into [0, 2 pi). */
+    const int full_circle = (ra_max_rad - ra_min_rad >= 2.0 * M_PI);
+    ra_min_rad = fmod(ra_min_rad, 2.0 * M_PI);
+    ra_max_rad = fmod(ra_max_rad, 2.0 * M_PI);
+    if (ra_min_rad < 0.0) ra_min_rad += 2.0 * M_PI;
+    if (ra_max_rad < 0.0) ra_max_rad += 2.0 * M_PI;
+    double width = ra_max_rad - ra_min_rad;
+    if (width < 0.0) width += 2.0 * M_PI;
+    if (full_circle) width = 2.0 * M_PI;
+    const double z_min = sin(dec_min_rad), z_max = sin(dec_max_rad);
+
+    /* Find a bounding cap for the box, which is used to prune the tree.
+     * If the box is less than half the sphere wide, the corner furthest
+     * from the centre of the box defines the radius of the cap. */
+    unit_vector(ra_min_rad + 0.5 * width, 0.5 * (dec_min_rad + dec_max_rad),
+            centre);
+    if (width < M_PI)
+    {
+        int j;
+        double corner[3];
+        cap2 = 0.0;
+        for (i = 0; i < 2; ++i)
+        {
+            for (j = 0; j < 2; ++j)
+            {
+                unit_vector(i ? ra_max_rad : ra_min_rad,
+                        j ? dec_max_rad : dec_min_rad, corner);
+                const double d = dist2(corner, centre);
+                if (d > cap2) cap2 = d;
+            }
+        }
+        cap2 = cap2 * (1.0 + 1e-9) + 1e-15;
+    }
+    stack = (int*) malloc(index->num_nodes * sizeof(int));
+    stack[top++] = 0;
+    while (top > 0 && !*status)
+    {
+        const Node* n = &index->nodes[stack[--top]];
+        if (n->max[2] < z_min || n->min[2] > z_max ||
+                min_dist2(n, centre) > cap2)
+            continue;
+        if (n->num_children == 0)
+        {
+            for (i = n->start; i < n->end; ++i)
+            {
+                const double* p = &index->xyz[3 * i];
+                const double dec = atan2(p[2], sqrt(p[0]*p[0] + p[1]*p[1]));
+                double ra = atan2(p[1], p[0]);
+                if (dec < dec_min_rad || dec > dec_max_rad) continue;
+                ra -= ra_min_rad;
+                while (ra < 0.0) ra += 2.0 * M_PI;
+                if (ra > width) continue;
+                num_found = append(indices, num_found, index->index[i],
+                        status);
+            }
+        }
+        else
+        {
+            for (i = 0; i < n->num_children; ++i)
+                stack[top++] = n->first_child + i;
+        }
+    }
+    free(stack);
+    if (num_found > 1 && !*status)
+        qsort(oskar_mem_int(indices, status), num_found, sizeof(int),
+                compare_int);
+    return num_found;
+}
+
+
+int oskar_sky_index_query_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, int k, oskar_Mem* indices,
+        oskar_Mem* distances_rad, int* status)
+{
+    int i, *out_index = 0;
+    double q[3], *out_dist = 0;
+    Heap h;
+    if (*status || k <= 0 || index->num_points == 0) return 0;
+    if (k > index->num_points) k = index->num_points;
+    h.size = 0;
+    h.capacity = k;
+    h.dist2 = (double*) malloc(k * sizeof(double));
+    h.index = (int*) malloc(k * sizeof(int));
+    unit_vector(ra_rad, dec_rad, q);
+    search_nearest(index, 0, q, &h);
+
+    /* Sort the results by taking the furthest from the top of the heap. */
+    oskar_mem_ensure(indices, k, status);
+    if (distances_rad) oskar_mem_ensure(distances_rad, k, status);
+    out_index = oskar_mem_int(indices, status);
+    if (distances_rad) out_dist = oskar_mem_double(distances_rad, status);
+    for (i = k - 1; i >= 0 && !*status; --i)
+    {
+        out_index[i] = h.index[0];
+        if (out_dist)
+            out_dist[i] = 2.0 * asin(0.5 * sqrt(h.dist2[0]));
+        h.size--;
+        heap_sift_down(&h, h.dist2[h.size], h.index[h.size]);
+    }
+    free(h.dist2);
+    free(h.index);
+    return *status ? 0 : k;
+}
+
+
+int oskar_sky_index_nearest(const oskar_SkyIndex* index,
+        double ra_rad, double dec_rad, double* distance_rad)
+{
+    int nearest = -1;
+    double q[3], d2 = 0.0;
+    Heap h;
+    if (index->num_points == 0) return -1;
+    h.size = 0;
+    h.capacity = 1;
+    h.dist2 = &d2;
+    h.index = &nearest;
+    unit_vector(ra_rad, dec_rad, q);
+    search_nearest(index, 0, q, &h);
+    if (distance_rad) *distance_rad = 2.0 * asin(0.5 * sqrt(d2));
+    return nearest;
+}
+
+
+int oskar_sky_index_query_ranges(const oskar_SkyIndex* index,
+        int num_centres, const double* ra_rad, const double* dec_rad,
+        double radius_rad, double tolerance_rad, oskar_Mem* ranges,
+        int* status)
+{
+    int c, num_ranges = 0, top = 0, *stack = 0, *r = 0;
+    double* q = 0;
+    if (*status || index->num_points == 0 || num_centres <= 0) return 0;
+    const double inner2 = radius_rad - tolerance_rad > 0.0 ?
+            chord2(radius_rad - tolerance_rad) : -1.0;
+    const double outer2 = radius_rad + tolerance_rad > M_PI ?
+            5.0 : chord2(radius_rad + tolerance_rad);
+    q = (double*) malloc(3 * num_centres * sizeof(double));
+    for (c = 0; c < num_centres; ++c)
+        unit_vector(ra_rad[c], dec_rad[c], &q[3 * c]);
+    stack = (int*) malloc(index->num_nodes * sizeof(int));
+    stack[top++] = 0;
+    while (top > 0 && !*status)
+    {
+        int i, whole = 0, outside = 1;
+        const Node* n = &index->nodes[stack[--top]];
+        for (c = 0; c < num_centres; ++c)
+        {
+            if (min_dist2(n, &q[3 * c]) >= outer2) continue;
+            outside = 0;
+            if (max_dist2(n, &q[3 * c]) < inner2)
+            {
+                whole = 1;
+                break;
+            }
+        }
+        if (outside) continue;
+        if (!whole && n->num_children > 0)
+        {
+            /* Push children in reverse, so ranges come out in order. */
+            for (i = n->num_children - 1; i >= 0; --i)
+                stack[top++] = n->first_child + i;
+            continue;
+        }
+
+        /* Extend the previous range if possible. */
+        r = oskar_mem_int(ranges, status);
+        if (num_ranges > 0 && r[3 * num_ranges - 2] == n->start &&
+                r[3 * num_ranges - 1] == whole)
+        {
+            r[3 * num_ranges - 2] = n->end;
+            continue;
+        }
+        oskar_mem_ensure(ranges, 3 * (num_ranges + 1), status);
+        if (*status) break;
+        r = oskar_mem_int(ranges, status);
+        r[3 * num_ranges + 0] = n->start;
+        r[3 * num_ranges + 1] = n->end;
+        r[3 * num_ranges + 2] = whole;
+        num_ranges++;
+    }
+    free(stack);
+    free(q);
+    return num_ranges;
+}
+
+
+void oskar_sky_index_free(oskar_SkyIndex* index)
+{
+    if (!index) return;
+    free(index->index);
+    free(index->xyz);
+    free(index->nodes);
+    free(index);
+}
+
+
+static void build_node(Build* b, int node, int level)
+{
+    int i, j, start, end;
+    oskar_SkyIndex* idx = b->idx;
+    if (*b->status) return;
+    Node* n = &idx->nodes[node];
+    start = n->start;
+    end = n->end;
+
+    /* Find the bounding box. */
+    for (j = 0; j < 3; ++j)
+    {
+        n->min[j] = 2.0;
+        n->max[j] = -2.0;
+    }
+    for (i = start; i < end; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+        {
+            const double v = idx->xyz[3 * i + j];
+            if (v < n->min[j]) n->min[j] = v;
+            if (v > n->max[j]) n->max[j] = v;
+        }
+    }
+    n->num_children = 0;
+    if (end - start <= LEAF_SIZE) return;
+
+    /* Split into child pixels at the next level of the HEALPix hierarchy,
+     * skipping levels where all positions fall into the same pixel. */
+    while (level < idx->order)
+    {
+        int num_children = 0, first;
+        const int shift = 2 * (idx->order - level - 1);
+        const unsigned int mask = (level < 0) ? ~0u : 3u;
+        for (i = start; i < end; ++i)
+            if (i == start || ((b->keys[i] >> shift) & mask) !=
+                    ((b->keys[i - 1] >> shift) & mask))
+                num_children++;
+        level++;
+        if (num_children == 1) continue;
+        first = new_nodes(idx, num_children, b->status);
+        if (*b->status) return;
+        idx->nodes[node].first_child = first;
+        idx->nodes[node].num_children = num_children;
+        for (i = start, j = first; i < end; ++i)
+        {
+            if (i == start) idx->nodes[j].start = i;
+            else if (((b->keys[i] >> shift) & mask) !=
+                    ((b->keys[i - 1] >> shift) & mask))
+            {
+                idx->nodes[j++].end = i;
+                idx->nodes[j].start = i;
+            }
+        }
+        idx->nodes[j].end = end;
+        for (j = 0; j < num_children; ++j)
+            build_node(b, first + j, level);
+        return;
+    }
+
+    /* At the finest level, split the cell as a k-d tree. */
+    split_kd(b, node);
+}
+
+
+static void split_kd(Build* b, int node)
+{
+    int j, axis = 0, first;
+    double extent = -1.0;
+    oskar_SkyIndex* idx = b->idx;
+    const Node* n = &idx->nodes[node];
+    const int start = n->start, end = n->end, mid = (start + end) / 2;
+    for (j = 0; j < 3; ++j)
+    {
+        if (n->max[j] - n->min[j] > extent)
+        {
+            extent = n->max[j] - n->min[j];
+            axis = j;
+        }
+    }
+
+    /* Coincident positions cannot be split. */
+    if (extent <= 0.0) return;
+    select_nth(idx, b->keys, start, end, mid, axis);
+    first = new_nodes(idx, 2, b->status);
+    if (*b->status) return;
+    idx->nodes[node].first_child = first;
+    idx->nodes[node].num_children = 2;
+    idx->nodes[first].start = start;
+    idx->nodes[first].end = mid;
+    idx->nodes[first + 1].start = mid;
+    idx->nodes[first + 1].end = end;
+    build_node(b, first, idx->order);
+    build_node(b, first + 1, idx->order);
+}
+
+
+static void select_nth(oskar_SkyIndex* idx, unsigned int* keys,
+        int start, int end, int nth, int axis)
+{
+    /* Quickselect, so that positions before nth are not greater than it,
+     * and positions after it are not less. */
+    int lo = start, hi = end - 1;
+    while (hi > lo)
+    {
+        int i = lo, j = hi;
+        const double pivot = idx->xyz[3 * ((lo + hi) / 2) + axis];
+        while (i <= j)
+        {
+            while (idx->xyz[3 * i + axis] < pivot) i++;
+            while (idx->xyz[3 * j + axis] > pivot) j--;
+            if (i <= j) swap_points(idx, keys, i++, j--);
+        }
+        if (nth <= j) hi = j;
+        else if (nth >= i) lo = i;
+        else break;
+    }
+}
+
+
+static void swap_points(oskar_SkyIndex* idx, unsigned int* keys, int i, int j)
+{
+    int k;
+    const unsigned int t_key = keys[i];
+    const int t_index = idx->index[i];
+    keys[i] = keys[j];
+    keys[j] = t_key;
+    idx->index[i] = idx->index[j];
+    idx->index[j] = t_index;
+    for (k = 0; k < 3; ++k)
+    {
+        const double t = idx->xyz[3 * i + k];
+        idx->xyz[3 * i + k] = idx->xyz[3 * j + k];
+        idx->xyz[3 * j + k] = t;
+    }
+}
+
+
+static int new_nodes(oskar_SkyIndex* idx, int num, int* status)
+{
+    const int first = idx->num_nodes;
+    if (first + num > idx->capacity_nodes)
+    {
+        int capacity = 2 * idx->capacity_nodes;
+        if (capacity < first + num)
+            capacity = first + num + 2 * (idx->num_points / LEAF_SIZE);
+        Node* t = (Node*) realloc(idx->nodes, capacity * sizeof(Node));
+        if (!t)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return -1;
+        }
+        idx->nodes = t;
+        idx->capacity_nodes = capacity;
+    }
+    memset(&idx->nodes[first], 0, num * sizeof(Node));
+    idx->num_nodes += num;
+    return first;
+}
+
+
+static void sort_by_key(int num, unsigned int* keys, int* index, int* status)
+{
+    /* Least-significant-digit radix sort, with 8-bit digits. */
+    int pass, i;
+    unsigned int* keys_tmp = (unsigned int*) malloc(
+            (num + 1) * sizeof(unsigned int));
+    int* index_tmp = (int*) malloc((num + 1) * sizeof(int));
+    if (!keys_tmp || !index_tmp)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        free(keys_tmp);
+        free(index_tmp);
+        return;
+    }
+    for (pass = 0; pass < 4 && num > 0; ++pass)
+    {
+        int count[257];
+        const int shift = 8 * pass;
+        memset(count, 0, sizeof(count));
+        for (i = 0; i < num; ++i)
+            count[((keys[i] >> shift) & 0xFF) + 1]++;
+        if (count[((keys[0] >> shift) & 0xFF) + 1] == num) continue;
+        for (i = 0; i < 256; ++i)
+            count[i + 1] += count[i];
+        for (i = 0; i < num; ++i)
+        {
+            const int j = count[(keys[i] >> shift) & 0xFF]++;
+            keys_tmp[j] = keys[i];
+            index_tmp[j] = index[i];
+        }
+        memcpy(keys, keys_tmp, num * sizeof(unsigned int));
+        memcpy(index, index_tmp, num * sizeof(int));
+    }
+    free(keys_tmp);
+    free(index_tmp);
+}
+
+
+static unsigned int nested_pixel(int order, const double v[3])
+{
+    /* Pixel index in the HEALPix nested scheme (Gorski et al. 2005). */
+    unsigned int face, ix, iy;
+    const int nside = 1 << order;
+    const double z = v[2], za = fabs(z);
+    double tt = atan2(v[1], v[0]) / (0.5 * M_PI);
+    if (tt < 0.0) tt += 4.0;
+    if (tt >= 4.0) tt = 0.0;
+    if (za <= 2.0 / 3.0)
+    {
+        const double t1 = nside * (0.5 + tt), t2 = nside * (0.75 * z);
+        const int jp = (int) (t1 - t2), jm = (int) (t1 + t2);
+        const int ifp = jp >> order, ifm = jm >> order;
+        face = (ifp == ifm) ? (ifp | 4) : ((ifp < ifm) ? ifp : ifm + 8);
+        ix = jm & (nside - 1);
+        iy = nside - (jp & (nside - 1)) - 1;
+    }
+    else
+    {
+        int ntt = (int) tt, jp, jm;
+        if (ntt > 3) ntt = 3;
+        const double tp = tt - ntt;
+        const double tmp = nside * sqrt(3.0 * (1.0 - za));
+        jp = (int) (tp * tmp);
+        jm = (int) ((1.0 - tp) * tmp);
+        if (jp > nside - 1) jp = nside - 1;
+        if (jm > nside - 1) jm = nside - 1;
+        if (z >= 0.0)
+        {
+            face = ntt;
+            ix = nside - jm - 1;
+            iy = nside - jp - 1;
+        }
+        else
+        {
+            face = ntt + 8;
+            ix = jp;
+            iy = jm;
+        }
+    }
+    if (face > 11) face = 11;
+    return (face << (2 * order)) + spread_bits(ix) + (spread_bits(iy) << 1);
+}
+
+
+static unsigned int spread_bits(unsigned int v)
+{
+    /* Interleave zeros between the low 16 bits. */
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+
+static double min_dist2(const Node* n, const double q[3])
+{
+    int j;
+    double d = 0.0;
+    for (j = 0; j < 3; ++j)
+    {
+        double t = 0.0;
+        if (q[j] < n->min[j]) t = n->min[j] - q[j];
+        else if (q[j] > n->max[j]) t = q[j] - n->max[j];
+        d += t * t;
+    }
+    return d;
+}
+
+
+static double max_dist2(const Node* n, const double q[3])
+{
+    int j;
+    double d = 0.0;
+    for (j = 0; j < 3; ++j)
+    {
+        const double a = fabs(q[j] - n->min[j]), b = fabs(q[j] - n->max[j]);
+        d += (a > b) ? a * a : b * b;
+    }
+    return d;
+}
+
+
+static double dist2(const double* p, const double q[3])
+{
+    const double x = p[0] - q[0], y = p[1] - q[1], z = p[2] - q[2];
+    return x * x + y * y + z * z;
+}
+
+
+static double chord2(double angle_rad)
+{
+    const double c = 2.0 * sin(0.5 * angle_rad);
+    return c * c;
+}
+
+
+static void unit_vector(double ra_rad, double dec_rad, double v[3])
+{
+    const double cos_dec = cos(dec_rad);
+    v[0] = cos_dec * cos(ra_rad);
+    v[1] = cos_dec * sin(ra_rad);
+    v[2] = sin(dec_rad);
+}
+
+
+static int append(oskar_Mem* mem, int num, int value, int* status)
+{
+    if ((size_t) num >= oskar_mem_length(mem))
+        oskar_mem_ensure(mem, 2 * (size_t) num + 64, status);
+    if (*status) return num;
+    oskar_mem_int(mem, status)[num] = value;
+    return num + 1;
+}
+
+
+static int compare_int(const void* a, const void* b)
+{
+    const int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+
+static void heap_push(Heap* h, double d2, int index)
+{
+    /* Max-heap on distance: replaces the top if the heap is full. */
+    int i;
+    if (h->size == h->capacity)
+    {
+        heap_sift_down(h, d2, index);
+        return;
+    }
+    for (i = h->size++; i > 0;)
+    {
+        const int parent = (i - 1) / 2;
+        if (h->dist2[parent] >= d2) break;
+        h->dist2[i] = h->dist2[parent];
+        h->index[i] = h->index[parent];
+        i = parent;
+    }
+    h->dist2[i] = d2;
+    h->index[i] = index;
+}
+
+
+static void heap_sift_down(Heap* h, double d2, int index)
+{
+    /* Puts the value at the top of the heap, and moves it down. */
+    int i = 0;
+    for (;;)
+    {
+        int child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && h->dist2[child + 1] > h->dist2[child])
+            child++;
+        if (h->dist2[child] <= d2) break;
+        h->dist2[i] = h->dist2[child];
+        h->index[i] = h->index[child];
+        i = child;
+    }
+    h->dist2[i] = d2;
+    h->index[i] = index;
+}
+
+
+static void search_nearest(const oskar_SkyIndex* idx, int node,
+        const double q[3], Heap* h)
+{
+    int i, j, order[12];
+    double d[12];
+    const Node* n = &idx->nodes[node];
+    if (h->size == h->capacity && min_dist2(n, q) > h->dist2[0]) return;
+    if (n->num_children == 0)
+    {
+        for (i = n->start; i < n->end; ++i)
+        {
+            const double d2 = dist2(&idx->xyz[3 * i], q);
+            if (h->size < h->capacity || d2 < h->dist2[0])
+                heap_push(h, d2, idx->index[i]);
+        }
+        return;
+    }
+
+    /* Visit the nearest children first. */
+    for (i = 0; i < n->num_children; ++i)
+    {
+        const double t = min_dist2(&idx->nodes[n->first_child + i], q);
+        for (j = i; j > 0 && d[j - 1] > t; --j)
+        {
+            d[j] = d[j - 1];
+            order[j] = order[j - 1];
+        }
+        d[j] = t;
+        order[j] = n->first_child + i;
+    }
+    for (i = 0; i < n->num_children; ++i)
+        search_nearest(idx, order[i], q, h);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "sky/oskar_sky.h"
+#include "sky/oskar_rebin_sky_cuda.h"
+#include "utility/oskar_device.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void rebin_cpu(const oskar_Sky* input, oskar_Sky* output,
+        int* status);
+
+void oskar_sky_rebin(const oskar_Sky* input, oskar_Sky* output, int* status)
+{
+    if (*status) return;
+    const int type = oskar_sky_precision(input);
+    const int location = oskar_sky_mem_location(input);
+    if (oskar_sky_precision(output) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (oskar_sky_mem_location(output) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (location == OSKAR_CPU)
+        rebin_cpu(input, output, status);
+    else if (location == OSKAR_GPU)
+    {
+#ifdef OSKAR_HAVE_CUDA
+        if (type != OSKAR_SINGLE)
+        {
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+        oskar_mem_clear_contents(oskar_sky_I(output), status);
+        if (*status) return;
+        oskar_rebin_sky_cuda_f(
+                oskar_sky_num_sources(input),
+                oskar_sky_num_sources(output),
+                oskar_mem_float_const(oskar_sky_ra_rad_const(input), status),
+                oskar_mem_float_const(oskar_sky_dec_rad_const(input), status),
+                oskar_mem_float_const(oskar_sky_I_const(input), status),
+                oskar_mem_float_const(oskar_sky_ra_rad_const(output), status),
+                oskar_mem_float_const(oskar_sky_dec_rad_const(output), status),
+                oskar_mem_float(oskar_sky_I(output), status));
+        oskar_device_check_error_cuda(status);
+#else
+        *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
+#endif
+    }
+    else
+        *status = OSKAR_ERR_BAD_LOCATION;
+}
+
+static void rebin_cpu(const oskar_Sky* input, oskar_Sky* output,
+        int* status)
+{
+    int i, t, num_threads = 1;
+    const int num_in = oskar_sky_num_sources(input);
+    const int num_out = oskar_sky_num_sources(output);
+    const int type = oskar_sky_precision(input);
+    oskar_mem_clear_contents(oskar_sky_I(output), status);
+    if (*status || num_in == 0 || num_out == 0) return;
+
+    /* Index the output source positions. */
+    oskar_SkyIndex* index = oskar_sky_index_create(num_out,
+            oskar_sky_ra_rad_const(output), oskar_sky_dec_rad_const(output),
+            status);
+    if (*status) return;
+
+    /* Allocate partial sums for each thread. */
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    double* sums = (double*) calloc((size_t) num_threads * num_out,
+            sizeof(double));
+    if (!sums)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_sky_index_free(index);
+        return;
+    }
+    const void* ra_in = oskar_mem_void_const(oskar_sky_ra_rad_const(input));
+    const void* dec_in = oskar_mem_void_const(oskar_sky_dec_rad_const(input));
+    const void* I_in = oskar_mem_void_const(oskar_sky_I_const(input));
+
+    /* Add the flux of each input source to its nearest output source.
+     * Each thread takes a contiguous block of input sources. */
+#pragma omp parallel num_threads(num_threads)
+    {
+        int j, thread_id = 0, threads = 1;
+#ifdef _OPENMP
+        thread_id = omp_get_thread_num();
+        threads = omp_get_num_threads();
+#endif
+        double* sum = &sums[(size_t) thread_id * num_out];
+        const int start = (int) (((long long) num_in * thread_id) / threads);
+        const int end = (int) (((long long) num_in * (thread_id + 1)) /
+                threads);
+        for (j = start; j < end; ++j)
+        {
+            double ra, dec, flux;
+            if (type == OSKAR_DOUBLE)
+            {
+                ra = ((const double*) ra_in)[j];
+                dec = ((const double*) dec_in)[j];
+                flux = ((const double*) I_in)[j];
+            }
+            else
+            {
+                ra = ((const float*) ra_in)[j];
+                dec = ((const float*) dec_in)[j];
+                flux = ((const float*) I_in)[j];
+            }
+            sum[oskar_sky_index_nearest(index, ra, dec, 0)] += flux;
+        }
+    }
+
+    /* Sum the partial results in thread order. */
+    for (t = 1; t < num_threads; ++t)
+    {
+        const double* sum = &sums[(size_t) t * num_out];
+        for (i = 0; i < num_out; ++i)
+            sums[i] += sum[i];
+    }
+    if (type == OSKAR_DOUBLE)
+        memcpy(oskar_mem_double(oskar_sky_I(output), status), sums,
+                num_out * sizeof(double));
+    else
+    {
+        float* I_out = oskar_mem_float(oskar_sky_I(output), status);
+        for (i = 0; i < num_out; ++i)
+            I_out[i] = (float) sums[i];
+    }
+    free(sums);
+    oskar_sky_index_free(index);
+}
+
+#ifdef __cplusplus
+}
+#endif
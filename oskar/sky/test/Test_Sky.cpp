@@ -30,13 +30,20 @@
 
 #include "telescope/oskar_telescope.h"
 #include "sky/oskar_sky.h"
+#include "convert/oskar_convert_galactic_to_fk5.h"
+#include "convert/oskar_convert_healpix_ring_to_theta_phi.h"
 #include "convert/oskar_convert_lon_lat_to_relative_directions.h"
+#include "convert/oskar_convert_relative_directions_to_lon_lat.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_device.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
 #include <cstdlib>
 #include "math/oskar_cmath.h"
+#include <vector>
 
 #ifdef OSKAR_HAVE_CUDA
 static int device_loc = OSKAR_GPU;
@@ -167,6 +174,47 @@ TEST(SkyModel, append)
 }
 
 
+TEST(SkyModel, append_in_place)
+{
+    int status = 0;
+
+    // Create a buffer with enough capacity, and empty it.
+    oskar_Sky* buffer = oskar_sky_create(OSKAR_SINGLE, OSKAR_CPU, 8, &status);
+    oskar_sky_set_num_sources(buffer, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const void* data = oskar_mem_void_const(oskar_sky_ra_rad_const(buffer));
+
+    // Create a sky model to append.
+    oskar_Sky* sky = oskar_sky_create(OSKAR_SINGLE, OSKAR_CPU, 3, &status);
+    for (int i = 0; i < 3; ++i)
+        oskar_sky_set_source(sky, i, i + 0.5, 0.0, 1.0, 0.0, 0.0, 0.0,
+                0.0, 0.0, 0.0, 0.0, 0.0, 0.0, &status);
+    oskar_sky_evaluate_relative_directions(sky, 0.1, 0.2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Append twice, and check the buffer was not reallocated.
+    oskar_sky_append(buffer, sky, &status);
+    oskar_sky_append(buffer, sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(6, oskar_sky_num_sources(buffer));
+    EXPECT_EQ(data, oskar_mem_void_const(oskar_sky_ra_rad_const(buffer)));
+    EXPECT_DOUBLE_EQ(0.1, oskar_sky_reference_ra_rad(buffer));
+    EXPECT_DOUBLE_EQ(0.2, oskar_sky_reference_dec_rad(buffer));
+    for (int i = 0; i < 6; ++i)
+        EXPECT_FLOAT_EQ((float)(i % 3) + 0.5f, oskar_mem_float(
+                oskar_sky_ra_rad(buffer), &status)[i]);
+
+    // Check the number of sources can't exceed the capacity.
+    oskar_sky_set_num_sources(buffer, 100, &status);
+    EXPECT_EQ((int)OSKAR_ERR_OUT_OF_RANGE, status);
+    status = 0;
+
+    // Free memory.
+    oskar_sky_free(buffer, &status);
+    oskar_sky_free(sky, &status);
+}
+
+
 TEST(SkyModel, compute_relative_lmn)
 {
     int status = 0;
@@ -1252,3 +1300,233 @@ TEST(SkyModel, read_write)
     remove(filename);
 }
 
+
+
+TEST(SkyModel, read_write_columns)
+{
+    int status = 0;
+    const int num_sources = 20000;
+    const char* filename = "test_sky_model_columns.osc";
+    oskar_Sky* sky = oskar_sky_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_sources, &status);
+
+    // Fill sky model with random sources. Other parameters are set from
+    // the position and flux, to check that columns stay in step.
+    srand(2);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        double ra = 2.0 * M_PI * rand() / (double)RAND_MAX;
+        double dec = asin(2.0 * rand() / (double)RAND_MAX - 1.0);
+        double I = 10.0 * rand() / (double)RAND_MAX;
+        oskar_sky_set_source(sky, i, ra, dec, I, 2.0 * I, ra, dec,
+                100e6 + I, -I, 3.0 * I, 1e-5 * I, 1e-6 * I, dec, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write it to a file, and read it back without filtering.
+    oskar_sky_write_columns(sky, filename, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Sky* sky2 = oskar_sky_read_columns(filename, OSKAR_SINGLE,
+            -DBL_MAX, DBL_MAX, 0.0, M_PI, 0.0, 0.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky2));
+    double sum_ref = 0.0, sum = 0.0;
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const float I = oskar_mem_float(oskar_sky_I(sky2), &status)[i];
+        EXPECT_FLOAT_EQ(2.0f * I,
+                oskar_mem_float(oskar_sky_Q(sky2), &status)[i]);
+        EXPECT_FLOAT_EQ(oskar_mem_float(oskar_sky_ra_rad(sky2), &status)[i],
+                oskar_mem_float(oskar_sky_U(sky2), &status)[i]);
+        EXPECT_FLOAT_EQ(oskar_mem_float(oskar_sky_dec_rad(sky2), &status)[i],
+                oskar_mem_float(oskar_sky_position_angle_rad(sky2),
+                        &status)[i]);
+        EXPECT_FLOAT_EQ(3.0f * I, oskar_mem_float(
+                oskar_sky_rotation_measure_rad(sky2), &status)[i]);
+        sum_ref += oskar_mem_double(oskar_sky_I(sky), &status)[i];
+        sum += I;
+    }
+    EXPECT_NEAR(sum_ref, sum, 1e-3);
+    oskar_sky_free(sky2, &status);
+
+    // Read it back with filters, and compare with the filter functions.
+    const double ra0 = 1.0, dec0 = -0.5, inner = 0.1, outer = 0.6;
+    sky2 = oskar_sky_read_columns(filename, OSKAR_DOUBLE,
+            2.0, 7.0, inner, outer, ra0, dec0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_sky_filter_by_flux(sky, 2.0, 7.0, &status);
+    oskar_sky_filter_by_radius(sky, inner, outer, ra0, dec0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(oskar_sky_num_sources(sky), oskar_sky_num_sources(sky2));
+    sum_ref = sum = 0.0;
+    for (int i = 0; i < oskar_sky_num_sources(sky); ++i)
+    {
+        sum_ref += oskar_mem_double(oskar_sky_I(sky), &status)[i];
+        sum += oskar_mem_double(oskar_sky_I(sky2), &status)[i];
+    }
+    EXPECT_NEAR(sum_ref, sum, 1e-9);
+
+    // Check that other files are rejected.
+    oskar_sky_write(sky, filename, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Sky* sky3 = oskar_sky_read_columns(filename, OSKAR_DOUBLE,
+            -DBL_MAX, DBL_MAX, 0.0, M_PI, 0.0, 0.0, &status);
+    EXPECT_EQ((int)OSKAR_ERR_BAD_SKY_FILE, status);
+    EXPECT_TRUE(sky3 == 0);
+    status = 0;
+
+    // Free memory.
+    remove(filename);
+    oskar_sky_free(sky, &status);
+    oskar_sky_free(sky2, &status);
+}
+
+TEST(SkyModel, from_healpix_ring)
+{
+    int status = 0;
+    const int nside = 64, num_pixels = 12 * nside * nside;
+    const int chunk_size = 3000;
+    const double freq_hz = 100e6, spix = -0.7;
+
+    // Create a map with some zero-valued pixels.
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_pixels, &status);
+    double* val = oskar_mem_double(data, &status);
+    for (int i = 0; i < num_pixels; ++i)
+        val[i] = (i % 7 == 0 || (i > 20000 && i < 23000)) ? 0.0 : 1.0 + i;
+
+    for (int galactic = 0; galactic < 2; ++galactic)
+    {
+        // Compute the expected source positions.
+        std::vector<double> ra, dec, flux;
+        for (int i = 0; i < num_pixels; ++i)
+        {
+            if (val[i] == 0.0) continue;
+            double lat = 0.0, lon = 0.0;
+            oskar_convert_healpix_ring_to_theta_phi_d(nside, i, &lat, &lon);
+            lat = M_PI / 2.0 - lat;
+            if (galactic)
+                oskar_convert_galactic_to_fk5_d(1, &lon, &lat, &lon, &lat);
+            ra.push_back(lon);
+            dec.push_back(lat);
+            flux.push_back(val[i]);
+        }
+        const int num_sources = (int) ra.size();
+
+        // Check the whole map.
+        oskar_Sky* sky = oskar_sky_from_healpix_ring(OSKAR_DOUBLE, data,
+                freq_hz, spix, nside, galactic, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+        const double* ra_ = oskar_mem_double_const(
+                oskar_sky_ra_rad_const(sky), &status);
+        const double* dec_ = oskar_mem_double_const(
+                oskar_sky_dec_rad_const(sky), &status);
+        const double* I_ = oskar_mem_double_const(
+                oskar_sky_I_const(sky), &status);
+        const double* ref_ = oskar_mem_double_const(
+                oskar_sky_reference_freq_hz_const(sky), &status);
+        const double* spix_ = oskar_mem_double_const(
+                oskar_sky_spectral_index_const(sky), &status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            EXPECT_DOUBLE_EQ(ra[i], ra_[i]);
+            EXPECT_DOUBLE_EQ(dec[i], dec_[i]);
+            EXPECT_DOUBLE_EQ(flux[i], I_[i]);
+            EXPECT_DOUBLE_EQ(freq_hz, ref_[i]);
+            EXPECT_DOUBLE_EQ(spix, spix_[i]);
+        }
+
+        // Stream the map into a set of chunks, one range at a time.
+        int num_chunks = 0;
+        oskar_Sky** chunks = 0;
+        for (int p = 0; p < num_pixels; p += chunk_size)
+        {
+            const int n = std::min(chunk_size, num_pixels - p);
+            oskar_Sky* t = oskar_sky_from_healpix_ring_range(OSKAR_SINGLE,
+                    data, freq_hz, spix, nside, galactic, p, n, &status);
+            EXPECT_LE(oskar_sky_num_sources(t), chunk_size);
+            oskar_sky_append_to_set(&num_chunks, &chunks, chunk_size,
+                    t, &status);
+            oskar_sky_free(t, &status);
+        }
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ((num_sources + chunk_size - 1) / chunk_size, num_chunks);
+        for (int c = 0, i = 0; c < num_chunks; ++c)
+        {
+            const int n = oskar_sky_num_sources(chunks[c]);
+            const float* ra_f = oskar_mem_float_const(
+                    oskar_sky_ra_rad_const(chunks[c]), &status);
+            const float* I_f = oskar_mem_float_const(
+                    oskar_sky_I_const(chunks[c]), &status);
+            for (int j = 0; j < n; ++j, ++i)
+            {
+                EXPECT_FLOAT_EQ((float) ra[i], ra_f[j]);
+                EXPECT_FLOAT_EQ((float) flux[i], I_f[j]);
+            }
+            oskar_sky_free(chunks[c], &status);
+        }
+        free(chunks);
+
+        // Check an invalid range is rejected.
+        oskar_Sky* t = oskar_sky_from_healpix_ring_range(OSKAR_DOUBLE, data,
+                freq_hz, spix, nside, galactic, num_pixels - 1, 2, &status);
+        EXPECT_EQ((int) OSKAR_ERR_OUT_OF_RANGE, status);
+        EXPECT_TRUE(t == 0);
+        status = 0;
+        oskar_sky_free(sky, &status);
+    }
+    oskar_mem_free(data, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(SkyModel, from_image)
+{
+    int status = 0;
+    const int size[] = {300, 200};
+    const double crval_deg[] = {30.0, -50.0}, crpix[] = {151.0, 101.0};
+    const double cellsize_deg = 0.01, freq_hz = 150e6;
+    const int num_pixels = size[0] * size[1];
+    oskar_Mem* image = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU,
+            num_pixels, &status);
+    float* img = oskar_mem_float(image, &status);
+    for (int i = 0; i < num_pixels; ++i)
+        img[i] = (i % 5 == 0) ? 0.0f : (float) (i % 100);
+    oskar_Sky* sky = oskar_sky_from_image(OSKAR_DOUBLE, image, size,
+            crval_deg, crpix, cellsize_deg, freq_hz, 0.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare with the expected source positions.
+    const double ra0 = crval_deg[0] * M_PI / 180.0;
+    const double dec0 = crval_deg[1] * M_PI / 180.0;
+    const double delta = sin(cellsize_deg * M_PI / 180.0);
+    const double* ra_ = oskar_mem_double_const(
+            oskar_sky_ra_rad_const(sky), &status);
+    const double* dec_ = oskar_mem_double_const(
+            oskar_sky_dec_rad_const(sky), &status);
+    const double* I_ = oskar_mem_double_const(
+            oskar_sky_I_const(sky), &status);
+    int s = 0;
+    for (int y = 0; y < size[1]; ++y)
+    {
+        for (int x = 0; x < size[0]; ++x)
+        {
+            const float v = img[y * size[0] + x];
+            if (v == 0.0f) continue;
+            const double l = -delta * (x + 1 - crpix[0]);
+            const double m = delta * (y + 1 - crpix[1]);
+            double ra = 0.0, dec = 0.0;
+            oskar_convert_relative_directions_to_lon_lat_2d_d(1, &l, &m, 0,
+                    ra0, cos(dec0), sin(dec0), &ra, &dec);
+            ASSERT_LT(s, oskar_sky_num_sources(sky));
+            EXPECT_DOUBLE_EQ(ra, ra_[s]);
+            EXPECT_DOUBLE_EQ(dec, dec_[s]);
+            EXPECT_DOUBLE_EQ((double) v, I_[s]);
+            ++s;
+        }
+    }
+    EXPECT_EQ(s, oskar_sky_num_sources(sky));
+    oskar_sky_free(sky, &status);
+    oskar_mem_free(image, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_angular_distance.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/station/oskar_station_work.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+static oskar_Sky* random_sky(int type, int num_sources, int* status)
+{
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, status);
+    oskar_mem_random_range(oskar_sky_ra_rad(sky), 0.0, 2.0 * M_PI, status);
+    oskar_mem_random_range(oskar_sky_dec_rad(sky),
+            -M_PI / 2.0, M_PI / 2.0, status);
+    oskar_mem_random_range(oskar_sky_I(sky), 1.0, 10.0, status);
+    return sky;
+}
+
+TEST(SkyIndex, query_radius)
+{
+    int status = 0;
+    const int num_sources = 20000;
+    oskar_Sky* sky = random_sky(OSKAR_DOUBLE, num_sources, &status);
+    const double* ra = oskar_mem_double_const(oskar_sky_ra_rad(sky), &status);
+    const double* dec = oskar_mem_double_const(oskar_sky_dec_rad(sky), &status);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+            &status);
+    oskar_Mem* found = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(num_sources, oskar_sky_index_num_points(index));
+    EXPECT_EQ(64, oskar_sky_index_nside(index));
+
+    // Compare annulus queries with the radius filter.
+    const double radii[][2] = {{0.0, 0.01}, {0.0, 0.3}, {0.1, 0.5},
+            {1.0, 3.0}, {0.0, 4.0}};
+    for (int r = 0; r < 5; ++r)
+    {
+        const double ra0 = 0.7 * r, dec0 = 0.3 * r - 0.6;
+        const int num_found = oskar_sky_index_query_radius(index, ra0, dec0,
+                radii[r][0], radii[r][1], found, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        std::vector<int> expected;
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const double d = oskar_angular_distance(ra[i], ra0, dec[i], dec0);
+            if (d >= radii[r][0] && d < radii[r][1]) expected.push_back(i);
+        }
+        ASSERT_EQ((int) expected.size(), num_found);
+        const int* f = oskar_mem_int_const(found, &status);
+        for (int i = 0; i < num_found; ++i)
+            EXPECT_EQ(expected[i], f[i]);
+
+        // Check the radius filter gives the same number of sources.
+        oskar_Sky* filtered = oskar_sky_create_copy(sky, OSKAR_CPU, &status);
+        oskar_sky_filter_by_radius(filtered, radii[r][0], radii[r][1],
+                ra0, dec0, &status);
+        EXPECT_EQ(num_found, oskar_sky_num_sources(filtered));
+        oskar_sky_free(filtered, &status);
+    }
+
+    // Clean up.
+    oskar_mem_free(found, &status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(SkyIndex, query_box)
+{
+    int status = 0;
+    const int num_sources = 20000;
+    oskar_Sky* sky = random_sky(OSKAR_SINGLE, num_sources, &status);
+    const float* ra = oskar_mem_float_const(oskar_sky_ra_rad(sky), &status);
+    const float* dec = oskar_mem_float_const(oskar_sky_dec_rad(sky), &status);
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+            &status);
+    oskar_Mem* found = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check boxes, including ones that wrap through zero and reach a pole.
+    const double boxes[][4] = {{0.1, 0.4, -0.2, 0.3}, {6.0, 0.5, 0.2, 0.9},
+            {1.0, 5.0, -1.0, -0.5}, {2.0, 3.0, 1.2, M_PI / 2.0}};
+    for (int b = 0; b < 4; ++b)
+    {
+        const int num_found = oskar_sky_index_query_box(index,
+                boxes[b][0], boxes[b][1], boxes[b][2], boxes[b][3],
+                found, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int* f = oskar_mem_int_const(found, &status);
+        int num_expected = 0;
+        for (int i = 0, j = 0; i < num_sources; ++i)
+        {
+            // Skip sources too close to an edge to classify reliably.
+            const double margin = 1e-6;
+            const bool wrap = boxes[b][0] > boxes[b][1];
+            const bool in_ra = wrap ?
+                    (ra[i] >= boxes[b][0] || ra[i] <= boxes[b][1]) :
+                    (ra[i] >= boxes[b][0] && ra[i] <= boxes[b][1]);
+            const bool in = in_ra &&
+                    dec[i] >= boxes[b][2] && dec[i] <= boxes[b][3];
+            const bool at_edge =
+                    fabs(ra[i] - boxes[b][0]) < margin ||
+                    fabs(ra[i] - boxes[b][1]) < margin ||
+                    fabs(dec[i] - boxes[b][2]) < margin ||
+                    fabs(dec[i] - boxes[b][3]) < margin;
+            if (at_edge)
+            {
+                if (j < num_found && f[j] == i) ++j;
+                continue;
+            }
+            if (in)
+            {
+                ++num_expected;
+                ASSERT_LT(j, num_found);
+                EXPECT_EQ(i, f[j++]);
+            }
+        }
+        EXPECT_GT(num_expected, 0);
+    }
+
+    // Clean up.
+    oskar_mem_free(found, &status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(SkyIndex, query_nearest)
+{
+    int status = 0;
+    const int num_random = 5000, num_clustered = 500;
+    const int num_sources = num_random + num_clustered;
+    oskar_Sky* sky = random_sky(OSKAR_DOUBLE, num_sources, &status);
+    double* ra = oskar_mem_double(oskar_sky_ra_rad(sky), &status);
+    double* dec = oskar_mem_double(oskar_sky_dec_rad(sky), &status);
+
+    // Add a cluster of coincident and very close sources.
+    for (int i = num_random; i < num_sources; ++i)
+    {
+        ra[i] = 1.0 + (i % 2 ? 0.0 : 1e-9 * i);
+        dec[i] = 0.5;
+    }
+    oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+            oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+            &status);
+    oskar_Mem* found = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, &status);
+    oskar_Mem* dist = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare with a brute-force search.
+    const double points[][2] = {{0.2, 0.1}, {3.0, -1.4}, {1.0, 0.5}};
+    const int k[] = {1, 10, 20};
+    for (int p = 0; p < 3; ++p)
+    {
+        std::vector<std::pair<double, int> > expected(num_sources);
+        for (int i = 0; i < num_sources; ++i)
+            expected[i] = std::make_pair(oskar_angular_distance(
+                    ra[i], points[p][0], dec[i], points[p][1]), i);
+        std::sort(expected.begin(), expected.end());
+        const int num_found = oskar_sky_index_query_nearest(index,
+                points[p][0], points[p][1], k[p], found, dist, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(k[p], num_found);
+        const int* f = oskar_mem_int_const(found, &status);
+        const double* d = oskar_mem_double_const(dist, &status);
+        for (int i = 0; i < num_found; ++i)
+        {
+            EXPECT_NEAR(expected[i].first, d[i], 1e-9);
+            EXPECT_NEAR(expected[i].first, oskar_angular_distance(
+                    ra[f[i]], points[p][0], dec[f[i]], points[p][1]), 1e-9);
+        }
+    }
+
+    // Check all clustered sources can be found.
+    EXPECT_EQ(num_clustered, oskar_sky_index_query_radius(index,
+            1.0, 0.5, 0.0, 1e-5, found, &status));
+
+    // Clean up.
+    oskar_mem_free(found, &status);
+    oskar_mem_free(dist, &status);
+    oskar_sky_index_free(index);
+    oskar_sky_free(sky, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(SkyIndex, horizon_clip)
+{
+    int status = 0;
+    const int num_sources = 50000, num_stations = 20;
+    const double deg2rad = M_PI / 180.0;
+    const int types[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    for (int t = 0; t < 2; ++t)
+    {
+        const int type = types[t];
+        oskar_Sky* sky = random_sky(type, num_sources, &status);
+        oskar_sky_evaluate_relative_directions(sky, 0.3, -0.7, &status);
+        oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU,
+                num_stations, &status);
+        for (int i = 0; i < num_stations; ++i)
+            oskar_station_set_position(oskar_telescope_station(tel, i),
+                    (116.0 + 3.0 * i) * deg2rad, (-27.0 + 4.0 * i) * deg2rad,
+                    0.0, 0.0, 0.0, 0.0);
+        oskar_StationWork* work = oskar_station_work_create(type,
+                OSKAR_CPU, &status);
+        oskar_SkyIndex* index = oskar_sky_index_create(num_sources,
+                oskar_sky_ra_rad_const(sky), oskar_sky_dec_rad_const(sky),
+                &status);
+        oskar_Sky* out1 = oskar_sky_create(type, OSKAR_CPU, 0, &status);
+        oskar_Sky* out2 = oskar_sky_create(type, OSKAR_CPU, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Check the indexed version gives exactly the same sources.
+        oskar_sky_horizon_clip(out1, sky, tel, 1.2, work, &status);
+        oskar_sky_horizon_clip_indexed(out2, sky, index, tel, 1.2, work,
+                &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_GT(oskar_sky_num_sources(out1), num_sources / 2);
+        EXPECT_LT(oskar_sky_num_sources(out1), num_sources);
+        ASSERT_EQ(oskar_sky_num_sources(out1), oskar_sky_num_sources(out2));
+        EXPECT_FALSE(oskar_mem_different(oskar_sky_ra_rad_const(out1),
+                oskar_sky_ra_rad_const(out2), 0, &status));
+        EXPECT_FALSE(oskar_mem_different(oskar_sky_l_const(out1),
+                oskar_sky_l_const(out2), 0, &status));
+
+        // Check an index of the wrong size is rejected.
+        oskar_sky_resize(sky, num_sources - 1, &status);
+        oskar_sky_horizon_clip_indexed(out2, sky, index, tel, 1.2, work,
+                &status);
+        EXPECT_EQ((int) OSKAR_ERR_DIMENSION_MISMATCH, status);
+        status = 0;
+
+        // Clean up.
+        oskar_sky_free(out1, &status);
+        oskar_sky_free(out2, &status);
+        oskar_sky_index_free(index);
+        oskar_station_work_free(work, &status);
+        oskar_telescope_free(tel, &status);
+        oskar_sky_free(sky, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+}
+
+TEST(SkyIndex, rebin)
+{
+    int status = 0;
+    const int num_in = 20000, num_out = 300;
+    const int types[] = {OSKAR_SINGLE, OSKAR_DOUBLE};
+    for (int t = 0; t < 2; ++t)
+    {
+        const int type = types[t];
+        oskar_Sky* in = random_sky(type, num_in, &status);
+        oskar_Sky* out = random_sky(type, num_out, &status);
+        oskar_sky_rebin(in, out, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Compare with a brute-force search in double precision.
+        oskar_Mem *ra_in = 0, *dec_in = 0, *I_in = 0, *ra_out = 0, *dec_out = 0;
+        ra_in = oskar_mem_convert_precision(oskar_sky_ra_rad_const(in),
+                OSKAR_DOUBLE, &status);
+        dec_in = oskar_mem_convert_precision(oskar_sky_dec_rad_const(in),
+                OSKAR_DOUBLE, &status);
+        I_in = oskar_mem_convert_precision(oskar_sky_I_const(in),
+                OSKAR_DOUBLE, &status);
+        ra_out = oskar_mem_convert_precision(oskar_sky_ra_rad_const(out),
+                OSKAR_DOUBLE, &status);
+        dec_out = oskar_mem_convert_precision(oskar_sky_dec_rad_const(out),
+                OSKAR_DOUBLE, &status);
+        const double* ra_i = oskar_mem_double_const(ra_in, &status);
+        const double* dec_i = oskar_mem_double_const(dec_in, &status);
+        const double* flux = oskar_mem_double_const(I_in, &status);
+        const double* ra_o = oskar_mem_double_const(ra_out, &status);
+        const double* dec_o = oskar_mem_double_const(dec_out, &status);
+        std::vector<double> expected(num_out, 0.0);
+        double total = 0.0;
+        for (int i = 0; i < num_in; ++i)
+        {
+            int nearest = 0;
+            double min_dist = 10.0;
+            for (int j = 0; j < num_out; ++j)
+            {
+                const double d = oskar_angular_distance(
+                        ra_i[i], ra_o[j], dec_i[i], dec_o[j]);
+                if (d < min_dist)
+                {
+                    min_dist = d;
+                    nearest = j;
+                }
+            }
+            expected[nearest] += flux[i];
+            total += flux[i];
+        }
+        oskar_Mem* I_out = oskar_mem_convert_precision(oskar_sky_I_const(out),
+                OSKAR_DOUBLE, &status);
+        const double* I = oskar_mem_double_const(I_out, &status);
+        const double tol = (type == OSKAR_DOUBLE) ? 1e-9 : 1e-2;
+        double sum = 0.0;
+        for (int j = 0; j < num_out; ++j)
+        {
+            EXPECT_NEAR(expected[j], I[j], tol);
+            sum += I[j];
+        }
+        EXPECT_NEAR(total, sum, tol * num_out);
+
+        // Check mismatched precision is rejected.
+        oskar_Sky* other = oskar_sky_create(
+                type == OSKAR_DOUBLE ? OSKAR_SINGLE : OSKAR_DOUBLE,
+                OSKAR_CPU, 1, &status);
+        oskar_sky_rebin(in, other, &status);
+        EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+        status = 0;
+
+        // Clean up.
+        oskar_mem_free(ra_in, &status);
+        oskar_mem_free(dec_in, &status);
+        oskar_mem_free(I_in, &status);
+        oskar_mem_free(ra_out, &status);
+        oskar_mem_free(dec_out, &status);
+        oskar_mem_free(I_out, &status);
+        oskar_sky_free(other, &status);
+        oskar_sky_free(in, &status);
+        oskar_sky_free(out, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+}
@@ -22,7 +22,7 @@
         GLOBAL_IN(FP, c), const int n, GLOBAL_IN(FP, x), GLOBAL_IN(FP, y),\
         const int stride_out, const int offset_out, GLOBAL_OUT(FP, z))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     int l, l1, l2, nk1, lx;\
     FP hh[3], wx[4], wy[4], t, x_ = x[i], y_ = y[i];\
     nk1 = nx - 4;\
@@ -51,7 +51,7 @@ OSKAR_REGISTER_KERNEL(NAME)
 #define OSKAR_SET_ZEROS_STRIDE(NAME, FP) KERNEL(NAME) (const int n,\
         const int stride_out, const int offset_out, GLOBAL_OUT(FP, out))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     out[i * stride_out + offset_out] = (FP)0;\
     KERNEL_LOOP_END\
 }\
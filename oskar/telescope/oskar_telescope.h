@@ -28,6 +28,26 @@ enum OSKAR_POL_MODE_TYPE
     OSKAR_POL_MODE_SCALAR
 };
 
+/* To maintain binary compatibility, do not change the values
+ * in the list below. */
+enum OSKAR_TELESCOPE_TAGS
+{
+    OSKAR_TELESCOPE_TAG_SNAPSHOT_KEY     = 1,
+    OSKAR_TELESCOPE_TAG_INTS             = 2,
+    OSKAR_TELESCOPE_TAG_DOUBLES          = 3,
+    OSKAR_TELESCOPE_TAG_STATION_COORDS   = 4,
+    OSKAR_TELESCOPE_TAG_STATION_INTS     = 5,
+    OSKAR_TELESCOPE_TAG_STATION_DOUBLES  = 6,
+    OSKAR_TELESCOPE_TAG_STATION_ARRAY    = 7,
+    OSKAR_TELESCOPE_TAG_ELEMENT_INTS     = 8,
+    OSKAR_TELESCOPE_TAG_ELEMENT_DOUBLES  = 9,
+    OSKAR_TELESCOPE_TAG_ELEMENT_FREQ_INTS = 10,
+    OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY    = 11,
+    OSKAR_TELESCOPE_TAG_SPLINE_INTS      = 12,
+    OSKAR_TELESCOPE_TAG_SPLINE_DOUBLES   = 13,
+    OSKAR_TELESCOPE_TAG_SPLINE_ARRAY     = 14
+};
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +69,7 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_override_element_cable_length_errors.h>
 #include <telescope/oskar_telescope_override_element_gains.h>
 #include <telescope/oskar_telescope_override_element_phases.h>
+#include <telescope/oskar_telescope_read_snapshot.h>
 #include <telescope/oskar_telescope_resize.h>
 #include <telescope/oskar_telescope_save.h>
 #include <telescope/oskar_telescope_save_layout.h>
@@ -57,5 +78,6 @@ enum OSKAR_POL_MODE_TYPE
 #include <telescope/oskar_telescope_set_station_coords_enu.h>
 #include <telescope/oskar_telescope_set_station_coords_wgs84.h>
 #include <telescope/oskar_telescope_uvw.h>
+#include <telescope/oskar_telescope_write_snapshot.h>
 
 #endif /* include guard */
@@ -365,6 +365,21 @@ int oskar_telescope_allow_station_beam_duplication(
 OSKAR_EXPORT
 int oskar_telescope_enable_numerical_patterns(const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the flag specifying whether a compiled model snapshot is used.
+ *
+ * @details
+ * Returns the flag specifying whether a compiled binary snapshot of the
+ * telescope model should be read (or written) when the model is loaded.
+ *
+ * @param[in] model   Pointer to telescope model.
+ *
+ * @return The boolean flag value.
+ */
+OSKAR_EXPORT
+int oskar_telescope_enable_snapshot(const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the flag specifying whether an ionospheric phase screen is enabled.
@@ -708,6 +723,24 @@ OSKAR_EXPORT
 void oskar_telescope_set_enable_numerical_patterns(oskar_Telescope* model,
         int value);
 
+/**
+ * @brief
+ * Sets the flag to specify whether a compiled model snapshot is used.
+ *
+ * @details
+ * Sets the flag to specify whether a compiled binary snapshot of the
+ * telescope model should be used by oskar_telescope_load().
+ *
+ * If enabled, the snapshot is read instead of the text files if it is
+ * still up to date, otherwise it is (re-)written after the model
+ * has been loaded.
+ *
+ * @param[in] model    Pointer to telescope model.
+ * @param[in] value    If true, the model snapshot will be enabled.
+ */
+OSKAR_EXPORT
+void oskar_telescope_set_enable_snapshot(oskar_Telescope* model, int value);
+
 /**
  * @brief
  * Sets the Gaussian station beam parameters.
@@ -57,6 +57,28 @@ OSKAR_EXPORT
 void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
         oskar_Log* log, int* status);
 
+/**
+ * @brief
+ * Loads a telescope model directory on the first process,
+ * and sends the model to all other processes.
+ *
+ * @details
+ * This is the same as oskar_telescope_load(), except that the directory
+ * is read only by the first MPI process. The model is then sent to all the
+ * others as a snapshot, using a temporary file on each node.
+ *
+ * This is a collective operation, so it must be called on all processes.
+ * If there is only one process, this is the same as oskar_telescope_load().
+ *
+ * @param[in,out] telescope  Pointer to telescope model to fill.
+ * @param[in]     path       Pathname of telescope model directory to load.
+ * @param[in,out] log        Pointer to log.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_load_mpi(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TELESCOPE_READ_SNAPSHOT_H_
+#define OSKAR_TELESCOPE_READ_SNAPSHOT_H_
+
+/**
+ * @file oskar_telescope_read_snapshot.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Reads a compiled binary snapshot of a telescope model.
+ *
+ * @details
+ * This function restores a telescope model previously written using
+ * oskar_telescope_write_snapshot().
+ *
+ * The snapshot is used only if the key string stored in the file matches
+ * the one supplied: if the file does not exist, or the keys do not match,
+ * the telescope model is left unchanged and the function returns false
+ * without setting an error code.
+ *
+ * The telescope model must be empty, and in CPU memory.
+ *
+ * @param[in,out] telescope  Pointer to telescope model to fill.
+ * @param[in] filename       Pathname of the snapshot file to read.
+ * @param[in] key            String identifying the source of the model.
+ * @param[in,out] status     Status return code.
+ *
+ * @return True if the snapshot was read, false if not.
+ */
+OSKAR_EXPORT
+int oskar_telescope_read_snapshot(oskar_Telescope* telescope,
+        const char* filename, const char* key, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
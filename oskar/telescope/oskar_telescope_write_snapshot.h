@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TELESCOPE_WRITE_SNAPSHOT_H_
+#define OSKAR_TELESCOPE_WRITE_SNAPSHOT_H_
+
+/**
+ * @file oskar_telescope_write_snapshot.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes a compiled binary snapshot of a telescope model.
+ *
+ * @details
+ * This function writes the complete contents of a loaded telescope model
+ * (including all nested stations, element data and fitted splines)
+ * to a single binary file, so that the model can later be restored using
+ * oskar_telescope_read_snapshot() without parsing the text files again.
+ *
+ * The supplied key string is stored in the file, and is used to check
+ * whether the snapshot is still valid when it is read back.
+ *
+ * Note that an HDF5 gain model is not stored in the snapshot.
+ *
+ * @param[in] telescope   Pointer to telescope model to write.
+ * @param[in] filename    Pathname of the snapshot file to write.
+ * @param[in] key         String identifying the source of the model.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_telescope_write_snapshot(const oskar_Telescope* telescope,
+        const char* filename, const char* key, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
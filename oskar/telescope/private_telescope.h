@@ -55,6 +55,7 @@ struct oskar_Telescope
     int identical_stations;                            /* True if all stations are identical. */
     int allow_station_beam_duplication;                /* True if station beam duplication is allowed. */
     int enable_numerical_patterns;                     /* True if numerical element patterns are enabled. */
+    int enable_snapshot;                               /* True if a compiled snapshot of the model should be used. */
 };
 
 #ifndef OSKAR_TELESCOPE_TYPEDEF_
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_TELESCOPE_SNAPSHOT_H_
+#define OSKAR_PRIVATE_TELESCOPE_SNAPSHOT_H_
+
+#include "telescope/station/private_station.h"
+
+#include <stddef.h>
+
+/*
+ * Layout of the records in a telescope model snapshot.
+ *
+ * Every record is written with a unique, incrementing user index,
+ * in depth-first order of the station tree, so that the file can be
+ * read back using a single forward pass.
+ */
+
+enum OSKAR_TELESCOPE_SNAPSHOT_SIZES
+{
+    SNAPSHOT_NUM_TELESCOPE_INTS = 8,
+    SNAPSHOT_NUM_TELESCOPE_DOUBLES = 5,
+    SNAPSHOT_NUM_STATION_ARRAYS = 36,
+    SNAPSHOT_NUM_STATION_INTS = 19 + SNAPSHOT_NUM_STATION_ARRAYS,
+    SNAPSHOT_NUM_STATION_DOUBLES = 12,
+    SNAPSHOT_NUM_ELEMENT_INTS = 11,
+    SNAPSHOT_NUM_ELEMENT_DOUBLES = 12,
+    SNAPSHOT_NUM_ELEMENT_FREQ_INTS = 3
+};
+
+/* Bit flags marking the per-frequency element data that is present. */
+enum OSKAR_TELESCOPE_SNAPSHOT_ELEMENT_FLAGS
+{
+    SNAPSHOT_HAS_SPLINES_X = 1,
+    SNAPSHOT_HAS_SPLINES_Y = 2,
+    SNAPSHOT_HAS_SPLINES_SCALAR = 4,
+    SNAPSHOT_HAS_SPH_WAVE = 8,
+    SNAPSHOT_HAS_FILENAME_X = 16,
+    SNAPSHOT_HAS_FILENAME_Y = 32,
+    SNAPSHOT_HAS_FILENAME_SCALAR = 64
+};
+
+/* Offsets of all the arrays in the station structure. */
+#define STATION_ARRAY(NAME) offsetof(struct oskar_Station, NAME)
+static const size_t oskar_telescope_snapshot_station_arrays[] = {
+        STATION_ARRAY(element_true_enu_metres[0][0]),
+        STATION_ARRAY(element_true_enu_metres[0][1]),
+        STATION_ARRAY(element_true_enu_metres[0][2]),
+        STATION_ARRAY(element_true_enu_metres[1][0]),
+        STATION_ARRAY(element_true_enu_metres[1][1]),
+        STATION_ARRAY(element_true_enu_metres[1][2]),
+        STATION_ARRAY(element_measured_enu_metres[0][0]),
+        STATION_ARRAY(element_measured_enu_metres[0][1]),
+        STATION_ARRAY(element_measured_enu_metres[0][2]),
+        STATION_ARRAY(element_measured_enu_metres[1][0]),
+        STATION_ARRAY(element_measured_enu_metres[1][1]),
+        STATION_ARRAY(element_measured_enu_metres[1][2]),
+        STATION_ARRAY(element_euler_cpu[0][0]),
+        STATION_ARRAY(element_euler_cpu[0][1]),
+        STATION_ARRAY(element_euler_cpu[0][2]),
+        STATION_ARRAY(element_euler_cpu[1][0]),
+        STATION_ARRAY(element_euler_cpu[1][1]),
+        STATION_ARRAY(element_euler_cpu[1][2]),
+        STATION_ARRAY(element_gain[0]),
+        STATION_ARRAY(element_gain[1]),
+        STATION_ARRAY(element_gain_error[0]),
+        STATION_ARRAY(element_gain_error[1]),
+        STATION_ARRAY(element_phase_offset_rad[0]),
+        STATION_ARRAY(element_phase_offset_rad[1]),
+        STATION_ARRAY(element_phase_error_rad[0]),
+        STATION_ARRAY(element_phase_error_rad[1]),
+        STATION_ARRAY(element_weight[0]),
+        STATION_ARRAY(element_weight[1]),
+        STATION_ARRAY(element_cable_length_error[0]),
+        STATION_ARRAY(element_cable_length_error[1]),
+        STATION_ARRAY(element_types_cpu),
+        STATION_ARRAY(element_mount_types_cpu),
+        STATION_ARRAY(permitted_beam_az_rad),
+        STATION_ARRAY(permitted_beam_el_rad),
+        STATION_ARRAY(noise_freq_hz),
+        STATION_ARRAY(noise_rms_jy)
+};
+#undef STATION_ARRAY
+
+#endif /* include guard */
@@ -144,6 +144,11 @@ int oskar_telescope_enable_numerical_patterns(const oskar_Telescope* model)
     return model->enable_numerical_patterns;
 }
 
+int oskar_telescope_enable_snapshot(const oskar_Telescope* model)
+{
+    return model->enable_snapshot;
+}
+
 int oskar_telescope_max_station_size(const oskar_Telescope* model)
 {
     return model->max_station_size;
@@ -272,6 +277,11 @@ void oskar_telescope_set_enable_numerical_patterns(oskar_Telescope* model,
     model->enable_numerical_patterns = value;
 }
 
+void oskar_telescope_set_enable_snapshot(oskar_Telescope* model, int value)
+{
+    model->enable_snapshot = value;
+}
+
 static void oskar_telescope_set_gaussian_station_beam_p(oskar_Station* station,
         double fwhm_rad, double ref_freq_hz)
 {
@@ -34,6 +34,7 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->identical_stations = src->identical_stations;
     telescope->allow_station_beam_duplication = src->allow_station_beam_duplication;
     telescope->enable_numerical_patterns = src->enable_numerical_patterns;
+    telescope->enable_snapshot = src->enable_snapshot;
     telescope->lon_rad = src->lon_rad;
     telescope->lat_rad = src->lat_rad;
     telescope->alt_metres = src->alt_metres;
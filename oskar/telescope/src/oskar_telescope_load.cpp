@@ -3,10 +3,12 @@
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
+#include "binary/oskar_crc.h"
 #include "telescope/oskar_telescope.h"
 #include "utility/oskar_dir.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_num_procs.h"
+#include "utility/oskar_mpi.h"
 #include "utility/oskar_thread.h"
 #include "telescope/private_TelescopeLoaderApodisation.h"
 #include "telescope/private_TelescopeLoaderCableLengthError.h"
@@ -21,7 +23,9 @@
 #include "telescope/private_TelescopeLoaderPermittedBeams.h"
 #include "telescope/private_TelescopeLoaderPosition.h"
 
+#include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <map>
 #include <string>
 #include <vector>
@@ -30,16 +34,101 @@ using std::map;
 using std::string;
 using std::vector;
 
+static const char* snapshot_file = ".oskar_telescope_snapshot.bin";
+static const char* gain_model_file = "gain_model.h5";
+
+static void load_local(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status);
 static void load_directories(oskar_Telescope* telescope,
         const string& cwd, oskar_Station* station, int depth,
         const vector<oskar_TelescopeLoadAbstract*>& loaders,
         map<string, string> filemap, oskar_Log* log, int* status);
+static string snapshot_key(const oskar_Telescope* telescope,
+        const char* path);
+static void snapshot_key_update(const oskar_CRC* crc_data,
+        unsigned long* crc, const string& root, const string& rel_dir,
+        int* num_files);
 
 extern "C"
 void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
         oskar_Log* log, int* status)
 {
-    // Check if safe to proceed.
+    load_local(telescope, path, log, status);
+}
+
+extern "C"
+void oskar_telescope_load_mpi(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status)
+{
+    char filename_root[512], filename[512];
+    int load_status = 0;
+    unsigned int id = 0;
+    if (*status) return;
+    if (oskar_mpi_size() == 1)
+    {
+        load_local(telescope, path, log, status);
+        return;
+    }
+    const int rank = oskar_mpi_rank();
+    const char* key = "mpi";
+    const char* dir = getenv("TMPDIR");
+    if (!dir) dir = getenv("TEMP");
+    if (!dir) dir = ".";
+    if (rank == 0)
+    {
+        load_local(telescope, path, log, &load_status);
+        id = (unsigned int) time(0) ^ (unsigned int) clock();
+    }
+
+    // Stop on all processes if the load failed.
+    oskar_mpi_bcast(&load_status, sizeof(int), 0, status);
+    oskar_mpi_bcast(&id, sizeof(unsigned int), 0, status);
+    if (*status) return;
+    if (load_status)
+    {
+        *status = load_status;
+        return;
+    }
+
+    // Write the snapshot on the first process, and copy it to the others.
+    snprintf(filename_root, sizeof(filename_root),
+            "%s%coskar_telescope_%08x_0.bin", dir, oskar_dir_separator(), id);
+    snprintf(filename, sizeof(filename),
+            "%s%coskar_telescope_%08x_%d.bin", dir, oskar_dir_separator(),
+            id, rank);
+    if (rank == 0)
+        oskar_telescope_write_snapshot(telescope, filename_root, key,
+                &load_status);
+    oskar_mpi_bcast(&load_status, sizeof(int), 0, status);
+    if (load_status && !*status) *status = load_status;
+    oskar_mpi_bcast_file(filename_root, filename, 0, status);
+
+    // Read the snapshot on the other processes.
+    if (rank != 0 && !*status)
+    {
+        if (!oskar_telescope_read_snapshot(telescope, filename, key, status)
+                && !*status)
+            *status = OSKAR_ERR_FILE_IO;
+        if (oskar_dir_file_exists(path, gain_model_file))
+        {
+            oskar_gains_open_hdf5(oskar_telescope_gains(telescope),
+                    oskar_TelescopeLoadAbstract::get_path(
+                            string(path), gain_model_file).c_str(),
+                    status);
+        }
+        oskar_telescope_set_station_ids(telescope);
+    }
+    remove(filename);
+    if (*status)
+        oskar_log_error(log, "Failed to distribute telescope model (%s).",
+                oskar_get_error_string(*status));
+}
+
+// Private functions.
+
+static void load_local(oskar_Telescope* telescope, const char* path,
+        oskar_Log* log, int* status)
+{
     if (*status) return;
 
     // Check that the telescope directory has been set and exists.
@@ -58,6 +147,37 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
         return;
     }
 
+    // Use the compiled snapshot of the model, if it is still up to date.
+    string key, snapshot_path;
+    if (oskar_telescope_enable_snapshot(telescope))
+    {
+        key = snapshot_key(telescope, path);
+        snapshot_path = oskar_TelescopeLoadAbstract::get_path(
+                string(path), snapshot_file);
+        if (oskar_telescope_read_snapshot(telescope,
+                snapshot_path.c_str(), key.c_str(), status))
+        {
+            oskar_log_message(log, 'M', 0,
+                    "Loaded telescope model snapshot '%s'",
+                    snapshot_path.c_str());
+            if (oskar_dir_file_exists(path, gain_model_file))
+            {
+                oskar_gains_open_hdf5(oskar_telescope_gains(telescope),
+                        oskar_TelescopeLoadAbstract::get_path(
+                                string(path), gain_model_file).c_str(),
+                        status);
+            }
+            oskar_telescope_set_station_ids(telescope);
+            return;
+        }
+        if (*status)
+        {
+            oskar_log_error(log, "Failed to read telescope model "
+                    "snapshot (%s).", oskar_get_error_string(*status));
+            return;
+        }
+    }
+
     // Create the loaders.
     vector<oskar_TelescopeLoadAbstract*> loaders;
     // The position loader must be first, because it defines the
@@ -94,9 +214,101 @@ void oskar_telescope_load(oskar_Telescope* telescope, const char* path,
 
     // (Re-)Set unique station IDs.
     oskar_telescope_set_station_ids(telescope);
+
+    // Write the snapshot for next time.
+    // Failure to write it (e.g. in a read-only directory) is not an error.
+    if (!*status && oskar_telescope_enable_snapshot(telescope))
+    {
+        int snapshot_status = 0;
+        oskar_telescope_write_snapshot(telescope, snapshot_path.c_str(),
+                key.c_str(), &snapshot_status);
+        if (snapshot_status)
+        {
+            remove(snapshot_path.c_str());
+            oskar_log_warning(log, "Could not write telescope model "
+                    "snapshot '%s'.", snapshot_path.c_str());
+        }
+    }
 }
 
-// Private functions.
+// Returns a string identifying the telescope model directory contents
+// and the settings that affect how the model is loaded.
+static string snapshot_key(const oskar_Telescope* telescope,
+        const char* path)
+{
+    char buffer[64];
+    int num_files = 0;
+    unsigned long crc = 0;
+    const int version = 2;
+    const int ints[] = {
+            version,
+            oskar_telescope_precision(telescope),
+            oskar_telescope_pol_mode(telescope),
+            oskar_telescope_enable_numerical_patterns(telescope),
+            oskar_telescope_allow_station_beam_duplication(telescope)
+    };
+    const double doubles[] = {
+            oskar_telescope_lon_rad(telescope),
+            oskar_telescope_lat_rad(telescope),
+            oskar_telescope_alt_metres(telescope)
+    };
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = oskar_crc_update(crc_data, crc, doubles, sizeof(doubles));
+    snapshot_key_update(crc_data, &crc, string(path), string(), &num_files);
+    oskar_crc_free(crc_data);
+    snprintf(buffer, sizeof(buffer), "%d-%d-%08lx", version, num_files, crc);
+    return string(buffer);
+}
+
+// Adds the name, size and contents of every file in the directory tree
+// to the CRC. Modification times are not used, as they may have a
+// resolution of only one second.
+static void snapshot_key_update(const oskar_CRC* crc_data,
+        unsigned long* crc, const string& root, const string& rel_dir,
+        int* num_files)
+{
+    int num_items = 0;
+    char** items = 0;
+    vector<char> buffer(65536);
+    const string dir = rel_dir.empty() ? root :
+            oskar_TelescopeLoadAbstract::get_path(root, rel_dir);
+    oskar_dir_items(dir.c_str(), NULL, 1, 1, &num_items, &items);
+    for (int i = 0; i < num_items; ++i)
+    {
+        const string rel_path = rel_dir.empty() ? string(items[i]) :
+                oskar_TelescopeLoadAbstract::get_path(rel_dir, items[i]);
+        const string abs_path = oskar_TelescopeLoadAbstract::get_path(
+                root, rel_path);
+        if (oskar_dir_exists(abs_path.c_str()))
+        {
+            snapshot_key_update(crc_data, crc, root, rel_path, num_files);
+        }
+        else if (rel_path != snapshot_file)
+        {
+            FILE* file = fopen(abs_path.c_str(), "rb");
+            if (file)
+            {
+                size_t num_read = 0;
+                unsigned long long size = 0;
+                *crc = oskar_crc_update(crc_data, *crc,
+                        rel_path.c_str(), 1 + rel_path.size());
+                while ((num_read = fread(&buffer[0], 1, buffer.size(),
+                        file)) > 0)
+                {
+                    *crc = oskar_crc_update(crc_data, *crc,
+                            &buffer[0], num_read);
+                    size += num_read;
+                }
+                *crc = oskar_crc_update(crc_data, *crc, &size, sizeof(size));
+                fclose(file);
+                (*num_files)++;
+            }
+        }
+        free(items[i]);
+    }
+    free(items);
+}
 
 struct ThreadArgs
 {
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "splines/private_splines.h"
+#include "telescope/private_telescope.h"
+#include "telescope/private_telescope_snapshot.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/station/element/private_element.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GROUP OSKAR_TAG_GROUP_TELESCOPE
+
+static void read_station(oskar_Binary* h, oskar_Station* s,
+        int* idx, int* status);
+static void read_element(oskar_Binary* h, oskar_Element* e,
+        int* idx, int* status);
+static oskar_Splines* read_splines(oskar_Binary* h, oskar_Splines* s,
+        int prec, int loc, int* idx, int* status);
+static void read_ints(oskar_Binary* h, int tag, int* values, int n,
+        int* idx, int* status);
+static void read_doubles(oskar_Binary* h, int tag, double* values, int n,
+        int* idx, int* status);
+static void read_mem(oskar_Binary* h, int tag, oskar_Mem* mem,
+        int* idx, int* status);
+static void seek(oskar_Binary* h, int type, int tag, int idx, int* status);
+
+int oskar_telescope_read_snapshot(oskar_Telescope* telescope,
+        const char* filename, const char* key, int* status)
+{
+    int i, idx = 0, ints[SNAPSHOT_NUM_TELESCOPE_INTS];
+    double doubles[SNAPSHOT_NUM_TELESCOPE_DOUBLES];
+    size_t key_len = 0;
+    char* stored_key = 0;
+    oskar_Binary* h = 0;
+    FILE* f = 0;
+    if (*status) return 0;
+
+    /* Return quietly if the file does not exist. */
+    f = fopen(filename, "rb");
+    if (!f) return 0;
+    fclose(f);
+
+    /* Open the file, and check the key matches. */
+    h = oskar_binary_create(filename, 'r', status);
+    oskar_binary_query(h, OSKAR_CHAR, GROUP,
+            OSKAR_TELESCOPE_TAG_SNAPSHOT_KEY, 0, &key_len, status);
+    if (*status || key_len != 1 + strlen(key))
+    {
+        /* Not a valid snapshot, or one for a different model. */
+        *status = 0;
+        oskar_binary_free(h);
+        return 0;
+    }
+    stored_key = (char*) calloc(key_len, 1);
+    oskar_binary_read(h, OSKAR_CHAR, GROUP,
+            OSKAR_TELESCOPE_TAG_SNAPSHOT_KEY, 0, key_len, stored_key, status);
+    if (*status || strcmp(key, stored_key))
+    {
+        *status = 0;
+        free(stored_key);
+        oskar_binary_free(h);
+        return 0;
+    }
+    free(stored_key);
+
+    /* Read telescope meta-data. */
+    read_ints(h, OSKAR_TELESCOPE_TAG_INTS,
+            ints, SNAPSHOT_NUM_TELESCOPE_INTS, &idx, status);
+    read_doubles(h, OSKAR_TELESCOPE_TAG_DOUBLES,
+            doubles, SNAPSHOT_NUM_TELESCOPE_DOUBLES, &idx, status);
+    if (*status)
+    {
+        oskar_binary_free(h);
+        return 0;
+    }
+    oskar_telescope_resize(telescope, ints[0], status);
+    telescope->supplied_coord_type = ints[1];
+    telescope->pol_mode = ints[2];
+    telescope->max_station_size = ints[3];
+    telescope->max_station_depth = ints[4];
+    telescope->identical_stations = ints[5];
+    telescope->allow_station_beam_duplication = ints[6];
+    telescope->enable_numerical_patterns = ints[7];
+    telescope->lon_rad = doubles[0];
+    telescope->lat_rad = doubles[1];
+    telescope->alt_metres = doubles[2];
+    telescope->pm_x_rad = doubles[3];
+    telescope->pm_y_rad = doubles[4];
+
+    /* Read station coordinates. */
+    for (i = 0; i < 3; ++i)
+    {
+        read_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_true_offset_ecef_metres[i], &idx, status);
+        read_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_true_enu_metres[i], &idx, status);
+        read_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_measured_offset_ecef_metres[i], &idx,
+                status);
+        read_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_measured_enu_metres[i], &idx, status);
+    }
+
+    /* Read all the stations. */
+    for (i = 0; i < telescope->num_stations; ++i)
+    {
+        read_station(h, telescope->station[i], &idx, status);
+    }
+    oskar_binary_free(h);
+    return *status ? 0 : 1;
+}
+
+static void read_station(oskar_Binary* h, oskar_Station* s,
+        int* idx, int* status)
+{
+    int i, ints[SNAPSHOT_NUM_STATION_INTS];
+    double doubles[SNAPSHOT_NUM_STATION_DOUBLES];
+    read_ints(h, OSKAR_TELESCOPE_TAG_STATION_INTS,
+            ints, SNAPSHOT_NUM_STATION_INTS, idx, status);
+    read_doubles(h, OSKAR_TELESCOPE_TAG_STATION_DOUBLES,
+            doubles, SNAPSHOT_NUM_STATION_DOUBLES, idx, status);
+    if (*status) return;
+
+    /* Set station meta-data. */
+    s->unique_id = ints[0];
+    s->station_type = ints[1];
+    s->normalise_final_beam = ints[2];
+    s->beam_coord_type = ints[3];
+    s->identical_children = ints[4];
+    s->num_elements = ints[5];
+    s->normalise_array_pattern = ints[7];
+    s->normalise_element_pattern = ints[8];
+    s->enable_array_pattern = ints[9];
+    s->common_element_orientation = ints[10];
+    s->common_pol_beams = ints[11];
+    s->swap_xy = ints[12];
+    s->array_is_3d = ints[13];
+    s->apply_element_errors = ints[14];
+    s->apply_element_weight = ints[15];
+    s->seed_time_variable_errors = (unsigned int) ints[16];
+    s->num_permitted_beams = ints[17];
+    s->offset_ecef[0] = doubles[0];
+    s->offset_ecef[1] = doubles[1];
+    s->offset_ecef[2] = doubles[2];
+    s->lon_rad = doubles[3];
+    s->lat_rad = doubles[4];
+    s->alt_metres = doubles[5];
+    s->pm_x_rad = doubles[6];
+    s->pm_y_rad = doubles[7];
+    s->beam_lon_rad = doubles[8];
+    s->beam_lat_rad = doubles[9];
+    s->gaussian_beam_fwhm_rad = doubles[10];
+    s->gaussian_beam_reference_freq_hz = doubles[11];
+
+    /* Read the arrays, creating any that do not yet exist. */
+    for (i = 0; i < SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+    {
+        const int type = ints[19 + i];
+        oskar_Mem** array = (oskar_Mem**) ((char*) s +
+                oskar_telescope_snapshot_station_arrays[i]);
+        if (!type) continue;
+        if (!*array) *array = oskar_mem_create(type, s->mem_location, 0, status);
+        read_mem(h, OSKAR_TELESCOPE_TAG_STATION_ARRAY, *array, idx, status);
+    }
+    oskar_mem_copy(s->element_types, s->element_types_cpu, status);
+
+    /* Read element models. */
+    if (ints[6] > 0)
+    {
+        oskar_station_resize_element_types(s, ints[6], status);
+        for (i = 0; i < ints[6] && !*status; ++i)
+        {
+            read_element(h, s->element[i], idx, status);
+        }
+    }
+
+    /* Recursively read child stations. */
+    if (ints[18] && s->num_elements > 0)
+    {
+        s->child = (oskar_Station**) calloc(
+                s->num_elements, sizeof(oskar_Station*));
+        if (!s->child)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
+        }
+        for (i = 0; i < s->num_elements && !*status; ++i)
+        {
+            s->child[i] = oskar_station_create(s->precision,
+                    s->mem_location, 0, status);
+            read_station(h, s->child[i], idx, status);
+        }
+    }
+}
+
+static void read_element(oskar_Binary* h, oskar_Element* e,
+        int* idx, int* status)
+{
+    int i, ints[SNAPSHOT_NUM_ELEMENT_INTS];
+    int freq_ints[SNAPSHOT_NUM_ELEMENT_FREQ_INTS];
+    double* doubles = 0;
+    read_ints(h, OSKAR_TELESCOPE_TAG_ELEMENT_INTS,
+            ints, SNAPSHOT_NUM_ELEMENT_INTS, idx, status);
+    if (*status) return;
+    const int num_freq = ints[10];
+    const int prec = e->precision;
+    const int loc = e->mem_location;
+    doubles = (double*) calloc(SNAPSHOT_NUM_ELEMENT_DOUBLES + num_freq,
+            sizeof(double));
+    if (!doubles)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    read_doubles(h, OSKAR_TELESCOPE_TAG_ELEMENT_DOUBLES,
+            doubles, SNAPSHOT_NUM_ELEMENT_DOUBLES + num_freq, idx, status);
+
+    /* Set element meta-data. */
+    e->x_element_type = ints[0];
+    e->y_element_type = ints[1];
+    e->x_taper_type = ints[2];
+    e->y_taper_type = ints[3];
+    e->x_dipole_length_units = ints[4];
+    e->y_dipole_length_units = ints[5];
+    e->element_type = ints[6];
+    e->taper_type = ints[7];
+    e->dipole_length_units = ints[8];
+    e->coord_sys = ints[9];
+    e->x_dipole_length = doubles[0];
+    e->y_dipole_length = doubles[1];
+    e->x_taper_cosine_power = doubles[2];
+    e->y_taper_cosine_power = doubles[3];
+    e->x_taper_gaussian_fwhm_rad = doubles[4];
+    e->y_taper_gaussian_fwhm_rad = doubles[5];
+    e->x_taper_ref_freq_hz = doubles[6];
+    e->y_taper_ref_freq_hz = doubles[7];
+    e->dipole_length = doubles[8];
+    e->cosine_power = doubles[9];
+    e->gaussian_fwhm_rad = doubles[10];
+    e->max_radius_rad = doubles[11];
+    oskar_element_resize_freq_data(e, num_freq, status);
+    for (i = 0; i < num_freq && !*status; ++i)
+    {
+        e->freqs_hz[i] = doubles[SNAPSHOT_NUM_ELEMENT_DOUBLES + i];
+    }
+    free(doubles);
+
+    /* Read per-frequency data. */
+    for (i = 0; i < num_freq && !*status; ++i)
+    {
+        read_ints(h, OSKAR_TELESCOPE_TAG_ELEMENT_FREQ_INTS,
+                freq_ints, SNAPSHOT_NUM_ELEMENT_FREQ_INTS, idx, status);
+        const int flags = freq_ints[0];
+        e->l_max[i] = freq_ints[1];
+        e->common_phi_coords[i] = freq_ints[2];
+        if (flags & SNAPSHOT_HAS_SPLINES_X)
+        {
+            e->x_h_re[i] = read_splines(h, e->x_h_re[i], prec, loc, idx, status);
+            e->x_h_im[i] = read_splines(h, e->x_h_im[i], prec, loc, idx, status);
+            e->x_v_re[i] = read_splines(h, e->x_v_re[i], prec, loc, idx, status);
+            e->x_v_im[i] = read_splines(h, e->x_v_im[i], prec, loc, idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPLINES_Y)
+        {
+            e->y_h_re[i] = read_splines(h, e->y_h_re[i], prec, loc, idx, status);
+            e->y_h_im[i] = read_splines(h, e->y_h_im[i], prec, loc, idx, status);
+            e->y_v_re[i] = read_splines(h, e->y_v_re[i], prec, loc, idx, status);
+            e->y_v_im[i] = read_splines(h, e->y_v_im[i], prec, loc, idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPLINES_SCALAR)
+        {
+            e->scalar_re[i] = read_splines(h, e->scalar_re[i],
+                    prec, loc, idx, status);
+            e->scalar_im[i] = read_splines(h, e->scalar_im[i],
+                    prec, loc, idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPH_WAVE)
+        {
+            if (!e->sph_wave[i])
+                e->sph_wave[i] = oskar_mem_create(
+                        prec | OSKAR_COMPLEX | OSKAR_MATRIX, loc, 0, status);
+            read_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->sph_wave[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_FILENAME_X)
+        {
+            if (!e->filename_x[i])
+                e->filename_x[i] = oskar_mem_create(
+                        OSKAR_CHAR, OSKAR_CPU, 0, status);
+            read_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_x[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_FILENAME_Y)
+        {
+            if (!e->filename_y[i])
+                e->filename_y[i] = oskar_mem_create(
+                        OSKAR_CHAR, OSKAR_CPU, 0, status);
+            read_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_y[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_FILENAME_SCALAR)
+        {
+            if (!e->filename_scalar[i])
+                e->filename_scalar[i] = oskar_mem_create(
+                        OSKAR_CHAR, OSKAR_CPU, 0, status);
+            read_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_scalar[i], idx, status);
+        }
+    }
+}
+
+static oskar_Splines* read_splines(oskar_Binary* h, oskar_Splines* s,
+        int prec, int loc, int* idx, int* status)
+{
+    int ints[2];
+    if (!s) s = oskar_splines_create(prec, loc, status);
+    read_ints(h, OSKAR_TELESCOPE_TAG_SPLINE_INTS, ints, 2, idx, status);
+    read_doubles(h, OSKAR_TELESCOPE_TAG_SPLINE_DOUBLES,
+            &s->smoothing_factor, 1, idx, status);
+    read_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY,
+            s->knots_x_theta, idx, status);
+    read_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY,
+            s->knots_y_phi, idx, status);
+    read_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY, s->coeff, idx, status);
+    if (*status) return s;
+    s->num_knots_x_theta = ints[0];
+    s->num_knots_y_phi = ints[1];
+    return s;
+}
+
+static void read_ints(oskar_Binary* h, int tag, int* values, int n,
+        int* idx, int* status)
+{
+    seek(h, OSKAR_INT, tag, *idx, status);
+    oskar_binary_read(h, OSKAR_INT, GROUP, (unsigned char) tag, (*idx)++,
+            n * sizeof(int), values, status);
+}
+
+static void read_doubles(oskar_Binary* h, int tag, double* values, int n,
+        int* idx, int* status)
+{
+    seek(h, OSKAR_DOUBLE, tag, *idx, status);
+    oskar_binary_read(h, OSKAR_DOUBLE, GROUP, (unsigned char) tag, (*idx)++,
+            n * sizeof(double), values, status);
+}
+
+static void read_mem(oskar_Binary* h, int tag, oskar_Mem* mem,
+        int* idx, int* status)
+{
+    seek(h, oskar_mem_type(mem), tag, *idx, status);
+    oskar_binary_read_mem(h, mem, GROUP, (unsigned char) tag, (*idx)++,
+            status);
+}
+
+/* Records are stored in order, so start each search at the previous one. */
+static void seek(oskar_Binary* h, int type, int tag, int idx, int* status)
+{
+    const int i = oskar_binary_query(h, (unsigned char) type, GROUP,
+            (unsigned char) tag, idx, 0, status);
+    if (!*status) oskar_binary_set_query_search_start(h, i, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
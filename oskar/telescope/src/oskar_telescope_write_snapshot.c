@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "splines/private_splines.h"
+#include "telescope/private_telescope.h"
+#include "telescope/private_telescope_snapshot.h"
+#include "telescope/oskar_telescope.h"
+#include "telescope/station/element/private_element.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GROUP OSKAR_TAG_GROUP_TELESCOPE
+
+static void write_station(oskar_Binary* h, const oskar_Station* s,
+        int* idx, int* status);
+static void write_element(oskar_Binary* h, const oskar_Element* e,
+        int* idx, int* status);
+static void write_splines(oskar_Binary* h, const oskar_Splines* s,
+        int* idx, int* status);
+static void write_ints(oskar_Binary* h, int tag, const int* values, int n,
+        int* idx, int* status);
+static void write_doubles(oskar_Binary* h, int tag, const double* values,
+        int n, int* idx, int* status);
+static void write_mem(oskar_Binary* h, int tag, const oskar_Mem* mem,
+        int* idx, int* status);
+
+void oskar_telescope_write_snapshot(const oskar_Telescope* telescope,
+        const char* filename, const char* key, int* status)
+{
+    int i, idx = 0, ints[SNAPSHOT_NUM_TELESCOPE_INTS];
+    double doubles[SNAPSHOT_NUM_TELESCOPE_DOUBLES];
+    oskar_Binary* h = 0;
+    if (*status) return;
+
+    /* Create the file. */
+    h = oskar_binary_create(filename, 'w', status);
+    if (*status)
+    {
+        oskar_binary_free(h);
+        return;
+    }
+
+    /* Write the key. */
+    oskar_binary_write(h, OSKAR_CHAR, GROUP, OSKAR_TELESCOPE_TAG_SNAPSHOT_KEY,
+            0, 1 + strlen(key), key, status);
+
+    /* Write telescope meta-data. */
+    ints[0] = telescope->num_stations;
+    ints[1] = telescope->supplied_coord_type;
+    ints[2] = telescope->pol_mode;
+    ints[3] = telescope->max_station_size;
+    ints[4] = telescope->max_station_depth;
+    ints[5] = telescope->identical_stations;
+    ints[6] = telescope->allow_station_beam_duplication;
+    ints[7] = telescope->enable_numerical_patterns;
+    doubles[0] = telescope->lon_rad;
+    doubles[1] = telescope->lat_rad;
+    doubles[2] = telescope->alt_metres;
+    doubles[3] = telescope->pm_x_rad;
+    doubles[4] = telescope->pm_y_rad;
+    write_ints(h, OSKAR_TELESCOPE_TAG_INTS,
+            ints, SNAPSHOT_NUM_TELESCOPE_INTS, &idx, status);
+    write_doubles(h, OSKAR_TELESCOPE_TAG_DOUBLES,
+            doubles, SNAPSHOT_NUM_TELESCOPE_DOUBLES, &idx, status);
+
+    /* Write station coordinates. */
+    for (i = 0; i < 3; ++i)
+    {
+        write_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_true_offset_ecef_metres[i], &idx, status);
+        write_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_true_enu_metres[i], &idx, status);
+        write_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_measured_offset_ecef_metres[i], &idx,
+                status);
+        write_mem(h, OSKAR_TELESCOPE_TAG_STATION_COORDS,
+                telescope->station_measured_enu_metres[i], &idx, status);
+    }
+
+    /* Write all the stations. */
+    for (i = 0; i < telescope->num_stations; ++i)
+    {
+        write_station(h, telescope->station[i], &idx, status);
+    }
+    oskar_binary_free(h);
+}
+
+static void write_station(oskar_Binary* h, const oskar_Station* s,
+        int* idx, int* status)
+{
+    int i, ints[SNAPSHOT_NUM_STATION_INTS];
+    double doubles[SNAPSHOT_NUM_STATION_DOUBLES];
+    const oskar_Mem* arrays[SNAPSHOT_NUM_STATION_ARRAYS];
+    if (*status) return;
+
+    /* Get handles to all the arrays. */
+    for (i = 0; i < SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+    {
+        arrays[i] = *(oskar_Mem* const*) ((const char*) s +
+                oskar_telescope_snapshot_station_arrays[i]);
+    }
+
+    /* Write station meta-data, including the types of all arrays. */
+    ints[0] = s->unique_id;
+    ints[1] = s->station_type;
+    ints[2] = s->normalise_final_beam;
+    ints[3] = s->beam_coord_type;
+    ints[4] = s->identical_children;
+    ints[5] = s->num_elements;
+    ints[6] = s->element ? s->num_element_types : 0;
+    ints[7] = s->normalise_array_pattern;
+    ints[8] = s->normalise_element_pattern;
+    ints[9] = s->enable_array_pattern;
+    ints[10] = s->common_element_orientation;
+    ints[11] = s->common_pol_beams;
+    ints[12] = s->swap_xy;
+    ints[13] = s->array_is_3d;
+    ints[14] = s->apply_element_errors;
+    ints[15] = s->apply_element_weight;
+    ints[16] = (int) s->seed_time_variable_errors;
+    ints[17] = s->num_permitted_beams;
+    ints[18] = s->child ? 1 : 0;
+    for (i = 0; i < SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+    {
+        ints[19 + i] = arrays[i] ? oskar_mem_type(arrays[i]) : 0;
+    }
+    doubles[0] = s->offset_ecef[0];
+    doubles[1] = s->offset_ecef[1];
+    doubles[2] = s->offset_ecef[2];
+    doubles[3] = s->lon_rad;
+    doubles[4] = s->lat_rad;
+    doubles[5] = s->alt_metres;
+    doubles[6] = s->pm_x_rad;
+    doubles[7] = s->pm_y_rad;
+    doubles[8] = s->beam_lon_rad;
+    doubles[9] = s->beam_lat_rad;
+    doubles[10] = s->gaussian_beam_fwhm_rad;
+    doubles[11] = s->gaussian_beam_reference_freq_hz;
+    write_ints(h, OSKAR_TELESCOPE_TAG_STATION_INTS,
+            ints, SNAPSHOT_NUM_STATION_INTS, idx, status);
+    write_doubles(h, OSKAR_TELESCOPE_TAG_STATION_DOUBLES,
+            doubles, SNAPSHOT_NUM_STATION_DOUBLES, idx, status);
+
+    /* Write the arrays that exist. */
+    for (i = 0; i < SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+    {
+        if (arrays[i])
+        {
+            write_mem(h, OSKAR_TELESCOPE_TAG_STATION_ARRAY,
+                    arrays[i], idx, status);
+        }
+    }
+
+    /* Write element models. */
+    if (s->element)
+    {
+        for (i = 0; i < s->num_element_types; ++i)
+        {
+            write_element(h, s->element[i], idx, status);
+        }
+    }
+
+    /* Recursively write child stations. */
+    if (s->child)
+    {
+        for (i = 0; i < s->num_elements; ++i)
+        {
+            write_station(h, s->child[i], idx, status);
+        }
+    }
+}
+
+static void write_element(oskar_Binary* h, const oskar_Element* e,
+        int* idx, int* status)
+{
+    int i, ints[SNAPSHOT_NUM_ELEMENT_INTS];
+    int freq_ints[SNAPSHOT_NUM_ELEMENT_FREQ_INTS];
+    double* doubles = 0;
+    if (*status) return;
+
+    /* Write element meta-data. */
+    ints[0] = e->x_element_type;
+    ints[1] = e->y_element_type;
+    ints[2] = e->x_taper_type;
+    ints[3] = e->y_taper_type;
+    ints[4] = e->x_dipole_length_units;
+    ints[5] = e->y_dipole_length_units;
+    ints[6] = e->element_type;
+    ints[7] = e->taper_type;
+    ints[8] = e->dipole_length_units;
+    ints[9] = e->coord_sys;
+    ints[10] = e->num_freq;
+    doubles = (double*) calloc(SNAPSHOT_NUM_ELEMENT_DOUBLES + e->num_freq,
+            sizeof(double));
+    if (!doubles)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    doubles[0] = e->x_dipole_length;
+    doubles[1] = e->y_dipole_length;
+    doubles[2] = e->x_taper_cosine_power;
+    doubles[3] = e->y_taper_cosine_power;
+    doubles[4] = e->x_taper_gaussian_fwhm_rad;
+    doubles[5] = e->y_taper_gaussian_fwhm_rad;
+    doubles[6] = e->x_taper_ref_freq_hz;
+    doubles[7] = e->y_taper_ref_freq_hz;
+    doubles[8] = e->dipole_length;
+    doubles[9] = e->cosine_power;
+    doubles[10] = e->gaussian_fwhm_rad;
+    doubles[11] = e->max_radius_rad;
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        doubles[SNAPSHOT_NUM_ELEMENT_DOUBLES + i] = e->freqs_hz[i];
+    }
+    write_ints(h, OSKAR_TELESCOPE_TAG_ELEMENT_INTS,
+            ints, SNAPSHOT_NUM_ELEMENT_INTS, idx, status);
+    write_doubles(h, OSKAR_TELESCOPE_TAG_ELEMENT_DOUBLES,
+            doubles, SNAPSHOT_NUM_ELEMENT_DOUBLES + e->num_freq, idx, status);
+    free(doubles);
+
+    /* Write per-frequency data. */
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        int flags = 0;
+        if (e->x_v_re[i]) flags |= SNAPSHOT_HAS_SPLINES_X;
+        if (e->y_v_re[i]) flags |= SNAPSHOT_HAS_SPLINES_Y;
+        if (e->scalar_re[i]) flags |= SNAPSHOT_HAS_SPLINES_SCALAR;
+        if (e->sph_wave[i]) flags |= SNAPSHOT_HAS_SPH_WAVE;
+        if (e->filename_x[i]) flags |= SNAPSHOT_HAS_FILENAME_X;
+        if (e->filename_y[i]) flags |= SNAPSHOT_HAS_FILENAME_Y;
+        if (e->filename_scalar[i]) flags |= SNAPSHOT_HAS_FILENAME_SCALAR;
+        freq_ints[0] = flags;
+        freq_ints[1] = e->l_max[i];
+        freq_ints[2] = e->common_phi_coords[i];
+        write_ints(h, OSKAR_TELESCOPE_TAG_ELEMENT_FREQ_INTS,
+                freq_ints, SNAPSHOT_NUM_ELEMENT_FREQ_INTS, idx, status);
+        if (flags & SNAPSHOT_HAS_SPLINES_X)
+        {
+            write_splines(h, e->x_h_re[i], idx, status);
+            write_splines(h, e->x_h_im[i], idx, status);
+            write_splines(h, e->x_v_re[i], idx, status);
+            write_splines(h, e->x_v_im[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPLINES_Y)
+        {
+            write_splines(h, e->y_h_re[i], idx, status);
+            write_splines(h, e->y_h_im[i], idx, status);
+            write_splines(h, e->y_v_re[i], idx, status);
+            write_splines(h, e->y_v_im[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPLINES_SCALAR)
+        {
+            write_splines(h, e->scalar_re[i], idx, status);
+            write_splines(h, e->scalar_im[i], idx, status);
+        }
+        if (flags & SNAPSHOT_HAS_SPH_WAVE)
+            write_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->sph_wave[i], idx, status);
+        if (flags & SNAPSHOT_HAS_FILENAME_X)
+            write_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_x[i], idx, status);
+        if (flags & SNAPSHOT_HAS_FILENAME_Y)
+            write_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_y[i], idx, status);
+        if (flags & SNAPSHOT_HAS_FILENAME_SCALAR)
+            write_mem(h, OSKAR_TELESCOPE_TAG_ELEMENT_ARRAY,
+                    e->filename_scalar[i], idx, status);
+    }
+}
+
+static void write_splines(oskar_Binary* h, const oskar_Splines* s,
+        int* idx, int* status)
+{
+    int ints[2];
+    if (*status) return;
+    ints[0] = s->num_knots_x_theta;
+    ints[1] = s->num_knots_y_phi;
+    write_ints(h, OSKAR_TELESCOPE_TAG_SPLINE_INTS, ints, 2, idx, status);
+    write_doubles(h, OSKAR_TELESCOPE_TAG_SPLINE_DOUBLES,
+            &s->smoothing_factor, 1, idx, status);
+    write_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY,
+            s->knots_x_theta, idx, status);
+    write_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY,
+            s->knots_y_phi, idx, status);
+    write_mem(h, OSKAR_TELESCOPE_TAG_SPLINE_ARRAY, s->coeff, idx, status);
+}
+
+static void write_ints(oskar_Binary* h, int tag, const int* values, int n,
+        int* idx, int* status)
+{
+    oskar_binary_write(h, OSKAR_INT, GROUP, (unsigned char) tag, (*idx)++,
+            n * sizeof(int), values, status);
+}
+
+static void write_doubles(oskar_Binary* h, int tag, const double* values,
+        int n, int* idx, int* status)
+{
+    oskar_binary_write(h, OSKAR_DOUBLE, GROUP, (unsigned char) tag, (*idx)++,
+            n * sizeof(double), values, status);
+}
+
+static void write_mem(oskar_Binary* h, int tag, const oskar_Mem* mem,
+        int* idx, int* status)
+{
+    oskar_binary_write_mem(h, mem, GROUP, (unsigned char) tag, (*idx)++,
+            0, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,7 +4,7 @@
 KERNEL(NAME) (const int offset_mask, const int n, GLOBAL_IN(FP, mask),\
         const int offset_out, GLOBAL_OUT(FP2, jones))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const int i_out = offset_out + i;\
     if (mask[i + offset_mask] < (FP)0)\
         MAKE_ZERO2(FP, jones[i_out]);\
@@ -21,7 +21,7 @@ KERNEL(NAME) (const int offset_mask, const int n, GLOBAL_IN(FP, mask),\
     MAKE_ZERO2(FP, zero.b);\
     MAKE_ZERO2(FP, zero.c);\
     MAKE_ZERO2(FP, zero.d);\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const int i_out = offset_out + i;\
     if (mask[i + offset_mask] < (FP)0) jones[i_out] = zero;\
     KERNEL_LOOP_END\
@@ -5,7 +5,7 @@
         GLOBAL_IN(FP, cable_length_error), const FP wavenumber,\
         const FP x1, const FP y1, const FP z1, GLOBAL_OUT(FP2, weights))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     FP re, im;\
     const FP p = wavenumber * (\
             x[i] * x1 + y[i] * y1 + z[i] * z1 + cable_length_error[i]);\
@@ -5,7 +5,7 @@ KERNEL(NAME) (const int n, GLOBAL_IN(FP, amp_gain),\
         GLOBAL_IN(FP, amp_error), GLOBAL_IN(FP, phase_offset),\
         GLOBAL_IN(FP, phase_error), GLOBAL_OUT(FP2, errors))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     FP re, im; FP2 r = errors[i];\
     r.x *= amp_error[i];   r.x += amp_gain[i];\
     r.y *= phase_error[i]; r.y += phase_offset[i];\
@@ -9,7 +9,7 @@ KERNEL(NAME) (const int num_points, GLOBAL_IN(FP, l), GLOBAL_IN(FP, m),\
 {\
     const int screen_half_x = screen_num_pixels_x / 2;\
     const int screen_half_y = screen_num_pixels_y / 2;\
-    KERNEL_LOOP_X(int, i, 0, num_points)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num_points)\
     FP2 comp;\
     const FP world_x = (station_u + l[i] * screen_height_m) * inv_pixel_size_m;\
     const FP world_y = (station_v + m[i] * screen_height_m) * inv_pixel_size_m;\
@@ -18,7 +18,7 @@
         const FP freq_qhz, const FP p1, const FP p2, const FP p3,\
         const FP cutoff_arcmin, GLOBAL_OUT(FP2, beam))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP val = (FP)0;\
     const FP ll = l[i], mm = m[i];\
     OSKAR_VLA_PBCOR(FP, ll, mm, val)\
@@ -32,7 +32,7 @@ OSKAR_REGISTER_KERNEL(NAME)
         const FP freq_qhz, const FP p1, const FP p2, const FP p3,\
         const FP cutoff_arcmin, GLOBAL_OUT(FP4c, beam))\
 {\
-    KERNEL_LOOP_X(int, i, 0, num)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, num)\
     FP val = (FP)0;\
     const FP ll = l[i], mm = m[i];\
     OSKAR_VLA_PBCOR(FP, ll, mm, val)\
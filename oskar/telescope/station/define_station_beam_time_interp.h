@@ -0,0 +1,13 @@
+/* Copyright (c) 2021, The OSKAR Developers. See LICENSE file. */
+
+/* Interpolates linearly between beams at two times, element by element. */
+#define OSKAR_STATION_BEAM_TIME_INTERP(NAME, FP) KERNEL(NAME) (\
+        const int n, const FP frac, GLOBAL_IN(FP, beam_a),\
+        GLOBAL_IN(FP, beam_b), const int offset_out, GLOBAL_OUT(FP, beam))\
+{\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
+    const FP a = beam_a[i];\
+    beam[i + offset_out] = a + frac * (beam_b[i] - a);\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
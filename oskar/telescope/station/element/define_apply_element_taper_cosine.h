@@ -4,7 +4,7 @@
 KERNEL(NAME) (const int n, const FP cos_power, GLOBAL_IN(FP, theta),\
         const int offset_out, GLOBAL_OUT(FP2, jones))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const FP theta_ = theta[i];\
     const FP cos_theta = (FP) cos(theta_);\
     const FP f = (FP) pow(cos_theta, cos_power);\
@@ -18,7 +18,7 @@ OSKAR_REGISTER_KERNEL(NAME)
 KERNEL(NAME) (const int n, const FP cos_power, GLOBAL_IN(FP, theta),\
         const int offset_out, GLOBAL_OUT(FP4c, jones))\
 {\
-    KERNEL_LOOP_X(int, i, 0, n)\
+    KERNEL_LOOP_PAR_SIMD_X(int, i, 0, n)\
     const FP theta_ = theta[i];\
     const FP cos_theta = (FP) cos(theta_);\
     const FP f = (FP) pow(cos_theta, cos_power);\
@@ -90,3 +90,111 @@ KERNEL(NAME) (\
     KERNEL_LOOP_END\
 }\
 OSKAR_REGISTER_KERNEL(NAME)
+
+/* Recurrence-based version of OSKAR_EVALUATE_SPHERICAL_WAVE_SUM.
+ *
+ * The terms are summed in columns of constant |m|. Normalised associated
+ * Legendre functions and their derivatives with respect to theta are
+ * generated along each column by the three-term recurrence in l, starting
+ * from the diagonal value (which is updated from one column to the next),
+ * and cos(m*phi) and sin(m*phi) are generated by the Chebyshev recurrence,
+ * so there are no per-term loops, factorials or calls to sin and cos.
+ * Using a recurrence for the derivative avoids the cancellation near the
+ * pole in the expression used by OSKAR_LEGENDRE2.
+ *
+ * The point-independent constants are held in separate arrays (see
+ * oskar_evaluate_spherical_wave_sum.c): coeff[0 .. l_max] holds the
+ * diagonal factors -sqrt((2m-1)/(2m)), followed by three arrays of length
+ * num_terms = (l_max+1)*(l_max+2)/2 indexed by term number in column
+ * order, which hold the recurrence factors a and b for the function of
+ * degree l+1, and the normalisation factors sqrt((2l+1)/(4*pi*l*(l+1))).
+ * alpha holds the coefficients for -|m|, then those for +|m|,
+ * in the same order. */
+#define OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_REC(NAME, FP, FP2, FP4c)\
+KERNEL(NAME) (\
+        const int num_points,\
+        GLOBAL_IN(FP, theta),\
+        GLOBAL_IN(FP, phi_x),\
+        GLOBAL_IN(FP, phi_y),\
+        const int l_max,\
+        GLOBAL_IN(FP, coeff),\
+        GLOBAL_IN(FP4c, alpha),\
+        const int offset,\
+        GLOBAL_OUT(FP4c, pattern))\
+{\
+    const int num_terms = ((l_max + 1) * (l_max + 2)) / 2;\
+    const FP *k_a = coeff + (l_max + 1), *k_b = k_a + num_terms;\
+    const FP *k_f = k_b + num_terms;\
+    KERNEL_LOOP_PAR_X(int, i, 0, num_points)\
+    FP2 Xp, Xt, Yp, Yt;\
+    FP theta_;\
+    MAKE_ZERO2(FP, Xp); MAKE_ZERO2(FP, Xt);\
+    MAKE_ZERO2(FP, Yp); MAKE_ZERO2(FP, Yt);\
+    theta_ = theta[i];\
+    /* Hack to avoid divide-by-zero (also in Matlab code!). */\
+    if (theta_ < (FP)1e-5) theta_ = (FP)1e-5;\
+    const FP phi_x_ = phi_x[i];\
+    const FP phi_y_ = phi_y[i];\
+    /* Propagate NAN. */\
+    if (phi_x_ != phi_x_) {\
+        Xp.x = Xp.y = Xt.x = Xt.y = phi_x_;\
+        Yp.x = Yp.y = Yt.x = Yt.y = phi_x_;\
+    }\
+    else {\
+        FP sin_t, cos_t, cos_x1, sin_x1, cos_y1, sin_y1;\
+        SINCOS(theta_, sin_t, cos_t);\
+        SINCOS(phi_x_, sin_x1, cos_x1);\
+        SINCOS(phi_y_, sin_y1, cos_y1);\
+        const FP inv_sin_t = (FP)1 / sin_t;\
+        /* Values for m and m - 1, starting from m = 0. */\
+        FP cos_x = (FP)1, sin_x = (FP)0, cos_x0 = cos_x1, sin_x0 = -sin_x1;\
+        FP cos_y = (FP)1, sin_y = (FP)0, cos_y0 = cos_y1, sin_y0 = -sin_y1;\
+        FP q_mm = (FP)1;\
+        int t = 0;\
+        for (int m = 0; m <= l_max; ++m) {\
+            if (m > 0) {\
+                FP tmp;\
+                q_mm *= coeff[m] * sin_t;\
+                tmp = 2 * cos_x1 * cos_x - cos_x0; cos_x0 = cos_x; cos_x = tmp;\
+                tmp = 2 * cos_x1 * sin_x - sin_x0; sin_x0 = sin_x; sin_x = tmp;\
+                tmp = 2 * cos_y1 * cos_y - cos_y0; cos_y0 = cos_y; cos_y = tmp;\
+                tmp = 2 * cos_y1 * sin_y - sin_y0; sin_y0 = sin_y; sin_y = tmp;\
+            }\
+            /* Function and derivative for degrees l and l - 1. */\
+            FP q = q_mm, g = m * cos_t * q_mm * inv_sin_t;\
+            FP q0 = (FP)0, g0 = (FP)0;\
+            for (int l = m; l <= l_max; ++l, ++t) {\
+                FP sin_p, cos_p;\
+                const FP pds = k_f[t] * q * inv_sin_t;\
+                const FP dpms = -k_f[t] * g;\
+                const FP q1 = k_a[t] * cos_t * q - k_b[t] * q0;\
+                const FP g1 = k_a[t] * (cos_t * g - sin_t * q) - k_b[t] * g0;\
+                const FP4c alpha_m = alpha[t];\
+                const FP4c alpha_p = alpha[num_terms + t];\
+                q0 = q; q = q1; g0 = g; g = g1;\
+                if (m == 0) {\
+                    sin_p = (FP)0; cos_p = (FP)1;\
+                    OSKAR_SPH_WAVE(FP2, 0, alpha_p.a, alpha_p.b, Xt, Xp)\
+                    OSKAR_SPH_WAVE(FP2, 0, alpha_p.c, alpha_p.d, Yt, Yp)\
+                }\
+                else {\
+                    cos_p = cos_x; sin_p = -sin_x;\
+                    OSKAR_SPH_WAVE(FP2, -m, alpha_m.a, alpha_m.b, Xt, Xp)\
+                    sin_p = sin_x;\
+                    OSKAR_SPH_WAVE(FP2,  m, alpha_p.a, alpha_p.b, Xt, Xp)\
+                    cos_p = cos_y; sin_p = -sin_y;\
+                    OSKAR_SPH_WAVE(FP2, -m, alpha_m.c, alpha_m.d, Yt, Yp)\
+                    sin_p = sin_y;\
+                    OSKAR_SPH_WAVE(FP2,  m, alpha_p.c, alpha_p.d, Yt, Yp)\
+                }\
+            }\
+        }\
+    }\
+    /* For some reason the theta/phi components must be reversed? */\
+    pattern[i + offset].a = Xp;\
+    pattern[i + offset].b = Xt;\
+    pattern[i + offset].c = Yp;\
+    pattern[i + offset].d = Yt;\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
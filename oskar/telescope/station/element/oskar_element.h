@@ -51,7 +51,8 @@ enum OSKAR_ELEMENT_TAGS
 {
     OSKAR_ELEMENT_TAG_SURFACE_TYPE = 1,
     OSKAR_ELEMENT_TAG_COORD_SYS = 2,
-    OSKAR_ELEMENT_TAG_MAX_RADIUS = 3
+    OSKAR_ELEMENT_TAG_MAX_RADIUS = 3,
+    OSKAR_ELEMENT_TAG_FIT_KEY = 4
 };
 
 enum OSKAR_ELEMENT_SURFACE_TYPE
@@ -48,6 +48,10 @@ extern "C" {
  * Evaluate the sum of spherical wave coefficients at the
  * given coordinates.
  *
+ * In CPU memory, the associated Legendre functions and the azimuthal
+ * terms are generated using recurrence relations, so the cost per point
+ * is proportional to l_max squared.
+ *
  * @param[in] num_points    Number of coordinate points.
  * @param[in] theta         Coordinate theta (polar) values, in radians.
  * @param[in] phi_x         Coordinate phi (azimuthal) values for X, in radians.
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_ELEMENT_FIT_SPLINES_H_
+#define OSKAR_PRIVATE_ELEMENT_FIT_SPLINES_H_
+
+#include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
+#include <splines/oskar_splines.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fits all surfaces concurrently, using one thread per surface. */
+void oskar_element_fit_splines(int num_surfaces, oskar_Splines** splines,
+        const char* const* names, int num_points, oskar_Mem* theta,
+        oskar_Mem* phi, oskar_Mem* const* data, oskar_Mem* weight,
+        double closeness, double closeness_inc, oskar_Log* log, int* status);
+
+/* Returns the key identifying a fit of the given file (free when done). */
+char* oskar_element_fit_splines_cache_key(const char* filename,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon, int* status);
+
+/* Returns the path of the cache file (free when done). */
+char* oskar_element_fit_splines_cache_path(const char* filename);
+
+/* Reads all the surfaces from the cache, if it exists and the key matches. */
+int oskar_element_fit_splines_cache_read(const char* cache_path,
+        const char* key, int num_surfaces, oskar_Splines** splines,
+        int* status);
+
+/* Writes all the surfaces to the cache, replacing it only when complete. */
+void oskar_element_fit_splines_cache_write(const char* cache_path,
+        const char* key, int num_surfaces, oskar_Splines* const* splines,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_PRIVATE_ELEMENT_FIT_SPLINES_H_ */
@@ -30,6 +30,7 @@
 #include "math/oskar_cmath.h"
 #include "telescope/station/element/private_element.h"
 #include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/private_element_fit_splines.h"
 #include "utility/oskar_getline.h"
 
 #include <stdio.h>
@@ -43,25 +44,20 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status);
+static void load_and_fit(const char* filename, double closeness,
+        double closeness_inc, int ignore_at_poles, int ignore_below_horizon,
+        oskar_Splines** splines, oskar_Log* log, int* status);
 
 void oskar_element_load_cst(oskar_Element* data,
         int port, double freq_hz, const char* filename,
         double closeness, double closeness_inc, int ignore_at_poles,
         int ignore_below_horizon, oskar_Log* log, int* status)
 {
-    int i, n = 0;
+    int i, j, n = 0;
     oskar_Splines **data_h_re = 0, **data_h_im = 0;
     oskar_Splines **data_v_re = 0, **data_v_im = 0;
-    oskar_Mem *theta, *phi, *h_re, *h_im, *v_re, *v_im, *weight;
-
-    /* Declare the line buffer. */
-    char *line = 0, *dbi = 0, *ludwig3 = 0;
-    size_t bufsize = 0;
-    FILE* file;
+    oskar_Splines **surfaces[4], *splines[4];
+    char *key = 0, *cache_path = 0;
 
     /* Check inputs. */
     if (*status) return;
@@ -113,6 +109,83 @@ void oskar_element_load_cst(oskar_Element* data,
         data_v_im = &data->y_v_im[i];
     }
 
+    /* Create the surfaces if they do not already exist. */
+    surfaces[0] = data_h_re;
+    surfaces[1] = data_h_im;
+    surfaces[2] = data_v_re;
+    surfaces[3] = data_v_im;
+    for (j = 0; j < 4; ++j)
+    {
+        if (!*surfaces[j])
+            *surfaces[j] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        splines[j] = *surfaces[j];
+    }
+
+    /* Use the cached surfaces if the file has been fitted before,
+     * otherwise fit the surfaces and cache them for next time. */
+    key = oskar_element_fit_splines_cache_key(filename,
+            closeness, closeness_inc, ignore_at_poles,
+            ignore_below_horizon, status);
+    cache_path = oskar_element_fit_splines_cache_path(filename);
+    if (!*status && oskar_element_fit_splines_cache_read(
+            cache_path, key, 4, splines, status))
+    {
+        oskar_log_message(log, 'M', 0, "Using fitted surfaces from '%s'",
+                cache_path);
+    }
+    else
+    {
+        load_and_fit(filename, closeness, closeness_inc, ignore_at_poles,
+                ignore_below_horizon, splines, log, status);
+        if (!*status)
+        {
+            /* A failed cache write is not an error. */
+            int cache_status = 0;
+            oskar_element_fit_splines_cache_write(cache_path, key, 4,
+                    splines, &cache_status);
+        }
+    }
+    free(cache_path);
+    free(key);
+
+    /* Copy X to Y if both ports are the same. */
+    if (port == 0)
+    {
+        if (!data->y_h_re[i])
+            data->y_h_re[i] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        if (!data->y_h_im[i])
+            data->y_h_im[i] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        if (!data->y_v_re[i])
+            data->y_v_re[i] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        if (!data->y_v_im[i])
+            data->y_v_im[i] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        oskar_splines_copy(data->y_h_re[i], data->x_h_re[i], status);
+        oskar_splines_copy(data->y_h_im[i], data->x_h_im[i], status);
+        oskar_splines_copy(data->y_v_re[i], data->x_v_re[i], status);
+        oskar_splines_copy(data->y_v_im[i], data->x_v_im[i], status);
+    }
+}
+
+
+static void load_and_fit(const char* filename, double closeness,
+        double closeness_inc, int ignore_at_poles, int ignore_below_horizon,
+        oskar_Splines** splines, oskar_Log* log, int* status)
+{
+    int n = 0;
+    oskar_Mem *theta, *phi, *h_re, *h_im, *v_re, *v_im, *weight;
+    const char* names[] = {"H [real]", "H [imag]", "V [real]", "V [imag]"};
+
+    /* Declare the line buffer. */
+    char *line = 0, *dbi = 0, *ludwig3 = 0;
+    size_t bufsize = 0;
+    FILE* file;
+    if (*status) return;
+
     /* Open the file. */
     file = fopen(filename, "r");
     if (!file)
@@ -247,34 +320,14 @@ void oskar_element_load_cst(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(data_h_re, n, theta, phi, h_re, weight,
-            closeness, closeness_inc, "H [real]", log, status);
-    fit_splines(data_h_im, n, theta, phi, h_im, weight,
-            closeness, closeness_inc, "H [imag]", log, status);
-    fit_splines(data_v_re, n, theta, phi, v_re, weight,
-            closeness, closeness_inc, "V [real]", log, status);
-    fit_splines(data_v_im, n, theta, phi, v_im, weight,
-            closeness, closeness_inc, "V [imag]", log, status);
-
-    /* Copy X to Y if both ports are the same. */
-    if (port == 0)
     {
-        if (!data->y_h_re[i])
-            data->y_h_re[i] = oskar_splines_create(
-                    OSKAR_DOUBLE, OSKAR_CPU, status);
-        if (!data->y_h_im[i])
-            data->y_h_im[i] = oskar_splines_create(
-                    OSKAR_DOUBLE, OSKAR_CPU, status);
-        if (!data->y_v_re[i])
-            data->y_v_re[i] = oskar_splines_create(
-                    OSKAR_DOUBLE, OSKAR_CPU, status);
-        if (!data->y_v_im[i])
-            data->y_v_im[i] = oskar_splines_create(
-                    OSKAR_DOUBLE, OSKAR_CPU, status);
-        oskar_splines_copy(data->y_h_re[i], data->x_h_re[i], status);
-        oskar_splines_copy(data->y_h_im[i], data->x_h_im[i], status);
-        oskar_splines_copy(data->y_v_re[i], data->x_v_re[i], status);
-        oskar_splines_copy(data->y_v_im[i], data->x_v_im[i], status);
+        oskar_Mem* surface_data[4];
+        surface_data[0] = h_re;
+        surface_data[1] = h_im;
+        surface_data[2] = v_re;
+        surface_data[3] = v_im;
+        oskar_element_fit_splines(4, splines, names, n, theta, phi,
+                surface_data, weight, closeness, closeness_inc, log, status);
     }
 
     /* Free local arrays. */
@@ -287,33 +340,6 @@ void oskar_element_load_cst(oskar_Element* data,
     oskar_mem_free(weight, status);
 }
 
-
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status)
-{
-    double avg_frac_error;
-    if (*status) return;
-    if (!*splines_ptr)
-        *splines_ptr = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
-    oskar_Splines* splines = *splines_ptr;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_line(log, 'M', ' ');
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
-}
-
 #ifdef __cplusplus
 }
 #endif
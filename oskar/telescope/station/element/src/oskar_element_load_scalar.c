@@ -30,6 +30,7 @@
 #include "math/oskar_cmath.h"
 #include "telescope/station/element/private_element.h"
 #include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/private_element_fit_splines.h"
 #include "utility/oskar_getline.h"
 #include "utility/oskar_string_to_array.h"
 
@@ -44,10 +45,9 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status);
+static void load_and_fit(const char* filename, double closeness,
+        double closeness_inc, int ignore_at_poles, int ignore_below_horizon,
+        oskar_Splines** splines, oskar_Log* log, int* status);
 
 void oskar_element_load_scalar(oskar_Element* data,
         double freq_hz, const char* filename,
@@ -55,13 +55,8 @@ void oskar_element_load_scalar(oskar_Element* data,
         int ignore_below_horizon, oskar_Log* log, int* status)
 {
     int i, n = 0, type = OSKAR_DOUBLE;
-    oskar_Splines *scalar_re = 0, *scalar_im = 0;
-    oskar_Mem *theta = 0, *phi = 0, *re = 0, *im = 0, *weight = 0;
-
-    /* Declare the line buffer. */
-    char *line = NULL;
-    size_t bufsize = 0;
-    FILE* file;
+    oskar_Splines* splines[2];
+    char *key = 0, *cache_path = 0;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -96,9 +91,63 @@ void oskar_element_load_scalar(oskar_Element* data,
         data->freqs_hz[i] = freq_hz;
     }
 
-    /* Get pointers to surface data based on frequency index. */
-    scalar_re = data->scalar_re[i];
-    scalar_im = data->scalar_im[i];
+    /* Create the surfaces if they do not already exist. */
+    if (!data->scalar_re[i])
+        data->scalar_re[i] = oskar_splines_create(type, OSKAR_CPU, status);
+    if (!data->scalar_im[i])
+        data->scalar_im[i] = oskar_splines_create(type, OSKAR_CPU, status);
+    splines[0] = data->scalar_re[i];
+    splines[1] = data->scalar_im[i];
+
+    /* Use the cached surfaces if the file has been fitted before,
+     * otherwise fit the surfaces and cache them for next time. */
+    key = oskar_element_fit_splines_cache_key(filename,
+            closeness, closeness_inc, ignore_at_poles,
+            ignore_below_horizon, status);
+    cache_path = oskar_element_fit_splines_cache_path(filename);
+    if (!*status && oskar_element_fit_splines_cache_read(
+            cache_path, key, 2, splines, status))
+    {
+        oskar_log_message(log, 'M', 0, "Using fitted surfaces from '%s'",
+                cache_path);
+    }
+    else
+    {
+        load_and_fit(filename, closeness, closeness_inc, ignore_at_poles,
+                ignore_below_horizon, splines, log, status);
+        if (!*status)
+        {
+            /* A failed cache write is not an error. */
+            int cache_status = 0;
+            oskar_element_fit_splines_cache_write(cache_path, key, 2,
+                    splines, &cache_status);
+        }
+    }
+    free(cache_path);
+    free(key);
+
+    /* Store the filename. */
+    if (!data->filename_scalar[i])
+        data->filename_scalar[i] = oskar_mem_create(
+                OSKAR_CHAR, OSKAR_CPU, 0, status);
+    oskar_mem_append_raw(data->filename_scalar[i], filename, OSKAR_CHAR,
+                OSKAR_CPU, 1 + strlen(filename), status);
+}
+
+
+static void load_and_fit(const char* filename, double closeness,
+        double closeness_inc, int ignore_at_poles, int ignore_below_horizon,
+        oskar_Splines** splines, oskar_Log* log, int* status)
+{
+    int n = 0, type = OSKAR_DOUBLE;
+    oskar_Mem *theta = 0, *phi = 0, *re = 0, *im = 0, *weight = 0;
+    const char* names[] = {"Scalar [real]", "Scalar [imag]"};
+
+    /* Declare the line buffer. */
+    char *line = NULL;
+    size_t bufsize = 0;
+    FILE* file;
+    if (*status) return;
 
     /* Open the file. */
     file = fopen(filename, "r");
@@ -177,14 +226,14 @@ void oskar_element_load_scalar(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(scalar_re, n, theta, phi, re, weight,
-            closeness, closeness_inc, "Scalar [real]", log, status);
-    fit_splines(scalar_im, n, theta, phi, im, weight,
-            closeness, closeness_inc, "Scalar [imag]", log, status);
+    {
+        oskar_Mem* surface_data[2];
+        surface_data[0] = re;
+        surface_data[1] = im;
+        oskar_element_fit_splines(2, splines, names, n, theta, phi,
+                surface_data, weight, closeness, closeness_inc, log, status);
+    }
 
-    /* Store the filename. */
-    oskar_mem_append_raw(data->filename_scalar[i], filename, OSKAR_CHAR,
-                OSKAR_CPU, 1 + strlen(filename), status);
 
     /* Free local arrays. */
     oskar_mem_free(theta, status);
@@ -194,29 +243,6 @@ void oskar_element_load_scalar(oskar_Element* data,
     oskar_mem_free(weight, status);
 }
 
-
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status)
-{
-    double avg_frac_error;
-    if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_message(log, 'M', 0, "");
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
-}
-
 #ifdef __cplusplus
 }
 #endif
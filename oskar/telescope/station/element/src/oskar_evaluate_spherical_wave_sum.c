@@ -29,8 +29,8 @@
 #include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
 #include "telescope/station/element/define_evaluate_spherical_wave.h"
 #include "log/oskar_log.h"
-#include "math/define_legendre_polynomial.h"
 #include "math/define_multiply.h"
+#include "math/oskar_cmath.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
 
@@ -38,8 +38,48 @@
 extern "C" {
 #endif
 
-OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(evaluate_spherical_wave_sum_float, float, float2, float4c)
-OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(evaluate_spherical_wave_sum_double, double, double2, double4c)
+OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_REC(evaluate_spherical_wave_sum_rec_float, float, float2, float4c)
+OSKAR_EVALUATE_SPHERICAL_WAVE_SUM_REC(evaluate_spherical_wave_sum_rec_double, double, double2, double4c)
+
+#define SET_UP_TABLES(FP, FP4c) {\
+        FP* k = (FP*) oskar_mem_void(coeff);\
+        FP4c* alpha_out = (FP4c*) oskar_mem_void(alpha_sorted);\
+        const FP4c* alpha_in = (const FP4c*) oskar_mem_void_const(alpha);\
+        FP *k_a = k + (l_max + 1), *k_b = k_a + num_terms;\
+        FP *k_f = k_b + num_terms;\
+        for (m = 0, t = 0; m <= l_max; ++m) {\
+            k[m] = (FP) (m > 0 ? -sqrt((2.0 * m - 1.0) / (2.0 * m)) : 1.0);\
+            for (l = m; l <= l_max; ++l, ++t) {\
+                const double n2 = (l + 1.0) * (l + 1.0) - (double) m * m;\
+                const int ind0 = l * l - 1 + l;\
+                k_a[t] = (FP) ((2.0 * l + 1.0) / sqrt(n2));\
+                k_b[t] = (FP) sqrt(((double) l * l - (double) m * m) / n2);\
+                k_f[t] = (FP) (l > 0 ?\
+                        sqrt((2.0 * l + 1.0) / (4.0 * M_PI * l * (l + 1.0))) :\
+                        0.0);\
+                if (l > 0 && m > 0) alpha_out[t] = alpha_in[ind0 - m];\
+                if (l > 0) alpha_out[num_terms + t] = alpha_in[ind0 + m];\
+            }\
+        }\
+    }
+
+/* Sets up the point-independent tables used by the recurrence-based
+ * evaluator, in the order described in define_evaluate_spherical_wave.h. */
+static void set_up_tables(int l_max, const oskar_Mem* alpha,
+        oskar_Mem* coeff, oskar_Mem* alpha_sorted, int* status)
+{
+    int l, m, t;
+    const int num_terms = ((l_max + 1) * (l_max + 2)) / 2;
+    if (*status) return;
+    oskar_mem_realloc(coeff, (l_max + 1) + 3 * num_terms, status);
+    oskar_mem_realloc(alpha_sorted, 2 * num_terms, status);
+    oskar_mem_clear_contents(alpha_sorted, status);
+    if (*status) return;
+    if (oskar_mem_precision(alpha) == OSKAR_DOUBLE)
+        SET_UP_TABLES(double, double4c)
+    else
+        SET_UP_TABLES(float, float4c)
+}
 
 void oskar_evaluate_spherical_wave_sum(int num_points, const oskar_Mem* theta,
         const oskar_Mem* phi_x, const oskar_Mem* phi_y, int l_max,
@@ -55,34 +95,50 @@ void oskar_evaluate_spherical_wave_sum(int num_points, const oskar_Mem* theta,
     }
     if (location == OSKAR_CPU)
     {
-        switch (oskar_mem_type(pattern))
+        const int type = oskar_mem_type(pattern);
+        if (type == OSKAR_SINGLE_COMPLEX || type == OSKAR_DOUBLE_COMPLEX)
         {
-        case OSKAR_SINGLE_COMPLEX_MATRIX:
-            evaluate_spherical_wave_sum_float(num_points,
-                    oskar_mem_float_const(theta, status),
-                    oskar_mem_float_const(phi_x, status),
-                    oskar_mem_float_const(phi_y, status), l_max,
-                    oskar_mem_float4c_const(alpha, status), offset,
-                    oskar_mem_float4c(pattern, status));
-            break;
-        case OSKAR_DOUBLE_COMPLEX_MATRIX:
-            evaluate_spherical_wave_sum_double(num_points,
-                    oskar_mem_double_const(theta, status),
-                    oskar_mem_double_const(phi_x, status),
-                    oskar_mem_double_const(phi_y, status), l_max,
-                    oskar_mem_double4c_const(alpha, status), offset,
-                    oskar_mem_double4c(pattern, status));
-            break;
-        case OSKAR_SINGLE_COMPLEX:
-        case OSKAR_DOUBLE_COMPLEX:
             oskar_log_error(0, "Spherical wave patterns cannot be used "
                     "in scalar mode");
             *status = OSKAR_ERR_BAD_DATA_TYPE;
-            break;
-        default:
+            return;
+        }
+        if (type != OSKAR_SINGLE_COMPLEX_MATRIX &&
+                type != OSKAR_DOUBLE_COMPLEX_MATRIX)
+        {
             *status = OSKAR_ERR_BAD_DATA_TYPE;
-            break;
+            return;
+        }
+        if (oskar_mem_type(alpha) != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        const int prec = oskar_mem_precision(pattern);
+        oskar_Mem* coeff = oskar_mem_create(prec, OSKAR_CPU, 0, status);
+        oskar_Mem* alpha_sorted = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        set_up_tables(l_max, alpha, coeff, alpha_sorted, status);
+        if (!*status)
+        {
+            if (prec == OSKAR_SINGLE)
+                evaluate_spherical_wave_sum_rec_float(num_points,
+                        oskar_mem_float_const(theta, status),
+                        oskar_mem_float_const(phi_x, status),
+                        oskar_mem_float_const(phi_y, status), l_max,
+                        oskar_mem_float_const(coeff, status),
+                        oskar_mem_float4c_const(alpha_sorted, status), offset,
+                        oskar_mem_float4c(pattern, status));
+            else
+                evaluate_spherical_wave_sum_rec_double(num_points,
+                        oskar_mem_double_const(theta, status),
+                        oskar_mem_double_const(phi_x, status),
+                        oskar_mem_double_const(phi_y, status), l_max,
+                        oskar_mem_double_const(coeff, status),
+                        oskar_mem_double4c_const(alpha_sorted, status), offset,
+                        oskar_mem_double4c(pattern, status));
         }
+        oskar_mem_free(coeff, status);
+        oskar_mem_free(alpha_sorted, status);
     }
     else
     {
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/oskar_crc.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "splines/private_splines.h"
+#include "telescope/station/element/oskar_element.h"
+#include "telescope/station/element/private_element_fit_splines.h"
+#include "utility/oskar_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Increment this if the fitting procedure changes. */
+#define FIT_VERSION 1
+
+struct FitArgs
+{
+    oskar_Splines* splines;
+    int num_points, status;
+    double *theta, *phi, avg_frac_error, closeness_inc;
+    const double *data, *weight;
+};
+typedef struct FitArgs FitArgs;
+
+static void* fit_surface(void* arg)
+{
+    FitArgs* a = (FitArgs*) arg;
+    oskar_splines_fit(a->splines, a->num_points, a->theta, a->phi,
+            a->data, a->weight, OSKAR_SPLINES_SPHERICAL, 1,
+            &a->avg_frac_error, a->closeness_inc, 1, 1e-14, &a->status);
+    return 0;
+}
+
+void oskar_element_fit_splines(int num_surfaces, oskar_Splines** splines,
+        const char* const* names, int num_points, oskar_Mem* theta,
+        oskar_Mem* phi, oskar_Mem* const* data, oskar_Mem* weight,
+        double closeness, double closeness_inc, oskar_Log* log, int* status)
+{
+    int i;
+    FitArgs* args = 0;
+    oskar_Thread** threads = 0;
+    if (*status) return;
+
+    /* The surfaces are independent, so fit them all at the same time.
+     * This is safe because oskar_splines_fit() allocates its own workspace
+     * on each call, and the Dierckx routines it uses keep no static state:
+     * they work only in that workspace and in the output spline, which is
+     * different for each surface. The shared inputs are only read. */
+    args = (FitArgs*) calloc(num_surfaces, sizeof(FitArgs));
+    threads = (oskar_Thread**) calloc(num_surfaces, sizeof(oskar_Thread*));
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        args[i].splines = splines[i];
+        args[i].num_points = num_points;
+        args[i].theta = oskar_mem_double(theta, status);
+        args[i].phi = oskar_mem_double(phi, status);
+        args[i].data = oskar_mem_double_const(data[i], status);
+        args[i].weight = oskar_mem_double_const(weight, status);
+        args[i].avg_frac_error = closeness; /* Copy the fitting parameter. */
+        args[i].closeness_inc = closeness_inc;
+    }
+    if (!*status)
+    {
+        for (i = 0; i < num_surfaces; ++i)
+        {
+            threads[i] = oskar_thread_create(fit_surface, &args[i], 0);
+        }
+        for (i = 0; i < num_surfaces; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+    }
+
+    /* Report results in order. */
+    for (i = 0; i < num_surfaces && !*status; ++i)
+    {
+        oskar_log_line(log, 'M', ' ');
+        oskar_log_message(log, 'M', 0, "Fitting surface %s...", names[i]);
+        if (args[i].status)
+        {
+            *status = args[i].status;
+            break;
+        }
+        oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
+                "frac. error (s=%.2e).", args[i].avg_frac_error,
+                oskar_splines_smoothing_factor(splines[i]));
+        oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = "
+                "(%d, %d).", oskar_splines_num_knots_x_theta(splines[i]),
+                oskar_splines_num_knots_y_phi(splines[i]));
+    }
+    free(args);
+    free(threads);
+}
+
+char* oskar_element_fit_splines_cache_key(const char* filename,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon, int* status)
+{
+    char *buffer = 0, *key = 0;
+    size_t num_read = 0, total = 0;
+    unsigned long crc = 0;
+    const int ints[] = {FIT_VERSION, ignore_at_poles, ignore_below_horizon};
+    const double doubles[] = {closeness, closeness_inc};
+    FILE* file = 0;
+    if (*status) return 0;
+
+    /* Read the whole file in blocks to compute its checksum. */
+    file = fopen(filename, "rb");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return 0;
+    }
+    buffer = (char*) malloc(65536);
+    if (!buffer)
+    {
+        fclose(file);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = oskar_crc_update(crc_data, crc, doubles, sizeof(doubles));
+    while ((num_read = fread(buffer, 1, 65536, file)) > 0)
+    {
+        crc = oskar_crc_update(crc_data, crc, buffer, num_read);
+        total += num_read;
+    }
+    oskar_crc_free(crc_data);
+    free(buffer);
+    fclose(file);
+
+    /* Include the file size, to make the key more robust. */
+    key = (char*) calloc(64, sizeof(char));
+    if (key) sprintf(key, "%lu-%08lx", (unsigned long) total, crc);
+    return key;
+}
+
+char* oskar_element_fit_splines_cache_path(const char* filename)
+{
+    const char* suffix = ".fit.bin";
+    char* path = (char*) calloc(1 + strlen(filename) + strlen(suffix), 1);
+    if (path) sprintf(path, "%s%s", filename, suffix);
+    return path;
+}
+
+int oskar_element_fit_splines_cache_read(const char* cache_path,
+        const char* key, int num_surfaces, oskar_Splines** splines,
+        int* status)
+{
+    int i;
+    size_t key_len = 0;
+    char* stored_key = 0;
+    oskar_Binary* h = 0;
+    FILE* f = 0;
+    const unsigned char group = (unsigned char) OSKAR_TAG_GROUP_SPLINE_DATA;
+    if (*status) return 0;
+
+    /* Return quietly if the cache does not exist. */
+    f = fopen(cache_path, "rb");
+    if (!f) return 0;
+    fclose(f);
+
+    /* Check the key. */
+    int read_status = 0;
+    h = oskar_binary_create(cache_path, 'r', &read_status);
+    oskar_binary_query(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+            OSKAR_ELEMENT_TAG_FIT_KEY, 0, &key_len, &read_status);
+    if (!read_status && key_len == 1 + strlen(key))
+    {
+        stored_key = (char*) calloc(key_len, 1);
+        oskar_binary_read(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+                OSKAR_ELEMENT_TAG_FIT_KEY, 0, key_len, stored_key,
+                &read_status);
+    }
+    if (read_status || !stored_key || strcmp(stored_key, key))
+    {
+        free(stored_key);
+        oskar_binary_free(h);
+        return 0;
+    }
+    free(stored_key);
+
+    /* Read the surfaces. */
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        oskar_Splines* s = splines[i];
+        oskar_binary_read_int(h, group, OSKAR_SPLINES_TAG_NUM_KNOTS_X_THETA,
+                i, &s->num_knots_x_theta, &read_status);
+        oskar_binary_read_int(h, group, OSKAR_SPLINES_TAG_NUM_KNOTS_Y_PHI,
+                i, &s->num_knots_y_phi, &read_status);
+        oskar_binary_read_mem(h, s->knots_x_theta,
+                group, OSKAR_SPLINES_TAG_KNOTS_X_THETA, i, &read_status);
+        oskar_binary_read_mem(h, s->knots_y_phi,
+                group, OSKAR_SPLINES_TAG_KNOTS_Y_PHI, i, &read_status);
+        oskar_binary_read_mem(h, s->coeff,
+                group, OSKAR_SPLINES_TAG_COEFF, i, &read_status);
+        oskar_binary_read_double(h, group, OSKAR_SPLINES_TAG_SMOOTHING_FACTOR,
+                i, &s->smoothing_factor, &read_status);
+    }
+    oskar_binary_free(h);
+    return read_status ? 0 : 1;
+}
+
+void oskar_element_fit_splines_cache_write(const char* cache_path,
+        const char* key, int num_surfaces, oskar_Splines* const* splines,
+        int* status)
+{
+    int i;
+    char* temp_path = 0;
+    oskar_Binary* h = 0;
+    const unsigned char group = (unsigned char) OSKAR_TAG_GROUP_SPLINE_DATA;
+    if (*status) return;
+
+    /* Write to a temporary file unique to this process, and rename it
+     * only when complete, so that a reader never sees a partial cache
+     * even if another process is writing the same one. */
+    temp_path = (char*) calloc(32 + strlen(cache_path), 1);
+    if (!temp_path)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+#ifdef OSKAR_OS_WIN
+    sprintf(temp_path, "%s.tmp.%lu", cache_path,
+            (unsigned long) GetCurrentProcessId());
+#else
+    sprintf(temp_path, "%s.tmp.%lu", cache_path, (unsigned long) getpid());
+#endif
+    h = oskar_binary_create(temp_path, 'w', status);
+    oskar_binary_write(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+            OSKAR_ELEMENT_TAG_FIT_KEY, 0, 1 + strlen(key), key, status);
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        const oskar_Splines* s = splines[i];
+        oskar_binary_write_int(h, group, OSKAR_SPLINES_TAG_NUM_KNOTS_X_THETA,
+                i, s->num_knots_x_theta, status);
+        oskar_binary_write_int(h, group, OSKAR_SPLINES_TAG_NUM_KNOTS_Y_PHI,
+                i, s->num_knots_y_phi, status);
+        oskar_binary_write_mem(h, s->knots_x_theta,
+                group, OSKAR_SPLINES_TAG_KNOTS_X_THETA, i, 0, status);
+        oskar_binary_write_mem(h, s->knots_y_phi,
+                group, OSKAR_SPLINES_TAG_KNOTS_Y_PHI, i, 0, status);
+        oskar_binary_write_mem(h, s->coeff,
+                group, OSKAR_SPLINES_TAG_COEFF, i, 0, status);
+        oskar_binary_write_double(h, group, OSKAR_SPLINES_TAG_SMOOTHING_FACTOR,
+                i, s->smoothing_factor, status);
+    }
+    oskar_binary_free(h);
+#ifdef OSKAR_OS_WIN
+    if (!*status && !MoveFileExA(temp_path, cache_path,
+            MOVEFILE_REPLACE_EXISTING))
+        *status = OSKAR_ERR_FILE_IO;
+#else
+    if (!*status && rename(temp_path, cache_path))
+        *status = OSKAR_ERR_FILE_IO;
+#endif
+    if (*status) remove(temp_path);
+    free(temp_path);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -40,6 +40,8 @@ enum OSKAR_STATION_TYPE
 #include <telescope/station/oskar_station_analyse.h>
 #include <telescope/station/oskar_station_beam.h>
 #include <telescope/station/oskar_station_beam_horizon_direction.h>
+#include <telescope/station/oskar_station_beam_time_interp.h>
+#include <telescope/station/oskar_station_checksum.h>
 #include <telescope/station/oskar_station_create_child_stations.h>
 #include <telescope/station/oskar_station_create_copy.h>
 #include <telescope/station/oskar_station_create.h>
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_STATION_BEAM_TIME_INTERP_H_
+#define OSKAR_STATION_BEAM_TIME_INTERP_H_
+
+/**
+ * @file oskar_station_beam_time_interp.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluate the beam for a station, interpolating in time if enabled.
+ *
+ * @details
+ * This is a replacement for oskar_station_beam() which, if enabled using
+ * oskar_station_work_set_beam_time_interp(), evaluates the beam exactly
+ * only on a coarse grid of time indices, and interpolates each complex
+ * element linearly in time between the two enclosing grid points.
+ * The beams at the grid points are cached in the workspace in slot
+ * \p cache_index, so each station using the workspace should use a
+ * different slot. Beams are cached separately for each frequency.
+ * If a new cache entry is needed at a time between grid points,
+ * the beam is evaluated directly, and the grid points are evaluated
+ * only when the entry is used again.
+ *
+ * Only aperture array stations are interpolated. Other station types,
+ * and all stations if an ionospheric screen is used, are evaluated
+ * directly.
+ *
+ * To measure the accuracy of the interpolation, the beam in slot 0 is
+ * also evaluated exactly at the middle of each interval, and compared
+ * with the interpolated values. The exact beam is returned in this case.
+ *
+ * @param[in] station           Station model.
+ * @param[in] cache_index       Index of the cache slot for this station.
+ * @param[in] work              Station beam workspace.
+ * @param[in] source_coord_type Type of input/source coordinates
+ *                              (OSKAR_COORD_TYPE enumerator).
+ * @param[in] num_points        Number of points at which to evaluate beam.
+ * @param[in] source_coords     Source coordinate values.
+ * @param[in] ref_lon_rad       Reference longitude in radians,
+ *                              if inputs are direction cosines.
+ * @param[in] ref_lat_rad       Reference latitude in radians,
+ *                              if inputs are direction cosines.
+ * @param[in] norm_coord_type   Type of normalisation coordinates.
+ * @param[in] norm_lon_rad      Longitude for beam normalisation, in radians.
+ * @param[in] norm_lat_rad      Latitude for beam normalisation, in radians.
+ * @param[in] time_index        Simulation time index.
+ * @param[in] gast_rad          Greenwich Apparent Sidereal Time, in radians.
+ * @param[in] frequency_hz      The observing frequency in Hz.
+ * @param[in] offset_out        Output array element offset.
+ * @param[out] beam             Output beam data.
+ * @param[in,out] status        Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_beam_time_interp(
+        const oskar_Station* station,
+        int cache_index,
+        oskar_StationWork* work,
+        int source_coord_type,
+        int num_points,
+        const oskar_Mem* const source_coords[3],
+        double ref_lon_rad,
+        double ref_lat_rad,
+        int norm_coord_type,
+        double norm_lon_rad,
+        double norm_lat_rad,
+        int time_index,
+        double gast_rad,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* beam,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_STATION_CHECKSUM_H_
+#define OSKAR_STATION_CHECKSUM_H_
+
+/**
+ * @file oskar_station_checksum.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Updates a checksum with the contents of a station model.
+ *
+ * @details
+ * Updates a CRC-32C checksum with everything that affects the beam of
+ * the station: its meta-data, the element layout, weights and errors,
+ * the element models (including any fitted or numerical pattern data),
+ * and all child stations.
+ *
+ * The unique ID of the station is not included, so identical stations
+ * have the same checksum.
+ *
+ * @param[in] station      Pointer to station model.
+ * @param[in] crc          Initial value of the checksum (0 to start).
+ * @param[in,out]  status  Status return code.
+ *
+ * @return The updated checksum.
+ */
+OSKAR_EXPORT
+unsigned long oskar_station_checksum(const oskar_Station* station,
+        unsigned long crc, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_STATION_CHECKSUM_H_ */
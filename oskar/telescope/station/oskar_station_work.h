@@ -68,6 +68,107 @@ OSKAR_EXPORT
 oskar_Mem* oskar_station_work_lmn_direction(oskar_StationWork* work, int dim,
         int num_points, int* status);
 
+/**
+ * @brief Enables caching of source ENU directions.
+ *
+ * @details
+ * If enabled, the source ENU directions computed by oskar_station_beam()
+ * are kept, and reused by later calls for stations whose local sidereal time
+ * and latitude both agree to within \p tolerance_rad. Up to \p max_groups sets of directions are
+ * kept, each the size of the source list.
+ *
+ * Cached directions are discarded when the time index, the number of
+ * sources, or the source coordinate arrays or their reference point change,
+ * and each time this function is called. The caller must call it again if
+ * the values in the source coordinate arrays are changed in place.
+ *
+ * @param[in,out] work        Pointer to work buffer structure.
+ * @param[in]     max_groups  Number of sets to cache (0 to disable).
+ * @param[in]     tolerance_rad Largest difference for stations to share.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_direction_cache(oskar_StationWork* work,
+        int max_groups, double tolerance_rad);
+
+/**
+ * @brief Enables interpolation of station beams in time.
+ *
+ * @details
+ * If enabled, oskar_station_beam_time_interp() evaluates the beam of each
+ * station exactly only at time indices which are a multiple of
+ * \p time_step, and interpolates linearly between them at other times.
+ * The beams at the two enclosing times are cached for up to
+ * \p max_channels frequencies for each of \p max_stations stations.
+ *
+ * If \p time_step is 0, the step is chosen automatically: it is halved if
+ * the error measured at the middle of an interval exceeds \p max_error,
+ * relative to the peak of the beam, and doubled if the error is
+ * well below it. The automatic step is kept between 2 and 256, so that it
+ * can always be checked and increased again. A \p time_step of 1 disables
+ * interpolation.
+ *
+ * Calling this function discards all cached beams and resets the
+ * statistics returned by oskar_station_work_beam_time_interp_stats().
+ *
+ * @param[in,out] work          Pointer to work buffer structure.
+ * @param[in] time_step         Time step between exact beams (0 = auto).
+ * @param[in] max_error         Largest allowed error, if automatic.
+ * @param[in] max_stations      Number of stations to cache.
+ * @param[in] max_channels      Number of frequencies cached per station.
+ * @param[in] time_start_mjd_utc Start time of the observation, as MJD(UTC).
+ * @param[in] time_inc_sec      Time increment, in seconds.
+ * @param[in] num_time_steps    Number of time steps in the observation.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_beam_time_interp(oskar_StationWork* work,
+        int time_step, double max_error, int max_stations, int max_channels,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps);
+
+/**
+ * @brief Sets the key of the sources whose beams are cached.
+ *
+ * @details
+ * Beams cached for interpolation in time are used again only if both the
+ * address of the source coordinate arrays and this key match the values
+ * used when they were cached. Setting a different key for each set of
+ * sources stored at the same address keeps a separate cache for each,
+ * if there is room for them. Beams with other keys are replaced first
+ * by those least recently used.
+ *
+ * @param[in,out] work          Pointer to work buffer structure.
+ * @param[in] key               Key of the sources in later calls.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_beam_time_interp_key(oskar_StationWork* work,
+        int key);
+
+/**
+ * @brief Discards station beams cached for interpolation in time.
+ *
+ * @details
+ * Beams are cached against the address of the source coordinate arrays,
+ * so this must be called if the source coordinates are changed in place.
+ *
+ * @param[in,out] work          Pointer to work buffer structure.
+ */
+OSKAR_EXPORT
+void oskar_station_work_clear_beam_time_interp(oskar_StationWork* work);
+
+/**
+ * @brief Returns statistics of station beam interpolation in time.
+ *
+ * @param[in] work              Pointer to work buffer structure.
+ * @param[out] time_step        Current time step between exact beams.
+ * @param[out] num_exact        Number of beams evaluated exactly.
+ * @param[out] num_interp       Number of beams interpolated.
+ * @param[out] num_checks       Number of interpolated beams checked.
+ * @param[out] max_error        Largest error found, relative to the peak.
+ */
+OSKAR_EXPORT
+void oskar_station_work_beam_time_interp_stats(const oskar_StationWork* work,
+        int* time_step, double* num_exact, double* num_interp,
+        double* num_checks, double* max_error);
+
 OSKAR_EXPORT
 void oskar_station_work_set_tec_screen_common_params(oskar_StationWork* work,
         char screen_type, double screen_height_km, double screen_pixel_size_m,
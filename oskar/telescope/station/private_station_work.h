@@ -8,6 +8,18 @@
 
 #include <mem/oskar_mem.h>
 
+/* Beams of one station at two times, for interpolation in time. */
+struct oskar_StationBeamCache
+{
+    const void* source;          /* Source coordinates used as the key. */
+    int key, num_points, coord_type;
+    double ref_lon_rad, ref_lat_rad, frequency_hz;
+    int time_index[2];           /* Time index of each beam, or -1. */
+    unsigned int last_used;
+    oskar_Mem* beam[2];
+};
+typedef struct oskar_StationBeamCache oskar_StationBeamCache;
+
 struct oskar_StationWork
 {
     oskar_Mem* weights;          /* Complex scalar. */
@@ -23,6 +35,23 @@ struct oskar_StationWork
     oskar_Mem* phi_y;            /* Real scalar. */
     oskar_Mem* beam_out_scratch; /* Output scratch array. */
 
+    /* Cache of source ENU directions, for groups of stations. */
+    int dir_max_groups, dir_num_groups, dir_next_group;
+    int dir_time_index, dir_num_points, dir_coord_type;
+    const void* dir_source;
+    double dir_tolerance_rad, dir_ref_lon_rad, dir_ref_lat_rad;
+    double *dir_lst_rad, *dir_lat_rad; /* Key of each group. */
+    oskar_Mem** dir_enu;               /* Three arrays per group. */
+
+    /* Cache of station beams, for interpolation in time. */
+    int interp_time_step, interp_auto, interp_num_time_steps;
+    int interp_max_stations, interp_max_channels, interp_key;
+    unsigned int interp_counter;
+    double interp_max_error, interp_time_start_mjd_utc, interp_time_inc_sec;
+    double interp_error, interp_num_checks, interp_num_exact, interp_num_interp;
+    oskar_StationBeamCache* interp_cache; /* Channels for each station. */
+    oskar_Mem* interp_check;     /* Exact beam, for checking accuracy. */
+
     /* TEC screen. */
     char screen_type;
     int previous_time_index;
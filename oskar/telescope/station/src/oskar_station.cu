@@ -5,6 +5,7 @@
 #include "telescope/station/define_evaluate_element_weights_errors.h"
 #include "telescope/station/define_evaluate_tec_screen.h"
 #include "telescope/station/define_evaluate_vla_beam_pbcor.h"
+#include "telescope/station/define_station_beam_time_interp.h"
 #include "utility/oskar_cuda_registrar.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
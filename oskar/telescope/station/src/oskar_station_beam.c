@@ -65,6 +65,79 @@ static void oskar_convert_any_to_enu_directions(
 }
 
 
+/* Returns source ENU directions, using the cache in the workspace if enabled.
+ * Each array has space for (num_points + 1) values. */
+static void get_enu_directions(oskar_StationWork* work,
+        int source_coord_type, int num_points,
+        const oskar_Mem* const source_coords[3],
+        double ref_lon_rad, double ref_lat_rad, int time_index,
+        double lst_rad, double lat_rad, oskar_Mem* enu[3], int* status)
+{
+    int i, g;
+    if (*status) return;
+
+    /* Convert directly if not caching. */
+    if (work->dir_max_groups == 0)
+    {
+        for (i = 0; i < 3; ++i)
+            enu[i] = oskar_station_work_enu_direction(
+                    work, i, num_points + 1, status);
+        oskar_convert_any_to_enu_directions(source_coord_type,
+                num_points, source_coords, ref_lon_rad, ref_lat_rad,
+                lst_rad, lat_rad, enu, status);
+        return;
+    }
+
+    /* Discard the cache if the sources or the time have changed. */
+    if (time_index != work->dir_time_index ||
+            num_points != work->dir_num_points ||
+            source_coord_type != work->dir_coord_type ||
+            (const void*) source_coords[0] != work->dir_source ||
+            ref_lon_rad != work->dir_ref_lon_rad ||
+            ref_lat_rad != work->dir_ref_lat_rad)
+    {
+        work->dir_num_groups = 0;
+        work->dir_next_group = 0;
+        work->dir_time_index = time_index;
+        work->dir_num_points = num_points;
+        work->dir_coord_type = source_coord_type;
+        work->dir_source = (const void*) source_coords[0];
+        work->dir_ref_lon_rad = ref_lon_rad;
+        work->dir_ref_lat_rad = ref_lat_rad;
+    }
+
+    /* Look for a group of stations that can share the directions. */
+    for (g = 0; g < work->dir_num_groups; ++g)
+    {
+        if (fabs(work->dir_lst_rad[g] - lst_rad) <= work->dir_tolerance_rad &&
+                fabs(work->dir_lat_rad[g] - lat_rad) <=
+                        work->dir_tolerance_rad)
+        {
+            for (i = 0; i < 3; ++i) enu[i] = work->dir_enu[3 * g + i];
+            return;
+        }
+    }
+
+    /* Not found, so evaluate them for a new group,
+     * replacing the oldest if the cache is full. */
+    g = work->dir_next_group;
+    work->dir_next_group = (g + 1) % work->dir_max_groups;
+    if (work->dir_num_groups < work->dir_max_groups)
+        work->dir_num_groups++;
+    work->dir_lst_rad[g] = lst_rad;
+    work->dir_lat_rad[g] = lat_rad;
+    for (i = 0; i < 3; ++i)
+    {
+        enu[i] = work->dir_enu[3 * g + i];
+        oskar_mem_ensure(enu[i], (size_t)num_points + 1, status);
+    }
+    oskar_convert_any_to_enu_directions(source_coord_type,
+            num_points, source_coords, ref_lon_rad, ref_lat_rad,
+            lst_rad, lat_rad, enu, status);
+    if (*status) work->dir_num_groups = 0;
+}
+
+
 void oskar_station_beam(
         const oskar_Station* station,
         oskar_StationWork* work,
@@ -124,15 +197,11 @@ void oskar_station_beam(
 
     /* Get source ENU coordinates. */
     for (i = 0; i < 3; ++i)
-    {
-        enu[i] = oskar_station_work_enu_direction(
-                work, i, num_points + 1, status);
         lmn[i] = oskar_station_work_lmn_direction(
                 work, i, num_points + 1, status);
-    }
-    oskar_convert_any_to_enu_directions(source_coord_type,
+    get_enu_directions(work, source_coord_type,
             num_points, source_coords, ref_lon_rad, ref_lat_rad,
-            lst_rad, lat_rad, enu, status);
+            time_index, lst_rad, lat_rad, enu, status);
 
     /* Check whether normalisation is needed. */
     const int normalise = oskar_station_normalise_final_beam(station) &&
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "telescope/station/define_station_beam_time_interp.h"
+#include "telescope/station/private_station_work.h"
+#include "telescope/station/oskar_station.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The automatic time step is kept within these limits. The lower limit
+ * is 2, as interpolation and its checks stop at a step of 1. */
+#define MIN_AUTO_TIME_STEP 2
+#define MAX_AUTO_TIME_STEP 256
+
+OSKAR_STATION_BEAM_TIME_INTERP(station_beam_time_interp_f, float)
+OSKAR_STATION_BEAM_TIME_INTERP(station_beam_time_interp_d, double)
+
+static oskar_StationBeamCache* get_cache(oskar_StationWork* work,
+        int cache_index, int source_coord_type, int num_points,
+        const oskar_Mem* const source_coords[3], double ref_lon_rad,
+        double ref_lat_rad, double frequency_hz, int* is_new);
+static void interpolate(int num_points, double frac, const oskar_Mem* a,
+        const oskar_Mem* b, int offset_out, oskar_Mem* beam, int* status);
+static double max_difference(int num_points, const oskar_Mem* a,
+        int offset_a, const oskar_Mem* b, int offset_b, double* peak,
+        int* status);
+
+void oskar_station_beam_time_interp(
+        const oskar_Station* station,
+        int cache_index,
+        oskar_StationWork* work,
+        int source_coord_type,
+        int num_points,
+        const oskar_Mem* const source_coords[3],
+        double ref_lon_rad,
+        double ref_lat_rad,
+        int norm_coord_type,
+        double norm_lon_rad,
+        double norm_lat_rad,
+        int time_index,
+        double gast_rad,
+        double frequency_hz,
+        int offset_out,
+        oskar_Mem* beam,
+        int* status)
+{
+    int i, is_new = 0, t[2];
+    if (*status) return;
+    const int step = work->interp_time_step;
+    const int num_times = work->interp_num_time_steps;
+
+    /* Evaluate the beam directly if not interpolating. */
+    if (step <= 1 || cache_index < 0 ||
+            cache_index >= work->interp_max_stations ||
+            time_index < 0 || time_index >= num_times ||
+            work->screen_type != 'N' ||
+            oskar_station_type(station) != OSKAR_STATION_TYPE_AA)
+    {
+        oskar_station_beam(station, work, source_coord_type, num_points,
+                source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+                norm_lon_rad, norm_lat_rad, time_index, gast_rad,
+                frequency_hz, offset_out, beam, status);
+        if (work->interp_max_stations > 0) work->interp_num_exact += 1.0;
+        return;
+    }
+
+    /* Find the grid points enclosing the time index. */
+    t[0] = (time_index / step) * step;
+    t[1] = t[0] + step;
+    if (t[1] > num_times - 1) t[1] = num_times - 1;
+    const int num_nodes = (time_index == t[0] || t[1] <= t[0]) ? 1 : 2;
+
+    /* A new cache entry may never be used again, so if it would need
+     * beams at two grid points, evaluate the beam directly instead, and
+     * fill the grid points only if the entry is used again. */
+    oskar_StationBeamCache* c = get_cache(work, cache_index,
+            source_coord_type, num_points, source_coords,
+            ref_lon_rad, ref_lat_rad, frequency_hz, &is_new);
+    if (is_new && num_nodes == 2)
+    {
+        oskar_station_beam(station, work, source_coord_type, num_points,
+                source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+                norm_lon_rad, norm_lat_rad, time_index, gast_rad,
+                frequency_hz, offset_out, beam, status);
+        work->interp_num_exact += 1.0;
+        return;
+    }
+
+    /* Make sure the beams at the grid points are in the cache.
+     * If moving to the next interval, the end beam becomes the start. */
+    if (c->time_index[0] != t[0] && c->time_index[1] == t[0])
+    {
+        oskar_Mem* tmp = c->beam[0];
+        c->beam[0] = c->beam[1];
+        c->beam[1] = tmp;
+        c->time_index[1] = c->time_index[0];
+        c->time_index[0] = t[0];
+    }
+    for (i = 0; i < num_nodes; ++i)
+    {
+        if (c->time_index[i] == t[i]) continue;
+        const double mjd = work->interp_time_start_mjd_utc +
+                (work->interp_time_inc_sec / 86400.0) * (t[i] + 0.5);
+        if (c->beam[i] && (oskar_mem_type(c->beam[i]) != oskar_mem_type(beam)
+                || oskar_mem_location(c->beam[i]) != oskar_mem_location(beam)))
+        {
+            oskar_mem_free(c->beam[i], status);
+            c->beam[i] = 0;
+        }
+        if (!c->beam[i])
+            c->beam[i] = oskar_mem_create(oskar_mem_type(beam),
+                    oskar_mem_location(beam), (size_t) num_points, status);
+        else
+            oskar_mem_ensure(c->beam[i], (size_t) num_points, status);
+        oskar_station_beam(station, work, source_coord_type, num_points,
+                source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+                norm_lon_rad, norm_lat_rad, t[i],
+                oskar_convert_mjd_to_gast_fast(mjd),
+                frequency_hz, 0, c->beam[i], status);
+        c->time_index[i] = *status ? -1 : t[i];
+        work->interp_num_exact += 1.0;
+    }
+    if (*status) return;
+
+    /* Copy the beam if the time index is on the grid. */
+    if (num_nodes == 1)
+    {
+        oskar_mem_copy_contents(beam, c->beam[0], (size_t) offset_out, 0,
+                (size_t) num_points, status);
+        return;
+    }
+
+    /* Interpolate between the grid points. */
+    const double frac = (double)(time_index - t[0]) / (t[1] - t[0]);
+    if (cache_index != 0 || time_index != t[0] + (t[1] - t[0]) / 2)
+    {
+        interpolate(num_points, frac, c->beam[0], c->beam[1],
+                offset_out, beam, status);
+        work->interp_num_interp += 1.0;
+        return;
+    }
+
+    /* At the middle of the interval, check the interpolated beam against
+     * the exact beam, and adjust the time step if it is automatic.
+     * The error of linear interpolation scales with the square of the
+     * step, so doubling it should multiply the error by about 4. */
+    double peak = 0.0;
+    if (!work->interp_check)
+        work->interp_check = oskar_mem_create(oskar_mem_type(beam),
+                oskar_mem_location(beam), (size_t) num_points, status);
+    else if (oskar_mem_type(work->interp_check) != oskar_mem_type(beam) ||
+            oskar_mem_location(work->interp_check) != oskar_mem_location(beam))
+    {
+        oskar_mem_free(work->interp_check, status);
+        work->interp_check = oskar_mem_create(oskar_mem_type(beam),
+                oskar_mem_location(beam), (size_t) num_points, status);
+    }
+    else
+        oskar_mem_ensure(work->interp_check, (size_t) num_points, status);
+    interpolate(num_points, frac, c->beam[0], c->beam[1], 0,
+            work->interp_check, status);
+    oskar_station_beam(station, work, source_coord_type, num_points,
+            source_coords, ref_lon_rad, ref_lat_rad, norm_coord_type,
+            norm_lon_rad, norm_lat_rad, time_index, gast_rad,
+            frequency_hz, offset_out, beam, status);
+    work->interp_num_exact += 1.0;
+    const double diff = max_difference(num_points, work->interp_check, 0,
+            beam, offset_out, &peak, status);
+    if (*status || peak <= 0.0) return;
+    const double error = diff / peak;
+    work->interp_num_checks += 1.0;
+    if (error > work->interp_error) work->interp_error = error;
+    if (work->interp_auto)
+    {
+        if (error > work->interp_max_error && step / 2 >= MIN_AUTO_TIME_STEP)
+            work->interp_time_step = step / 2;
+        else if (error < work->interp_max_error / 8.0 &&
+                2 * step <= MAX_AUTO_TIME_STEP)
+            work->interp_time_step = 2 * step;
+    }
+}
+
+static oskar_StationBeamCache* get_cache(oskar_StationWork* work,
+        int cache_index, int source_coord_type, int num_points,
+        const oskar_Mem* const source_coords[3], double ref_lon_rad,
+        double ref_lat_rad, double frequency_hz, int* is_new)
+{
+    int i;
+    oskar_StationBeamCache *c = 0, *entries;
+    entries = &work->interp_cache[cache_index * work->interp_max_channels];
+
+    /* Look for the entry matching the sources and frequency,
+     * and replace the least recently used one if there is none. */
+    for (i = 0; i < work->interp_max_channels; ++i)
+    {
+        oskar_StationBeamCache* e = &entries[i];
+        if (e->source == (const void*) source_coords[0] &&
+                e->key == work->interp_key &&
+                e->num_points == num_points &&
+                e->coord_type == source_coord_type &&
+                e->ref_lon_rad == ref_lon_rad &&
+                e->ref_lat_rad == ref_lat_rad &&
+                e->frequency_hz == frequency_hz)
+        {
+            c = e;
+            break;
+        }
+        if (!c || e->last_used < c->last_used) c = e;
+    }
+    if (c->source != (const void*) source_coords[0] ||
+            c->key != work->interp_key ||
+            c->num_points != num_points ||
+            c->coord_type != source_coord_type ||
+            c->ref_lon_rad != ref_lon_rad ||
+            c->ref_lat_rad != ref_lat_rad ||
+            c->frequency_hz != frequency_hz)
+    {
+        c->source = (const void*) source_coords[0];
+        c->key = work->interp_key;
+        c->num_points = num_points;
+        c->coord_type = source_coord_type;
+        c->ref_lon_rad = ref_lon_rad;
+        c->ref_lat_rad = ref_lat_rad;
+        c->frequency_hz = frequency_hz;
+        c->time_index[0] = c->time_index[1] = -1;
+        *is_new = 1;
+    }
+    c->last_used = ++work->interp_counter;
+    return c;
+}
+
+static void interpolate(int num_points, double frac, const oskar_Mem* a,
+        const oskar_Mem* b, int offset_out, oskar_Mem* beam, int* status)
+{
+    if (*status) return;
+    const int location = oskar_mem_location(beam);
+    const int num_real = (oskar_mem_is_matrix(beam) ? 8 : 2);
+    const int n = num_points * num_real;
+    const int offset = offset_out * num_real;
+    if (oskar_mem_location(a) != location || oskar_mem_location(b) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_type(a) != oskar_mem_type(beam) ||
+            oskar_mem_type(b) != oskar_mem_type(beam))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (location == OSKAR_CPU)
+    {
+        if (oskar_mem_precision(beam) == OSKAR_DOUBLE)
+            station_beam_time_interp_d(n, frac,
+                    oskar_mem_double_const(a, status),
+                    oskar_mem_double_const(b, status), offset,
+                    oskar_mem_double(beam, status));
+        else
+            station_beam_time_interp_f(n, (float) frac,
+                    oskar_mem_float_const(a, status),
+                    oskar_mem_float_const(b, status), offset,
+                    oskar_mem_float(beam, status));
+    }
+    else
+    {
+        size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        const int is_dbl = oskar_mem_precision(beam) == OSKAR_DOUBLE;
+        const float frac_f = (float) frac;
+        const char* k = is_dbl ?
+                "station_beam_time_interp_double" :
+                "station_beam_time_interp_float";
+        oskar_device_check_local_size(location, 0, local_size);
+        global_size[0] = oskar_device_global_size((size_t) n, local_size[0]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &n},
+                {is_dbl ? DBL_SZ : FLT_SZ,
+                        is_dbl ? (const void*)&frac : (const void*)&frac_f},
+                {PTR_SZ, oskar_mem_buffer_const(a)},
+                {PTR_SZ, oskar_mem_buffer_const(b)},
+                {INT_SZ, &offset},
+                {PTR_SZ, oskar_mem_buffer(beam)}
+        };
+        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
+static double max_difference(int num_points, const oskar_Mem* a,
+        int offset_a, const oskar_Mem* b, int offset_b, double* peak,
+        int* status)
+{
+    int i;
+    double diff = 0.0;
+    *peak = 0.0;
+    if (*status) return 0.0;
+    const int num_real = (oskar_mem_is_matrix(a) ? 8 : 2);
+    const int type = oskar_mem_type(a);
+    oskar_Mem* a_cpu = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    oskar_Mem* b_cpu = oskar_mem_create(type, OSKAR_CPU, num_points, status);
+    oskar_mem_copy_contents(a_cpu, a, 0, (size_t) offset_a,
+            (size_t) num_points, status);
+    oskar_mem_copy_contents(b_cpu, b, 0, (size_t) offset_b,
+            (size_t) num_points, status);
+    if (!*status)
+    {
+        const int n = num_points * num_real;
+        if (oskar_mem_precision(a) == OSKAR_DOUBLE)
+        {
+            const double *p = oskar_mem_double_const(a_cpu, status);
+            const double *q = oskar_mem_double_const(b_cpu, status);
+            for (i = 0; i < n; ++i)
+            {
+                if (fabs(p[i] - q[i]) > diff) diff = fabs(p[i] - q[i]);
+                if (fabs(q[i]) > *peak) *peak = fabs(q[i]);
+            }
+        }
+        else
+        {
+            const float *p = oskar_mem_float_const(a_cpu, status);
+            const float *q = oskar_mem_float_const(b_cpu, status);
+            for (i = 0; i < n; ++i)
+            {
+                if (fabs(p[i] - q[i]) > diff) diff = fabs(p[i] - q[i]);
+                if (fabs(q[i]) > *peak) *peak = fabs(q[i]);
+            }
+        }
+    }
+    oskar_mem_free(a_cpu, status);
+    oskar_mem_free(b_cpu, status);
+    return diff;
+}
+
+#ifdef __cplusplus
+}
+#endif
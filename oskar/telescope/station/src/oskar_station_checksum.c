@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_crc.h"
+#include "splines/private_splines.h"
+#include "telescope/private_telescope_snapshot.h"
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/oskar_station.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static unsigned long update_station(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Station* s, int* status);
+static unsigned long update_element(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Element* e, int* status);
+static unsigned long update_splines(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Splines* s, int* status);
+static unsigned long update_mem(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Mem* mem, int* status);
+
+unsigned long oskar_station_checksum(const oskar_Station* station,
+        unsigned long crc, int* status)
+{
+    if (*status || !station) return crc;
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    crc = update_station(crc_data, crc, station, status);
+    oskar_crc_free(crc_data);
+    return crc;
+}
+
+static unsigned long update_station(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Station* s, int* status)
+{
+    int i;
+    if (*status) return crc;
+
+    /* Meta-data (the same set as written to a model snapshot). */
+    const int ints[] = {s->station_type, s->normalise_final_beam,
+            s->beam_coord_type, s->identical_children, s->num_elements,
+            s->element ? s->num_element_types : 0,
+            s->normalise_array_pattern, s->normalise_element_pattern,
+            s->enable_array_pattern, s->common_element_orientation,
+            s->common_pol_beams, s->swap_xy, s->array_is_3d,
+            s->apply_element_errors, s->apply_element_weight,
+            (int) s->seed_time_variable_errors, s->num_permitted_beams,
+            s->child ? 1 : 0};
+    const double doubles[] = {s->offset_ecef[0], s->offset_ecef[1],
+            s->offset_ecef[2], s->lon_rad, s->lat_rad, s->alt_metres,
+            s->pm_x_rad, s->pm_y_rad, s->beam_lon_rad, s->beam_lat_rad,
+            s->gaussian_beam_fwhm_rad, s->gaussian_beam_reference_freq_hz};
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = oskar_crc_update(crc_data, crc, doubles, sizeof(doubles));
+
+    /* Element layout, weights, errors, types and orientations. */
+    for (i = 0; i < SNAPSHOT_NUM_STATION_ARRAYS; ++i)
+    {
+        const oskar_Mem* array = *(oskar_Mem* const*) ((const char*) s +
+                oskar_telescope_snapshot_station_arrays[i]);
+        crc = update_mem(crc_data, crc, array, status);
+    }
+
+    /* Element models. */
+    if (s->element)
+    {
+        for (i = 0; i < s->num_element_types; ++i)
+        {
+            crc = update_element(crc_data, crc, s->element[i], status);
+        }
+    }
+
+    /* Child stations. */
+    if (s->child)
+    {
+        for (i = 0; i < s->num_elements; ++i)
+        {
+            crc = update_station(crc_data, crc, s->child[i], status);
+        }
+    }
+    return crc;
+}
+
+static unsigned long update_element(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Element* e, int* status)
+{
+    int i;
+    if (*status || !e) return crc;
+    const int ints[] = {e->x_element_type, e->y_element_type,
+            e->x_taper_type, e->y_taper_type, e->x_dipole_length_units,
+            e->y_dipole_length_units, e->element_type, e->taper_type,
+            e->dipole_length_units, e->coord_sys, e->num_freq};
+    const double doubles[] = {e->x_dipole_length, e->y_dipole_length,
+            e->x_taper_cosine_power, e->y_taper_cosine_power,
+            e->x_taper_gaussian_fwhm_rad, e->y_taper_gaussian_fwhm_rad,
+            e->x_taper_ref_freq_hz, e->y_taper_ref_freq_hz,
+            e->dipole_length, e->cosine_power, e->gaussian_fwhm_rad,
+            e->max_radius_rad};
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = oskar_crc_update(crc_data, crc, doubles, sizeof(doubles));
+    if (e->num_freq > 0)
+    {
+        crc = oskar_crc_update(crc_data, crc, e->freqs_hz,
+                e->num_freq * sizeof(double));
+    }
+    for (i = 0; i < e->num_freq; ++i)
+    {
+        const int freq_ints[] = {e->l_max[i], e->common_phi_coords[i]};
+        crc = oskar_crc_update(crc_data, crc, freq_ints, sizeof(freq_ints));
+        crc = update_splines(crc_data, crc, e->x_h_re[i], status);
+        crc = update_splines(crc_data, crc, e->x_h_im[i], status);
+        crc = update_splines(crc_data, crc, e->x_v_re[i], status);
+        crc = update_splines(crc_data, crc, e->x_v_im[i], status);
+        crc = update_splines(crc_data, crc, e->y_h_re[i], status);
+        crc = update_splines(crc_data, crc, e->y_h_im[i], status);
+        crc = update_splines(crc_data, crc, e->y_v_re[i], status);
+        crc = update_splines(crc_data, crc, e->y_v_im[i], status);
+        crc = update_splines(crc_data, crc, e->scalar_re[i], status);
+        crc = update_splines(crc_data, crc, e->scalar_im[i], status);
+        crc = update_mem(crc_data, crc, e->sph_wave[i], status);
+    }
+    return crc;
+}
+
+static unsigned long update_splines(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Splines* s, int* status)
+{
+    if (*status || !s) return crc;
+    const int ints[] = {s->num_knots_x_theta, s->num_knots_y_phi};
+    crc = oskar_crc_update(crc_data, crc, ints, sizeof(ints));
+    crc = update_mem(crc_data, crc, s->knots_x_theta, status);
+    crc = update_mem(crc_data, crc, s->knots_y_phi, status);
+    crc = update_mem(crc_data, crc, s->coeff, status);
+    return crc;
+}
+
+static unsigned long update_mem(const oskar_CRC* crc_data,
+        unsigned long crc, const oskar_Mem* mem, int* status)
+{
+    oskar_Mem* copy = 0;
+    if (*status || !mem) return crc;
+    const size_t num_bytes = oskar_mem_length(mem) *
+            oskar_mem_element_size(oskar_mem_type(mem));
+    const int type = oskar_mem_type(mem);
+    crc = oskar_crc_update(crc_data, crc, &type, sizeof(int));
+    if (num_bytes == 0) return crc;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        copy = oskar_mem_create_copy(mem, OSKAR_CPU, status);
+        mem = copy;
+    }
+    if (!*status)
+    {
+        crc = oskar_crc_update(crc_data, crc, oskar_mem_void_const(mem),
+                num_bytes);
+    }
+    oskar_mem_free(copy, status);
+    return crc;
+}
+
+#ifdef __cplusplus
+}
+#endif
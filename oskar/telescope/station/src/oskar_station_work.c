@@ -1,18 +1,18 @@
 /*
- * Copyright (c) 2012-2020, The OSKAR Developers.
+ * Copyright (c) 2012-2021, The OSKAR Developers.
  * See the LICENSE file at the top-level directory of this distribution.
  */
 
 #include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 #include "telescope/station/oskar_evaluate_tec_screen.h"
-
 #include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void free_beam_cache(oskar_StationWork* work, int* status);
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status);
 
@@ -46,6 +46,8 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->screen_output = oskar_mem_create(complex_type, location, 0, status);
     work->screen_type = 'N'; /* None */
     work->previous_time_index = -1;
+    work->dir_time_index = -1;
+    work->interp_time_step = 1;
     return work;
 }
 
@@ -73,6 +75,13 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     }
     for (i = 0; i < work->num_depths; ++i)
         oskar_mem_free(work->beam[i], status);
+    for (i = 0; i < 3 * work->dir_max_groups; ++i)
+        oskar_mem_free(work->dir_enu[i], status);
+    free(work->dir_enu);
+    free(work->dir_lst_rad);
+    free(work->dir_lat_rad);
+    free_beam_cache(work, status);
+    oskar_mem_free(work->interp_check, status);
     free(work);
 }
 
@@ -100,6 +109,96 @@ oskar_Mem* oskar_station_work_lmn_direction(oskar_StationWork* work, int dim,
     return work->lmn[dim];
 }
 
+void oskar_station_work_set_direction_cache(oskar_StationWork* work,
+        int max_groups, double tolerance_rad)
+{
+    int i, status = 0;
+    if (max_groups < 0) max_groups = 0;
+    work->dir_num_groups = 0;
+    work->dir_next_group = 0;
+    work->dir_time_index = -1;
+    work->dir_tolerance_rad = tolerance_rad;
+    if (max_groups == work->dir_max_groups) return;
+    for (i = 0; i < 3 * work->dir_max_groups; ++i)
+        oskar_mem_free(work->dir_enu[i], &status);
+    free(work->dir_enu);
+    free(work->dir_lst_rad);
+    free(work->dir_lat_rad);
+    work->dir_enu = 0;
+    work->dir_lst_rad = 0;
+    work->dir_lat_rad = 0;
+    work->dir_max_groups = max_groups;
+    if (max_groups == 0) return;
+    work->dir_enu = (oskar_Mem**) calloc(3 * max_groups, sizeof(oskar_Mem*));
+    work->dir_lst_rad = (double*) calloc(max_groups, sizeof(double));
+    work->dir_lat_rad = (double*) calloc(max_groups, sizeof(double));
+    for (i = 0; i < 3 * max_groups; ++i)
+        work->dir_enu[i] = oskar_mem_create(oskar_mem_type(work->enu[0]),
+                oskar_mem_location(work->enu[0]), 0, &status);
+}
+
+void oskar_station_work_set_beam_time_interp(oskar_StationWork* work,
+        int time_step, double max_error, int max_stations, int max_channels,
+        double time_start_mjd_utc, double time_inc_sec, int num_time_steps)
+{
+    int status = 0;
+    if (time_step < 0) time_step = 1;
+    if (max_stations < 0) max_stations = 0;
+    if (max_channels < 1) max_channels = 1;
+    if (max_stations != work->interp_max_stations ||
+            max_channels != work->interp_max_channels)
+    {
+        free_beam_cache(work, &status);
+        work->interp_max_stations = max_stations;
+        work->interp_max_channels = max_channels;
+        if (max_stations > 0)
+            work->interp_cache = (oskar_StationBeamCache*) calloc(
+                    (size_t) max_stations * max_channels,
+                    sizeof(oskar_StationBeamCache));
+    }
+    work->interp_auto = (time_step == 0);
+    work->interp_time_step = (time_step == 0) ? 4 : time_step;
+    work->interp_max_error = max_error;
+    work->interp_time_start_mjd_utc = time_start_mjd_utc;
+    work->interp_time_inc_sec = time_inc_sec;
+    work->interp_num_time_steps = num_time_steps;
+    work->interp_error = work->interp_num_checks = 0.0;
+    work->interp_num_exact = work->interp_num_interp = 0.0;
+    oskar_station_work_clear_beam_time_interp(work);
+}
+
+void oskar_station_work_set_beam_time_interp_key(oskar_StationWork* work,
+        int key)
+{
+    work->interp_key = key;
+}
+
+void oskar_station_work_clear_beam_time_interp(oskar_StationWork* work)
+{
+    int i;
+    const int num_entries = work->interp_max_stations *
+            work->interp_max_channels;
+    for (i = 0; i < num_entries; ++i)
+    {
+        oskar_StationBeamCache* c = &work->interp_cache[i];
+        c->source = 0;
+        c->time_index[0] = c->time_index[1] = -1;
+        c->last_used = 0;
+    }
+    work->interp_counter = 0;
+}
+
+void oskar_station_work_beam_time_interp_stats(const oskar_StationWork* work,
+        int* time_step, double* num_exact, double* num_interp,
+        double* num_checks, double* max_error)
+{
+    *time_step = work->interp_time_step;
+    *num_exact = work->interp_num_exact;
+    *num_interp = work->interp_num_interp;
+    *num_checks = work->interp_num_checks;
+    *max_error = work->interp_error;
+}
+
 void oskar_station_work_set_tec_screen_common_params(oskar_StationWork* work,
         char screen_type, double screen_height_km, double screen_pixel_size_m,
         double screen_time_interval_sec)
@@ -195,6 +294,21 @@ oskar_Mem* oskar_station_work_beam(oskar_StationWork* work,
     return work->beam[depth];
 }
 
+static void free_beam_cache(oskar_StationWork* work, int* status)
+{
+    int i;
+    const int num_entries = work->interp_max_stations *
+            work->interp_max_channels;
+    for (i = 0; i < num_entries && work->interp_cache; ++i)
+    {
+        oskar_mem_free(work->interp_cache[i].beam[0], status);
+        oskar_mem_free(work->interp_cache[i].beam[1], status);
+    }
+    free(work->interp_cache);
+    work->interp_cache = 0;
+    work->interp_max_stations = 0;
+}
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status)
 {
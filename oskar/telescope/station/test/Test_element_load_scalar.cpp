@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+TEST(element_load_scalar, test_fit_cache)
+{
+    int status = 0;
+    const char* filename = "temp_test_element_scalar.txt";
+    const char* cache = "temp_test_element_scalar.txt.fit.bin";
+    const double freq_hz = 100e6;
+    remove(cache);
+
+    // Write a smooth scalar element pattern.
+    FILE* f = fopen(filename, "w");
+    for (int t = 0; t <= 90; t += 5)
+    {
+        for (int p = 0; p < 360; p += 10)
+        {
+            const double theta = t * M_PI / 180.0;
+            const double phi = p * M_PI / 180.0;
+            fprintf(f, "%d %d %.6f %.6f\n", t, p,
+                    cos(theta) * (1.0 + 0.1 * cos(phi)), 10.0 * sin(theta));
+        }
+    }
+    fclose(f);
+
+    // Fit the surfaces, which should write the cache.
+    oskar_Element* e1 = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_load_scalar(e1, freq_hz, filename, 0.02, 2.0, 0, 0,
+            0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_element_has_scalar_spline_data(e1, 0));
+    ASSERT_TRUE(oskar_dir_file_exists(".", cache));
+
+    // The temporary file used to write the cache must have gone.
+    int num_temp = 0;
+    char** temp_names = 0;
+    oskar_dir_items(".", "temp_test_element_scalar.txt.fit.bin.tmp*",
+            1, 0, &num_temp, &temp_names);
+    EXPECT_EQ(0, num_temp);
+    for (int i = 0; i < num_temp; ++i) free(temp_names[i]);
+    free(temp_names);
+
+    // Load again, which should use the cache.
+    oskar_Element* e2 = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_load_scalar(e2, freq_hz, filename, 0.02, 2.0, 0, 0,
+            0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    for (int i = 0; i < 2; ++i)
+    {
+        const oskar_Splines* s1 = i == 0 ? e1->scalar_re[0] : e1->scalar_im[0];
+        const oskar_Splines* s2 = i == 0 ? e2->scalar_re[0] : e2->scalar_im[0];
+        ASSERT_GT(oskar_splines_num_knots_x_theta(s1), 0);
+        EXPECT_EQ(oskar_splines_num_knots_x_theta(s1),
+                oskar_splines_num_knots_x_theta(s2));
+        EXPECT_EQ(oskar_splines_num_knots_y_phi(s1),
+                oskar_splines_num_knots_y_phi(s2));
+        EXPECT_EQ(oskar_splines_smoothing_factor(s1),
+                oskar_splines_smoothing_factor(s2));
+        EXPECT_FALSE(oskar_mem_different(oskar_splines_coeff_const(s1),
+                oskar_splines_coeff_const(s2), 0, &status));
+    }
+
+    // A different fitting parameter must not use the cached surfaces.
+    oskar_Element* e3 = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_element_load_scalar(e3, freq_hz, filename, 0.1, 2.0, 0, 0,
+            0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_NE(oskar_splines_smoothing_factor(e1->scalar_re[0]),
+            oskar_splines_smoothing_factor(e3->scalar_re[0]));
+
+    oskar_element_free(e1, &status);
+    oskar_element_free(e2, &status);
+    oskar_element_free(e3, &status);
+    remove(filename);
+    remove(cache);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_evaluate_spherical_wave_sum.h"
+#include "telescope/station/element/define_evaluate_spherical_wave.h"
+#include "math/define_legendre_polynomial.h"
+#include "math/define_multiply.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// Direct evaluation of each term, used as the reference.
+OSKAR_EVALUATE_SPHERICAL_WAVE_SUM(sph_wave_direct, double, double2, double4c)
+
+static void run_test(int prec, int l_max, double tol)
+{
+    int status = 0;
+    const int num_points = 2000;
+    const int type = prec | OSKAR_COMPLEX | OSKAR_MATRIX;
+    const int num_coeff = (l_max + 1) * (l_max + 1) - 1;
+    oskar_Mem* theta = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* phi_x = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* phi_y = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* alpha = oskar_mem_create(type, OSKAR_CPU, num_coeff, &status);
+    oskar_Mem* out = oskar_mem_create(type, OSKAR_CPU, num_points + 5, &status);
+    oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points + 5, &status);
+    oskar_mem_random_range(theta, 0.0, M_PI / 2.0, &status);
+    oskar_mem_random_range(phi_x, -M_PI, M_PI, &status);
+    oskar_mem_random_range(phi_y, -M_PI, M_PI, &status);
+    oskar_mem_random_range(alpha, -1.0, 1.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Include points at the pole.
+    oskar_mem_set_element_real(theta, 0, 0.0, &status);
+    oskar_mem_set_element_real(theta, 1, 1e-7, &status);
+
+    // Evaluate both versions, using double precision for the reference.
+    oskar_evaluate_spherical_wave_sum(num_points, theta, phi_x, phi_y,
+            l_max, alpha, 5, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Mem* theta_d = oskar_mem_convert_precision(theta, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* phi_x_d = oskar_mem_convert_precision(phi_x, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* phi_y_d = oskar_mem_convert_precision(phi_y, OSKAR_DOUBLE,
+            &status);
+    oskar_Mem* alpha_d = oskar_mem_convert_precision(alpha, OSKAR_DOUBLE,
+            &status);
+    sph_wave_direct(num_points,
+            oskar_mem_double_const(theta_d, &status),
+            oskar_mem_double_const(phi_x_d, &status),
+            oskar_mem_double_const(phi_y_d, &status), l_max,
+            oskar_mem_double4c_const(alpha_d, &status), 5,
+            oskar_mem_double4c(ref, &status));
+
+    // Compare results, relative to the largest value.
+    oskar_Mem* out_d = oskar_mem_convert_precision(out, OSKAR_DOUBLE, &status);
+    const double* o = oskar_mem_double_const(out_d, &status);
+    const double* r = oskar_mem_double_const(ref, &status);
+    double max_val = 0.0, max_err = 0.0;
+    for (int i = 5 * 8; i < (num_points + 5) * 8; ++i)
+    {
+        max_val = std::max(max_val, fabs(r[i]));
+        max_err = std::max(max_err, fabs(o[i] - r[i]));
+    }
+    EXPECT_GT(max_val, 0.0);
+    EXPECT_LT(max_err / max_val, tol) << "l_max = " << l_max;
+
+    // Free memory.
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi_x, &status);
+    oskar_mem_free(phi_y, &status);
+    oskar_mem_free(alpha, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out_d, &status);
+    oskar_mem_free(theta_d, &status);
+    oskar_mem_free(phi_x_d, &status);
+    oskar_mem_free(phi_y_d, &status);
+    oskar_mem_free(alpha_d, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(evaluate_spherical_wave_sum, recurrence_double)
+{
+    const int l_max[] = {1, 2, 5, 15, 30};
+    for (int i = 0; i < 5; ++i)
+        run_test(OSKAR_DOUBLE, l_max[i], 1e-10);
+}
+
+TEST(evaluate_spherical_wave_sum, recurrence_single)
+{
+    const int l_max[] = {1, 2, 5, 15, 30};
+    for (int i = 0; i < 5; ++i)
+        run_test(OSKAR_SINGLE, l_max[i], 2e-5);
+}
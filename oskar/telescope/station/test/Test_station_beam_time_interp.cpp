@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/oskar_station.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "math/oskar_evaluate_image_lmn_grid.h"
+#include "math/oskar_linspace.h"
+#include "math/oskar_meshgrid.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+#ifdef OSKAR_HAVE_CUDA
+static int device_loc = OSKAR_GPU;
+#else
+static int device_loc = OSKAR_CPU;
+#endif
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b,
+        double* peak, int* status)
+{
+    oskar_Mem* a_ = oskar_mem_create_copy(a, OSKAR_CPU, status);
+    oskar_Mem* b_ = oskar_mem_create_copy(b, OSKAR_CPU, status);
+    const double2* pa = oskar_mem_double2_const(a_, status);
+    const double2* pb = oskar_mem_double2_const(b_, status);
+    const size_t num_elements = oskar_mem_length(a_);
+    double diff = 0.0;
+    *peak = 0.0;
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+        const double dx = pa[i].x - pb[i].x, dy = pa[i].y - pb[i].y;
+        const double d = sqrt(dx * dx + dy * dy);
+        const double p = sqrt(pa[i].x * pa[i].x + pa[i].y * pa[i].y);
+        if (d > diff) diff = d;
+        if (p > *peak) *peak = p;
+    }
+    oskar_mem_free(a_, status);
+    oskar_mem_free(b_, status);
+    return diff;
+}
+
+static oskar_Station* create_station(int prec, double lat_rad, int* status)
+{
+    // Construct an aperture array station.
+    const int station_dim = 8;
+    const int num_antennas = station_dim * station_dim;
+    oskar_Station* station_cpu = oskar_station_create(prec,
+            OSKAR_CPU, num_antennas, status);
+    oskar_station_resize_element_types(station_cpu, 1, status);
+    oskar_station_set_position(station_cpu, 0.0, lat_rad, 0.0, 0.0, 0.0, 0.0);
+    oskar_station_set_phase_centre(station_cpu,
+            OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R);
+    oskar_element_set_element_type(oskar_station_element(station_cpu, 0),
+            "Isotropic", status);
+    std::vector<double> x_pos(station_dim);
+    oskar_linspace_d(&x_pos[0], -14.0, 14.0, station_dim);
+    oskar_meshgrid_d(
+            oskar_mem_double(oskar_station_element_measured_enu_metres(
+                    station_cpu, 0, 0), status),
+            oskar_mem_double(oskar_station_element_measured_enu_metres(
+                    station_cpu, 0, 1), status),
+            &x_pos[0], station_dim, &x_pos[0], station_dim);
+    oskar_mem_copy(oskar_station_element_true_enu_metres(station_cpu, 0, 0),
+            oskar_station_element_measured_enu_metres(station_cpu, 0, 0),
+            status);
+    oskar_mem_copy(oskar_station_element_true_enu_metres(station_cpu, 0, 1),
+            oskar_station_element_measured_enu_metres(station_cpu, 0, 1),
+            status);
+    oskar_Station* station = oskar_station_create_copy(station_cpu,
+            device_loc, status);
+    oskar_station_free(station_cpu, status);
+    return station;
+}
+
+TEST(station_beam_time_interp, compare_exact)
+{
+    int error = 0;
+    const int prec = OSKAR_DOUBLE;
+    const double frequency = 100e6;
+    const double lat_rad = -50.0 * D2R;
+    const double start_mjd = 51544.5, inc_sec = 60.0;
+    const int num_times = 9, time_step = 4;
+
+    oskar_Station* station = create_station(prec, lat_rad, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Create source positions around the phase centre.
+    const int num_l = 16, num_m = 16, num_pts = num_l * num_m;
+    oskar_Mem* l = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* m = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* n = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_evaluate_image_lmn_grid(num_l, num_m, 30.0 * D2R, 30.0 * D2R,
+            0, l, m, n, &error);
+    oskar_Mem* l_dev = oskar_mem_create_copy(l, device_loc, &error);
+    oskar_Mem* m_dev = oskar_mem_create_copy(m, device_loc, &error);
+    oskar_Mem* n_dev = oskar_mem_create_copy(n, device_loc, &error);
+    const oskar_Mem* const source_coords[] = {l_dev, m_dev, n_dev};
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Evaluate beams exactly and with interpolation, and compare them.
+    oskar_StationWork* work_exact = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_StationWork* work_interp = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_station_work_set_beam_time_interp(work_interp, time_step, 0.0,
+            1, 1, start_mjd, inc_sec, num_times);
+    oskar_Mem* beam_exact = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    oskar_Mem* beam_interp = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    double max_rel_diff = 0.0;
+    for (int t = 0; t < num_times; ++t)
+    {
+        const double mjd = start_mjd + (t + 0.5) * inc_sec / 86400.0;
+        const double gast = oskar_convert_mjd_to_gast_fast(mjd);
+        oskar_station_beam(station, work_exact, OSKAR_COORDS_REL_DIR,
+                num_pts, source_coords, 0.0, -60.0 * D2R,
+                OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                t, gast, frequency, 0, beam_exact, &error);
+        oskar_station_beam_time_interp(station, 0, work_interp,
+                OSKAR_COORDS_REL_DIR, num_pts, source_coords,
+                0.0, -60.0 * D2R, OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                t, gast, frequency, 0, beam_interp, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+        double peak = 0.0;
+        const double diff = max_abs_diff(beam_exact, beam_interp,
+                &peak, &error);
+        if (t % time_step == 0)
+        {
+            EXPECT_LT(diff, 1e-10 * peak) << "Time index " << t;
+        }
+        if (diff / peak > max_rel_diff) max_rel_diff = diff / peak;
+    }
+    EXPECT_GT(max_rel_diff, 0.0);
+    EXPECT_LT(max_rel_diff, 1e-2);
+
+    // Check statistics.
+    int step_used = 0;
+    double num_exact = 0.0, num_interp = 0.0, num_checks = 0.0;
+    double max_error = 0.0;
+    oskar_station_work_beam_time_interp_stats(work_interp, &step_used,
+            &num_exact, &num_interp, &num_checks, &max_error);
+    EXPECT_EQ(time_step, step_used);
+    EXPECT_GT(num_interp, 0.0);
+    EXPECT_GT(num_checks, 0.0);
+    EXPECT_LT(max_error, 1e-2);
+
+    // Clean up.
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_mem_free(l_dev, &error);
+    oskar_mem_free(m_dev, &error);
+    oskar_mem_free(n_dev, &error);
+    oskar_mem_free(beam_exact, &error);
+    oskar_mem_free(beam_interp, &error);
+    oskar_station_work_free(work_exact, &error);
+    oskar_station_work_free(work_interp, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST(station_beam_time_interp, auto_step_minimum)
+{
+    int error = 0;
+    const int prec = OSKAR_DOUBLE, num_pts = 64, num_times = 33;
+    const double frequency = 100e6;
+    const double start_mjd = 51544.5, inc_sec = 600.0;
+    oskar_Station* station = create_station(prec, -50.0 * D2R, &error);
+    oskar_Mem* l = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* m = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_Mem* n = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_evaluate_image_lmn_grid(8, 8, 30.0 * D2R, 30.0 * D2R,
+            0, l, m, n, &error);
+    oskar_Mem* l_dev = oskar_mem_create_copy(l, device_loc, &error);
+    oskar_Mem* m_dev = oskar_mem_create_copy(m, device_loc, &error);
+    oskar_Mem* n_dev = oskar_mem_create_copy(n, device_loc, &error);
+    const oskar_Mem* const source_coords[] = {l_dev, m_dev, n_dev};
+    oskar_Mem* beam = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // With an error limit that can never be met, the automatic step
+    // must shrink to its minimum and stay there, still checking errors.
+    oskar_StationWork* work = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_station_work_set_beam_time_interp(work, 0, 1e-30,
+            1, 1, start_mjd, inc_sec, num_times);
+    for (int t = 0; t < num_times; ++t)
+    {
+        const double mjd = start_mjd + (t + 0.5) * inc_sec / 86400.0;
+        oskar_station_beam_time_interp(station, 0, work,
+                OSKAR_COORDS_REL_DIR, num_pts, source_coords,
+                0.0, -60.0 * D2R, OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                t, oskar_convert_mjd_to_gast_fast(mjd), frequency, 0,
+                beam, &error);
+    }
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    int step_used = 0;
+    double num_exact = 0.0, num_interp = 0.0, num_checks = 0.0;
+    double max_error = 0.0;
+    oskar_station_work_beam_time_interp_stats(work, &step_used,
+            &num_exact, &num_interp, &num_checks, &max_error);
+    EXPECT_EQ(2, step_used);
+    EXPECT_GT(num_interp, 0.0);
+    EXPECT_GT(num_checks, 0.0);
+
+    // Clean up.
+    oskar_mem_free(l, &error);
+    oskar_mem_free(m, &error);
+    oskar_mem_free(n, &error);
+    oskar_mem_free(l_dev, &error);
+    oskar_mem_free(m_dev, &error);
+    oskar_mem_free(n_dev, &error);
+    oskar_mem_free(beam, &error);
+    oskar_station_work_free(work, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST(station_beam_time_interp, cache_keys)
+{
+    int error = 0;
+    const int prec = OSKAR_DOUBLE, num_pts = 64, num_times = 9;
+    const double frequency = 100e6;
+    const double start_mjd = 51544.5, inc_sec = 60.0;
+    oskar_Station* station = create_station(prec, -50.0 * D2R, &error);
+
+    // Make two sets of sources, which are copied in turn to the same
+    // memory, as the interferometer does with sky chunks.
+    oskar_Mem *lmn[2][3], *lmn_dev[3];
+    for (int i = 0; i < 2; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            lmn[i][j] = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+        oskar_evaluate_image_lmn_grid(8, 8, (10.0 + 20.0 * i) * D2R,
+                (10.0 + 20.0 * i) * D2R, 0,
+                lmn[i][0], lmn[i][1], lmn[i][2], &error);
+    }
+    for (int j = 0; j < 3; ++j)
+        lmn_dev[j] = oskar_mem_create(prec, device_loc, num_pts, &error);
+    const oskar_Mem* const source_coords[] = {
+            lmn_dev[0], lmn_dev[1], lmn_dev[2]};
+    oskar_Mem* beam_exact = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    oskar_Mem* beam_interp = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // Keep beams for both sets, using a different key for each.
+    oskar_StationWork* work_exact = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_StationWork* work_interp = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_station_work_set_beam_time_interp(work_interp, 4, 0.0,
+            1, 2, start_mjd, inc_sec, num_times);
+    for (int t = 0; t < num_times; ++t)
+    {
+        const double mjd = start_mjd + (t + 0.5) * inc_sec / 86400.0;
+        const double gast = oskar_convert_mjd_to_gast_fast(mjd);
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                oskar_mem_copy(lmn_dev[j], lmn[i][j], &error);
+            oskar_station_beam(station, work_exact, OSKAR_COORDS_REL_DIR,
+                    num_pts, source_coords, 0.0, -60.0 * D2R,
+                    OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                    t, gast, frequency, 0, beam_exact, &error);
+            oskar_station_work_set_beam_time_interp_key(work_interp, i + 1);
+            oskar_station_beam_time_interp(station, 0, work_interp,
+                    OSKAR_COORDS_REL_DIR, num_pts, source_coords,
+                    0.0, -60.0 * D2R, OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                    t, gast, frequency, 0, beam_interp, &error);
+            ASSERT_EQ(0, error) << oskar_get_error_string(error);
+            double peak = 0.0;
+            const double diff = max_abs_diff(beam_exact, beam_interp,
+                    &peak, &error);
+            EXPECT_LT(diff, 1e-2 * peak) << "Time " << t << ", set " << i;
+        }
+    }
+
+    // Each set needs its exact beams only once: three on the grid,
+    // and two to check the errors in the middle of each interval.
+    int step_used = 0;
+    double num_exact = 0.0, num_interp = 0.0, num_checks = 0.0;
+    double max_error = 0.0;
+    oskar_station_work_beam_time_interp_stats(work_interp, &step_used,
+            &num_exact, &num_interp, &num_checks, &max_error);
+    EXPECT_EQ(2.0 * (3 + 2), num_exact);
+
+    // Clean up.
+    for (int j = 0; j < 3; ++j)
+    {
+        oskar_mem_free(lmn[0][j], &error);
+        oskar_mem_free(lmn[1][j], &error);
+        oskar_mem_free(lmn_dev[j], &error);
+    }
+    oskar_mem_free(beam_exact, &error);
+    oskar_mem_free(beam_interp, &error);
+    oskar_station_work_free(work_exact, &error);
+    oskar_station_work_free(work_interp, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST(station_beam_time_interp, exact_beams_per_call)
+{
+    int error = 0;
+    const int prec = OSKAR_DOUBLE, num_pts = 64, num_times = 9;
+    const double frequency = 100e6;
+    const double start_mjd = 51544.5, inc_sec = 60.0;
+    oskar_Station* station = create_station(prec, -50.0 * D2R, &error);
+    oskar_Mem* lmn[3];
+    for (int j = 0; j < 3; ++j)
+        lmn[j] = oskar_mem_create(prec, OSKAR_CPU, num_pts, &error);
+    oskar_evaluate_image_lmn_grid(8, 8, 30.0 * D2R, 30.0 * D2R, 0,
+            lmn[0], lmn[1], lmn[2], &error);
+    oskar_Mem* lmn_dev[3];
+    for (int j = 0; j < 3; ++j)
+        lmn_dev[j] = oskar_mem_create_copy(lmn[j], device_loc, &error);
+    const oskar_Mem* const source_coords[] = {
+            lmn_dev[0], lmn_dev[1], lmn_dev[2]};
+    oskar_Mem* beam_exact = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    oskar_Mem* beam_interp = oskar_mem_create(prec | OSKAR_COMPLEX,
+            device_loc, num_pts, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+
+    // If the cached beams can never be used again, as for merged or
+    // changing sky chunks, each call must cost no more than one exact
+    // beam, and give the exact beam. The second pass alternates between
+    // two keys with room for only one of them.
+    oskar_StationWork* work_exact = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_StationWork* work_interp = oskar_station_work_create(prec,
+            device_loc, &error);
+    oskar_station_work_set_beam_time_interp(work_interp, 4, 0.0,
+            1, 1, start_mjd, inc_sec, num_times);
+    for (int pass = 0, key = 0; pass < 2; ++pass)
+    {
+        for (int t = 0; t < num_times; ++t)
+        {
+            const double mjd = start_mjd + (t + 0.5) * inc_sec / 86400.0;
+            const double gast = oskar_convert_mjd_to_gast_fast(mjd);
+            key = (pass == 0) ? key + 1 : 1 + t % 2;
+            int step_used = 0;
+            double num_exact[2], num_interp = 0.0, num_checks = 0.0;
+            double max_error = 0.0;
+            oskar_station_work_beam_time_interp_stats(work_interp,
+                    &step_used, &num_exact[0], &num_interp, &num_checks,
+                    &max_error);
+            oskar_station_work_set_beam_time_interp_key(work_interp, key);
+            oskar_station_beam_time_interp(station, 0, work_interp,
+                    OSKAR_COORDS_REL_DIR, num_pts, source_coords,
+                    0.0, -60.0 * D2R, OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                    t, gast, frequency, 0, beam_interp, &error);
+            oskar_station_beam(station, work_exact, OSKAR_COORDS_REL_DIR,
+                    num_pts, source_coords, 0.0, -60.0 * D2R,
+                    OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                    t, gast, frequency, 0, beam_exact, &error);
+            ASSERT_EQ(0, error) << oskar_get_error_string(error);
+            oskar_station_work_beam_time_interp_stats(work_interp,
+                    &step_used, &num_exact[1], &num_interp, &num_checks,
+                    &max_error);
+            EXPECT_EQ(1.0, num_exact[1] - num_exact[0])
+                    << "Pass " << pass << ", time " << t;
+            double peak = 0.0;
+            EXPECT_EQ(0.0, max_abs_diff(beam_exact, beam_interp,
+                    &peak, &error)) << "Pass " << pass << ", time " << t;
+        }
+    }
+
+    // Clean up.
+    for (int j = 0; j < 3; ++j)
+    {
+        oskar_mem_free(lmn[j], &error);
+        oskar_mem_free(lmn_dev[j], &error);
+    }
+    oskar_mem_free(beam_exact, &error);
+    oskar_mem_free(beam_interp, &error);
+    oskar_station_work_free(work_exact, &error);
+    oskar_station_work_free(work_interp, &error);
+    oskar_station_free(station, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
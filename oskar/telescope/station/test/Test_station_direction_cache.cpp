@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/oskar_station.h"
+#include "telescope/station/private_station_work.h"
+#include "convert/oskar_convert_mjd_to_gast_fast.h"
+#include "math/oskar_evaluate_image_lmn_grid.h"
+#include "math/oskar_linspace.h"
+#include "math/oskar_meshgrid.h"
+#include "utility/oskar_get_error_string.h"
+
+#include "math/oskar_cmath.h"
+#include <vector>
+
+#define D2R (M_PI / 180.0)
+
+#ifdef OSKAR_HAVE_CUDA
+static int device_loc = OSKAR_GPU;
+#else
+static int device_loc = OSKAR_CPU;
+#endif
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b,
+        int* status)
+{
+    oskar_Mem* a_ = oskar_mem_create_copy(a, OSKAR_CPU, status);
+    oskar_Mem* b_ = oskar_mem_create_copy(b, OSKAR_CPU, status);
+    const double2* pa = oskar_mem_double2_const(a_, status);
+    const double2* pb = oskar_mem_double2_const(b_, status);
+    const size_t num_elements = oskar_mem_length(a_);
+    double diff = 0.0;
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+        const double dx = pa[i].x - pb[i].x, dy = pa[i].y - pb[i].y;
+        const double d = sqrt(dx * dx + dy * dy);
+        if (d > diff) diff = d;
+    }
+    oskar_mem_free(a_, status);
+    oskar_mem_free(b_, status);
+    return diff;
+}
+
+class station_direction_cache : public ::testing::Test
+{
+protected:
+    static const int num_pts = 64;
+    int error;
+    oskar_Station* station;
+    oskar_StationWork *work_cache, *work_exact;
+    oskar_Mem *lmn[2][3], *lmn_dev[2][3], *beam, *beam_exact;
+
+    void SetUp()
+    {
+        error = 0;
+        const int prec = OSKAR_DOUBLE;
+
+        // Construct an aperture array station.
+        const int station_dim = 8;
+        const int num_antennas = station_dim * station_dim;
+        oskar_Station* station_cpu = oskar_station_create(prec,
+                OSKAR_CPU, num_antennas, &error);
+        oskar_station_resize_element_types(station_cpu, 1, &error);
+        oskar_station_set_position(station_cpu,
+                0.0, -50.0 * D2R, 0.0, 0.0, 0.0, 0.0);
+        oskar_station_set_phase_centre(station_cpu,
+                OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R);
+        oskar_element_set_element_type(
+                oskar_station_element(station_cpu, 0), "Isotropic", &error);
+        std::vector<double> x_pos(station_dim);
+        oskar_linspace_d(&x_pos[0], -14.0, 14.0, station_dim);
+        oskar_meshgrid_d(
+                oskar_mem_double(oskar_station_element_measured_enu_metres(
+                        station_cpu, 0, 0), &error),
+                oskar_mem_double(oskar_station_element_measured_enu_metres(
+                        station_cpu, 0, 1), &error),
+                &x_pos[0], station_dim, &x_pos[0], station_dim);
+        for (int i = 0; i < 2; ++i)
+            oskar_mem_copy(
+                    oskar_station_element_true_enu_metres(station_cpu, 0, i),
+                    oskar_station_element_measured_enu_metres(
+                            station_cpu, 0, i), &error);
+        station = oskar_station_create_copy(station_cpu, device_loc, &error);
+        oskar_station_free(station_cpu, &error);
+
+        // Make two sets of sources, as if from two sky chunks.
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                lmn[i][j] = oskar_mem_create(prec, OSKAR_CPU,
+                        num_pts, &error);
+            oskar_evaluate_image_lmn_grid(8, 8, (10.0 + 20.0 * i) * D2R,
+                    (10.0 + 20.0 * i) * D2R, 0,
+                    lmn[i][0], lmn[i][1], lmn[i][2], &error);
+            for (int j = 0; j < 3; ++j)
+                lmn_dev[i][j] = oskar_mem_create_copy(lmn[i][j],
+                        device_loc, &error);
+        }
+        beam = oskar_mem_create(prec | OSKAR_COMPLEX,
+                device_loc, num_pts, &error);
+        beam_exact = oskar_mem_create(prec | OSKAR_COMPLEX,
+                device_loc, num_pts, &error);
+
+        // Use a tolerance wide enough to reuse stale directions,
+        // so that only invalidation of the cache keeps them correct.
+        work_cache = oskar_station_work_create(prec, device_loc, &error);
+        work_exact = oskar_station_work_create(prec, device_loc, &error);
+        oskar_station_work_set_direction_cache(work_cache, 2, 0.1);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    }
+
+    void TearDown()
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                oskar_mem_free(lmn[i][j], &error);
+                oskar_mem_free(lmn_dev[i][j], &error);
+            }
+        }
+        oskar_mem_free(beam, &error);
+        oskar_mem_free(beam_exact, &error);
+        oskar_station_work_free(work_cache, &error);
+        oskar_station_work_free(work_exact, &error);
+        oskar_station_free(station, &error);
+        ASSERT_EQ(0, error) << oskar_get_error_string(error);
+    }
+
+    // Evaluates the beam with and without the cache,
+    // and returns the largest difference between them.
+    double evaluate(oskar_Mem* const coords[3], int time_index)
+    {
+        const double mjd = 51544.5 + (time_index + 0.5) * 60.0 / 86400.0;
+        const double gast = oskar_convert_mjd_to_gast_fast(mjd);
+        const oskar_Mem* const source_coords[] = {
+                coords[0], coords[1], coords[2]};
+        oskar_station_beam(station, work_cache, OSKAR_COORDS_REL_DIR,
+                num_pts, source_coords, 0.0, -60.0 * D2R,
+                OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                time_index, gast, 100e6, 0, beam, &error);
+        oskar_station_beam(station, work_exact, OSKAR_COORDS_REL_DIR,
+                num_pts, source_coords, 0.0, -60.0 * D2R,
+                OSKAR_COORDS_RADEC, 0.0, -60.0 * D2R,
+                time_index, gast, 100e6, 0, beam_exact, &error);
+        return max_abs_diff(beam, beam_exact, &error);
+    }
+};
+
+TEST_F(station_direction_cache, hit_and_miss)
+{
+    // The first call fills the cache, and the second hits it.
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 0));
+    ASSERT_EQ(1, work_cache->dir_num_groups);
+    oskar_Mem* beam_hit = oskar_mem_create_copy(beam, OSKAR_CPU, &error);
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 0));
+    EXPECT_EQ(1, work_cache->dir_num_groups);
+    EXPECT_EQ(0.0, max_abs_diff(beam, beam_hit, &error));
+
+    // Resetting the cache forces a miss, which gives the same beam.
+    oskar_station_work_set_direction_cache(work_cache, 2, 0.1);
+    EXPECT_EQ(0, work_cache->dir_num_groups);
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 0));
+    EXPECT_EQ(1, work_cache->dir_num_groups);
+    EXPECT_EQ(0.0, max_abs_diff(beam, beam_hit, &error));
+    oskar_mem_free(beam_hit, &error);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST_F(station_direction_cache, new_time_index)
+{
+    // The sidereal time moves by less than the tolerance,
+    // so the cached directions are correct only if discarded.
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 0));
+    EXPECT_EQ(0, work_cache->dir_time_index);
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 1));
+    EXPECT_EQ(1, work_cache->dir_time_index);
+    EXPECT_EQ(1, work_cache->dir_num_groups);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
+
+TEST_F(station_direction_cache, new_chunk)
+{
+    // Sources in different arrays.
+    EXPECT_EQ(0.0, evaluate(lmn_dev[0], 0));
+    EXPECT_EQ(0.0, evaluate(lmn_dev[1], 0));
+    EXPECT_EQ((const void*) lmn_dev[1][0], work_cache->dir_source);
+    EXPECT_EQ(1, work_cache->dir_num_groups);
+
+    // Sources copied into the same arrays, as done for each sky chunk,
+    // after which the cache must be reset by the caller.
+    for (int j = 0; j < 3; ++j)
+        oskar_mem_copy(lmn_dev[1][j], lmn[0][j], &error);
+    oskar_station_work_set_direction_cache(work_cache, 2, 0.1);
+    EXPECT_EQ(0, work_cache->dir_num_groups);
+    EXPECT_EQ(0.0, evaluate(lmn_dev[1], 0));
+    EXPECT_EQ(1, work_cache->dir_num_groups);
+    ASSERT_EQ(0, error) << oskar_get_error_string(error);
+}
@@ -377,6 +377,145 @@ TEST(telescope_model_load_save, test_2_level)
     oskar_dir_remove(tm);
 }
 
+TEST(telescope_model_load_save, test_snapshot)
+{
+    int err = 0;
+    const char* tm = "temp_test_telescope_snapshot";
+    const char* snapshot = ".oskar_telescope_snapshot.bin";
+
+    // Create and save a two-level telescope model.
+    int num_stations = 3, num_tiles = 4, num_elements = 8;
+    oskar_Telescope* telescope = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, num_stations, &err);
+    oskar_telescope_set_position(telescope, 0.1, 0.5, 1.0);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        double xyz[3];
+        xyz[0] = 1.0 * i;
+        xyz[1] = 2.0 * i;
+        xyz[2] = 3.0 * i;
+        oskar_Station* st = oskar_telescope_station(telescope, i);
+        oskar_telescope_set_station_coords(telescope, i,
+                xyz, xyz, xyz, xyz, &err);
+        oskar_station_resize(st, num_tiles, &err);
+        oskar_station_create_child_stations(st, &err);
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            xyz[0] = 10.0 * i + 1.0 * j;
+            xyz[1] = 20.0 * i + 1.0 * j;
+            xyz[2] = 30.0 * i + 1.0 * j;
+            oskar_station_set_element_coords(st, 0, j, xyz, xyz, &err);
+            oskar_station_resize(oskar_station_child(st, j), num_elements, &err);
+            for (int k = 0; k < num_elements; ++k)
+            {
+                xyz[0] = 100.0 * i + 10.0 * j + 1.0 * k;
+                xyz[1] = 200.0 * i + 10.0 * j + 1.0 * k;
+                xyz[2] = 300.0 * i + 10.0 * j + 1.0 * k;
+                oskar_station_set_element_coords(oskar_station_child(st, j), 0,
+                        k, xyz, xyz, &err);
+            }
+        }
+    }
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_save(telescope, tm, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_free(telescope, &err);
+
+    // Load it from the text files, which should write the snapshot.
+    oskar_Telescope* telescope1 = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(telescope1, 0);
+    oskar_telescope_set_enable_snapshot(telescope1, 1);
+    oskar_telescope_load(telescope1, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    ASSERT_TRUE(oskar_dir_file_exists(tm, snapshot));
+
+    // Load it again, this time from the snapshot.
+    oskar_Telescope* telescope2 = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(telescope2, 0);
+    oskar_telescope_set_enable_snapshot(telescope2, 1);
+    char* path = oskar_dir_get_path(tm, snapshot);
+    EXPECT_EQ(0, oskar_telescope_read_snapshot(telescope2, path,
+            "not the right key", &err));
+    free(path);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    EXPECT_EQ(0, oskar_telescope_num_stations(telescope2));
+    oskar_telescope_load(telescope2, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+
+    // Check the contents are identical.
+    ASSERT_EQ(num_stations, oskar_telescope_num_stations(telescope2));
+    EXPECT_DOUBLE_EQ(oskar_telescope_lon_rad(telescope1),
+            oskar_telescope_lon_rad(telescope2));
+    EXPECT_DOUBLE_EQ(oskar_telescope_lat_rad(telescope1),
+            oskar_telescope_lat_rad(telescope2));
+    for (int dim = 0; dim < 3; dim++)
+    {
+        EXPECT_FALSE(oskar_mem_different(
+                oskar_telescope_station_true_enu_metres(telescope1, dim),
+                oskar_telescope_station_true_enu_metres(telescope2, dim),
+                0, &err));
+    }
+    for (int i = 0; i < num_stations; ++i)
+    {
+        const oskar_Station* s1 = oskar_telescope_station_const(telescope1, i);
+        const oskar_Station* s2 = oskar_telescope_station_const(telescope2, i);
+        EXPECT_EQ(oskar_station_unique_id(s1), oskar_station_unique_id(s2));
+        EXPECT_FALSE(oskar_station_different(s1, s2, &err));
+        for (int j = 0; j < num_tiles; ++j)
+        {
+            EXPECT_FALSE(oskar_station_different(
+                    oskar_station_child_const(s1, j),
+                    oskar_station_child_const(s2, j), &err));
+        }
+    }
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    oskar_telescope_free(telescope1, &err);
+    oskar_telescope_free(telescope2, &err);
+
+    // Change the station layout: the snapshot must not be used.
+    path = oskar_dir_get_path(tm, "layout.txt");
+    FILE* f = fopen(path, "w");
+    for (int i = 0; i < num_stations; ++i)
+        fprintf(f, "%.1f, %.1f, %.1f\n", i * 15.0, i * 25.0, i * 35.0);
+    fclose(f);
+    free(path);
+    oskar_Telescope* telescope3 = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(telescope3, 0);
+    oskar_telescope_set_enable_snapshot(telescope3, 1);
+    oskar_telescope_load(telescope3, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    const double* x = oskar_mem_double_const(
+            oskar_telescope_station_true_enu_metres(telescope3, 0), &err);
+    EXPECT_DOUBLE_EQ(30.0, x[2]);
+    oskar_telescope_free(telescope3, &err);
+
+    // Change it again straight away, keeping the same file size.
+    // The snapshot must not be used, even if the modification time
+    // has not changed.
+    path = oskar_dir_get_path(tm, "layout.txt");
+    f = fopen(path, "w");
+    for (int i = 0; i < num_stations; ++i)
+        fprintf(f, "%.1f, %.1f, %.1f\n", i * 16.0, i * 26.0, i * 36.0);
+    fclose(f);
+    free(path);
+    oskar_Telescope* telescope4 = oskar_telescope_create(OSKAR_DOUBLE,
+            OSKAR_CPU, 0, &err);
+    oskar_telescope_set_enable_numerical_patterns(telescope4, 0);
+    oskar_telescope_set_enable_snapshot(telescope4, 1);
+    oskar_telescope_load(telescope4, tm, NULL, &err);
+    ASSERT_EQ(0, err) << oskar_get_error_string(err);
+    x = oskar_mem_double_const(
+            oskar_telescope_station_true_enu_metres(telescope4, 0), &err);
+    EXPECT_DOUBLE_EQ(32.0, x[2]);
+    oskar_telescope_free(telescope4, &err);
+
+    // Remove test directory.
+    oskar_dir_remove(tm);
+}
+
 //
 // TODO: check combinations of telescope model loading and overrides...
 //
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_FILE_MAP_H_
+#define OSKAR_FILE_MAP_H_
+
+/**
+ * @file oskar_file_map.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_FileMap;
+#ifndef OSKAR_FILE_MAP_TYPEDEF_
+#define OSKAR_FILE_MAP_TYPEDEF_
+typedef struct oskar_FileMap oskar_FileMap;
+#endif /* OSKAR_FILE_MAP_TYPEDEF_ */
+
+/**
+ * @brief Creates a file of the given size and maps it into memory.
+ *
+ * @details
+ * Any existing file with the same name is truncated.
+ * The mapping is readable and writable, and changes are written back
+ * to the file when it is unmapped or synchronised.
+ *
+ * @param[in] filename   Path of the file to create.
+ * @param[in] num_bytes  Size of the file, in bytes. Must be non-zero.
+ * @param[in,out] status Status return code.
+ *
+ * @return Handle to the mapped file, or NULL on failure.
+ */
+OSKAR_EXPORT
+oskar_FileMap* oskar_file_map_create(const char* filename, size_t num_bytes,
+        int* status);
+
+/**
+ * @brief Maps the whole of an existing file into memory.
+ *
+ * @param[in] filename   Path of the file to open.
+ * @param[in] writable   If true, the mapping is also writable.
+ * @param[in,out] status Status return code.
+ *
+ * @return Handle to the mapped file, or NULL on failure.
+ */
+OSKAR_EXPORT
+oskar_FileMap* oskar_file_map_open(const char* filename, int writable,
+        int* status);
+
+/**
+ * @brief Returns a pointer to the start of the mapped file contents.
+ */
+OSKAR_EXPORT
+void* oskar_file_map_data(oskar_FileMap* map);
+
+/**
+ * @brief Returns the size of the mapped file, in bytes.
+ */
+OSKAR_EXPORT
+size_t oskar_file_map_size(const oskar_FileMap* map);
+
+/**
+ * @brief Writes modified pages of a writable mapping back to the file.
+ *
+ * @param[in] map        Handle to the mapped file.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_file_map_sync(oskar_FileMap* map, int* status);
+
+/**
+ * @brief Unmaps and closes the file, and frees the handle.
+ *
+ * @param[in] map        Handle to the mapped file. May be NULL.
+ */
+OSKAR_EXPORT
+void oskar_file_map_free(oskar_FileMap* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -55,6 +55,8 @@
     if (I >= N) return;\
 
 #define KERNEL_LOOP_PAR_X(TYPE, I, OFFSET, N) KERNEL_LOOP_X(TYPE, I, OFFSET, N)
+#define KERNEL_LOOP_PAR_SIMD_X(TYPE, I, OFFSET, N)\
+    KERNEL_LOOP_X(TYPE, I, OFFSET, N)
 #define KERNEL_LOOP_END \
 
 #define LOCAL __shared__
@@ -173,6 +175,8 @@
     if (I >= N) return;\
 
 #define KERNEL_LOOP_PAR_X(TYPE, I, OFFSET, N) KERNEL_LOOP_X(TYPE, I, OFFSET, N)
+#define KERNEL_LOOP_PAR_SIMD_X(TYPE, I, OFFSET, N)\
+    KERNEL_LOOP_X(TYPE, I, OFFSET, N)
 #define KERNEL_LOOP_END \
 
 #define LOCAL local
@@ -233,11 +237,33 @@
     TYPE I;\
     for (I = OFFSET; I < N; I++) {\
 
+/* Loops with a large amount of work per iteration are always shared between
+ * threads. Element-wise loops are only split if there are at least 2048
+ * iterations per thread for two threads, as anything smaller costs more in
+ * fork/join overhead than it saves; they are also marked for vectorisation.
+ * The number of threads used is set by the caller (via omp_set_num_threads),
+ * so that simulator CPU devices can share the available cores. */
 #define KERNEL_LOOP_PAR_X(TYPE, I, OFFSET, N)\
     TYPE I;\
-    DO_PRAGMA(omp parallel for private(I))\
+    DO_PRAGMA(omp parallel for private(I) schedule(static)\
+            if((N) - (OFFSET) > 1))\
     for (I = OFFSET; I < N; I++) {\
 
+#if defined(_OPENMP) && _OPENMP >= 201511
+#define KERNEL_LOOP_PAR_SIMD_X(TYPE, I, OFFSET, N)\
+    TYPE I;\
+    DO_PRAGMA(omp parallel for simd schedule(static)\
+            if(parallel: (N) - (OFFSET) >= 4096))\
+    for (I = OFFSET; I < N; I++) {\
+
+#else
+#define KERNEL_LOOP_PAR_SIMD_X(TYPE, I, OFFSET, N)\
+    TYPE I;\
+    DO_PRAGMA(omp parallel for private(I) schedule(static)\
+            if((N) - (OFFSET) >= 4096))\
+    for (I = OFFSET; I < N; I++) {\
+
+#endif
 #define KERNEL_LOOP_END }\
 
 #define LOCAL
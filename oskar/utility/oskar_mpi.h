@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_MPI_H_
+#define OSKAR_MPI_H_
+
+/**
+ * @file oskar_mpi.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialises MPI, if OSKAR was built with MPI support.
+ *
+ * @details
+ * Applications that can be distributed over multiple processes should
+ * call this function at the start of main(), and call
+ * oskar_mpi_finalise() before returning.
+ *
+ * If OSKAR was built without MPI support, this function does nothing.
+ *
+ * The error code OSKAR_ERR_MPI_THREAD_SUPPORT is returned if running
+ * with more than one process and the MPI library does not provide
+ * at least MPI_THREAD_SERIALIZED, as blocks are received by a separate
+ * thread. All processes will then return the same error, and should exit.
+ *
+ * @param[in,out] argc    Pointer to argc from main().
+ * @param[in,out] argv    Pointer to argv from main().
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_init(int* argc, char*** argv, int* status);
+
+/**
+ * @brief Finalises MPI, if it was initialised by oskar_mpi_init().
+ */
+OSKAR_EXPORT
+void oskar_mpi_finalise(void);
+
+/**
+ * @brief Terminates all processes, if running with more than one.
+ *
+ * @details
+ * This should be called if an error occurs on any process, so that the
+ * others do not wait forever for data that will never arrive.
+ *
+ * @param[in] error_code  The error code to return.
+ */
+OSKAR_EXPORT
+void oskar_mpi_abort(int error_code);
+
+/**
+ * @brief Returns the index of this process.
+ *
+ * @details
+ * Returns the rank of this process in MPI_COMM_WORLD,
+ * or 0 if MPI is not available or has not been initialised.
+ */
+OSKAR_EXPORT
+int oskar_mpi_rank(void);
+
+/**
+ * @brief Returns the number of processes.
+ *
+ * @details
+ * Returns the size of MPI_COMM_WORLD,
+ * or 1 if MPI is not available or has not been initialised.
+ */
+OSKAR_EXPORT
+int oskar_mpi_size(void);
+
+/**
+ * @brief Broadcasts a block of bytes from one process to all others.
+ *
+ * @param[in,out] data  Data to send (on root) or receive (on all others).
+ * @param[in] size      Number of bytes.
+ * @param[in] root      Rank of the sending process.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_bcast(void* data, size_t size, int root, int* status);
+
+/**
+ * @brief Replaces a value on all processes with the smallest of them.
+ *
+ * @details
+ * This must be called by all processes. As error codes are negative, it can
+ * be used to share an error from any process with all others, so that they
+ * can stop together.
+ *
+ * @param[in,out] value   Value to combine.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_allreduce_min_int(int* value, int* status);
+
+/**
+ * @brief Broadcasts the contents of an array from one process to all others.
+ *
+ * @details
+ * The array is resized on all receiving processes to match the one on
+ * the root process. Arrays must be in CPU memory, and have the same
+ * data type on all processes.
+ *
+ * @param[in,out] mem   Array to send (on root) or receive (on all others).
+ * @param[in] root      Rank of the sending process.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_bcast_mem(oskar_Mem* mem, int root, int* status);
+
+/**
+ * @brief Broadcasts the contents of a file from one process to all others.
+ *
+ * @details
+ * The file @p filename_root is read on the root process, and its contents
+ * are written to @p filename on every other process.
+ *
+ * @param[in] filename_root  Name of the file to read on the root process.
+ * @param[in] filename       Name of the file to write on other processes.
+ * @param[in] root           Rank of the sending process.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_bcast_file(const char* filename_root, const char* filename,
+        int root, int* status);
+
+/**
+ * @brief Sends the first @p num_elements of an array to another process.
+ *
+ * @param[in] mem           Array to send, in CPU memory.
+ * @param[in] num_elements  Number of elements to send.
+ * @param[in] dest          Rank of the receiving process.
+ * @param[in] tag           Message tag.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_send_mem(const oskar_Mem* mem, size_t num_elements,
+        int dest, int tag, int* status);
+
+/**
+ * @brief Receives the first @p num_elements of an array from another process.
+ *
+ * @param[in,out] mem       Array to fill, in CPU memory.
+ * @param[in] num_elements  Number of elements to receive.
+ * @param[in] source        Rank of the sending process.
+ * @param[in] tag           Message tag.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_recv_mem(oskar_Mem* mem, size_t num_elements,
+        int source, int tag, int* status);
+
+/**
+ * @brief Sends an array of integers to another process.
+ *
+ * @param[in] values   Values to send.
+ * @param[in] count    Number of values.
+ * @param[in] dest     Rank of the receiving process.
+ * @param[in] tag      Message tag.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_send_int(const int* values, int count, int dest, int tag,
+        int* status);
+
+/**
+ * @brief Receives an array of integers from another process.
+ *
+ * @param[out] values  Values received.
+ * @param[in] count    Number of values.
+ * @param[in] source   Rank of the sending process.
+ * @param[in] tag      Message tag.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mpi_recv_int(int* values, int count, int source, int tag,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -142,6 +142,20 @@ void oskar_timer_resume(oskar_Timer* timer);
 OSKAR_EXPORT
 void oskar_timer_restart(oskar_Timer* timer);
 
+/**
+ * @brief Sets the name of the timer, used in performance traces.
+ *
+ * @details
+ * If a timer has a name, each interval it measures is recorded as an
+ * event while tracing is enabled (see oskar_trace.h).
+ * Timers without a name are not traced.
+ *
+ * @param[in,out] timer Pointer to timer.
+ * @param[in] name      Name of the timer. Must be a string literal.
+ */
+OSKAR_EXPORT
+void oskar_timer_set_name(oskar_Timer* timer, const char* name);
+
 /**
  * @brief Starts and resets the timer.
  *
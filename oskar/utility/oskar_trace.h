@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TRACE_H_
+#define OSKAR_TRACE_H_
+
+/**
+ * @file oskar_trace.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum OSKAR_TRACE_CONTEXT
+{
+    OSKAR_TRACE_DEVICE = 0,
+    OSKAR_TRACE_BLOCK = 1,
+    OSKAR_TRACE_TIME = 2,
+    OSKAR_TRACE_CHUNK = 3,
+    OSKAR_TRACE_CHANNEL = 4,
+    OSKAR_TRACE_NUM_CONTEXTS = 5
+};
+
+/**
+ * @brief Enables or disables recording of performance trace events.
+ *
+ * @details
+ * While enabled, every interval measured by a named timer
+ * (see oskar_timer_set_name()) is recorded as an event, together with
+ * the work unit that the calling thread has set using
+ * oskar_trace_set_context().
+ *
+ * Each thread records into its own ring buffer, so recording needs
+ * no locks. If a buffer fills, its oldest events are overwritten.
+ *
+ * Enabling the trace discards any events already recorded.
+ *
+ * @param[in] value If true, enable recording; if false, disable it.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_enabled(int value);
+
+/**
+ * @brief Returns true if trace events are being recorded.
+ */
+OSKAR_EXPORT
+int oskar_trace_enabled(void);
+
+/**
+ * @brief Returns the current time on the trace clock, in seconds.
+ */
+OSKAR_EXPORT
+double oskar_trace_time(void);
+
+/**
+ * @brief Sets part of the work unit context of the calling thread.
+ *
+ * @details
+ * The context is attached to subsequent events recorded by the calling
+ * thread. Negative values mean the item does not apply.
+ *
+ * @param[in] item   Enumerated context item (OSKAR_TRACE_DEVICE, etc.)
+ * @param[in] value  Value of the item, or -1 to clear it.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_context(int item, int value);
+
+/**
+ * @brief Records an event on the calling thread.
+ *
+ * @details
+ * Does nothing unless recording is enabled.
+ *
+ * @param[in] name   Name of the event. Must be a string literal,
+ *                   or remain valid until the trace is written.
+ * @param[in] start  Start time of the event, from oskar_trace_time().
+ * @param[in] end    End time of the event, from oskar_trace_time().
+ */
+OSKAR_EXPORT
+void oskar_trace_event(const char* name, double start, double end);
+
+/**
+ * @brief Writes all recorded events to a file.
+ *
+ * @details
+ * Events are written in Chrome trace (JSON) format, which can be
+ * viewed using Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+ * Events from each compute device are shown on their own track.
+ *
+ * This must not be called while other threads are recording events.
+ *
+ * @param[in] filename     Name of the file to write.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_write(const char* filename, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_TRACE_H_ */
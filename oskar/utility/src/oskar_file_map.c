@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "utility/oskar_file_map.h"
+
+#include <stdlib.h>
+
+#ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_FileMap
+{
+    void* data;
+    size_t size;
+#ifdef OSKAR_OS_WIN
+    HANDLE file, mapping;
+#else
+    int fd;
+#endif
+};
+
+static oskar_FileMap* map_file(const char* filename, int create,
+        int writable, size_t num_bytes, int* status)
+{
+    oskar_FileMap* map = 0;
+    if (*status) return 0;
+    if (!filename || !filename[0] || (create && num_bytes == 0))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    map = (oskar_FileMap*) calloc(1, sizeof(oskar_FileMap));
+#ifdef OSKAR_OS_WIN
+    {
+        LARGE_INTEGER size;
+        map->file = CreateFileA(filename,
+                writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                FILE_SHARE_READ, 0, create ? CREATE_ALWAYS : OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, 0);
+        if (map->file == INVALID_HANDLE_VALUE)
+        {
+            free(map);
+            *status = OSKAR_ERR_FILE_IO;
+            return 0;
+        }
+        if (create)
+        {
+            size.QuadPart = (LONGLONG) num_bytes;
+            if (!SetFilePointerEx(map->file, size, 0, FILE_BEGIN) ||
+                    !SetEndOfFile(map->file))
+                *status = OSKAR_ERR_FILE_IO;
+        }
+        else if (!GetFileSizeEx(map->file, &size) || size.QuadPart == 0)
+            *status = OSKAR_ERR_FILE_IO;
+        map->size = (size_t) size.QuadPart;
+        if (!*status)
+            map->mapping = CreateFileMappingA(map->file, 0,
+                    writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, 0);
+        if (map->mapping)
+            map->data = MapViewOfFile(map->mapping,
+                    writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    {
+        struct stat st;
+        map->fd = open(filename, writable ?
+                (O_RDWR | (create ? (O_CREAT | O_TRUNC) : 0)) : O_RDONLY,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (map->fd == -1)
+        {
+            free(map);
+            *status = OSKAR_ERR_FILE_IO;
+            return 0;
+        }
+        if (create)
+        {
+            if (ftruncate(map->fd, (off_t) num_bytes) != 0)
+                *status = OSKAR_ERR_FILE_IO;
+            map->size = num_bytes;
+        }
+        else
+        {
+            if (fstat(map->fd, &st) != 0 || st.st_size == 0)
+                *status = OSKAR_ERR_FILE_IO;
+            else
+                map->size = (size_t) st.st_size;
+        }
+        if (!*status)
+        {
+            map->data = mmap(0, map->size,
+                    writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                    MAP_SHARED, map->fd, 0);
+            if (map->data == MAP_FAILED) map->data = 0;
+        }
+    }
+#endif
+    if (!map->data)
+    {
+        if (!*status) *status = OSKAR_ERR_FILE_IO;
+        oskar_file_map_free(map);
+        return 0;
+    }
+    return map;
+}
+
+oskar_FileMap* oskar_file_map_create(const char* filename, size_t num_bytes,
+        int* status)
+{
+    return map_file(filename, 1, 1, num_bytes, status);
+}
+
+oskar_FileMap* oskar_file_map_open(const char* filename, int writable,
+        int* status)
+{
+    return map_file(filename, 0, writable, 0, status);
+}
+
+void* oskar_file_map_data(oskar_FileMap* map)
+{
+    return map ? map->data : 0;
+}
+
+size_t oskar_file_map_size(const oskar_FileMap* map)
+{
+    return map ? map->size : 0;
+}
+
+void oskar_file_map_sync(oskar_FileMap* map, int* status)
+{
+    if (*status || !map || !map->data) return;
+#ifdef OSKAR_OS_WIN
+    if (!FlushViewOfFile(map->data, 0)) *status = OSKAR_ERR_FILE_IO;
+#else
+    if (msync(map->data, map->size, MS_SYNC) != 0) *status = OSKAR_ERR_FILE_IO;
+#endif
+}
+
+void oskar_file_map_free(oskar_FileMap* map)
+{
+    if (!map) return;
+#ifdef OSKAR_OS_WIN
+    if (map->data) UnmapViewOfFile(map->data);
+    if (map->mapping) CloseHandle(map->mapping);
+    if (map->file != INVALID_HANDLE_VALUE) CloseHandle(map->file);
+#else
+    if (map->data) munmap(map->data, map->size);
+    if (map->fd != -1) close(map->fd);
+#endif
+    free(map);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -90,6 +90,9 @@ const char* oskar_get_error_string(int error)
     case OSKAR_ERR_BAD_COORD_FILE:         return "bad coordinate file";
     case OSKAR_ERR_BAD_GSM_FILE:           return "bad Global Sky Model file";
     case OSKAR_ERR_FFT_FAILED:             return "FFT failed";
+    case OSKAR_ERR_MPI_FAILED:             return "MPI communication failed";
+    case OSKAR_ERR_MPI_THREAD_SUPPORT:
+        return "MPI library does not support MPI_THREAD_SERIALIZED";
 
     /* OSKAR binary file errors. */
     case OSKAR_ERR_BINARY_OPEN_FAIL:       return "binary file open failed";
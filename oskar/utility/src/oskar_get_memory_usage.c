@@ -27,6 +27,7 @@
  */
 
 #include "utility/oskar_get_memory_usage.h"
+#include "mem/oskar_mem_pool.h"
 
 #include <stdio.h>
 #include <stddef.h>
@@ -258,6 +259,20 @@ void oskar_log_mem(oskar_Log* log)
     oskar_log_message(log, 'M', 0,
             "System memory used by current process: %.1f MB.",
             (double) mem_resident / (1024. * 1024.));
+    if (oskar_mem_pool_enabled())
+    {
+        size_t num_allocs = 0, num_reused = 0, num_in_place = 0;
+        size_t bytes_cached = 0, bytes_peak = 0;
+        oskar_mem_pool_counters(&num_allocs, &num_reused, &num_in_place,
+                &bytes_cached, &bytes_peak);
+        oskar_log_message(log, 'M', 0, "Memory pool: %lu allocations, "
+                "%lu reused, %lu resized in place.",
+                (unsigned long) num_allocs, (unsigned long) num_reused,
+                (unsigned long) num_in_place);
+        oskar_log_message(log, 'M', 0, "Memory pool: %.1f MB peak, "
+                "%.1f MB cached.", (double) bytes_peak / (1024. * 1024.),
+                (double) bytes_cached / (1024. * 1024.));
+    }
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "utility/oskar_mpi.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef OSKAR_HAVE_MPI
+#include <mpi.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest number of bytes to pass in a single MPI call. */
+#define MAX_CHUNK_BYTES ((size_t) INT_MAX)
+
+#ifdef OSKAR_HAVE_MPI
+static int initialised_here = 0;
+
+static int mpi_is_active(void)
+{
+    int initialised = 0, finalised = 0;
+    MPI_Initialized(&initialised);
+    MPI_Finalized(&finalised);
+    return initialised && !finalised;
+}
+#endif
+
+void oskar_mpi_init(int* argc, char*** argv, int* status)
+{
+#ifdef OSKAR_HAVE_MPI
+    int initialised = 0, provided = 0;
+    if (*status) return;
+    MPI_Initialized(&initialised);
+    if (!initialised)
+    {
+        MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided);
+        initialised_here = 1;
+    }
+    else MPI_Query_thread(&provided);
+
+    /* Blocks are received by the writer thread while other threads run,
+     * so distributed runs need at least MPI_THREAD_SERIALIZED. */
+    if (provided < MPI_THREAD_SERIALIZED && oskar_mpi_size() > 1)
+        *status = OSKAR_ERR_MPI_THREAD_SUPPORT;
+#else
+    (void) argc;
+    (void) argv;
+    (void) status;
+#endif
+}
+
+void oskar_mpi_finalise(void)
+{
+#ifdef OSKAR_HAVE_MPI
+    if (initialised_here && mpi_is_active()) MPI_Finalize();
+    initialised_here = 0;
+#endif
+}
+
+void oskar_mpi_abort(int error_code)
+{
+#ifdef OSKAR_HAVE_MPI
+    if (oskar_mpi_size() > 1) MPI_Abort(MPI_COMM_WORLD, error_code);
+#else
+    (void) error_code;
+#endif
+}
+
+int oskar_mpi_rank(void)
+{
+    int rank = 0;
+#ifdef OSKAR_HAVE_MPI
+    if (mpi_is_active()) MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    return rank;
+}
+
+int oskar_mpi_size(void)
+{
+    int size = 1;
+#ifdef OSKAR_HAVE_MPI
+    if (mpi_is_active()) MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+    return size;
+}
+
+void oskar_mpi_bcast(void* data, size_t size, int root, int* status)
+{
+    if (*status || oskar_mpi_size() == 1) return;
+#ifdef OSKAR_HAVE_MPI
+    {
+        size_t offset = 0;
+        while (offset < size)
+        {
+            size_t chunk = size - offset;
+            if (chunk > MAX_CHUNK_BYTES) chunk = MAX_CHUNK_BYTES;
+            if (MPI_Bcast((char*)data + offset, (int) chunk, MPI_BYTE,
+                    root, MPI_COMM_WORLD) != MPI_SUCCESS)
+            {
+                *status = OSKAR_ERR_MPI_FAILED;
+                return;
+            }
+            offset += chunk;
+        }
+    }
+#else
+    (void) data;
+    (void) size;
+    (void) root;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+void oskar_mpi_allreduce_min_int(int* value, int* status)
+{
+    if (*status || oskar_mpi_size() == 1) return;
+#ifdef OSKAR_HAVE_MPI
+    if (MPI_Allreduce(MPI_IN_PLACE, value, 1, MPI_INT, MPI_MIN,
+            MPI_COMM_WORLD) != MPI_SUCCESS)
+        *status = OSKAR_ERR_MPI_FAILED;
+#else
+    (void) value;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+void oskar_mpi_bcast_mem(oskar_Mem* mem, int root, int* status)
+{
+    int alloc_status = 0;
+    unsigned long long length = 0;
+    if (*status || oskar_mpi_size() == 1) return;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    length = (unsigned long long) oskar_mem_length(mem);
+    oskar_mpi_bcast(&length, sizeof(length), root, status);
+
+    /* Resize the array, and check it worked on all processes before
+     * broadcasting the contents, so that all processes fail together. */
+    if (oskar_mpi_rank() != root)
+        oskar_mem_realloc(mem, (size_t) length, &alloc_status);
+    oskar_mpi_allreduce_min_int(&alloc_status, status);
+    if (!*status) *status = alloc_status;
+    if (*status || length == 0) return;
+    oskar_mpi_bcast(oskar_mem_void(mem),
+            (size_t) length * oskar_mem_element_size(oskar_mem_type(mem)),
+            root, status);
+}
+
+void oskar_mpi_bcast_file(const char* filename_root, const char* filename,
+        int root, int* status)
+{
+    FILE* file = 0;
+    char* data = 0;
+    unsigned long long size = 0;
+    int file_status = 0;
+    if (*status || oskar_mpi_size() == 1) return;
+    const int is_root = (oskar_mpi_rank() == root);
+
+    /* Read the file on the root process. */
+    if (is_root)
+    {
+        file = fopen(filename_root, "rb");
+        if (file)
+        {
+            fseek(file, 0, SEEK_END);
+            size = (unsigned long long) ftell(file);
+            fseek(file, 0, SEEK_SET);
+            data = (char*) malloc(size > 0 ? (size_t) size : 1);
+            if (!data || fread(data, 1, (size_t) size, file) != size)
+                file_status = OSKAR_ERR_FILE_IO;
+            fclose(file);
+        }
+        else file_status = OSKAR_ERR_FILE_IO;
+    }
+
+    /* Broadcast the read status, so that all processes fail together. */
+    oskar_mpi_bcast(&file_status, sizeof(int), root, status);
+    if (*status || file_status)
+    {
+        if (!*status) *status = file_status;
+        free(data);
+        return;
+    }
+
+    /* Allocate space for the contents, and check it worked on all
+     * processes before broadcasting them, so that all processes fail
+     * together rather than some waiting for a broadcast that never comes. */
+    oskar_mpi_bcast(&size, sizeof(size), root, status);
+    if (!is_root)
+    {
+        data = (char*) malloc(size > 0 ? (size_t) size : 1);
+        if (!data) file_status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    }
+    oskar_mpi_allreduce_min_int(&file_status, status);
+    if (*status || file_status)
+    {
+        if (!*status) *status = file_status;
+        free(data);
+        return;
+    }
+    oskar_mpi_bcast(data, (size_t) size, root, status);
+
+    /* Write the file on all other processes. */
+    if (!is_root && !*status)
+    {
+        file = fopen(filename, "wb");
+        if (!file || fwrite(data, 1, (size_t) size, file) != size)
+            *status = OSKAR_ERR_FILE_IO;
+        if (file) fclose(file);
+    }
+    free(data);
+}
+
+void oskar_mpi_send_mem(const oskar_Mem* mem, size_t num_elements,
+        int dest, int tag, int* status)
+{
+    if (*status) return;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (num_elements > oskar_mem_length(mem))
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+#ifdef OSKAR_HAVE_MPI
+    {
+        size_t offset = 0;
+        const size_t size = num_elements *
+                oskar_mem_element_size(oskar_mem_type(mem));
+        const char* data = (const char*) oskar_mem_void_const(mem);
+        while (offset < size)
+        {
+            size_t chunk = size - offset;
+            if (chunk > MAX_CHUNK_BYTES) chunk = MAX_CHUNK_BYTES;
+            if (MPI_Send(data + offset, (int) chunk, MPI_BYTE,
+                    dest, tag, MPI_COMM_WORLD) != MPI_SUCCESS)
+            {
+                *status = OSKAR_ERR_MPI_FAILED;
+                return;
+            }
+            offset += chunk;
+        }
+    }
+#else
+    (void) dest;
+    (void) tag;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+void oskar_mpi_recv_mem(oskar_Mem* mem, size_t num_elements,
+        int source, int tag, int* status)
+{
+    if (*status) return;
+    if (oskar_mem_location(mem) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (num_elements > oskar_mem_length(mem))
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+#ifdef OSKAR_HAVE_MPI
+    {
+        size_t offset = 0;
+        const size_t size = num_elements *
+                oskar_mem_element_size(oskar_mem_type(mem));
+        char* data = (char*) oskar_mem_void(mem);
+        while (offset < size)
+        {
+            size_t chunk = size - offset;
+            if (chunk > MAX_CHUNK_BYTES) chunk = MAX_CHUNK_BYTES;
+            if (MPI_Recv(data + offset, (int) chunk, MPI_BYTE,
+                    source, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE) !=
+                    MPI_SUCCESS)
+            {
+                *status = OSKAR_ERR_MPI_FAILED;
+                return;
+            }
+            offset += chunk;
+        }
+    }
+#else
+    (void) source;
+    (void) tag;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+void oskar_mpi_send_int(const int* values, int count, int dest, int tag,
+        int* status)
+{
+    if (*status) return;
+#ifdef OSKAR_HAVE_MPI
+    if (MPI_Send(values, count, MPI_INT, dest, tag, MPI_COMM_WORLD) !=
+            MPI_SUCCESS)
+        *status = OSKAR_ERR_MPI_FAILED;
+#else
+    (void) values;
+    (void) count;
+    (void) dest;
+    (void) tag;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+void oskar_mpi_recv_int(int* values, int count, int source, int tag,
+        int* status)
+{
+    if (*status) return;
+#ifdef OSKAR_HAVE_MPI
+    if (MPI_Recv(values, count, MPI_INT, source, tag, MPI_COMM_WORLD,
+            MPI_STATUS_IGNORE) != MPI_SUCCESS)
+        *status = OSKAR_ERR_MPI_FAILED;
+#else
+    (void) values;
+    (void) count;
+    (void) source;
+    (void) tag;
+    *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,6 +29,7 @@
 #include "utility/oskar_device.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
@@ -62,7 +63,8 @@ struct oskar_Timer
 #ifdef OSKAR_HAVE_CUDA
     cudaEvent_t start_cuda, end_cuda;
 #endif
-    double start, elapsed;
+    double start, elapsed, trace_start;
+    const char* name;
 #ifdef OSKAR_OS_WIN
     double freq;
 #endif
@@ -188,6 +190,9 @@ void oskar_timer_pause(oskar_Timer* timer)
     if (timer->paused) return;
     (void)oskar_timer_elapsed(timer);
     timer->paused = 1;
+    if (timer->name && timer->trace_start > 0.0 && oskar_trace_enabled())
+        oskar_trace_event(timer->name, timer->trace_start, oskar_trace_time());
+    timer->trace_start = 0.0;
 }
 
 void oskar_timer_reset(oskar_Timer* timer)
@@ -208,6 +213,8 @@ void oskar_timer_resume(oskar_Timer* timer)
 void oskar_timer_restart(oskar_Timer* timer)
 {
     timer->paused = 0;
+    if (timer->name && oskar_trace_enabled())
+        timer->trace_start = oskar_trace_time();
 #ifdef OSKAR_HAVE_CUDA
     if (timer->type == OSKAR_TIMER_CUDA)
     {
@@ -218,6 +225,11 @@ void oskar_timer_restart(oskar_Timer* timer)
     timer->start = oskar_get_wtime(timer);
 }
 
+void oskar_timer_set_name(oskar_Timer* timer, const char* name)
+{
+    timer->name = name;
+}
+
 void oskar_timer_start(oskar_Timer* timer)
 {
     timer->elapsed = 0.0;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "utility/oskar_trace.h"
+#include "utility/oskar_mpi.h"
+#include "utility/oskar_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef OSKAR_OS_WIN
+#include <sys/time.h>
+#include <unistd.h>
+#define THREAD_LOCAL __thread
+#else
+#include <windows.h>
+#define THREAD_LOCAL __declspec(thread)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of events kept per thread. */
+#define TRACE_BUFFER_SIZE 65536
+
+typedef struct TraceEvent
+{
+    const char* name;
+    double start, end;
+    int context[OSKAR_TRACE_NUM_CONTEXTS];
+} TraceEvent;
+
+typedef struct TraceBuffer
+{
+    TraceEvent* events;
+    size_t num_recorded;
+    int thread_index;
+} TraceBuffer;
+
+static volatile int enabled_ = 0;
+static int generation_ = 0;
+static double time_origin_ = 0.0;
+static int num_buffers_ = 0;
+static TraceBuffer** buffers_ = 0;
+static oskar_Mutex* mutex_ = 0;
+static THREAD_LOCAL TraceBuffer* buffer_ = 0;
+static THREAD_LOCAL int buffer_generation_ = -1;
+static THREAD_LOCAL int context_[OSKAR_TRACE_NUM_CONTEXTS] =
+        {-1, -1, -1, -1, -1};
+
+static void free_buffers(void)
+{
+    int i;
+    for (i = 0; i < num_buffers_; ++i)
+    {
+        free(buffers_[i]->events);
+        free(buffers_[i]);
+    }
+    free(buffers_);
+    buffers_ = 0;
+    num_buffers_ = 0;
+}
+
+void oskar_trace_set_enabled(int value)
+{
+    /* Called from the main thread, before any worker threads start. */
+    if (!mutex_) mutex_ = oskar_mutex_create();
+    oskar_mutex_lock(mutex_);
+    if (value && !enabled_)
+    {
+        free_buffers();
+        generation_++;
+        time_origin_ = oskar_trace_time();
+    }
+    enabled_ = value;
+    oskar_mutex_unlock(mutex_);
+}
+
+int oskar_trace_enabled(void)
+{
+    return enabled_;
+}
+
+double oskar_trace_time(void)
+{
+#if defined(OSKAR_OS_WIN)
+    LARGE_INTEGER cntr, freq;
+    QueryPerformanceCounter(&cntr);
+    QueryPerformanceFrequency(&freq);
+    return (double)(cntr.QuadPart) / (double)(freq.QuadPart);
+#elif _POSIX_MONOTONIC_CLOCK > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+void oskar_trace_set_context(int item, int value)
+{
+    if (item >= 0 && item < OSKAR_TRACE_NUM_CONTEXTS)
+        context_[item] = value;
+}
+
+void oskar_trace_event(const char* name, double start, double end)
+{
+    int i;
+    TraceEvent* event;
+    if (!enabled_) return;
+
+    /* Register a buffer for this thread on its first event. */
+    if (!buffer_ || buffer_generation_ != generation_)
+    {
+        TraceBuffer* b = (TraceBuffer*) calloc(1, sizeof(TraceBuffer));
+        if (!b) return;
+        b->events = (TraceEvent*) malloc(
+                TRACE_BUFFER_SIZE * sizeof(TraceEvent));
+        if (!b->events)
+        {
+            free(b);
+            return;
+        }
+        oskar_mutex_lock(mutex_);
+        b->thread_index = num_buffers_;
+        buffers_ = (TraceBuffer**) realloc(buffers_,
+                (num_buffers_ + 1) * sizeof(TraceBuffer*));
+        buffers_[num_buffers_++] = b;
+        buffer_generation_ = generation_;
+        oskar_mutex_unlock(mutex_);
+        buffer_ = b;
+    }
+
+    /* Record the event, overwriting the oldest if the buffer is full. */
+    event = &buffer_->events[buffer_->num_recorded % TRACE_BUFFER_SIZE];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    for (i = 0; i < OSKAR_TRACE_NUM_CONTEXTS; ++i)
+        event->context[i] = context_[i];
+    buffer_->num_recorded++;
+}
+
+void oskar_trace_write(const char* filename, int* status)
+{
+    int i, first = 1;
+    FILE* file;
+    static const char* context_names[] = {
+            "device", "block", "time", "chunk", "channel"
+    };
+    if (*status || !filename || !filename[0]) return;
+    file = fopen(filename, "w");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+
+    /* Write events in Chrome trace format, with times in microseconds.
+     * Each device has its own track. Other threads are shown after them. */
+    const int pid = oskar_mpi_rank();
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    if (mutex_) oskar_mutex_lock(mutex_);
+    for (i = 0; i < num_buffers_; ++i)
+    {
+        size_t j, num_events, start_index;
+        const TraceBuffer* b = buffers_[i];
+        num_events = b->num_recorded < TRACE_BUFFER_SIZE ?
+                b->num_recorded : TRACE_BUFFER_SIZE;
+        start_index = b->num_recorded - num_events;
+        for (j = start_index; j < b->num_recorded; ++j)
+        {
+            int k, num_args;
+            const TraceEvent* e = &b->events[j % TRACE_BUFFER_SIZE];
+            const int device = e->context[OSKAR_TRACE_DEVICE];
+            const int tid = device >= 0 ? device : 1000 + b->thread_index;
+            fprintf(file, "%s{\"name\": \"%s\", \"cat\": \"oskar\", "
+                    "\"ph\": \"X\", \"pid\": %d, \"tid\": %d, "
+                    "\"ts\": %.3f, \"dur\": %.3f, \"args\": {",
+                    first ? "" : ",\n", e->name, pid, tid,
+                    (e->start - time_origin_) * 1e6,
+                    (e->end - e->start) * 1e6);
+            first = 0;
+            for (k = 0, num_args = 0; k < OSKAR_TRACE_NUM_CONTEXTS; ++k)
+            {
+                if (e->context[k] < 0) continue;
+                fprintf(file, "%s\"%s\": %d", num_args++ > 0 ? ", " : "",
+                        context_names[k], e->context[k]);
+            }
+            fprintf(file, "}}");
+        }
+
+        /* Name the track. */
+        if (num_events > 0)
+        {
+            const int device = b->events[start_index % TRACE_BUFFER_SIZE].
+                    context[OSKAR_TRACE_DEVICE];
+            if (device >= 0)
+                fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                        "\"pid\": %d, \"tid\": %d, "
+                        "\"args\": {\"name\": \"Device %d\"}}",
+                        pid, device, device);
+            else
+                fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+                        "\"pid\": %d, \"tid\": %d, "
+                        "\"args\": {\"name\": \"Thread %d\"}}",
+                        pid, 1000 + b->thread_index, b->thread_index);
+        }
+    }
+    if (mutex_) oskar_mutex_unlock(mutex_);
+    fprintf(file, "\n]}\n");
+    fclose(file);
+}
+
+#ifdef __cplusplus
+}
+#endif
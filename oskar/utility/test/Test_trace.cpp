@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_thread.h"
+#include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+struct TraceThreadArgs
+{
+    int device;
+};
+
+static void* run_stages(void* arg)
+{
+    const int device = ((TraceThreadArgs*)arg)->device;
+    oskar_Timer* tmr_a = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Timer* tmr_b = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_name(tmr_a, "Stage A");
+    oskar_timer_set_name(tmr_b, "Stage B");
+    oskar_trace_set_context(OSKAR_TRACE_DEVICE, device);
+    for (int i = 0; i < 10; ++i)
+    {
+        oskar_trace_set_context(OSKAR_TRACE_TIME, i);
+        oskar_timer_resume(tmr_a);
+        oskar_timer_pause(tmr_a);
+        oskar_timer_resume(tmr_b);
+        oskar_timer_pause(tmr_b);
+    }
+    oskar_timer_free(tmr_a);
+    oskar_timer_free(tmr_b);
+    return 0;
+}
+
+static size_t count(const std::string& str, const std::string& sub)
+{
+    size_t n = 0;
+    for (size_t p = str.find(sub); p != std::string::npos;
+            p = str.find(sub, p + sub.length()))
+        n++;
+    return n;
+}
+
+TEST(trace, write_events)
+{
+    int status = 0;
+    const char* filename = "utility_test_trace.json";
+    oskar_Thread* threads[2];
+    TraceThreadArgs args[2];
+
+    // Record events in two threads.
+    oskar_trace_set_enabled(1);
+    for (int i = 0; i < 2; ++i)
+    {
+        args[i].device = i;
+        threads[i] = oskar_thread_create(run_stages, (void*)&args[i], 0);
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+
+    // Events recorded after disabling the trace should be ignored.
+    oskar_trace_set_enabled(0);
+    oskar_trace_event("Ignored", 0.0, 1.0);
+    oskar_trace_write(filename, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the contents of the file.
+    std::ifstream file(filename);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string str = buffer.str();
+    EXPECT_EQ((size_t) 40, count(str, "\"ph\": \"X\""));
+    EXPECT_EQ((size_t) 20, count(str, "\"Stage A\""));
+    EXPECT_EQ((size_t) 20, count(str, "\"Stage B\""));
+    EXPECT_EQ((size_t) 0, count(str, "\"Ignored\""));
+    EXPECT_EQ((size_t) 1, count(str, "\"Device 1\""));
+    EXPECT_EQ((size_t) 2, count(str, "\"device\": 1, \"time\": 9"));
+    remove(filename);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_H_
+#define OSKAR_VIS_BDA_H_
+
+/**
+ * @file oskar_vis_bda.h
+ */
+
+/* Public interface. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisBDA;
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBDA oskar_VisBDA;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+/* To maintain binary compatibility, do not change the values
+ * in the lists below.
+ *
+ * A BDA file starts with a standard visibility header, which describes the
+ * full-resolution data, but it holds no visibility blocks. The averaged
+ * rows are written in chunks using the tags in OSKAR_TAG_GROUP_VIS_BDA,
+ * and the number of chunks is written last.
+ * When a full-resolution visibility file is written as well, it records
+ * the name of the BDA file using OSKAR_VIS_BDA_TAG_FILE_NAME. */
+enum OSKAR_VIS_BDA_TAGS
+{
+    OSKAR_VIS_BDA_TAG_NUM_ROWS_AND_POLS        = 1,
+    OSKAR_VIS_BDA_TAG_ANTENNA1                 = 2,
+    OSKAR_VIS_BDA_TAG_ANTENNA2                 = 3,
+    OSKAR_VIS_BDA_TAG_TIME_CENTROID_MJD_UTC    = 4,
+    OSKAR_VIS_BDA_TAG_EXPOSURE_SEC             = 5,
+    OSKAR_VIS_BDA_TAG_FREQ_HZ                  = 6,
+    OSKAR_VIS_BDA_TAG_CHANNEL_WIDTH_HZ         = 7,
+    OSKAR_VIS_BDA_TAG_BASELINE_UU              = 8,
+    OSKAR_VIS_BDA_TAG_BASELINE_VV              = 9,
+    OSKAR_VIS_BDA_TAG_BASELINE_WW              = 10,
+    OSKAR_VIS_BDA_TAG_WEIGHT                   = 11,
+    OSKAR_VIS_BDA_TAG_CROSS_CORRELATIONS       = 12,
+    OSKAR_VIS_BDA_TAG_NUM_CHUNKS               = 13,
+    OSKAR_VIS_BDA_TAG_FILE_NAME                = 14
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <vis/oskar_vis_bda_accessors.h>
+#include <vis/oskar_vis_bda_add_block.h>
+#include <vis/oskar_vis_bda_create.h>
+#include <vis/oskar_vis_bda_finalise.h>
+#include <vis/oskar_vis_bda_free.h>
+
+#endif /* include guard */
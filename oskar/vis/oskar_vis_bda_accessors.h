@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_ACCESSORS_H_
+#define OSKAR_VIS_BDA_ACCESSORS_H_
+
+/**
+ * @file oskar_vis_bda_accessors.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OSKAR_EXPORT
+double oskar_vis_bda_compression_ratio(const oskar_VisBDA* bda);
+
+OSKAR_EXPORT
+double oskar_vis_bda_max_duvw_wavelengths(const oskar_VisBDA* bda);
+
+OSKAR_EXPORT
+double oskar_vis_bda_num_vis_in(const oskar_VisBDA* bda);
+
+OSKAR_EXPORT
+double oskar_vis_bda_num_vis_out(const oskar_VisBDA* bda);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_ADD_BLOCK_H_
+#define OSKAR_VIS_BDA_ADD_BLOCK_H_
+
+/**
+ * @file oskar_vis_bda_add_block.h
+ */
+
+#include <oskar_global.h>
+#include <binary/oskar_binary.h>
+#include <vis/oskar_vis_block.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Adds a visibility block to the baseline-dependent averaging stage.
+ *
+ * @details
+ * Accumulates the cross-correlations in the block into the running
+ * averages, and writes any averages completed by it to the file handle
+ * as a chunk of rows in the OSKAR_TAG_GROUP_VIS_BDA tag group.
+ *
+ * Blocks must be supplied in the order produced by the simulator:
+ * in time order, with all channel blocks for one time range in sequence.
+ *
+ * @param[in,out] bda     Handle to the averaging stage.
+ * @param[in]     block   Visibility block to add, in CPU memory.
+ * @param[in,out] file    OSKAR binary file handle, opened for write.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_add_block(oskar_VisBDA* bda, const oskar_VisBlock* block,
+        oskar_Binary* file, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_CREATE_H_
+#define OSKAR_VIS_BDA_CREATE_H_
+
+/**
+ * @file oskar_vis_bda_create.h
+ */
+
+#include <oskar_global.h>
+#include <vis/oskar_vis_header.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a baseline-dependent averaging stage.
+ *
+ * @details
+ * Creates a stage that averages cross-correlation visibility data
+ * over time and frequency as it is produced, with the averaging length on
+ * each baseline set by the smearing it would introduce.
+ *
+ * The (u,v,w) tolerance is derived from the maximum allowed amplitude loss
+ * factor \p max_fact for a source at the edge of a field of view of
+ * diameter \p fov_deg, as used by the Python BDA utilities.
+ * For example, a value of 1.01 corresponds to a 1% amplitude loss.
+ *
+ * Averaging lengths are unlimited if \p max_time_avg_sec or
+ * \p max_chans_avg are zero.
+ *
+ * @param[in] hdr              Header describing the visibility data.
+ * @param[in] max_fact         Maximum allowed amplitude loss factor (> 1).
+ * @param[in] fov_deg          Field of view diameter, in degrees.
+ * @param[in] max_time_avg_sec Maximum averaging time, in seconds.
+ * @param[in] max_chans_avg    Maximum number of channels to average.
+ * @param[in,out] status       Status return code.
+ *
+ * @return A handle to the new stage.
+ */
+OSKAR_EXPORT
+oskar_VisBDA* oskar_vis_bda_create(const oskar_VisHeader* hdr,
+        double max_fact, double fov_deg, double max_time_avg_sec,
+        int max_chans_avg, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_FINALISE_H_
+#define OSKAR_VIS_BDA_FINALISE_H_
+
+/**
+ * @file oskar_vis_bda_finalise.h
+ */
+
+#include <oskar_global.h>
+#include <binary/oskar_binary.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Writes out all remaining averages.
+ *
+ * @details
+ * Completes all partially-accumulated averages and writes them to the
+ * file handle, followed by the total number of chunks written.
+ *
+ * @param[in,out] bda     Handle to the averaging stage.
+ * @param[in,out] file    OSKAR binary file handle, opened for write.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_finalise(oskar_VisBDA* bda, oskar_Binary* file,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
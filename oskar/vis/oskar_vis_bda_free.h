@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_VIS_BDA_FREE_H_
+#define OSKAR_VIS_BDA_FREE_H_
+
+/**
+ * @file oskar_vis_bda_free.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Frees memory held by a baseline-dependent averaging stage.
+ *
+ * @param[in,out] bda     Handle to the averaging stage.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_free(oskar_VisBDA* bda, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_VIS_BDA_H_
+#define OSKAR_PRIVATE_VIS_BDA_H_
+
+#include <mem/oskar_mem.h>
+
+/*
+ * This structure holds the state of a baseline-dependent averaging (BDA)
+ * stage, which compresses cross-correlation data on the fly as blocks
+ * are produced.
+ *
+ * Each baseline averages adjacent channels in groups, where the group size
+ * is set by the baseline length so that the change in (u,v,w) across the
+ * group stays within the smearing tolerance. The group size is set again
+ * for each block, using the longest length in the block, and averages
+ * open on a baseline are closed if it changes. Groups do not straddle
+ * visibility blocks in frequency.
+ * Each channel group then averages consecutive time samples until the
+ * (u,v,w) track moves further than the tolerance, or the maximum averaging
+ * time is reached.
+ *
+ * The accumulators are indexed by (channel, baseline), using the first
+ * channel of each group, with baseline the fastest varying dimension.
+ * Completed averages are buffered as rows, and written once per block.
+ */
+struct oskar_VisBDA
+{
+    /* Dimensions and observation parameters. */
+    int num_pols, num_stations, num_baselines, num_channels;
+    double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
+
+    /* Averaging limits. */
+    int max_chans_avg, max_times_avg;
+    double max_duvw_wavelengths;
+
+    /* Number of channels averaged on each baseline. */
+    int* chans_avg;
+
+    /* Accumulators, per (channel, baseline). */
+    int *count, *group_chans, *time_first;
+    double *uvw_first, *uvw_sum, *vis_sum;
+
+    /* Buffered output rows. */
+    int num_rows, chunk_index;
+    oskar_Mem *ant1, *ant2, *time_centroid, *exposure, *freq, *width;
+    oskar_Mem *uu, *vv, *ww, *weight, *vis;
+
+    /* Statistics. */
+    double num_vis_in, num_vis_out;
+};
+
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBDA oskar_VisBDA;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+#endif /* include guard */
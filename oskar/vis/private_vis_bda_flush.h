@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_VIS_BDA_FLUSH_H_
+#define OSKAR_PRIVATE_VIS_BDA_FLUSH_H_
+
+#include <binary/oskar_binary.h>
+#include <vis/private_vis_bda.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_flush_average(oskar_VisBDA* h, size_t i, int a1, int a2,
+        int* status);
+
+void oskar_vis_bda_flush_rows(oskar_VisBDA* h, oskar_Binary* file,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+double oskar_vis_bda_compression_ratio(const oskar_VisBDA* bda)
+{
+    return bda->num_vis_out > 0.0 ? bda->num_vis_in / bda->num_vis_out : 0.0;
+}
+
+double oskar_vis_bda_max_duvw_wavelengths(const oskar_VisBDA* bda)
+{
+    return bda->max_duvw_wavelengths;
+}
+
+double oskar_vis_bda_num_vis_in(const oskar_VisBDA* bda)
+{
+    return bda->num_vis_in;
+}
+
+double oskar_vis_bda_num_vis_out(const oskar_VisBDA* bda)
+{
+    return bda->num_vis_out;
+}
+
+#ifdef __cplusplus
+}
+#endif
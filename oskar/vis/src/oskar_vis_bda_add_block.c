@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/private_vis_bda_flush.h"
+#include "vis/oskar_vis_bda.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C_0 299792458.0
+
+static void set_chans_avg(oskar_VisBDA* h, int num_times,
+        const double* uvw[3], int* status);
+
+void oskar_vis_bda_add_block(oskar_VisBDA* h, const oskar_VisBlock* block,
+        oskar_Binary* file, int* status)
+{
+    int a1, a2, b, t, k;
+    oskar_Mem *vis_temp = 0, *uvw_temp[3];
+    const double *vis_in = 0, *uvw_in[3];
+    if (*status || !oskar_vis_block_has_cross_correlations(block)) return;
+    const oskar_Mem* xc = oskar_vis_block_cross_correlations_const(block);
+    const int num_pols = h->num_pols;
+    const int num_baselines = h->num_baselines;
+    const int num_times = oskar_vis_block_num_times(block);
+    const int num_chans = oskar_vis_block_num_channels(block);
+    const int start_time = oskar_vis_block_start_time_index(block);
+    const int start_chan = oskar_vis_block_start_channel_index(block);
+    if (oskar_mem_location(xc) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_vis_block_num_baselines(block) != num_baselines ||
+            oskar_vis_block_num_pols(block) != num_pols ||
+            start_chan + num_chans > h->num_channels ||
+            oskar_mem_length(oskar_vis_block_baseline_uu_metres_const(
+                    block)) < (size_t) num_times * num_baselines)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Averages are accumulated in double precision. */
+    if (oskar_mem_precision(xc) == OSKAR_DOUBLE)
+        vis_in = (const double*) oskar_mem_void_const(xc);
+    else
+    {
+        vis_temp = oskar_mem_convert_precision(xc, OSKAR_DOUBLE, status);
+        vis_in = (const double*) oskar_mem_void_const(vis_temp);
+    }
+    for (k = 0; k < 3; ++k)
+    {
+        const oskar_Mem* uvw =
+                oskar_vis_block_baseline_uvw_metres_const(block, k);
+        uvw_temp[k] = 0;
+        if (oskar_mem_precision(uvw) == OSKAR_DOUBLE)
+            uvw_in[k] = (const double*) oskar_mem_void_const(uvw);
+        else
+        {
+            uvw_temp[k] = oskar_mem_convert_precision(uvw,
+                    OSKAR_DOUBLE, status);
+            uvw_in[k] = (const double*) oskar_mem_void_const(uvw_temp[k]);
+        }
+    }
+
+    /* Set the number of channels to average on each baseline. */
+    set_chans_avg(h, num_times, uvw_in, status);
+
+    /* Accumulate the block. */
+    for (t = 0; t < num_times && !*status; ++t)
+    {
+        const int t_global = start_time + t;
+        for (a1 = 0, b = 0; a1 < h->num_stations; ++a1)
+        {
+            for (a2 = a1 + 1; a2 < h->num_stations; ++a2, ++b)
+            {
+                int c, c0;
+                const int num_chans_group = h->chans_avg[b];
+                const int i_uvw = t * num_baselines + b;
+                const double uu = uvw_in[0][i_uvw];
+                const double vv = uvw_in[1][i_uvw];
+                const double ww = uvw_in[2][i_uvw];
+                for (c0 = 0; c0 < num_chans; c0 += num_chans_group)
+                {
+                    const int num_c = (c0 + num_chans_group <= num_chans) ?
+                            num_chans_group : num_chans - c0;
+                    const size_t i = (size_t)(start_chan + c0) *
+                            num_baselines + b;
+                    double* vis_sum = h->vis_sum + 2 * num_pols * i;
+                    double* uvw_first = h->uvw_first + 3 * i;
+
+                    /* Close the current average if adding this sample
+                     * would take it beyond the limits. */
+                    if (h->count[i] > 0)
+                    {
+                        const double du = uu - uvw_first[0];
+                        const double dv = vv - uvw_first[1];
+                        const double dw = ww - uvw_first[2];
+                        const double f_max = h->freq_start_hz +
+                                h->freq_inc_hz * (start_chan + c0 +
+                                        (h->freq_inc_hz > 0.0 ? num_c - 1 : 0));
+                        const double duvw =
+                                sqrt(du*du + dv*dv + dw*dw) * f_max / C_0;
+                        if (duvw > h->max_duvw_wavelengths ||
+                                t_global - h->time_first[i] >= h->max_times_avg)
+                            oskar_vis_bda_flush_average(h, i, a1, a2, status);
+                    }
+                    if (h->count[i] == 0)
+                    {
+                        h->group_chans[i] = num_c;
+                        h->time_first[i] = t_global;
+                        uvw_first[0] = uu;
+                        uvw_first[1] = vv;
+                        uvw_first[2] = ww;
+                    }
+
+                    /* Add the channels in this group. */
+                    for (c = c0; c < c0 + num_c; ++c)
+                    {
+                        const double* v = vis_in + 2 * num_pols *
+                                (((size_t) t * num_chans + c) *
+                                        num_baselines + b);
+                        for (k = 0; k < 2 * num_pols; ++k)
+                            vis_sum[k] += v[k];
+                    }
+                    h->uvw_sum[3 * i + 0] += num_c * uu;
+                    h->uvw_sum[3 * i + 1] += num_c * vv;
+                    h->uvw_sum[3 * i + 2] += num_c * ww;
+                    h->count[i] += num_c;
+                }
+            }
+        }
+    }
+    h->num_vis_in += (double) num_times * num_chans * num_baselines;
+    oskar_mem_free(vis_temp, status);
+    for (k = 0; k < 3; ++k) oskar_mem_free(uvw_temp[k], status);
+
+    /* Write out the completed averages. */
+    oskar_vis_bda_flush_rows(h, file, status);
+}
+
+/* Sets the channel group size on each baseline from the longest baseline
+ * length in the block. If the size changes, the averages already open on
+ * the baseline are closed first, as they use the old channel groups. */
+static void set_chans_avg(oskar_VisBDA* h, int num_times,
+        const double* uvw[3], int* status)
+{
+    int a1, a2, b, c, t;
+    const double inc = fabs(h->freq_inc_hz);
+    if (*status) return;
+    for (a1 = 0, b = 0; a1 < h->num_stations; ++a1)
+    {
+        for (a2 = a1 + 1; a2 < h->num_stations; ++a2, ++b)
+        {
+            int n = h->max_chans_avg;
+            double len = 0.0;
+            for (t = 0; t < num_times; ++t)
+            {
+                const int i = t * h->num_baselines + b;
+                const double l = sqrt(uvw[0][i] * uvw[0][i] +
+                        uvw[1][i] * uvw[1][i] + uvw[2][i] * uvw[2][i]);
+                if (l > len) len = l;
+            }
+            if (len > 0.0 && inc > 0.0)
+            {
+                const double n_max =
+                        h->max_duvw_wavelengths * C_0 / (len * inc);
+                if (n_max < (double) n) n = (int) n_max;
+            }
+            if (n < 1) n = 1;
+            if (h->chans_avg[b] != 0 && h->chans_avg[b] != n)
+            {
+                for (c = 0; c < h->num_channels; ++c)
+                    oskar_vis_bda_flush_average(h,
+                            (size_t) c * h->num_baselines + b, a1, a2, status);
+            }
+            h->chans_avg[b] = n;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
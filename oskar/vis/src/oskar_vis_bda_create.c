@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+#include "math/oskar_cmath.h"
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Inverse of sinc(x) = sin(pi x) / (pi x), using Newton-Raphson. */
+static double inv_sinc(double value)
+{
+    int i;
+    double x1 = 0.001;
+    for (i = 0; i < 1000; ++i)
+    {
+        const double x0 = x1, a = x0 * M_PI;
+        x1 = x0 - ((sin(a) / a) - value) /
+                ((a * cos(a) - M_PI * sin(a)) / (a * a));
+        if (fabs(x1 - x0) < 1.0e-6) break;
+    }
+    return x1;
+}
+
+oskar_VisBDA* oskar_vis_bda_create(const oskar_VisHeader* hdr,
+        double max_fact, double fov_deg, double max_time_avg_sec,
+        int max_chans_avg, int* status)
+{
+    oskar_VisBDA* h = 0;
+    int amp_type = 0, num_stations = 0, num_channels = 0;
+    size_t num_acc = 0;
+    if (*status || !hdr) return 0;
+    amp_type = oskar_vis_header_amp_type(hdr);
+    num_stations = oskar_vis_header_num_stations(hdr);
+    num_channels = oskar_vis_header_num_channels_total(hdr);
+    if (!oskar_vis_header_write_cross_correlations(hdr))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+
+    /* Allocate the structure. */
+    h = (oskar_VisBDA*) calloc(1, sizeof(oskar_VisBDA));
+    if (!h)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+
+    /* Store metadata. */
+    h->num_pols = oskar_type_is_matrix(amp_type) ? 4 : 1;
+    h->num_stations = num_stations;
+    h->num_baselines = num_stations * (num_stations - 1) / 2;
+    h->num_channels = num_channels;
+    h->freq_start_hz = oskar_vis_header_freq_start_hz(hdr);
+    h->freq_inc_hz = oskar_vis_header_freq_inc_hz(hdr);
+    h->time_start_mjd_utc = oskar_vis_header_time_start_mjd_utc(hdr);
+    h->time_inc_sec = oskar_vis_header_time_inc_sec(hdr);
+
+    /* Set the averaging limits. */
+    h->max_chans_avg = max_chans_avg > 0 ? max_chans_avg : num_channels;
+    h->max_times_avg = oskar_vis_header_num_times_total(hdr);
+    if (max_time_avg_sec > 0.0 && h->time_inc_sec > 0.0)
+    {
+        h->max_times_avg = (int) floor(max_time_avg_sec / h->time_inc_sec);
+        if (h->max_times_avg < 1) h->max_times_avg = 1;
+    }
+    if (max_fact > 1.0 && fov_deg > 0.0)
+        h->max_duvw_wavelengths =
+                inv_sinc(1.0 / max_fact) / (fov_deg * (M_PI / 180.0));
+
+    /* Create the accumulators. */
+    num_acc = (size_t) num_channels * h->num_baselines;
+    h->chans_avg = (int*) calloc(h->num_baselines, sizeof(int));
+    h->count = (int*) calloc(num_acc, sizeof(int));
+    h->group_chans = (int*) calloc(num_acc, sizeof(int));
+    h->time_first = (int*) calloc(num_acc, sizeof(int));
+    h->uvw_first = (double*) calloc(3 * num_acc, sizeof(double));
+    h->uvw_sum = (double*) calloc(3 * num_acc, sizeof(double));
+    h->vis_sum = (double*) calloc(2 * h->num_pols * num_acc, sizeof(double));
+    if (!h->chans_avg || !h->count || !h->group_chans || !h->time_first ||
+            !h->uvw_first || !h->uvw_sum || !h->vis_sum)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+
+    /* Create the output row buffers. */
+    h->ant1 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    h->ant2 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    h->time_centroid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->exposure = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->freq = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->width = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->vis = oskar_mem_create(h->num_pols == 4 ?
+            OSKAR_DOUBLE_COMPLEX_MATRIX : OSKAR_DOUBLE_COMPLEX,
+            OSKAR_CPU, 0, status);
+
+    /* Return handle to structure. */
+    return h;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/private_vis_bda_flush.h"
+#include "vis/oskar_vis_bda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_finalise(oskar_VisBDA* h, oskar_Binary* file, int* status)
+{
+    int a1, a2, b, c;
+    if (*status) return;
+
+    /* Close all remaining averages, in channel order on each baseline. */
+    for (a1 = 0, b = 0; a1 < h->num_stations; ++a1)
+    {
+        for (a2 = a1 + 1; a2 < h->num_stations; ++a2, ++b)
+        {
+            for (c = 0; c < h->num_channels; ++c)
+            {
+                const size_t i = (size_t) c * h->num_baselines + b;
+                oskar_vis_bda_flush_average(h, i, a1, a2, status);
+            }
+        }
+    }
+    oskar_vis_bda_flush_rows(h, file, status);
+
+    /* Record the number of chunks written. */
+    oskar_binary_write_int(file, OSKAR_TAG_GROUP_VIS_BDA,
+            OSKAR_VIS_BDA_TAG_NUM_CHUNKS, 0, h->chunk_index, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
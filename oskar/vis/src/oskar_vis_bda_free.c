@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_free(oskar_VisBDA* bda, int* status)
+{
+    if (!bda) return;
+    oskar_mem_free(bda->ant1, status);
+    oskar_mem_free(bda->ant2, status);
+    oskar_mem_free(bda->time_centroid, status);
+    oskar_mem_free(bda->exposure, status);
+    oskar_mem_free(bda->freq, status);
+    oskar_mem_free(bda->width, status);
+    oskar_mem_free(bda->uu, status);
+    oskar_mem_free(bda->vv, status);
+    oskar_mem_free(bda->ww, status);
+    oskar_mem_free(bda->weight, status);
+    oskar_mem_free(bda->vis, status);
+    free(bda->chans_avg);
+    free(bda->count);
+    free(bda->group_chans);
+    free(bda->time_first);
+    free(bda->uvw_first);
+    free(bda->uvw_sum);
+    free(bda->vis_sum);
+    free(bda);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/private_vis_bda_flush.h"
+#include "vis/oskar_vis_bda.h"
+#include "mem/oskar_binary_write_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static void resize_rows(oskar_VisBDA* h, size_t num_rows, int* status)
+{
+    oskar_mem_realloc(h->ant1, num_rows, status);
+    oskar_mem_realloc(h->ant2, num_rows, status);
+    oskar_mem_realloc(h->time_centroid, num_rows, status);
+    oskar_mem_realloc(h->exposure, num_rows, status);
+    oskar_mem_realloc(h->freq, num_rows, status);
+    oskar_mem_realloc(h->width, num_rows, status);
+    oskar_mem_realloc(h->uu, num_rows, status);
+    oskar_mem_realloc(h->vv, num_rows, status);
+    oskar_mem_realloc(h->ww, num_rows, status);
+    oskar_mem_realloc(h->weight, num_rows, status);
+    oskar_mem_realloc(h->vis, num_rows, status);
+}
+
+void oskar_vis_bda_flush_average(oskar_VisBDA* h, size_t i, int a1, int a2,
+        int* status)
+{
+    int k;
+    const int count = h->count[i];
+    if (*status || count == 0) return;
+
+    /* Make sure there is space for the row. */
+    const int r = h->num_rows;
+    if ((size_t) r >= oskar_mem_length(h->ant1))
+        resize_rows(h, r + h->num_baselines, status);
+    if (*status) return;
+
+    /* Store the average as a new row. */
+    const int chan = (int) (i / h->num_baselines);
+    const int num_chans = h->group_chans[i];
+    const int num_times = count / num_chans;
+    const double s = 1.0 / count;
+    double* vis_out = oskar_mem_double(h->vis, status) + 2 * h->num_pols * r;
+    double* vis_sum = h->vis_sum + 2 * h->num_pols * i;
+    oskar_mem_int(h->ant1, status)[r] = a1;
+    oskar_mem_int(h->ant2, status)[r] = a2;
+    oskar_mem_double(h->time_centroid, status)[r] = h->time_start_mjd_utc +
+            (h->time_first[i] + 0.5 * num_times) * h->time_inc_sec / 86400.0;
+    oskar_mem_double(h->exposure, status)[r] = num_times * h->time_inc_sec;
+    oskar_mem_double(h->freq, status)[r] = h->freq_start_hz +
+            (chan + 0.5 * (num_chans - 1)) * h->freq_inc_hz;
+    oskar_mem_double(h->width, status)[r] = num_chans * h->freq_inc_hz;
+    oskar_mem_double(h->uu, status)[r] = h->uvw_sum[3 * i + 0] * s;
+    oskar_mem_double(h->vv, status)[r] = h->uvw_sum[3 * i + 1] * s;
+    oskar_mem_double(h->ww, status)[r] = h->uvw_sum[3 * i + 2] * s;
+    oskar_mem_double(h->weight, status)[r] = (double) count;
+    for (k = 0; k < 2 * h->num_pols; ++k)
+    {
+        vis_out[k] = vis_sum[k] * s;
+        vis_sum[k] = 0.0;
+    }
+    h->uvw_sum[3 * i + 0] = 0.0;
+    h->uvw_sum[3 * i + 1] = 0.0;
+    h->uvw_sum[3 * i + 2] = 0.0;
+    h->count[i] = 0;
+    h->num_rows++;
+    h->num_vis_out += 1.0;
+}
+
+void oskar_vis_bda_flush_rows(oskar_VisBDA* h, oskar_Binary* file,
+        int* status)
+{
+    const unsigned char grp = OSKAR_TAG_GROUP_VIS_BDA;
+    const size_t n = (size_t) h->num_rows;
+    int dims[2];
+    if (*status || h->num_rows == 0) return;
+    dims[0] = h->num_rows;
+    dims[1] = h->num_pols;
+    const int j = h->chunk_index;
+    oskar_binary_write(file, OSKAR_INT, grp,
+            OSKAR_VIS_BDA_TAG_NUM_ROWS_AND_POLS, j, sizeof(dims), dims, status);
+    oskar_binary_write_mem(file, h->ant1, grp,
+            OSKAR_VIS_BDA_TAG_ANTENNA1, j, n, status);
+    oskar_binary_write_mem(file, h->ant2, grp,
+            OSKAR_VIS_BDA_TAG_ANTENNA2, j, n, status);
+    oskar_binary_write_mem(file, h->time_centroid, grp,
+            OSKAR_VIS_BDA_TAG_TIME_CENTROID_MJD_UTC, j, n, status);
+    oskar_binary_write_mem(file, h->exposure, grp,
+            OSKAR_VIS_BDA_TAG_EXPOSURE_SEC, j, n, status);
+    oskar_binary_write_mem(file, h->freq, grp,
+            OSKAR_VIS_BDA_TAG_FREQ_HZ, j, n, status);
+    oskar_binary_write_mem(file, h->width, grp,
+            OSKAR_VIS_BDA_TAG_CHANNEL_WIDTH_HZ, j, n, status);
+    oskar_binary_write_mem(file, h->uu, grp,
+            OSKAR_VIS_BDA_TAG_BASELINE_UU, j, n, status);
+    oskar_binary_write_mem(file, h->vv, grp,
+            OSKAR_VIS_BDA_TAG_BASELINE_VV, j, n, status);
+    oskar_binary_write_mem(file, h->ww, grp,
+            OSKAR_VIS_BDA_TAG_BASELINE_WW, j, n, status);
+    oskar_binary_write_mem(file, h->weight, grp,
+            OSKAR_VIS_BDA_TAG_WEIGHT, j, n, status);
+    oskar_binary_write_mem(file, h->vis, grp,
+            OSKAR_VIS_BDA_TAG_CROSS_CORRELATIONS, j, n, status);
+    h->chunk_index++;
+    h->num_rows = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2021, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "binary/oskar_binary.h"
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+TEST(vis_bda, compression)
+{
+    int status = 0;
+    const int num_stations = 4, num_times = 60, num_channels = 8;
+    const int max_times_per_block = 20, max_channels_per_block = 4;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const double station_x[] = {0.0, 20.0, 2000.0, 20000.0};
+    const double time_inc_sec = 10.0;
+    const char* filename = "temp_test_vis_bda.vis";
+
+    // Create the header and write it.
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times,
+            max_channels_per_block, num_channels, num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 100e3);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 51544.5);
+    oskar_vis_header_set_time_inc_sec(hdr, time_inc_sec);
+    oskar_Binary* file = oskar_vis_header_write(hdr, filename, &status);
+    oskar_VisBDA* bda = oskar_vis_bda_create(hdr, 1.01, 1.0, 0.0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Add blocks of constant visibilities on rotating baselines.
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    for (int t0 = 0; t0 < num_times; t0 += max_times_per_block)
+    {
+        for (int c0 = 0; c0 < num_channels; c0 += max_channels_per_block)
+        {
+            oskar_vis_block_set_start_time_index(block, t0);
+            oskar_vis_block_set_start_channel_index(block, c0);
+            double* vis = oskar_mem_double(
+                    oskar_vis_block_cross_correlations(block), &status);
+            double* uu = oskar_mem_double(
+                    oskar_vis_block_baseline_uu_metres(block), &status);
+            double* vv = oskar_mem_double(
+                    oskar_vis_block_baseline_vv_metres(block), &status);
+            double* ww = oskar_mem_double(
+                    oskar_vis_block_baseline_ww_metres(block), &status);
+            for (int t = 0; t < max_times_per_block; ++t)
+            {
+                const double ha = 2.0 * M_PI * (t0 + t) * time_inc_sec / 86400;
+                for (int a1 = 0, b = 0; a1 < num_stations; ++a1)
+                {
+                    for (int a2 = a1 + 1; a2 < num_stations; ++a2, ++b)
+                    {
+                        const double len = station_x[a2] - station_x[a1];
+                        const int i = t * num_baselines + b;
+                        uu[i] = len * cos(ha);
+                        vv[i] = len * sin(ha);
+                        ww[i] = 0.0;
+                        for (int c = 0; c < max_channels_per_block; ++c)
+                        {
+                            const int j = (t * max_channels_per_block + c) *
+                                    num_baselines + b;
+                            vis[2 * j + 0] = 1.0;
+                            vis[2 * j + 1] = -2.0;
+                        }
+                    }
+                }
+            }
+            oskar_vis_bda_add_block(bda, block, file, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        }
+    }
+    oskar_vis_bda_finalise(bda, file, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double num_vis_in = (double) num_times * num_channels * num_baselines;
+    EXPECT_DOUBLE_EQ(num_vis_in, oskar_vis_bda_num_vis_in(bda));
+    EXPECT_GT(oskar_vis_bda_compression_ratio(bda), 2.0);
+    const double num_vis_out = oskar_vis_bda_num_vis_out(bda);
+    oskar_vis_bda_free(bda, &status);
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(file);
+
+    // Read the rows back and check them.
+    file = oskar_binary_create(filename, 'r', &status);
+    int num_chunks = 0;
+    oskar_binary_read_int(file, OSKAR_TAG_GROUP_VIS_BDA,
+            OSKAR_VIS_BDA_TAG_NUM_CHUNKS, 0, &num_chunks, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_GT(num_chunks, 0);
+    double total_weight = 0.0, total_rows = 0.0;
+    std::vector<int> rows_per_baseline(num_baselines, 0);
+    for (int i = 0; i < num_chunks; ++i)
+    {
+        int dims[2];
+        oskar_binary_read(file, OSKAR_INT, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_NUM_ROWS_AND_POLS, i,
+                sizeof(dims), dims, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(1, dims[1]);
+        const int n = dims[0];
+        std::vector<int> ant1(n), ant2(n);
+        std::vector<double> weight(n), vis(2 * n);
+        oskar_binary_read(file, OSKAR_INT, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_ANTENNA1, i, n * sizeof(int),
+                &ant1[0], &status);
+        oskar_binary_read(file, OSKAR_INT, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_ANTENNA2, i, n * sizeof(int),
+                &ant2[0], &status);
+        oskar_binary_read(file, OSKAR_DOUBLE, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_WEIGHT, i, n * sizeof(double),
+                &weight[0], &status);
+        oskar_binary_read(file, OSKAR_DOUBLE_COMPLEX, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_CROSS_CORRELATIONS, i,
+                2 * n * sizeof(double), &vis[0], &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int r = 0; r < n; ++r)
+        {
+            const int a1 = ant1[r], a2 = ant2[r];
+            const int b = a1 * (num_stations - 1) - (a1 - 1) * a1 / 2 +
+                    a2 - a1 - 1;
+            rows_per_baseline[b]++;
+            total_weight += weight[r];
+            EXPECT_NEAR(1.0, vis[2 * r + 0], 1e-12);
+            EXPECT_NEAR(-2.0, vis[2 * r + 1], 1e-12);
+        }
+        total_rows += n;
+    }
+    oskar_binary_free(file);
+    EXPECT_DOUBLE_EQ(num_vis_out, total_rows);
+    EXPECT_DOUBLE_EQ(num_vis_in, total_weight);
+
+    // The shortest baseline must be averaged more than the longest.
+    EXPECT_LT(rows_per_baseline[0], rows_per_baseline[2]);
+    EXPECT_EQ(num_times * num_channels, rows_per_baseline[2]);
+    remove(filename);
+}
+
+TEST(vis_bda, channel_groups_follow_length)
+{
+    int status = 0;
+    const int num_stations = 2, num_times = 30, num_channels = 8;
+    const int max_times_per_block = 10;
+    const double block_length[] = {100.0, 3000.0, 20000.0};
+    const double freq_inc_hz = 100e3;
+    const char* filename = "temp_test_vis_bda_groups.vis";
+
+    // Create the header and write it.
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times,
+            num_channels, num_channels, num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 51544.5);
+    oskar_vis_header_set_time_inc_sec(hdr, 10.0);
+    oskar_Binary* file = oskar_vis_header_write(hdr, filename, &status);
+    oskar_VisBDA* bda = oskar_vis_bda_create(hdr, 1.01, 1.0, 0.0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double max_duvw = oskar_vis_bda_max_duvw_wavelengths(bda);
+
+    // Add blocks in which the baseline gets longer each time.
+    oskar_VisBlock* block = oskar_vis_block_create_from_header(OSKAR_CPU,
+            hdr, &status);
+    for (int i = 0; i < num_times / max_times_per_block; ++i)
+    {
+        oskar_vis_block_set_start_time_index(block, i * max_times_per_block);
+        oskar_Mem* vis = oskar_vis_block_cross_correlations(block);
+        oskar_Mem* uu = oskar_vis_block_baseline_uu_metres(block);
+        oskar_mem_set_value_real(vis, 1.0, 0, oskar_mem_length(vis),
+                &status);
+        oskar_mem_set_value_real(uu, block_length[i], 0,
+                oskar_mem_length(uu), &status);
+        oskar_mem_clear_contents(
+                oskar_vis_block_baseline_vv_metres(block), &status);
+        oskar_mem_clear_contents(
+                oskar_vis_block_baseline_ww_metres(block), &status);
+        oskar_vis_bda_add_block(bda, block, file, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
+    oskar_vis_bda_finalise(bda, file, &status);
+    oskar_vis_bda_free(bda, &status);
+    oskar_vis_block_free(block, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(file);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check that no row averages channels over more than the tolerance,
+    // unless it holds only one channel.
+    file = oskar_binary_create(filename, 'r', &status);
+    int num_chunks = 0;
+    oskar_binary_read_int(file, OSKAR_TAG_GROUP_VIS_BDA,
+            OSKAR_VIS_BDA_TAG_NUM_CHUNKS, 0, &num_chunks, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double total_weight = 0.0;
+    for (int i = 0; i < num_chunks; ++i)
+    {
+        int dims[2];
+        oskar_binary_read(file, OSKAR_INT, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_NUM_ROWS_AND_POLS, i,
+                sizeof(dims), dims, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const int n = dims[0];
+        std::vector<double> width(n), uu(n), weight(n);
+        oskar_binary_read(file, OSKAR_DOUBLE, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_CHANNEL_WIDTH_HZ, i, n * sizeof(double),
+                &width[0], &status);
+        oskar_binary_read(file, OSKAR_DOUBLE, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_BASELINE_UU, i, n * sizeof(double),
+                &uu[0], &status);
+        oskar_binary_read(file, OSKAR_DOUBLE, OSKAR_TAG_GROUP_VIS_BDA,
+                OSKAR_VIS_BDA_TAG_WEIGHT, i, n * sizeof(double),
+                &weight[0], &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int r = 0; r < n; ++r)
+        {
+            if (width[r] > freq_inc_hz)
+            {
+                EXPECT_LE(uu[r] * width[r] / 299792458.0,
+                        max_duvw * (1 + 1e-9))
+                        << "Row " << r << " of chunk " << i;
+            }
+            total_weight += weight[r];
+        }
+    }
+    oskar_binary_free(file);
+    EXPECT_DOUBLE_EQ((double) num_times * num_channels, total_weight);
+    remove(filename);
+}
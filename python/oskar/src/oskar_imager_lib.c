@@ -1698,7 +1698,9 @@ static PyObject* make_image(PyObject* self, PyObject* args)
             !strncmp(algorithm_type, "w", 1))
         wproj = 1;
     if (!strncmp(weighting_type, "U", 1) ||
-            !strncmp(weighting_type, "u", 1))
+            !strncmp(weighting_type, "u", 1) ||
+            !strncmp(weighting_type, "B", 1) ||
+            !strncmp(weighting_type, "b", 1))
         uniform = 1;
 
     /* Get the plane size. */